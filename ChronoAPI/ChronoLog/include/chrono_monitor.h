@@ -2,59 +2,119 @@
 #define CHRONOLOG_CHRONO_MONITOR_H
 
 #include <spdlog/spdlog.h>
+#include <map>
 #include <mutex>
+#include <string>
+
+namespace spdlog
+{
+namespace details
+{
+class thread_pool;
+}
+}
 
 namespace chronolog
 {
 
+/**
+ * @def CHRONOLOG_LOG_ACTIVE_LEVEL
+ * @brief Compile-time logging level.
+ * The logging statements below this level (SPDLOG_LEVEL_TRACE .. SPDLOG_LEVEL_OFF) are compiled out
+ * and their arguments are never evaluated. Defaults to SPDLOG_LEVEL_INFO when NDEBUG is defined
+ * and to SPDLOG_LEVEL_TRACE otherwise.
+ */
+#ifndef CHRONOLOG_LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define CHRONOLOG_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#else
+#define CHRONOLOG_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+#endif
+
+/**
+ * @def CHRONOLOG_LOG(log_target, level, ...)
+ * @brief Lazy logging macro.
+ * The arguments are evaluated and formatted only if the runtime level of the logger lets the message through,
+ * so the expensive arguments (event stringification) cost nothing when the level is disabled.
+ */
+#define CHRONOLOG_LOG(log_target, level, ...) \
+    do \
+    { \
+        spdlog::logger &chronolog_logger_ = (log_target); \
+        if(chronolog_logger_.should_log(level)) \
+        { chronolog_logger_.log(level, __VA_ARGS__); } \
+    } while(0)
+
 /**
  * @def LOG_TRACE(...)
  * @brief Trace logging macro.
- * Logs a trace message when NDEBUG is not defined. Does nothing otherwise.
+ * Logs a trace message when CHRONOLOG_LOG_ACTIVE_LEVEL allows it. Does nothing otherwise.
  */
 
 /**
  * @def LOG_DEBUG(...)
  * @brief Debug logging macro.
- * Logs a debug message when NDEBUG is not defined. Does nothing otherwise.
+ * Logs a debug message when CHRONOLOG_LOG_ACTIVE_LEVEL allows it. Does nothing otherwise.
  */
 
 /**
  * @def LOG_INFO(...)
  * @brief Info logging macro.
- * Logs an info message regardless of NDEBUG definition.
+ * Logs an info message when CHRONOLOG_LOG_ACTIVE_LEVEL allows it (always by default).
  */
 
 /**
  * @def LOG_WARNING(...)
  * @brief Warning logging macro.
- * Logs a warning message regardless of NDEBUG definition.
+ * Logs a warning message regardless of CHRONOLOG_LOG_ACTIVE_LEVEL.
  */
 
 /**
  * @def LOG_ERROR(...)
  * @brief Error logging macro.
- * Logs an error message regardless of NDEBUG definition.
+ * Logs an error message regardless of CHRONOLOG_LOG_ACTIVE_LEVEL.
  */
 
 /**
  * @def LOG_CRITICAL(...)
  * @brief Critical logging macro.
- * Logs a critical message regardless of NDEBUG definition.
+ * Logs a critical message regardless of CHRONOLOG_LOG_ACTIVE_LEVEL.
  */
 
-// Custom logging macros based on build type
-#ifdef NDEBUG
-#define LOG_TRACE(...)
-#define LOG_DEBUG(...)
+/**
+ * @def LOG_MODULE_TRACE(module_logger, ...) .. LOG_MODULE_ERROR(module_logger, ...)
+ * @brief Module logging macros.
+ * Same as the LOG_ macros but log through the module logger returned by chrono_monitor::getModuleLogger(),
+ * whose runtime level can be set independently of the process level.
+ */
+
+#if CHRONOLOG_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::trace, __VA_ARGS__)
+#define LOG_MODULE_TRACE(module_logger, ...) CHRONOLOG_LOG(module_logger, spdlog::level::trace, __VA_ARGS__)
 #else
-#define LOG_TRACE(...) chronolog::chrono_monitor::getInstance().trace(__VA_ARGS__)
-#define LOG_DEBUG(...) chronolog::chrono_monitor::getInstance().debug(__VA_ARGS__)
+#define LOG_TRACE(...) (void)0
+#define LOG_MODULE_TRACE(module_logger, ...) (void)0
 #endif
-#define LOG_INFO(...) chronolog::chrono_monitor::getInstance().info(__VA_ARGS__)
-#define LOG_WARNING(...) chronolog::chrono_monitor::getInstance().warn(__VA_ARGS__)
-#define LOG_ERROR(...) chronolog::chrono_monitor::getInstance().error(__VA_ARGS__)
-#define LOG_CRITICAL(...) chronolog::chrono_monitor::getInstance().critical(__VA_ARGS__)
+#if CHRONOLOG_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::debug, __VA_ARGS__)
+#define LOG_MODULE_DEBUG(module_logger, ...) CHRONOLOG_LOG(module_logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) (void)0
+#define LOG_MODULE_DEBUG(module_logger, ...) (void)0
+#endif
+#if CHRONOLOG_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::info, __VA_ARGS__)
+#define LOG_MODULE_INFO(module_logger, ...) CHRONOLOG_LOG(module_logger, spdlog::level::info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) (void)0
+#define LOG_MODULE_INFO(module_logger, ...) (void)0
+#endif
+#define LOG_WARNING(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::warn, __VA_ARGS__)
+#define LOG_ERROR(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::err, __VA_ARGS__)
+#define LOG_CRITICAL(...) CHRONOLOG_LOG(chronolog::chrono_monitor::getInstance(), spdlog::level::critical, __VA_ARGS__)
+#define LOG_MODULE_WARNING(module_logger, ...) CHRONOLOG_LOG(module_logger, spdlog::level::warn, __VA_ARGS__)
+#define LOG_MODULE_ERROR(module_logger, ...) CHRONOLOG_LOG(module_logger, spdlog::level::err, __VA_ARGS__)
 
 /**
  * @class Logger
@@ -82,6 +142,8 @@ public:
      * @param logFileSize  Maximum size of log file before rotating (in Bytes).
      * @param logFileNum   Number of log files to maintain before overwriting.
      * @param flushLevel   The logging level for the logger to flush into file when file logging mode.
+     * @param asyncLogging If true the messages are written to the sink by a background thread,
+     *                     the logging threads only format the message and queue it.
      *
      * @return             Returns 0 if the logger was initialized successfully,
      *                     and returns 1 if there was an error during initialization.
@@ -89,7 +151,8 @@ public:
     static int initialize(const std::string &logType, const std::string &location, spdlog::level::level_enum logLevel
                           , const std::string &loggerName, const std::size_t &logFileSize = 104857600
                           , const std::size_t &logFileNum = 3
-                          , spdlog::level::level_enum flushLevel = spdlog::level::warn);
+                          , spdlog::level::level_enum flushLevel = spdlog::level::warn
+                          , bool asyncLogging = false);
 
 
     /**
@@ -102,6 +165,28 @@ public:
      */
     static spdlog::logger &getInstance();
 
+    /**
+     * @brief Accessor for the module logger.
+     *
+     * Returns the logger of the named module, created on the first call. The module logger shares the sink
+     * of the process logger and reports the module name in the formatted output; its level is the one set with
+     * setModuleLevel() or the process level otherwise. The hot path components look their module logger up once
+     * and keep the reference.
+     *
+     * @param moduleName   The name of the module, e.g. "IngestionQueue".
+     * @return Reference to spdlog::logger instance of the module.
+     */
+    static spdlog::logger &getModuleLogger(const std::string &moduleName);
+
+    /**
+     * @brief Sets the runtime logging level of the module logger.
+     *
+     * Can be called before or after the module logger is created.
+     */
+    static void setModuleLevel(const std::string &moduleName, spdlog::level::level_enum logLevel);
+
+    static void setModuleLevels(const std::map <std::string, spdlog::level::level_enum> &moduleLevels);
+
     // Delete copy constructor and assignment operator
     chrono_monitor(const chrono_monitor &) = delete;
 
@@ -118,8 +203,16 @@ private:
      *
      * This static member holds the instance of the spdlog logger used by the Logger class.
      */
+    static std::shared_ptr <spdlog::details::thread_pool> asyncThreadPool;
+
     static std::shared_ptr <spdlog::logger> logger;
 
+    /**
+     * @brief Module loggers and the runtime levels set for the modules, protected by the mutex.
+     */
+    static std::map <std::string, std::shared_ptr <spdlog::logger>> moduleLoggers;
+    static std::map <std::string, spdlog::level::level_enum> moduleLevels;
+
     /**
      * @brief Mutex for thread safety.
      *
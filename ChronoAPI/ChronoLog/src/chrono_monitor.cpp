@@ -3,6 +3,7 @@
 //
 
 #include "chrono_monitor.h"
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <iostream>
@@ -11,12 +12,16 @@
 namespace chronolog
 {
 
+// the thread pool is defined before the logger so that it outlives it and drains the queued messages at exit
+std::shared_ptr <spdlog::details::thread_pool> chrono_monitor::asyncThreadPool = nullptr;
 std::shared_ptr <spdlog::logger> chrono_monitor::logger = nullptr;
+std::map <std::string, std::shared_ptr <spdlog::logger>> chrono_monitor::moduleLoggers;
+std::map <std::string, spdlog::level::level_enum> chrono_monitor::moduleLevels;
 std::mutex chrono_monitor::mutex;
 
 int chrono_monitor::initialize(const std::string &logType, const std::string &location, spdlog::level::level_enum logLevel
                                , const std::string &loggerName, const std::size_t &logFileSize, const std::size_t &logFileNum
-                               , spdlog::level::level_enum flushLevel)
+                               , spdlog::level::level_enum flushLevel, bool asyncLogging)
 {
     std::lock_guard <std::mutex> lock(mutex);
     if(logger)
@@ -45,7 +50,18 @@ int chrono_monitor::initialize(const std::string &logType, const std::string &lo
             std::cerr << "[Logger] Invalid log type" << std::endl;
             return 1;
         }
-        logger = std::make_shared <spdlog::logger>(loggerName, sink);
+        if(asyncLogging)
+        {
+            // a single background thread keeps the messages of each logging thread in order,
+            // the logging threads block rather than drop messages if the queue is full
+            asyncThreadPool = std::make_shared <spdlog::details::thread_pool>(spdlog::details::default_async_q_size, 1);
+            logger = std::make_shared <spdlog::async_logger>(loggerName, sink, asyncThreadPool
+                                                             , spdlog::async_overflow_policy::block);
+        }
+        else
+        {
+            logger = std::make_shared <spdlog::logger>(loggerName, sink);
+        }
         logger->flush_on(flushLevel);
         logger->set_level(logLevel);
     }
@@ -70,4 +86,43 @@ spdlog::logger &chrono_monitor::getInstance()
     }
 }
 
+spdlog::logger &chrono_monitor::getModuleLogger(const std::string &moduleName)
+{
+    spdlog::logger &processLogger = getInstance();
+
+    std::lock_guard <std::mutex> lock(mutex);
+    auto loggerIter = moduleLoggers.find(moduleName);
+    if(loggerIter == moduleLoggers.end())
+    {
+        // the clone shares the sinks and, for the async logger, the thread pool of the process logger
+        std::shared_ptr <spdlog::logger> moduleLogger = processLogger.clone(moduleName);
+        auto levelIter = moduleLevels.find(moduleName);
+        if(levelIter != moduleLevels.end())
+        {
+            moduleLogger->set_level((*levelIter).second);
+        }
+        loggerIter = moduleLoggers.insert(std::make_pair(moduleName, moduleLogger)).first;
+    }
+    return *((*loggerIter).second);
+}
+
+void chrono_monitor::setModuleLevel(const std::string &moduleName, spdlog::level::level_enum logLevel)
+{
+    std::lock_guard <std::mutex> lock(mutex);
+    moduleLevels[moduleName] = logLevel;
+    auto loggerIter = moduleLoggers.find(moduleName);
+    if(loggerIter != moduleLoggers.end())
+    {
+        (*loggerIter).second->set_level(logLevel);
+    }
+}
+
+void chrono_monitor::setModuleLevels(const std::map <std::string, spdlog::level::level_enum> &levels)
+{
+    for(auto const &moduleLevel: levels)
+    {
+        setModuleLevel(moduleLevel.first, moduleLevel.second);
+    }
+}
+
 } // namespace chronolog
\ No newline at end of file
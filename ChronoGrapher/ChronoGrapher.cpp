@@ -15,8 +15,16 @@
 #include "ConfigurationManager.h"
 #include "CSVFileChunkExtractor.h"
 #include "HDF5FileChunkExtractor.h"
+#include "PlayerChunkForwarder.h"
+#include "MetricsRegistry.h"
+#include "EventTracer.h"
+#include "XstreamPlacement.h"
 #include "cmd_arg_parse.h"
 
+// the registration is re-sent every this many stats messages, which re-registers the process
+// with the ChronoVisor restarted from its metadata store
+#define VISOR_REGISTRATION_REFRESH_CYCLES 6
+
 namespace chl = chronolog;
 
 // we will be using a combination of the uint32_t representation of the service IP address
@@ -83,12 +91,15 @@ int main(int argc, char**argv)
                                                        , GRAPHER_CONF.LOG_CONF.LOGNAME
                                                        , GRAPHER_CONF.LOG_CONF.LOGFILESIZE
                                                        , GRAPHER_CONF.LOG_CONF.LOGFILENUM
-                                                       , GRAPHER_CONF.LOG_CONF.FLUSHLEVEL);
+                                                       , GRAPHER_CONF.LOG_CONF.FLUSHLEVEL
+                                                       , GRAPHER_CONF.LOG_CONF.ASYNC);
     if(result == 1)
     {
         std::cerr <<" ChronoGrapher failed to initialize chrono_monitor, check the configuration settings";
         exit(EXIT_FAILURE);
     }
+    chronolog::chrono_monitor::setModuleLevels(GRAPHER_CONF.LOG_CONF.MODULE_LEVELS);
+    chronolog::EventTracer::getInstance().configure("ChronoGrapher", GRAPHER_CONF.TRACING_CONF.sample_every);
 
     LOG_INFO("Running ChronoGrapher ");
     LOG_INFO("[ChronoGrapher] Configuration {}", GRAPHER_CONF.to_String());
@@ -150,10 +161,24 @@ int main(int argc, char**argv)
 
     // Instantiate MemoryDataStore & ExtractorModule
     chronolog::ChunkIngestionQueue ingestionQueue;
+    // xstreams of the recording handlers, data collection, archiving and forwarding pinned to their configured cores;
+    // declared ahead of the modules whose xstreams run its pools
+    chronolog::XstreamPlacement xstreamPlacement;
+    if(xstreamPlacement.initialize(GRAPHER_CONF.CORE_PLACEMENT_CONF) != chronolog::CL_SUCCESS)
+    {
+        LOG_CRITICAL("[ChronoGrapher] Invalid CorePlacement configuration; exiting");
+        return (-1);
+    }
     std::string csv_files_directory = GRAPHER_CONF.EXTRACTOR_CONF.story_files_dir;
 
 //    chronolog::CSVFileStoryChunkExtractor storyExtractor(process_id_string.str(), csv_files_directory);
-    chronolog::HDF5FileChunkExtractor storyExtractor(chl::to_string(processIdCard), csv_files_directory);
+    if(GRAPHER_CONF.EXTRACTOR_CONF.record_encoding != "template" && GRAPHER_CONF.EXTRACTOR_CONF.record_encoding != "none")
+    {
+        LOG_WARNING("[ChronoGrapher] Unknown record_encoding '{}', the records are archived verbatim"
+                    , GRAPHER_CONF.EXTRACTOR_CONF.record_encoding);
+    }
+    chronolog::HDF5FileChunkExtractor storyExtractor(chl::to_string(processIdCard), csv_files_directory
+                                                     , GRAPHER_CONF.EXTRACTOR_CONF.record_encoding == "template");
 
     chronolog::GrapherDataStore theDataStore(ingestionQueue, storyExtractor.getExtractionQueue(),
                 GRAPHER_CONF.DATA_STORE_CONF.max_story_chunk_size,
@@ -161,6 +186,29 @@ int main(int argc, char**argv)
                 GRAPHER_CONF.DATA_STORE_CONF.acceptance_window_secs,
                 GRAPHER_CONF.DATA_STORE_CONF.inactive_story_delay_secs);
 
+    // Instantiate the forwarder of the incoming StoryChunks to the Player of this RecordingGroup
+    chl::ServiceId playerDrainServiceId(GRAPHER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.PROTO_CONF,
+                GRAPHER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.IP,
+                GRAPHER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.BASE_PORT,
+                GRAPHER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.SERVICE_PROVIDER_ID);
+
+    tl::engine*forwardingEngine = nullptr;
+    chronolog::PlayerChunkForwarder*playerChunkForwarder = nullptr;
+
+    try
+    {
+        forwardingEngine = new tl::engine(GRAPHER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.PROTO_CONF, THALLIUM_CLIENT_MODE);
+        playerChunkForwarder = new chronolog::PlayerChunkForwarder(*forwardingEngine, playerDrainServiceId);
+    }
+    catch(tl::exception const &)
+    {
+        // the Grapher is fully functional without the Player feed, recent events will just be
+        // available for playback once they are archived
+        LOG_WARNING("[ChronoGrapher] failed to create forwarding engine for Player service {}"
+                    , chl::to_string(playerDrainServiceId));
+        playerChunkForwarder = nullptr;
+    }
+
     tl::engine*dataAdminEngine = nullptr;
 
     chronolog::DataStoreAdminService*grapherDataAdminService = nullptr;
@@ -205,9 +253,14 @@ int main(int argc, char**argv)
         s1 << recordingEngine->self();
         LOG_INFO("[ChronoGrapher] starting RecordingService at {} with provider_id {}", s1.str()
                  , recording_service_provider_id);
+        tl::pool recording_handler_pool = xstreamPlacement.createHandlerXstreams(chronolog::XSTREAM_RPC);
         grapherRecordingService = chronolog::GrapherRecordingService::CreateRecordingService(*recordingEngine
                                                                                              , recording_service_provider_id
-                                                                                             , ingestionQueue);
+                                                                                             , ingestionQueue
+                                                                                             , (playerChunkForwarder != nullptr
+                                                                                                ? &playerChunkForwarder->getExtractionQueue()
+                                                                                                : nullptr)
+                                                                                             , recording_handler_pool);
     }
     catch(tl::exception const &)
     {
@@ -270,18 +323,60 @@ int main(int argc, char**argv)
     // services are successfully created and keeper process had registered with ChronoVisor
     // start all dataCollection and Extraction threads...
     tl::abt scope;
-    theDataStore.startDataCollection(3);
-    // start extraction streams & threads
-    storyExtractor.startExtractionThreads(2);
+    theDataStore.startDataCollection(3, &xstreamPlacement);
+    // start extraction streams & threads, the archiving xstreams run on the io cores
+    storyExtractor.startExtractionThreads(2, &xstreamPlacement, chronolog::XSTREAM_IO);
+    if(playerChunkForwarder != nullptr)
+    { playerChunkForwarder->startExtractionThreads(1, &xstreamPlacement); }
 
     /// Main loop for sending stats message until receiving SIGTERM ____________________________________________________
     // now we are ready to ingest records coming from the storyteller clients ....
     // main thread would be sending stats message until keeper process receives
     // sigterm signal
     chronolog::GrapherStatsMsg grapherStatsMsg(processIdCard);
+    chronolog::ProcessLoadStats loadStats;
+    loadStats.capacity = chronolog::getProcessCapacity();
+    uint64_t lastIngestedEventCount = ingestionQueue.getIngestedEventCount();
+    auto lastStatsTime = std::chrono::steady_clock::now();
+    uint64_t statsCycle = 0;
+
+    chronolog::MetricsRegistry & metricsRegistry = chronolog::MetricsRegistry::getInstance();
+    chronolog::MetricsGauge* activeStoriesGauge = metricsRegistry.getGauge("grapher_active_stories");
+    chronolog::MetricsGauge* ingestionQueueGauge = metricsRegistry.getGauge("grapher_ingestion_queue_depth");
+    chronolog::MetricsGauge* extractionQueueGauge = metricsRegistry.getGauge("grapher_extraction_queue_depth");
+    std::vector<chronolog::MetricSummary> metricsRollup;
+    if(!GRAPHER_CONF.METRICS_CONF.dump_file.empty())
+    {
+        metricsRegistry.startPeriodicDump(GRAPHER_CONF.METRICS_CONF.dump_file, GRAPHER_CONF.METRICS_CONF.dump_interval_secs);
+    }
     while(keep_running)
     {
+        // the load stats let ChronoVisor place new stories on the less loaded RecordingGroups
+        auto statsTime = std::chrono::steady_clock::now();
+        uint64_t ingestedEventCount = ingestionQueue.getIngestedEventCount();
+        uint64_t elapsedMillis = std::chrono::duration_cast<std::chrono::milliseconds>(statsTime - lastStatsTime).count();
+        loadStats.ingestionRate = (elapsedMillis == 0 ? 0 : (ingestedEventCount - lastIngestedEventCount) * 1000 / elapsedMillis);
+        loadStats.ingestionQueueDepth = ingestionQueue.getOrphanQueueSize();
+        loadStats.extractionQueueDepth = storyExtractor.getExtractionQueue().size();
+        loadStats.residentMemory = chronolog::getResidentMemory();
+        lastIngestedEventCount = ingestedEventCount;
+        lastStatsTime = statsTime;
+
+        grapherStatsMsg.setLoadStats(theDataStore.getActiveStoryCount(), loadStats);
+
+        activeStoriesGauge->set(grapherStatsMsg.getActiveStoryCount());
+        ingestionQueueGauge->set(loadStats.ingestionQueueDepth);
+        extractionQueueGauge->set(loadStats.extractionQueueDepth);
+        metricsRollup.clear();
+        metricsRegistry.getRollup(metricsRollup);
+        grapherStatsMsg.setMetricsRollup(metricsRollup);
+
         grapherRegistryClient->send_stats_msg(grapherStatsMsg);
+        if(++statsCycle % VISOR_REGISTRATION_REFRESH_CYCLES == 0)
+        {
+            grapherRegistryClient->send_register_msg(
+                    chronolog::GrapherRegistrationMsg(processIdCard, dataStoreServiceId));
+        }
         sleep(10);
     }
 
@@ -289,22 +384,31 @@ int main(int argc, char**argv)
     // Unregister from the chronoVisor so that no new story requests would be coming
     grapherRegistryClient->send_unregister_msg(processIdCard);
     delete grapherRegistryClient;
+    metricsRegistry.stopPeriodicDump();
 
     /// Stop services and shut down ____________________________________________________________________________________
     LOG_INFO("[ChronoGrapher] Initiating shutdown procedures.");
     // Stop recording events
     delete grapherRecordingService;
+    xstreamPlacement.shutdownHandlerXstreams();
     delete grapherDataAdminService;
     // Shutdown the Data Collection
     theDataStore.shutdownDataCollection();
     // Shutdown extraction module
     // drain extractionQueue and stop extraction xStreams
     storyExtractor.shutdownExtractionThreads();
+    if(chronolog::EventTracer::isEnabled() && !GRAPHER_CONF.TRACING_CONF.trace_file.empty())
+    {
+        chronolog::EventTracer::getInstance().dumpToFile(GRAPHER_CONF.TRACING_CONF.trace_file);
+    }
+    // stop forwarding StoryChunks to the Player
+    delete playerChunkForwarder;
     // these are not probably needed as thallium handles the engine finalization...
     //  recordingEngine.finalize();
     //  collectionEngine.finalize();
     delete recordingEngine;
     delete dataAdminEngine;
+    delete forwardingEngine;
     LOG_INFO("[ChronoGrapher] Shutdown completed. Exiting.");
     return exit_code;
 }
@@ -6,6 +6,7 @@
 #include <deque>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
 #include "chrono_monitor.h"
 
 #include "chronolog_types.h"
@@ -24,6 +25,7 @@ class ChunkIngestionQueue
 {
 public:
     ChunkIngestionQueue()
+        : ingestedEventCount(0)
     {}
 
     ~ChunkIngestionQueue()
@@ -54,6 +56,7 @@ public:
 
     void ingestStoryChunk(StoryChunk* chunk)
     {
+        ingestedEventCount.fetch_add(chunk->getEventCount(), std::memory_order_relaxed);
         LOG_DEBUG("[IngestionQueue] has {} StoryHandles; Received chunk for StoryID={} startTime {} eventCount{}", storyIngestionHandles.size(),
                                 chunk->getStoryId(), chunk->getStartTime(), chunk->getEventCount());
         auto ingestionHandle_iter = storyIngestionHandles.find(chunk->getStoryId());
@@ -105,6 +108,16 @@ public:
         LOG_WARNING("[IngestionQueue] has {} orphaned chunks", orphanQueue.size());
     }
 
+    // total number of events received in story chunks, used for the ingestion rate reported to ChronoVisor
+    uint64_t getIngestedEventCount() const
+    { return ingestedEventCount.load(std::memory_order_relaxed); }
+
+    size_t getOrphanQueueSize()
+    {
+        std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+        return orphanQueue.size();
+    }
+
     bool is_empty() const
     {
         return (orphanQueue.empty() && storyIngestionHandles.empty());
@@ -133,6 +146,8 @@ private:
     // chunks for unknown stories or late arriving chunks for closed stories will end up
     // in orphanQueue that we'll periodically try to drain into the DataStore
     std::deque <StoryChunk*> orphanQueue;
+
+    std::atomic <uint64_t> ingestedEventCount;
 };
 }
 
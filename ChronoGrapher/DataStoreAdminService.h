@@ -5,8 +5,10 @@
 #include <margo.h>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "chronolog_types.h"
+#include "StoryRecordingStartMsg.h"
 #include "GrapherDataStore.h"
 
 namespace tl = thallium;
@@ -52,6 +54,17 @@ public:
         request.respond(return_code);
     }
 
+    void StartStoryShardRecording(tl::request const &request, std::string const &chronicle_name
+                                  , std::string const &story_name, StoryId const &story_id, uint64_t start_time
+                                  , uint32_t shard_index)
+    {
+        LOG_INFO("[DataStoreAdminService] Starting Story Shard Recording: StoryName={}, StoryID={}, ShardIndex={}"
+                 , story_name, story_id, shard_index);
+        int return_code = theDataStore.startStoryRecording(chronicle_name, story_name, story_id, start_time
+                                                           , shard_index);
+        request.respond(return_code);
+    }
+
     void StopStoryRecording(tl::request const &request, StoryId const &story_id)
     {
         LOG_INFO("[DataStoreAdminService] Stopping Story Recording: StoryID={}", story_id);
@@ -59,6 +72,30 @@ public:
         request.respond(return_code);
     }
 
+    // batched notifications of the stories acquired or released together, one return code per story
+    void StartStoryRecordingBatch(tl::request const &request, std::vector <StoryRecordingStartMsg> const &stories)
+    {
+        LOG_INFO("[DataStoreAdminService] Starting Story Recording batch: StoryCount={}", stories.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(stories.size());
+        for(auto const &story: stories)
+        {
+            return_codes.push_back(theDataStore.startStoryRecording(story.chronicleName, story.storyName, story.storyId
+                                                                    , story.startTime, story.shardIndex));
+        }
+        request.respond(return_codes);
+    }
+
+    void StopStoryRecordingBatch(tl::request const &request, std::vector <StoryId> const &story_ids)
+    {
+        LOG_INFO("[DataStoreAdminService] Stopping Story Recording batch: StoryCount={}", story_ids.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(story_ids.size());
+        for(auto const &story_id: story_ids)
+        { return_codes.push_back(theDataStore.stopStoryRecording(story_id)); }
+        request.respond(return_codes);
+    }
+
 private:
     DataStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, GrapherDataStore &data_store_instance)
             : tl::provider <DataStoreAdminService>(tl_engine, service_provider_id), theDataStore(data_store_instance)
@@ -67,6 +104,9 @@ private:
         define("shutdown_data_collection", &DataStoreAdminService::shutdown_data_collection);
         define("start_story_recording", &DataStoreAdminService::StartStoryRecording);
         define("stop_story_recording", &DataStoreAdminService::StopStoryRecording);
+        define("start_story_recording_batch", &DataStoreAdminService::StartStoryRecordingBatch);
+        define("stop_story_recording_batch", &DataStoreAdminService::StopStoryRecordingBatch);
+        define("start_story_shard_recording", &DataStoreAdminService::StartStoryShardRecording);
         //set up callback for the case when the engine is being finalized while this provider is still alive
         get_engine().push_finalize_callback(this, [p = this]()
         { delete p; });
@@ -17,10 +17,11 @@ namespace tl = thallium;
 ////////////////////////
 
 int chronolog::GrapherDataStore::startStoryRecording(std::string const &chronicle, std::string const &story
-                                                    , chronolog::StoryId const &story_id, uint64_t start_time)
+                                                    , chronolog::StoryId const &story_id, uint64_t start_time
+                                                    , uint32_t shard_index)
 {
-    LOG_INFO("[GrapherDataStore] Start recording story: Chronicle={}, Story={}, StoryId={}"
-             , chronicle, story, story_id);
+    LOG_INFO("[GrapherDataStore] Start recording story: Chronicle={}, Story={}, StoryId={}, ShardIndex={}"
+             , chronicle, story, story_id, shard_index);
 
     // Get dataStoreMutex, check for story_id_presence & add new StoryPipeline if needed
     std::lock_guard storeLock(dataStoreMutex);
@@ -41,7 +42,7 @@ int chronolog::GrapherDataStore::startStoryRecording(std::string const &chronicl
 
     auto result = theMapOfStoryPipelines.emplace(
             std::pair <chl::StoryId, chl::StoryPipeline*>(story_id, new chl::StoryPipeline(theExtractionQueue, chronicle, story, story_id, start_time
-                                                        , story_chunk_duration_secs, acceptance_window_secs)));
+                                                        , story_chunk_duration_secs, acceptance_window_secs, shard_index)));
 
     if(result.second)
     {
@@ -89,6 +90,16 @@ int chronolog::GrapherDataStore::stopStoryRecording(chronolog::StoryId const &st
 
 ////////////////////////
 
+uint32_t chronolog::GrapherDataStore::getActiveStoryCount()
+{
+    std::lock_guard storeLock(dataStoreMutex);
+    if(theMapOfStoryPipelines.size() <= pipelinesWaitingForExit.size())
+    { return 0; }
+    return theMapOfStoryPipelines.size() - pipelinesWaitingForExit.size();
+}
+
+////////////////////////
+
 void chronolog::GrapherDataStore::collectIngestedEvents()
 {
     LOG_DEBUG("[GrapherDataStore] Initiating collection of ingested story chunks. Current state={}, Active "
@@ -180,7 +191,7 @@ void chronolog::GrapherDataStore::dataCollectionTask()
 }
 
 ////////////////////////
-void chronolog::GrapherDataStore::startDataCollection(int stream_count)
+void chronolog::GrapherDataStore::startDataCollection(int stream_count, XstreamPlacement*xstream_placement)
 {
     std::lock_guard storeLock(dataStoreStateMutex);
     if(is_running() || is_shutting_down())
@@ -195,7 +206,8 @@ void chronolog::GrapherDataStore::startDataCollection(int stream_count)
 
     for(int i = 0; i < stream_count; ++i)
     {
-        tl::managed <tl::xstream> es = tl::xstream::create();
+        tl::managed <tl::xstream> es = (xstream_placement != nullptr
+                                        ? xstream_placement->createXstream(XSTREAM_SEQUENCING) : tl::xstream::create());
         dataStoreStreams.push_back(std::move(es));
     }
 
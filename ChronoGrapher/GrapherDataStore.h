@@ -11,6 +11,7 @@
 #include "ChunkIngestionQueue.h"
 #include "StoryPipeline.h"
 #include "StoryChunkExtractionQueue.h"
+#include "XstreamPlacement.h"
 
 
 namespace chronolog
@@ -48,17 +49,23 @@ public:
     bool is_shutting_down() const
     { return (SHUTTING_DOWN == state); }
 
-    int startStoryRecording(ChronicleName const &, StoryName const &, StoryId const &, uint64_t start_time);
+    // shard_index > 0 is given for the shards of a sharded story, the pipeline stamps it on the extracted chunks
+    int startStoryRecording(ChronicleName const &, StoryName const &, StoryId const &, uint64_t start_time
+                            , uint32_t shard_index = 0);
 
     int stopStoryRecording(StoryId const &);
 
+    // stories being recorded, not counting the pipelines waiting for exit
+    uint32_t getActiveStoryCount();
+
     void collectIngestedEvents();
 
     void extractDecayedStoryChunks();
 
     void retireDecayedPipelines();
 
-    void startDataCollection(int stream_count);
+    // the data collection xstreams are pinned to the sequencing cores of the placement if it is given
+    void startDataCollection(int stream_count, XstreamPlacement*xstream_placement = nullptr);
 
     void shutdownDataCollection();
 
@@ -11,6 +11,8 @@
 #include "KeeperIdCard.h"
 #include "chronolog_types.h"
 #include "ChunkIngestionQueue.h"
+#include "StoryChunkExtractionQueue.h"
+#include "MetricsRegistry.h"
 
 namespace tl = thallium;
 
@@ -21,9 +23,12 @@ class GrapherRecordingService: public tl::provider <GrapherRecordingService>
 public:
     // RecordingService should be created on the heap not the stack thus the constructor is private...
     static GrapherRecordingService*
-    CreateRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, ChunkIngestionQueue &ingestion_queue)
+    CreateRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, ChunkIngestionQueue &ingestion_queue
+                           , StoryChunkExtractionQueue*player_forwarding_queue = nullptr
+                           , tl::pool const &handler_pool = tl::pool())
     {
-        return new GrapherRecordingService(tl_engine, service_provider_id, ingestion_queue);
+        return new GrapherRecordingService(tl_engine, service_provider_id, ingestion_queue, player_forwarding_queue
+                                           , handler_pool);
     }
 
     ~GrapherRecordingService()
@@ -51,14 +56,15 @@ public:
                       , tl::thread::self_id());
             tl::bulk local = tl_engine.expose(segments, tl::bulk_mode::write_only);
             LOG_DEBUG("[GrapherRecordingService] Bulk memory exposed, ThreadID={}", tl::thread::self_id());
+            start = std::chrono::high_resolution_clock::now();
             b.on(ep) >> local;
+            end = std::chrono::high_resolution_clock::now();
+            bulkTransferLatency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count());
             LOG_DEBUG("[GrapherRecordingService] Received {} bytes of StoryChunk data, ThreadID={}", b.size()
                       , tl::thread::self_id());
 
             StoryChunk*story_chunk = new StoryChunk();
-#ifndef NDEBUG
             start = std::chrono::high_resolution_clock::now();
-#endif
             int ret = deserializedWithCereal(&mem_vec[0], b.size()
                                              , *story_chunk);
             if(ret != chronolog::CL_SUCCESS)
@@ -71,8 +77,10 @@ public:
                 request.respond(ret);
                 return;
             }
-#ifndef NDEBUG
             end = std::chrono::high_resolution_clock::now();
+            deserializationLatency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count());
+            EventTracer::getInstance().recordStage(story_chunk->getTracedEvents(), "received");
+#ifndef NDEBUG
             LOG_INFO("[GrapherRecordingService] Deserialization took {} us, ThreadID={}",
                     std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count() / 1000.0
                      , tl::thread::self_id());
@@ -85,6 +93,13 @@ public:
             LOG_DEBUG("[GrapherRecordingService] StoryChunk recording RPC responded {}, ThreadID={}", b.size()
                       , tl::thread::self_id());
 
+            // hand a copy of the chunk over to the Player of this RecordingGroup before the original
+            // gets merged into the StoryPipeline, so that the recent events can be played back before they are archived
+            if(playerForwardingQueue != nullptr && !story_chunk->empty())
+            {
+                playerForwardingQueue->stashStoryChunk(new StoryChunk(*story_chunk));
+            }
+
             theIngestionQueue.ingestStoryChunk(story_chunk);
         }
         catch(std::bad_alloc const &ex)
@@ -97,10 +112,16 @@ public:
     }
 
 private:
-    GrapherRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, ChunkIngestionQueue &ingestion_queue)
+    GrapherRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, ChunkIngestionQueue &ingestion_queue
+                            , StoryChunkExtractionQueue*player_forwarding_queue, tl::pool const &handler_pool)
             : tl::provider <GrapherRecordingService>(tl_engine, service_provider_id), theIngestionQueue(ingestion_queue)
+            , playerForwardingQueue(player_forwarding_queue)
+            , bulkTransferLatency(MetricsRegistry::getInstance().getHistogram("grapher_chunk_bulk_transfer_nsecs"))
+            , deserializationLatency(MetricsRegistry::getInstance().getHistogram("grapher_chunk_deserialization_nsecs"))
     {
-        define("record_story_chunk", &GrapherRecordingService::record_story_chunk, tl::ignore_return_value());
+        // the null handler_pool leaves the handlers on the margo rpc xstream
+        define("record_story_chunk", &GrapherRecordingService::record_story_chunk, handler_pool
+               , tl::ignore_return_value());
         //set up callback for the case when the engine is being finalized while this provider is still alive
         get_engine().push_finalize_callback(this, [p = this]()
         { delete p; });
@@ -143,6 +164,9 @@ private:
     GrapherRecordingService &operator=(GrapherRecordingService const &) = delete;
 
     ChunkIngestionQueue &theIngestionQueue;
+    StoryChunkExtractionQueue*playerForwardingQueue;
+    LatencyHistogram*bulkTransferLatency;
+    LatencyHistogram*deserializationLatency;
 };
 
 }// namespace chronolog
@@ -6,9 +6,13 @@ namespace tl = thallium;
 namespace chronolog
 {
 HDF5FileChunkExtractor::HDF5FileChunkExtractor(const std::string &chrono_process_id_card
-                                               , const std::string &hdf5_files_root_dir)
+                                               , const std::string &hdf5_files_root_dir
+                                               , bool encode_record_templates)
                                                : chrono_process_id(chrono_process_id_card)
                                                , rootDirectory(hdf5_files_root_dir)
+                                               , encodeRecordTemplates(encode_record_templates)
+                                               , writeLatency(MetricsRegistry::getInstance().getHistogram(
+                                                       "grapher_hdf5_write_nsecs"))
 {}
 
 HDF5FileChunkExtractor::~HDF5FileChunkExtractor()
@@ -19,8 +23,12 @@ HDF5FileChunkExtractor::~HDF5FileChunkExtractor()
 int HDF5FileChunkExtractor::processStoryChunk(StoryChunk *story_chunk)
 {
     LOG_INFO("[HDF5FileChunkExtractor] Writing StoryChunk...");
-    StoryChunkWriter chunkWriter(rootDirectory, "story_chunks", "data");
-    hsize_t size = chunkWriter.writeStoryChunk(*story_chunk);
+    hsize_t size = 0;
+    {
+        ScopedLatency write_latency(writeLatency);
+        StoryChunkWriter chunkWriter(rootDirectory, "story_chunks", "data", encodeRecordTemplates);
+        size = chunkWriter.writeStoryChunk(*story_chunk);
+    }
     int ret = (size == 0) ? chronolog::CL_ERR_UNKNOWN : chronolog::CL_SUCCESS;
     if(size == 0)
     {
@@ -29,6 +37,7 @@ int HDF5FileChunkExtractor::processStoryChunk(StoryChunk *story_chunk)
     else
     {
         LOG_INFO("[HDF5FileChunkExtractor] StoryChunk written to file.");
+        EventTracer::getInstance().recordStage(story_chunk->getTracedEvents(), "archived");
     }
     LOG_DEBUG("[HDF5FileChunkExtractor] Finished processing StoryChunk.");
     return ret;
@@ -2,6 +2,7 @@
 #define CHRONOLOG_HDF5_FILE_CHUNK_EXTRACTOR_H
 
 #include "StoryChunkExtractor.h"
+#include "MetricsRegistry.h"
 
 namespace chronolog
 {
@@ -9,7 +10,9 @@ namespace chronolog
 class HDF5FileChunkExtractor: public StoryChunkExtractorBase
 {
 public:
-    HDF5FileChunkExtractor(std::string const &chrono_process_id_card, std::string const &hdf5_files_root_dir);
+    // encode_record_templates archives the log records with the record template dictionary of every chunk
+    HDF5FileChunkExtractor(std::string const &chrono_process_id_card, std::string const &hdf5_files_root_dir
+                           , bool encode_record_templates = false);
 
     ~HDF5FileChunkExtractor();
 
@@ -18,6 +21,8 @@ public:
 private:
     std::string chrono_process_id;
     std::string rootDirectory;
+    bool encodeRecordTemplates;
+    LatencyHistogram *writeLatency;
 };
 
 } // chronolog
@@ -0,0 +1,101 @@
+#include <thallium/serialization/stl/vector.hpp>
+#include <cereal/archives/binary.hpp>
+
+#include "chrono_monitor.h"
+#include "chronolog_errcode.h"
+#include "PlayerChunkForwarder.h"
+
+namespace tl = thallium;
+namespace chl = chronolog;
+
+chronolog::PlayerChunkForwarder::PlayerChunkForwarder(tl::engine &tl_engine, chl::ServiceId const &player_drain_service_id)
+        : forwarding_engine(tl_engine)
+        , player_service_id(player_drain_service_id)
+{
+    drain_to_player = forwarding_engine.define("record_story_chunk");
+
+    // the Player might not be up yet, so the lookup failure is not fatal here;
+    // we'll retry the lookup when the first chunk is forwarded
+    lookupPlayerService();
+
+    LOG_DEBUG("[PlayerChunkForwarder] created forwarder for Player service {}", chl::to_string(player_service_id));
+}
+
+chronolog::PlayerChunkForwarder::~PlayerChunkForwarder()
+{
+    LOG_DEBUG("[PlayerChunkForwarder] Destructor called for Player service {}", chl::to_string(player_service_id));
+    shutdownExtractionThreads();
+    drain_to_player.deregister();
+}
+
+bool chronolog::PlayerChunkForwarder::lookupPlayerService()
+{
+    if(!player_service_handle.is_null())
+    { return true; }
+
+    try
+    {
+        std::string service_addr_string;
+        player_service_id.get_service_as_string(service_addr_string);
+        player_service_handle = tl::provider_handle(forwarding_engine.lookup(service_addr_string)
+                                                    , player_service_id.getProviderId());
+    }
+    catch(tl::exception const &ex)
+    {
+        LOG_WARNING("[PlayerChunkForwarder] Failed to lookup Player service {} : {}", chl::to_string(player_service_id)
+                    , ex.what());
+        player_service_handle = tl::provider_handle();
+    }
+
+    return !player_service_handle.is_null();
+}
+
+int chronolog::PlayerChunkForwarder::processStoryChunk(chl::StoryChunk*story_chunk)
+{
+    if(!lookupPlayerService())
+    {
+        LOG_WARNING("[PlayerChunkForwarder] Player service {} is unreachable, discarding StoryChunk StoryId {} StartTime {}"
+                    , chl::to_string(player_service_id), story_chunk->getStoryId(), story_chunk->getStartTime());
+        return chronolog::CL_SUCCESS;
+    }
+
+    try
+    {
+        std::ostringstream oss(std::ios::binary);
+        cereal::BinaryOutputArchive oarchive(oss);
+        oarchive(*story_chunk);
+        std::string serialized_story_chunk = oss.str();
+
+        std::vector <std::pair <void*, std::size_t>> segments(1);
+        segments[0].first = (void*)(serialized_story_chunk.data());
+        segments[0].second = serialized_story_chunk.size();
+        tl::bulk tl_bulk = forwarding_engine.expose(segments, tl::bulk_mode::read_only);
+
+        size_t bytes_transfered = drain_to_player.on(player_service_handle)(tl_bulk);
+
+        if(bytes_transfered == serialized_story_chunk.size())
+        {
+            LOG_DEBUG("[PlayerChunkForwarder] Forwarded StoryChunk StoryId {} StartTime {} eventCount {}"
+                      , story_chunk->getStoryId(), story_chunk->getStartTime(), story_chunk->getEventCount());
+            return chronolog::CL_SUCCESS;
+        }
+        LOG_WARNING("[PlayerChunkForwarder] Player service {} rejected StoryChunk StoryId {} StartTime {} response {}"
+                    , chl::to_string(player_service_id), story_chunk->getStoryId(), story_chunk->getStartTime()
+                    , bytes_transfered);
+    }
+    catch(tl::exception const &ex)
+    {
+        LOG_WARNING("[PlayerChunkForwarder] Thallium exception while forwarding StoryChunk to {}: {}"
+                    , chl::to_string(player_service_id), ex.what());
+        // force a new lookup next time in case the Player has been restarted
+        player_service_handle = tl::provider_handle();
+    }
+    catch(cereal::Exception const &ex)
+    {
+        LOG_ERROR("[PlayerChunkForwarder] Cereal exception while serializing StoryChunk: {}", ex.what());
+    }
+
+    // the StoryChunk is persisted by the Grapher regardless,
+    // so we discard it rather than let the forwarding queue grow while the Player is away
+    return chronolog::CL_SUCCESS;
+}
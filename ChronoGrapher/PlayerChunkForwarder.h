@@ -0,0 +1,45 @@
+#ifndef PLAYER_CHUNK_FORWARDER_H
+#define PLAYER_CHUNK_FORWARDER_H
+
+#include <thallium.hpp>
+
+#include "chronolog_types.h"
+#include "ServiceId.h"
+#include "StoryChunkExtractor.h"
+
+namespace tl = thallium;
+
+namespace chronolog
+{
+
+// PlayerChunkForwarder forwards copies of the StoryChunks received by the Grapher
+// to the Player of the same RecordingGroup so that the Player can serve playback requests
+// for the recent part of the story that is not yet in the archive.
+// Forwarding is best effort: the archive remains the source of truth,
+// so a chunk that can't be delivered to the Player is discarded rather than retried.
+
+class PlayerChunkForwarder: public StoryChunkExtractorBase
+{
+public:
+    PlayerChunkForwarder(tl::engine &forwarding_engine, ServiceId const &player_drain_service_id);
+
+    ~PlayerChunkForwarder();
+
+    int processStoryChunk(StoryChunk*story_chunk) override;
+
+private:
+    PlayerChunkForwarder(PlayerChunkForwarder const &) = delete;
+
+    PlayerChunkForwarder &operator=(PlayerChunkForwarder const &) = delete;
+
+    bool lookupPlayerService();
+
+    tl::engine &forwarding_engine;
+    ServiceId player_service_id;
+    tl::remote_procedure drain_to_player;
+    tl::provider_handle player_service_handle;
+};
+
+}
+
+#endif
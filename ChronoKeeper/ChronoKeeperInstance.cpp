@@ -1,12 +1,15 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <algorithm>
+#include <map>
 
 #include <signal.h>
 
 #include "KeeperRecordingService.h"
 #include "KeeperRegClient.h"
 #include "IngestionQueue.h"
+#include "KeeperAdmissionControl.h"
 #include "StoryChunkExtractionQueue.h"
 #include "StoryChunkExtractor.h"
 #include "KeeperDataStore.h"
@@ -16,6 +19,16 @@
 #include "CSVFileChunkExtractor.h"
 #include "cmd_arg_parse.h"
 #include "StoryChunkExtractorRDMA.h"
+#include "MetricsRegistry.h"
+#include "EventTracer.h"
+#include "XstreamPlacement.h"
+
+// number of the hottest stories reported with each stats message
+#define MAX_REPORTED_HOT_STORIES 8
+
+// the registration is re-sent every this many stats messages, which re-registers the process
+// with the ChronoVisor restarted from its metadata store
+#define VISOR_REGISTRATION_REFRESH_CYCLES 6
 
 // we will be using a combination of the uint32_t representation of the service IP address
 // and uint16_t representation of the port number
@@ -79,11 +92,14 @@ int main(int argc, char**argv)
                                                        , KEEPER_CONF.LOG_CONF.LOGNAME
                                                        , KEEPER_CONF.LOG_CONF.LOGFILESIZE
                                                        , KEEPER_CONF.LOG_CONF.LOGFILENUM
-                                                       , KEEPER_CONF.LOG_CONF.FLUSHLEVEL);
+                                                       , KEEPER_CONF.LOG_CONF.FLUSHLEVEL
+                                                       , KEEPER_CONF.LOG_CONF.ASYNC);
     if(result == 1)
     {
         exit(EXIT_FAILURE);
     }
+    chronolog::chrono_monitor::setModuleLevels(KEEPER_CONF.LOG_CONF.MODULE_LEVELS);
+    chronolog::EventTracer::getInstance().configure("ChronoKeeper", KEEPER_CONF.TRACING_CONF.sample_every);
 
     LOG_INFO("Running ChronoKeeper Server.");
     LOG_INFO("[ChronoKeeper] Configuration {}", KEEPER_CONF.to_String());
@@ -147,6 +163,16 @@ int main(int argc, char**argv)
 
     // Instantiate ChronoKeeper MemoryDataStore & ExtractorModule
     chronolog::IngestionQueue ingestionQueue;
+    // event rate limits of the stories of the chronicles that ask for them
+    chronolog::KeeperAdmissionControl admissionControl;
+    // xstreams of the recording handlers, data collection and extraction pinned to their configured cores;
+    // declared ahead of the modules whose xstreams run its pools
+    chronolog::XstreamPlacement xstreamPlacement;
+    if(xstreamPlacement.initialize(KEEPER_CONF.CORE_PLACEMENT_CONF) != chronolog::CL_SUCCESS)
+    {
+        LOG_CRITICAL("[ChronoKeeperInstance] Invalid CorePlacement configuration; exiting");
+        return (-1);
+    }
     std::string keeper_csv_files_directory = KEEPER_CONF.EXTRACTOR_CONF.story_files_dir;
     // Instantiate KeeperGrapherDrainService
     tl::engine*extractionEngine = nullptr;
@@ -210,7 +236,8 @@ int main(int argc, char**argv)
                   , keeper_group_id, s3.str(), datastore_service_provider_id);
         keeperDataAdminService = chronolog::DataStoreAdminService::CreateDataStoreAdminService(*dataAdminEngine
                                                                                                , datastore_service_provider_id
-                                                                                               , theDataStore);
+                                                                                               , theDataStore
+                                                                                               , admissionControl);
     }
     catch(tl::exception const &)
     {
@@ -240,9 +267,13 @@ int main(int argc, char**argv)
         s1 << recordingEngine->self();
         LOG_INFO("[ChronoKeeperInstance] GroupID={} starting KeeperRecordingService at {} with provider_id {}"
                  , keeper_group_id, s1.str(), recording_service_provider_id);
+        tl::pool recording_handler_pool = xstreamPlacement.createHandlerXstreams(chronolog::XSTREAM_RPC);
         keeperRecordingService = chronolog::KeeperRecordingService::CreateKeeperRecordingService(*recordingEngine
                                                                                                  , recording_service_provider_id
-                                                                                                 , ingestionQueue);
+                                                                                                 , ingestionQueue
+                                                                                                 , admissionControl
+                                                                                                 , recording_handler_pool
+                                                                                                 , &xstreamPlacement);
     }
     catch(tl::exception const &)
     {
@@ -301,9 +332,9 @@ int main(int argc, char**argv)
     // services are successfully created and keeper process had registered with ChronoVisor
     // start all dataCollection and Extraction threads...
     tl::abt scope;
-    theDataStore.startDataCollection(3);
+    theDataStore.startDataCollection(3, &xstreamPlacement);
     // start extraction streams & threads
-    storyExtractor.startExtractionThreads(2);
+    storyExtractor.startExtractionThreads(2, &xstreamPlacement);
 
 
     /// Main loop for sending stats message until receiving SIGTERM ____________________________________________________
@@ -311,9 +342,72 @@ int main(int argc, char**argv)
     // main thread would be sending stats message until keeper process receives
     // sigterm signal
     chronolog::KeeperStatsMsg keeperStatsMsg(keeperIdCard);
+    chronolog::ProcessLoadStats loadStats;
+    loadStats.capacity = chronolog::getProcessCapacity();
+    uint64_t lastIngestedEventCount = ingestionQueue.getIngestedEventCount();
+    uint64_t lastThrottledEventCount = admissionControl.getThrottledEventCount();
+    std::map<chronolog::StoryId, uint64_t> lastStoryEventCounts;
+    std::map<chronolog::StoryId, uint64_t> storyEventCounts;
+    std::vector<chronolog::StoryLoad> hotStories;
+    auto lastStatsTime = std::chrono::steady_clock::now();
+    uint64_t statsCycle = 0;
+
+    chronolog::MetricsRegistry & metricsRegistry = chronolog::MetricsRegistry::getInstance();
+    chronolog::MetricsGauge* activeStoriesGauge = metricsRegistry.getGauge("keeper_active_stories");
+    chronolog::MetricsGauge* ingestionQueueGauge = metricsRegistry.getGauge("keeper_ingestion_queue_depth");
+    chronolog::MetricsGauge* extractionQueueGauge = metricsRegistry.getGauge("keeper_extraction_queue_depth");
+    std::vector<chronolog::MetricSummary> metricsRollup;
+    if(!KEEPER_CONF.METRICS_CONF.dump_file.empty())
+    {
+        metricsRegistry.startPeriodicDump(KEEPER_CONF.METRICS_CONF.dump_file, KEEPER_CONF.METRICS_CONF.dump_interval_secs);
+    }
     while(keep_running)
     {
+        // the load stats let ChronoVisor place new stories on the less loaded RecordingGroups
+        auto statsTime = std::chrono::steady_clock::now();
+        uint64_t ingestedEventCount = ingestionQueue.getIngestedEventCount();
+        uint64_t elapsedMillis = std::chrono::duration_cast<std::chrono::milliseconds>(statsTime - lastStatsTime).count();
+        loadStats.ingestionRate = (elapsedMillis == 0 ? 0 : (ingestedEventCount - lastIngestedEventCount) * 1000 / elapsedMillis);
+        uint64_t throttledEventCount = admissionControl.getThrottledEventCount();
+        loadStats.throttleRate = (elapsedMillis == 0 ? 0 : (throttledEventCount - lastThrottledEventCount) * 1000 / elapsedMillis);
+        lastThrottledEventCount = throttledEventCount;
+        loadStats.ingestionQueueDepth = ingestionQueue.getOrphanQueueSize();
+        loadStats.extractionQueueDepth = storyExtractor.getExtractionQueue().size();
+        loadStats.residentMemory = chronolog::getResidentMemory();
+        lastIngestedEventCount = ingestedEventCount;
+        lastStatsTime = statsTime;
+
+        // the hottest stories are the candidates ChronoVisor would migrate off an overloaded RecordingGroup
+        ingestionQueue.getStoryEventCounts(storyEventCounts);
+        hotStories.clear();
+        for(auto const& story_count: storyEventCounts)
+        {
+            auto last_iter = lastStoryEventCounts.find(story_count.first);
+            uint64_t story_events = story_count.second - (last_iter == lastStoryEventCounts.end() ? 0 : (*last_iter).second);
+            if(story_events > 0 && elapsedMillis > 0)
+            { hotStories.push_back(chronolog::StoryLoad{story_count.first, story_events * 1000 / elapsedMillis}); }
+        }
+        std::sort(hotStories.begin(), hotStories.end(), [](chronolog::StoryLoad const& a, chronolog::StoryLoad const& b)
+                  { return a.ingestionRate > b.ingestionRate; });
+        if(hotStories.size() > MAX_REPORTED_HOT_STORIES)
+        { hotStories.resize(MAX_REPORTED_HOT_STORIES); }
+        lastStoryEventCounts.swap(storyEventCounts);
+        keeperStatsMsg.setHotStories(hotStories);
+
+        keeperStatsMsg.setLoadStats(theDataStore.getActiveStoryCount(), loadStats);
+
+        activeStoriesGauge->set(keeperStatsMsg.getActiveStoryCount());
+        ingestionQueueGauge->set(loadStats.ingestionQueueDepth);
+        extractionQueueGauge->set(loadStats.extractionQueueDepth);
+        metricsRollup.clear();
+        metricsRegistry.getRollup(metricsRollup);
+        keeperStatsMsg.setMetricsRollup(metricsRollup);
+
         keeperRegistryClient->send_stats_msg(keeperStatsMsg);
+        if(++statsCycle % VISOR_REGISTRATION_REFRESH_CYCLES == 0)
+        {
+            keeperRegistryClient->send_register_msg(chronolog::KeeperRegistrationMsg(keeperIdCard, dataStoreServiceId));
+        }
         sleep(10);
     }
 
@@ -321,17 +415,23 @@ int main(int argc, char**argv)
     // Unregister from the chronoVisor so that no new story requests would be coming
     keeperRegistryClient->send_unregister_msg(keeperIdCard);
     delete keeperRegistryClient;
+    metricsRegistry.stopPeriodicDump();
 
     /// Stop services and shut down ____________________________________________________________________________________
     LOG_INFO("[ChronoKeeperInstance] Initiating shutdown procedures.");
     // Stop recording events
     delete keeperRecordingService;
+    xstreamPlacement.shutdownHandlerXstreams();
     delete keeperDataAdminService;
     // Shutdown the Data Collection
     theDataStore.shutdownDataCollection();
     // Shutdown extraction module
     // drain extractionQueue and stop extraction xStreams
     storyExtractor.shutdownExtractionThreads();
+    if(chronolog::EventTracer::isEnabled() && !KEEPER_CONF.TRACING_CONF.trace_file.empty())
+    {
+        chronolog::EventTracer::getInstance().dumpToFile(KEEPER_CONF.TRACING_CONF.trace_file);
+    }
     // these are not probably needed as thallium handles the engine finalization...
     //  recordingEngine.finalize();
     //  collectionEngine.finalize();
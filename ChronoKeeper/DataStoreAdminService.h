@@ -5,9 +5,12 @@
 #include <margo.h>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "chronolog_types.h"
+#include "StoryRecordingStartMsg.h"
 #include "KeeperDataStore.h"
+#include "KeeperAdmissionControl.h"
 
 namespace tl = thallium;
 
@@ -19,9 +22,10 @@ class DataStoreAdminService: public tl::provider <DataStoreAdminService>
 public:
     // Service should be created on the heap not the stack thus the constructor is private...
     static DataStoreAdminService*
-    CreateDataStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, KeeperDataStore &dataStoreInstance)
+    CreateDataStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, KeeperDataStore &dataStoreInstance
+                                , KeeperAdmissionControl &admission_control)
     {
-        return new DataStoreAdminService(tl_engine, service_provider_id, dataStoreInstance);
+        return new DataStoreAdminService(tl_engine, service_provider_id, dataStoreInstance, admission_control);
     }
 
     ~DataStoreAdminService()
@@ -52,21 +56,77 @@ public:
         request.respond(return_code);
     }
 
+    // the story of the chronicle with the event rate limits
+    void StartLimitedStoryRecording(tl::request const &request, std::string const &chronicle_name
+                                    , std::string const &story_name, StoryId const &story_id, uint64_t start_time
+                                    , StoryAdmissionLimits const &admission_limits)
+    {
+        LOG_INFO("[DataStoreAdminService] Starting Story Recording: StoryName={}, StoryID={}, Limits={}", story_name
+                 , story_id, to_string(admission_limits));
+        int return_code = theDataStore.startStoryRecording(chronicle_name, story_name, story_id, start_time);
+        if(return_code == CL_SUCCESS)
+        { theAdmissionControl.setStoryLimits(story_id, admission_limits); }
+        request.respond(return_code);
+    }
+
     void StopStoryRecording(tl::request const &request, StoryId const &story_id)
     {
         LOG_INFO("[DataStoreAdminService] Stopping Story Recording: StoryID={}", story_id);
+        theAdmissionControl.removeStory(story_id);
         int return_code = theDataStore.stopStoryRecording(story_id);
         request.respond(return_code);
     }
 
+    // batched notifications of the stories acquired or released together, one return code per story
+    void StartStoryRecordingBatch(tl::request const &request, std::vector <StoryRecordingStartMsg> const &stories)
+    {
+        LOG_INFO("[DataStoreAdminService] Starting Story Recording batch: StoryCount={}", stories.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(stories.size());
+        for(auto const &story: stories)
+        {
+            return_codes.push_back(theDataStore.startStoryRecording(story.chronicleName, story.storyName, story.storyId
+                                                                    , story.startTime));
+            if(return_codes.back() == CL_SUCCESS)
+            { theAdmissionControl.setStoryLimits(story.storyId, story.admissionLimits); }
+        }
+        request.respond(return_codes);
+    }
+
+    void StopStoryRecordingBatch(tl::request const &request, std::vector <StoryId> const &story_ids)
+    {
+        LOG_INFO("[DataStoreAdminService] Stopping Story Recording batch: StoryCount={}", story_ids.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(story_ids.size());
+        for(auto const &story_id: story_ids)
+        {
+            theAdmissionControl.removeStory(story_id);
+            return_codes.push_back(theDataStore.stopStoryRecording(story_id));
+        }
+        request.respond(return_codes);
+    }
+
+    void MigrateStoryRecording(tl::request const &request, StoryId const &story_id)
+    {
+        LOG_INFO("[DataStoreAdminService] Migrating Story Recording: StoryID={}", story_id);
+        int return_code = theDataStore.migrateStoryRecording(story_id);
+        request.respond(return_code);
+    }
+
 private:
-    DataStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, KeeperDataStore &data_store_instance)
+    DataStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, KeeperDataStore &data_store_instance
+                          , KeeperAdmissionControl &admission_control)
             : tl::provider <DataStoreAdminService>(tl_engine, service_provider_id), theDataStore(data_store_instance)
+            , theAdmissionControl(admission_control)
     {
         define("collection_service_available", &DataStoreAdminService::collection_service_available);
         define("shutdown_data_collection", &DataStoreAdminService::shutdown_data_collection);
         define("start_story_recording", &DataStoreAdminService::StartStoryRecording);
+        define("start_limited_story_recording", &DataStoreAdminService::StartLimitedStoryRecording);
         define("stop_story_recording", &DataStoreAdminService::StopStoryRecording);
+        define("start_story_recording_batch", &DataStoreAdminService::StartStoryRecordingBatch);
+        define("stop_story_recording_batch", &DataStoreAdminService::StopStoryRecordingBatch);
+        define("migrate_story_recording", &DataStoreAdminService::MigrateStoryRecording);
         //set up callback for the case when the engine is being finalized while this provider is still alive
         get_engine().push_finalize_callback(this, [p = this]()
         { delete p; });
@@ -81,6 +141,7 @@ private:
     DataStoreAdminService &operator=(DataStoreAdminService const &) = delete;
 
     KeeperDataStore &theDataStore;
+    KeeperAdmissionControl &theAdmissionControl;
 };
 
 }// namespace chronolog
@@ -4,12 +4,17 @@
 
 #include <iostream>
 #include <deque>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <atomic>
 #include "chrono_monitor.h"
 
 #include "chronolog_types.h"
+#include "chronolog_errcode.h"
 #include "StoryIngestionHandle.h"
+#include "EventTracer.h"
 
 //
 // IngestionQueue is a funnel into the MemoryDataStore
@@ -25,6 +30,9 @@ class IngestionQueue
 {
 public:
     IngestionQueue()
+        : moduleLogger(chrono_monitor::getModuleLogger("IngestionQueue"))
+        , ingestedEventCount(0)
+        , migratedStoryCount(0)
     {}
 
     ~IngestionQueue()
@@ -42,6 +50,8 @@ public:
     void removeIngestionHandle(StoryId const &story_id)
     {
         std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+        if(migratedStories.erase(story_id))
+        { migratedStoryCount.fetch_sub(1, std::memory_order_relaxed); }
         if(storyIngestionHandles.erase(story_id))
         {
             LOG_DEBUG("[IngestionQueue] Removed handle for StoryID={}. Current handle MapSize={}", story_id
@@ -53,12 +63,24 @@ public:
         }
     }
 
-    void ingestLogEvent(LogEvent const &event)
+    // the story moved to another RecordingGroup: events keep being ingested until the handle is removed,
+    // but the clients are told to switch to the new group's keepers
+    void setStoryMigrated(StoryId const &story_id, bool migrated)
     {
-        std::stringstream ss;
-        ss << event;
-        LOG_DEBUG("[IngestionQueue] Received event for StoryID={}: Event Details={}, HandleMapSize={}", event.storyId
-             , ss.str(), storyIngestionHandles.size());
+        std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+        if(migrated && migratedStories.insert(story_id).second)
+        { migratedStoryCount.fetch_add(1, std::memory_order_relaxed); }
+        else if(!migrated && migratedStories.erase(story_id))
+        { migratedStoryCount.fetch_sub(1, std::memory_order_relaxed); }
+    }
+
+    // returns CL_ERR_STORY_MIGRATED if the event was ingested for the story that has been migrated
+    int ingestLogEvent(LogEvent const &event)
+    {
+        ingestedEventCount.fetch_add(1, std::memory_order_relaxed);
+        // the event is only stringified if the IngestionQueue module logs at debug level
+        LOG_MODULE_DEBUG(moduleLogger, "[IngestionQueue] Received event for StoryID={}: Event Details={}, HandleMapSize={}"
+             , event.storyId, event.toString(), storyIngestionHandles.size());
         auto ingestionHandle_iter = storyIngestionHandles.find(event.storyId);
         if(ingestionHandle_iter == storyIngestionHandles.end())
         {
@@ -71,6 +93,16 @@ public:
             //individual StoryIngestionHandle has its own mutex
             (*ingestionHandle_iter).second->ingestEvent(event);
         }
+        if(EventTracer::isEnabled())
+        { EventTracer::getInstance().recordStage(event, "ingested"); }
+
+        if(migratedStoryCount.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+            if(migratedStories.find(event.storyId) != migratedStories.end())
+            { return chronolog::CL_ERR_STORY_MIGRATED; }
+        }
+        return chronolog::CL_SUCCESS;
     }
 
     void drainOrphanEvents()
@@ -99,6 +131,25 @@ public:
         LOG_DEBUG("[IngestionQueue] Drained {} orphan events into known handles.", orphanEventQueue.size());
     }
 
+    // total number of events received, used for the ingestion rate reported to ChronoVisor
+    uint64_t getIngestedEventCount() const
+    { return ingestedEventCount.load(std::memory_order_relaxed); }
+
+    // number of events ingested so far for each of the stories being recorded
+    void getStoryEventCounts(std::map <StoryId, uint64_t> &story_event_counts)
+    {
+        story_event_counts.clear();
+        std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+        for(auto const &handle_pair: storyIngestionHandles)
+        { story_event_counts[handle_pair.first] = handle_pair.second->getIngestedEventCount(); }
+    }
+
+    size_t getOrphanQueueSize()
+    {
+        std::lock_guard <std::mutex> lock(ingestionQueueMutex);
+        return orphanEventQueue.size();
+    }
+
     bool is_empty() const
     {
         return (orphanEventQueue.empty() && storyIngestionHandles.empty());
@@ -121,6 +172,8 @@ private:
 
     IngestionQueue &operator=(IngestionQueue const &) = delete;
 
+    spdlog::logger &moduleLogger;   // the per event logging goes through the IngestionQueue module logger
+
     std::mutex ingestionQueueMutex;
     std::unordered_map <StoryId, StoryIngestionHandle*> storyIngestionHandles;
 
@@ -128,6 +181,12 @@ private:
     // in orphanEventQueue that we'll periodically try to drain into the DataStore
     std::deque <LogEvent> orphanEventQueue;
 
+    std::atomic <uint64_t> ingestedEventCount;
+
+    // stories migrated to another RecordingGroup, the atomic count keeps the common case lock free
+    std::unordered_set <StoryId> migratedStories;
+    std::atomic <uint32_t> migratedStoryCount;
+
     //Timer to triger periodic attempt to drain orphanEventQueue and collect/log statistics
 };
 }
@@ -0,0 +1,207 @@
+#ifndef KEEPER_ADMISSION_CONTROL_H
+#define KEEPER_ADMISSION_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "chrono_monitor.h"
+#include "chronolog_types.h"
+#include "MetricsRegistry.h"
+#include "StoryAdmissionLimits.h"
+#include "TokenBucket.h"
+
+// the client bucket not used for this long is dropped once it has refilled, the client gets a full one if it comes back
+#define CLIENT_BUCKET_IDLE_SECS 60
+
+namespace chronolog
+{
+
+// KeeperAdmissionControl holds the token buckets of the stories recorded with the event rate limits:
+// one bucket for the story and one for every client writing into it.
+// The event is admitted if both the client's and the story's buckets have a token left,
+// the events of the stories without the limits are admitted without taking any lock.
+// The buckets are local to this Keeper: every Keeper recording the story admits up to the story rate,
+// so the story as a whole is limited to the story rate times the number of its recording Keepers;
+// the client sends its events to one Keeper at a time, so the client rate holds for the client as a whole.
+// The buckets of the clients that stopped writing are dropped every CLIENT_BUCKET_IDLE_SECS.
+
+class KeeperAdmissionControl
+{
+public:
+    KeeperAdmissionControl()
+        : limitedStoryCount(0)
+        , throttledEventCount(0)
+        , throttledEvents(MetricsRegistry::getInstance().getCounter("keeper_throttled_event_total"))
+    {}
+
+    ~KeeperAdmissionControl()
+    {
+        for(auto &story_admission: limitedStories)
+        { delete story_admission.second; }
+    }
+
+    void setStoryLimits(StoryId const &story_id, StoryAdmissionLimits const &limits)
+    {
+        if(limits.isUnlimited())
+        { return; }
+
+        std::unique_lock <std::shared_mutex> lock(admissionMutex);
+        auto story_iter = limitedStories.find(story_id);
+        if(story_iter != limitedStories.end())
+        {
+            // the story is started again with the same chronicle limits, the buckets keep their tokens
+            return;
+        }
+        limitedStories[story_id] = new StoryAdmission(limits);
+        limitedStoryCount.store(limitedStories.size(), std::memory_order_release);
+        LOG_INFO("[KeeperAdmissionControl] Story {} is recorded with the event rate limits {}", story_id
+                 , to_string(limits));
+    }
+
+    void removeStory(StoryId const &story_id)
+    {
+        std::unique_lock <std::shared_mutex> lock(admissionMutex);
+        auto story_iter = limitedStories.find(story_id);
+        if(story_iter == limitedStories.end())
+        { return; }
+        if((*story_iter).second->throttledEventCount > 0)
+        {
+            LOG_INFO("[KeeperAdmissionControl] Story {} had {} events throttled", story_id
+                     , (*story_iter).second->throttledEventCount);
+        }
+        delete (*story_iter).second;
+        limitedStories.erase(story_iter);
+        limitedStoryCount.store(limitedStories.size(), std::memory_order_release);
+    }
+
+    // returns false if the event is over the client or the story event rate
+    bool admitEvent(LogEvent const &log_event)
+    {
+        if(limitedStoryCount.load(std::memory_order_acquire) == 0)
+        { return true; }
+
+        return admitEvent(log_event, std::chrono::duration_cast <std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // now is the steady clock time in nanoseconds
+    bool admitEvent(LogEvent const &log_event, uint64_t now)
+    {
+        if(limitedStoryCount.load(std::memory_order_acquire) == 0)
+        { return true; }
+
+        std::shared_lock <std::shared_mutex> lock(admissionMutex);
+        auto story_iter = limitedStories.find(log_event.storyId);
+        if(story_iter == limitedStories.end())
+        { return true; }
+
+        StoryAdmission &story_admission = *((*story_iter).second);
+
+        std::lock_guard <std::mutex> story_lock(story_admission.storyMutex);
+        if(now >= story_admission.lastIdleSweepTime + CLIENT_BUCKET_IDLE_SECS * 1000000000ULL)
+        { dropIdleClientBuckets(story_admission, now); }
+
+        TokenBucket &story_bucket = story_admission.storyBucket;
+        auto client_iter = story_admission.clientBuckets.find(log_event.getClientId());
+        if(client_iter == story_admission.clientBuckets.end())
+        {
+            client_iter = story_admission.clientBuckets.emplace(log_event.getClientId(), TokenBucket(
+                    story_admission.limits.clientEventRate, burstSize(story_admission.limits.clientEventRate
+                                                                      , story_admission.limits.burstMillis))).first;
+        }
+        TokenBucket &client_bucket = (*client_iter).second;
+
+        // the tokens are only taken if both buckets admit the event
+        story_bucket.refill(now);
+        client_bucket.refill(now);
+        if(!story_bucket.hasTokens() || !client_bucket.hasTokens())
+        {
+            story_admission.throttledEventCount++;
+            throttledEventCount.fetch_add(1, std::memory_order_relaxed);
+            throttledEvents->add();
+            return false;
+        }
+        story_bucket.consume();
+        client_bucket.consume();
+        return true;
+    }
+
+    // total number of events throttled, reported in the Keeper stats
+    uint64_t getThrottledEventCount() const
+    { return throttledEventCount.load(std::memory_order_relaxed); }
+
+    // number of the clients of the story with a bucket of their own
+    size_t getClientBucketCount(StoryId const &story_id)
+    {
+        std::shared_lock <std::shared_mutex> lock(admissionMutex);
+        auto story_iter = limitedStories.find(story_id);
+        if(story_iter == limitedStories.end())
+        { return 0; }
+        std::lock_guard <std::mutex> story_lock((*story_iter).second->storyMutex);
+        return (*story_iter).second->clientBuckets.size();
+    }
+
+private:
+    KeeperAdmissionControl(KeeperAdmissionControl const &) = delete;
+
+    KeeperAdmissionControl &operator=(KeeperAdmissionControl const &) = delete;
+
+    static uint64_t burstSize(uint64_t rate, uint64_t burst_millis)
+    {
+        if(rate == 0)
+        { return 0; }
+        uint64_t burst = rate * (burst_millis == 0 ? 1000 : burst_millis) / 1000;
+        return (burst == 0 ? 1 : burst);
+    }
+
+    struct StoryAdmission
+    {
+        explicit StoryAdmission(StoryAdmissionLimits const &story_limits)
+            : limits(story_limits)
+            , storyBucket(story_limits.storyEventRate, burstSize(story_limits.storyEventRate, story_limits.burstMillis))
+            , throttledEventCount(0)
+            , lastIdleSweepTime(0)
+        {}
+
+        StoryAdmissionLimits limits;
+        std::mutex storyMutex;
+        TokenBucket storyBucket;
+        std::unordered_map <ClientId, TokenBucket> clientBuckets;
+        uint64_t throttledEventCount;
+        uint64_t lastIdleSweepTime;     // nanoseconds
+    };
+
+    // drops the buckets of the clients idle for CLIENT_BUCKET_IDLE_SECS that have refilled since,
+    // the caller holds the storyMutex
+    static void dropIdleClientBuckets(StoryAdmission &story_admission, uint64_t now)
+    {
+        story_admission.lastIdleSweepTime = now;
+        for(auto client_iter = story_admission.clientBuckets.begin(); client_iter != story_admission.clientBuckets.end();)
+        {
+            TokenBucket &client_bucket = (*client_iter).second;
+            if(now >= client_bucket.getLastRefillTime() + CLIENT_BUCKET_IDLE_SECS * 1000000000ULL)
+            {
+                client_bucket.refill(now);
+                if(client_bucket.isFull())
+                {
+                    client_iter = story_admission.clientBuckets.erase(client_iter);
+                    continue;
+                }
+            }
+            ++client_iter;
+        }
+    }
+
+    std::shared_mutex admissionMutex;   // guards the limitedStories map, the buckets are guarded by the storyMutex
+    std::unordered_map <StoryId, StoryAdmission*> limitedStories;
+    std::atomic <size_t> limitedStoryCount;
+    std::atomic <uint64_t> throttledEventCount;
+    MetricsCounter*throttledEvents;
+};
+
+}
+
+#endif
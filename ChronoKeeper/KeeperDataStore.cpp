@@ -44,6 +44,8 @@ int chronolog::KeeperDataStore::startStoryRecording(std::string const &chronicle
         {
             pipelinesWaitingForExit.erase(waiting_iter);
         }
+        // the story might be migrating back to this group before its pipeline exit
+        theIngestionQueue.setStoryMigrated(story_id, false);
 
         return chronolog::CL_SUCCESS;
     }
@@ -97,6 +99,29 @@ int chronolog::KeeperDataStore::stopStoryRecording(chronolog::StoryId const &sto
 
 ////////////////////////
 
+int chronolog::KeeperDataStore::migrateStoryRecording(chronolog::StoryId const &story_id)
+{
+    LOG_INFO("[KeeperDataStore] Story migrated to another RecordingGroup. StoryID={}", story_id);
+    // the pipeline keeps accepting the events from the clients that haven't switched to the new group yet
+    // until its exit_time, the migration mark is cleared when the pipeline is disengaged from the IngestionQueue
+    int return_code = stopStoryRecording(story_id);
+    if(return_code == chronolog::CL_SUCCESS)
+    { theIngestionQueue.setStoryMigrated(story_id, true); }
+    return return_code;
+}
+
+////////////////////////
+
+uint32_t chronolog::KeeperDataStore::getActiveStoryCount()
+{
+    std::lock_guard storeLock(dataStoreMutex);
+    if(theMapOfStoryPipelines.size() <= pipelinesWaitingForExit.size())
+    { return 0; }
+    return theMapOfStoryPipelines.size() - pipelinesWaitingForExit.size();
+}
+
+////////////////////////
+
 void chronolog::KeeperDataStore::collectIngestedEvents()
 {
     LOG_DEBUG(
@@ -189,7 +214,7 @@ void chronolog::KeeperDataStore::dataCollectionTask()
 }
 
 ////////////////////////
-void chronolog::KeeperDataStore::startDataCollection(int stream_count)
+void chronolog::KeeperDataStore::startDataCollection(int stream_count, XstreamPlacement*xstream_placement)
 {
     std::lock_guard storeLock(dataStoreStateMutex);
     if(is_running() || is_shutting_down())
@@ -204,7 +229,8 @@ void chronolog::KeeperDataStore::startDataCollection(int stream_count)
 
     for(int i = 0; i < stream_count; ++i)
     {
-        tl::managed <tl::xstream> es = tl::xstream::create();
+        tl::managed <tl::xstream> es = (xstream_placement != nullptr
+                                        ? xstream_placement->createXstream(XSTREAM_SEQUENCING) : tl::xstream::create());
         dataStoreStreams.push_back(std::move(es));
     }
 
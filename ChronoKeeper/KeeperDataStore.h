@@ -11,6 +11,7 @@
 #include "IngestionQueue.h"
 #include "StoryPipeline.h"
 #include "StoryChunkExtractionQueue.h"
+#include "XstreamPlacement.h"
 
 
 namespace chronolog
@@ -54,13 +55,21 @@ public:
 
     int stopStoryRecording(StoryId const &);
 
+    // the story is moving to another RecordingGroup: the pipeline is drained through the normal decay path
+    // and the clients still sending events here are redirected to the new group
+    int migrateStoryRecording(StoryId const &);
+
+    // stories being recorded, not counting the pipelines waiting for exit
+    uint32_t getActiveStoryCount();
+
     void collectIngestedEvents();
 
     void extractDecayedStoryChunks();
 
     void retireDecayedPipelines();
 
-    void startDataCollection(int stream_count);
+    // the data collection xstreams are pinned to the sequencing cores of the placement if it is given
+    void startDataCollection(int stream_count, XstreamPlacement*xstream_placement = nullptr);
 
     void shutdownDataCollection();
 
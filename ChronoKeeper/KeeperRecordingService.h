@@ -7,9 +7,15 @@
 #include <thallium/serialization/stl/string.hpp>
 
 #include "chronolog_errcode.h"
+#include "chrono_monitor.h"
 #include "KeeperIdCard.h"
 #include "chronolog_types.h"
 #include "IngestionQueue.h"
+#include "HybridLogicalClock.h"
+#include "RecordEventResponseMsg.h"
+#include "MetricsRegistry.h"
+#include "KeeperAdmissionControl.h"
+#include "SharedMemoryIngestor.h"
 
 namespace tl = thallium;
 
@@ -20,14 +26,18 @@ class KeeperRecordingService: public tl::provider <KeeperRecordingService>
 public:
     // KeeperRecordingService should be created on the heap not the stack thus the constructor is private...
     static KeeperRecordingService*
-    CreateKeeperRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, IngestionQueue &ingestion_queue)
+    CreateKeeperRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, IngestionQueue &ingestion_queue
+                                 , KeeperAdmissionControl &admission_control, tl::pool const &handler_pool = tl::pool()
+                                 , XstreamPlacement*xstream_placement = nullptr)
     {
-        return new KeeperRecordingService(tl_engine, service_provider_id, ingestion_queue);
+        return new KeeperRecordingService(tl_engine, service_provider_id, ingestion_queue, admission_control
+                                          , handler_pool, xstream_placement);
     }
 
     ~KeeperRecordingService()
     {
         LOG_DEBUG("[KeeperRecordingService] Destructor called. Cleaning up...");
+        sharedMemoryIngestor.shutdown();
         get_engine().pop_finalize_callback(this);
     }
 
@@ -35,18 +45,47 @@ public:
     {
         //  ClientId teller_id,  StoryId story_id,
         //  ChronoTick const& chrono_tick, std::string const& record)
-        std::stringstream ss;
-        ss << log_event;
-        LOG_DEBUG("[KeeperRecordingService] Recording event: {}", ss.str());
-        theIngestionQueue.ingestLogEvent(log_event);
-        request.respond(chronolog::CL_SUCCESS);
+        ScopedLatency record_latency(recordEventLatency, metricsSampleTick());
+        recordedEvents->add();
+        // the event is only stringified if the KeeperRecordingService module logs at debug level
+        LOG_MODULE_DEBUG(moduleLogger, "[KeeperRecordingService] Recording event: {}", log_event.toString());
+        // the client over the event rate limits of the story backs off and resends the event
+        if(!theAdmissionControl.admitEvent(log_event))
+        {
+            request.respond(RecordEventResponseMsg(CL_ERR_THROTTLED, keeperClock.getTimestamp()));
+            return;
+        }
+        // the event is always recorded, CL_ERR_STORY_MIGRATED tells the client to switch to the story's new keepers
+        int return_code = theIngestionQueue.ingestLogEvent(log_event);
+        // the keeper clock merges the event times of all its clients and is sent back
+        // for the clients running the hybrid logical clock to catch up with
+        keeperClock.update(log_event.time());
+        request.respond(RecordEventResponseMsg(return_code, keeperClock.getTimestamp()));
+    }
+
+    // the client running on the keeper node sends its events through the shared memory ring shm_name from now on
+    void attach_event_ring(tl::request const &request, ClientId const &client_id, std::string const &shm_name)
+    {
+        int return_code = sharedMemoryIngestor.attachEventRing(client_id, shm_name);
+        request.respond(return_code);
     }
 
 private:
-    KeeperRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, IngestionQueue &ingestion_queue)
+    KeeperRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, IngestionQueue &ingestion_queue
+                           , KeeperAdmissionControl &admission_control, tl::pool const &handler_pool
+                           , XstreamPlacement*xstream_placement)
             : tl::provider <KeeperRecordingService>(tl_engine, service_provider_id), theIngestionQueue(ingestion_queue)
+            , theAdmissionControl(admission_control)
+            , moduleLogger(chrono_monitor::getModuleLogger("KeeperRecordingService"))
+            , recordedEvents(MetricsRegistry::getInstance().getCounter("keeper_record_event_total"))
+            , recordEventLatency(MetricsRegistry::getInstance().getHistogram("keeper_record_event_nsecs"))
+            , sharedMemoryIngestor(ingestion_queue, admission_control, keeperClock)
     {
-        define("record_event", &KeeperRecordingService::record_event, tl::ignore_return_value());
+        // the null handler_pool leaves the handlers on the margo rpc xstream
+        define("record_event", &KeeperRecordingService::record_event, handler_pool, tl::ignore_return_value());
+        define("attach_event_ring", &KeeperRecordingService::attach_event_ring, handler_pool);
+        // the ring poller runs next to the recording handlers, on the rpc cores
+        sharedMemoryIngestor.startPolling(get_engine().get_margo_instance(), xstream_placement);
         //set up callback for the case when the engine is being finalized while this provider is still alive
         get_engine().push_finalize_callback(this, [p = this]()
         { delete p; });
@@ -57,6 +96,12 @@ private:
     KeeperRecordingService &operator=(KeeperRecordingService const &) = delete;
 
     IngestionQueue &theIngestionQueue;
+    KeeperAdmissionControl &theAdmissionControl;
+    spdlog::logger &moduleLogger;
+    HybridLogicalClock keeperClock;
+    MetricsCounter *recordedEvents;
+    LatencyHistogram *recordEventLatency;   // sampled, see METRICS_LATENCY_SAMPLE_EVERY
+    SharedMemoryIngestor sharedMemoryIngestor;  // polls the rings of the clients on the keeper node
 };
 
 }// namespace chronolog
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 #include <thallium.hpp>
 
 #include "KeeperIdCard.h"
@@ -0,0 +1,270 @@
+#ifndef SHARED_MEMORY_INGESTOR_H
+#define SHARED_MEMORY_INGESTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <margo.h>
+#include <thallium.hpp>
+
+#include "chrono_monitor.h"
+#include "chronolog_errcode.h"
+#include "chronolog_types.h"
+#include "HybridLogicalClock.h"
+#include "IngestionQueue.h"
+#include "KeeperAdmissionControl.h"
+#include "MetricsRegistry.h"
+#include "SharedEventRing.h"
+#include "XstreamPlacement.h"
+
+// events taken out of one ring before moving on to the next one, so that a busy client doesn't starve the others
+#define SHM_INGEST_BATCH_SIZE 256
+// the idle poller yields for this many empty rounds and then sleeps, doubling the sleep up to the max
+#define SHM_POLL_SPIN_ROUNDS 1000
+#define SHM_POLL_IDLE_MAX_USECS 200
+
+namespace tl = thallium;
+// the ring whose next event is throttled is not polled again for this long
+#define SHM_THROTTLED_RING_PAUSE_USECS 1000
+
+namespace chronolog
+{
+
+// SharedMemoryIngestor polls the SharedEventRings of the clients running on the keeper node
+// and ingests their events the same way KeeperRecordingService::record_event does for the rpc clients:
+// admission control, IngestionQueue, keeper clock.
+// The event throttled by the admission control is left at the head of its ring, so the client's ring fills up
+// and the client sends its next events through rpc, where the admission control answers them with CL_ERR_THROTTLED;
+// the other events of that client wait behind it.
+// The events carry the ClientId the ring was attached for, whatever the client process wrote into the records.
+// The ring is detached once its client has closed it or has exited, and all its events are ingested,
+// or right away if the client has corrupted it.
+// The client that finds the ring stalled takes back the events not polled yet, the poller skips them.
+// The poller is a ULT on an rpc role xstream, it ingests on the cores of the recording handlers;
+// the attached rings are owned by the poller, attachEventRing only hands the new ring over to it.
+class SharedMemoryIngestor
+{
+public:
+    SharedMemoryIngestor(IngestionQueue &ingestion_queue, KeeperAdmissionControl &admission_control
+                         , HybridLogicalClock &keeper_clock)
+        : theIngestionQueue(ingestion_queue)
+        , theAdmissionControl(admission_control)
+        , keeperClock(keeper_clock)
+        , running(false)
+        , attachedRingCount(0)
+        , ingestedEvents(MetricsRegistry::getInstance().getCounter("keeper_shm_event_total"))
+        , attachedRingsGauge(MetricsRegistry::getInstance().getGauge("keeper_shm_attached_rings"))
+    {}
+
+    ~SharedMemoryIngestor()
+    { shutdown(); }
+
+    // maps the client's ring, the client unlinks the segment name once this returns
+    int attachEventRing(ClientId const &client_id, std::string const &shm_name)
+    {
+        SharedEventRing*event_ring = SharedEventRing::AttachSharedEventRing(shm_name);
+        if(event_ring == nullptr)
+        { return CL_ERR_UNKNOWN; }
+        // the client tells the ring is alive by the poll time, it has to be fresh before the first round
+        event_ring->publishConsumerState(keeperClock.getTimestamp());
+
+        std::lock_guard <std::mutex> lock(ringMapMutex);
+        if(!running)
+        {
+            event_ring->closeConsumer();
+            delete event_ring;
+            return CL_ERR_UNKNOWN;
+        }
+        attachedRings.emplace_back(shm_name, AttachedRing{client_id, event_ring, 0});
+        attachedRingCount.store(attachedRings.size(), std::memory_order_release);
+        LOG_INFO("[SharedMemoryIngestor] Attached event ring {} of ClientID={} capacity {}", shm_name, client_id
+                 , event_ring->getCapacity());
+        return CL_SUCCESS;
+    }
+
+    // the poller's idle sleep is a margo sleep that lets the other ULTs of the xstream run
+    void startPolling(margo_instance_id margo_id, XstreamPlacement*xstream_placement = nullptr)
+    {
+        std::lock_guard <std::mutex> lock(ringMapMutex);
+        if(running)
+        { return; }
+        running = true;
+        pollingStream = (xstream_placement != nullptr ? xstream_placement->createXstream(XSTREAM_RPC)
+                                                      : tl::xstream::create());
+        pollingThread = pollingStream->make_thread([p = this, margo_id]()
+                                                   { p->pollEventRings(margo_id); });
+    }
+
+    // ingests the events left in the rings and tells the clients to fall back to rpc
+    void shutdown()
+    {
+        {
+            std::lock_guard <std::mutex> lock(ringMapMutex);
+            if(!running)
+            { return; }
+            running = false;
+        }
+        pollingThread->join();
+        pollingStream->join();
+
+        // the poller is gone, the rings left are ingested and closed here
+        pollRound(steadyClockMicros());
+        for(auto &ring_entry: eventRings)
+        {
+            ring_entry.second.eventRing->closeConsumer();
+            delete ring_entry.second.eventRing;
+        }
+        eventRings.clear();
+        attachedRingsGauge->set(0);
+        LOG_INFO("[SharedMemoryIngestor] Detached all the event rings");
+    }
+
+private:
+    SharedMemoryIngestor(SharedMemoryIngestor const &) = delete;
+
+    SharedMemoryIngestor &operator=(SharedMemoryIngestor const &) = delete;
+
+    struct AttachedRing
+    {
+        ClientId clientId;
+        SharedEventRing*eventRing;
+        uint64_t pausedUntil;   // steady clock microseconds
+    };
+
+    static uint64_t steadyClockMicros()
+    {
+        return std::chrono::duration_cast <std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void pollEventRings(margo_instance_id margo_id)
+    {
+        uint64_t idle_rounds = 0;
+        uint64_t idle_usecs = 1;
+        while(running)
+        {
+            size_t event_count = pollRound(steadyClockMicros());
+            if(event_count > 0)
+            {
+                idle_rounds = 0;
+                idle_usecs = 1;
+            }
+            else if(++idle_rounds < SHM_POLL_SPIN_ROUNDS)
+            { tl::thread::yield(); }
+            else
+            {
+                margo_thread_sleep(margo_id, idle_usecs / 1000.0);
+                idle_usecs = std::min <uint64_t>(idle_usecs * 2, SHM_POLL_IDLE_MAX_USECS);
+            }
+        }
+    }
+
+    // takes over the rings attached since the previous round, the ringMapMutex is only taken if there are any
+    void takeAttachedRings()
+    {
+        if(attachedRingCount.load(std::memory_order_acquire) == 0)
+        { return; }
+
+        std::vector <std::pair <std::string, AttachedRing>> new_rings;
+        {
+            std::lock_guard <std::mutex> lock(ringMapMutex);
+            new_rings.swap(attachedRings);
+            attachedRingCount.store(0, std::memory_order_release);
+        }
+        for(auto &new_ring: new_rings)
+        {
+            auto ring_iter = eventRings.find(new_ring.first);
+            if(ring_iter != eventRings.end())
+            {
+                // the name was reused by a new segment, the old one is already unlinked
+                delete (*ring_iter).second.eventRing;
+                eventRings.erase(ring_iter);
+            }
+            eventRings.emplace(new_ring.first, new_ring.second);
+        }
+        attachedRingsGauge->set(eventRings.size());
+    }
+
+    // ingests up to SHM_INGEST_BATCH_SIZE events from every ring, returns the number of events ingested;
+    // called by the poller, or by shutdown() once the poller has exited
+    size_t pollRound(uint64_t now)
+    {
+        takeAttachedRings();
+        size_t event_count = 0;
+        LogEvent log_event;
+        for(auto ring_iter = eventRings.begin(); ring_iter != eventRings.end();)
+        {
+            AttachedRing &attached_ring = (*ring_iter).second;
+            SharedEventRing*event_ring = attached_ring.eventRing;
+            size_t batch_count = 0;
+            while(now >= attached_ring.pausedUntil && batch_count < SHM_INGEST_BATCH_SIZE && event_ring->peek(log_event))
+            {
+                // the admission control and the event sequence go by the client the ring is attached for
+                log_event.clientId = attached_ring.clientId;
+                if(!theAdmissionControl.admitEvent(log_event))
+                {
+                    attached_ring.pausedUntil = now + SHM_THROTTLED_RING_PAUSE_USECS;
+                    break;
+                }
+                // the event is consumed before it is ingested, the client that has given up on the ring
+                // may have taken it back to send it through rpc
+                if(!event_ring->pop())
+                { break; }
+                // the event is always recorded, the client is told about the migrated story through the ring
+                if(theIngestionQueue.ingestLogEvent(log_event) == CL_ERR_STORY_MIGRATED)
+                { event_ring->markStoryMigrated(log_event.storyId); }
+                keeperClock.update(log_event.time());
+                batch_count++;
+            }
+            event_ring->publishConsumerState(keeperClock.getTimestamp());
+            if(batch_count > 0)
+            {
+                event_count += batch_count;
+                ingestedEvents->add(batch_count);
+            }
+
+            if(event_ring->isCorrupted())
+            {
+                // the client falls back to rpc once it finds the ring closed
+                LOG_ERROR("[SharedMemoryIngestor] Detached corrupted event ring {} of ClientID={}"
+                          , event_ring->getName(), attached_ring.clientId);
+                event_ring->closeConsumer();
+                delete event_ring;
+                ring_iter = eventRings.erase(ring_iter);
+                attachedRingsGauge->set(eventRings.size());
+            }
+            else if(event_ring->isEmpty() && event_ring->isProducerGone())
+            {
+                LOG_INFO("[SharedMemoryIngestor] Detached event ring {} of ClientID={}", event_ring->getName()
+                         , attached_ring.clientId);
+                delete event_ring;
+                ring_iter = eventRings.erase(ring_iter);
+                attachedRingsGauge->set(eventRings.size());
+            }
+            else
+            { ++ring_iter; }
+        }
+        return event_count;
+    }
+
+    IngestionQueue &theIngestionQueue;
+    KeeperAdmissionControl &theAdmissionControl;
+    HybridLogicalClock &keeperClock;
+    std::mutex ringMapMutex;    // guards running and attachedRings
+    std::atomic <bool> running;
+    tl::managed <tl::xstream> pollingStream;
+    tl::managed <tl::thread> pollingThread;
+    std::vector <std::pair <std::string, AttachedRing>> attachedRings;  // attached, not yet taken over by the poller
+    std::atomic <size_t> attachedRingCount;
+    std::map <std::string, AttachedRing> eventRings;  // polled rings, accessed by the poller only
+    MetricsCounter*ingestedEvents;
+    MetricsGauge*attachedRingsGauge;
+};
+
+}
+
+#endif
@@ -8,6 +8,8 @@ chronolog::StoryChunkExtractorRDMA::StoryChunkExtractorRDMA(tl::engine &extracti
                                                             , tl::remote_procedure &drain_to_grapher
                                                             , tl::provider_handle &service_ph): extraction_engine(
         extraction_engine), drain_to_grapher(drain_to_grapher), service_ph(service_ph)
+        , serializationLatency(MetricsRegistry::getInstance().getHistogram("keeper_chunk_serialization_nsecs"))
+        , bulkTransferLatency(MetricsRegistry::getInstance().getHistogram("keeper_chunk_bulk_transfer_nsecs"))
 {
     LOG_DEBUG("[StoryChunkExtractorRDMA] KeeperGrapherDrainService setup complete");
 }
@@ -25,9 +27,7 @@ int chronolog::StoryChunkExtractorRDMA::processStoryChunk(StoryChunk*story_chunk
     {
         LOG_DEBUG("[StoryChunkExtractorRDMA] Processing a story chunk, StoryID: {}, StartTime: {} ..."
                   , story_chunk->getStoryId(), story_chunk->getStartTime());
-#ifndef NDEBUG
         start = std::chrono::high_resolution_clock::now();
-#endif
         size_t serialized_story_chunk_size;
         std::ostringstream oss(std::ios::binary);
         cereal::BinaryOutputArchive oarchive(oss);
@@ -35,8 +35,9 @@ int chronolog::StoryChunkExtractorRDMA::processStoryChunk(StoryChunk*story_chunk
         std::string serialized_story_chunk = oss.str();
         serialized_story_chunk_size = serialized_story_chunk.size();
 
-#ifndef NDEBUG
         end = std::chrono::high_resolution_clock::now();
+        serializationLatency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count());
+#ifndef NDEBUG
         LOG_INFO("[StoryChunkExtractorRDMA] Serialization took {} us",
                 std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count() / 1000.0);
 #endif
@@ -47,12 +48,11 @@ int chronolog::StoryChunkExtractorRDMA::processStoryChunk(StoryChunk*story_chunk
         segments[0].second = serialized_story_chunk_size;
         tl::bulk tl_bulk = extraction_engine.expose(segments, tl::bulk_mode::read_only);
         LOG_DEBUG("[StoryChunkExtractorRDMA] Draining to Grapher with story chunk size: {} ...", tl_bulk.size());
-#ifndef NDEBUG
         start = std::chrono::high_resolution_clock::now();
-#endif
         size_t result = drain_to_grapher.on(service_ph)(tl_bulk);
-#ifndef NDEBUG
         end = std::chrono::high_resolution_clock::now();
+        bulkTransferLatency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count());
+#ifndef NDEBUG
         LOG_INFO("[StoryChunkExtractorRDMA] Draining to Grapher took {} us",
                 std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count() / 1000.0);
 #endif
@@ -62,6 +62,7 @@ int chronolog::StoryChunkExtractorRDMA::processStoryChunk(StoryChunk*story_chunk
         {
             LOG_INFO("[StoryChunkExtractorRDMA] Successfully drained a story chunk to Grapher, StoryID: {}, "
                      "StartTime: {}", story_chunk->getStoryId(), story_chunk->getStartTime());
+            EventTracer::getInstance().recordStage(story_chunk->getTracedEvents(), "sent_to_grapher");
             return chronolog::CL_SUCCESS;
         }
         else
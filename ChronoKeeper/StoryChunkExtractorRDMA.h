@@ -4,6 +4,7 @@
 #include "chronolog_types.h"
 #include "StoryChunkExtractor.h"
 #include "ConfigurationManager.h"
+#include "MetricsRegistry.h"
 
 namespace tl = thallium;
 
@@ -25,6 +26,8 @@ private:
     tl::engine &extraction_engine;
     tl::remote_procedure drain_to_grapher;
     tl::provider_handle service_ph;
+    LatencyHistogram*serializationLatency;
+    LatencyHistogram*bulkTransferLatency;
 };
 
 }
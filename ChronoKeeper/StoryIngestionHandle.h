@@ -1,9 +1,12 @@
 #ifndef STORY_INGESTION_HANDLE_H
 #define STORY_INGESTION_HANDLE_H
 
+#include <chrono>
 #include <mutex>
 #include <deque>
 
+#include "chronolog_types.h"
+
 //
 // IngestionQueue is a funnel into the KeeperDataStore
 // std::deque guarantees O(1) time for addidng elements and resizing 
@@ -18,9 +21,13 @@ class StoryIngestionHandle
 {
 
 public:
-    StoryIngestionHandle(std::mutex &a_mutex, EventDeque*active, EventDeque*passive): ingestionMutex(a_mutex)
-                                                                                      , activeDeque(active)
-                                                                                      , passiveDeque(passive)
+    StoryIngestionHandle(std::mutex &a_mutex, EventDeque*active, EventDeque*passive)
+        : ingestionMutex(a_mutex)
+        , activeDeque(active)
+        , passiveDeque(passive)
+        , activeIngestTime(0)
+        , passiveIngestTime(0)
+        , ingestedEventCount(0)
     {}
 
     ~StoryIngestionHandle() = default;
@@ -31,10 +38,28 @@ public:
     EventDeque &getPassiveDeque() const
     { return *passiveDeque; }
 
+    // Keeper clock time the first event of the deque was ingested at, the merge delay of the batch is measured from it
+    uint64_t getActiveIngestTime() const
+    { return activeIngestTime; }
+
+    uint64_t getPassiveIngestTime() const
+    { return passiveIngestTime; }
+
     void ingestEvent(LogEvent const &logEvent)
     {   // assume multiple service threads pushing events on ingestionQueue
         std::lock_guard <std::mutex> lock(ingestionMutex);
+        // the clock is read once per batch, for the first event ingested since the deques were swapped
+        if(activeDeque->empty())
+        { activeIngestTime = std::chrono::high_resolution_clock::now().time_since_epoch().count(); }
         activeDeque->push_back(logEvent);
+        ingestedEventCount++;
+    }
+
+    // number of events ingested for this story, used to report the hottest stories to ChronoVisor
+    uint64_t getIngestedEventCount() const
+    {
+        std::lock_guard <std::mutex> lock(ingestionMutex);
+        return ingestedEventCount;
     }
 
     void swapActiveDeque() //EventDeque * empty_deque, EventDeque * full_deque)
@@ -51,6 +76,7 @@ public:
         EventDeque*full_deque = activeDeque;
         activeDeque = passiveDeque;
         passiveDeque = full_deque;
+        passiveIngestTime = activeIngestTime;
     }
 
 
@@ -58,6 +84,9 @@ private:
     std::mutex &ingestionMutex;
     EventDeque*activeDeque;
     EventDeque*passiveDeque;
+    uint64_t activeIngestTime;
+    uint64_t passiveIngestTime;
+    uint64_t ingestedEventCount;  // updated under the ingestionMutex
 };
 
 }
@@ -8,6 +8,7 @@
 #include "StoryIngestionHandle.h"
 #include "StoryChunkExtractionQueue.h"
 #include "chrono_monitor.h"
+#include "MetricsRegistry.h"
 
 //#define TRACE_CHUNKING
 #define TRACE_CHUNK_EXTRACTION
@@ -24,6 +25,7 @@ chronolog::StoryPipeline::StoryPipeline(StoryChunkExtractionQueue &extractionQue
     , chronicleName(chronicle_name), storyName(story_name)
     , chunkGranularity(chunk_granularity), acceptanceWindow(acceptance_window)
     , activeIngestionHandle(nullptr)
+    , mergeDelayHistogram(chl::MetricsRegistry::getInstance().getHistogram("keeper_ingestion_to_merge_nsecs"))
 {
     activeIngestionHandle = new chl::StoryIngestionHandle(ingestionMutex, &eventQueue1, &eventQueue2);
 
@@ -76,11 +78,11 @@ void chronolog::StoryPipeline::finalize()
     {
         if(!activeIngestionHandle->getPassiveDeque().empty())
         {
-            mergeEvents(activeIngestionHandle->getPassiveDeque());
+            mergeEvents(activeIngestionHandle->getPassiveDeque(), activeIngestionHandle->getPassiveIngestTime());
         }
         if(!activeIngestionHandle->getActiveDeque().empty())
         {
-            mergeEvents(activeIngestionHandle->getActiveDeque());
+            mergeEvents(activeIngestionHandle->getActiveDeque(), activeIngestionHandle->getActiveIngestTime());
         }
         delete activeIngestionHandle;
         LOG_INFO("[StoryPipeline] Finalized ingestion handle for storyId: {}", storyId);
@@ -106,6 +108,7 @@ void chronolog::StoryPipeline::finalize()
             }
             else
             {
+                chl::EventTracer::getInstance().recordStage(extractedChunk->getTracedEvents(), "extraction_queued");
                 theExtractionQueue.stashStoryChunk(extractedChunk);
             }
         }
@@ -173,7 +176,7 @@ void chronolog::StoryPipeline::collectIngestedEvents()
     activeIngestionHandle->swapActiveDeque();
     if(!activeIngestionHandle->getPassiveDeque().empty())
     {
-        mergeEvents(activeIngestionHandle->getPassiveDeque());
+        mergeEvents(activeIngestionHandle->getPassiveDeque(), activeIngestionHandle->getPassiveIngestTime());
     }
     LOG_INFO("[StoryPipeline] Collected ingested events for StoryID={}", storyId);
 }
@@ -223,6 +226,7 @@ void chronolog::StoryPipeline::extractDecayedStoryChunks(uint64_t current_time)
             }
             else
             {
+                chl::EventTracer::getInstance().recordStage(extractedChunk->getTracedEvents(), "extraction_queued");
                 theExtractionQueue.stashStoryChunk(extractedChunk);
             }
         }
@@ -235,7 +239,7 @@ void chronolog::StoryPipeline::extractDecayedStoryChunks(uint64_t current_time)
 
 ////////////////////
 
-void chronolog::StoryPipeline::mergeEvents(chronolog::EventDeque &event_deque)
+void chronolog::StoryPipeline::mergeEvents(chronolog::EventDeque &event_deque, uint64_t ingest_time)
 {
     if(event_deque.empty())
     { return; }
@@ -246,9 +250,15 @@ void chronolog::StoryPipeline::mergeEvents(chronolog::EventDeque &event_deque)
     // chunk and do the lookup only if it's not the one
     // NOTE: we should never have less than 2 chunks in the active storyTimelineMap !!!
     std::map <uint64_t, chronolog::StoryChunk*>::iterator chunk_to_merge_iter = --storyTimelineMap.end();
+    // the delay is measured on the Keeper clock from the ingestion of the batch's first event,
+    // the longest wait in the batch; the event time is the client clock time
+    uint64_t merge_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    mergeDelayHistogram->record(merge_time > ingest_time ? merge_time - ingest_time : 0);
     while(!event_deque.empty())
     {
         event = event_deque.front();
+        if(chl::EventTracer::isEnabled())
+        { chl::EventTracer::getInstance().recordStage(event, "merged"); }
         LOG_DEBUG("[StoryPipeline] StoryID: {} [Start: {}, End: {}]: Merging event time: {}", storyId, TimelineStart()
              , TimelineEnd(), event.time());
         if(TimelineStart() <= event.time() && event.time() < TimelineEnd())
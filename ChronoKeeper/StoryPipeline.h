@@ -10,13 +10,12 @@
 #include "chronolog_types.h"
 #include "StoryChunk.h"
 #include "StoryChunkExtractionQueue.h"
+#include "MetricsRegistry.h"
+#include "StoryIngestionHandle.h"
 
 namespace chronolog
 {
 
-
-class StoryIngestionHandle;
-
 class StoryPipeline
 {
 
@@ -37,7 +36,8 @@ public:
 
     void collectIngestedEvents();
 
-    void mergeEvents(std::deque <LogEvent> &);
+    // merges the ingested batch, ingest_time is the Keeper clock time the first event of the batch was ingested at
+    void mergeEvents(EventDeque &, uint64_t ingest_time);
 
     void extractDecayedStoryChunks(uint64_t);
 
@@ -72,11 +72,13 @@ private:
     // two ingestion queues so that they can take turns playing 
     // active/passive ingestion duty
     // 
-    std::deque <LogEvent> eventQueue1;
-    std::deque <LogEvent> eventQueue2;
+    EventDeque eventQueue1;
+    EventDeque eventQueue2;
 
     StoryIngestionHandle*activeIngestionHandle;
 
+    LatencyHistogram*mergeDelayHistogram;  // delay between the ingestion of the batch's first event and the batch merge
+
     // mutex used to protect Story sequencing operations 
     // from concurrent access by the DataStore Sequencing threads
     std::mutex sequencingMutex;
@@ -12,6 +12,9 @@
 #include "ArchiveReadingRequestQueue.h"
 #include "ArchiveReadingAgent.h"
 #include "StoryChunkExtractionQueue.h"
+#include "PlayerDataStore.h"
+#include "PlaybackEventSelector.h"
+#include "StoryAggregationTask.h"
 
 namespace chl = chronolog;
 namespace tl = thallium;
@@ -26,38 +29,253 @@ void chronolog::ArchiveReadingAgent::archiveReadingTask()
     
     while( !is_shutting_down() )
     {
-        if(theReadingRequestQueue.empty())
+        // 1. wait for the next reading request the queue schedules
+        // 2. read in the next time slice of the requested range from the archive store
+        // 3. merge the archived events of the slice with the recent events the Player holds in memory
+        //    for the stories that are still being recorded and send them to the client
+        // 4. return the rest of the request to the queue, or if this was the last slice complete the request
+
+        chl::ArchiveReadingRequest readingRequest;
+        theReadingRequestQueue.waitReadingRequest(readingRequest); 
+        if(readingRequest.empty())
+        {   continue; } // the queue is shut down
+
+        if(readingRequest.readingState == nullptr)
+        {   readingRequest.readingState = new chl::ReadingRequestState(readingRequest.filter); }
+
+        chl::chrono_time sliceEnd = theReadingRequestQueue.getSliceEnd(readingRequest);
+        readArchiveSlice(readingRequest, sliceEnd);
+
+        chl::PlaybackEventSelector * selector = readingRequest.readingState->getSelector();
+        if(sliceEnd < readingRequest.endTime && (selector == nullptr || !selector->is_exhausted()))
         {
-            sleep(1);
+            if(readingRequest.storyChunkQueue != nullptr)
+            {   streamPlaybackSlice(readingRequest, sliceEnd); }
+
+            // the other requests are served before the next slice of this one
+            readingRequest.sliceStart = sliceEnd;
+            if(!theReadingRequestQueue.pushReadingRequest(readingRequest))
+            {   releaseReadingRequest(readingRequest); }
             continue;
         }
-         
-        // 1. take a reading request off the reading queue
-        // 2. read in the requested data from the archive store
-        // 3. continue adding every StoryChunk read onto the StoryChunkIngestionQueue for merging with the current realtime stream of chunks from Keepers/Graphers
-        //    or bypass the merging and add the StoryChunk directly onto the ExtractionQueue to be sent to the client
-           
-        chl::ArchiveReadingRequest readingRequest;
-        theReadingRequestQueue.popReadingRequest(readingRequest); 
-        std::list<chl::StoryChunk*> listOfChunks;
 
-        theReadingAgent.readArchivedStory(readingRequest.chronicleName, readingRequest.storyName, readingRequest.startTime, readingRequest.endTime, listOfChunks);
+        if(readingRequest.aggregationTask != nullptr)
+        {   finishAggregation(readingRequest); }
+        else if(readingRequest.summaryTask != nullptr)
+        {   finishSummary(readingRequest); }
+        else
+        {   finishPlayback(readingRequest); }
+
+        theReadingRequestQueue.completeReadingRequest(readingRequest);
+        delete readingRequest.readingState;
+    }
+
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::readArchiveSlice(chl::ArchiveReadingRequest const & readingRequest, chl::chrono_time sliceEnd)
+{
+    // the slice selects the archive files by their start time, the events are selected from the whole requested range
+    // so that the events of the file extending past the slice end are not lost;
+    // the files starting at the slice end belong to the next slice
+    chl::chrono_time fileEndTime = (sliceEnd < readingRequest.endTime ? sliceEnd - 1 : readingRequest.endTime);
+
+    chl::ReadingRequestState & readingState = *readingRequest.readingState;
+
+    // the playback filter is evaluated while the archived events are read
+    // so that only the selected events are copied into the StoryChunks,
+    // the aggregated and summarized events are not copied at all
+    chl::StoryAggregator * aggregator = (readingRequest.aggregationTask != nullptr ? &readingRequest.aggregationTask->getAggregator() : nullptr);
+    chl::StoryChunkSummary * summary = (readingRequest.summaryTask != nullptr ? &readingRequest.summaryTask->getSummary() : nullptr);
+
+    std::list<chl::StoryChunk*> listOfChunks;
+    theReadingAgent.readArchivedStorySlice(readingRequest.chronicleName, readingRequest.storyName, readingRequest.startTime, readingRequest.endTime
+                                        , readingRequest.sliceStart, fileEndTime, listOfChunks
+                                        , false, readingState.getSelector(), aggregator, summary);
+
+    LOG_DEBUG("[ReadingAgent] Read {} StoryChunks for Chronicle={}, Story={}, TimeRange=[{}, {}), Slice=[{}, {})"
+              , listOfChunks.size(), readingRequest.chronicleName, readingRequest.storyName
+              , readingRequest.startTime, readingRequest.endTime, readingRequest.sliceStart, sliceEnd);
+
+    if(readingRequest.storyChunkQueue == nullptr)
+    {   return; }
+
+    // StoryChunk events are keyed by {eventTime, clientId, eventIndex}, so the events present
+    // both in the archive and in memory are only inserted once
+    if(readingState.playbackChunk == nullptr)
+    {
+        readingState.playbackChunk = new chl::StoryChunk(readingRequest.chronicleName, readingRequest.storyName, 0
+                                                       , readingRequest.startTime, readingRequest.endTime);
+    }
+    while(!listOfChunks.empty())
+    {
+        readingState.playbackChunk->mergeEvents(*listOfChunks.front());
+        delete listOfChunks.front();
+        listOfChunks.pop_front();
+    }
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::mergeRecentPlaybackEvents(chl::ArchiveReadingRequest const & readingRequest
+                                                              , chl::chrono_time rangeStart, chl::chrono_time rangeEnd)
+{
+    if(theRecentDataStore == nullptr)
+    {   return; }
+
+    chl::PlaybackEventSelector * selector = readingRequest.readingState->getSelector();
+    chl::StoryChunk * playbackChunk = readingRequest.readingState->playbackChunk;
+
+    if(selector == nullptr)
+    {
+        theRecentDataStore->readRecentStoryEvents(readingRequest.chronicleName, readingRequest.storyName
+                                                 , rangeStart, rangeEnd, *playbackChunk);
+    }
+    else if(!selector->is_exhausted())
+    {
+        // recent events go through the same selector after the archived ones, keeping the time order
+        // of the sampling and the limit; the in-memory copies of the archived events are not offered again
+        chl::StoryChunk recentChunk(readingRequest.chronicleName, readingRequest.storyName, 0, rangeStart, rangeEnd);
+        theRecentDataStore->readRecentStoryEvents(readingRequest.chronicleName, readingRequest.storyName
+                                                 , rangeStart, rangeEnd, recentChunk);
+        selector->selectRecentEvents(recentChunk, *playbackChunk);
+    }
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::streamPlaybackSlice(chl::ArchiveReadingRequest const & readingRequest, chl::chrono_time sliceEnd)
+{
+    // the events before the slice end are complete once the recent events of the slice are merged in,
+    // they are sent to the client in their own StoryChunk so that the playback is held in memory one slice at a time;
+    // the events of the archive files extending past the slice end stay in the playbackChunk for the next slice
+    mergeRecentPlaybackEvents(readingRequest, readingRequest.sliceStart, sliceEnd);
+
+    chl::StoryChunk * sliceChunk = new chl::StoryChunk(readingRequest.chronicleName, readingRequest.storyName, 0
+                                                     , readingRequest.sliceStart, sliceEnd);
+    sliceChunk->mergeEvents(*readingRequest.readingState->playbackChunk, readingRequest.sliceStart);
+
+    LOG_DEBUG("[ReadingAgent] Playback StoryChunk for Chronicle={}, Story={}, Slice=[{}, {}) has {} events"
+              , readingRequest.chronicleName, readingRequest.storyName
+              , readingRequest.sliceStart, sliceEnd, sliceChunk->getEventCount());
+
+    if(sliceChunk->empty())
+    {
+        delete sliceChunk;
+        return;
+    }
+    readingRequest.storyChunkQueue->stashStoryChunk(sliceChunk);
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::finishPlayback(chl::ArchiveReadingRequest const & readingRequest)
+{
+    chl::PlaybackEventSelector * selector = readingRequest.readingState->getSelector();
+
+    mergeRecentPlaybackEvents(readingRequest, readingRequest.sliceStart, readingRequest.endTime);
+
+    // the last StoryChunk of the playback ends at the end of the requested range, the client completes the query
+    // once it receives it, so it is sent even if there are no events left
+    chl::StoryChunk * lastChunk = new chl::StoryChunk(readingRequest.chronicleName, readingRequest.storyName, 0
+                                                    , readingRequest.sliceStart, readingRequest.endTime);
+    lastChunk->mergeEvents(*readingRequest.readingState->playbackChunk, readingRequest.sliceStart);
+
+    if(selector != nullptr)
+    {
+        selector->drainReservoir(*lastChunk);
+    }
 
-        LOG_DEBUG("[ReadingAgent] Read {} StoryChunks for Chronicle={}, Story={}, TimeRange=[{}, {})"
-                  , listOfChunks.size(), readingRequest.chronicleName, readingRequest.storyName
-                  , readingRequest.startTime, readingRequest.endTime);
-        while(!listOfChunks.empty())
+    LOG_DEBUG("[ReadingAgent] Playback StoryChunk for Chronicle={}, Story={}, Slice=[{}, {}) has {} events"
+              , readingRequest.chronicleName, readingRequest.storyName
+              , readingRequest.sliceStart, readingRequest.endTime, lastChunk->getEventCount());
+
+    readingRequest.storyChunkQueue->stashStoryChunk(lastChunk);
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::finishAggregation(chl::ArchiveReadingRequest const & readingRequest)
+{
+    chl::StoryAggregator & aggregator = readingRequest.aggregationTask->getAggregator();
+    chl::PlaybackEventSelector * selector = readingRequest.readingState->getSelector();
+
+    if(theRecentDataStore != nullptr && (selector == nullptr || !selector->is_exhausted()))
+    {
+        chl::StoryChunk recentChunk(readingRequest.chronicleName, readingRequest.storyName, 0
+                                  , readingRequest.startTime, readingRequest.endTime);
+        theRecentDataStore->readRecentStoryEvents(readingRequest.chronicleName, readingRequest.storyName
+                                                 , readingRequest.startTime, readingRequest.endTime, recentChunk);
+        for(auto const & event_record : recentChunk)
         {
-            readingRequest.storyChunkQueue->stashStoryChunk(listOfChunks.front());
-            listOfChunks.pop_front();
+            // skip the in-memory copies of the events already aggregated from the archive
+            if(aggregator.isArchived(event_record.first))
+            {   continue; }
+
+            if(selector == nullptr || selector->select(event_record.second.getClientId(), event_record.second.getRecord()))
+            {
+                aggregator.aggregateEvent(event_record.second.time(), event_record.second.getClientId()
+                                        , event_record.second.getRecord());
+            }
         }
     }
 
+    LOG_DEBUG("[ReadingAgent] Aggregated {} events for Chronicle={}, Story={}, TimeRange=[{}, {})"
+              , aggregator.getEventCount(), readingRequest.chronicleName, readingRequest.storyName
+              , readingRequest.startTime, readingRequest.endTime);
+
+    readingRequest.aggregationTask->complete(chl::CL_SUCCESS);
 }
 
 ////////////////////////
 
-void chronolog::ArchiveReadingAgent::startArchiveReading(int stream_count)
+void chronolog::ArchiveReadingAgent::finishSummary(chl::ArchiveReadingRequest const & readingRequest)
+{
+    chl::StoryChunkSummary & summary = readingRequest.summaryTask->getSummary();
+
+    if(theRecentDataStore != nullptr)
+    {
+        // the in-memory events up to the last archived event are the copies of the archived ones
+        bool hasArchivedEvents = !summary.empty();
+        chl::EventSequence archiveHorizon = summary.getLastEventSequence();
+
+        chl::StoryChunk recentChunk(readingRequest.chronicleName, readingRequest.storyName, 0
+                                  , readingRequest.startTime, readingRequest.endTime);
+        theRecentDataStore->readRecentStoryEvents(readingRequest.chronicleName, readingRequest.storyName
+                                                 , readingRequest.startTime, readingRequest.endTime, recentChunk);
+        for(auto const & event_record : recentChunk)
+        {
+            if(hasArchivedEvents && !(archiveHorizon < event_record.first))
+            {   continue; }
+
+            summary.addEvent(event_record.second.time(), event_record.second.getClientId(), event_record.second.index()
+                            , event_record.second.getRecord().size());
+        }
+    }
+
+    LOG_DEBUG("[ReadingAgent] Summarized {} events for Chronicle={}, Story={}, TimeRange=[{}, {})"
+              , summary.getEventCount(), readingRequest.chronicleName, readingRequest.storyName
+              , readingRequest.startTime, readingRequest.endTime);
+
+    readingRequest.summaryTask->complete(chl::CL_SUCCESS);
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::releaseReadingRequest(chl::ArchiveReadingRequest const & readingRequest)
+{
+    if(readingRequest.aggregationTask != nullptr)
+    {   readingRequest.aggregationTask->complete(chl::CL_ERR_UNKNOWN); }
+    else if(readingRequest.summaryTask != nullptr)
+    {   readingRequest.summaryTask->complete(chl::CL_ERR_UNKNOWN); }
+
+    delete readingRequest.readingState;
+}
+
+////////////////////////
+
+void chronolog::ArchiveReadingAgent::startArchiveReading(int stream_count, XstreamPlacement*xstream_placement)
 {
     std::lock_guard lock(agentStateMutex);
     if(is_running() || is_shutting_down())
@@ -75,7 +293,8 @@ void chronolog::ArchiveReadingAgent::startArchiveReading(int stream_count)
 
     for(int i = 0; i < stream_count; ++i)
     {
-        tl::managed <tl::xstream> es = tl::xstream::create();
+        tl::managed <tl::xstream> es = (xstream_placement != nullptr
+                                        ? xstream_placement->createXstream(XSTREAM_IO) : tl::xstream::create());
         archiveReadingStreams.push_back(std::move(es));
     }
 
@@ -105,7 +324,8 @@ void chronolog::ArchiveReadingAgent::shutdownArchiveReading()
 
     agentState = SHUTTING_DOWN;
 
-    theReadingRequestQueue.clear();
+    // wake up the reading threads waiting for requests, no new requests are accepted from now on
+    theReadingRequestQueue.shutdown();
 
     // Join threads & execution streams while holding stateMutex
     // and just wait until all the events are collected and
@@ -121,6 +341,14 @@ void chronolog::ArchiveReadingAgent::shutdownArchiveReading()
         es->join();
     }
 
+    // release the requests still waiting in the queue, including the partially read ones
+    chl::ArchiveReadingRequest pendingRequest;
+    while(!theReadingRequestQueue.empty())
+    {
+        theReadingRequestQueue.popReadingRequest(pendingRequest);
+        releaseReadingRequest(pendingRequest);
+    }
+
     theReadingAgent.shutdown();
 
     LOG_INFO("[ReadingAgent] Archive reading is shutdown.");
@@ -10,10 +10,13 @@
 
 #include "ArchiveReadingRequestQueue.h"
 #include "HDF5ArchiveReadingAgent.h"
+#include "XstreamPlacement.h"
 
 namespace chronolog
 {
 
+class PlayerDataStore;
+
 class DummyReadingAgent 
 {
 public:
@@ -33,6 +36,31 @@ public:
     { return 1; }
 };
 
+// ReadingRequestState carries the progress of the ArchiveReadingRequest between its time slices:
+// the playback filter state and the playback StoryChunk holding the events read past the end of the current slice
+class ReadingRequestState
+{
+public:
+    explicit ReadingRequestState(PlaybackFilter const & playback_filter)
+        : eventSelector(playback_filter)
+        , playbackChunk(nullptr)
+    {}
+
+    ~ReadingRequestState()
+    { delete playbackChunk; }
+
+    PlaybackEventSelector * getSelector()
+    { return (eventSelector.is_pass_through() ? nullptr : &eventSelector); }
+
+    PlaybackEventSelector eventSelector;
+    StoryChunk * playbackChunk;
+
+private:
+    ReadingRequestState(ReadingRequestState const &) = delete;
+
+    ReadingRequestState &operator=(ReadingRequestState const &) = delete;
+};
+
 class ArchiveReadingAgent
 {
 
@@ -45,8 +73,10 @@ class ArchiveReadingAgent
 
 
 public:
-    ArchiveReadingAgent( ArchiveReadingRequestQueue & request_queue, std::string const & archive_path)
+    ArchiveReadingAgent( ArchiveReadingRequestQueue & request_queue, std::string const & archive_path
+                        , PlayerDataStore * recent_data_store = nullptr)
         : theReadingRequestQueue(request_queue)
+        , theRecentDataStore(recent_data_store)
         , agentState(UNKNOWN)
         , theReadingAgent(archive_path)
     {}
@@ -59,19 +89,40 @@ public:
     bool is_shutting_down() const
     { return (SHUTTING_DOWN == agentState); }
 
-    void startArchiveReading(int stream_count);
+    // the archive reading xstreams are pinned to the io cores of the placement if it is given
+    void startArchiveReading(int stream_count, XstreamPlacement*xstream_placement = nullptr);
 
     void shutdownArchiveReading();
 
     void archiveReadingTask();
 
 private:
+    void readArchiveSlice(ArchiveReadingRequest const &, chrono_time slice_end);
+
+    // merges the recent in-memory events of the range into the playbackChunk of the request
+    void mergeRecentPlaybackEvents(ArchiveReadingRequest const &, chrono_time range_start, chrono_time range_end);
+
+    // sends the playback events of the completed slice to the client
+    void streamPlaybackSlice(ArchiveReadingRequest const &, chrono_time slice_end);
+
+    void finishPlayback(ArchiveReadingRequest const &);
+
+    void finishAggregation(ArchiveReadingRequest const &);
+
+    void finishSummary(ArchiveReadingRequest const &);
+
+    // releases the request that won't be completed, the waiting tasks are completed with an error
+    void releaseReadingRequest(ArchiveReadingRequest const &);
+
     ArchiveReadingAgent(ArchiveReadingAgent const &) = delete;
 
     ArchiveReadingAgent &operator=(ArchiveReadingAgent const &) = delete;
 
     ArchiveReadingRequestQueue & theReadingRequestQueue;
 
+    // in-memory store of the recent events not yet archived by the Grapher
+    PlayerDataStore * theRecentDataStore;
+
     std::mutex agentStateMutex;
     ReadingAgentState agentState;
     std::vector <thallium::managed <thallium::xstream>> archiveReadingStreams;
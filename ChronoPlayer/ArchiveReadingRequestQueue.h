@@ -2,14 +2,38 @@
 #define ARCHIVE_READING_REQUEST_QUEUE_H
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <thallium.hpp>
 
 #include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::PlaybackFilter definition
+#include "PlayerStatsMsg.h"   //for chronolog::ReadingClassStats definition
+
+// requests covering longer time range are classified as bulk and read one slice at a time
+#define DEFAULT_READING_SLICE_WIDTH (300ULL * 1000000000ULL)
+// consecutive interactive slices served while bulk requests are waiting, before one bulk slice is served
+#define INTERACTIVE_READING_BURST 4
+
+namespace tl = thallium;
 
 namespace chronolog
 {
 
 class StoryChunkExtractionQueue;
+class StoryAggregationTask;
+class StorySummaryTask;
+class ReadingRequestState;
+
+enum ReadingPriority
+{
+    READING_INTERACTIVE = 0,
+    READING_BULK = 1
+};
 
 struct ArchiveReadingRequest
 {
@@ -17,66 +41,246 @@ struct ArchiveReadingRequest
     ChronicleName chronicleName;
     StoryName     storyName;
     chrono_time      startTime;
-    chrono_time      endTime;   
+    chrono_time      endTime;
+    PlaybackFilter   filter;
+    StoryAggregationTask * aggregationTask; // set for the aggregation queries instead of storyChunkQueue
+    StorySummaryTask * summaryTask;         // set for the range statistics queries instead of storyChunkQueue
+    std::string      clientKey;             // requests are scheduled fairly across the requesting clients
+    ReadingPriority  priority;              // assigned by the ArchiveReadingRequestQueue
+    chrono_time      sliceStart;            // [sliceStart, endTime[ is the part of the range still to be read
+    uint64_t         enqueueTime;           // steady clock time the request was first queued at
+    ReadingRequestState * readingState;     // reading agent state carried between the slices of the request
 
-    ArchiveReadingRequest( StoryChunkExtractionQueue* queue = nullptr, 
-        ChronicleName const& chronicle=std::string(), StoryName const& story=std::string(), chrono_time const& start=0, chrono_time const& end=0)
+    ArchiveReadingRequest( StoryChunkExtractionQueue* queue = nullptr,
+        ChronicleName const& chronicle=std::string(), StoryName const& story=std::string(), chrono_time const& start=0, chrono_time const& end=0
+        , PlaybackFilter const& playback_filter = PlaybackFilter(), StoryAggregationTask * aggregation_task = nullptr
+        , StorySummaryTask * summary_task = nullptr, std::string const& client_key = std::string())
     : storyChunkQueue(queue)
     , chronicleName(chronicle)
     , storyName(story)
     , startTime(start)
     , endTime(end)
-    { } 
+    , filter(playback_filter)
+    , aggregationTask(aggregation_task)
+    , summaryTask(summary_task)
+    , clientKey(client_key)
+    , priority(READING_INTERACTIVE)
+    , sliceStart(start)
+    , enqueueTime(0)
+    , readingState(nullptr)
+    { }
+
+    bool empty() const
+    { return (storyChunkQueue == nullptr && aggregationTask == nullptr && summaryTask == nullptr); }
 };
 
+// ArchiveReadingRequestQueue schedules the archive reading requests:
+// requests spanning more than one slice width are bulk requests, the rest are interactive;
+// interactive requests are served first, with one bulk slice let through after INTERACTIVE_READING_BURST
+// interactive ones so that the bulk requests make progress;
+// within the class the clients are served round robin, one slice at a time,
+// the reading agent returns the unfinished request to the queue after each slice
+// so a long export of one client interleaves with the requests of the others.
+// The waiting reading threads are Argobots ULTs sharing the reading xstreams,
+// so the queue is guarded by the Argobots mutex and condition variable that yield the xstream
+// to the other ULTs instead of blocking it; the queue has to be created within the Argobots scope.
+
 class ArchiveReadingRequestQueue
 {
 public:
-    ArchiveReadingRequestQueue()
+    explicit ArchiveReadingRequestQueue(chrono_time slice_width = DEFAULT_READING_SLICE_WIDTH)
+        : sliceWidth(std::max <chrono_time>(slice_width, 1))
+        , queuedCount(0)
+        , interactiveBurst(0)
+        , shuttingDown(false)
     {}
-    
+
     ~ArchiveReadingRequestQueue()
     {}
 
     bool empty() const
-    {   return readingRequestQueue.empty(); }
+    {   return (queuedCount.load() == 0); }
+
+    chrono_time getSliceWidth() const
+    { return sliceWidth; }
 
-    void pushReadingRequest(ArchiveReadingRequest const& a_request)
+    // end of the next slice to read for the request
+    chrono_time getSliceEnd(ArchiveReadingRequest const& a_request) const
     {
-        std::lock_guard<std::mutex> lock(readingRequestQueueMutex);
-        readingRequestQueue.push_back(a_request);
+        if(a_request.endTime - a_request.sliceStart <= sliceWidth)
+        { return a_request.endTime; }
+        return a_request.sliceStart + sliceWidth;
     }
-          
-    ArchiveReadingRequest & popReadingRequest( ArchiveReadingRequest & a_request)
+
+    // returns false if the queue is shut down and the request is not accepted
+    bool pushReadingRequest(ArchiveReadingRequest const& a_request)
     {
-        std::lock_guard<std::mutex> lock(readingRequestQueueMutex);
-        if( !readingRequestQueue.empty())
         {
-            a_request = readingRequestQueue.front();
-            readingRequestQueue.pop_front();
+            std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+            if(shuttingDown)
+            { return false; }
+
+            ArchiveReadingRequest queued_request(a_request);
+            if(queued_request.enqueueTime == 0)
+            {
+                // first push of the request, not the return of the partially read one
+                queued_request.enqueueTime = std::chrono::steady_clock::now().time_since_epoch().count();
+                queued_request.sliceStart = std::max(queued_request.sliceStart, queued_request.startTime);
+                queued_request.priority = (queued_request.endTime - queued_request.startTime > sliceWidth ? READING_BULK
+                                                                                                         : READING_INTERACTIVE);
+            }
+
+            PriorityClass & priority_class = priorityClasses[queued_request.priority];
+            auto client_iter = priority_class.clientQueues.find(queued_request.clientKey);
+            if(client_iter == priority_class.clientQueues.end())
+            {
+                client_iter = priority_class.clientQueues.emplace(queued_request.clientKey
+                                                                  , std::deque<ArchiveReadingRequest>()).first;
+                priority_class.clientRotation.push_back(queued_request.clientKey);
+            }
+            (*client_iter).second.push_back(queued_request);
+            priority_class.queueDepth++;
+            queuedCount++;
         }
-        else 
+        readingRequestAvailable.notify_one();
+        return true;
+    }
+
+    ArchiveReadingRequest & popReadingRequest( ArchiveReadingRequest & a_request)
+    {
+        std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+        return takeNextRequest(a_request);
+    }
+
+    // waits for the next scheduled request, returns an empty request when the queue is shut down
+    ArchiveReadingRequest & waitReadingRequest( ArchiveReadingRequest & a_request)
+    {
+        std::unique_lock<tl::mutex> lock(readingRequestQueueMutex);
+        readingRequestAvailable.wait(lock, [this]() { return (queuedCount != 0 || shuttingDown); });
+        return takeNextRequest(a_request);
+    }
+
+    // called by the reading agent once the last slice of the request has been read
+    void completeReadingRequest(ArchiveReadingRequest const& a_request)
+    {
+        uint64_t latency = std::chrono::steady_clock::now().time_since_epoch().count() - a_request.enqueueTime;
+
+        std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+        PriorityClass & priority_class = priorityClasses[a_request.priority];
+        priority_class.completedRequests++;
+        priority_class.latencySum += latency;
+        priority_class.maxLatency = std::max(priority_class.maxLatency, latency);
+    }
+
+    // queue depths and the latencies of the requests completed since the previous call
+    void collectReadingStats(ReadingClassStats & interactive_stats, ReadingClassStats & bulk_stats)
+    {
+        std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+        collectClassStats(priorityClasses[READING_INTERACTIVE], interactive_stats);
+        collectClassStats(priorityClasses[READING_BULK], bulk_stats);
+    }
+
+    // wakes up all the waiting reading threads, no new requests are accepted after this call
+    void shutdown()
+    {
         {
-            a_request = ArchiveReadingRequest{nullptr,"","",0,0};
+            std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+            shuttingDown = true;
         }
-
-        return a_request;    
+        readingRequestAvailable.notify_all();
     }
 
     void clear()
     {
-        std::lock_guard<std::mutex> lock(readingRequestQueueMutex);
-        readingRequestQueue.clear();
+        std::lock_guard<tl::mutex> lock(readingRequestQueueMutex);
+        for(auto & priority_class: priorityClasses)
+        {
+            priority_class.clientQueues.clear();
+            priority_class.clientRotation.clear();
+            priority_class.queueDepth = 0;
+        }
+        queuedCount = 0;
     }
 
-            
+
 private:
     ArchiveReadingRequestQueue(ArchiveReadingRequestQueue const &) = delete;
 
     ArchiveReadingRequestQueue &operator=( ArchiveReadingRequestQueue const &) = delete;
 
-    std::mutex  readingRequestQueueMutex;
-    std::deque<ArchiveReadingRequest> readingRequestQueue;
+    struct PriorityClass
+    {
+        std::map<std::string, std::deque<ArchiveReadingRequest>> clientQueues;
+        std::deque<std::string> clientRotation;  // clients with queued requests, in round robin order
+        uint32_t queueDepth = 0;
+        uint64_t completedRequests = 0;
+        uint64_t latencySum = 0;
+        uint64_t maxLatency = 0;
+    };
+
+    // readingRequestQueueMutex is expected to be held by the caller
+    ArchiveReadingRequest & takeNextRequest( ArchiveReadingRequest & a_request)
+    {
+        if(queuedCount == 0)
+        {
+            a_request = ArchiveReadingRequest{nullptr,"","",0,0};
+            return a_request;
+        }
+
+        PriorityClass & interactive_class = priorityClasses[READING_INTERACTIVE];
+        PriorityClass & bulk_class = priorityClasses[READING_BULK];
+        PriorityClass * priority_class = &interactive_class;
+        if(interactive_class.queueDepth == 0
+            || (bulk_class.queueDepth != 0 && interactiveBurst >= INTERACTIVE_READING_BURST))
+        {
+            priority_class = &bulk_class;
+            interactiveBurst = 0;
+        }
+        else
+        {
+            interactiveBurst++;
+        }
+
+        std::string client_key = priority_class->clientRotation.front();
+        priority_class->clientRotation.pop_front();
+
+        auto client_iter = priority_class->clientQueues.find(client_key);
+        a_request = (*client_iter).second.front();
+        (*client_iter).second.pop_front();
+        if((*client_iter).second.empty())
+        {
+            priority_class->clientQueues.erase(client_iter);
+        }
+        else
+        {
+            priority_class->clientRotation.push_back(client_key);
+        }
+
+        priority_class->queueDepth--;
+        queuedCount--;
+        return a_request;
+    }
+
+    static void collectClassStats(PriorityClass & priority_class, ReadingClassStats & stats)
+    {
+        stats.queueDepth = priority_class.queueDepth;
+        stats.completedRequests = priority_class.completedRequests;
+        stats.meanLatency = (priority_class.completedRequests == 0 ? 0
+                                                                   : priority_class.latencySum / priority_class.completedRequests);
+        stats.maxLatency = priority_class.maxLatency;
+
+        priority_class.completedRequests = 0;
+        priority_class.latencySum = 0;
+        priority_class.maxLatency = 0;
+    }
+
+    chrono_time sliceWidth;
+    tl::mutex   readingRequestQueueMutex;
+    tl::condition_variable readingRequestAvailable;
+    PriorityClass priorityClasses[2];
+    std::atomic<uint32_t> queuedCount;  // updated under readingRequestQueueMutex, read without it by empty()
+    uint32_t interactiveBurst;
+    bool shuttingDown;
 
 };
 
@@ -10,12 +10,19 @@
 #include "StoryChunkExtractionQueue.h"
 #include "PlayerDataStore.h"
 #include "PlayerStoreAdminService.h"
+#include "PlayerRecordingService.h"
 #include "ConfigurationManager.h"
 #include "cmd_arg_parse.h"
 
 #include "ArchiveReadingAgent.h"
 #include "ArchiveReadingRequestQueue.h"
 #include "PlaybackService.h"
+#include "MetricsRegistry.h"
+#include "XstreamPlacement.h"
+
+// the registration is re-sent every this many stats messages, which re-registers the process
+// with the ChronoVisor restarted from its metadata store
+#define VISOR_REGISTRATION_REFRESH_CYCLES 6
 
 namespace chl = chronolog;
 namespace tl = thallium;
@@ -54,11 +61,13 @@ int main(int argc, char**argv)
                                                        , PLAYER_CONF.LOG_CONF.LOGNAME
                                                        , PLAYER_CONF.LOG_CONF.LOGFILESIZE
                                                        , PLAYER_CONF.LOG_CONF.LOGFILENUM
-                                                       , PLAYER_CONF.LOG_CONF.FLUSHLEVEL);
+                                                       , PLAYER_CONF.LOG_CONF.FLUSHLEVEL
+                                                       , PLAYER_CONF.LOG_CONF.ASYNC);
     if(result == 1)
     {
         exit(EXIT_FAILURE);
     }
+    chronolog::chrono_monitor::setModuleLevels(PLAYER_CONF.LOG_CONF.MODULE_LEVELS);
 
     LOG_INFO("Running ChronoPlayer ");
     LOG_INFO("[ChronoPlayer]  Configuration {}", PLAYER_CONF.to_String());
@@ -98,6 +107,9 @@ int main(int argc, char**argv)
     }
 
 
+    // Argobots is initialized ahead of the reading request queue that is guarded by the Argobots mutex
+    tl::abt scope;
+
     tl::engine * playbackEngine = nullptr;
     chronolog::PlaybackService * playbackService = nullptr;
     chronolog::ArchiveReadingRequestQueue readingRequestQueue;
@@ -137,8 +149,19 @@ int main(int argc, char**argv)
     // Instantiate MemoryDataStore & ExtractorModule
     chronolog::StoryChunkIngestionQueue ingestionQueue;
     chronolog::StoryChunkExtractionQueue extractionQueue;
+    // xstreams of the recording handlers, data collection and archive reading pinned to their configured cores;
+    // declared ahead of the modules whose xstreams run its pools
+    chronolog::XstreamPlacement xstreamPlacement;
+    if(xstreamPlacement.initialize(PLAYER_CONF.CORE_PLACEMENT_CONF) != chronolog::CL_SUCCESS)
+    {
+        LOG_CRITICAL("[ChronoPlayer] Invalid CorePlacement configuration; exiting");
+        return (-1);
+    }
 
-    chronolog::PlayerDataStore theDataStore(ingestionQueue, extractionQueue);
+    chronolog::PlayerDataStore theDataStore(ingestionQueue, extractionQueue,
+                PLAYER_CONF.DATA_STORE_CONF.story_chunk_duration_secs,
+                PLAYER_CONF.DATA_STORE_CONF.acceptance_window_secs,
+                PLAYER_CONF.DATA_STORE_CONF.inactive_story_delay_secs);
 
     tl::engine * dataAdminEngine = nullptr;
 
@@ -176,6 +199,49 @@ int main(int argc, char**argv)
 
     LOG_INFO("[ChronoPlayer] started AdminService at {}", chl::to_string(playerAdminServiceId));
 
+    // Instantiate RecordingService receiving the recent StoryChunks from the Grapher
+    chronolog::ServiceId recordingServiceId( PLAYER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.PROTO_CONF,
+        PLAYER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.IP,
+        PLAYER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.BASE_PORT,
+        PLAYER_CONF.GRAPHER_PLAYER_DRAIN_SERVICE_CONF.SERVICE_PROVIDER_ID);
+
+    tl::engine * recordingEngine = nullptr;
+    chronolog::PlayerRecordingService * playerRecordingService = nullptr;
+
+    try
+    {
+        std::string RECORDING_SERVICE_NA_STRING;
+        recordingServiceId.get_service_as_string(RECORDING_SERVICE_NA_STRING);
+
+        margo_instance_id recording_margo_id = margo_init(RECORDING_SERVICE_NA_STRING.c_str(), MARGO_SERVER_MODE, 1, 1);
+
+        recordingEngine = new tl::engine(recording_margo_id);
+
+        LOG_DEBUG("[ChronoPlayer] starting RecordingService at {}", chl::to_string(recordingServiceId));
+
+        tl::pool recording_handler_pool = xstreamPlacement.createHandlerXstreams(chronolog::XSTREAM_RPC);
+        playerRecordingService = chronolog::PlayerRecordingService::CreateRecordingService(*recordingEngine
+                                                                                          , recordingServiceId.getProviderId()
+                                                                                          , ingestionQueue
+                                                                                          , recording_handler_pool);
+    }
+    catch(tl::exception const & ex)
+    {
+        LOG_ERROR("[ChronoPlayer]  failed to create RecordingService at {} exception:{}", chl::to_string(recordingServiceId), ex.what());
+        playerRecordingService = nullptr;
+    }
+
+    if(nullptr == playerRecordingService)
+    {
+        // playback of the archived data doesn't depend on the RecordingService
+        LOG_WARNING("[ChronoPlayer] failed to create RecordingService at {}, only archived events would be played back"
+                    , chl::to_string(recordingServiceId));
+    }
+    else
+    {
+        LOG_INFO("[ChronoPlayer] started RecordingService at {}", chl::to_string(recordingServiceId));
+    }
+
     /// RegistryClient SetUp _____________________________________________________________________________________
     // create RegistryClient and register the new Recording service with the Registry
     std::string REGISTRY_SERVICE_NA_STRING = PLAYER_CONF.VISOR_REGISTRY_SERVICE_CONF.PROTO_CONF + "://" +
@@ -199,7 +265,7 @@ int main(int argc, char**argv)
     chronolog::ArchiveReadingAgent * archiveReadingAgent = nullptr;
 
     std::string archive_path = PLAYER_CONF.READER_CONF.story_files_dir;
-    archiveReadingAgent = new chronolog::ArchiveReadingAgent(readingRequestQueue, archive_path);
+    archiveReadingAgent = new chronolog::ArchiveReadingAgent(readingRequestQueue, archive_path, &theDataStore);
 
     /// Registration with ChronoVisor __________________________________________________________________________________
     // try to register with chronoVisor a few times than log ERROR and exit...
@@ -229,21 +295,44 @@ int main(int argc, char**argv)
     /// Start data collection and extraction threads ___________________________________________________________________
     // services are successfully created and keeper process had registered with ChronoVisor
     // start all dataCollection and Extraction threads...
-    tl::abt scope;
-   // theDataStore.startDataCollection(3);
+    theDataStore.startDataCollection(1, &xstreamPlacement);
     // start extraction streams & threads
     //storyExtractor.startExtractionThreads(2);
     int NUMBER_ARCHIVE_READING_STREAMS = 1;
-    archiveReadingAgent->startArchiveReading(NUMBER_ARCHIVE_READING_STREAMS); 
+    archiveReadingAgent->startArchiveReading(NUMBER_ARCHIVE_READING_STREAMS, &xstreamPlacement);
 
     /// Main loop for sending stats message until receiving SIGTERM ____________________________________________________
     // now we are ready to ingest records coming from the storyteller clients ....
     // main thread would be sending stats message until keeper process receives
     // sigterm signal
     chronolog::PlayerStatsMsg playerStatsMsg(playerIdCard);
+    chronolog::ReadingClassStats interactiveReadingStats;
+    chronolog::ReadingClassStats bulkReadingStats;
+    uint64_t statsCycle = 0;
+
+    chronolog::MetricsRegistry & metricsRegistry = chronolog::MetricsRegistry::getInstance();
+    chronolog::MetricsGauge* interactiveQueueGauge = metricsRegistry.getGauge("player_interactive_reading_queue_depth");
+    chronolog::MetricsGauge* bulkQueueGauge = metricsRegistry.getGauge("player_bulk_reading_queue_depth");
+    std::vector<chronolog::MetricSummary> metricsRollup;
+    if(!PLAYER_CONF.METRICS_CONF.dump_file.empty())
+    {
+        metricsRegistry.startPeriodicDump(PLAYER_CONF.METRICS_CONF.dump_file, PLAYER_CONF.METRICS_CONF.dump_interval_secs);
+    }
     while(keep_running)
     {
+        readingRequestQueue.collectReadingStats(interactiveReadingStats, bulkReadingStats);
+        playerStatsMsg.setReadingStats(interactiveReadingStats, bulkReadingStats);
+        interactiveQueueGauge->set(interactiveReadingStats.queueDepth);
+        bulkQueueGauge->set(bulkReadingStats.queueDepth);
+        metricsRollup.clear();
+        metricsRegistry.getRollup(metricsRollup);
+        playerStatsMsg.setMetricsRollup(metricsRollup);
         playerRegistryClient->send_stats_msg(playerStatsMsg);
+        if(++statsCycle % VISOR_REGISTRATION_REFRESH_CYCLES == 0)
+        {
+            playerRegistryClient->send_register_msg(
+                    chronolog::PlayerRegistrationMsg(playerIdCard, playerAdminServiceId));
+        }
         sleep(10);
     }
 
@@ -251,23 +340,26 @@ int main(int argc, char**argv)
     // Unregister from the chronoVisor so that no new story requests would be coming
     playerRegistryClient->send_unregister_msg(playerIdCard);
     delete playerRegistryClient;
+    metricsRegistry.stopPeriodicDump();
 
     /// Stop services and shut down ____________________________________________________________________________________
     LOG_INFO("[ChronoPlayer] Initiating shutdown procedures.");
     
     archiveReadingAgent->shutdownArchiveReading(); 
     delete archiveReadingAgent;
+    delete playerRecordingService;
+    xstreamPlacement.shutdownHandlerXstreams();
     delete playerStoreAdminService;
     delete playbackService;
     // Shutdown the Data Collection
-    //theDataStore.shutdownDataCollection();
+    theDataStore.shutdownDataCollection();
     // Shutdown extraction module
     // drain extractionQueue and stop extraction xStreams
     //storyExtractor.shutdownExtractionThreads();
     // these are not probably needed as thallium handles the engine finalization...
     //  recordingEngine.finalize();
     //  collectionEngine.finalize();
-   // delete recordingEngine;
+    delete recordingEngine;
     delete dataAdminEngine;
     delete playbackEngine;
     LOG_INFO("[ChronoPlayer] Shutdown completed. Exiting.");
@@ -1,9 +1,11 @@
 #include <sys/inotify.h>
 #include <H5Cpp.h>
 #include <filesystem>
+#include <limits>
 
 #include "chronolog_errcode.h"
 #include "StoryChunkWriter.h"
+#include "RecordTemplateDictionary.h"
 #include "HDF5ArchiveReadingAgent.h"
 
 namespace tl = thallium;
@@ -38,10 +40,132 @@ herr_t error_walker(unsigned int n, const H5E_error2_t *err_desc, void *client_d
     return 0;
 }
 
+// columnar pass over the archived events for the aggregation queries;
+// the record views point into the HDF5 read buffer and are only valid while the buffer is alive
+static void aggregateEventData(std::vector <LogEventHVL> const &data, uint64_t startTime, uint64_t endTime
+                               , PlaybackEventSelector *selector, StoryAggregator &aggregator)
+{
+    std::vector <chrono_time> event_times;
+    std::vector <ClientId> client_ids;
+    std::vector <std::string_view> records;
+    event_times.reserve(data.size());
+    client_ids.reserve(data.size());
+    records.reserve(data.size());
+
+    for(auto const &event_hvl: data)
+    {
+        if(event_hvl.eventTime < startTime)
+        { continue; }
+        if(event_hvl.eventTime >= endTime)
+        { break; }
+
+        aggregator.advanceArchiveHorizon(EventSequence(event_hvl.eventTime, event_hvl.clientId, event_hvl.eventIndex));
+
+        std::string_view record(static_cast<char *>(event_hvl.logRecord.p), event_hvl.logRecord.len);
+        if(selector != nullptr && !selector->select(event_hvl.clientId, record))
+        { continue; }
+
+        event_times.push_back(event_hvl.eventTime);
+        client_ids.push_back(event_hvl.clientId);
+        records.push_back(record);
+    }
+
+    aggregator.aggregateEvents(event_times, client_ids, records);
+}
+
+// summary of the events in range computed from the event data, used for the chunks that are not fully in range
+// or were archived without the summary dataset
+static void summarizeEventData(std::vector <LogEventHVL> const &data, uint64_t startTime, uint64_t endTime
+                               , StoryChunkSummary &summary)
+{
+    for(auto const &event_hvl: data)
+    {
+        if(event_hvl.eventTime < startTime)
+        { continue; }
+        if(event_hvl.eventTime >= endTime)
+        { break; }
+
+        summary.addEvent(event_hvl.eventTime, event_hvl.clientId, event_hvl.eventIndex, event_hvl.logRecord.len);
+    }
+}
+
+// returns false if the file has no summary dataset or the summary can't be decoded
+static bool readSummaryDataset(H5::H5File &file, StoryChunkSummary &summary)
+{
+    std::string summary_dataset_name = "/story_chunks/data.summary";
+    try
+    {
+        if(H5Lexists(file.getId(), summary_dataset_name.c_str(), H5P_DEFAULT) <= 0)
+        { return false; }
+
+        H5::DataSet summary_dataset = file.openDataSet(summary_dataset_name);
+        hsize_t summary_size = 0;
+        summary_dataset.getSpace().getSimpleExtentDims(&summary_size, nullptr);
+
+        std::string encoded_summary(summary_size, '\0');
+        summary_dataset.read(encoded_summary.data(), H5::PredType::NATIVE_UINT8);
+        return summary.decode(encoded_summary);
+    }
+    catch(H5::Exception &error)
+    {
+        LOG_WARNING("[HDF5ArchiveReadingAgent] Failed to read chunk summary : {}", error.getCDetailMsg());
+    }
+    return false;
+}
+
+// the records of the chunk archived with the record templates are decoded in place, only for the events in range;
+// returns false if the file has the dictionary dataset but it or one of the records can't be decoded
+static bool decodeRecordTemplates(H5::H5File &file, std::vector <LogEventHVL> &data, uint64_t startTime
+                                  , uint64_t endTime)
+{
+    std::string dictionary_dataset_name = "/story_chunks/data.templates";
+    if(H5Lexists(file.getId(), dictionary_dataset_name.c_str(), H5P_DEFAULT) <= 0)
+    { return true; }
+
+    H5::DataSet dictionary_dataset = file.openDataSet(dictionary_dataset_name);
+    hsize_t dictionary_size = 0;
+    dictionary_dataset.getSpace().getSimpleExtentDims(&dictionary_size, nullptr);
+    std::string encoded_dictionary(dictionary_size, '\0');
+    dictionary_dataset.read(encoded_dictionary.data(), H5::PredType::NATIVE_UINT8);
+
+    RecordTemplateDictionary dictionary;
+    if(!dictionary.decode(encoded_dictionary))
+    {
+        LOG_WARNING("[HDF5ArchiveReadingAgent] Failed to decode the record template dictionary");
+        return false;
+    }
+
+    std::string record;
+    for(auto &event_hvl: data)
+    {
+        if(event_hvl.eventTime < startTime)
+        { continue; }
+        if(event_hvl.eventTime >= endTime)
+        { break; }
+
+        if(!dictionary.decodeRecord(std::string_view(static_cast<char *>(event_hvl.logRecord.p)
+                                                     , event_hvl.logRecord.len), record))
+        {
+            LOG_WARNING("[HDF5ArchiveReadingAgent] Failed to decode the record of event {}:{}:{}", event_hvl.eventTime
+                        , event_hvl.clientId, event_hvl.eventIndex);
+            return false;
+        }
+        hvl_t log_record;
+        log_record.len = record.size();
+        log_record.p = record.data();
+        event_hvl = LogEventHVL(event_hvl.storyId, event_hvl.eventTime, event_hvl.clientId, event_hvl.eventIndex
+                                , log_record);
+    }
+    return true;
+}
+
 int chronolog::HDF5ArchiveReadingAgent::readStoryChunkFile(const ChronicleName &chronicleName, const StoryName &storyName
                                                             , uint64_t startTime, uint64_t endTime
                                                             , std::list <StoryChunk *> &listOfChunks
-                                                            , const std::string &file_name)
+                                                            , const std::string &file_name
+                                                            , PlaybackEventSelector *selector
+                                                            , StoryAggregator *aggregator
+                                                            , StoryChunkSummary *summary)
 {
     std::unique_ptr <H5::H5File> file;
     StoryChunk *story_chunk = nullptr;
@@ -52,6 +176,19 @@ int chronolog::HDF5ArchiveReadingAgent::readStoryChunkFile(const ChronicleName &
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Opening file {}", file_name);
         file = std::make_unique <H5::H5File>(file_name, H5F_ACC_SWMR_READ);
 
+        if(summary != nullptr)
+        {
+            StoryChunkSummary chunk_summary;
+            if(readSummaryDataset(*file, chunk_summary) && (chunk_summary.empty()
+               || (chunk_summary.getFirstEventTime() >= startTime && chunk_summary.getLastEventTime() < endTime)))
+            {
+                LOG_DEBUG("[HDF5ArchiveReadingAgent] Using archived summary of {} events from file {}"
+                          , chunk_summary.getEventCount(), file_name);
+                summary->merge(chunk_summary);
+                return 0;
+            }
+        }
+
         std::string dataset_name = "/story_chunks/data.vlen_bytes";
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Opening dataset {}", dataset_name);
         H5::DataSet dataset = file->openDataSet(dataset_name);
@@ -80,6 +217,28 @@ int chronolog::HDF5ArchiveReadingAgent::readStoryChunkFile(const ChronicleName &
         std::vector <LogEventHVL> data;
         data.resize(dims_out[0]);
         dataset.read(data.data(), defined_comp_type);
+        if(!decodeRecordTemplates(*file, data, startTime, endTime))
+        {
+            LOG_WARNING("[HDF5ArchiveReadingAgent] Error reading dataset {} : Record template decoding failed"
+                        , file_name);
+            return CL_ERR_UNKNOWN;
+        }
+
+        if(aggregator != nullptr)
+        {
+            LOG_DEBUG("[HDF5ArchiveReadingAgent] Aggregating events of {}-{} range {}-{}", chronicleName, storyName
+                      , startTime, endTime);
+            aggregateEventData(data, startTime, endTime, selector, *aggregator);
+            return 0;
+        }
+
+        if(summary != nullptr)
+        {
+            LOG_DEBUG("[HDF5ArchiveReadingAgent] Summarizing events of {}-{} range {}-{} from file {}", chronicleName
+                      , storyName, startTime, endTime, file_name);
+            summarizeEventData(data, startTime, endTime, *summary);
+            return 0;
+        }
 
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Creating StoryChunk {}-{} range {}-{}...", chronicleName, storyName
                   , startTime, endTime);
@@ -99,9 +258,33 @@ int chronolog::HDF5ArchiveReadingAgent::readStoryChunkFile(const ChronicleName &
                 break;
             }
 
+            if(selector != nullptr)
+            {
+                if(selector->is_exhausted())
+                {
+                    LOG_DEBUG("[HDF5ArchiveReadingAgent] Stopping reading events at time {}, playback limit reached"
+                              , event_hvl.eventTime);
+                    break;
+                }
+                selector->advanceArchiveHorizon(EventSequence(event_hvl.eventTime, event_hvl.clientId, event_hvl.eventIndex));
+                // evaluate the filter on the raw record so the rejected events are never copied
+                if(!selector->select(event_hvl.clientId, std::string_view(static_cast<char *>(event_hvl.logRecord.p)
+                                                                          , event_hvl.logRecord.len)))
+                {
+                    continue;
+                }
+            }
+
             LogEvent event(event_hvl.storyId, event_hvl.eventTime, event_hvl.clientId, event_hvl.eventIndex
                            , std::string(static_cast<char *>(event_hvl.logRecord.p), event_hvl.logRecord.len));
-            story_chunk->insertEvent(event);
+            if(selector != nullptr)
+            {
+                selector->keep(*story_chunk, event);
+            }
+            else
+            {
+                story_chunk->insertEvent(event);
+            }
         }
 
         if(story_chunk->getEventCount() > 0)
@@ -151,7 +334,24 @@ int chronolog::HDF5ArchiveReadingAgent::readArchivedStory(const ChronicleName &c
                                                           , const StoryName &storyName
                                                           , uint64_t startTime, uint64_t endTime
                                                           , std::list <StoryChunk *> &listOfChunks
-                                                          , bool readAuxFiles)
+                                                          , bool readAuxFiles
+                                                          , PlaybackEventSelector *selector
+                                                          , StoryAggregator *aggregator
+                                                          , StoryChunkSummary *summary)
+{
+    return readArchivedStorySlice(chronicleName, storyName, startTime, endTime, startTime, endTime, listOfChunks
+                                  , readAuxFiles, selector, aggregator, summary);
+}
+
+int chronolog::HDF5ArchiveReadingAgent::readArchivedStorySlice(const ChronicleName &chronicleName
+                                                          , const StoryName &storyName
+                                                          , uint64_t startTime, uint64_t endTime
+                                                          , uint64_t fileStartTime, uint64_t fileEndTime
+                                                          , std::list <StoryChunk *> &listOfChunks
+                                                          , bool readAuxFiles
+                                                          , PlaybackEventSelector *selector
+                                                          , StoryAggregator *aggregator
+                                                          , StoryChunkSummary *summary)
 {
     // find all HDF5 files in the archive directory the start time of which falls in the range [startTime, endTime)
     // for each file, read Events in the StoryChunk and add matched ones to the list of StoryChunks
@@ -167,8 +367,11 @@ int chronolog::HDF5ArchiveReadingAgent::readArchivedStory(const ChronicleName &c
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Reading archived story {}-{} range {}-{}, main and auxiliary files"
               , chronicleName, storyName, startTime, endTime);
     }
-    auto start_it = start_time_file_name_map_.lower_bound(std::make_tuple(chronicleName, storyName, startTime));
-    auto end_it = start_time_file_name_map_.upper_bound(std::make_tuple(chronicleName, storyName, endTime));
+    // all the shard files of the story chunks in the range are read, their events are merged in the EventSequence order
+    auto start_it = start_time_file_name_map_.lower_bound(
+            std::make_tuple(chronicleName, storyName, fileStartTime, uint32_t(0)));
+    auto end_it = start_time_file_name_map_.upper_bound(
+            std::make_tuple(chronicleName, storyName, fileEndTime, std::numeric_limits <uint32_t>::max()));
     LOG_DEBUG("[HDF5ArchiveReadingAgent] readArchiveStory {}-{} range {}-{}", chronicleName, storyName, startTime
               , endTime);
 
@@ -201,11 +404,20 @@ int chronolog::HDF5ArchiveReadingAgent::readArchivedStory(const ChronicleName &c
 
     for(auto it = start_it; it != end_it; ++it)
     {
+        if(selector != nullptr && selector->is_exhausted())
+        {
+            LOG_DEBUG("[HDF5ArchiveReadingAgent] Playback limit reached for story {}-{}, skipping remaining files"
+                      , chronicleName, storyName);
+            break;
+        }
+
         file_full_path = fs::path(it->second);
 
         // file_name should be in the format of /path/to/output/{chronicleName}.{storyName}.{startTime}.vlen.h5
+        // or /path/to/output/{chronicleName}.{storyName}.{startTime}.shard{N}.vlen.h5
         file_name = file_full_path.string();
-        readStoryChunkFile(chronicleName, storyName, startTime, endTime, listOfChunks, file_name);
+        readStoryChunkFile(chronicleName, storyName, startTime, endTime, listOfChunks, file_name, selector, aggregator
+                           , summary);
 
         if(readAuxFiles)
         {
@@ -232,7 +444,8 @@ int chronolog::HDF5ArchiveReadingAgent::readArchivedStory(const ChronicleName &c
                     if(fs::exists(file_name))
                     {
                         LOG_DEBUG("[HDF5ArchiveReadingAgent] Reading numbered file: {}", file_name);
-                        readStoryChunkFile(chronicleName, storyName, startTime, endTime, listOfChunks, file_name);
+                        readStoryChunkFile(chronicleName, storyName, startTime, endTime, listOfChunks, file_name
+                                           , selector, aggregator, summary);
                     }
                     else
                     {
@@ -9,6 +9,9 @@
 #include <utility>
 
 #include "StoryChunkIngestionQueue.h"
+#include "PlaybackEventSelector.h"
+#include "StoryAggregator.h"
+#include "StoryChunkSummary.h"
 
 namespace tl = thallium;
 namespace fs = std::filesystem;
@@ -40,11 +43,24 @@ public:
         return 0;
     }
 
+    // when the PlaybackEventSelector is provided only the events it selects are added to the StoryChunks,
+    // when the StoryAggregator is provided the selected events are aggregated instead of being added to the StoryChunks,
+    // when the StoryChunkSummary is provided the events are summarized instead, using the archived chunk summary
+    // without reading the events if the whole chunk falls in the range
     int readStoryChunkFile(const ChronicleName&, const StoryName&, uint64_t, uint64_t, std::list<StoryChunk*>&
-                          , const std::string &);
+                          , const std::string &, PlaybackEventSelector * = nullptr, StoryAggregator * = nullptr
+                          , StoryChunkSummary * = nullptr);
 
     int readArchivedStory(const ChronicleName&, const StoryName&, uint64_t, uint64_t, std::list<StoryChunk*>&
-                          , bool = false);
+                          , bool = false, PlaybackEventSelector * = nullptr, StoryAggregator * = nullptr
+                          , StoryChunkSummary * = nullptr);
+
+    // reads the events in the [startTime, endTime[ range from the archive files whose start time
+    // is in the [fileStartTime, fileEndTime] range, so that a long range can be read one slice of files at a time
+    int readArchivedStorySlice(const ChronicleName&, const StoryName&, uint64_t startTime, uint64_t endTime
+                          , uint64_t fileStartTime, uint64_t fileEndTime, std::list<StoryChunk*>&
+                          , bool = false, PlaybackEventSelector * = nullptr, StoryAggregator * = nullptr
+                          , StoryChunkSummary * = nullptr);
 
     static std::string getChronicleName(const std::string &file_name)
     {
@@ -88,6 +104,33 @@ public:
         return start_time_in_ns;
     }
 
+    static uint32_t getShardIndex(const std::string &file_name)
+    {
+        // Example shard file name: /home/kfeng/chronolog/Debug/output/chronicle_0_0.story_0_0.1736806500.shard2.vlen.h5
+        // the files of the unsharded stories belong to shard 0
+        std::string base_name = fs::path(file_name).filename().string();
+        size_t first_dot = base_name.find_first_of('.');
+        size_t second_dot = base_name.find_first_of('.', first_dot + 1);
+        size_t third_dot = base_name.find_first_of('.', second_dot + 1);
+        if(third_dot == std::string::npos)
+        { return 0; }
+        size_t fourth_dot = base_name.find_first_of('.', third_dot + 1);
+        std::string shard_str = base_name.substr(third_dot + 1, fourth_dot - third_dot - 1);
+        if(shard_str.size() <= 5 || shard_str.compare(0, 5, "shard") != 0 ||
+           !std::all_of(shard_str.begin() + 5, shard_str.end(), ::isdigit))
+        { return 0; }
+        try
+        {
+            return std::stoul(shard_str.substr(5));
+        }
+        catch(const std::exception &e)
+        {
+            LOG_ERROR("[HDF5ArchiveReadingAgent] Failed to convert shard index string '{}' to uint32_t: {}"
+                      , shard_str, e.what());
+        }
+        return 0;
+    }
+
 private:
     fs::path expandTilde(fs::path path)
     {
@@ -220,7 +263,8 @@ private:
                       , start_time_file_name_map_.size());
             return -1; // Skip files that already exist in the map
         }
-        start_time_file_name_map_[std::make_tuple(chronicle_name, story_name, start_time)] = file_name;
+        start_time_file_name_map_[std::make_tuple(chronicle_name, story_name, start_time, getShardIndex(file_name))] =
+                file_name;
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Added file {} to start_time_file_name_map_.", file_name);
         LOG_DEBUG("[HDF5ArchiveReadingAgent] start_time_file_name_map_ has {} entries."
                   , start_time_file_name_map_.size());
@@ -247,7 +291,7 @@ private:
                       , start_time_file_name_map_.size());
             return -1; // Skip files that already exist in the map
         }
-        start_time_file_name_map_.erase(std::make_tuple(chronicle_name, story_name, start_time));
+        start_time_file_name_map_.erase(std::make_tuple(chronicle_name, story_name, start_time, getShardIndex(file_name)));
         LOG_DEBUG("[HDF5ArchiveReadingAgent] Removed file {} from start_time_file_name_map_.", file_name);
         LOG_DEBUG("[HDF5ArchiveReadingAgent] start_time_file_name_map_ has {} entries.",
                   start_time_file_name_map_.size());
@@ -266,7 +310,8 @@ private:
     }
 
     std::string archive_path_;
-    std::map<std::tuple<std::string, std::string, uint64_t>, std::string> start_time_file_name_map_;
+    // the partial chunk files of a sharded story share the start time and are told apart by the shard index
+    std::map<std::tuple<std::string, std::string, uint64_t, uint32_t>, std::string> start_time_file_name_map_;
     std::mutex start_time_file_name_map_mutex_;
     tl::managed <tl::xstream> archive_dir_monitoring_stream_;
     tl::managed <tl::thread> archive_dir_monitoring_thread_;
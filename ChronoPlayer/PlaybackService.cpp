@@ -1,11 +1,19 @@
 
 #include <map>
 #include <thallium.hpp>
+#include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
+#include <thallium/serialization/stl/map.hpp>
 
 #include "chrono_monitor.h"
 
 #include "PlaybackService.h"
 #include "StoryChunkTransferAgent.h"
+#include "StoryAggregationTask.h"
+#include "PlaybackEventSelector.h"
+#include "AggregationResponseMsg.h"
+#include "StoryStatisticsResponseMsg.h"
+#include "MetricsRegistry.h"
 
 namespace tl = thallium;
 namespace chl = chronolog;
@@ -16,9 +24,14 @@ chronolog::PlaybackService::PlaybackService(tl::engine &tl_engine, uint16_t serv
             : tl::provider <PlaybackService>(tl_engine, service_provider_id)
             , playbackEngine(tl_engine)
             , theArchiveReadingRequestQueue(archive_reading_queue)
+            , playbackRequestLatency(chl::MetricsRegistry::getInstance().getHistogram("player_playback_request_nsecs"))
+            , aggregationRequestLatency(chl::MetricsRegistry::getInstance().getHistogram("player_aggregation_request_nsecs"))
+            , statisticsRequestLatency(chl::MetricsRegistry::getInstance().getHistogram("player_statistics_request_nsecs"))
 {
         define("playback_service_available", &PlaybackService::playback_service_available);
         define("story_playback_request", &PlaybackService::story_playback_request);
+        define("story_aggregation_request", &PlaybackService::story_aggregation_request);
+        define("story_statistics_request", &PlaybackService::story_statistics_request);
 
         //set up callback for the case when the engine is being finalized while this provider is still alive
         playbackEngine.push_finalize_callback(this, [p = this]()
@@ -46,9 +59,14 @@ void chronolog::PlaybackService::playback_service_available(tl::request const &r
 }
 
 void chronolog::PlaybackService::story_playback_request(tl::request const &request,chl::ServiceId const & receiver_service_id, uint32_t query_id
-    ,chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, chl::chrono_time const& start_time, chl::chrono_time const& end_time)
+    ,chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, chl::chrono_time const& start_time, chl::chrono_time const& end_time
+    ,chl::PlaybackFilter const& playback_filter)
 {
-        LOG_INFO("[PlaybackService] story_playback_request for receiver_service {} Story {}-{}", chl::to_string(receiver_service_id), chronicle_name, story_name);
+        // the events are streamed back asynchronously, this is the time to accept and schedule the playback;
+        // the archive reading time is reported in the ReadingClassStats
+        chl::ScopedLatency request_latency(playbackRequestLatency);
+        LOG_INFO("[PlaybackService] story_playback_request for receiver_service {} Story {}-{} filtered={}", chl::to_string(receiver_service_id), chronicle_name, story_name
+                , !playback_filter.is_pass_through());
 
    //ChronoPlayer is running and able to respond 
    // generate unique RequestId (service_provider_id + atomic query index)
@@ -78,12 +96,79 @@ void chronolog::PlaybackService::story_playback_request(tl::request const &reque
     // put new archiveRequest tied to the Sender's extractionQueue on 
     // onto the ArchiveReadingRequestQueue
 
+    // requests are scheduled fairly across the requesting clients
     theArchiveReadingRequestQueue.pushReadingRequest(
-            chl::ArchiveReadingRequest( &(storyChunkSender->getExtractionQueue()),chronicle_name, story_name, start_time, end_time)
+            chl::ArchiveReadingRequest( &(storyChunkSender->getExtractionQueue()),chronicle_name, story_name, start_time, end_time, playback_filter
+                                    , nullptr, nullptr, static_cast<std::string>(request.get_endpoint()))
         );
     
     // return requestId 
     request.respond(requestId);
 }
 
+void chronolog::PlaybackService::story_aggregation_request(tl::request const &request
+    ,chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, chl::chrono_time const& start_time, chl::chrono_time const& end_time
+    ,chl::AggregationQuery const& aggregation_query, chl::PlaybackFilter const& playback_filter)
+{
+    chl::ScopedLatency request_latency(aggregationRequestLatency);
+    LOG_INFO("[PlaybackService] story_aggregation_request for Story {}-{} range {}-{} bucketWidth {}", chronicle_name, story_name
+            , start_time, end_time, aggregation_query.bucketWidth);
+
+    int return_code = chl::StoryAggregator::validateQuery(aggregation_query, start_time, end_time);
+    // reservoir sample of the events has no meaning for the bucketed statistics
+    if(return_code == chl::CL_SUCCESS
+        && (playback_filter.reservoirSize != 0 || !chl::PlaybackEventSelector::is_valid_filter(playback_filter)))
+    {   return_code = chl::CL_ERR_INVALID_ARG; }
 
+    if(return_code != chl::CL_SUCCESS)
+    {
+        LOG_WARNING("[PlaybackService] story_aggregation_request for Story {}-{} rejected: invalid query", chronicle_name, story_name);
+        request.respond(chl::AggregationResponseMsg(return_code));
+        return;
+    }
+
+    // the aggregation is computed by the ArchiveReadingAgent threads,
+    // this request thread waits for its completion and responds with the compact result
+    chl::StoryAggregationTask aggregationTask(aggregation_query, start_time, end_time);
+    if(theArchiveReadingRequestQueue.pushReadingRequest(
+            chl::ArchiveReadingRequest( nullptr, chronicle_name, story_name, start_time, end_time, playback_filter, &aggregationTask
+                                    , nullptr, static_cast<std::string>(request.get_endpoint())) ))
+    {   return_code = aggregationTask.wait(); }
+    else
+    {   return_code = chl::CL_ERR_UNKNOWN; }
+
+    std::vector<chl::AggregationBucket> buckets;
+    if(return_code == chl::CL_SUCCESS)
+    {   aggregationTask.getAggregator().getResults(buckets); }
+
+    request.respond(chl::AggregationResponseMsg(return_code, buckets));
+}
+
+void chronolog::PlaybackService::story_statistics_request(tl::request const &request
+    ,chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, chl::chrono_time const& start_time, chl::chrono_time const& end_time)
+{
+    chl::ScopedLatency request_latency(statisticsRequestLatency);
+    LOG_INFO("[PlaybackService] story_statistics_request for Story {}-{} range {}-{}", chronicle_name, story_name
+            , start_time, end_time);
+
+    if(start_time >= end_time)
+    {
+        LOG_WARNING("[PlaybackService] story_statistics_request for Story {}-{} rejected: invalid range", chronicle_name, story_name);
+        request.respond(chl::StoryStatisticsResponseMsg(chl::CL_ERR_INVALID_ARG));
+        return;
+    }
+
+    // the statistics are merged from the archived chunk summaries by the ArchiveReadingAgent threads
+    chl::StorySummaryTask summaryTask;
+    int return_code = chl::CL_ERR_UNKNOWN;
+    if(theArchiveReadingRequestQueue.pushReadingRequest(
+            chl::ArchiveReadingRequest( nullptr, chronicle_name, story_name, start_time, end_time, chl::PlaybackFilter(), nullptr, &summaryTask
+                                    , static_cast<std::string>(request.get_endpoint())) ))
+    {   return_code = summaryTask.wait(); }
+
+    chl::StoryStatistics statistics;
+    if(return_code == chl::CL_SUCCESS)
+    {   summaryTask.getSummary().getStatistics(statistics); }
+
+    request.respond(chl::StoryStatisticsResponseMsg(return_code, statistics));
+}
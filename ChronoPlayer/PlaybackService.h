@@ -9,6 +9,7 @@
 
 #include "ServiceId.h"
 #include "ArchiveReadingRequestQueue.h"
+#include "MetricsRegistry.h"
 
 namespace tl = thallium;
 
@@ -33,7 +34,17 @@ public:
 
     void
     story_playback_request(tl::request const &request, ServiceId const & requesting_service_id, uint32_t query_id
-            , ChronicleName const &chronicle_name, StoryName const &story_name, chrono_time const& start_time, chrono_time const& end_time);
+            , ChronicleName const &chronicle_name, StoryName const &story_name, chrono_time const& start_time, chrono_time const& end_time
+            , PlaybackFilter const& playback_filter);
+
+    void
+    story_aggregation_request(tl::request const &request, ChronicleName const &chronicle_name, StoryName const &story_name
+            , chrono_time const& start_time, chrono_time const& end_time
+            , AggregationQuery const& aggregation_query, PlaybackFilter const& playback_filter);
+
+    void
+    story_statistics_request(tl::request const &request, ChronicleName const &chronicle_name, StoryName const &story_name
+            , chrono_time const& start_time, chrono_time const& end_time);
 
 private:
     PlaybackService(tl::engine &tl_engine, uint16_t service_provider_id
@@ -47,6 +58,9 @@ private:
     ArchiveReadingRequestQueue & theArchiveReadingRequestQueue;
     std::mutex playbackServiceMutex;
     std::map<service_endpoint, StoryChunkTransferAgent*> chunkSenders;
+    LatencyHistogram * playbackRequestLatency;
+    LatencyHistogram * aggregationRequestLatency;
+    LatencyHistogram * statisticsRequestLatency;
 };
 
 }// namespace chronolog
@@ -46,6 +46,7 @@ int main()
 
     chl::ServiceId queryServiceId("ofi+sockets", "127.0.0.1",5557,57);
 
+    tl::abt scope;
     chl::ArchiveReadingRequestQueue readingRequestQueue;
 
     try
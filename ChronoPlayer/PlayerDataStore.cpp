@@ -14,6 +14,101 @@ namespace chl = chronolog;
 namespace tl = thallium;
 
 
+////////////////////////
+
+int chronolog::PlayerDataStore::startStoryRecording(std::string const &chronicle, std::string const &story
+                                                   , chronolog::StoryId const &story_id, uint64_t start_time)
+{
+    LOG_INFO("[PlayerDataStore] Start recording story: Chronicle={}, Story={}, StoryId={}", chronicle, story, story_id);
+
+    // Get dataStoreMutex, check for story_id_presence & add new StoryPipeline if needed
+    std::lock_guard storeLock(dataStoreMutex);
+    auto pipeline_iter = theMapOfStoryPipelines.find(story_id);
+    if(pipeline_iter != theMapOfStoryPipelines.end())
+    {
+        LOG_INFO("[PlayerDataStore] Story already being recorded. StoryId: {}", story_id);
+        //check it the pipeline was put on the waitingForExit list by the previous acquisition
+        // and remove it from there
+        auto waiting_iter = pipelinesWaitingForExit.find(story_id);
+        if(waiting_iter != pipelinesWaitingForExit.end())
+        {
+            pipelinesWaitingForExit.erase(waiting_iter);
+        }
+
+        return chronolog::CL_SUCCESS;
+    }
+
+    auto result = theMapOfStoryPipelines.emplace(
+            std::pair <chl::StoryId, chl::StoryPipeline*>(story_id, new chl::StoryPipeline(theExtractionQueue, chronicle, story, story_id, start_time
+                                                        , story_chunk_duration_secs, acceptance_window_secs)));
+
+    if(result.second)
+    {
+        LOG_INFO("[PlayerDataStore] New StoryPipeline created successfully. StoryId {}", story_id);
+        pipeline_iter = result.first;
+        theStoryIdIndex[std::pair <chl::ChronicleName, chl::StoryName>(chronicle, story)] = story_id;
+        //engage StoryPipeline with the IngestionQueue
+        chl::StoryChunkIngestionHandle*ingestionHandle = (*pipeline_iter).second->getActiveIngestionHandle();
+        theIngestionQueue.addStoryIngestionHandle(story_id, ingestionHandle);
+        return chronolog::CL_SUCCESS;
+    }
+    else
+    {
+        LOG_ERROR("[PlayerDataStore] Failed to create StoryPipeline for StoryId: {}. Possible memory or resource issue."
+                  , story_id);
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+}
+////////////////////////
+
+int chronolog::PlayerDataStore::stopStoryRecording(chronolog::StoryId const &story_id)
+{
+    LOG_DEBUG("[PlayerDataStore] Initiating stop recording for StoryId={}", story_id);
+    // the StoryPipeline is kept around for inactive_pipeline_delay so that the late chunks
+    // forwarded by the Grapher are still merged in and the recent events remain available for playback
+    std::lock_guard storeLock(dataStoreMutex);
+    auto pipeline_iter = theMapOfStoryPipelines.find(story_id);
+    if(pipeline_iter != theMapOfStoryPipelines.end())
+    {
+        uint64_t exit_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() + inactive_pipeline_delay_secs*1000000000;
+        pipelinesWaitingForExit[(*pipeline_iter).first] = (std::pair <chl::StoryPipeline*, uint64_t>(
+                (*pipeline_iter).second, exit_time));
+        LOG_INFO("[PlayerDataStore] Scheduled pipeline to retire: StoryId {} timeline {}-{} acceptanceWindow {} retirementTime {}",
+                (*pipeline_iter).second->getStoryId(), (*pipeline_iter).second->TimelineStart(), (*pipeline_iter).second->TimelineEnd(),
+                (*pipeline_iter).second->getAcceptanceWindow(), exit_time);
+    }
+    else
+    {
+        LOG_WARNING("[PlayerDataStore] Attempt to stop recording for non-existent StoryId={}", story_id);
+    }
+    return chronolog::CL_SUCCESS;
+}
+
+////////////////////////
+
+int chronolog::PlayerDataStore::readRecentStoryEvents(chl::ChronicleName const &chronicle, chl::StoryName const &story
+                                                      , uint64_t start_time, uint64_t end_time, chl::StoryChunk &story_chunk)
+{
+    std::lock_guard storeLock(dataStoreMutex);
+    auto index_iter = theStoryIdIndex.find(std::pair <chl::ChronicleName, chl::StoryName>(chronicle, story));
+    if(index_iter == theStoryIdIndex.end())
+    {   return chronolog::CL_ERR_NOT_EXIST; }
+
+    auto pipeline_iter = theMapOfStoryPipelines.find((*index_iter).second);
+    if(pipeline_iter == theMapOfStoryPipelines.end())
+    {   return chronolog::CL_ERR_NOT_EXIST; }
+
+    chl::StoryPipeline * pipeline = (*pipeline_iter).second;
+    // merge in whatever has been ingested since the last collection pass
+    // so that the playback includes the most recent events
+    pipeline->collectIngestedEvents();
+    uint32_t event_count = pipeline->copyEvents(story_chunk, start_time, end_time);
+
+    LOG_DEBUG("[PlayerDataStore] Read {} recent events for Chronicle={}, Story={}, TimeRange=[{}, {})"
+              , event_count, chronicle, story, start_time, end_time);
+    return chronolog::CL_SUCCESS;
+}
+
 ////////////////////////
 
 void chronolog::PlayerDataStore::collectIngestedEvents()
@@ -46,6 +141,13 @@ void chronolog::PlayerDataStore::extractDecayedStoryChunks()
     {
         (*pipeline_iter).second->extractDecayedStoryChunks(current_time);
     }
+
+    // the decayed StoryChunks are persisted by the Grapher of the RecordingGroup,
+    // once they leave the StoryPipeline the Player reads them from the archive
+    while(!theExtractionQueue.empty())
+    {
+        delete theExtractionQueue.ejectStoryChunk();
+    }
 }
 ////////////////////////
 
@@ -68,6 +170,8 @@ void chronolog::PlayerDataStore::retireDecayedPipelines()
                 LOG_DEBUG("[PlayerDataStore] retiring pipeline StoryId {} timeline {}-{} acceptanceWindow {} retirementTime {}",
                         pipeline->getStoryId(), pipeline->TimelineStart(), pipeline->TimelineEnd(), pipeline->getAcceptanceWindow(), (*pipeline_iter).second.second);
                 theMapOfStoryPipelines.erase(pipeline->getStoryId());
+                theStoryIdIndex.erase(std::pair <chl::ChronicleName, chl::StoryName>(pipeline->getChronicleName()
+                                                                                     , pipeline->getStoryName()));
                 theIngestionQueue.removeStoryIngestionHandle(pipeline->getStoryId());
                 pipeline_iter = pipelinesWaitingForExit.erase(pipeline_iter);
                 delete pipeline;
@@ -107,7 +211,7 @@ void chronolog::PlayerDataStore::dataCollectionTask()
 }
 
 ////////////////////////
-void chronolog::PlayerDataStore::startDataCollection(int stream_count)
+void chronolog::PlayerDataStore::startDataCollection(int stream_count, XstreamPlacement*xstream_placement)
 {
     std::lock_guard storeLock(dataStoreStateMutex);
     if(is_running() || is_shutting_down())
@@ -122,7 +226,8 @@ void chronolog::PlayerDataStore::startDataCollection(int stream_count)
 
     for(int i = 0; i < stream_count; ++i)
     {
-        tl::managed <tl::xstream> es = tl::xstream::create();
+        tl::managed <tl::xstream> es = (xstream_placement != nullptr
+                                        ? xstream_placement->createXstream(XSTREAM_SEQUENCING) : tl::xstream::create());
         dataStoreStreams.push_back(std::move(es));
     }
 
@@ -153,19 +258,16 @@ void chronolog::PlayerDataStore::shutdownDataCollection()
 
     if(!theMapOfStoryPipelines.empty())
     {
-        // label all existing Pipelines as waiting to exit
+        // label all existing Pipelines as ready to exit,
+        // the Player doesn't persist the events it holds in memory so there's no need to wait for them to decay
         std::lock_guard storeLock(dataStoreMutex);
         uint64_t current_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
 
         for(auto pipeline_iter = theMapOfStoryPipelines.begin();
             pipeline_iter != theMapOfStoryPipelines.end(); ++pipeline_iter)
         {
-            if(pipelinesWaitingForExit.find((*pipeline_iter).first) == pipelinesWaitingForExit.end())
-            {
-                uint64_t exit_time = current_time + (*pipeline_iter).second->getAcceptanceWindow();
-                pipelinesWaitingForExit[(*pipeline_iter).first] = (std::pair <chl::StoryPipeline*, uint64_t>(
-                        (*pipeline_iter).second, exit_time));
-            }
+            pipelinesWaitingForExit[(*pipeline_iter).first] = (std::pair <chl::StoryPipeline*, uint64_t>(
+                    (*pipeline_iter).second, current_time));
         }
     }
 
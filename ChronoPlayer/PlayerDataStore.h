@@ -11,6 +11,7 @@
 #include "StoryChunkIngestionQueue.h"
 #include "StoryPipeline.h"
 #include "StoryChunkExtractionQueue.h"
+#include "XstreamPlacement.h"
 
 
 namespace chronolog
@@ -29,10 +30,15 @@ class PlayerDataStore
 
 
 public:
-    PlayerDataStore(StoryChunkIngestionQueue &ingestion_queue, StoryChunkExtractionQueue &extraction_queue)
+    PlayerDataStore(StoryChunkIngestionQueue &ingestion_queue, StoryChunkExtractionQueue &extraction_queue
+                    , uint32_t story_chunk_duration_secs = 60, uint32_t acceptance_window_secs = 180
+                    , uint32_t inactive_pipeline_delay_secs = 300)
         : state(UNKNOWN)
         , theIngestionQueue(ingestion_queue)
         , theExtractionQueue(extraction_queue)
+        , story_chunk_duration_secs(story_chunk_duration_secs)
+        , acceptance_window_secs(acceptance_window_secs)
+        , inactive_pipeline_delay_secs(inactive_pipeline_delay_secs)
     {}
 
     ~PlayerDataStore();
@@ -42,19 +48,22 @@ public:
 
     bool is_shutting_down() const
     { return (SHUTTING_DOWN == state); }
-/*
-    int startStoryRecording(ChronicleName const &, StoryName const &, StoryId const &, uint64_t start_time
-                            , uint32_t time_chunk_ranularity = 30, uint32_t access_window = 300);
+    int startStoryRecording(ChronicleName const &, StoryName const &, StoryId const &, uint64_t start_time);
 
     int stopStoryRecording(StoryId const &);
-*/
+
+    // copy the recent events of the story that are still held in memory into the StoryChunk
+    int readRecentStoryEvents(ChronicleName const &, StoryName const &, uint64_t start_time, uint64_t end_time
+                              , StoryChunk &);
+
     void collectIngestedEvents();
 
     void extractDecayedStoryChunks();
 
     void retireDecayedPipelines();
 
-    void startDataCollection(int stream_count);
+    // the data collection xstreams are pinned to the sequencing cores of the placement if it is given
+    void startDataCollection(int stream_count, XstreamPlacement*xstream_placement = nullptr);
 
     void shutdownDataCollection();
 
@@ -69,11 +78,18 @@ private:
     std::mutex dataStoreStateMutex;
     StoryChunkIngestionQueue &theIngestionQueue;
     StoryChunkExtractionQueue &theExtractionQueue;
+
+    uint32_t story_chunk_duration_secs;
+    uint32_t acceptance_window_secs;
+    uint32_t inactive_pipeline_delay_secs;
+
     std::vector <thallium::managed <thallium::xstream>> dataStoreStreams;
     std::vector <thallium::managed <thallium::thread>> dataStoreThreads;
 
     std::mutex dataStoreMutex;
     std::unordered_map <StoryId, StoryPipeline*> theMapOfStoryPipelines;
+    // playback requests name the story, the index finds its pipeline without scanning the active pipelines
+    std::map <std::pair <ChronicleName, StoryName>, StoryId> theStoryIdIndex;
     std::unordered_map <StoryId, std::pair <StoryPipeline*, uint64_t>> pipelinesWaitingForExit;
 
 };
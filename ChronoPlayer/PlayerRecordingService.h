@@ -0,0 +1,133 @@
+#ifndef PLAYER_RECORDING_SERVICE_H
+#define PLAYER_RECORDING_SERVICE_H
+
+#include <iostream>
+#include <margo.h>
+#include <thallium.hpp>
+#include <thallium/serialization/stl/string.hpp>
+#include <cereal/archives/binary.hpp>
+
+#include "chronolog_errcode.h"
+#include "chronolog_types.h"
+#include "StoryChunkIngestionQueue.h"
+
+namespace tl = thallium;
+
+namespace chronolog
+{
+
+// PlayerRecordingService receives the StoryChunks forwarded by the Grapher of the RecordingGroup
+// and places them on the IngestionQueue of the PlayerDataStore,
+// so that the recent events could be played back before they reach the archive
+
+class PlayerRecordingService: public tl::provider <PlayerRecordingService>
+{
+public:
+    // RecordingService should be created on the heap not the stack thus the constructor is private...
+    static PlayerRecordingService*
+    CreateRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, StoryChunkIngestionQueue &ingestion_queue
+                           , tl::pool const &handler_pool = tl::pool())
+    {
+        return new PlayerRecordingService(tl_engine, service_provider_id, ingestion_queue, handler_pool);
+    }
+
+    ~PlayerRecordingService()
+    {
+        LOG_DEBUG("[PlayerRecordingService] Destructor called. Cleaning up...");
+        get_engine().pop_finalize_callback(this);
+    }
+
+    void record_story_chunk(tl::request const &request, tl::bulk &b)
+    {
+        try
+        {
+            std::vector <char> mem_vec(b.size());
+            tl::endpoint ep = request.get_endpoint();
+            std::vector <std::pair <void*, std::size_t>> segments(1);
+            segments[0].first = (void*)(&mem_vec[0]);
+            segments[0].second = mem_vec.size();
+            tl::engine tl_engine = get_engine();
+            tl::bulk local = tl_engine.expose(segments, tl::bulk_mode::write_only);
+            b.on(ep) >> local;
+            LOG_DEBUG("[PlayerRecordingService] Received {} bytes of StoryChunk data, ThreadID={}", b.size()
+                      , tl::thread::self_id());
+
+            StoryChunk*story_chunk = new StoryChunk();
+            int ret = deserializedWithCereal(&mem_vec[0], b.size(), *story_chunk);
+            if(ret != chronolog::CL_SUCCESS)
+            {
+                delete story_chunk;
+                ret = 10000000 + tl::thread::self_id(); // arbitrary error code encoded with thread id
+                LOG_ERROR("[PlayerRecordingService] Discarding the story chunk, responding {} to Grapher", ret);
+                request.respond(ret);
+                return;
+            }
+
+            LOG_DEBUG("[PlayerRecordingService] StoryChunk received: StoryId {} StartTime {} eventCount {} ThreadID={}"
+                      , story_chunk->getStoryId(), story_chunk->getStartTime(), story_chunk->getEventCount()
+                      , tl::thread::self_id());
+
+            request.respond(b.size());
+
+            theIngestionQueue.ingestStoryChunk(story_chunk);
+        }
+        catch(std::bad_alloc const &ex)
+        {
+            LOG_ERROR("[PlayerRecordingService] Failed to allocate memory for StoryChunk data, ThreadID={}"
+                      , tl::thread::self_id());
+            request.respond(20000000 + tl::thread::self_id());
+            return;
+        }
+    }
+
+private:
+    PlayerRecordingService(tl::engine &tl_engine, uint16_t service_provider_id, StoryChunkIngestionQueue &ingestion_queue
+                           , tl::pool const &handler_pool)
+            : tl::provider <PlayerRecordingService>(tl_engine, service_provider_id), theIngestionQueue(ingestion_queue)
+    {
+        // the null handler_pool leaves the handlers on the margo rpc xstream
+        define("record_story_chunk", &PlayerRecordingService::record_story_chunk, handler_pool
+               , tl::ignore_return_value());
+        //set up callback for the case when the engine is being finalized while this provider is still alive
+        get_engine().push_finalize_callback(this, [p = this]()
+        { delete p; });
+    }
+
+    int deserializedWithCereal(char *buffer, size_t size, StoryChunk &story_chunk)
+    {
+        std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+        try
+        {
+            ss.write(buffer, size);
+            cereal::BinaryInputArchive iarchive(ss);
+            iarchive(story_chunk);
+            return chronolog::CL_SUCCESS;
+        }
+        catch(cereal::Exception const &ex)
+        {
+            LOG_ERROR("[PlayerRecordingService] Failed to deserialize a story chunk, size={}, ThreadID={}. "
+                      "Cereal exception: {}", ss.str().size(), tl::thread::self_id(), ex.what());
+        }
+        catch(std::exception const &ex)
+        {
+            LOG_ERROR("[PlayerRecordingService] Failed to deserialize a story chunk, size={}, ThreadID={}. "
+                      "std::exception: {}", ss.str().size(), tl::thread::self_id(), ex.what());
+        }
+        catch(...)
+        {
+            LOG_ERROR("[PlayerRecordingService] Failed to deserialize a story chunk, ThreadID={}. Unknown exception "
+                      "encountered.", tl::thread::self_id());
+        }
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+
+    PlayerRecordingService(PlayerRecordingService const &) = delete;
+
+    PlayerRecordingService &operator=(PlayerRecordingService const &) = delete;
+
+    StoryChunkIngestionQueue &theIngestionQueue;
+};
+
+}// namespace chronolog
+
+#endif
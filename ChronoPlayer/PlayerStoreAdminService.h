@@ -5,8 +5,10 @@
 #include <margo.h>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "chronolog_types.h"
+#include "StoryRecordingStartMsg.h"
 #include "PlayerDataStore.h"
 
 namespace tl = thallium;
@@ -42,7 +44,6 @@ public:
         theDataStore.shutdownDataCollection();
         request.respond(status);
     }
-/*
     void
     StartStoryRecording(tl::request const &request, std::string const &chronicle_name, std::string const &story_name
                         , StoryId const &story_id, uint64_t start_time)
@@ -58,15 +59,41 @@ public:
         int return_code = theDataStore.stopStoryRecording(story_id);
         request.respond(return_code);
     }
-*/
+
+    // batched notifications of the stories acquired or released together, one return code per story
+    void StartStoryRecordingBatch(tl::request const &request, std::vector <StoryRecordingStartMsg> const &stories)
+    {
+        LOG_INFO("[PlayerStoreAdminService] Starting Story Recording batch: StoryCount={}", stories.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(stories.size());
+        for(auto const &story: stories)
+        {
+            return_codes.push_back(theDataStore.startStoryRecording(story.chronicleName, story.storyName, story.storyId
+                                                                    , story.startTime));
+        }
+        request.respond(return_codes);
+    }
+
+    void StopStoryRecordingBatch(tl::request const &request, std::vector <StoryId> const &story_ids)
+    {
+        LOG_INFO("[PlayerStoreAdminService] Stopping Story Recording batch: StoryCount={}", story_ids.size());
+        std::vector <int> return_codes;
+        return_codes.reserve(story_ids.size());
+        for(auto const &story_id: story_ids)
+        { return_codes.push_back(theDataStore.stopStoryRecording(story_id)); }
+        request.respond(return_codes);
+    }
+
 private:
     PlayerStoreAdminService(tl::engine &tl_engine, uint16_t service_provider_id, PlayerDataStore &data_store_instance)
             : tl::provider <PlayerStoreAdminService>(tl_engine, service_provider_id), theDataStore(data_store_instance)
     {
         define("collection_service_available", &PlayerStoreAdminService::collection_service_available);
         define("shutdown_data_collection", &PlayerStoreAdminService::shutdown_data_collection);
-        //define("start_story_recording", &DataStoreAdminService::StartStoryRecording);
-        //define("stop_story_recording", &DataStoreAdminService::StopStoryRecording);
+        define("start_story_recording", &PlayerStoreAdminService::StartStoryRecording);
+        define("stop_story_recording", &PlayerStoreAdminService::StopStoryRecording);
+        define("start_story_recording_batch", &PlayerStoreAdminService::StartStoryRecordingBatch);
+        define("stop_story_recording_batch", &PlayerStoreAdminService::StopStoryRecordingBatch);
         //set up callback for the case when the engine is being finalized while this provider is still alive
         get_engine().push_finalize_callback(this, [p = this]()
         { delete p; });
@@ -0,0 +1,83 @@
+#ifndef STORY_AGGREGATION_TASK_H
+#define STORY_AGGREGATION_TASK_H
+
+#include <thallium.hpp>
+
+#include "chronolog_types.h"
+#include "StoryAggregator.h"
+#include "StoryChunkSummary.h"
+
+namespace tl = thallium;
+
+namespace chronolog
+{
+
+// StoryAggregationTask ties the StoryAggregator of the aggregation query
+// to the PlaybackService request waiting for its completion.
+// The task is owned by the waiting request, the ArchiveReadingAgent fills in the aggregator
+// and calls complete() exactly once.
+
+class StoryAggregationTask
+{
+public:
+    StoryAggregationTask(AggregationQuery const &query, chrono_time start_time, chrono_time end_time)
+        : theAggregator(query, start_time, end_time)
+    {}
+
+    ~StoryAggregationTask() = default;
+
+    StoryAggregator &getAggregator()
+    { return theAggregator; }
+
+    void complete(int status)
+    { completion.set_value(status); }
+
+    int wait()
+    {
+        int status = completion.wait();
+        return status;
+    }
+
+private:
+    StoryAggregationTask(StoryAggregationTask const &) = delete;
+
+    StoryAggregationTask &operator=(StoryAggregationTask const &) = delete;
+
+    StoryAggregator theAggregator;
+    tl::eventual <int> completion;
+};
+
+// StorySummaryTask is the StoryAggregationTask counterpart for the range statistics queries,
+// the ArchiveReadingAgent merges the archived chunk summaries and the recent in-memory events into the summary.
+
+class StorySummaryTask
+{
+public:
+    StorySummaryTask() = default;
+
+    ~StorySummaryTask() = default;
+
+    StoryChunkSummary &getSummary()
+    { return theSummary; }
+
+    void complete(int status)
+    { completion.set_value(status); }
+
+    int wait()
+    {
+        int status = completion.wait();
+        return status;
+    }
+
+private:
+    StorySummaryTask(StorySummaryTask const &) = delete;
+
+    StorySummaryTask &operator=(StorySummaryTask const &) = delete;
+
+    StoryChunkSummary theSummary;
+    tl::eventual <int> completion;
+};
+
+}
+
+#endif
@@ -14,11 +14,10 @@
 #include <chrono_monitor.h>
 #include <chronolog_errcode.h>
 #include <mutex>
+#include <shared_mutex>
 
 #define MAX_CHRONICLE_PROPERTY_LIST_SIZE 16
 #define MAX_CHRONICLE_METADATA_MAP_SIZE 16
-#define MAX_STORY_MAP_SIZE 1024
-#define MAX_ARCHIVE_MAP_SIZE 1024
 
 enum ChronicleIndexingGranularity
 {
@@ -52,12 +51,9 @@ typedef struct ChronicleStats_
 class Chronicle
 {
 public:
+    // the maps start empty and grow with the entries added, most chronicles hold only a few stories
     Chronicle()
     {
-        propertyList_ = std::unordered_map <std::string, std::string>(MAX_CHRONICLE_PROPERTY_LIST_SIZE);
-        metadataMap_ = std::unordered_map <std::string, std::string>(MAX_CHRONICLE_METADATA_MAP_SIZE);
-        storyMap_ = std::unordered_map <uint64_t, Story*>(MAX_STORY_MAP_SIZE);
-        archiveMap_ = std::unordered_map <uint64_t, Archive*>(MAX_ARCHIVE_MAP_SIZE);
         attrs_.size = 0;
         attrs_.indexing_granularity = chronicle_gran_ms;
         attrs_.type = chronicle_type_standard;
@@ -306,6 +302,11 @@ public:
     size_t getArchiveMapSize()
     { return archiveMap_.size(); }
 
+    // guards the chronicle's maps and the acquirer maps of its stories:
+    // shared for the lookups, exclusive for the modifications
+    std::shared_mutex &getMutex()
+    { return chronicleMutex_; }
+
 private:
     std::string name_;
     uint64_t cid_{};
@@ -315,6 +316,7 @@ private:
     std::unordered_map <std::string, std::string> metadataMap_;
     std::unordered_map <uint64_t, Story*> storyMap_;
     std::unordered_map <uint64_t, Archive*> archiveMap_;
+    std::shared_mutex chronicleMutex_;
 //    std::unordered_map<std::string, uint64_t> *storyName2IdMap_;
 //    std::unordered_map<uint64_t, std::string> *storyId2NameMap_;
 };
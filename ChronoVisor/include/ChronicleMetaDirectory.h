@@ -1,16 +1,29 @@
 #ifndef CHRONOLOG_CHRONICLEMETADIRECTORY_H
 #define CHRONOLOG_CHRONICLEMETADIRECTORY_H
 
+#include <mutex>
 #include <string>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 #include <Chronicle.h>
 #include "chronolog_types.h"
+#include "VisorMetadataStore.h"
+
+// number of independently locked partitions of the chronicle map, chronicles are assigned by their cid
+#define CHRONICLE_DIRECTORY_SHARD_COUNT 64
 
 class ClientRegistryManager;
 
 typedef uint64_t StoryId;
 
+// Locking: a shard's mutex is held exclusively only to add or remove a chronicle in that shard,
+// all the other operations hold it shared and then lock the chronicle itself,
+// shared for the lookups and exclusively for the story and attribute modifications,
+// so the requests for different chronicles no longer serialize on one directory mutex.
+// The metadata store records of the changes are queued per shard while the chronicle lock is held,
+// which keeps the order of the changes of each chronicle, and appended to the store after the locks are released
+
 class ChronicleMetaDirectory
 {
 public:
@@ -23,8 +36,15 @@ public:
         clientRegistryManager_ = pClientRegistryManager;
     }
 
-    std::unordered_map <uint64_t, Chronicle*>*getChronicleMap()
-    { return chronicleMap_; }
+    // the chronicle and story changes are logged to the metadata store once they are applied
+    void set_metadata_store(chronolog::VisorMetadataStore*pMetadataStore)
+    {
+        metadataStore_ = pMetadataStore;
+    }
+
+    // rebuilds the chronicles and stories recovered by the metadata store,
+    // called on the main thread before the client portal service is started
+    int restore_from_metadata_store(chronolog::VisorMetadataStore const &);
 
     int create_chronicle(const std::string &name, const std::map <std::string, std::string> &attrs);
 
@@ -40,8 +60,13 @@ public:
     release_story(chronolog::ClientId const &client_id, const std::string &chronicle_name, const std::string &story_name
                   , StoryId &);
 
+    int get_acquired_story_id(chronolog::ClientId const &client_id, const std::string &chronicle_name
+                              , const std::string &story_name, StoryId &);
+
     int get_chronicle_attr(std::string const &name, const std::string &key, std::string &value);
 
+    int get_chronicle_attrs(std::string const &name, std::map <std::string, std::string> &attrs);
+
     int edit_chronicle_attr(std::string const &name, const std::string &key, const std::string &value);
 
     int show_chronicles(std::vector <std::string> &);
@@ -49,9 +74,30 @@ public:
     int show_stories(const std::string &chronicle_name, std::vector <std::string> &);
 
 private:
-    std::unordered_map <uint64_t, Chronicle*>*chronicleMap_;
-    std::mutex g_chronicleMetaDirectoryMutex_;
+    struct ChronicleMapShard
+    {
+        std::shared_mutex shardMutex;
+        std::unordered_map <uint64_t, Chronicle*> chronicleMap;
+        std::mutex queuedRecordsMutex;
+        std::vector <std::string> queuedRecords;  // metadata store records not appended yet, in the change order
+        std::mutex recordsLoggingMutex;           // held while the queued records are appended to the store
+    };
+
+    ChronicleMapShard &getShard(uint64_t cid)
+    { return chronicleMapShards_[cid % CHRONICLE_DIRECTORY_SHARD_COUNT]; }
+
+    // returns nullptr if the chronicle does not exist, the caller holds the shard's mutex
+    static Chronicle*findChronicle(ChronicleMapShard &shard, uint64_t cid);
+
+    // the caller holds the changed chronicle's lock or the shard's mutex exclusively
+    static void queueMetadataRecord(ChronicleMapShard &shard, std::string &&record);
+
+    // appends the shard's queued records to the metadata store, called after the chronicle and shard locks are released
+    void logQueuedMetadataRecords(ChronicleMapShard &shard);
+
+    ChronicleMapShard chronicleMapShards_[CHRONICLE_DIRECTORY_SHARD_COUNT];
     ClientRegistryManager*clientRegistryManager_ = nullptr;
+    chronolog::VisorMetadataStore*metadataStore_ = nullptr;
 };
 
 #endif //CHRONOLOG_CHRONICLEMETADIRECTORY_H
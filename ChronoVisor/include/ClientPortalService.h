@@ -12,6 +12,7 @@
 #include "VisorClientPortal.h"
 #include "ConnectResponseMsg.h"
 #include "AcquireStoryResponseMsg.h"
+#include "HybridLogicalClock.h"
 
 namespace tl = thallium;
 
@@ -41,9 +42,9 @@ public:
         int return_code = theVisorClientPortal.ClientConnect(client_account, client_host_ip, client_pid, client_id
                                                              , clock_offset);
         if(chronolog::CL_SUCCESS == return_code)
-        { request.respond(ConnectResponseMsg(chronolog::CL_SUCCESS, client_id)); }
+        { request.respond(ConnectResponseMsg(chronolog::CL_SUCCESS, client_id, visorClock.getTimestamp())); }
         else
-        { request.respond(ConnectResponseMsg(return_code, ClientId{0})); }
+        { request.respond(ConnectResponseMsg(return_code, ClientId{0}, visorClock.getTimestamp())); }
     }
 
     void Disconnect(tl::request const &request, ClientId const &client_token)
@@ -71,6 +72,7 @@ public:
     {
         AcquireStoryResponseMsg acquire_response = theVisorClientPortal.AcquireStory(client_id, chronicle_name
                                                                                      , story_name, attrs, flags);
+        acquire_response.setClockTime(visorClock.getTimestamp());
         request.respond(acquire_response);
     }
 
@@ -81,6 +83,33 @@ public:
         request.respond(return_code);
     }
 
+    void AcquireStories(tl::request const &request, ClientId const &client_id, std::string const &chronicle_name
+                        , std::vector <std::string> const &story_names
+                        , const std::map <std::string, std::string> &attrs, int &flags)
+    {
+        std::vector <AcquireStoryResponseMsg> acquire_responses =
+                theVisorClientPortal.AcquireStories(client_id, chronicle_name, story_names, attrs, flags);
+        uint64_t clock_time = visorClock.getTimestamp();
+        for(auto &acquire_response: acquire_responses)
+        { acquire_response.setClockTime(clock_time); }
+        request.respond(acquire_responses);
+    }
+
+    void ReleaseStories(tl::request const &request, ClientId const &client_id, std::string const &chronicle_name
+                        , std::vector <std::string> const &story_names)
+    {
+        request.respond(theVisorClientPortal.ReleaseStories(client_id, chronicle_name, story_names));
+    }
+
+    void RefreshStory(tl::request const &request, ClientId const &client_id, std::string const &chronicle_name
+                      , std::string const &story_name)
+    {
+        AcquireStoryResponseMsg refresh_response = theVisorClientPortal.RefreshStory(client_id, chronicle_name
+                                                                                     , story_name);
+        refresh_response.setClockTime(visorClock.getTimestamp());
+        request.respond(refresh_response);
+    }
+
     void DestroyStory(tl::request const &request, ClientId const &client_id, std::string const &chronicle_name
                       , std::string const &story_name)
     {
@@ -128,6 +157,9 @@ private:
         define("DestroyChronicle", &ClientPortalService::DestroyChronicle);
         define("AcquireStory", &ClientPortalService::AcquireStory);
         define("ReleaseStory", &ClientPortalService::ReleaseStory);
+        define("RefreshStory", &ClientPortalService::RefreshStory);
+        define("AcquireStories", &ClientPortalService::AcquireStories);
+        define("ReleaseStories", &ClientPortalService::ReleaseStories);
         define("DestroyStory", &ClientPortalService::DestroyStory);
         define("GetChronicleAttr", &ClientPortalService::GetChronicleAttr);
         define("EditChronicleAttr", &ClientPortalService::EditChronicleAttr);
@@ -146,6 +178,7 @@ private:
     ClientPortalService &operator=(ClientPortalService const &) = delete;
 
     VisorClientPortal &theVisorClientPortal;
+    HybridLogicalClock visorClock;  // piggybacked on the responses carrying the client's keepers
 };
 }// namespace chronolog
 
@@ -1,11 +1,14 @@
 #ifndef DataStoreAdmin_CLIENT_H
 #define DataStoreAdmin_CLIENT_H
 
+#include <chrono>
 #include <iostream>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 #include "chrono_monitor.h"
 #include "chronolog_types.h"
+#include "StoryRecordingStartMsg.h"
 
 namespace tl = thallium;
 
@@ -94,12 +97,207 @@ public:
         return status;
     }
 
+    // one rpc for all the stories of the batch, return_codes get one code per story in the batch order
+    int send_start_story_recording_batch(std::vector <StoryRecordingStartMsg> const &stories
+                                         , std::vector <int> &return_codes)
+    {
+        int status = chronolog::CL_ERR_UNKNOWN;
+        return_codes.clear();
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] START Story Recording batch of {} stories", stories.size());
+            std::vector <int> batch_codes = start_story_recording_batch.on(service_handle)(stories);
+            return_codes.swap(batch_codes);
+            if(return_codes.size() == stories.size())
+            { status = chronolog::CL_SUCCESS; }
+        }
+        catch(tl::exception const &ex)
+        {}
+        return status;
+    }
+
+    int send_stop_story_recording_batch(std::vector <StoryId> const &story_ids, std::vector <int> &return_codes)
+    {
+        int status = chronolog::CL_ERR_UNKNOWN;
+        return_codes.clear();
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] STOP Story Recording batch of {} stories", story_ids.size());
+            std::vector <int> batch_codes = stop_story_recording_batch.on(service_handle)(story_ids);
+            return_codes.swap(batch_codes);
+            if(return_codes.size() == story_ids.size())
+            { status = chronolog::CL_SUCCESS; }
+        }
+        catch(tl::exception const &ex)
+        {}
+        return status;
+    }
+
+    // Graphers only: start recording one shard of a sharded story, the shard index goes into the archived chunk names
+    int send_start_story_shard_recording(ChronicleName const &chronicle_name, StoryName const &story_name
+                                         , StoryId const &story_id, uint64_t start_time, uint32_t shard_index)
+    {
+        int status = chronolog::CL_ERR_UNKNOWN;
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] START Story Shard Recording for StoryID={} ShardIndex={}", story_id
+                      , shard_index);
+            status = start_story_shard_recording.on(service_handle)(chronicle_name, story_name, story_id, start_time
+                                                                     , shard_index);
+        }
+        catch(tl::exception const &ex)
+        {}
+        return status;
+    }
+
+    // Keepers only: stop recording the story that moved to another RecordingGroup
+    int send_migrate_story_recording(StoryId const &story_id)
+    {
+        int status = chronolog::CL_ERR_UNKNOWN;
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] MIGRATE Story Recording for StoryId={}", story_id);
+            status = migrate_story_recording.on(service_handle)(story_id);
+        }
+        catch(tl::exception const &ex)
+        {}
+        return status;
+    }
+
+    // asynchronous variants for the parallel notification fan-out of the KeeperRegistry:
+    // the rpc is issued with the timeout and the response is joined with wait_for_notification(),
+    // nullptr is returned if the rpc couldn't be issued
+    // shard_index > 0 only for the Grapher recording one shard of a sharded story,
+    // admission_limits are set only for the Keepers recording the story of the chronicle with the event rate limits
+    tl::async_response* async_start_story_recording(ChronicleName const &chronicle_name, StoryName const &story_name
+                                                    , StoryId const &story_id, uint64_t start_time
+                                                    , uint32_t shard_index
+                                                    , StoryAdmissionLimits const &admission_limits
+                                                    , std::chrono::milliseconds timeout)
+    {
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] START Story Recording for StoryID={} ShardIndex={}", story_id, shard_index);
+            if(!admission_limits.isUnlimited())
+            {
+                return new tl::async_response(start_limited_story_recording.on(service_handle).timed_async(
+                        timeout, chronicle_name, story_name, story_id, start_time, admission_limits));
+            }
+            if(shard_index == 0)
+            {
+                return new tl::async_response(start_story_recording.on(service_handle).timed_async(
+                        timeout, chronicle_name, story_name, story_id, start_time));
+            }
+            return new tl::async_response(start_story_shard_recording.on(service_handle).timed_async(
+                    timeout, chronicle_name, story_name, story_id, start_time, shard_index));
+        }
+        catch(tl::exception const &ex)
+        {}
+        return nullptr;
+    }
+
+    // story_migrated asks the Keeper to redirect the clients of the story that moved to another RecordingGroup
+    tl::async_response* async_stop_story_recording(StoryId const &story_id, bool story_migrated
+                                                   , std::chrono::milliseconds timeout)
+    {
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] {} Story Recording for StoryId={}", (story_migrated ? "MIGRATE" : "STOP")
+                      , story_id);
+            if(story_migrated)
+            { return new tl::async_response(migrate_story_recording.on(service_handle).timed_async(timeout, story_id)); }
+            return new tl::async_response(stop_story_recording.on(service_handle).timed_async(timeout, story_id));
+        }
+        catch(tl::exception const &ex)
+        {}
+        return nullptr;
+    }
+
+    tl::async_response* async_start_story_recording_batch(std::vector <StoryRecordingStartMsg> const &stories
+                                                          , std::chrono::milliseconds timeout)
+    {
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] START Story Recording batch of {} stories", stories.size());
+            return new tl::async_response(start_story_recording_batch.on(service_handle).timed_async(timeout, stories));
+        }
+        catch(tl::exception const &ex)
+        {}
+        return nullptr;
+    }
+
+    tl::async_response* async_stop_story_recording_batch(std::vector <StoryId> const &story_ids
+                                                         , std::chrono::milliseconds timeout)
+    {
+        try
+        {
+            LOG_DEBUG("[DataStoreAdminClient] STOP Story Recording batch of {} stories", story_ids.size());
+            return new tl::async_response(stop_story_recording_batch.on(service_handle).timed_async(timeout, story_ids));
+        }
+        catch(tl::exception const &ex)
+        {}
+        return nullptr;
+    }
+
+    // joins the asynchronous notification and deletes the pending response,
+    // returns CL_ERR_UNKNOWN if the rpc wasn't issued, failed or timed out
+    static int wait_for_notification(tl::async_response* pending_response)
+    {
+        if(pending_response == nullptr)
+        { return chronolog::CL_ERR_UNKNOWN; }
+
+        int status = chronolog::CL_ERR_UNKNOWN;
+        try
+        {
+            status = pending_response->wait();
+        }
+        catch(tl::timeout const &ex)
+        {
+            LOG_WARNING("[DataStoreAdminClient] Notification timed out");
+        }
+        catch(tl::exception const &ex)
+        {}
+        delete pending_response;
+        return status;
+    }
+
+    // joins the asynchronous batch notification, return_codes get one code per story of the batch
+    static int wait_for_batch_notification(tl::async_response* pending_response, size_t batch_size
+                                           , std::vector <int> &return_codes)
+    {
+        return_codes.clear();
+        if(pending_response == nullptr)
+        { return chronolog::CL_ERR_UNKNOWN; }
+
+        int status = chronolog::CL_ERR_UNKNOWN;
+        try
+        {
+            std::vector <int> batch_codes = pending_response->wait();
+            return_codes.swap(batch_codes);
+            if(return_codes.size() == batch_size)
+            { status = chronolog::CL_SUCCESS; }
+        }
+        catch(tl::timeout const &ex)
+        {
+            LOG_WARNING("[DataStoreAdminClient] Batch notification timed out");
+        }
+        catch(tl::exception const &ex)
+        {}
+        delete pending_response;
+        return status;
+    }
+
     ~DataStoreAdminClient()
     {
         collection_service_available.deregister();
         shutdown_data_collection.deregister();
         start_story_recording.deregister();
         stop_story_recording.deregister();
+        migrate_story_recording.deregister();
+        start_story_shard_recording.deregister();
+        start_limited_story_recording.deregister();
+        start_story_recording_batch.deregister();
+        stop_story_recording_batch.deregister();
     }
 
 private:
@@ -110,6 +308,11 @@ private:
     tl::remote_procedure shutdown_data_collection;
     tl::remote_procedure start_story_recording;
     tl::remote_procedure stop_story_recording;
+    tl::remote_procedure migrate_story_recording;
+    tl::remote_procedure start_story_shard_recording;
+    tl::remote_procedure start_limited_story_recording;
+    tl::remote_procedure start_story_recording_batch;
+    tl::remote_procedure stop_story_recording_batch;
 
     // constructor is private to make sure thalium rpc objects are created on the heap, not stack
     DataStoreAdminClient(tl::engine &tl_engine, std::string const &collection_service_addr
@@ -120,6 +323,11 @@ private:
         shutdown_data_collection = tl_engine.define("shutdown_data_collection");
         start_story_recording = tl_engine.define("start_story_recording");
         stop_story_recording = tl_engine.define("stop_story_recording");
+        migrate_story_recording = tl_engine.define("migrate_story_recording");
+        start_story_shard_recording = tl_engine.define("start_story_shard_recording");
+        start_limited_story_recording = tl_engine.define("start_limited_story_recording");
+        start_story_recording_batch = tl_engine.define("start_story_recording_batch");
+        stop_story_recording_batch = tl_engine.define("stop_story_recording_batch");
     }
 };
 }
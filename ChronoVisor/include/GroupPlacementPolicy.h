@@ -0,0 +1,129 @@
+#ifndef GROUP_PLACEMENT_POLICY_H
+#define GROUP_PLACEMENT_POLICY_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ServiceId.h" //for chronolog::RecordingGroupId definition
+#include "ProcessLoadStats.h" //for chronolog::StoryLoad definition
+
+namespace chronolog
+{
+
+// GroupLoad is the load snapshot of an active RecordingGroup the placement policy chooses from:
+// storyCount is maintained by the KeeperRegistry as the stories are assigned and released,
+// the rest is aggregated over the latest stats messages of the group's Keepers and Grapher
+
+struct GroupLoad
+{
+    RecordingGroupId groupId = 0;
+    uint32_t storyCount = 0;
+    uint64_t ingestionRate = 0;   // events per second
+    uint64_t queueDepth = 0;      // ingestion and extraction backlog
+    uint64_t residentMemory = 0;  // bytes
+    uint32_t capacity = 1;        // relative processing capacity of the group
+
+    // load per unit of capacity; one story, 1000 events/sec of ingestion
+    // or 1000 backlogged events/chunks weigh the same
+    double loadScore() const;
+
+    // the share of the load score a story with this ingestion rate adds to the group
+    double storyLoadScore(uint64_t story_ingestion_rate) const;
+};
+
+// Story rebalancing: ChronoVisor periodically moves one hot story off the most loaded group
+// onto the least loaded one when the most loaded group is above imbalance_ratio times the mean load
+
+// returns false if the groups are balanced enough, otherwise the indexes of the most and the least loaded groups
+bool selectRebalancingGroups(std::vector <GroupLoad> const &group_loads, double imbalance_ratio, size_t &source
+                             , size_t &target);
+
+// picks the candidate story whose move leaves the larger of the two group loads the lowest;
+// only the moves that keep both groups below the source group's current load qualify,
+// so the story can't be bounced straight back
+bool selectStoryToMigrate(GroupLoad const &source, GroupLoad const &target, std::vector <StoryLoad> const &candidates
+                          , StoryId &story_id);
+
+class GroupPlacementPolicy
+{
+public:
+    virtual ~GroupPlacementPolicy() = default;
+
+    // returns the index of the selected group in the group_loads vector, the vector is not empty
+    virtual size_t selectGroup(std::vector <GroupLoad> const &group_loads) = 0;
+
+    virtual std::string getName() const = 0;
+
+    // supported policies : "uniform", "least_loaded", "power_of_two", "weighted_capacity";
+    // returns nullptr for the unknown policy name
+    static GroupPlacementPolicy *CreateGroupPlacementPolicy(std::string const &policy_name, uint64_t seed);
+
+protected:
+    GroupPlacementPolicy() = default;
+};
+
+// uniform random choice, the original KeeperRegistry placement
+class UniformPlacementPolicy: public GroupPlacementPolicy
+{
+public:
+    explicit UniformPlacementPolicy(uint64_t seed): randomGenerator(seed)
+    {}
+
+    size_t selectGroup(std::vector <GroupLoad> const &group_loads) override;
+
+    std::string getName() const override
+    { return "uniform"; }
+
+private:
+    std::mt19937 randomGenerator;
+};
+
+// the group with the lowest load score, ties are broken by the story count
+class LeastLoadedPlacementPolicy: public GroupPlacementPolicy
+{
+public:
+    LeastLoadedPlacementPolicy() = default;
+
+    size_t selectGroup(std::vector <GroupLoad> const &group_loads) override;
+
+    std::string getName() const override
+    { return "least_loaded"; }
+};
+
+// the less loaded of two groups drawn at random, avoids herding new stories onto one group
+// while its reported load is still stale
+class PowerOfTwoPlacementPolicy: public GroupPlacementPolicy
+{
+public:
+    explicit PowerOfTwoPlacementPolicy(uint64_t seed): randomGenerator(seed)
+    {}
+
+    size_t selectGroup(std::vector <GroupLoad> const &group_loads) override;
+
+    std::string getName() const override
+    { return "power_of_two"; }
+
+private:
+    std::mt19937 randomGenerator;
+};
+
+// random choice with the probability proportional to the group capacity
+class WeightedCapacityPlacementPolicy: public GroupPlacementPolicy
+{
+public:
+    explicit WeightedCapacityPlacementPolicy(uint64_t seed): randomGenerator(seed)
+    {}
+
+    size_t selectGroup(std::vector <GroupLoad> const &group_loads) override;
+
+    std::string getName() const override
+    { return "weighted_capacity"; }
+
+private:
+    std::mt19937 randomGenerator;
+};
+
+}
+
+#endif
@@ -2,9 +2,9 @@
 #define KEEPER_REGISTRY_H
 
 #include <chrono>
+#include <list>
 #include <map>
 #include <mutex>
-#include <random>
 #include <vector>
 
 #include <thallium.hpp>
@@ -20,6 +20,9 @@
 #include "PlayerRegistrationMsg.h"
 #include "PlayerStatsMsg.h"
 #include "ConfigurationManager.h"
+#include "GroupPlacementPolicy.h"
+#include "StoryRecordingStartMsg.h"
+#include "VisorMetadataStore.h"
 
 namespace chronolog
 {
@@ -37,6 +40,20 @@ class DataStoreAdminClient;
 
 class KeeperRegistryService;
 
+// one story of the AcquireStories batch, the registry fills in the error code,
+// the recording keepers of the client's shard and the player of the story
+struct StoryAcquisition
+{
+    ChronicleName chronicleName;
+    StoryName storyName;
+    StoryId storyId = 0;
+    uint32_t shardCount = 1;
+    StoryAdmissionLimits admissionLimits;   // event rate limits of the story's chronicle
+    int errorCode = CL_ERR_UNKNOWN;
+    std::vector<KeeperIdCard> keepers;
+    ServiceId player;
+};
+
 class KeeperProcessEntry
 {
 public:
@@ -61,6 +78,8 @@ public:
     bool active;
     uint64_t lastStatsTime;
     uint32_t activeStoryCount;
+    ProcessLoadStats loadStats;  // load stats of the latest KeeperStatsMsg
+    std::vector<StoryLoad> hotStories; // the hottest stories of the latest KeeperStatsMsg
     std::list<std::pair<std::time_t, DataStoreAdminClient*>> delayedExitClients;
 };
 
@@ -88,6 +107,7 @@ public:
     bool active;
     uint64_t lastStatsTime;
     uint32_t activeStoryCount;
+    ProcessLoadStats loadStats;  // load stats of the latest GrapherStatsMsg
     std::list<std::pair<std::time_t, DataStoreAdminClient*>> delayedExitGrapherClients;
     };
 
@@ -115,6 +135,8 @@ public:
         bool active;
         uint64_t lastStatsTime;
         uint32_t activeStoryCount;
+        ReadingClassStats interactiveReadingStats;  // archive reading queue stats of the latest PlayerStatsMsg
+        ReadingClassStats bulkReadingStats;
         std::list<std::pair<std::time_t, DataStoreAdminClient*>> delayedExitPlayerClients;
     };
 
@@ -128,6 +150,7 @@ public:
         RecordingGroup(RecordingGroupId group_id, GrapherProcessEntry* grapher_ptr = nullptr, PlayerProcessEntry* player_ptr=nullptr)
             : groupId(group_id)
             , activeKeeperCount(0)
+            , assignedStoryCount(0)
             , grapherProcess(grapher_ptr)
             , playerProcess(player_ptr)
         {}
@@ -144,9 +167,11 @@ public:
         void clearDelayedExitPlayer(PlayerProcessEntry&, std::time_t);
 
         std::vector<KeeperIdCard>& getActiveKeepers(std::vector<KeeperIdCard>& keeper_id_cards);
+        GroupLoad getGroupLoad() const;
 
         RecordingGroupId groupId;
         size_t activeKeeperCount;
+        uint32_t assignedStoryCount; // stories the registry has placed on this group
         GrapherProcessEntry* grapherProcess;
         PlayerProcessEntry* playerProcess;
         std::map<std::pair<uint32_t, uint16_t>, KeeperProcessEntry> keeperProcesses;
@@ -173,7 +198,9 @@ public:
 
         bool is_shutting_down() const { return (SHUTTING_DOWN == registryState); }
 
-        int InitializeRegistryService(VisorConfiguration const&);
+        // the active story recordings recovered by the metadata store are restored before the registry service starts,
+        // so the Keepers and Graphers re-registering after the Visor restart pick up the stories they are still recording
+        int InitializeRegistryService(VisorConfiguration const&, VisorMetadataStore* metadata_store = nullptr);
 
         int ShutdownRegistryService();
 
@@ -181,10 +208,37 @@ public:
         int unregisterKeeperProcess(KeeperIdCard const& keeper_id_card);
         void updateKeeperProcessStats(KeeperStatsMsg const& keeperStatsMsg);
 
+        // the new story is placed on shard_count distinct RecordingGroups (capped by the number of active groups),
+        // the returned keepers are those of the shard the client is mapped to by its ClientId;
+        // the keepers enforce the admission limits of the story's chronicle
         int notifyRecordingGroupOfStoryRecordingStart(ChronicleName const &, StoryName const &, StoryId const &
+                                                      , ClientId const &, uint32_t shard_count
+                                                      , StoryAdmissionLimits const &
                                                       , std::vector <KeeperIdCard> &, ServiceId &);
         int notifyRecordingGroupOfStoryRecordingStop(StoryId const&);
 
+        // stops recording the stories restored by the metadata store that no client acquired again
+        // within the claim grace period after the Visor restart, called periodically by the ChronoVisor main loop
+        int expireUnclaimedRestoredStories();
+
+        // batched variants for the stories acquired or released together: the stories are placed the same way
+        // as one by one, but every process of a RecordingGroup gets one notification rpc for the whole batch
+        int notifyRecordingGroupsOfStoryRecordingStart(ClientId const &, std::vector<StoryAcquisition> &);
+        int notifyRecordingGroupsOfStoryRecordingStop(std::vector<StoryId> const &);
+
+        // current recording keepers of the client's shard and the player of the active story,
+        // for the clients redirected by the story migration
+        int getStoryRecordingKeepers(StoryId const &, ClientId const &, std::vector <KeeperIdCard> &, ServiceId &);
+
+        // starts recording the active story on the target group and only then assigns the story to it,
+        // the current group's keepers redirect the clients to the target group while their pipelines drain
+        // through the normal decay path; the story stays on the current group if the target group fails to start it
+        int migrateStory(StoryId const &, RecordingGroupId const &);
+
+        // moves one hot story off the most loaded RecordingGroup if the group load imbalance
+        // is over the configured ratio, called periodically by the ChronoVisor main loop
+        int rebalanceRecordingGroups();
+
         int registerGrapherProcess(GrapherRegistrationMsg const& reg_msg);
         int unregisterGrapherProcess(GrapherIdCard const& id_card);
         void updateGrapherProcessStats(GrapherStatsMsg const& );
@@ -197,11 +251,51 @@ public:
         KeeperRegistry(KeeperRegistry const&) = delete;//disable copying
         KeeperRegistry& operator=(KeeperRegistry const&) = delete;
 
-        int notifyGrapherOfStoryRecordingStart(RecordingGroup &, ChronicleName const &, StoryName const &, StoryId const & , uint64_t);
-        int notifyGrapherOfStoryRecordingStop(RecordingGroup&, StoryId const&);
-        int notifyKeepersOfStoryRecordingStart(RecordingGroup&, std::vector<KeeperIdCard> &, ChronicleName const &
-                                               , StoryName const &, StoryId const &, uint64_t);
-        int notifyKeepersOfStoryRecordingStop(RecordingGroup &, std::vector <KeeperIdCard> const &, StoryId const &);
+        // one process notified of the story recording start or stop by the parallel notification fan-out
+        struct ProcessNotification
+        {
+            std::string processIdString;
+            DataStoreAdminClient* adminClient = nullptr; // nullptr if the process is not available for notification
+            bool isKeeper = false;
+            KeeperIdCard keeperIdCard;
+            thallium::async_response* pendingResponse = nullptr;
+            int returnCode = CL_ERR_UNKNOWN;
+            std::vector<int> storyReturnCodes; // batched notifications only
+        };
+
+        // the Grapher, Player and Keepers of the group to be notified
+        struct GroupNotification
+        {
+            ProcessNotification grapher;
+            ProcessNotification player;
+            std::vector<ProcessNotification> keepers;
+
+            std::vector<ProcessNotification*> processes();
+        };
+
+        // collects the active processes of the group, takes the registryLock;
+        // the delayedExit logic keeps their adminClients alive for the duration of the notification
+        GroupNotification collectGroupNotification(RecordingGroup &);
+        // notifies the groups recording the story, the group at index i records shard i of the sharded story:
+        // all the rpcs are issued before any of them is joined, so the latency is that of the slowest process;
+        // if any group fails to start the story the processes that did start it are told to stop
+        int notifyGroupsOfStoryRecordingStart(std::vector<RecordingGroup*> const &, ChronicleName const &
+                                              , StoryName const &, StoryId const &, uint64_t
+                                              , StoryAdmissionLimits const &
+                                              , std::vector<std::vector<KeeperIdCard>> &group_keepers);
+        void notifyGroupsOfStoryRecordingStop(std::vector<RecordingGroup*> const &, StoryId const &
+                                              , bool story_migrated = false);
+        // issues the stop rpcs to all the processes before joining them, story_migrated applies to the keepers only
+        void stopProcessNotifications(std::vector<ProcessNotification*> const &, StoryId const &, bool story_migrated);
+        // chooses the shard groups of the new story and registers it as active, the caller holds the registryLock
+        std::vector<RecordingGroup*> placeStory(ChronicleName const &, StoryName const &, StoryId const &
+                                                , uint32_t shard_count, StoryAdmissionLimits const &);
+        // removes the story from the active stories and returns its shard groups, the caller holds the registryLock
+        std::vector<RecordingGroup*> removeActiveStory(StoryId const &);
+        // rebuilds activeStories, storyShards and activeStoryNames, the caller holds the registryLock
+        void restoreStoryRecordings(VisorMetadataStore const &);
+        // logs the groups recording the story to the metadata store, the caller holds the registryLock
+        void logStoryRecordingGroups(StoryId const &);
 
         RegistryState registryState;
         std::mutex registryLock;
@@ -209,12 +303,19 @@ public:
         KeeperRegistryService* keeperRegistryService;
         std::string dataStoreAdminServiceProtocol;
         size_t delayedDataAdminExitSeconds;
+        std::chrono::milliseconds notificationTimeout; // story start/stop notification rpc timeout
 
         std::map<RecordingGroupId, RecordingGroup> recordingGroups;
         std::vector<RecordingGroup*> activeGroups;
-        std::mt19937 mt_random;//mersene twister random int generator
-        std::uniform_int_distribution<size_t> group_id_distribution;
-        std::map<StoryId, RecordingGroup*> activeStories;
+        GroupPlacementPolicy* placementPolicy; // chooses the RecordingGroup for the new story
+        std::map<StoryId, RecordingGroup*> activeStories; // the group recording shard 0 of the sharded story
+        std::map<StoryId, std::vector<RecordingGroup*>> storyShards; // groups recording the shards of the sharded stories
+        std::map<StoryId, std::pair<ChronicleName, StoryName>> activeStoryNames; // needed to restart the story elsewhere
+        std::map<StoryId, StoryAdmissionLimits> storyAdmissionLimits; // the active stories with the event rate limits
+        std::map<StoryId, std::time_t> unclaimedRestoredStories; // restored stories not acquired since, by restore time
+        double storyRebalancingRatio;      // 0 disables the story migration
+        std::time_t lastStoryMigrationTime;
+        VisorMetadataStore* metadataStore; // nullptr if the Visor metadata is not persisted
     };
 }
 
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "KeeperIdCard.h"
 #include "KeeperRegistrationMsg.h"
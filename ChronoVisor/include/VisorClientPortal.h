@@ -38,7 +38,8 @@ public:
 
     ~VisorClientPortal();
 
-    int StartServices(VisorConfiguration const &, KeeperRegistry*);
+    // the chronicles and stories recovered by the metadata store are restored before the service starts
+    int StartServices(VisorConfiguration const &, KeeperRegistry*, VisorMetadataStore* metadata_store = nullptr);
 
     void ShutdownServices();
 
@@ -60,6 +61,20 @@ public:
 
     int ReleaseStory(ClientId const &client_id, std::string const &chronicle_name, std::string const &story_name);
 
+    // bulk story setup: the responses and return codes follow the order of story_names,
+    // the recording processes are notified once per batch instead of once per story
+    std::vector <AcquireStoryResponseMsg> AcquireStories(ClientId const &client_id, std::string const &chronicle_name
+                                                         , std::vector <std::string> const &story_names
+                                                         , const std::map <std::string, std::string> &attrs
+                                                         , int &flags);
+
+    std::vector <int> ReleaseStories(ClientId const &client_id, std::string const &chronicle_name
+                                     , std::vector <std::string> const &story_names);
+
+    // current recording keepers of the story acquired by the client, used after the story has been migrated
+    AcquireStoryResponseMsg RefreshStory(ClientId const &client_id, std::string const &chronicle_name
+                                         , std::string const &story_name);
+
 /*int ReleaseStory( ClientId const&client_id, StoryId const&);
 int DestroyStory( ClientId const&client_id, StoryId const&);
 */
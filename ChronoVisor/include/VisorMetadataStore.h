@@ -0,0 +1,123 @@
+#ifndef VISOR_METADATA_STORE_H
+#define VISOR_METADATA_STORE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "chronolog_types.h"
+#include "ServiceId.h" //for chronolog::RecordingGroupId definition
+
+namespace chronolog
+{
+
+// VisorMetadataStore keeps the ChronoVisor metadata that has to outlive the Visor process on local disk:
+// the chronicles and their stories from the ChronicleMetaDirectory and the RecordingGroups
+// recording the active stories from the KeeperRegistry.
+// Every change is appended to the log file as it happens; once the log grows past the snapshot interval
+// the whole state is written to a new snapshot file and the log starts over.
+// The appends go to the page cache and survive the Visor process crash; the log is fsync'd by the periodic
+// snapshotIfDue call, on the snapshot rotation and on shutdown, so a machine crash loses at most the records
+// logged since the last main loop tick.
+// On startup the Visor loads the snapshot, replays the log on top of it and rebuilds its registries
+// before it starts the RPC services.
+//
+// Record framing, both files: uint32 payload length, uint64 payload CityHash64, payload.
+// The records set or erase one entry each, so replaying a log that has already been folded into the snapshot
+// (the Visor stopped between the snapshot rename and the log truncation) ends in the same state.
+
+struct ChronicleRecord
+{
+    std::map <std::string, std::string> properties;
+    std::unordered_map <StoryName, std::map <std::string, std::string>> stories; // story attributes by story name
+};
+
+// the RecordingGroups recording the active story, the group of shard 0 first
+struct StoryRecordingRecord
+{
+    StoryId storyId = 0;
+    ChronicleName chronicleName;
+    StoryName storyName;
+    std::vector <RecordingGroupId> shardGroups;
+};
+
+class VisorMetadataStore
+{
+public:
+    // returns nullptr if the store directory can't be created
+    static VisorMetadataStore *CreateVisorMetadataStore(std::string const &store_dir
+                                                        , uint64_t snapshot_interval_records);
+
+    ~VisorMetadataStore();
+
+    // loads the snapshot and replays the log; a torn record at the end of the log left by a crash
+    // is cut off, returns CL_ERR_UNKNOWN if the files can't be read or the log can't be reopened
+    int recover();
+
+    std::unordered_map <ChronicleName, ChronicleRecord> const &getChronicles() const
+    { return chronicles; }
+
+    std::map <StoryId, StoryRecordingRecord> const &getStoryRecordings() const
+    { return storyRecordings; }
+
+    size_t getStoryCount() const;
+
+    // payloads of the chronicle and story records, built by the ChronicleMetaDirectory under the chronicle lock
+    // and logged with logRecords() once the lock is released
+    static std::string chronicleCreatedRecord(ChronicleName const &);
+    static std::string chronicleDestroyedRecord(ChronicleName const &);
+    static std::string chronicleAttrEditedRecord(ChronicleName const &, std::string const &key, std::string const &value);
+    static std::string storyCreatedRecord(ChronicleName const &, StoryName const &
+                                          , std::map <std::string, std::string> const &attrs);
+    static std::string storyDestroyedRecord(ChronicleName const &, StoryName const &);
+
+    // appends the records in the given order
+    int logRecords(std::vector <std::string> const &);
+
+    int logChronicleCreated(ChronicleName const &);
+    int logChronicleDestroyed(ChronicleName const &);
+    int logChronicleAttrEdited(ChronicleName const &, std::string const &key, std::string const &value);
+    int logStoryCreated(ChronicleName const &, StoryName const &, std::map <std::string, std::string> const &attrs);
+    int logStoryDestroyed(ChronicleName const &, StoryName const &);
+    int logStoryRecordingStarted(StoryRecordingRecord const &);
+    int logStoryRecordingStopped(StoryId const &);
+
+    // writes the snapshot and truncates the log if snapshotIntervalRecords records were logged since the last one,
+    // otherwise fsyncs the records logged since the previous call; called periodically by the ChronoVisor main loop
+    int snapshotIfDue();
+
+    int writeSnapshot();
+
+private:
+    VisorMetadataStore(std::string const &store_dir, uint64_t snapshot_interval_records);
+
+    VisorMetadataStore(VisorMetadataStore const &) = delete;
+    VisorMetadataStore &operator=(VisorMetadataStore const &) = delete;
+
+    // applies one record payload to the in-memory state, false if the payload is malformed
+    bool applyRecord(char const *payload, size_t payload_size);
+    // replays the framed records of the file, returns the offset past the last intact record
+    int replayFile(std::string const &file_path, size_t &valid_size);
+    // frames, applies and appends the record to the log
+    int appendRecord(std::string const &payload);
+    // fsyncs the log, the caller holds the storeMutex
+    int syncLog();
+
+    std::string storeDir;
+    std::string logFilePath;
+    std::string snapshotFilePath;
+    uint64_t snapshotIntervalRecords;
+    uint64_t recordsSinceSnapshot;
+    uint64_t recordsSinceSync; // records appended to the log since its last fsync
+    int logFd;
+
+    std::mutex storeMutex;
+    std::unordered_map <ChronicleName, ChronicleRecord> chronicles;
+    std::map <StoryId, StoryRecordingRecord> storyRecordings;
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <unistd.h>
 #include <mutex>
+#include <shared_mutex>
 #include <typedefs.h>
 #include <ClientRegistryManager.h>
 
@@ -12,12 +13,78 @@ ChronicleMetaDirectory::ChronicleMetaDirectory()
 {
     LOG_DEBUG("[ChronicleMetaDirectory] Constructor is called. Object created at {} in thread PID={}"
          , static_cast<const void*>(this), getpid());
-    chronicleMap_ = new std::unordered_map <uint64_t, Chronicle*>();
 }
 
 ChronicleMetaDirectory::~ChronicleMetaDirectory()
+{}
+
+Chronicle*ChronicleMetaDirectory::findChronicle(ChronicleMapShard &shard, uint64_t cid)
+{
+    auto chronicleMapRecord = shard.chronicleMap.find(cid);
+    return (chronicleMapRecord != shard.chronicleMap.end() ? chronicleMapRecord->second : nullptr);
+}
+
+void ChronicleMetaDirectory::queueMetadataRecord(ChronicleMapShard &shard, std::string &&record)
+{
+    std::lock_guard <std::mutex> queueLock(shard.queuedRecordsMutex);
+    shard.queuedRecords.push_back(std::move(record));
+}
+
+void ChronicleMetaDirectory::logQueuedMetadataRecords(ChronicleMapShard &shard)
 {
-    delete chronicleMap_;
+    // the first caller to get here appends the records queued by the others as well;
+    // once the logging mutex is taken the caller's own record is either still queued or already appended
+    std::lock_guard <std::mutex> loggingLock(shard.recordsLoggingMutex);
+    std::vector <std::string> records;
+    {
+        std::lock_guard <std::mutex> queueLock(shard.queuedRecordsMutex);
+        records.swap(shard.queuedRecords);
+    }
+    if(!records.empty())
+    { metadataStore_->logRecords(records); }
+}
+
+/**
+ * Rebuild the Chronicles and Stories recovered by the metadata store \n
+ * The Stories come back unacquired, the clients acquire them again after they reconnect
+ * @param metadata_store: metadata store after the recovery
+ * @return chronolog::CL_SUCCESS if all the Chronicles and Stories are restored \n
+ *         chronolog::CL_ERR_UNKNOWN otherwise
+ */
+int ChronicleMetaDirectory::restore_from_metadata_store(chronolog::VisorMetadataStore const &metadata_store)
+{
+    int ret = chronolog::CL_SUCCESS;
+    for(auto const &[chronicle_name, chronicle_record]: metadata_store.getChronicles())
+    {
+        uint64_t cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
+        ChronicleMapShard &shard = getShard(cid);
+        std::unique_lock <std::shared_mutex> shardLock(shard.shardMutex);
+        if(findChronicle(shard, cid) != nullptr)
+        {
+            continue;
+        }
+        auto*pChronicle = new Chronicle();
+        pChronicle->setName(chronicle_name);
+        pChronicle->setCid(cid);
+        for(auto const &property: chronicle_record.properties)
+        {
+            pChronicle->getPropertyList().insert_or_assign(property.first, property.second);
+        }
+        pChronicle->getStoryMap().reserve(chronicle_record.stories.size());
+        for(auto const &[story_name, story_attrs]: chronicle_record.stories)
+        {
+            if(pChronicle->addStory(story_name, story_attrs).first != chronolog::CL_SUCCESS)
+            {
+                LOG_ERROR("[ChronicleMetaDirectory] Fail to restore StoryName={} in ChronicleName={}"
+                     , story_name.c_str(), chronicle_name.c_str());
+                ret = chronolog::CL_ERR_UNKNOWN;
+            }
+        }
+        shard.chronicleMap.emplace(cid, pChronicle);
+    }
+    LOG_INFO("[ChronicleMetaDirectory] Restored {} Chronicles with {} Stories from the metadata store"
+         , metadata_store.getChronicles().size(), metadata_store.getStoryCount());
+    return ret;
 }
 
 /**
@@ -37,12 +104,12 @@ int ChronicleMetaDirectory::create_chronicle(const std::string &name
         LOG_DEBUG("[ChronicleMetaDirectory] Attribute of Chronicle {}: {}={}", name.c_str(), iter->first.c_str()
              , iter->second.c_str());
     }
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* Check if Chronicle already exists, fail if true */
     uint64_t cid;
     cid = CityHash64(name.c_str(), name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord != chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::unique_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    if(findChronicle(shard, cid) != nullptr)
     {
         LOG_WARNING("[ChronicleMetaDirectory] A Chronicle with the same ChronicleName={} already exists", name.c_str());
         return chronolog::CL_ERR_CHRONICLE_EXISTS;
@@ -50,10 +117,26 @@ int ChronicleMetaDirectory::create_chronicle(const std::string &name
     auto*pChronicle = new Chronicle();
     pChronicle->setName(name);
     pChronicle->setCid(cid);
-    auto res = chronicleMap_->emplace(cid, pChronicle);
+    // the attributes are kept as the chronicle properties, e.g. the event rate limits of its stories
+    for(auto const &attr: attrs)
+    {
+        pChronicle->getPropertyList().insert_or_assign(attr.first, attr.second);
+    }
+    auto res = shard.chronicleMap.emplace(cid, pChronicle);
     if(res.second)
     {
         LOG_DEBUG("[ChronicleMetaDirectory] ChronicleName={} is created", name.c_str());
+        if(metadataStore_ != nullptr)
+        {
+            queueMetadataRecord(shard, chl::VisorMetadataStore::chronicleCreatedRecord(name));
+            for(auto const &attr: attrs)
+            {
+                queueMetadataRecord(shard
+                                    , chl::VisorMetadataStore::chronicleAttrEditedRecord(name, attr.first, attr.second));
+            }
+            shardLock.unlock();
+            logQueuedMetadataRecords(shard);
+        }
         return chronolog::CL_SUCCESS;
     }
     else
@@ -76,15 +159,16 @@ int ChronicleMetaDirectory::create_chronicle(const std::string &name
 int ChronicleMetaDirectory::destroy_chronicle(const std::string &name)
 {
     LOG_DEBUG("[ChronicleMetaDirectory] Destroying ChronicleName={}", name.c_str());
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(name.c_str(), name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord != chronicleMap_->end())
+    /* the exclusive shard lock keeps out every other request to the chronicles of this shard */
+    ChronicleMapShard &shard = getShard(cid);
+    std::unique_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle != nullptr)
     {
         /* Check if Chronicle is acquired by checking if each of its Story is acquired, fail if true */
-        Chronicle*pChronicle = chronicleMapRecord->second;
         auto storyMap = pChronicle->getStoryMap();
         int ret = chronolog::CL_SUCCESS;
         for(auto storyMapRecord: storyMap)
@@ -112,10 +196,16 @@ int ChronicleMetaDirectory::destroy_chronicle(const std::string &name)
         }
         /* No Stories in Chronicle is acquired, ready to destroy */
         delete pChronicle;
-        auto nErased = chronicleMap_->erase(cid);
+        auto nErased = shard.chronicleMap.erase(cid);
         if(nErased == 1)
         {
             LOG_DEBUG("[ChronicleMetaDirectory] ChronicleName={} is destroyed", name.c_str());
+            if(metadataStore_ != nullptr)
+            {
+                queueMetadataRecord(shard, chl::VisorMetadataStore::chronicleDestroyedRecord(name));
+                shardLock.unlock();
+                logQueuedMetadataRecords(shard);
+            }
             return chronolog::CL_SUCCESS;
         }
         else
@@ -146,14 +236,15 @@ int ChronicleMetaDirectory::destroy_story(std::string const &chronicle_name, con
 {
     LOG_DEBUG("[ChronicleMetaDirectory] Destroying StoryName={} in ChronicleName={}", story_name.c_str()
          , chronicle_name.c_str());
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord != chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle != nullptr)
     {
-        Chronicle*pChronicle = chronicleMap_->find(cid)->second;
+        std::unique_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
         /* Then check if Story exists, fail if false */
         uint64_t sid = pChronicle->getStoryId(story_name);
         if(sid == 0)
@@ -179,6 +270,13 @@ int ChronicleMetaDirectory::destroy_story(std::string const &chronicle_name, con
             LOG_ERROR("[ChronicleMetaDirectory] Fail to remove StoryName={} in ChronicleName={}", story_name.c_str()
                  , chronicle_name.c_str());
         }
+        else if(metadataStore_ != nullptr)
+        {
+            queueMetadataRecord(shard, chl::VisorMetadataStore::storyDestroyedRecord(chronicle_name, story_name));
+            chronicleLock.unlock();
+            shardLock.unlock();
+            logQueuedMetadataRecords(shard);
+        }
         return res;
     }
     else
@@ -207,24 +305,29 @@ int ChronicleMetaDirectory::acquire_story(chl::ClientId const &client_id, const
     LOG_DEBUG("[ChronicleMetaDirectory] ClientID={} acquiring StoryName={} in ChronicleName={} with Flags={}", client_id
          , story_name.c_str(), chronicle_name.c_str(), flags);
 
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord == chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle == nullptr)
     {
         LOG_WARNING("[ChronicleMetaDirectory] ChronicleName={} does not exist", chronicle_name.c_str());
         return chronolog::CL_ERR_NOT_EXIST;
     }
-    Chronicle*pChronicle = chronicleMapRecord->second;
+    std::unique_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
     /* Then check if Story already_acquired_by_this_client, fail if false */
+    bool story_exists = pChronicle->hasStory(story_name);
     auto ret = pChronicle->addStory(story_name, attrs);
     if(ret.first != chronolog::CL_SUCCESS)
     {
         return ret.first;
     }
     Story*pStory = ret.second;
+    bool story_created = (!story_exists && metadataStore_ != nullptr);
+    if(story_created)
+    { queueMetadataRecord(shard, chl::VisorMetadataStore::storyCreatedRecord(chronicle_name, story_name, attrs)); }
     /* Last check if this client has acquired this Story already, do nothing and return success if true */
     auto acquirerMap = pStory->getAcquirerMap();
     auto acquirerMapRecord = acquirerMap.find(client_id);
@@ -245,6 +348,12 @@ int ChronicleMetaDirectory::acquire_story(chl::ClientId const &client_id, const
     pStory->addAcquirerClient(client_id, clientRegistryManager_->get_client_info(client_id));
     /* Add this Story to acquiredStoryMap for this client */
     clientRegistryManager_->add_story_acquisition(client_id, story_id, pStory);
+    if(story_created)
+    {
+        chronicleLock.unlock();
+        shardLock.unlock();
+        logQueuedMetadataRecords(shard);
+    }
     return chronolog::CL_SUCCESS;
 }
 
@@ -265,15 +374,16 @@ int ChronicleMetaDirectory::release_story(chl::ClientId const &client_id, const
 {
     LOG_DEBUG("[ChronicleMetaDirectory] ClientID={} releasing StoryName={} in ChronicleName={}", client_id
          , story_name.c_str(), chronicle_name.c_str());
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
     int ret = chronolog::CL_ERR_NOT_EXIST;
-    auto chronicleRecord = chronicleMap_->find(cid);
-    if(chronicleRecord != chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle != nullptr)
     {
-        Chronicle*pChronicle = chronicleRecord->second;
+        std::unique_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
         /* Then check if Story exists, fail if false */
         uint64_t sid = pChronicle->getStoryId(story_name);
         if(sid == 0)
@@ -309,19 +419,81 @@ int ChronicleMetaDirectory::release_story(chl::ClientId const &client_id, const
     return ret;
 }
 
+/**
+ * Look up the StoryId of the Story acquired by the client
+ * @param client_id: ClientID that acquired the Story
+ * @param chronicle_name: name of the Chronicle that the Story belongs to
+ * @param story_name: name of the Story
+ * @param story_id to populate with the story_id assigned to the story
+ * @return chronolog::CL_SUCCESS if the client has acquired the Story \n
+ *         chronolog::CL_ERR_NOT_EXIST if the Chronicle or the Story does not exist \n
+ *         chronolog::CL_ERR_NOT_ACQUIRED if the Story is not acquired by this client
+ */
+int ChronicleMetaDirectory::get_acquired_story_id(chl::ClientId const &client_id, const std::string &chronicle_name
+                                                  , const std::string &story_name, StoryId &story_id)
+{
+    uint64_t cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle == nullptr)
+    {
+        return chronolog::CL_ERR_NOT_EXIST;
+    }
+    std::shared_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
+    uint64_t sid = pChronicle->getStoryId(story_name);
+    if(sid == 0)
+    {
+        return chronolog::CL_ERR_NOT_EXIST;
+    }
+    auto acquirerMap = pChronicle->getStoryMap().at(sid)->getAcquirerMap();
+    if(acquirerMap.find(client_id) == acquirerMap.end())
+    {
+        return chronolog::CL_ERR_NOT_ACQUIRED;
+    }
+    story_id = sid;
+    return chronolog::CL_SUCCESS;
+}
+
+/**
+ * Get all the attributes of a Chronicle
+ * @param name: name of the Chronicle
+ * @param attrs: attributes of the Chronicle
+ * @return chronolog::CL_SUCCESS if the Chronicle exists \n
+ *         chronolog::CL_ERR_NOT_EXIST otherwise
+ */
+int ChronicleMetaDirectory::get_chronicle_attrs(std::string const &name, std::map <std::string, std::string> &attrs)
+{
+    attrs.clear();
+    uint64_t cid;
+    cid = CityHash64(name.c_str(), name.length());
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle == nullptr)
+    {
+        return chronolog::CL_ERR_NOT_EXIST;
+    }
+    std::shared_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
+    attrs.insert(pChronicle->getPropertyList().begin(), pChronicle->getPropertyList().end());
+    return chronolog::CL_SUCCESS;
+}
+
 int ChronicleMetaDirectory::get_chronicle_attr(std::string const &name, const std::string &key, std::string &value)
 {
     LOG_DEBUG("[ChronicleMetaDirectory] Getting attributes Key={} from ChronicleName={}", key.c_str(), name.c_str());
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(name.c_str(), name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord != chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    auto chronicleMapRecord = shard.chronicleMap.find(cid);
+    if(chronicleMapRecord != shard.chronicleMap.end())
     {
-        Chronicle*pChronicle = chronicleMap_->find(cid)->second;
+        Chronicle*pChronicle = chronicleMapRecord->second;
         if(pChronicle)
         {
+            std::shared_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
             /* Then check if property exists, fail if false */
             auto propertyRecord = pChronicle->getPropertyList().find(key);
             if(propertyRecord != pChronicle->getPropertyList().end())
@@ -354,31 +526,32 @@ ChronicleMetaDirectory::edit_chronicle_attr(std::string const &name, const std::
 {
     LOG_DEBUG("[ChronicleMetaDirectory] Editing attribute Key={}, Value={} from ChronicleName={}", key.c_str(), value.c_str()
          , name.c_str());
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
     /* First check if Chronicle exists, fail if false */
     uint64_t cid;
     cid = CityHash64(name.c_str(), name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord != chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    auto chronicleMapRecord = shard.chronicleMap.find(cid);
+    if(chronicleMapRecord != shard.chronicleMap.end())
     {
-        Chronicle*pChronicle = chronicleMap_->find(cid)->second;
+        Chronicle*pChronicle = chronicleMapRecord->second;
         if(pChronicle)
         {
+            std::unique_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
             /* Then check if property exists, fail if false */
             auto propertyRecord = pChronicle->getPropertyList().find(key);
             if(propertyRecord != pChronicle->getPropertyList().end())
             {
-                auto res = pChronicle->getPropertyList().insert_or_assign(key, value);
-                if(res.second)
-                {
-                    return chronolog::CL_SUCCESS;
-                }
-                else
+                /* the property exists, so its value is assigned rather than inserted */
+                propertyRecord->second = value;
+                if(metadataStore_ != nullptr)
                 {
-                    LOG_ERROR("[ChronicleMetaDirectory] Something is wrong, fail to insert property Key={}, Value={}"
-                         , key.c_str(), value.c_str());
-                    return chronolog::CL_ERR_UNKNOWN;
+                    queueMetadataRecord(shard, chl::VisorMetadataStore::chronicleAttrEditedRecord(name, key, value));
+                    chronicleLock.unlock();
+                    shardLock.unlock();
+                    logQueuedMetadataRecords(shard);
                 }
+                return chronolog::CL_SUCCESS;
             }
             else
             {
@@ -409,10 +582,13 @@ int ChronicleMetaDirectory::show_chronicles(std::vector <std::string> &chronicle
 {
     chronicle_names.clear();
 
-    std::lock_guard <std::mutex> lock(g_chronicleMetaDirectoryMutex_);
-    for(auto &[key, value]: *chronicleMap_)
+    for(auto &shard: chronicleMapShards_)
     {
-        chronicle_names.emplace_back(value->getName());
+        std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+        for(auto &[key, value]: shard.chronicleMap)
+        {
+            chronicle_names.emplace_back(value->getName());
+        }
     }
     return chronolog::CL_SUCCESS;
 }
@@ -429,17 +605,17 @@ int ChronicleMetaDirectory::show_stories(const std::string &chronicle_name, std:
 {
     story_names.clear();
 
-    std::lock_guard <std::mutex> chronicleMapLock(g_chronicleMetaDirectoryMutex_);
-
     /* First check if Chronicle exists, fail if false */
 
     uint64_t cid;
     cid = CityHash64(chronicle_name.c_str(), chronicle_name.length());
-    auto chronicleMapRecord = chronicleMap_->find(cid);
-    if(chronicleMapRecord == chronicleMap_->end())
+    ChronicleMapShard &shard = getShard(cid);
+    std::shared_lock <std::shared_mutex> shardLock(shard.shardMutex);
+    Chronicle*pChronicle = findChronicle(shard, cid);
+    if(pChronicle == nullptr)
     { return chronolog::CL_ERR_NOT_EXIST; }
 
-    Chronicle*pChronicle = chronicleMap_->find(cid)->second;
+    std::shared_lock <std::shared_mutex> chronicleLock(pChronicle->getMutex());
 
     LOG_DEBUG("[ChronicleMetaDirectory] Chronicle at {}", static_cast<void*>(&(*pChronicle)));
     for(auto &[key, value]: pChronicle->getStoryMap())
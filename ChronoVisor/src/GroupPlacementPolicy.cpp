@@ -0,0 +1,140 @@
+#include <algorithm>
+
+#include "GroupPlacementPolicy.h"
+
+namespace chl = chronolog;
+
+// ingestion rate and backlog are scaled to the story count units
+#define LOAD_EVENTS_PER_STORY_UNIT 1000.0
+
+double chronolog::GroupLoad::loadScore() const
+{
+    double load = storyCount + ingestionRate / LOAD_EVENTS_PER_STORY_UNIT + queueDepth / LOAD_EVENTS_PER_STORY_UNIT;
+    return load / (capacity == 0 ? 1 : capacity);
+}
+
+double chronolog::GroupLoad::storyLoadScore(uint64_t story_ingestion_rate) const
+{
+    return (1 + story_ingestion_rate / LOAD_EVENTS_PER_STORY_UNIT) / (capacity == 0 ? 1 : capacity);
+}
+
+namespace
+{
+
+// true if group a is less loaded than group b
+bool lessLoaded(chl::GroupLoad const &a, chl::GroupLoad const &b)
+{
+    double a_score = a.loadScore();
+    double b_score = b.loadScore();
+    if(a_score != b_score)
+    { return a_score < b_score; }
+    return a.storyCount < b.storyCount;
+}
+
+}
+
+////////////////////////
+
+bool chronolog::selectRebalancingGroups(std::vector <chl::GroupLoad> const &group_loads, double imbalance_ratio
+                                        , size_t &source, size_t &target)
+{
+    if(group_loads.size() < 2)
+    { return false; }
+
+    source = 0;
+    target = 0;
+    double total_score = 0;
+    for(size_t i = 0; i < group_loads.size(); ++i)
+    {
+        total_score += group_loads[i].loadScore();
+        if(lessLoaded(group_loads[source], group_loads[i]))
+        { source = i; }
+        if(lessLoaded(group_loads[i], group_loads[target]))
+        { target = i; }
+    }
+
+    double mean_score = total_score / group_loads.size();
+    return (source != target && group_loads[source].loadScore() > imbalance_ratio * mean_score);
+}
+
+bool chronolog::selectStoryToMigrate(chl::GroupLoad const &source, chl::GroupLoad const &target
+                                     , std::vector <chl::StoryLoad> const &candidates, chl::StoryId &story_id)
+{
+    double source_score = source.loadScore();
+    double target_score = target.loadScore();
+    double best_score = source_score;
+    bool selected = false;
+
+    for(auto const &story_load: candidates)
+    {
+        double new_source_score = source_score - source.storyLoadScore(story_load.ingestionRate);
+        double new_target_score = target_score + target.storyLoadScore(story_load.ingestionRate);
+        double new_max_score = std::max(new_source_score, new_target_score);
+        if(new_max_score < best_score)
+        {
+            best_score = new_max_score;
+            story_id = story_load.storyId;
+            selected = true;
+        }
+    }
+    return selected;
+}
+
+////////////////////////
+
+chl::GroupPlacementPolicy *
+chronolog::GroupPlacementPolicy::CreateGroupPlacementPolicy(std::string const &policy_name, uint64_t seed)
+{
+    if(policy_name == "uniform")
+    { return new UniformPlacementPolicy(seed); }
+    else if(policy_name == "least_loaded")
+    { return new LeastLoadedPlacementPolicy(); }
+    else if(policy_name == "power_of_two")
+    { return new PowerOfTwoPlacementPolicy(seed); }
+    else if(policy_name == "weighted_capacity")
+    { return new WeightedCapacityPlacementPolicy(seed); }
+
+    return nullptr;
+}
+
+////////////////////////
+
+size_t chronolog::UniformPlacementPolicy::selectGroup(std::vector <chl::GroupLoad> const &group_loads)
+{
+    return std::uniform_int_distribution <size_t>(0, group_loads.size() - 1)(randomGenerator);
+}
+
+size_t chronolog::LeastLoadedPlacementPolicy::selectGroup(std::vector <chl::GroupLoad> const &group_loads)
+{
+    size_t selected = 0;
+    for(size_t i = 1; i < group_loads.size(); ++i)
+    {
+        if(lessLoaded(group_loads[i], group_loads[selected]))
+        { selected = i; }
+    }
+    return selected;
+}
+
+size_t chronolog::PowerOfTwoPlacementPolicy::selectGroup(std::vector <chl::GroupLoad> const &group_loads)
+{
+    if(group_loads.size() == 1)
+    { return 0; }
+
+    // two distinct groups
+    size_t first = std::uniform_int_distribution <size_t>(0, group_loads.size() - 1)(randomGenerator);
+    size_t second = std::uniform_int_distribution <size_t>(0, group_loads.size() - 2)(randomGenerator);
+    if(second >= first)
+    { second++; }
+
+    return (lessLoaded(group_loads[second], group_loads[first]) ? second : first);
+}
+
+size_t chronolog::WeightedCapacityPlacementPolicy::selectGroup(std::vector <chl::GroupLoad> const &group_loads)
+{
+    std::vector <double> weights;
+    weights.reserve(group_loads.size());
+    for(auto const &group_load: group_loads)
+    { weights.push_back(group_load.capacity == 0 ? 1 : group_load.capacity); }
+
+    return std::discrete_distribution <size_t>(weights.begin(), weights.end())(randomGenerator);
+}
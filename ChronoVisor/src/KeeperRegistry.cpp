@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include <thallium.hpp>
@@ -7,6 +8,13 @@
 #include "DataStoreAdminClient.h"
 #include "chrono_monitor.h"
 #include "ConfigurationManager.h"
+
+// minimal interval between the story migrations, long enough for the recording processes
+// to report the group loads that reflect the previous migration
+#define STORY_MIGRATION_INTERVAL_SECS 30
+// the story restored by the metadata store stops being recorded if no client acquires it again within this time
+// after the Visor restart, long enough for the clients to reconnect
+#define RESTORED_STORY_CLAIM_GRACE_SECS 300
 /////////////////////////
 
 namespace tl = thallium;
@@ -15,7 +23,7 @@ namespace chl = chronolog;
 namespace chronolog
 {
 
-int KeeperRegistry::InitializeRegistryService(VisorConfiguration const & VISOR_CONF)
+int KeeperRegistry::InitializeRegistryService(VisorConfiguration const & VISOR_CONF, VisorMetadataStore* metadata_store)
 {
     int status = chronolog::CL_ERR_UNKNOWN;
     std::lock_guard <std::mutex> lock(registryLock);
@@ -23,6 +31,10 @@ int KeeperRegistry::InitializeRegistryService(VisorConfiguration const & VISOR_C
     if(registryState != UNKNOWN)
     { return chronolog::CL_SUCCESS; }
 
+    metadataStore = metadata_store;
+    if(metadataStore != nullptr)
+    { restoreStoryRecordings(*metadataStore); }
+
     try
     {
         // initialise thalium engine for KeeperRegistryService
@@ -51,6 +63,19 @@ int KeeperRegistry::InitializeRegistryService(VisorConfiguration const & VISOR_C
 
         delayedDataAdminExitSeconds = VISOR_CONF.DELAYED_DATA_ADMIN_EXIT_IN_SECS;
 
+        // the adminClient of the unregistered process has to outlive the story notifications still waiting on it:
+        // the start notification and the rollback stop that may follow it both run on the adminClients
+        // collected before the start, so the two timeouts together have to fit in the delayed exit
+        notificationTimeout = std::chrono::milliseconds(VISOR_CONF.STORY_NOTIFICATION_TIMEOUT_MSEC);
+        std::chrono::milliseconds max_notification_timeout =
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(delayedDataAdminExitSeconds)) / 2;
+        if(notificationTimeout > max_notification_timeout)
+        {
+            LOG_WARNING("[ChronoProcessRegistry] story notification timeout {} msec is capped at half of delayed_data_admin_exit_in_secs {}"
+                        , notificationTimeout.count(), delayedDataAdminExitSeconds);
+            notificationTimeout = max_notification_timeout;
+        }
+
         // Kun: This protocol will be used to create dataStoreAdminClient for both Keeper and Grapher.
         // Since they share the same Thallium engine, we have to use the same protocol for both.
         // This is a temporary solution until we have a better way to handle this.
@@ -59,6 +84,24 @@ int KeeperRegistry::InitializeRegistryService(VisorConfiguration const & VISOR_C
         //  ends (Keeper, Grapher, and Visor) use the same protocol.
         //dataStoreAdminServiceProtocol = KEEPER_CONF.DATA_STORE_ADMIN_SERVICE_CONF.PROTO_CONF;
 
+        size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
+        GroupPlacementPolicy* configured_policy =
+                GroupPlacementPolicy::CreateGroupPlacementPolicy(VISOR_CONF.GROUP_PLACEMENT_POLICY, new_seed);
+        if(configured_policy != nullptr)
+        {
+            delete placementPolicy;
+            placementPolicy = configured_policy;
+        }
+        else
+        {
+            LOG_WARNING("[ChronoProcessRegistry] Unknown group placement policy {}, using {}"
+                        , VISOR_CONF.GROUP_PLACEMENT_POLICY, placementPolicy->getName());
+        }
+        LOG_INFO("[ChronoProcessRegistry] RecordingGroup placement policy: {}", placementPolicy->getName());
+
+        storyRebalancingRatio = VISOR_CONF.STORY_REBALANCING_RATIO_PERCENT / 100.0;
+        LOG_INFO("[ChronoProcessRegistry] Story rebalancing ratio: {}", storyRebalancingRatio);
+
         registryState = INITIALIZED;
         status = chronolog::CL_SUCCESS;
     }
@@ -76,13 +119,79 @@ KeeperRegistry::KeeperRegistry()
     , registryEngine(nullptr)
     , keeperRegistryService(nullptr)
     , delayedDataAdminExitSeconds(3)
+    , notificationTimeout(1500)
+    , placementPolicy(nullptr)
+    , storyRebalancingRatio(0)
+    , lastStoryMigrationTime(0)
+    , metadataStore(nullptr)
 {
-    // INNA: I'm using current time for seeding Mersene Twister number generator
-    // there are different opinions on the use of std::random_device for seeding of Mersene Twister..
-    // TODO: reseach the seeding of Mersense Twister int number generator
+    // stories are placed on the RecordingGroups by the placement policy;
+    // power_of_two is used until the configured policy is created in InitializeRegistryService(),
+    // the current time seeds the random sampling of the candidate groups
 
     size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
-    mt_random.seed(new_seed);//initial seed for the 32 int Mersene Twister generator
+    placementPolicy = GroupPlacementPolicy::CreateGroupPlacementPolicy("power_of_two", new_seed);
+}
+
+/////////////////
+
+void KeeperRegistry::restoreStoryRecordings(VisorMetadataStore const& metadata_store)
+{
+    // the groups come back empty and are activated as their processes re-register,
+    // the stories stay assigned to them so the re-registered processes carry on recording the stories
+    // until the clients acquire them again or the claim grace period runs out
+    std::time_t restore_time =
+            std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
+    for(auto const& [story_id, recording]: metadata_store.getStoryRecordings())
+    {
+        if(recording.shardGroups.empty())
+        { continue; }
+
+        std::vector<RecordingGroup*> shard_groups;
+        for(RecordingGroupId group_id: recording.shardGroups)
+        {
+            auto group_iter = recordingGroups.try_emplace(group_id, RecordingGroup(group_id)).first;
+            shard_groups.push_back(&((*group_iter).second));
+            shard_groups.back()->assignedStoryCount++;
+        }
+
+        activeStories[story_id] = shard_groups.front();
+        activeStoryNames[story_id] = std::pair<ChronicleName, StoryName>(recording.chronicleName, recording.storyName);
+        if(shard_groups.size() > 1)
+        { storyShards[story_id] = shard_groups; }
+        unclaimedRestoredStories[story_id] = restore_time;
+    }
+    LOG_INFO("[ChronoProcessRegistry] Restored {} active stories on {} RecordingGroups", activeStories.size()
+             , recordingGroups.size());
+}
+
+void KeeperRegistry::logStoryRecordingGroups(StoryId const& story_id)
+{
+    if(metadataStore == nullptr)
+    { return; }
+
+    StoryRecordingRecord recording;
+    recording.storyId = story_id;
+    auto names_iter = activeStoryNames.find(story_id);
+    if(names_iter != activeStoryNames.end())
+    {
+        recording.chronicleName = (*names_iter).second.first;
+        recording.storyName = (*names_iter).second.second;
+    }
+    auto shards_iter = storyShards.find(story_id);
+    if(shards_iter != storyShards.end())
+    {
+        for(auto const* recording_group: (*shards_iter).second)
+        { recording.shardGroups.push_back(recording_group->groupId); }
+    }
+    else
+    {
+        auto story_iter = activeStories.find(story_id);
+        if(story_iter == activeStories.end() || (*story_iter).second == nullptr)
+        { return; }
+        recording.shardGroups.push_back((*story_iter).second->groupId);
+    }
+    metadataStore->logStoryRecordingStarted(recording);
 }
 
 /////////////////
@@ -104,6 +213,8 @@ int KeeperRegistry::ShutdownRegistryService()
 
     activeGroups.clear();
     activeStories.clear();
+    storyShards.clear();
+    unclaimedRestoredStories.clear();
 
     while(!recordingGroups.empty())
     {
@@ -206,6 +317,7 @@ KeeperRegistry::~KeeperRegistry()
     ShutdownRegistryService();
     registryEngine->finalize();
     delete registryEngine;
+    delete placementPolicy;
 }
 /////////////////
 
@@ -245,6 +357,16 @@ int KeeperRegistry::registerKeeperProcess(KeeperRegistrationMsg const &keeper_re
     // running on the same host... check for this case and clean up the leftover record...
     auto keeper_process_iter = recording_group.keeperProcesses.find(keeper_id_card.getRecordingServiceId().get_service_endpoint());
 
+    // the running keeper refreshing its registration keeps its entry and DataStoreAdminClient,
+    // the refresh is what re-registers the keeper with the Visor restarted from its metadata store
+    if(keeper_process_iter != recording_group.keeperProcesses.end() && (*keeper_process_iter).second.active
+       && (*keeper_process_iter).second.idCard == keeper_id_card
+       && (*keeper_process_iter).second.adminServiceId == admin_service_id)
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Keeper {} refreshed its registration", to_string(keeper_id_card));
+        return chronolog::CL_SUCCESS;
+    }
+
     if(keeper_process_iter != recording_group.keeperProcesses.end())
     {
         // must be a case of the KeeperProcess exiting without unregistering or some unexpected break in communication...
@@ -323,10 +445,6 @@ int KeeperRegistry::registerKeeperProcess(KeeperRegistrationMsg const &keeper_re
     if(recording_group.isActive() && recording_group.activeKeeperCount == 1)
     {
         activeGroups.push_back(&recording_group);
-        size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
-        mt_random.seed(new_seed);//re-seed the mersene_twister_generator
-        group_id_distribution =
-                std::uniform_int_distribution<size_t>(0, activeGroups.size() - 1);//reset the distribution range
     }
 
     LOG_INFO("[ChronoProcessRegistry]  has {} activeGroups; {} RecordingGroups ", activeGroups.size(), recordingGroups.size());
@@ -364,13 +482,6 @@ int KeeperRegistry::unregisterKeeperProcess(KeeperIdCard const &keeper_id_card)
         if(recording_group.isActive() && (*keeper_process_iter).second.active && recording_group.activeKeeperCount == 1)
         {
             activeGroups.erase(std::remove(activeGroups.begin(), activeGroups.end(), &recording_group));
-            if(activeGroups.size() > 0)
-            {//reset the group distribution
-                size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
-                mt_random.seed(new_seed);//re-seed the mersene_twister_generator
-                group_id_distribution =
-                    std::uniform_int_distribution<size_t>(0, activeGroups.size() - 1);//reset the distribution range
-            }
         }
 
         // we mark the keeperProcessEntry as inactive and set the time it would be safe to delete.
@@ -397,16 +508,21 @@ int KeeperRegistry::unregisterKeeperProcess(KeeperIdCard const &keeper_id_card)
 
 void KeeperRegistry::updateKeeperProcessStats(KeeperStatsMsg const &keeperStatsMsg)
 {
-    // NOTE: we don't lock registryLock while updating the keeperProcess stats
-    // delayed destruction of keeperProcessEntry protects us from the case when
-    // stats message is received from the KeeperProcess that has unregistered
-    // on the other thread
+    // NOTE: the keeperProcess stats are read by the story placement under registryLock
+    // so we hold the lock while updating them
     if(is_shutting_down())
     { return; }
 
     KeeperIdCard keeper_id_card = keeperStatsMsg.getKeeperIdCard();
 
-    LOG_DEBUG("[ChronoProcessRegistry] Received KeeperStatsMsg from {}", chl::to_string(keeper_id_card));
+    LOG_DEBUG("[ChronoProcessRegistry] Received {}", chl::to_string(keeperStatsMsg));
+    if(!keeperStatsMsg.getMetricsRollup().empty())
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Keeper {} metrics {}", chl::to_string(keeper_id_card)
+                  , chl::to_string(keeperStatsMsg.getMetricsRollup()));
+    }
+
+    std::lock_guard<std::mutex> lock(registryLock);
 
     auto group_iter = recordingGroups.find(keeper_id_card.getGroupId());
     if(group_iter == recordingGroups.end()) { return; }
@@ -418,9 +534,11 @@ void KeeperRegistry::updateKeeperProcessStats(KeeperStatsMsg const &keeperStatsM
         // we should probably log a warning here...
         return;
     }
-    KeeperProcessEntry keeper_process = (*keeper_process_iter).second;
+    KeeperProcessEntry & keeper_process = (*keeper_process_iter).second;
     keeper_process.lastStatsTime = std::chrono::steady_clock::now().time_since_epoch().count();
     keeper_process.activeStoryCount = keeperStatsMsg.getActiveStoryCount();
+    keeper_process.loadStats = keeperStatsMsg.getLoadStats();
+    keeper_process.hotStories = keeperStatsMsg.getHotStories();
 }
 /////////////////
 
@@ -482,13 +600,15 @@ std::vector<KeeperIdCard>& RecordingGroup::getActiveKeepers(std::vector<KeeperId
 }
 /////////////////
 int KeeperRegistry::notifyRecordingGroupOfStoryRecordingStart(ChronicleName const& chronicle, StoryName const &story
-                                                              , StoryId const &story_id
+                                                              , StoryId const &story_id, ClientId const &client_id
+                                                              , uint32_t shard_count
+                                                              , StoryAdmissionLimits const &admission_limits
                                                               , std::vector <KeeperIdCard> &vectorOfKeepers
                                 , ServiceId & player_service_id)
 {
     vectorOfKeepers.clear();
 
-    RecordingGroup* recording_group = nullptr;
+    std::vector<RecordingGroup*> shard_groups;
 
     {
         //lock KeeperRegistry and choose the recording group for this story
@@ -510,8 +630,15 @@ int KeeperRegistry::notifyRecordingGroupOfStoryRecordingStart(ChronicleName cons
             //INNA:TODO: we should probably check if the group's active status hasn't changed
             //and implement group re-assignment procedure when we have recording processes dynamically coming and going..
 
-            recording_group = (*story_iter).second;
+            RecordingGroup* recording_group = (*story_iter).second;
+            auto shards_iter = storyShards.find(story_id);
+            if(shards_iter != storyShards.end())
+            {
+                // the writer clients of the sharded story are spread over the shards by their ClientId
+                recording_group = (*shards_iter).second[client_id % (*shards_iter).second.size()];
+            }
             recording_group->getActiveKeepers(vectorOfKeepers); 
+            unclaimedRestoredStories.erase(story_id);
     
             //no need for notification , group processes are already recording this story
             LOG_DEBUG("[ChronoProcessRegistry] RecordingGroup {} is already recording story {}", recording_group->groupId,story_id);
@@ -519,338 +646,867 @@ int KeeperRegistry::notifyRecordingGroupOfStoryRecordingStart(ChronicleName cons
             return chronolog::CL_SUCCESS;
         }
 
-        // select recording_group from the group id distribution using a random int value
-        // generated by Mirsene Twister generator
-        // NOTE: using uniform_distribution for now, we might add discrete distribution with weights later...
+        shard_groups = placeStory(chronicle, story, story_id, shard_count, admission_limits);
+    }
 
-        recording_group = activeGroups[group_id_distribution(mt_random)];
-        activeStories[story_id] = recording_group;
+    for(size_t shard_index = 0; shard_index < shard_groups.size(); ++shard_index)
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] {} policy selected RecordingGroup {} for story {} shard {}"
+                  , placementPolicy->getName(), shard_groups[shard_index]->groupId, story_id, shard_index);
     }
 
-    LOG_DEBUG("[ChronoProcessRegistry] selected RecordingGroup {} for story {}", recording_group->groupId, story_id);
-    
     uint64_t story_start_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
 
     // the registryLock is released by this point..
-    // notify Grapher and notifyKeepers functions use delayedExit logic to protect
+    // the notification uses delayedExit logic to protect
     // the rpc code from DataAdminClients being destroyed while notification is in progress..
-    int rpc_return = notifyGrapherOfStoryRecordingStart(*recording_group, chronicle, story, story_id, story_start_time);
-    
-    if( rpc_return != chronolog::CL_SUCCESS)
+    std::vector<std::vector<KeeperIdCard>> shard_keepers;
+    int rpc_return = notifyGroupsOfStoryRecordingStart(shard_groups, chronicle, story, story_id, story_start_time
+                                                       , admission_limits, shard_keepers);
+    if(rpc_return != chronolog::CL_SUCCESS)
     {
-        LOG_WARNING("[ChronoProcessRegistry]  RecordingGroup {} failed to notify Grapher of Story {} Start : err_code {}", recording_group->groupId, story_id, rpc_return);
+        // the processes that did start the story have been told to stop, forget the story placement
+        std::lock_guard<std::mutex> lock(registryLock);
+        auto story_iter = activeStories.find(story_id);
+        if(story_iter != activeStories.end() && (*story_iter).second == shard_groups.front())
+        { removeActiveStory(story_id); }
         return rpc_return;
     }
+    vectorOfKeepers = shard_keepers[client_id % shard_groups.size()];
 
-    LOG_DEBUG("[ChronoProcessRegistry]  RecordingGroup {}  notified Grapher  of Story {} Start", recording_group->groupId, story_id);
+    // the playback of the sharded story goes through the player of shard 0,
+    // the archived partial chunks of the other shards are merged on replay
+    RecordingGroup* recording_group = shard_groups.front();
+    if(recording_group->playerProcess != nullptr)
+    {
+        player_service_id = recording_group->playerProcess->idCard.getPlaybackServiceId();
+    }
+
+    LOG_INFO("[ChronoProcessRegistry]  RecordingGroup {}  notified  of story {} Start : {} shards, client group has {} keepers and player {}", 
+        recording_group->groupId, story_id, shard_groups.size(), vectorOfKeepers.size(), chl::to_string(player_service_id));
+    return rpc_return;
+}
 
-    recording_group->getActiveKeepers(vectorOfKeepers);
-    rpc_return = notifyKeepersOfStoryRecordingStart(*recording_group, vectorOfKeepers, chronicle, story, story_id,
-                                                        story_start_time);
-    if( rpc_return != chronolog::CL_SUCCESS)
+////////////////
+std::vector<RecordingGroup*> KeeperRegistry::placeStory(ChronicleName const& chronicle, StoryName const& story
+                                                        , StoryId const& story_id, uint32_t shard_count
+                                                        , StoryAdmissionLimits const& admission_limits)
+{
+    // let the placement policy select the recording_group based on the current load of the active groups,
+    // each shard of the sharded story goes to a different group
+    std::vector<RecordingGroup*> shard_groups;
+    std::vector<GroupLoad> group_loads;
+    std::vector<RecordingGroup*> candidate_groups(activeGroups.begin(), activeGroups.end());
+    group_loads.reserve(activeGroups.size());
+    for(auto const* active_group: activeGroups)
+    { group_loads.push_back(active_group->getGroupLoad()); }
+
+    shard_count = std::min<size_t>(std::max<uint32_t>(shard_count, 1), activeGroups.size());
+    while(shard_groups.size() < shard_count)
     {
-        LOG_WARNING("[ChronoProcessRegistry]  RecordingGroup {} failed to notify Keepers of Story {} Start : err_code {}", 
-            recording_group->groupId, story_id, rpc_return);
-        vectorOfKeepers.clear();
-        return rpc_return;
+        size_t selected = placementPolicy->selectGroup(group_loads);
+        shard_groups.push_back(candidate_groups[selected]);
+        shard_groups.back()->assignedStoryCount++;
+        candidate_groups.erase(candidate_groups.begin() + selected);
+        group_loads.erase(group_loads.begin() + selected);
     }
 
-    LOG_DEBUG("[ChronoProcessRegistry]  RecordingGroup {}  notified  Keepers of story {} Start", recording_group->groupId, story_id);
+    activeStories[story_id] = shard_groups.front();
+    activeStoryNames[story_id] = std::pair<ChronicleName, StoryName>(chronicle, story);
+    if(!admission_limits.isUnlimited())
+    { storyAdmissionLimits[story_id] = admission_limits; }
+    if(shard_groups.size() > 1)
+    { storyShards[story_id] = shard_groups; }
+    logStoryRecordingGroups(story_id);
 
-    if(recording_group->playerProcess != nullptr)
+    return shard_groups;
+}
+
+////////////////
+std::vector<KeeperRegistry::ProcessNotification*> KeeperRegistry::GroupNotification::processes()
+{
+    std::vector<ProcessNotification*> group_processes;
+    for(auto& keeper: keepers)
+    { group_processes.push_back(&keeper); }
+    group_processes.push_back(&grapher);
+    group_processes.push_back(&player);
+    return group_processes;
+}
+
+////////////////
+KeeperRegistry::GroupNotification KeeperRegistry::collectGroupNotification(RecordingGroup& recording_group)
+{
+    GroupNotification group_notification;
+
+    // NOTE: we release the registryLock before sending rpc requests so that we do not hold it for the duration of rpc communication.
+    // We delay the destruction of unactive adminClients that might be triggered by the unregister call from a different thread
+    // to protect us from the unfortunate case of adminClient object being deleted while this thread is waiting for rpc response
+    std::lock_guard<std::mutex> lock(registryLock);
+
+    if(recording_group.grapherProcess != nullptr && recording_group.grapherProcess->active)
     {
-        player_service_id = recording_group->playerProcess->idCard.getPlaybackServiceId();
+        group_notification.grapher.processIdString = recording_group.grapherProcess->idCardString;
+        group_notification.grapher.adminClient = recording_group.grapherProcess->adminClient;
+    }
+    else
+    {
+        LOG_WARNING("[ChronoProcessRegistry] grapher for recordingGroup {} is not available for notification",
+                    recording_group.groupId);
     }
 
-    LOG_INFO("[ChronoProcessRegistry]  RecordingGroup {}  notified  of story {} Start : group has {} keepers and player {}", 
-        recording_group->groupId, story_id, vectorOfKeepers.size(), chl::to_string(player_service_id));
-    return rpc_return;
+    if(recording_group.playerProcess != nullptr && recording_group.playerProcess->active)
+    {
+        group_notification.player.processIdString = recording_group.playerProcess->idCardString;
+        group_notification.player.adminClient = recording_group.playerProcess->adminClient;
+    }
+
+    for(auto const& keeper_process: recording_group.keeperProcesses)
+    {
+        if(!keeper_process.second.active || keeper_process.second.keeperAdminClient == nullptr)
+        { continue; }
+
+        ProcessNotification keeper_notification;
+        keeper_notification.processIdString = keeper_process.second.idCardString;
+        keeper_notification.adminClient = keeper_process.second.keeperAdminClient;
+        keeper_notification.isKeeper = true;
+        keeper_notification.keeperIdCard = keeper_process.second.idCard;
+        group_notification.keepers.push_back(keeper_notification);
+    }
+
+    return group_notification;
 }
 
 ////////////////
-int KeeperRegistry::notifyGrapherOfStoryRecordingStart(RecordingGroup &recordingGroup, ChronicleName const &chronicle
-                                                       , StoryName const &story, StoryId const &storyId
-                                                       , uint64_t story_start_time)
+int KeeperRegistry::notifyGroupsOfStoryRecordingStart(std::vector<RecordingGroup*> const& shard_groups
+                                                      , ChronicleName const& chronicle, StoryName const& story
+                                                      , StoryId const& story_id, uint64_t story_start_time
+                                                      , StoryAdmissionLimits const& admission_limits
+                                                      , std::vector<std::vector<KeeperIdCard>>& group_keepers)
 {
-    int return_code = chronolog::CL_ERR_UNKNOWN;
+    group_keepers.assign(shard_groups.size(), std::vector<KeeperIdCard>());
 
     if(!is_running())
     {
-        LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", storyId);
-        return chronolog::CL_ERR_UNKNOWN;
+        LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", story_id);
+        return chronolog::CL_ERR_NO_KEEPERS;
     }
 
-    DataStoreAdminClient* dataAdminClient = nullptr;
+    std::vector<GroupNotification> notifications;
+    notifications.reserve(shard_groups.size());
+    for(auto* recording_group: shard_groups)
+    { notifications.push_back(collectGroupNotification(*recording_group)); }
 
+    // all the rpcs are issued before any of them is joined;
+    // only the Grapher gets the shard index, the Player and Keepers of the shard group record the story as is
+    for(uint32_t shard_index = 0; shard_index < notifications.size(); ++shard_index)
     {
-        // NOTE: we release the registryLock before sending rpc request so that we do not hold it for the duration of rpc communication.
-        // We delay the destruction of unactive adminClients that might be triggered by the unregister call from a different thread
-        //  to protect us from the unfortunate case of aminClient object being deleted
-        // while this thread is waiting for rpc response
-        std::lock_guard<std::mutex> lock(registryLock);
-
-        if(recordingGroup.grapherProcess != nullptr && recordingGroup.grapherProcess->active &&
-           recordingGroup.grapherProcess->adminClient != nullptr)
+        for(ProcessNotification* process: notifications[shard_index].processes())
         {
-            dataAdminClient = recordingGroup.grapherProcess->adminClient;
+            if(process->adminClient == nullptr)
+            { continue; }
+            uint32_t process_shard_index = (process == &notifications[shard_index].grapher ? shard_index : 0);
+            process->pendingResponse = process->adminClient->async_start_story_recording(
+                    chronicle, story, story_id, story_start_time, process_shard_index
+                    , (process->isKeeper ? admission_limits : StoryAdmissionLimits()), notificationTimeout);
         }
-        else
+    }
+
+    for(auto& group_notification: notifications)
+    {
+        for(ProcessNotification* process: group_notification.processes())
         {
-            LOG_WARNING("[ChronoProcessRegistry] grapher for recordingGroup {} is not available for notification",
-                        recordingGroup.groupId);
+            if(process->adminClient == nullptr)
+            { continue; }
+            process->returnCode = DataStoreAdminClient::wait_for_notification(process->pendingResponse);
+            process->pendingResponse = nullptr;
         }
     }
 
-    if(dataAdminClient == nullptr) { return return_code; }
-
-    try
+    // the story is started if the Grapher and at least one Keeper of every shard group are recording it;
+    // failure to notify the Player is not fatal as the story events will still be available from the archive
+    bool story_started = true;
+    for(size_t shard_index = 0; shard_index < notifications.size(); ++shard_index)
     {
-        return_code = dataAdminClient->send_start_story_recording(chronicle, story, storyId, story_start_time);
-        if(return_code != chronolog::CL_SUCCESS)
+        GroupNotification& group_notification = notifications[shard_index];
+        RecordingGroupId group_id = shard_groups[shard_index]->groupId;
+
+        if(group_notification.grapher.returnCode != chronolog::CL_SUCCESS)
         {
-            LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to {}", recordingGroup.grapherProcess->idCardString);
+            LOG_WARNING("[ChronoProcessRegistry] RecordingGroup {} failed to notify Grapher of Story {} Start", group_id
+                        , story_id);
+            story_started = false;
         }
-        else
+        if(group_notification.player.adminClient != nullptr && group_notification.player.returnCode != chronolog::CL_SUCCESS)
         {
-            LOG_INFO("[ChronoProcessRegistry] Registry notified {} to start recording StoryID={} with StartTime={}",
-                     recordingGroup.grapherProcess->idCardString, storyId, story_start_time);
+            LOG_WARNING("[ChronoProcessRegistry] RecordingGroup {} failed to notify Player of Story {} Start", group_id
+                        , story_id);
+        }
+        for(auto const& keeper: group_notification.keepers)
+        {
+            if(keeper.returnCode == chronolog::CL_SUCCESS)
+            {
+                LOG_INFO("[ChronoProcessRegistry] Registry notified {} to start recording StoryID={} with StartTime={}",
+                         keeper.processIdString, story_id, story_start_time);
+                group_keepers[shard_index].push_back(keeper.keeperIdCard);
+            }
+            else
+            {
+                LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to keeper {}", keeper.processIdString);
+            }
+        }
+        if(group_keepers[shard_index].empty())
+        {
+            LOG_ERROR("[ChronoProcessRegistry] RecordingGroup {} failed to notify keepers to start recording story {}"
+                      , group_id, story_id);
+            story_started = false;
         }
     }
-    catch(thallium::exception const& ex)
+
+    if(story_started)
+    { return chronolog::CL_SUCCESS; }
+
+    // rollback: every process that has started recording the story is told to stop
+    std::vector<ProcessNotification*> started_processes;
+    for(auto& group_notification: notifications)
     {
-        LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to grapher {}", recordingGroup.grapherProcess->idCardString);
+        for(ProcessNotification* process: group_notification.processes())
+        {
+            if(process->returnCode == chronolog::CL_SUCCESS)
+            { started_processes.push_back(process); }
+        }
     }
+    LOG_WARNING("[ChronoProcessRegistry] Story {} failed to start on {} groups, stopping it on {} processes", story_id
+                , shard_groups.size(), started_processes.size());
+    stopProcessNotifications(started_processes, story_id, false);
 
-    return return_code;
+    group_keepers.assign(shard_groups.size(), std::vector<KeeperIdCard>());
+    return chronolog::CL_ERR_NO_KEEPERS;
 }
 
-///////////////
-int KeeperRegistry::notifyGrapherOfStoryRecordingStop(RecordingGroup& recordingGroup, StoryId const& storyId)
+////////////////
+void KeeperRegistry::notifyGroupsOfStoryRecordingStop(std::vector<RecordingGroup*> const& recording_groups
+                                                      , StoryId const& story_id, bool story_migrated)
 {
-    int return_code = chronolog::CL_ERR_UNKNOWN;
-
-    if(!is_running())
+    std::vector<GroupNotification> notifications;
+    notifications.reserve(recording_groups.size());
+    std::vector<ProcessNotification*> group_processes;
+    for(auto* recording_group: recording_groups)
     {
-        LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", storyId);
-        return chronolog::CL_ERR_NO_KEEPERS;
+        notifications.push_back(collectGroupNotification(*recording_group));
+        for(ProcessNotification* process: notifications.back().processes())
+        { group_processes.push_back(process); }
     }
 
-    DataStoreAdminClient* dataAdminClient = nullptr;
-
-    std::stringstream id_string;
+    stopProcessNotifications(group_processes, story_id, story_migrated);
+}
 
+////////////////
+void KeeperRegistry::stopProcessNotifications(std::vector<ProcessNotification*> const& processes
+                                              , StoryId const& story_id, bool story_migrated)
+{
+    // the keepers of the migrated story redirect the clients still sending its events to the new group
+    for(ProcessNotification* process: processes)
     {
-        // NOTE: we release the registryLock before sending rpc request so that we do not hold it for the duration of rpc communication.
-        // We delay the destruction of unactive adminClients that might be triggered by the unregister call from a different thread
-        //  to protect us from the unfortunate case of aminClient object being deleted
-        // while this thread is waiting for rpc response
-        std::lock_guard<std::mutex> lock(registryLock);
+        if(process->adminClient == nullptr)
+        { continue; }
+        process->pendingResponse = process->adminClient->async_stop_story_recording(
+                story_id, (story_migrated && process->isKeeper), notificationTimeout);
+    }
 
-        if(recordingGroup.grapherProcess != nullptr && recordingGroup.grapherProcess->active &&
-           recordingGroup.grapherProcess->adminClient != nullptr)
+    for(ProcessNotification* process: processes)
+    {
+        if(process->adminClient == nullptr)
+        { continue; }
+        process->returnCode = DataStoreAdminClient::wait_for_notification(process->pendingResponse);
+        process->pendingResponse = nullptr;
+        if(process->returnCode != chronolog::CL_SUCCESS)
         {
-            id_string << recordingGroup.grapherProcess->idCard;
-            dataAdminClient = recordingGroup.grapherProcess->adminClient;
+            LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to {}", process->processIdString);
         }
         else
         {
-            LOG_WARNING("[ChronoProcessRegistry] grapher for recordingGroup {} is not available for notification",
-                        recordingGroup.groupId);
+            LOG_INFO("[ChronoProcessRegistry] Registry notified {} to stop recording story {}{}", process->processIdString
+                     , story_id, ((story_migrated && process->isKeeper) ? " (migrated)" : ""));
         }
     }
+}
 
-    if(dataAdminClient == nullptr) { return return_code; }
+////////////////
+std::vector<RecordingGroup*> KeeperRegistry::removeActiveStory(StoryId const& story_id)
+{
+    std::vector<RecordingGroup*> shard_groups;
 
-    try
+    auto story_iter = activeStories.find(story_id);
+    if(story_iter == activeStories.end())
+    { return shard_groups; }
+
+    auto shards_iter = storyShards.find(story_id);
+    if(shards_iter != storyShards.end())
     {
-        return_code = dataAdminClient->send_stop_story_recording(storyId);
-        if(return_code != chronolog::CL_SUCCESS)
-        {
-            LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to grapher {}", id_string.str());
-        }
-        else
-        {
-            LOG_INFO("[ChronoProcessRegistry] Registry notified grapher {} to stop recording StoryID={} ", id_string.str(),
-                     storyId);
-        }
+        shard_groups = (*shards_iter).second;
+        storyShards.erase(shards_iter);
     }
-    catch(thallium::exception const& ex)
+    else if((*story_iter).second != nullptr)
+    {
+        shard_groups.push_back((*story_iter).second);
+    }
+
+    for(auto* recording_group: shard_groups)
     {
-        LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to grapher {}", id_string.str());
+        if(recording_group->assignedStoryCount > 0) { recording_group->assignedStoryCount--; }
     }
 
-    return return_code;
+    activeStories.erase(story_iter);
+    activeStoryNames.erase(story_id);
+    storyAdmissionLimits.erase(story_id);
+    unclaimedRestoredStories.erase(story_id);
+    if(metadataStore != nullptr)
+    { metadataStore->logStoryRecordingStopped(story_id); }
+
+    return shard_groups;
 }
+
+
+
+
+
 /////////////////////
 
-int KeeperRegistry::notifyKeepersOfStoryRecordingStart(RecordingGroup& recordingGroup
-                                                       , std::vector <KeeperIdCard> &vectorOfKeepers
-                                                       , ChronicleName const &chronicle, StoryName const &story
-                                                       , StoryId const &storyId, uint64_t story_start_time)
+/////////////////
+int KeeperRegistry::notifyRecordingGroupOfStoryRecordingStop(StoryId const& story_id)
 {
+    std::vector<RecordingGroup*> shard_groups;
 
-    // if there are no activeGroups ready for recording
-    // we are out of luck...
-    if(!is_running())
     {
-        LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", storyId);
-        return chronolog::CL_ERR_NO_KEEPERS;
+        //lock KeeperRegistry and choose the recording group for this story
+        //NOTE we only keep the lock within this paragraph...
+        std::lock_guard<std::mutex> lock(registryLock);
+        if(!is_running())
+        {
+            LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", story_id);
+            return chronolog::CL_ERR_NO_KEEPERS;
+        }
+
+        //we don't know of this story if there are no groups recording it
+        shard_groups = removeActiveStory(story_id);
     }
 
-    std::vector<KeeperIdCard> vectorOfKeepersToNotify = vectorOfKeepers;
-    vectorOfKeepers.clear();
+    // the registryLock is released by this point..
+    // the notification uses delayedExit logic to protect
+    // the rpc code from DataAdminClients being destroyed while notification is in progress..
+    if(!shard_groups.empty())
+    { notifyGroupsOfStoryRecordingStop(shard_groups, story_id); }
+
+    return chronolog::CL_SUCCESS;
+}
 
-    auto keeper_processes = recordingGroup.keeperProcesses;
+//////////////
+int KeeperRegistry::expireUnclaimedRestoredStories()
+{
+    std::map<StoryId, std::vector<RecordingGroup*>> expired_stories;
 
-    for(KeeperIdCard keeper_id_card: vectorOfKeepersToNotify)
     {
-        DataStoreAdminClient* dataAdminClient = nullptr;
+        std::lock_guard<std::mutex> lock(registryLock);
+        // the restored stories are only told to stop once the recording processes are back to be notified
+        if(!is_running() || unclaimedRestoredStories.empty())
+        { return chronolog::CL_SUCCESS; }
+
+        std::time_t current_time =
+                std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
+        for(auto story_iter = unclaimedRestoredStories.begin(); story_iter != unclaimedRestoredStories.end();)
         {
-            // NOTE: we release the registryLock before sending rpc request so that we do not hold it for the duration of rpc communication.
-            // We delay the destruction of unactive keeperProcessEntries that might be triggered by the keeper unregister call from a different thread
-            // (see unregisterKeeperProcess()) to protect us from the unfortunate case of keeperProcessEntry.dataAdminClient object being deleted
-            // while this thread is waiting for rpc response
-            std::lock_guard<std::mutex> lock(registryLock);
-            auto keeper_process_iter = keeper_processes.find(keeper_id_card.getRecordingServiceId().get_service_endpoint());
-                    
-            if((keeper_process_iter != keeper_processes.end() && (*keeper_process_iter).second.active) &&
-               ((*keeper_process_iter).second.keeperAdminClient != nullptr))
+            // removeActiveStory erases the story from unclaimedRestoredStories, move past it first
+            StoryId story_id = (*story_iter).first;
+            std::time_t restore_time = (*story_iter).second;
+            ++story_iter;
+            if(current_time >= restore_time + RESTORED_STORY_CLAIM_GRACE_SECS)
             {
-                dataAdminClient = (*keeper_process_iter).second.keeperAdminClient;
+                // releases the groups' assignedStoryCount and logs the recording stop to the metadata store
+                expired_stories[story_id] = removeActiveStory(story_id);
             }
-            else
+        }
+    }
+
+    // the registryLock is released by this point..
+    // the notification uses delayedExit logic to protect
+    // the rpc code from DataAdminClients being destroyed while notification is in progress..
+    for(auto const& [story_id, shard_groups]: expired_stories)
+    {
+        LOG_INFO("[ChronoProcessRegistry] Restored story {} was not acquired within {} secs, stopping its recording"
+                 , story_id, RESTORED_STORY_CLAIM_GRACE_SECS);
+        if(!shard_groups.empty())
+        { notifyGroupsOfStoryRecordingStop(shard_groups, story_id); }
+    }
+    return chronolog::CL_SUCCESS;
+}
+//////////////
+int KeeperRegistry::notifyRecordingGroupsOfStoryRecordingStart(ClientId const& client_id
+                                                               , std::vector<StoryAcquisition>& acquisitions)
+{
+    // the stories each group is notified of, with the index of their acquisition in the batch
+    std::map<RecordingGroupId, std::vector<StoryRecordingStartMsg>> group_stories;
+    std::map<RecordingGroupId, std::vector<size_t>> group_acquisitions;
+    std::map<RecordingGroupId, RecordingGroup*> notified_groups;
+    std::vector<std::vector<RecordingGroup*>> acquisition_groups(acquisitions.size());
+
+    uint64_t story_start_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    {
+        std::lock_guard<std::mutex> lock(registryLock);
+        if(!is_running())
+        {
+            LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording {} stories"
+                      , acquisitions.size());
+            for(auto& acquisition: acquisitions)
+            { acquisition.errorCode = chronolog::CL_ERR_NO_KEEPERS; }
+            return chronolog::CL_ERR_NO_KEEPERS;
+        }
+
+        for(size_t index = 0; index < acquisitions.size(); ++index)
+        {
+            StoryAcquisition& acquisition = acquisitions[index];
+            acquisition.keepers.clear();
+
+            auto story_iter = activeStories.find(acquisition.storyId);
+            if(story_iter != activeStories.end() && (*story_iter).second != nullptr)
             {
-                LOG_WARNING("[ChronoProcessRegistry] Keeper {} is not available for notification", to_string(keeper_id_card));
+                // the story is already being recorded for another client, no need for notification
+                RecordingGroup* recording_group = (*story_iter).second;
+                auto shards_iter = storyShards.find(acquisition.storyId);
+                if(shards_iter != storyShards.end())
+                { recording_group = (*shards_iter).second[client_id % (*shards_iter).second.size()]; }
+                recording_group->getActiveKeepers(acquisition.keepers);
+                unclaimedRestoredStories.erase(acquisition.storyId);
+                acquisition.errorCode = chronolog::CL_SUCCESS;
                 continue;
             }
+
+            acquisition_groups[index] = placeStory(acquisition.chronicleName, acquisition.storyName
+                                                   , acquisition.storyId, acquisition.shardCount
+                                                   , acquisition.admissionLimits);
+            for(uint32_t shard_index = 0; shard_index < acquisition_groups[index].size(); ++shard_index)
+            {
+                RecordingGroup* shard_group = acquisition_groups[index][shard_index];
+                StoryRecordingStartMsg story_start;
+                story_start.chronicleName = acquisition.chronicleName;
+                story_start.storyName = acquisition.storyName;
+                story_start.storyId = acquisition.storyId;
+                story_start.startTime = story_start_time;
+                story_start.shardIndex = shard_index;
+                story_start.admissionLimits = acquisition.admissionLimits;
+                group_stories[shard_group->groupId].push_back(story_start);
+                group_acquisitions[shard_group->groupId].push_back(index);
+                notified_groups[shard_group->groupId] = shard_group;
+            }
         }
+    }
 
-        try
+    // the registryLock is released by this point..
+    // the batched notifications use the same delayedExit logic as the single story ones
+    // to protect the rpc code from DataAdminClients being destroyed while notification is in progress..
+    std::map<RecordingGroupId, GroupNotification> notifications;
+    for(auto const& [group_id, recording_group]: notified_groups)
+    { notifications[group_id] = collectGroupNotification(*recording_group); }
+
+    // all the batches are sent out before any of the responses is joined
+    for(auto& [group_id, group_notification]: notifications)
+    {
+        for(ProcessNotification* process: group_notification.processes())
+        {
+            if(process->adminClient == nullptr)
+            { continue; }
+            process->pendingResponse = process->adminClient->async_start_story_recording_batch(group_stories[group_id]
+                                                                                             , notificationTimeout);
+        }
+    }
+    for(auto& [group_id, group_notification]: notifications)
+    {
+        for(ProcessNotification* process: group_notification.processes())
         {
-            int rpc_return = dataAdminClient->send_start_story_recording(chronicle, story, storyId, story_start_time);
-            if(rpc_return != chronolog::CL_SUCCESS)
+            if(process->adminClient == nullptr)
+            { continue; }
+            process->returnCode = DataStoreAdminClient::wait_for_batch_notification(
+                    process->pendingResponse, group_stories[group_id].size(), process->storyReturnCodes);
+            process->pendingResponse = nullptr;
+            if(process->returnCode != chronolog::CL_SUCCESS)
             {
-                LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to keeper {}", to_string(keeper_id_card));
+                LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to {} of {} stories Start"
+                            , process->processIdString, group_stories[group_id].size());
             }
-            else
+        }
+    }
+
+    // the story is started in the group if the Grapher and at least one Keeper are recording it,
+    // failure to notify the Player is not fatal as the story events will still be available from the archive
+    std::vector<std::map<RecordingGroup*, std::vector<KeeperIdCard>>> acquisition_keepers(acquisitions.size());
+    std::vector<int> acquisition_returns(acquisitions.size(), chronolog::CL_SUCCESS);
+    for(auto& [group_id, group_notification]: notifications)
+    {
+        RecordingGroup* recording_group = notified_groups[group_id];
+        std::vector<size_t> const& indices = group_acquisitions[group_id];
+        for(size_t i = 0; i < indices.size(); ++i)
+        {
+            std::vector<KeeperIdCard>& story_keepers = acquisition_keepers[indices[i]][recording_group];
+            for(auto const& keeper: group_notification.keepers)
             {
-                LOG_INFO("[ChronoProcessRegistry] Registry notified {} to start recording StoryID={} with StartTime={}",
-                         to_string(keeper_id_card), storyId, story_start_time);
-                vectorOfKeepers.push_back(keeper_id_card);
+                if(keeper.returnCode == chronolog::CL_SUCCESS && keeper.storyReturnCodes[i] == chronolog::CL_SUCCESS)
+                { story_keepers.push_back(keeper.keeperIdCard); }
+            }
+
+            if(group_notification.grapher.returnCode != chronolog::CL_SUCCESS)
+            { acquisition_returns[indices[i]] = chronolog::CL_ERR_NO_KEEPERS; }
+            else if(group_notification.grapher.storyReturnCodes[i] != chronolog::CL_SUCCESS)
+            { acquisition_returns[indices[i]] = group_notification.grapher.storyReturnCodes[i]; }
+            else if(story_keepers.empty())
+            {
+                LOG_ERROR("[ChronoProcessRegistry] RecordingGroup {} failed to notify keepers to start recording story {}"
+                          , group_id, group_stories[group_id][i].storyId);
+                acquisition_returns[indices[i]] = chronolog::CL_ERR_NO_KEEPERS;
             }
         }
-        catch(thallium::exception const& ex)
+    }
+
+    // rollback: the stories that failed to start in any of their shard groups
+    // are stopped on every process that has started recording them
+    std::vector<StoryId> failed_story_ids;
+    for(size_t index = 0; index < acquisitions.size(); ++index)
+    {
+        if(!acquisition_groups[index].empty() && acquisition_returns[index] != chronolog::CL_SUCCESS)
+        { failed_story_ids.push_back(acquisitions[index].storyId); }
+    }
+    if(!failed_story_ids.empty())
+    {
+        std::vector<std::pair<ProcessNotification*, std::vector<StoryId>>> process_stops;
+        for(auto& [group_id, group_notification]: notifications)
         {
-            LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to keeper {}", to_string(keeper_id_card));
+            std::vector<size_t> const& indices = group_acquisitions[group_id];
+            for(ProcessNotification* process: group_notification.processes())
+            {
+                if(process->returnCode != chronolog::CL_SUCCESS)
+                { continue; }
+                std::vector<StoryId> stop_ids;
+                for(size_t i = 0; i < indices.size(); ++i)
+                {
+                    if(acquisition_returns[indices[i]] != chronolog::CL_SUCCESS
+                       && process->storyReturnCodes[i] == chronolog::CL_SUCCESS)
+                    { stop_ids.push_back(acquisitions[indices[i]].storyId); }
+                }
+                if(!stop_ids.empty())
+                { process_stops.emplace_back(process, stop_ids); }
+            }
         }
+
+        LOG_WARNING("[ChronoProcessRegistry] {} stories failed to start, stopping them on {} processes"
+                    , failed_story_ids.size(), process_stops.size());
+        for(auto& [process, stop_ids]: process_stops)
+        { process->pendingResponse = process->adminClient->async_stop_story_recording_batch(stop_ids, notificationTimeout); }
+        for(auto& [process, stop_ids]: process_stops)
+        {
+            std::vector<int> stop_returns;
+            if(DataStoreAdminClient::wait_for_batch_notification(process->pendingResponse, stop_ids.size(), stop_returns)
+               != chronolog::CL_SUCCESS)
+            { LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to {}", process->processIdString); }
+            process->pendingResponse = nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(registryLock);
+        for(StoryId const& story_id: failed_story_ids)
+        { removeActiveStory(story_id); }
     }
 
-    if(vectorOfKeepers.empty())
+    size_t started_count = 0;
+    for(size_t index = 0; index < acquisitions.size(); ++index)
     {
-        LOG_ERROR("[ChronoProcessRegistry] Registry failed to notify keepers to start recording story {}", storyId);
-        return chronolog::CL_ERR_NO_KEEPERS;
+        if(acquisition_groups[index].empty())
+        { continue; }
+
+        StoryAcquisition& acquisition = acquisitions[index];
+        acquisition.errorCode = acquisition_returns[index];
+        if(acquisition.errorCode != chronolog::CL_SUCCESS)
+        { continue; }
+
+        RecordingGroup* client_group = acquisition_groups[index][client_id % acquisition_groups[index].size()];
+        acquisition.keepers = acquisition_keepers[index][client_group];
+        if(acquisition_groups[index].front()->playerProcess != nullptr)
+        { acquisition.player = acquisition_groups[index].front()->playerProcess->idCard.getPlaybackServiceId(); }
+        started_count++;
     }
 
+    LOG_INFO("[ChronoProcessRegistry] {} RecordingGroups notified of {} stories Start out of the batch of {}"
+             , group_stories.size(), started_count, acquisitions.size());
     return chronolog::CL_SUCCESS;
 }
-/////////////////
-int KeeperRegistry::notifyRecordingGroupOfStoryRecordingStop(StoryId const& story_id)
-{
-    RecordingGroup* recording_group = nullptr;
 
-    std::vector<KeeperIdCard> vectorOfKeepers;
+
+//////////////
+int KeeperRegistry::notifyRecordingGroupsOfStoryRecordingStop(std::vector<StoryId> const& story_ids)
+{
+    std::map<RecordingGroupId, std::vector<StoryId>> group_stories;
+    std::map<RecordingGroupId, RecordingGroup*> notified_groups;
 
     {
-        //lock KeeperRegistry and choose the recording group for this story
-        //NOTE we only keep the lock within this paragraph...
         std::lock_guard<std::mutex> lock(registryLock);
         if(!is_running())
         {
-            LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to start recording story {}", story_id);
+            LOG_ERROR("[ChronoProcessRegistry] Registry has no active RecordingGroups to stop recording {} stories"
+                      , story_ids.size());
             return chronolog::CL_ERR_NO_KEEPERS;
         }
 
+        for(StoryId const& story_id: story_ids)
+        {
+            for(auto* recording_group: removeActiveStory(story_id))
+            {
+                group_stories[recording_group->groupId].push_back(story_id);
+                notified_groups[recording_group->groupId] = recording_group;
+            }
+        }
+    }
+
+    // all the batches are sent out before any of the responses is joined
+    std::map<RecordingGroupId, GroupNotification> notifications;
+    for(auto const& [group_id, recording_group]: notified_groups)
+    { notifications[group_id] = collectGroupNotification(*recording_group); }
+
+    for(auto& [group_id, group_notification]: notifications)
+    {
+        for(ProcessNotification* process: group_notification.processes())
+        {
+            if(process->adminClient == nullptr)
+            { continue; }
+            process->pendingResponse = process->adminClient->async_stop_story_recording_batch(group_stories[group_id]
+                                                                                            , notificationTimeout);
+        }
+    }
+    for(auto& [group_id, group_notification]: notifications)
+    {
+        for(ProcessNotification* process: group_notification.processes())
+        {
+            if(process->adminClient == nullptr)
+            { continue; }
+            process->returnCode = DataStoreAdminClient::wait_for_batch_notification(
+                    process->pendingResponse, group_stories[group_id].size(), process->storyReturnCodes);
+            process->pendingResponse = nullptr;
+            if(process->returnCode != chronolog::CL_SUCCESS)
+            { LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to {}", process->processIdString); }
+            else
+            {
+                LOG_INFO("[ChronoProcessRegistry] Registry notified {} to stop recording {} stories"
+                         , process->processIdString, group_stories[group_id].size());
+            }
+        }
+    }
+
+    return chronolog::CL_SUCCESS;
+}
+
+
+//////////////
+int KeeperRegistry::getStoryRecordingKeepers(StoryId const& story_id, ClientId const& client_id
+                                             , std::vector<KeeperIdCard>& vectorOfKeepers
+                                             , ServiceId& player_service_id)
+{
+    vectorOfKeepers.clear();
+
+    std::lock_guard<std::mutex> lock(registryLock);
+    if(!is_running())
+    { return chronolog::CL_ERR_NO_KEEPERS; }
+
+    auto story_iter = activeStories.find(story_id);
+    if(story_iter == activeStories.end() || (*story_iter).second == nullptr)
+    { return chronolog::CL_ERR_NOT_EXIST; }
+
+    RecordingGroup* recording_group = (*story_iter).second;
+    auto shards_iter = storyShards.find(story_id);
+    if(shards_iter != storyShards.end())
+    { (*shards_iter).second[client_id % (*shards_iter).second.size()]->getActiveKeepers(vectorOfKeepers); }
+    else
+    { recording_group->getActiveKeepers(vectorOfKeepers); }
+
+    if(recording_group->playerProcess != nullptr && recording_group->playerProcess->active)
+    {
+        player_service_id = recording_group->playerProcess->idCard.getPlaybackServiceId();
+    }
+
+    return (vectorOfKeepers.empty() ? chronolog::CL_ERR_NO_KEEPERS : chronolog::CL_SUCCESS);
+}
+
+//////////////
+int KeeperRegistry::migrateStory(StoryId const& story_id, RecordingGroupId const& target_group_id)
+{
+    RecordingGroup* source_group = nullptr;
+    RecordingGroup* target_group = nullptr;
+    ChronicleName chronicle;
+    StoryName story;
+    StoryAdmissionLimits admission_limits;
+
+    {
+        std::lock_guard<std::mutex> lock(registryLock);
+        if(!is_running())
+        { return chronolog::CL_ERR_NO_KEEPERS; }
 
         auto story_iter = activeStories.find(story_id);
+        auto names_iter = activeStoryNames.find(story_id);
+        if(story_iter == activeStories.end() || (*story_iter).second == nullptr || names_iter == activeStoryNames.end())
+        {
+            LOG_WARNING("[ChronoProcessRegistry] Story {} is not being recorded, nothing to migrate", story_id);
+            return chronolog::CL_ERR_NOT_EXIST;
+        }
 
-        if(story_iter == activeStories.end())
+        // the sharded story is already spread over several groups and stays where it is
+        if(storyShards.find(story_id) != storyShards.end())
         {
-            //we don't know of this story
-            return chronolog::CL_SUCCESS;
+            LOG_WARNING("[ChronoProcessRegistry] Story {} is sharded, it is not migrated", story_id);
+            return chronolog::CL_ERR_INVALID_ARG;
         }
 
-        recording_group = (*story_iter).second;
-        if(recording_group != nullptr) { recording_group->getActiveKeepers(vectorOfKeepers); }
+        auto group_iter = recordingGroups.find(target_group_id);
+        if(group_iter == recordingGroups.end() || !(*group_iter).second.isActive())
+        {
+            LOG_WARNING("[ChronoProcessRegistry] RecordingGroup {} is not active, can't migrate story {}", target_group_id, story_id);
+            return chronolog::CL_ERR_NO_KEEPERS;
+        }
 
-        activeStories.erase(story_iter);
+        source_group = (*story_iter).second;
+        target_group = &((*group_iter).second);
+        if(source_group == target_group)
+        { return chronolog::CL_SUCCESS; }
+
+        chronicle = (*names_iter).second.first;
+        story = (*names_iter).second.second;
+        auto limits_iter = storyAdmissionLimits.find(story_id);
+        if(limits_iter != storyAdmissionLimits.end())
+        { admission_limits = (*limits_iter).second; }
+
+        lastStoryMigrationTime = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
     }
 
-    if(recording_group != nullptr)
+    LOG_INFO("[ChronoProcessRegistry] Migrating story {} from RecordingGroup {} to RecordingGroup {}", story_id
+             , source_group->groupId, target_group->groupId);
+
+    uint64_t story_start_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    // the target group has to be recording the story before any client is given its keepers,
+    // so the story stays assigned to the source group until the target group has started recording it;
+    // the processes of the target group that did start recording it are stopped if the group fails to start it
+    std::vector<std::vector<KeeperIdCard>> target_keepers;
+    int rpc_return = notifyGroupsOfStoryRecordingStart({target_group}, chronicle, story, story_id, story_start_time
+                                                       , admission_limits, target_keepers);
+    if(rpc_return != chronolog::CL_SUCCESS)
     {
-        // the registryLock is released by this point..
-        // notify Grapher and notifyKeepers functions use delayedExit logic to protect
-        // the rpc code from DataAdminClients being destroyed while notification is in progress..
+        // the source group hasn't been told anything, the story simply stays there
+        LOG_WARNING("[ChronoProcessRegistry] RecordingGroup {} failed to start recording story {}, migration cancelled: err_code {}"
+                    , target_group->groupId, story_id, rpc_return);
+        return rpc_return;
+    }
 
-        notifyKeepersOfStoryRecordingStop(*recording_group, vectorOfKeepers, story_id);
-     
-        notifyGrapherOfStoryRecordingStop(*recording_group, story_id);
+    // the story might have been released by its last client while the target group was being notified,
+    // in which case the release has stopped the source group and the target group is stopped here
+    // unless the story has been acquired again and placed on the target group meanwhile
+    bool story_released = false;
+    {
+        std::lock_guard<std::mutex> lock(registryLock);
+        auto story_iter = activeStories.find(story_id);
+        if(story_iter != activeStories.end() && (*story_iter).second == target_group)
+        { return chronolog::CL_SUCCESS; }
+
+        story_released = (story_iter == activeStories.end() || (*story_iter).second != source_group);
+        if(!story_released)
+        {
+            (*story_iter).second = target_group;
+            if(source_group->assignedStoryCount > 0) { source_group->assignedStoryCount--; }
+            target_group->assignedStoryCount++;
+            logStoryRecordingGroups(story_id);
+        }
+    }
+    if(story_released)
+    {
+        LOG_INFO("[ChronoProcessRegistry] Story {} was released during its migration to RecordingGroup {}", story_id
+                 , target_group->groupId);
+        notifyGroupsOfStoryRecordingStop({target_group}, story_id);
+        return chronolog::CL_ERR_NOT_EXIST;
     }
 
+    // the source group keepers keep ingesting the events of the clients that haven't switched yet
+    // and tell these clients to switch, their pipelines drain through the normal decay path
+    notifyGroupsOfStoryRecordingStop({source_group}, story_id, true);
+
+    LOG_INFO("[ChronoProcessRegistry] Story {} migrated to RecordingGroup {} with {} keepers", story_id
+             , target_group->groupId, target_keepers.front().size());
     return chronolog::CL_SUCCESS;
 }
+
 //////////////
-int KeeperRegistry::notifyKeepersOfStoryRecordingStop(RecordingGroup& recordingGroup,
-                                                      std::vector<KeeperIdCard> const& vectorOfKeepers,
-                                                      StoryId const& storyId)
+int KeeperRegistry::rebalanceRecordingGroups()
 {
-    if(!is_running())
+    StoryId story_id = 0;
+    RecordingGroupId target_group_id = 0;
+
     {
-        LOG_ERROR("[ChronoProcessRegistry] Registry has no keepers to notify of story release {}", storyId);
-        return chronolog::CL_ERR_NO_KEEPERS;
-    }
+        std::lock_guard<std::mutex> lock(registryLock);
+        if(!is_running() || storyRebalancingRatio == 0 || activeGroups.size() < 2)
+        { return chronolog::CL_SUCCESS; }
+
+        // the group loads only reflect the previous migration once the next stats messages come in
+        std::time_t current_time =
+                std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
+        if(current_time < lastStoryMigrationTime + STORY_MIGRATION_INTERVAL_SECS)
+        { return chronolog::CL_SUCCESS; }
 
-    auto keeper_processes = recordingGroup.keeperProcesses;
+        std::vector<GroupLoad> group_loads;
+        group_loads.reserve(activeGroups.size());
+        for(auto const* active_group: activeGroups)
+        { group_loads.push_back(active_group->getGroupLoad()); }
 
-    for(KeeperIdCard keeper_id_card: vectorOfKeepers)
-    {
-        DataStoreAdminClient* dataAdminClient = nullptr;
+        size_t source = 0;
+        size_t target = 0;
+        if(!selectRebalancingGroups(group_loads, storyRebalancingRatio, source, target))
+        { return chronolog::CL_SUCCESS; }
+
+        RecordingGroup* source_group = activeGroups[source];
+
+        // the hottest stories of the source group are reported by each of its keepers
+        std::map<StoryId, uint64_t> story_ingestion_rates;
+        for(auto const& keeper_process_pair: source_group->keeperProcesses)
         {
-            // NOTE: we release the registryLock before sending rpc request so that we do not hold it for the duration of rpc communication.
-            // We delay the destruction of unactive keeperProcessEntries that might be triggered by the keeper unregister call from a different thread
-            // (see unregisterKeeperProcess()) to protect us from the unfortunate case of keeperProcessEntry.dataAdminClient object being deleted
-            // while this thread is waiting for rpc response
-            std::lock_guard<std::mutex> lock(registryLock);
-            auto keeper_process_iter = keeper_processes.find(keeper_id_card.getRecordingServiceId().get_service_endpoint());
-            if((keeper_process_iter != keeper_processes.end() && (*keeper_process_iter).second.active) &&
-               ((*keeper_process_iter).second.keeperAdminClient != nullptr))
-            {
-                dataAdminClient = (*keeper_process_iter).second.keeperAdminClient;
-            }
-            else
-            {
-                LOG_WARNING("[ChronoProcessRegistry] Keeper {} is not available for notification", to_string(keeper_id_card));
-                continue;
-            }
+            if(!keeper_process_pair.second.active)
+            { continue; }
+            for(auto const& story_load: keeper_process_pair.second.hotStories)
+            { story_ingestion_rates[story_load.storyId] += story_load.ingestionRate; }
         }
-        try
+
+        std::vector<StoryLoad> candidates;
+        for(auto const& story_rate: story_ingestion_rates)
         {
-            int rpc_return = dataAdminClient->send_stop_story_recording(storyId);
-            if(rpc_return != chronolog::CL_SUCCESS)
-            {
-                LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to keeper {}", to_string(keeper_id_card));
-            }
-            else
-            {
-                LOG_INFO("[ChronoProcessRegistry] Registry notified  {} to stop recording story {}", to_string(keeper_id_card), storyId);
-            }
+            // skip the stories that have been released or moved since the stats were sent, and the sharded stories
+            auto story_iter = activeStories.find(story_rate.first);
+            if(story_iter != activeStories.end() && (*story_iter).second == source_group &&
+               storyShards.find(story_rate.first) == storyShards.end())
+            { candidates.push_back(StoryLoad{story_rate.first, story_rate.second}); }
         }
-        catch(thallium::exception const& ex)
+        if(candidates.empty())
         {
-            LOG_WARNING("[ChronoProcessRegistry] Registry failed RPC notification to keeper {}", to_string(keeper_id_card));
+            // no ingestion reported, the imbalance is in the story count so any story of the group will do
+            for(auto const& story_pair: activeStories)
+            {
+                if(story_pair.second == source_group && storyShards.find(story_pair.first) == storyShards.end())
+                {
+                    candidates.push_back(StoryLoad{story_pair.first, 0});
+                    break;
+                }
+            }
         }
+
+        if(!selectStoryToMigrate(group_loads[source], group_loads[target], candidates, story_id))
+        { return chronolog::CL_SUCCESS; }
+
+        target_group_id = activeGroups[target]->groupId;
+        LOG_INFO("[ChronoProcessRegistry] Rebalancing: RecordingGroup {} load {} , RecordingGroup {} load {}, moving story {}"
+                 , source_group->groupId, group_loads[source].loadScore(), target_group_id
+                 , group_loads[target].loadScore(), story_id);
     }
 
-    return chronolog::CL_SUCCESS;
+    return migrateStory(story_id, target_group_id);
 }
 
 ////////////////////////////
@@ -888,6 +1544,15 @@ int KeeperRegistry::registerGrapherProcess(GrapherRegistrationMsg const & reg_ms
 
     std::stringstream id_string;
     id_string << grapher_id_card;
+    // the running grapher refreshing its registration keeps its entry and DataStoreAdminClient
+    if(recording_group.grapherProcess != nullptr && recording_group.grapherProcess->active
+       && recording_group.grapherProcess->idCard == grapher_id_card
+       && recording_group.grapherProcess->adminServiceId == admin_service_id)
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Grapher {} refreshed its registration", chl::to_string(grapher_id_card));
+        return chronolog::CL_SUCCESS;
+    }
+
     if(recording_group.grapherProcess != nullptr)
     {
         // start delayed destruction for the lingering Adminclient to be safe...
@@ -954,11 +1619,6 @@ int KeeperRegistry::registerGrapherProcess(GrapherRegistrationMsg const & reg_ms
     if(recording_group.isActive())
     {
         activeGroups.push_back(&recording_group);
-        
-        //reset the group distribution
-        size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
-        mt_random.seed(new_seed);//re-seed the mersene_twister_generator
-        group_id_distribution = std::uniform_int_distribution<size_t>(0, activeGroups.size() - 1);
     }
 
     LOG_INFO("[ChronoProcessRegistry]  has {} activeGroups; {} RecordingGroups ", activeGroups.size(), recordingGroups.size());
@@ -1002,14 +1662,6 @@ int KeeperRegistry::unregisterGrapherProcess(GrapherIdCard const& grapher_id_car
             // wait for the new grapher?
             LOG_INFO("[ChronoProcessRegistry] RecordingGroup {} is not active; activeGroups.size{}", recording_group.groupId,activeGroups.size());
             activeGroups.erase(active_group_iter);
-            if(activeGroups.size() > 0)
-            {
-                //reset the group distribution
-                size_t new_seed = std::chrono::high_resolution_clock::to_time_t(std::chrono::high_resolution_clock::now());
-                mt_random.seed(new_seed);//re-seed the mersene_twister_generator
-                group_id_distribution =
-                    std::uniform_int_distribution<size_t>(0, activeGroups.size() - 1);//reset the distribution range
-            }
         }
     }
 
@@ -1044,10 +1696,8 @@ int KeeperRegistry::unregisterGrapherProcess(GrapherIdCard const& grapher_id_car
 
 void chl::KeeperRegistry::updateGrapherProcessStats(chl::GrapherStatsMsg const &statsMsg)
 {
-    // NOTE: we don't lock registryLock while updating the keeperProcess stats
-    // delayed destruction of keeperProcessEntry protects us from the case when
-    // stats message is received from the KeeperProcess that has unregistered
-    // on the other thread
+    // NOTE: the grapherProcess stats are read by the story placement under registryLock
+    // so we hold the lock while updating them
     if(is_shutting_down())
     { return; }
 
@@ -1056,7 +1706,13 @@ void chl::KeeperRegistry::updateGrapherProcessStats(chl::GrapherStatsMsg const &
     id_string += stats.getGrapherIdCard();
     LOG_DEBUG("[ChronoProcessRegistry] Received GrapherStatsMsg from {}", chl::to_string(stats.getGrapherIdCard()));
 #endif
+    if(!statsMsg.getMetricsRollup().empty())
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Grapher {} metrics {}", chl::to_string(statsMsg.getGrapherIdCard())
+                  , chl::to_string(statsMsg.getMetricsRollup()));
+    }
 
+    std::lock_guard<std::mutex> lock(registryLock);
     auto group_iter = recordingGroups.find(statsMsg.getGrapherIdCard().getGroupId());
     if(group_iter == recordingGroups.end()) 
     { return; }
@@ -1067,6 +1723,7 @@ void chl::KeeperRegistry::updateGrapherProcessStats(chl::GrapherStatsMsg const &
         // there's no need to update stats of inactive process
         recording_group.grapherProcess->lastStatsTime = std::chrono::steady_clock::now().time_since_epoch().count();
         recording_group.grapherProcess->activeStoryCount = statsMsg.getActiveStoryCount();
+        recording_group.grapherProcess->loadStats = statsMsg.getLoadStats();
 
     }
 }
@@ -1104,6 +1761,15 @@ int chl::KeeperRegistry::registerPlayerProcess(chl::PlayerRegistrationMsg const
     // it is possible that the Registry still retains the record of the previous re-incarnation of the player process
     // check for this case and clean up the leftover record...
 
+    // the running player refreshing its registration keeps its entry and DataStoreAdminClient
+    if(recording_group.playerProcess != nullptr && recording_group.playerProcess->active
+       && recording_group.playerProcess->idCard == id_card
+       && recording_group.playerProcess->adminServiceId == admin_service_id)
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Player {} refreshed its registration", chl::to_string(id_card));
+        return chronolog::CL_SUCCESS;
+    }
+
     if(recording_group.playerProcess != nullptr)
     {
         // start delayed destruction for the lingering Adminclient to be safe...
@@ -1235,6 +1901,11 @@ void chl::KeeperRegistry::updatePlayerProcessStats(chl::PlayerStatsMsg const &st
     id_string += stats.getPlayerIdCard;
     LOG_DEBUG("[ChronoProcessRegistry] Received PlayerStatsMsg from {}", id_string.str());
 #endif
+    if(!statsMsg.getMetricsRollup().empty())
+    {
+        LOG_DEBUG("[ChronoProcessRegistry] Player {} metrics {}", chl::to_string(statsMsg.getPlayerIdCard())
+                  , chl::to_string(statsMsg.getMetricsRollup()));
+    }
 
     auto group_iter = recordingGroups.find(statsMsg.getPlayerIdCard().getGroupId());
     if(group_iter == recordingGroups.end())
@@ -1245,6 +1916,11 @@ void chl::KeeperRegistry::updatePlayerProcessStats(chl::PlayerStatsMsg const &st
     {
         // there's no need to update stats of inactive process
         recording_group.playerProcess->lastStatsTime = std::chrono::steady_clock::now().time_since_epoch().count();
+        recording_group.playerProcess->interactiveReadingStats = statsMsg.getInteractiveReadingStats();
+        recording_group.playerProcess->bulkReadingStats = statsMsg.getBulkReadingStats();
+        LOG_DEBUG("[ChronoProcessRegistry] Player {} archive reading interactive {} bulk {}"
+                  , chl::to_string(statsMsg.getPlayerIdCard()), chl::to_string(statsMsg.getInteractiveReadingStats())
+                  , chl::to_string(statsMsg.getBulkReadingStats()));
 
     }
 
@@ -1253,6 +1929,39 @@ void chl::KeeperRegistry::updatePlayerProcessStats(chl::PlayerStatsMsg const &st
 
 ///////////////
 
+chl::GroupLoad chl::RecordingGroup::getGroupLoad() const
+{
+    GroupLoad group_load;
+    group_load.groupId = groupId;
+    group_load.storyCount = assignedStoryCount;
+    group_load.capacity = 0;
+
+    // every keeper of the group ingests its share of the group's stories,
+    // the queue depths add up while the ingestion rate is the rate of the group as a whole
+    for(auto const &keeper_process: keeperProcesses)
+    {
+        if(!keeper_process.second.active)
+        { continue; }
+        ProcessLoadStats const &load_stats = keeper_process.second.loadStats;
+        group_load.ingestionRate += load_stats.ingestionRate;
+        group_load.queueDepth += load_stats.ingestionQueueDepth + load_stats.extractionQueueDepth;
+        group_load.residentMemory += load_stats.residentMemory;
+        group_load.capacity += (load_stats.capacity == 0 ? 1 : load_stats.capacity);
+    }
+
+    if(grapherProcess != nullptr && grapherProcess->active)
+    {
+        ProcessLoadStats const &load_stats = grapherProcess->loadStats;
+        group_load.queueDepth += load_stats.ingestionQueueDepth + load_stats.extractionQueueDepth;
+        group_load.residentMemory += load_stats.residentMemory;
+    }
+
+    if(group_load.capacity == 0)
+    { group_load.capacity = 1; }
+
+    return group_load;
+}
+
 bool chl::RecordingGroup::isActive() const
 {
     //TODO: we might add a check for time since the last stats message received from
@@ -1,11 +1,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include "ConfigurationManager.h"
 #include "chronolog_types.h"
+#include "chronolog_client.h" //for STORY_SHARD_COUNT_ATTR definition
 #include "VisorClientPortal.h"
 
 #include "KeeperRegistry.h"
@@ -16,6 +18,62 @@
 namespace tl = thallium;
 namespace chl = chronolog;
 
+namespace
+{
+// the number of recording groups the story asks to be sharded across, 1 if the attribute is missing or invalid
+uint32_t get_story_shard_count(std::map <std::string, std::string> const &attrs, std::string const &story_name)
+{
+    uint32_t shard_count = 1;
+    auto shard_attr_iter = attrs.find(STORY_SHARD_COUNT_ATTR);
+    if(shard_attr_iter != attrs.end())
+    {
+        try
+        {
+            shard_count = std::max(1ul, std::stoul((*shard_attr_iter).second));
+        }
+        catch(std::exception const &ex)
+        {
+            LOG_WARNING("[VisorClientPortal] Ignoring invalid {} attribute '{}' of story {}", STORY_SHARD_COUNT_ATTR
+                        , (*shard_attr_iter).second, story_name);
+        }
+    }
+    return shard_count;
+}
+
+// the value of the numeric chronicle attribute, 0 if it is missing or invalid
+uint64_t get_chronicle_rate_attr(std::map <std::string, std::string> const &chronicle_attrs, std::string const &attr
+                                 , std::string const &chronicle_name)
+{
+    auto attr_iter = chronicle_attrs.find(attr);
+    if(attr_iter == chronicle_attrs.end())
+    { return 0; }
+    try
+    {
+        return std::stoull((*attr_iter).second);
+    }
+    catch(std::exception const &ex)
+    {
+        LOG_WARNING("[VisorClientPortal] Ignoring invalid {} attribute '{}' of chronicle {}", attr, (*attr_iter).second
+                    , chronicle_name);
+    }
+    return 0;
+}
+
+// the event rate limits the Keepers enforce on the stories of the chronicle
+chl::StoryAdmissionLimits get_chronicle_admission_limits(std::map <std::string, std::string> const &chronicle_attrs
+                                                         , std::string const &chronicle_name)
+{
+    chl::StoryAdmissionLimits admission_limits;
+    admission_limits.clientEventRate = get_chronicle_rate_attr(chronicle_attrs, CHRONICLE_CLIENT_EVENT_RATE_ATTR
+                                                               , chronicle_name);
+    admission_limits.storyEventRate = get_chronicle_rate_attr(chronicle_attrs, CHRONICLE_STORY_EVENT_RATE_ATTR
+                                                              , chronicle_name);
+    admission_limits.burstMillis = get_chronicle_rate_attr(chronicle_attrs, CHRONICLE_EVENT_BURST_MSECS_ATTR
+                                                           , chronicle_name);
+    return admission_limits;
+}
+}
+
 /////////////////
 chronolog::VisorClientPortal::VisorClientPortal(): clientPortalState(chl::VisorClientPortal::UNKNOWN)
                                                    , clientPortalEngine(nullptr), clientPortalService(nullptr)
@@ -32,7 +90,8 @@ chronolog::VisorClientPortal::VisorClientPortal(): clientPortalState(chl::VisorC
 
 ////////////////
 int chronolog::VisorClientPortal::StartServices(chronolog::VisorConfiguration const & VISOR_CONF
-                                                , chl::KeeperRegistry*keeperRegistry)
+                                                , chl::KeeperRegistry*keeperRegistry
+                                                , chl::VisorMetadataStore*metadata_store)
 {
     int return_status = chronolog::CL_ERR_UNKNOWN;
 
@@ -43,6 +102,12 @@ int chronolog::VisorClientPortal::StartServices(chronolog::VisorConfiguration co
     // TODO : keeper registry can be a member ...
     theKeeperRegistry = keeperRegistry;
 
+    if(metadata_store != nullptr)
+    {
+        chronicleMetaDirectory.restore_from_metadata_store(*metadata_store);
+        chronicleMetaDirectory.set_metadata_store(metadata_store);
+    }
+
     try
     {
         // initialise thalium engine for KeeperRegistryService
@@ -221,16 +286,23 @@ chronolog::VisorClientPortal::AcquireStory(chl::ClientId const &client_id, std::
              , getpid(), client_id, chronicle_name.c_str(), story_name.c_str(), flags);
     }
 
+    // the hot story might ask to be sharded across several recording groups
+    uint32_t shard_count = get_story_shard_count(attrs, story_name);
+    std::map <std::string, std::string> chronicle_attrs;
+    chronicleMetaDirectory.get_chronicle_attrs(chronicle_name, chronicle_attrs);
+    chl::StoryAdmissionLimits admission_limits = get_chronicle_admission_limits(chronicle_attrs, chronicle_name);
+
     // if this is the first client to acquire this story we need to choose an active recording group
-    // for the new story and notify the recording Keepers & Graphers
+    // (or groups, for the sharded story) for the new story and notify the recording Keepers & Graphers
     // so that they are ready to start recording this story
 
     if(chronolog::CL_SUCCESS != theKeeperRegistry->notifyRecordingGroupOfStoryRecordingStart(
-                                        chronicle_name, story_name, story_id, recording_keepers, player))
+                                        chronicle_name, story_name, story_id, client_id, shard_count
+                                        , admission_limits, recording_keepers, player))
     {
-        // RPC notification to the keepers might have failed, release the newly acquired story
+        // RPC notification to the keepers might have failed, release the newly acquired story;
+        // the registry has already stopped the story on the shard groups that did start it and dropped its placement
         chronicleMetaDirectory.release_story(client_id, chronicle_name, story_name, story_id);
-        //we do know that there's no need notify keepers of the story ending in this case as it hasn't started...
         recording_keepers.clear();
         return chronolog::AcquireStoryResponseMsg(chronolog::CL_ERR_NO_KEEPERS, story_id, recording_keepers);
     }
@@ -258,6 +330,134 @@ int chronolog::VisorClientPortal::ReleaseStory(chl::ClientId const &client_id, s
     return chronolog::CL_SUCCESS;
 }
 
+std::vector <chl::AcquireStoryResponseMsg>
+chronolog::VisorClientPortal::AcquireStories(chl::ClientId const &client_id, std::string const &chronicle_name
+                                             , std::vector <std::string> const &story_names
+                                             , const std::map <std::string, std::string> &attrs, int &flags)
+{
+    std::vector <chl::AcquireStoryResponseMsg> responses(story_names.size());
+    std::vector <chronolog::KeeperIdCard> no_keepers;
+
+    if(!theKeeperRegistry->is_running())
+    {
+        responses.assign(story_names.size(), chl::AcquireStoryResponseMsg(chronolog::CL_ERR_NO_KEEPERS, 0, no_keepers));
+        return responses;
+    }
+
+    // the metadata directory part of the acquisition is done one story at a time,
+    // the stories to be started are then passed to the registry as one batch
+    std::map <std::string, std::string> chronicle_attrs;
+    chronicleMetaDirectory.get_chronicle_attrs(chronicle_name, chronicle_attrs);
+    chl::StoryAdmissionLimits admission_limits = get_chronicle_admission_limits(chronicle_attrs, chronicle_name);
+    std::vector <chl::StoryAcquisition> acquisitions;
+    std::vector <size_t> acquisition_indices;
+    for(size_t index = 0; index < story_names.size(); ++index)
+    {
+        std::string const &story_name = story_names[index];
+        chronolog::StoryId story_id{0};
+        int ret = chronolog::CL_ERR_UNKNOWN;
+        if(chronicle_name.empty() || story_name.empty())
+        { ret = chronolog::CL_ERR_INVALID_ARG; }
+        else if(!story_action_is_authorized(client_id, chronicle_name, story_name))
+        { ret = chronolog::CL_ERR_NOT_AUTHORIZED; }
+        else
+        { ret = chronicleMetaDirectory.acquire_story(client_id, chronicle_name, story_name, attrs, flags, story_id); }
+
+        if(ret != chronolog::CL_SUCCESS)
+        {
+            responses[index] = chl::AcquireStoryResponseMsg(ret, story_id, no_keepers);
+            continue;
+        }
+
+        chl::StoryAcquisition acquisition;
+        acquisition.chronicleName = chronicle_name;
+        acquisition.storyName = story_name;
+        acquisition.storyId = story_id;
+        acquisition.shardCount = get_story_shard_count(attrs, story_name);
+        acquisition.admissionLimits = admission_limits;
+        acquisitions.push_back(acquisition);
+        acquisition_indices.push_back(index);
+    }
+
+    if(!acquisitions.empty())
+    { theKeeperRegistry->notifyRecordingGroupsOfStoryRecordingStart(client_id, acquisitions); }
+
+    size_t acquired_count = 0;
+    for(size_t i = 0; i < acquisitions.size(); ++i)
+    {
+        chl::StoryAcquisition const &acquisition = acquisitions[i];
+        if(acquisition.errorCode != chronolog::CL_SUCCESS)
+        {
+            // RPC notification to the keepers might have failed, release the newly acquired story
+            StoryId story_id(0);
+            chronicleMetaDirectory.release_story(client_id, chronicle_name, acquisition.storyName, story_id);
+            responses[acquisition_indices[i]] = chl::AcquireStoryResponseMsg(chronolog::CL_ERR_NO_KEEPERS
+                                                                              , acquisition.storyId, no_keepers);
+            continue;
+        }
+        responses[acquisition_indices[i]] = chl::AcquireStoryResponseMsg(chronolog::CL_SUCCESS, acquisition.storyId
+                                                                          , acquisition.keepers, acquisition.player);
+        acquired_count++;
+    }
+
+    LOG_INFO("[VisorClientPortal] Stories acquired: PID={}, ClientID={}, ChronicleName={}, Acquired={} of {}, Flags={}"
+             , getpid(), client_id, chronicle_name.c_str(), acquired_count, story_names.size(), flags);
+    return responses;
+}
+
+std::vector <int>
+chronolog::VisorClientPortal::ReleaseStories(chl::ClientId const &client_id, std::string const &chronicle_name
+                                             , std::vector <std::string> const &story_names)
+{
+    std::vector <int> return_codes(story_names.size(), chronolog::CL_ERR_UNKNOWN);
+    std::vector <StoryId> released_story_ids;
+
+    for(size_t index = 0; index < story_names.size(); ++index)
+    {
+        if(!story_action_is_authorized(client_id, chronicle_name, story_names[index]))
+        {
+            return_codes[index] = chronolog::CL_ERR_NOT_AUTHORIZED;
+            continue;
+        }
+
+        StoryId story_id(0);
+        return_codes[index] = chronicleMetaDirectory.release_story(client_id, chronicle_name, story_names[index]
+                                                                   , story_id);
+        if(return_codes[index] == chronolog::CL_SUCCESS)
+        { released_story_ids.push_back(story_id); }
+    }
+
+    LOG_INFO("[VisorClientPortal] Stories released: PID={}, ChronicleName={}, Released={} of {}", getpid()
+             , chronicle_name.c_str(), released_story_ids.size(), story_names.size());
+
+    if(!released_story_ids.empty())
+    { theKeeperRegistry->notifyRecordingGroupsOfStoryRecordingStop(released_story_ids); }
+
+    return return_codes;
+}
+
+chl::AcquireStoryResponseMsg
+chronolog::VisorClientPortal::RefreshStory(chl::ClientId const &client_id, std::string const &chronicle_name
+                                           , std::string const &story_name)
+{
+    chronolog::StoryId story_id{0};
+    std::vector <chronolog::KeeperIdCard> recording_keepers;
+    chl::ServiceId player;
+
+    if(!story_action_is_authorized(client_id, chronicle_name, story_name))
+    { return chronolog::AcquireStoryResponseMsg(chronolog::CL_ERR_NOT_AUTHORIZED, story_id, recording_keepers); }
+
+    int ret = chronicleMetaDirectory.get_acquired_story_id(client_id, chronicle_name, story_name, story_id);
+    if(ret != chronolog::CL_SUCCESS)
+    { return chronolog::AcquireStoryResponseMsg(ret, story_id, recording_keepers); }
+
+    ret = theKeeperRegistry->getStoryRecordingKeepers(story_id, client_id, recording_keepers, player);
+    LOG_INFO("[VisorClientPortal] Story refreshed: ClientID={}, ChronicleName={}, StoryName={}, Keepers={}, Error Code={}"
+         , client_id, chronicle_name.c_str(), story_name.c_str(), recording_keepers.size(), ret);
+
+    return chronolog::AcquireStoryResponseMsg(ret, story_id, recording_keepers, player);
+}
+
 //////////////
 
 int chronolog::VisorClientPortal::GetChronicleAttr(chl::ClientId const &client_id, std::string const &chronicle_name
@@ -0,0 +1,642 @@
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "city.h"
+#include "chrono_monitor.h"
+#include "chronolog_errcode.h"
+#include "VisorMetadataStore.h"
+
+namespace chl = chronolog;
+
+#define METADATA_LOG_FILE_NAME "visor_metadata.log"
+#define METADATA_SNAPSHOT_FILE_NAME "visor_metadata.snapshot"
+// the snapshot is written out in pieces of this size
+#define METADATA_SNAPSHOT_WRITE_BUFFER_SIZE (4 * 1024 * 1024)
+
+namespace
+{
+
+enum MetadataRecordType: uint8_t
+{
+    CHRONICLE_CREATED = 1,
+    CHRONICLE_DESTROYED = 2,
+    CHRONICLE_ATTR_EDITED = 3,
+    STORY_CREATED = 4,
+    STORY_DESTROYED = 5,
+    STORY_RECORDING_STARTED = 6,
+    STORY_RECORDING_STOPPED = 7
+};
+
+size_t const RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+void putUint8(std::string &buffer, uint8_t value)
+{ buffer.push_back(static_cast<char>(value)); }
+
+void putUint32(std::string &buffer, uint32_t value)
+{ buffer.append(reinterpret_cast<char const*>(&value), sizeof(value)); }
+
+void putUint64(std::string &buffer, uint64_t value)
+{ buffer.append(reinterpret_cast<char const*>(&value), sizeof(value)); }
+
+void putString(std::string &buffer, std::string const &value)
+{
+    putUint32(buffer, value.size());
+    buffer.append(value);
+}
+
+void putAttrs(std::string &buffer, std::map <std::string, std::string> const &attrs)
+{
+    putUint32(buffer, attrs.size());
+    for(auto const &attr: attrs)
+    {
+        putString(buffer, attr.first);
+        putString(buffer, attr.second);
+    }
+}
+
+void putRecord(std::string &buffer, std::string const &payload)
+{
+    putUint32(buffer, payload.size());
+    putUint64(buffer, CityHash64(payload.data(), payload.size()));
+    buffer.append(payload);
+}
+
+struct RecordReader
+{
+    char const *pos;
+    char const *end;
+
+    bool getUint8(uint8_t &value)
+    {
+        if(end - pos < 1)
+        { return false; }
+        value = static_cast<uint8_t>(*pos++);
+        return true;
+    }
+
+    bool getUint32(uint32_t &value)
+    {
+        if(end - pos < static_cast<ptrdiff_t>(sizeof(value)))
+        { return false; }
+        std::memcpy(&value, pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool getUint64(uint64_t &value)
+    {
+        if(end - pos < static_cast<ptrdiff_t>(sizeof(value)))
+        { return false; }
+        std::memcpy(&value, pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool getString(std::string &value)
+    {
+        uint32_t size = 0;
+        if(!getUint32(size) || end - pos < static_cast<ptrdiff_t>(size))
+        { return false; }
+        value.assign(pos, size);
+        pos += size;
+        return true;
+    }
+
+    bool getAttrs(std::map <std::string, std::string> &attrs)
+    {
+        uint32_t count = 0;
+        if(!getUint32(count))
+        { return false; }
+        std::string key;
+        std::string value;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            if(!getString(key) || !getString(value))
+            { return false; }
+            attrs.insert_or_assign(key, value);
+        }
+        return true;
+    }
+};
+
+int writeAll(int fd, char const *data, size_t size)
+{
+    while(size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if(written < 0)
+        {
+            if(errno == EINTR)
+            { continue; }
+            return chronolog::CL_ERR_UNKNOWN;
+        }
+        data += written;
+        size -= written;
+    }
+    return chronolog::CL_SUCCESS;
+}
+
+}
+
+////////////////////////
+
+chl::VisorMetadataStore *
+chronolog::VisorMetadataStore::CreateVisorMetadataStore(std::string const &store_dir
+                                                        , uint64_t snapshot_interval_records)
+{
+    std::error_code error_code;
+    std::filesystem::create_directories(store_dir, error_code);
+    if(error_code)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to create metadata store directory {}: {}", store_dir
+                  , error_code.message());
+        return nullptr;
+    }
+    return new VisorMetadataStore(store_dir, snapshot_interval_records);
+}
+
+chronolog::VisorMetadataStore::VisorMetadataStore(std::string const &store_dir, uint64_t snapshot_interval_records)
+    : storeDir(store_dir)
+    , logFilePath(store_dir + "/" + METADATA_LOG_FILE_NAME)
+    , snapshotFilePath(store_dir + "/" + METADATA_SNAPSHOT_FILE_NAME)
+    , snapshotIntervalRecords(snapshot_interval_records)
+    , recordsSinceSnapshot(0)
+    , recordsSinceSync(0)
+    , logFd(-1)
+{}
+
+chronolog::VisorMetadataStore::~VisorMetadataStore()
+{
+    if(logFd >= 0)
+    {
+        syncLog();
+        ::close(logFd);
+    }
+}
+
+size_t chronolog::VisorMetadataStore::getStoryCount() const
+{
+    size_t story_count = 0;
+    for(auto const &chronicle: chronicles)
+    { story_count += chronicle.second.stories.size(); }
+    return story_count;
+}
+
+////////////////////////
+
+bool chronolog::VisorMetadataStore::applyRecord(char const *payload, size_t payload_size)
+{
+    RecordReader reader{payload, payload + payload_size};
+    uint8_t record_type = 0;
+    if(!reader.getUint8(record_type))
+    { return false; }
+
+    ChronicleName chronicle_name;
+    StoryName story_name;
+    switch(record_type)
+    {
+        case CHRONICLE_CREATED:
+        {
+            if(!reader.getString(chronicle_name))
+            { return false; }
+            chronicles.try_emplace(chronicle_name);
+            return true;
+        }
+        case CHRONICLE_DESTROYED:
+        {
+            if(!reader.getString(chronicle_name))
+            { return false; }
+            chronicles.erase(chronicle_name);
+            return true;
+        }
+        case CHRONICLE_ATTR_EDITED:
+        {
+            std::string key;
+            std::string value;
+            if(!reader.getString(chronicle_name) || !reader.getString(key) || !reader.getString(value))
+            { return false; }
+            auto chronicle_iter = chronicles.find(chronicle_name);
+            if(chronicle_iter != chronicles.end())
+            { (*chronicle_iter).second.properties.insert_or_assign(key, value); }
+            return true;
+        }
+        case STORY_CREATED:
+        {
+            std::map <std::string, std::string> attrs;
+            if(!reader.getString(chronicle_name) || !reader.getString(story_name) || !reader.getAttrs(attrs))
+            { return false; }
+            auto chronicle_iter = chronicles.find(chronicle_name);
+            if(chronicle_iter != chronicles.end())
+            { (*chronicle_iter).second.stories.insert_or_assign(story_name, std::move(attrs)); }
+            return true;
+        }
+        case STORY_DESTROYED:
+        {
+            if(!reader.getString(chronicle_name) || !reader.getString(story_name))
+            { return false; }
+            auto chronicle_iter = chronicles.find(chronicle_name);
+            if(chronicle_iter != chronicles.end())
+            { (*chronicle_iter).second.stories.erase(story_name); }
+            return true;
+        }
+        case STORY_RECORDING_STARTED:
+        {
+            StoryRecordingRecord recording;
+            uint32_t shard_count = 0;
+            if(!reader.getUint64(recording.storyId) || !reader.getString(recording.chronicleName)
+               || !reader.getString(recording.storyName) || !reader.getUint32(shard_count))
+            { return false; }
+            for(uint32_t i = 0; i < shard_count; ++i)
+            {
+                uint32_t group_id = 0;
+                if(!reader.getUint32(group_id))
+                { return false; }
+                recording.shardGroups.push_back(group_id);
+            }
+            storyRecordings.insert_or_assign(recording.storyId, std::move(recording));
+            return true;
+        }
+        case STORY_RECORDING_STOPPED:
+        {
+            StoryId story_id = 0;
+            if(!reader.getUint64(story_id))
+            { return false; }
+            storyRecordings.erase(story_id);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+int chronolog::VisorMetadataStore::replayFile(std::string const &file_path, size_t &valid_size)
+{
+    valid_size = 0;
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if(fd < 0)
+    { return (errno == ENOENT ? chronolog::CL_SUCCESS : chronolog::CL_ERR_UNKNOWN); }
+
+    struct stat file_stat;
+    if(::fstat(fd, &file_stat) != 0)
+    {
+        ::close(fd);
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+
+    // one read of the whole file, the records are then parsed in place
+    std::string contents(file_stat.st_size, '\0');
+    size_t bytes_read = 0;
+    while(bytes_read < contents.size())
+    {
+        ssize_t result = ::read(fd, &contents[bytes_read], contents.size() - bytes_read);
+        if(result < 0 && errno == EINTR)
+        { continue; }
+        if(result <= 0)
+        { break; }
+        bytes_read += result;
+    }
+    ::close(fd);
+    contents.resize(bytes_read);
+
+    char const *pos = contents.data();
+    char const *end = contents.data() + contents.size();
+    while(static_cast<size_t>(end - pos) >= RECORD_HEADER_SIZE)
+    {
+        uint32_t payload_size = 0;
+        uint64_t payload_hash = 0;
+        std::memcpy(&payload_size, pos, sizeof(payload_size));
+        std::memcpy(&payload_hash, pos + sizeof(payload_size), sizeof(payload_hash));
+        char const *payload = pos + RECORD_HEADER_SIZE;
+        if(static_cast<size_t>(end - payload) < payload_size
+           || CityHash64(payload, payload_size) != payload_hash
+           || !applyRecord(payload, payload_size))
+        { break; }
+        pos = payload + payload_size;
+        if(file_path == logFilePath)
+        { recordsSinceSnapshot++; }
+    }
+    valid_size = pos - contents.data();
+
+    if(valid_size != contents.size())
+    {
+        LOG_WARNING("[VisorMetadataStore] {} has {} bytes past the last intact record", file_path
+                    , contents.size() - valid_size);
+    }
+    return chronolog::CL_SUCCESS;
+}
+
+int chronolog::VisorMetadataStore::recover()
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+
+    chronicles.clear();
+    storyRecordings.clear();
+    recordsSinceSnapshot = 0;
+    recordsSinceSync = 0;
+    if(logFd >= 0)
+    {
+        ::close(logFd);
+        logFd = -1;
+    }
+
+    size_t snapshot_size = 0;
+    size_t log_size = 0;
+    if(replayFile(snapshotFilePath, snapshot_size) != chronolog::CL_SUCCESS
+       || replayFile(logFilePath, log_size) != chronolog::CL_SUCCESS)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to read the metadata files in {}: {}", storeDir, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+
+    logFd = ::open(logFilePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(logFd < 0)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to open {}: {}", logFilePath, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+    // cut off the record torn by the crash so that the new records follow the last intact one
+    struct stat log_stat;
+    if(::fstat(logFd, &log_stat) == 0 && static_cast<size_t>(log_stat.st_size) > log_size)
+    {
+        if(::ftruncate(logFd, log_size) != 0)
+        {
+            LOG_ERROR("[VisorMetadataStore] Failed to truncate {}: {}", logFilePath, strerror(errno));
+            return chronolog::CL_ERR_UNKNOWN;
+        }
+        if(syncLog() != chronolog::CL_SUCCESS)
+        { return chronolog::CL_ERR_UNKNOWN; }
+    }
+
+    LOG_INFO("[VisorMetadataStore] Recovered {} chronicles, {} stories, {} active story recordings from {}"
+             , chronicles.size(), getStoryCount(), storyRecordings.size(), storeDir);
+    return chronolog::CL_SUCCESS;
+}
+
+////////////////////////
+
+int chronolog::VisorMetadataStore::syncLog()
+{
+    // NOTE: the caller holds the storeMutex
+    if(::fsync(logFd) != 0)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to sync {}: {}", logFilePath, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+    recordsSinceSync = 0;
+    return chronolog::CL_SUCCESS;
+}
+
+int chronolog::VisorMetadataStore::appendRecord(std::string const &payload)
+{
+    // NOTE: the caller holds the storeMutex
+    if(logFd < 0)
+    { return chronolog::CL_ERR_UNKNOWN; }
+
+    std::string record;
+    record.reserve(RECORD_HEADER_SIZE + payload.size());
+    putRecord(record, payload);
+    // a single write of the whole record, the log survives the Visor process crash
+    if(writeAll(logFd, record.data(), record.size()) != chronolog::CL_SUCCESS)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to append to {}: {}", logFilePath, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+    applyRecord(payload.data(), payload.size());
+    recordsSinceSnapshot++;
+    recordsSinceSync++;
+    return chronolog::CL_SUCCESS;
+}
+
+std::string chronolog::VisorMetadataStore::chronicleCreatedRecord(ChronicleName const &chronicle_name)
+{
+    std::string payload;
+    putUint8(payload, CHRONICLE_CREATED);
+    putString(payload, chronicle_name);
+    return payload;
+}
+
+int chronolog::VisorMetadataStore::logChronicleCreated(ChronicleName const &chronicle_name)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(chronicleCreatedRecord(chronicle_name));
+}
+
+std::string chronolog::VisorMetadataStore::chronicleDestroyedRecord(ChronicleName const &chronicle_name)
+{
+    std::string payload;
+    putUint8(payload, CHRONICLE_DESTROYED);
+    putString(payload, chronicle_name);
+    return payload;
+}
+
+int chronolog::VisorMetadataStore::logChronicleDestroyed(ChronicleName const &chronicle_name)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(chronicleDestroyedRecord(chronicle_name));
+}
+
+std::string chronolog::VisorMetadataStore::chronicleAttrEditedRecord(ChronicleName const &chronicle_name, std::string const &key
+                                                                     , std::string const &value)
+{
+    std::string payload;
+    putUint8(payload, CHRONICLE_ATTR_EDITED);
+    putString(payload, chronicle_name);
+    putString(payload, key);
+    putString(payload, value);
+    return payload;
+}
+
+int chronolog::VisorMetadataStore::logChronicleAttrEdited(ChronicleName const &chronicle_name, std::string const &key
+                                                          , std::string const &value)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(chronicleAttrEditedRecord(chronicle_name, key, value));
+}
+
+std::string chronolog::VisorMetadataStore::storyCreatedRecord(ChronicleName const &chronicle_name, StoryName const &story_name
+                                                              , std::map <std::string, std::string> const &attrs)
+{
+    std::string payload;
+    putUint8(payload, STORY_CREATED);
+    putString(payload, chronicle_name);
+    putString(payload, story_name);
+    putAttrs(payload, attrs);
+    return payload;
+}
+
+int chronolog::VisorMetadataStore::logStoryCreated(ChronicleName const &chronicle_name, StoryName const &story_name
+                                                   , std::map <std::string, std::string> const &attrs)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(storyCreatedRecord(chronicle_name, story_name, attrs));
+}
+
+std::string chronolog::VisorMetadataStore::storyDestroyedRecord(ChronicleName const &chronicle_name, StoryName const &story_name)
+{
+    std::string payload;
+    putUint8(payload, STORY_DESTROYED);
+    putString(payload, chronicle_name);
+    putString(payload, story_name);
+    return payload;
+}
+
+int chronolog::VisorMetadataStore::logStoryDestroyed(ChronicleName const &chronicle_name, StoryName const &story_name)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(storyDestroyedRecord(chronicle_name, story_name));
+}
+
+int chronolog::VisorMetadataStore::logRecords(std::vector <std::string> const &payloads)
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    int ret = chronolog::CL_SUCCESS;
+    for(auto const &payload: payloads)
+    {
+        if(appendRecord(payload) != chronolog::CL_SUCCESS)
+        { ret = chronolog::CL_ERR_UNKNOWN; }
+    }
+    return ret;
+}
+
+int chronolog::VisorMetadataStore::logStoryRecordingStarted(StoryRecordingRecord const &recording)
+{
+    std::string payload;
+    putUint8(payload, STORY_RECORDING_STARTED);
+    putUint64(payload, recording.storyId);
+    putString(payload, recording.chronicleName);
+    putString(payload, recording.storyName);
+    putUint32(payload, recording.shardGroups.size());
+    for(RecordingGroupId group_id: recording.shardGroups)
+    { putUint32(payload, group_id); }
+
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(payload);
+}
+
+int chronolog::VisorMetadataStore::logStoryRecordingStopped(StoryId const &story_id)
+{
+    std::string payload;
+    putUint8(payload, STORY_RECORDING_STOPPED);
+    putUint64(payload, story_id);
+
+    std::lock_guard <std::mutex> lock(storeMutex);
+    return appendRecord(payload);
+}
+
+////////////////////////
+
+int chronolog::VisorMetadataStore::snapshotIfDue()
+{
+    {
+        std::lock_guard <std::mutex> lock(storeMutex);
+        if(recordsSinceSnapshot < snapshotIntervalRecords)
+        {
+            // the records logged since the previous call survive the machine crash from here on
+            if(logFd < 0 || recordsSinceSync == 0)
+            { return chronolog::CL_SUCCESS; }
+            return syncLog();
+        }
+    }
+    return writeSnapshot();
+}
+
+int chronolog::VisorMetadataStore::writeSnapshot()
+{
+    std::lock_guard <std::mutex> lock(storeMutex);
+    if(logFd < 0)
+    { return chronolog::CL_ERR_UNKNOWN; }
+
+    std::string tmp_file_path = snapshotFilePath + ".tmp";
+    int snapshot_fd = ::open(tmp_file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(snapshot_fd < 0)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to create {}: {}", tmp_file_path, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+
+    // the snapshot is the shortest log that rebuilds the current state
+    std::string buffer;
+    std::string payload;
+    buffer.reserve(METADATA_SNAPSHOT_WRITE_BUFFER_SIZE + 4096);
+    int ret = chronolog::CL_SUCCESS;
+    auto add_record = [&]()
+    {
+        putRecord(buffer, payload);
+        payload.clear();
+        if(buffer.size() >= METADATA_SNAPSHOT_WRITE_BUFFER_SIZE && ret == chronolog::CL_SUCCESS)
+        {
+            ret = writeAll(snapshot_fd, buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    };
+
+    for(auto const &[chronicle_name, chronicle]: chronicles)
+    {
+        putUint8(payload, CHRONICLE_CREATED);
+        putString(payload, chronicle_name);
+        add_record();
+        for(auto const &property: chronicle.properties)
+        {
+            putUint8(payload, CHRONICLE_ATTR_EDITED);
+            putString(payload, chronicle_name);
+            putString(payload, property.first);
+            putString(payload, property.second);
+            add_record();
+        }
+        for(auto const &[story_name, attrs]: chronicle.stories)
+        {
+            putUint8(payload, STORY_CREATED);
+            putString(payload, chronicle_name);
+            putString(payload, story_name);
+            putAttrs(payload, attrs);
+            add_record();
+        }
+    }
+    for(auto const &[story_id, recording]: storyRecordings)
+    {
+        putUint8(payload, STORY_RECORDING_STARTED);
+        putUint64(payload, story_id);
+        putString(payload, recording.chronicleName);
+        putString(payload, recording.storyName);
+        putUint32(payload, recording.shardGroups.size());
+        for(RecordingGroupId group_id: recording.shardGroups)
+        { putUint32(payload, group_id); }
+        add_record();
+    }
+    if(ret == chronolog::CL_SUCCESS)
+    { ret = writeAll(snapshot_fd, buffer.data(), buffer.size()); }
+    if(ret == chronolog::CL_SUCCESS && ::fsync(snapshot_fd) != 0)
+    { ret = chronolog::CL_ERR_UNKNOWN; }
+    ::close(snapshot_fd);
+
+    // the rename replaces the previous snapshot atomically, the log is truncated only after that
+    if(ret != chronolog::CL_SUCCESS || ::rename(tmp_file_path.c_str(), snapshotFilePath.c_str()) != 0)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to write snapshot {}: {}", snapshotFilePath, strerror(errno));
+        ::unlink(tmp_file_path.c_str());
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+    int dir_fd = ::open(storeDir.c_str(), O_RDONLY | O_DIRECTORY);
+    if(dir_fd >= 0)
+    {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+
+    if(::ftruncate(logFd, 0) != 0)
+    {
+        LOG_ERROR("[VisorMetadataStore] Failed to truncate {}: {}", logFilePath, strerror(errno));
+        return chronolog::CL_ERR_UNKNOWN;
+    }
+    // the log records folded into the snapshot are gone for good only once the truncation is on disk
+    if(syncLog() != chronolog::CL_SUCCESS)
+    { return chronolog::CL_ERR_UNKNOWN; }
+    LOG_INFO("[VisorMetadataStore] Snapshot of {} chronicles and {} active story recordings written after {} log records"
+             , chronicles.size(), storyRecordings.size(), recordsSinceSnapshot);
+    recordsSinceSnapshot = 0;
+    return chronolog::CL_SUCCESS;
+}
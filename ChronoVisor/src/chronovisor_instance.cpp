@@ -1,3 +1,4 @@
+#include <chrono>
 #include <signal.h>
 //#include "ClocksourceManager.h"
 #include <unistd.h>
@@ -6,6 +7,7 @@
 #include "KeeperRegistry.h"
 #include "chrono_monitor.h"
 #include "VisorClientPortal.h"
+#include "VisorMetadataStore.h"
 
 volatile sig_atomic_t keep_running = true;
 
@@ -50,21 +52,42 @@ int main(int argc, char**argv)
                                                        , VISOR_CONF.VISOR_LOG_CONF.LOGNAME
                                                        , VISOR_CONF.VISOR_LOG_CONF.LOGFILESIZE
                                                        , VISOR_CONF.VISOR_LOG_CONF.LOGFILENUM
-                                                       , VISOR_CONF.VISOR_LOG_CONF.FLUSHLEVEL);
+                                                       , VISOR_CONF.VISOR_LOG_CONF.FLUSHLEVEL
+                                                       , VISOR_CONF.VISOR_LOG_CONF.ASYNC);
     if(result == 1)
     {
         exit(EXIT_FAILURE);
     }
+    chronolog::chrono_monitor::setModuleLevels(VISOR_CONF.VISOR_LOG_CONF.MODULE_LEVELS);
     LOG_INFO("[chronovisor_instance] Running Chronovisor Server.");
 
    LOG_INFO("chronovisor_instance] VISOR CONFIGURATION {}", VISOR_CONF.to_String());
 
+    // recover the chronicles, stories and active story recordings of the previous Visor run
+    // before any of the RPC services is started
+    chronolog::VisorMetadataStore* metadataStore = nullptr;
+    if(!VISOR_CONF.METADATA_STORE_DIR.empty())
+    {
+        auto recoveryStart = std::chrono::steady_clock::now();
+        metadataStore = chronolog::VisorMetadataStore::CreateVisorMetadataStore(
+                VISOR_CONF.METADATA_STORE_DIR, VISOR_CONF.METADATA_SNAPSHOT_INTERVAL_RECORDS);
+        if(metadataStore == nullptr || metadataStore->recover() != chronolog::CL_SUCCESS)
+        {
+            LOG_CRITICAL("[chronovisor_instance] Failed to recover the metadata store at {}", VISOR_CONF.METADATA_STORE_DIR);
+            delete metadataStore;
+            exit(EXIT_FAILURE);
+        }
+        LOG_INFO("[chronovisor_instance] Metadata store recovered in {} ms"
+                 , std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - recoveryStart).count());
+    }
+
     chronolog::VisorClientPortal theChronoVisorPortal;
     chronolog::KeeperRegistry keeperRegistry;
 
-    keeperRegistry.InitializeRegistryService(VISOR_CONF);
+    keeperRegistry.InitializeRegistryService(VISOR_CONF, metadataStore);
 
-    theChronoVisorPortal.StartServices(VISOR_CONF, &keeperRegistry);
+    theChronoVisorPortal.StartServices(VISOR_CONF, &keeperRegistry, metadataStore);
 
     // If services do not start successfully there should a graceful exit(-1) here 
     /////
@@ -72,10 +95,22 @@ int main(int argc, char**argv)
     while(keep_running)
     {
         sleep(10);
+        // spread the load of the hot stories after scale out or during ingestion spikes
+        keeperRegistry.rebalanceRecordingGroups();
+        // the restored stories left behind by the clients that never came back stop skewing the placement
+        keeperRegistry.expireUnclaimedRestoredStories();
+        if(metadataStore != nullptr)
+        { metadataStore->snapshotIfDue(); }
     }
 
     theChronoVisorPortal.ShutdownServices();
     keeperRegistry.ShutdownRegistryService();
+    // the next start only has to load the snapshot
+    if(metadataStore != nullptr)
+    {
+        metadataStore->writeSnapshot();
+        delete metadataStore;
+    }
     LOG_INFO("[chronovisor_instance] ChronoVisor shutdown.");
     return 0;
 }
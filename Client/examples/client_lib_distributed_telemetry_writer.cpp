@@ -161,20 +161,15 @@ public:
         story_attrs["node"] = node_name;
         story_attrs["rank"] = std::to_string(rank);
 
-        // CPU usage story
-        auto cpu_result = client->AcquireStory(chronicle_name, "cpu_usage", story_attrs, flags);
-        assert(cpu_result.first == chronolog::CL_SUCCESS);
-        cpu_story_handle = cpu_result.second;
-
-        // Memory usage story
-        auto memory_result = client->AcquireStory(chronicle_name, "memory_usage", story_attrs, flags);
-        assert(memory_result.first == chronolog::CL_SUCCESS);
-        memory_story_handle = memory_result.second;
-
-        // Network usage story
-        auto network_result = client->AcquireStory(chronicle_name, "network_usage", story_attrs, flags);
-        assert(network_result.first == chronolog::CL_SUCCESS);
-        network_story_handle = network_result.second;
+        // Acquire the cpu, memory and network usage stories with one request
+        auto story_results = client->AcquireStories(chronicle_name, {"cpu_usage", "memory_usage", "network_usage"}
+                                                    , story_attrs, flags);
+        assert(story_results.size() == 3);
+        for(auto const &story_result: story_results)
+        { assert(story_result.first == chronolog::CL_SUCCESS); }
+        cpu_story_handle = story_results[0].second;
+        memory_story_handle = story_results[1].second;
+        network_story_handle = story_results[2].second;
 
         return true;
     }
@@ -185,22 +180,19 @@ public:
         {
             std::string chronicle_name = node_name;
 
-            // Release all stories
+            // Release all stories with one request
+            std::vector <std::string> acquired_stories;
             if(cpu_story_handle)
-            {
-                client->ReleaseStory(chronicle_name, "cpu_usage");
-                cpu_story_handle = nullptr;
-            }
+            { acquired_stories.push_back("cpu_usage"); }
             if(memory_story_handle)
-            {
-                client->ReleaseStory(chronicle_name, "memory_usage");
-                memory_story_handle = nullptr;
-            }
+            { acquired_stories.push_back("memory_usage"); }
             if(network_story_handle)
-            {
-                client->ReleaseStory(chronicle_name, "network_usage");
-                network_story_handle = nullptr;
-            }
+            { acquired_stories.push_back("network_usage"); }
+            if(!acquired_stories.empty())
+            { client->ReleaseStories(chronicle_name, acquired_stories); }
+            cpu_story_handle = nullptr;
+            memory_story_handle = nullptr;
+            network_story_handle = nullptr;
 
             // Disconnect from ChronoVisor
             client->Disconnect();
@@ -12,6 +12,21 @@ struct ClientPortalServiceConf {
     std::string IP = "127.0.0.1";
     uint16_t PORT = 5555;
     uint16_t PROVIDER_ID = 55;
+    // how the story writing handles spread the events over the story keepers:
+    // "round_robin", "timestamp", "client_sticky" or "least_outstanding"
+    std::string KEEPER_CHOICE_POLICY = "round_robin";
+    // event timestamps: "physical" local clock or "hlc" hybrid logical clock synchronized through the rpc responses
+    std::string CLOCK_MODE = "physical";
+    // one in TRACE_SAMPLE_EVERY events is traced from the client to the archive (0 disables the tracing),
+    // the client stages of the traces are dumped into TRACE_FILE when the client is destroyed
+    uint32_t TRACE_SAMPLE_EVERY = 0;
+    std::string TRACE_FILE = "";
+    // the AcquireStory / log_event / ReleaseStory calls are captured into WORKLOAD_CAPTURE_FILE (empty disables the capture)
+    // for the workload replay; WORKLOAD_CAPTURE_PAYLOADS "full" keeps the event payloads, "redacted" only their sizes
+    std::string WORKLOAD_CAPTURE_FILE = "";
+    std::string WORKLOAD_CAPTURE_PAYLOADS = "redacted";
+    // the events for the keepers running on the client node go through the shared memory rings instead of rpc
+    bool SHARED_MEMORY_TRANSPORT = true;
 };
 
 struct ClientQueryServiceConf {
@@ -100,6 +100,91 @@ private:
 
 };
 
+// PlaybackFilter describes the selection the chrono_player applies to the story events
+// before they are sent back to the client.
+// Default constructed filter selects all the events in the requested time range.
+struct PlaybackFilter
+{
+    std::vector<ClientId> clientIds;    // only events produced by these clients; empty means any client
+    std::string recordPattern;          // only events whose log record contains the pattern; empty means any record
+    bool patternIsRegex = false;        // treat recordPattern as ECMAScript regex instead of plain substring
+    uint32_t sampleEveryNth = 0;        // keep every Nth matching event; 0 or 1 keeps all of them
+    uint32_t reservoirSize = 0;         // keep a uniform random sample of this many matching events; 0 disables
+    uint64_t limit = 0;                 // return at most this many events, the earliest ones; 0 means no limit
+
+    bool is_pass_through() const
+    {
+        return (clientIds.empty() && recordPattern.empty() && sampleEveryNth <= 1 && reservoirSize == 0 && limit == 0);
+    }
+
+    // serialization function used by thallium RPC providers
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(clientIds, recordPattern, patternIsRegex, sampleEveryNth, reservoirSize, limit);
+    }
+};
+
+// AggregationQuery describes the time-bucketed statistics the chrono_player computes over the story events.
+// Numeric statistics (sum/min/max/quantiles) are computed over the events whose log record parses as a number,
+// the event count includes all the selected events.
+struct AggregationQuery
+{
+    uint64_t bucketWidth = 1000000000;  // width of the time bucket in nanoseconds
+    bool groupByClient = false;         // compute separate buckets for each client
+    bool numericStats = true;           // compute sum/min/max/quantiles over numeric log records; counts only if false
+    std::vector<double> quantiles;      // requested quantiles in [0,1], e.g. {0.5, 0.99}
+
+    // serialization function used by thallium RPC providers
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(bucketWidth, groupByClient, numericStats, quantiles);
+    }
+};
+
+struct AggregationBucket
+{
+    uint64_t bucketStart = 0;           // bucket covers [bucketStart, bucketStart + bucketWidth[
+    ClientId clientId = 0;              // only meaningful when the query was grouped by client
+    uint64_t eventCount = 0;
+    uint64_t valueCount = 0;            // number of events with numeric log record
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+    std::vector<double> quantileValues; // approximate values of the requested quantiles, in request order
+
+    // serialization function used by thallium RPC providers
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(bucketStart, clientId, eventCount, valueCount, sum, min, max, quantileValues);
+    }
+};
+
+// StoryStatistics summarizes the story events in the requested time range,
+// the chrono_player computes them from the per-chunk summaries of the archive without reading the events
+struct StoryStatistics
+{
+    uint64_t eventCount = 0;
+    uint64_t firstEventTime = 0;
+    uint64_t lastEventTime = 0;
+    uint64_t recordBytes = 0;               // total size of the log records
+    uint64_t minRecordSize = 0;
+    uint64_t maxRecordSize = 0;
+    uint64_t distinctClients = 0;           // approximate number of distinct clients
+    std::map<ClientId, uint64_t> clientEventCounts; // event counts of the clients, might not list every client of a busy story
+    std::vector<double> recordSizeQuantiles;    // approximate record size at the 0.5, 0.9 and 0.99 quantiles
+
+    // serialization function used by thallium RPC providers
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(eventCount, firstEventTime, lastEventTime, recordBytes, minRecordSize, maxRecordSize, distinctClients
+             , clientEventCounts, recordSizeQuantiles);
+    }
+};
+
 class StoryHandle
 {
 public:
@@ -110,6 +195,18 @@ public:
 
 class ChronologClientImpl;
 
+// AcquireStory attribute: the number of RecordingGroups a hot story is sharded across
+#define STORY_SHARD_COUNT_ATTR "shard_count"
+
+// CreateChronicle attributes: the event rate limits the Keepers enforce on every story of the chronicle,
+// in events per second on one Keeper: each Keeper recording the story admits up to story_event_rate,
+// so a story recorded by N Keepers takes up to N times story_event_rate in total;
+// the events over the limit are rejected with CL_ERR_THROTTLED, the client library retries them with backoff
+// and then keeps them in the story's retry buffer; log_event returns 0 only if the retry buffer is full
+#define CHRONICLE_CLIENT_EVENT_RATE_ATTR "client_event_rate"   // events of a single client
+#define CHRONICLE_STORY_EVENT_RATE_ATTR "story_event_rate"     // events of all the clients together
+#define CHRONICLE_EVENT_BURST_MSECS_ATTR "event_burst_msecs"   // burst over the rates, default 1000 msecs worth of events
+
 // top level Chronolog Client...
 // implementation details are in the ChronologClientImpl class 
 class Client
@@ -131,12 +228,24 @@ public:
 
     int DestroyChronicle(std::string const &chronicle_name);
 
+    // attrs[STORY_SHARD_COUNT_ATTR] = "K" asks for a hot story to be recorded by K RecordingGroups,
+    // each writer client records into one of the K shards and the playback merges them back;
+    // K is taken from the acquisition that starts the story recording
     std::pair <int, StoryHandle*> AcquireStory(std::string const &chronicle_name, std::string const &story_name
                                                , const std::map <std::string, std::string> &attrs
                                                , int &flags);
 
     int ReleaseStory(std::string const &chronicle_name, std::string const &story_name);
 
+    // bulk story setup: acquires or releases all the stories of the chronicle with one Visor rpc,
+    // the results follow the order of story_names; AcquireStories applies the same attrs to every story
+    std::vector <std::pair <int, StoryHandle*>> AcquireStories(std::string const &chronicle_name
+                                                               , std::vector <std::string> const &story_names
+                                                               , const std::map <std::string, std::string> &attrs
+                                                               , int &flags);
+
+    std::vector <int> ReleaseStories(std::string const &chronicle_name, std::vector <std::string> const &story_names);
+
     int DestroyStory(std::string const &chronicle_name, std::string const &story_name);
 
     int GetChronicleAttr(std::string const &chronicle_name, const std::string &key, std::string &value);
@@ -149,6 +258,19 @@ public:
     
     int ReplayStory( std::string const & chronicle, std::string const & story, uint64_t start, uint64_t end, std::vector<Event> & event_series);
 
+    // filtered replay: the filter is evaluated by the chrono_player so that only the selected events are transferred
+    int ReplayStory( std::string const & chronicle, std::string const & story, uint64_t start, uint64_t end
+                   , PlaybackFilter const & filter, std::vector<Event> & event_series);
+
+    // time-bucketed aggregation computed by the chrono_player, only the resulting buckets are transferred
+    int AggregateStory( std::string const & chronicle, std::string const & story, uint64_t start, uint64_t end
+                      , AggregationQuery const & query, std::vector<AggregationBucket> & buckets
+                      , PlaybackFilter const & filter = PlaybackFilter());
+
+    // range statistics answered from the archived chunk summaries
+    int GetStoryStatistics( std::string const & chronicle, std::string const & story, uint64_t start, uint64_t end
+                          , StoryStatistics & statistics);
+
 private:
     ChronologClientImpl*chronologClientImpl;
 };
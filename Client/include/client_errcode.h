@@ -17,7 +17,9 @@ enum ClientErrorCode {
     CL_ERR_NOT_AUTHORIZED  = -9,   // Unauthorized operation
     CL_ERR_NO_PLAYERS      = -10,   // No ChronoPlayers available
     CL_ERR_NOT_READER_MODE = -11,  // Client is running in WRITER_MODE
-    CL_ERR_QUERY_TIMED_OUT = -12   // Replay query timed out
+    CL_ERR_QUERY_TIMED_OUT = -12,  // Replay query timed out
+    CL_ERR_STORY_MIGRATED  = -13,  // Event was recorded, but the story has moved to another RecordingGroup
+    CL_ERR_THROTTLED       = -14   // Event was not recorded, the client is over the story's event rate limit; retry later
 };
 
 // Convert enum value to its name (for logging)
@@ -36,6 +38,8 @@ inline const char* to_string(ClientErrorCode e) {
     case CL_ERR_NO_PLAYERS:      return "CL_ERR_NO_PLAYERS";
     case CL_ERR_NOT_READER_MODE: return "CL_ERR_NOT_READER_MODE";
     case CL_ERR_QUERY_TIMED_OUT: return "CL_ERR_QUERY_TIMED_OUT";
+    case CL_ERR_STORY_MIGRATED:  return "CL_ERR_STORY_MIGRATED";
+    case CL_ERR_THROTTLED:       return "CL_ERR_THROTTLED";
     default:                     return "UnknownClientErrorCode";
     }
 }
@@ -55,6 +59,8 @@ inline const char* to_string_client(int code) {
         case CL_ERR_NO_PLAYERS:
         case CL_ERR_NOT_READER_MODE:
         case CL_ERR_QUERY_TIMED_OUT:
+        case CL_ERR_STORY_MIGRATED:
+        case CL_ERR_THROTTLED:
             return to_string(static_cast<chronolog::ClientErrorCode>(code));
         default:
             return "UnknownClientErrorCode";
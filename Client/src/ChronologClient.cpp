@@ -48,6 +48,19 @@ int chronolog::Client::ReleaseStory(std::string const &chronicle_name, std::stri
     return chronologClientImpl->ReleaseStory(chronicle_name, story_name);
 }
 
+std::vector <std::pair <int, chronolog::StoryHandle*>>
+chronolog::Client::AcquireStories(std::string const &chronicle_name, std::vector <std::string> const &story_names
+                                  , const std::map <std::string, std::string> &attrs, int &flags)
+{
+    return chronologClientImpl->AcquireStories(chronicle_name, story_names, attrs, flags);
+}
+
+std::vector <int>
+chronolog::Client::ReleaseStories(std::string const &chronicle_name, std::vector <std::string> const &story_names)
+{
+    return chronologClientImpl->ReleaseStories(chronicle_name, story_names);
+}
+
 int chronolog::Client::DestroyStory(std::string const &chronicle_name, std::string const &story_name)
 {
     return chronologClientImpl->DestroyStory(chronicle_name, story_name);
@@ -79,5 +92,24 @@ chronolog::Client::ShowStories(std::string const &chronicle_name, std::vector <s
 int chronolog::Client::ReplayStory(std::string const & chronicle_name, std::string const & story_name, uint64_t start_time, uint64_t end_time
                 , std::vector<chronolog::Event> & event_series)
 {
-    return chronologClientImpl->replay_story(chronicle_name, story_name, start_time, end_time, event_series);
+    return chronologClientImpl->replay_story(chronicle_name, story_name, start_time, end_time, chronolog::PlaybackFilter(), event_series);
+}
+
+int chronolog::Client::ReplayStory(std::string const & chronicle_name, std::string const & story_name, uint64_t start_time, uint64_t end_time
+                , chronolog::PlaybackFilter const & filter, std::vector<chronolog::Event> & event_series)
+{
+    return chronologClientImpl->replay_story(chronicle_name, story_name, start_time, end_time, filter, event_series);
+}
+
+int chronolog::Client::AggregateStory(std::string const & chronicle_name, std::string const & story_name, uint64_t start_time, uint64_t end_time
+                , chronolog::AggregationQuery const & query, std::vector<chronolog::AggregationBucket> & buckets
+                , chronolog::PlaybackFilter const & filter)
+{
+    return chronologClientImpl->aggregate_story(chronicle_name, story_name, start_time, end_time, query, filter, buckets);
+}
+
+int chronolog::Client::GetStoryStatistics(std::string const & chronicle_name, std::string const & story_name, uint64_t start_time, uint64_t end_time
+                , chronolog::StoryStatistics & statistics)
+{
+    return chronologClientImpl->get_story_statistics(chronicle_name, story_name, start_time, end_time, statistics);
 }
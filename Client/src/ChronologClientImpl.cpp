@@ -35,6 +35,12 @@ chronolog::ChronologClientImpl::ChronologClientImpl(
         , clientState(UNKNOWN)
         , clientLogin("")
         , hostId(0), pid(0), clientId(0)
+        , clockProxy(clientPortalServiceConf.CLOCK_MODE)
+        , keeperChoicePolicy(clientPortalServiceConf.KEEPER_CHOICE_POLICY)
+        , traceFile(clientPortalServiceConf.TRACE_FILE)
+        , workloadCaptureFile(clientPortalServiceConf.WORKLOAD_CAPTURE_FILE)
+        , captureWorkloadPayloads(clientPortalServiceConf.WORKLOAD_CAPTURE_PAYLOADS == "full")
+        , sharedMemoryTransport(clientPortalServiceConf.SHARED_MEMORY_TRANSPORT)
         , tlEngine(nullptr)
         , rpcVisorClient(nullptr)
         , storyteller(nullptr)
@@ -42,6 +48,7 @@ chronolog::ChronologClientImpl::ChronologClientImpl(
 {
 
     defineClientIdentity();
+    chl::EventTracer::getInstance().configure("ChronoClient", clientPortalServiceConf.TRACE_SAMPLE_EVERY);
     
     if(WRITER_MODE == clientMode)
     {
@@ -108,6 +115,9 @@ chronolog::ChronologClientImpl::~ChronologClientImpl()
         delete tlEngine;
     }
 
+    if(chl::EventTracer::isEnabled() && !traceFile.empty())
+    { chl::EventTracer::getInstance().dumpToFile(traceFile); }
+
 }
 
 int chronolog::ChronologClientImpl::Connect()
@@ -130,13 +140,15 @@ int chronolog::ChronologClientImpl::Connect()
     LOG_DEBUG("[ChronoLogClientImpl] Connection attempt to Visor completed. Response received: {}", ss.str());
 
     int return_code = connectResponseMsg.getErrorCode();
+    clockProxy.mergeRemoteTime(connectResponseMsg.getClockTime());
     if(return_code == chronolog::CL_SUCCESS)
     {
         clientState = CONNECTED;
         clientId = connectResponseMsg.getClientId();
         if(storyteller == nullptr)
         {
-            storyteller = new StorytellerClient(clockProxy, *tlEngine, clientId);
+            storyteller = new StorytellerClient(clockProxy, *tlEngine, clientId, rpcVisorClient, keeperChoicePolicy
+                                                , workloadCaptureFile, captureWorkloadPayloads, sharedMemoryTransport);
         }
         //TODO: if we ever change the connection hashing algorithm we'd need to handle reconnection case with the new client_id 
     }
@@ -304,6 +316,7 @@ chronolog::ChronologClientImpl::AcquireStory(std::string const &chronicle_name,
     std::stringstream ss;
     ss << acquireStoryResponse;
     LOG_DEBUG("[ChronoLogClientImpl] Response from AcquireStory RPC call: {}", ss.str());
+    clockProxy.mergeRemoteTime(acquireStoryResponse.getClockTime());
     if(acquireStoryResponse.getErrorCode() != chronolog::CL_SUCCESS)
     {
         LOG_ERROR("[ChronoLogClientImpl] Failed to acquire story '{}' from chronicle '{}'. Error code: {}", story_name
@@ -398,6 +411,170 @@ int chronolog::ChronologClientImpl::ReleaseStory(std::string const &chronicle_na
     return releaseStatus;
 }
 
+///////
+
+std::vector <std::pair <int, chronolog::StoryHandle*>>
+chronolog::ChronologClientImpl::AcquireStories(std::string const &chronicle_name
+                                               , std::vector <std::string> const &story_names
+                                               , const std::map <std::string, std::string> &attrs, int &flags)
+{
+    LOG_DEBUG("[ChronoLogClientImpl] Attempting to acquire {} stories. ChronicleName={}", story_names.size()
+              , chronicle_name);
+
+    std::vector <std::pair <int, chronolog::StoryHandle*>> results(
+            story_names.size(), std::pair <int, chronolog::StoryHandle*>(chronolog::CL_ERR_INVALID_ARG, nullptr));
+    if(chronicle_name.empty())
+    {
+        LOG_ERROR("[ChronoLogClientImpl] Failed to acquire stories: Missing essential parameters.");
+        return results;
+    }
+
+    std::lock_guard <std::mutex> lock_client(chronologClientMutex);
+
+    if((clientState == UNKNOWN) || (clientState == SHUTTING_DOWN))
+    {
+        LOG_ERROR("[ChronoLogClientImpl] Failed to acquire stories from chronicle '{}': Client is not connected or is shutting down."
+                  , chronicle_name);
+        results.assign(story_names.size()
+                       , std::pair <int, chronolog::StoryHandle*>(chronolog::CL_ERR_NO_CONNECTION, nullptr));
+        return results;
+    }
+
+    // only the stories that haven't been acquired by this process yet go into the Visor request
+    std::vector <std::string> requested_stories;
+    std::vector <size_t> requested_indices;
+    for(size_t index = 0; index < story_names.size(); ++index)
+    {
+        if(story_names[index].empty())
+        { continue; }
+
+        chronolog::StoryHandle*storyHandle = storyteller->findStoryWritingHandle(chronicle_name, story_names[index]);
+        if(storyHandle != nullptr)
+        {
+            results[index] = std::pair <int, chronolog::StoryHandle*>(chronolog::CL_SUCCESS, storyHandle);
+            continue;
+        }
+        requested_stories.push_back(story_names[index]);
+        requested_indices.push_back(index);
+    }
+
+    if(requested_stories.empty())
+    { return results; }
+
+    // issue one rpc request to the Visor for the whole batch
+    auto acquireStoryResponses = rpcVisorClient->AcquireStories(clientId, chronicle_name, requested_stories, attrs
+                                                                , flags);
+    if(!acquireStoryResponses.empty())
+    { clockProxy.mergeRemoteTime(acquireStoryResponses.front().getClockTime()); }
+
+    for(size_t i = 0; i < requested_stories.size(); ++i)
+    {
+        auto const &acquireStoryResponse = acquireStoryResponses[i];
+        std::string const &story_name = requested_stories[i];
+        if(acquireStoryResponse.getErrorCode() != chronolog::CL_SUCCESS)
+        {
+            LOG_ERROR("[ChronoLogClientImpl] Failed to acquire story '{}' from chronicle '{}'. Error code: {}"
+                      , story_name, chronicle_name, chronolog::to_string_client(acquireStoryResponse.getErrorCode()));
+            results[requested_indices[i]] = std::pair <int, chronolog::StoryHandle*>(
+                    acquireStoryResponse.getErrorCode(), nullptr);
+            continue;
+        }
+
+        chronolog::StoryHandle*storyHandle = storyteller->initializeStoryWritingHandle(
+                chronicle_name, story_name, acquireStoryResponse.getStoryId(), acquireStoryResponse.getKeepers()
+                , acquireStoryResponse.getPlayer());
+
+        if((nullptr != storyReaderService) && acquireStoryResponse.getPlayer().is_valid())
+        {
+            storyReaderService->addStoryReader(chronicle_name, story_name, acquireStoryResponse.getPlayer());
+        }
+
+        if(storyHandle == nullptr)
+        {
+            LOG_ERROR("[ChronoLogClientImpl] Failed to initialize story handle for '{}' in chronicle '{}'.", story_name
+                      , chronicle_name);
+            results[requested_indices[i]] = std::pair <int, chronolog::StoryHandle*>(chronolog::CL_ERR_UNKNOWN, nullptr);
+        }
+        else
+        {
+            results[requested_indices[i]] = std::pair <int, chronolog::StoryHandle*>(chronolog::CL_SUCCESS, storyHandle);
+        }
+    }
+
+    LOG_INFO("[ChronoLogClientImpl] Acquired {} stories in chronicle '{}' with one Visor request."
+             , requested_stories.size(), chronicle_name);
+    return results;
+}
+
+///////
+
+std::vector <int> chronolog::ChronologClientImpl::ReleaseStories(std::string const &chronicle_name
+                                                                 , std::vector <std::string> const &story_names)
+{
+    std::vector <int> return_codes(story_names.size(), chronolog::CL_ERR_INVALID_ARG);
+    if(chronicle_name.empty())
+    {
+        LOG_ERROR("[ChronoLogClientImpl] Failed to release stories: chronicle_name must be provided.");
+        return return_codes;
+    }
+
+    if(storyReaderService)
+    {
+        for(auto const &story_name: story_names)
+        { storyReaderService->removeStoryReader(chronicle_name, story_name); }
+    }
+
+    std::lock_guard <std::mutex> lock_client(chronologClientMutex);
+
+    // the active WritingHandles are cleared regardless of the Visor connection state
+    std::vector <std::string> released_stories;
+    std::vector <size_t> released_indices;
+    for(size_t index = 0; index < story_names.size(); ++index)
+    {
+        if(story_names[index].empty())
+        { continue; }
+
+        if(nullptr == storyteller || nullptr == storyteller->findStoryWritingHandle(chronicle_name, story_names[index]))
+        {
+            LOG_WARNING("[ChronoLogClientImpl] No active writing handle found for story '{}' in chronicle '{}'."
+                        , story_names[index], chronicle_name);
+            return_codes[index] = chronolog::CL_ERR_NOT_ACQUIRED;
+            continue;
+        }
+
+        storyteller->removeAcquiredStoryHandle(chronicle_name, story_names[index]);
+        released_stories.push_back(story_names[index]);
+        released_indices.push_back(index);
+    }
+
+    if(released_stories.empty())
+    { return return_codes; }
+
+    if((clientState == UNKNOWN) || (clientState == SHUTTING_DOWN))
+    {
+        LOG_ERROR("[ChronoLogClientImpl] Cannot release stories from chronicle '{}' due to client being in an unknown or shutting down state."
+                  , chronicle_name);
+        for(size_t index: released_indices)
+        { return_codes[index] = chronolog::CL_ERR_NO_CONNECTION; }
+        return return_codes;
+    }
+
+    auto releaseStatuses = rpcVisorClient->ReleaseStories(clientId, chronicle_name, released_stories);
+    for(size_t i = 0; i < released_stories.size(); ++i)
+    {
+        return_codes[released_indices[i]] = releaseStatuses[i];
+        if(releaseStatuses[i] != chronolog::CL_SUCCESS)
+        {
+            LOG_ERROR("[ChronoLogClientImpl] Failed to release story '{}' from chronicle '{}'. Error code: {}"
+                      , released_stories[i], chronicle_name, chronolog::to_string_client(releaseStatuses[i]));
+        }
+    }
+
+    LOG_INFO("[ChronoLogClientImpl] Released {} stories from chronicle '{}' with one Visor request."
+             , released_stories.size(), chronicle_name);
+    return return_codes;
+}
+
 //TODO: client account must be passed into the rpc call 
 int chronolog::ChronologClientImpl::GetChronicleAttr(std::string const &chronicle_name, const std::string &key
                                                      , std::string &value)
@@ -534,7 +711,47 @@ chronolog::ChronologClientImpl::ShowStories(std::string const &chronicle_name, s
 ////////////////////////////
 int 
 chronolog::ChronologClientImpl::replay_story( chronolog::ChronicleName const& chronicle, chronolog::StoryName const& story, uint64_t start, uint64_t end
-                , std::vector<chronolog::Event> & event_series)
+                , chronolog::PlaybackFilter const& filter, std::vector<chronolog::Event> & event_series)
+{
+    // this functionality is only available if the client is running in READER_MODE
+
+    if(WRITER_MODE == clientMode)
+    {
+        return chl::CL_ERR_NOT_READER_MODE;
+    }
+
+    if(nullptr == storyReaderService)
+    {
+        return chronolog::CL_ERR_NO_PLAYERS;
+    }
+
+    return storyReaderService->replay_story(chronicle, story, start, end, filter, event_series);
+}
+
+////////////////////////////
+int 
+chronolog::ChronologClientImpl::aggregate_story( chronolog::ChronicleName const& chronicle, chronolog::StoryName const& story, uint64_t start, uint64_t end
+                , chronolog::AggregationQuery const& query, chronolog::PlaybackFilter const& filter, std::vector<chronolog::AggregationBucket> & buckets)
+{
+    // this functionality is only available if the client is running in READER_MODE
+
+    if(WRITER_MODE == clientMode)
+    {
+        return chl::CL_ERR_NOT_READER_MODE;
+    }
+
+    if(nullptr == storyReaderService)
+    {
+        return chronolog::CL_ERR_NO_PLAYERS;
+    }
+
+    return storyReaderService->aggregate_story(chronicle, story, start, end, query, filter, buckets);
+}
+
+////////////////////////////
+int 
+chronolog::ChronologClientImpl::get_story_statistics( chronolog::ChronicleName const& chronicle, chronolog::StoryName const& story, uint64_t start, uint64_t end
+                , chronolog::StoryStatistics & statistics)
 {
     // this functionality is only available if the client is running in READER_MODE
 
@@ -548,6 +765,6 @@ chronolog::ChronologClientImpl::replay_story( chronolog::ChronicleName const& ch
         return chronolog::CL_ERR_NO_PLAYERS;
     }
 
-    return storyReaderService->replay_story(chronicle, story, start, end, event_series);
+    return storyReaderService->get_story_statistics(chronicle, story, start, end, statistics);
 }
 //////////////////////////////
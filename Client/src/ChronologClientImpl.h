@@ -60,6 +60,14 @@ public:
                                                , int &flags);
 
     int ReleaseStory(std::string const &chronicle_name, std::string const &story_name); 
+
+    std::vector <std::pair <int, StoryHandle*>> AcquireStories(std::string const &chronicle_name
+                                                               , std::vector <std::string> const &story_names
+                                                               , const std::map <std::string, std::string> &attrs
+                                                               , int &flags);
+
+    std::vector <int> ReleaseStories(std::string const &chronicle_name, std::vector <std::string> const &story_names);
+
     int DestroyStory(std::string const &chronicle_name, std::string const &story_name);
 
     int GetChronicleAttr(std::string const &chronicle_name, const std::string &key, std::string &value);
@@ -69,7 +77,12 @@ public:
     std::vector <std::string> &ShowChronicles(std::vector <std::string> &);
     std::vector <std::string> &ShowStories(const std::string &chronicle_name, std::vector <std::string> &);
 
-    int replay_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, std::vector<Event> & eventSeries);
+    int replay_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, PlaybackFilter const&, std::vector<Event> & eventSeries);
+
+    int aggregate_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, AggregationQuery const&, PlaybackFilter const&
+                       , std::vector<AggregationBucket> & buckets);
+
+    int get_story_statistics( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, StoryStatistics & statistics);
 
 private:
 
@@ -81,6 +94,11 @@ private:
     uint32_t pid;
     ClientId clientId;
     ChronologTimer clockProxy;
+    std::string keeperChoicePolicy;
+    std::string traceFile;
+    std::string workloadCaptureFile;
+    bool captureWorkloadPayloads;
+    bool sharedMemoryTransport;
     thallium::engine*tlEngine;
     RpcVisorClient*rpcVisorClient;
     StorytellerClient*storyteller;
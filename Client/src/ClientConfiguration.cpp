@@ -23,6 +23,34 @@ bool ClientConfiguration::load_from_file(const std::string& path) {
         if (json_object_object_get_ex(portal_service, "rpc", &rpc)) {
             parse_rpc(rpc, PORTAL_CONF.PROTO_CONF, PORTAL_CONF.IP, PORTAL_CONF.PORT, PORTAL_CONF.PROVIDER_ID);
         }
+        json_object* keeper_choice_policy;
+        if (json_object_object_get_ex(portal_service, "keeper_choice_policy", &keeper_choice_policy)) {
+            PORTAL_CONF.KEEPER_CHOICE_POLICY = json_object_get_string(keeper_choice_policy);
+        }
+        json_object* clock_mode;
+        if (json_object_object_get_ex(portal_service, "clock_mode", &clock_mode)) {
+            PORTAL_CONF.CLOCK_MODE = json_object_get_string(clock_mode);
+        }
+        json_object* trace_sample_every;
+        if (json_object_object_get_ex(portal_service, "trace_sample_every", &trace_sample_every)) {
+            PORTAL_CONF.TRACE_SAMPLE_EVERY = json_object_get_int(trace_sample_every);
+        }
+        json_object* trace_file;
+        if (json_object_object_get_ex(portal_service, "trace_file", &trace_file)) {
+            PORTAL_CONF.TRACE_FILE = json_object_get_string(trace_file);
+        }
+        json_object* workload_capture_file;
+        if (json_object_object_get_ex(portal_service, "workload_capture_file", &workload_capture_file)) {
+            PORTAL_CONF.WORKLOAD_CAPTURE_FILE = json_object_get_string(workload_capture_file);
+        }
+        json_object* workload_capture_payloads;
+        if (json_object_object_get_ex(portal_service, "workload_capture_payloads", &workload_capture_payloads)) {
+            PORTAL_CONF.WORKLOAD_CAPTURE_PAYLOADS = json_object_get_string(workload_capture_payloads);
+        }
+        json_object* shared_memory_transport;
+        if (json_object_object_get_ex(portal_service, "shared_memory_transport", &shared_memory_transport)) {
+            PORTAL_CONF.SHARED_MEMORY_TRANSPORT = json_object_get_boolean(shared_memory_transport);
+        }
     }
 
     json_object* query_service;
@@ -105,6 +133,13 @@ std::ostream& ClientConfiguration::log_configuration(std::ostream& out) const {
     out << "  IP: " << PORTAL_CONF.IP << std::endl;
     out << "  port: " << PORTAL_CONF.PORT << std::endl;
     out << "  provider ID: " << PORTAL_CONF.PROVIDER_ID << std::endl;
+    out << "  keeper choice policy: " << PORTAL_CONF.KEEPER_CHOICE_POLICY << std::endl;
+    out << "  clock mode: " << PORTAL_CONF.CLOCK_MODE << std::endl;
+    out << "  trace sample every: " << PORTAL_CONF.TRACE_SAMPLE_EVERY << std::endl;
+    out << "  trace file: " << PORTAL_CONF.TRACE_FILE << std::endl;
+    out << "  workload capture file: " << PORTAL_CONF.WORKLOAD_CAPTURE_FILE << std::endl;
+    out << "  workload capture payloads: " << PORTAL_CONF.WORKLOAD_CAPTURE_PAYLOADS << std::endl;
+    out << "  shared memory transport: " << (PORTAL_CONF.SHARED_MEMORY_TRANSPORT ? "on" : "off") << std::endl;
 
     out << "[QUERY_CONF]" << std::endl;
     out << "  protocol: " << QUERY_CONF.PROTO_CONF << std::endl;
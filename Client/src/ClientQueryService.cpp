@@ -7,6 +7,7 @@
 #include "chronolog_client.h"
 
 #include "StoryChunk.h"
+#include "PlaybackEventSelector.h"
 #include "ClientQueryService.h"
 #include "PlaybackQueryRpcClient.h"
 
@@ -64,9 +65,13 @@ void chl::ClientQueryService::removeStoryReader(chl::ChronicleName const & chron
 
 ////////////
 
-int chl::ClientQueryService::replay_story( chl::ChronicleName const& chronicle, chl::StoryName const& story, uint64_t start, uint64_t end, std::vector<chl::Event> & event_series)
+int chl::ClientQueryService::replay_story( chl::ChronicleName const& chronicle, chl::StoryName const& story, uint64_t start, uint64_t end
+        , chl::PlaybackFilter const& filter, std::vector<chl::Event> & event_series)
 {
 
+    if(!chl::PlaybackEventSelector::is_valid_filter(filter))
+    { return chl::CL_ERR_INVALID_ARG; }
+
     //check if the story has been acquired and the chrono_player is available for it 
 
     auto storyReader_iter = acquiredStoryMap.find(std::pair<chl::ChronicleName,chl::StoryName>(chronicle, story));
@@ -89,7 +94,7 @@ int chl::ClientQueryService::replay_story( chl::ChronicleName const& chronicle,
 
     //send query request to the appropriate chrono_player PlaybackService
     if( (playbackRpcClient == nullptr)
-    || ( playbackRpcClient->send_story_playback_request( query->queryId, chronicle, story, start,end) != chl::CL_SUCCESS))
+    || ( playbackRpcClient->send_story_playback_request( query->queryId, chronicle, story, start,end, filter) != chl::CL_SUCCESS))
     {
         stop_query(query->queryId);
         return chl::CL_ERR_NO_PLAYERS;
@@ -114,6 +119,55 @@ int chl::ClientQueryService::replay_story( chl::ChronicleName const& chronicle,
 }
 //////
 
+int chl::ClientQueryService::aggregate_story( chl::ChronicleName const& chronicle, chl::StoryName const& story, uint64_t start, uint64_t end
+        , chl::AggregationQuery const& query, chl::PlaybackFilter const& filter, std::vector<chl::AggregationBucket> & buckets)
+{
+    if(!chl::PlaybackEventSelector::is_valid_filter(filter))
+    { return chl::CL_ERR_INVALID_ARG; }
+
+    PlaybackQueryRpcClient * playbackRpcClient = nullptr;
+    {
+        std::lock_guard <std::mutex> lock(queryServiceMutex);
+        auto storyReader_iter = acquiredStoryMap.find(std::pair<chl::ChronicleName,chl::StoryName>(chronicle, story));
+        if(storyReader_iter == acquiredStoryMap.end())
+        { return chl::CL_ERR_NOT_ACQUIRED; }
+
+        playbackRpcClient = (*storyReader_iter).second;
+    }
+
+    if(playbackRpcClient == nullptr)
+    { return chl::CL_ERR_NO_PLAYERS; }
+
+    // unlike the playback the aggregation result is small enough to come back in the RPC response
+    return playbackRpcClient->send_story_aggregation_request(chronicle, story, start, end, query, filter, buckets, queryTimeoutInSecs);
+}
+
+//////
+
+int chl::ClientQueryService::get_story_statistics( chl::ChronicleName const& chronicle, chl::StoryName const& story, uint64_t start, uint64_t end
+        , chl::StoryStatistics & statistics)
+{
+    if(start >= end)
+    { return chl::CL_ERR_INVALID_ARG; }
+
+    PlaybackQueryRpcClient * playbackRpcClient = nullptr;
+    {
+        std::lock_guard <std::mutex> lock(queryServiceMutex);
+        auto storyReader_iter = acquiredStoryMap.find(std::pair<chl::ChronicleName,chl::StoryName>(chronicle, story));
+        if(storyReader_iter == acquiredStoryMap.end())
+        { return chl::CL_ERR_NOT_ACQUIRED; }
+
+        playbackRpcClient = (*storyReader_iter).second;
+    }
+
+    if(playbackRpcClient == nullptr)
+    { return chl::CL_ERR_NO_PLAYERS; }
+
+    return playbackRpcClient->send_story_statistics_request(chronicle, story, start, end, statistics, queryTimeoutInSecs);
+}
+
+//////
+
 chl::PlaybackQuery * chl::ClientQueryService::start_query(uint64_t timeout_time, chl::ChronicleName const& chronicle, chl::StoryName const& story, 
         chl::chrono_time const& start_time, chl::chrono_time const& end_time, std::vector<chl::Event> & playback_events)
 {
@@ -246,7 +300,9 @@ void chl::ClientQueryService::receive_story_chunk(tl::request  const& request, t
             LOG_DEBUG("[ClientQueryService] Query {} got StoryChunk {}-{} StartTime {} eventCount {} ThreadID={}"
                         , query_id, story_chunk->getChronicleName(), story_chunk->getStoryName(), story_chunk->getStartTime(), story_chunk->getEventCount() , tl::thread::self_id());
             story_chunk->extractEventSeries((*query_iter).second.eventSeries);
-            (*query_iter).second.completed=true;
+            // the Player streams the playback in time slices, the last StoryChunk ends at the query end time
+            if(story_chunk->getEndTime() >= (*query_iter).second.endTime)
+            {   (*query_iter).second.completed=true; }
         }
         
         delete story_chunk;
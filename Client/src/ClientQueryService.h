@@ -67,7 +67,12 @@ public:
  
     void receive_story_chunk(tl::request const&, tl::bulk &);
 
-    int replay_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, std::vector<Event> & replay_events);
+    int replay_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, PlaybackFilter const&, std::vector<Event> & replay_events);
+
+    int aggregate_story( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, AggregationQuery const&, PlaybackFilter const&
+                       , std::vector<AggregationBucket> & buckets);
+
+    int get_story_statistics( ChronicleName const&, StoryName const&, uint64_t start, uint64_t end, StoryStatistics & statistics);
 
 private:
     ClientQueryService(thallium::engine & tl_engine, ServiceId const&);
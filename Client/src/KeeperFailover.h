@@ -0,0 +1,165 @@
+#ifndef KEEPER_FAILOVER_H
+#define KEEPER_FAILOVER_H
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "chronolog_types.h"
+#include "client_errcode.h"
+
+namespace chronolog
+{
+
+// KeeperCircuitBreaker skips the keeper after failure_threshold consecutive failed requests.
+// Once open_msecs pass a single request is let through as the probe while the circuit stays open for the others;
+// the probe success closes the circuit, its failure keeps the circuit open for another open_msecs.
+// If the probe never reports back the next probe is let through open_msecs later.
+// The caller passes the current steady clock time in milliseconds.
+class KeeperCircuitBreaker
+{
+public:
+    KeeperCircuitBreaker(uint32_t failure_threshold, uint64_t open_msecs)
+        : failureThreshold(failure_threshold)
+        , openMsecs(open_msecs)
+    {}
+
+    // returns true if the request is to be sent to the keeper, it is then reported with recordSuccess or recordFailure
+    bool allowRequest(uint64_t now_msecs)
+    {
+        if(consecutiveFailures.load(std::memory_order_relaxed) < failureThreshold)
+        { return true; }
+
+        uint64_t open_until = circuitOpenUntil.load(std::memory_order_relaxed);
+        if(now_msecs < open_until)
+        { return false; }
+
+        // half open: the one caller that moves the deadline forward sends the probe
+        return circuitOpenUntil.compare_exchange_strong(open_until, now_msecs + openMsecs, std::memory_order_relaxed);
+    }
+
+    // returns true if the success closed the open circuit
+    bool recordSuccess()
+    { return (consecutiveFailures.exchange(0, std::memory_order_relaxed) >= failureThreshold); }
+
+    // returns true if the circuit is open after the failure
+    bool recordFailure(uint64_t now_msecs)
+    {
+        if(consecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1 < failureThreshold)
+        { return false; }
+        circuitOpenUntil.store(now_msecs + openMsecs, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool isOpen() const
+    { return (consecutiveFailures.load(std::memory_order_relaxed) >= failureThreshold); }
+
+private:
+    uint32_t failureThreshold;
+    uint64_t openMsecs;
+    std::atomic <uint32_t> consecutiveFailures{0};
+    std::atomic <uint64_t> circuitOpenUntil{0};
+};
+
+// Sends the event to the chosen keeper, failing over to the other story keepers their circuit breakers allow
+// if it is unreachable. The event keeps its timestamp and index. On return chosen_keeper is the keeper
+// that took the event. KeeperClient provides allowRequest() and send_event_msg(LogEvent const &).
+template <class KeeperClient>
+int sendWithFailover(std::vector <KeeperClient*> const &keepers, KeeperClient* &chosen_keeper, LogEvent const &event)
+{
+    int return_code = CL_ERR_NO_KEEPERS;
+    if(chosen_keeper->allowRequest())
+    { return_code = chosen_keeper->send_event_msg(event); }
+
+    if(CL_ERR_NO_KEEPERS != return_code)
+    { return return_code; }
+
+    for(KeeperClient* other_keeper: keepers)
+    {
+        if(other_keeper == chosen_keeper || !other_keeper->allowRequest())
+        { continue; }
+        return_code = other_keeper->send_event_msg(event);
+        if(CL_ERR_NO_KEEPERS != return_code)
+        {
+            chosen_keeper = other_keeper;
+            break;
+        }
+    }
+    return return_code;
+}
+
+// EventRetryBuffer keeps the events that couldn't be recorded yet, in their logging order,
+// to be resent later with their original timestamp and index.
+class EventRetryBuffer
+{
+public:
+    explicit EventRetryBuffer(size_t buffer_capacity)
+        : capacity(buffer_capacity)
+    {}
+
+    // returns false if the buffer is full
+    bool push(LogEvent const &event)
+    {
+        std::lock_guard <std::mutex> lock(bufferMutex);
+        if(events.size() >= capacity)
+        { return false; }
+        events.push_back(event);
+        eventCount = events.size();
+        return true;
+    }
+
+    // lock free check for the writer threads
+    size_t size() const
+    { return eventCount.load(std::memory_order_relaxed); }
+
+    // Resends up to max_events buffered events with send_event(LogEvent const &) returning the record_event code.
+    // Stops at the first event that is still retryable (no keeper reachable or throttled), it stays at the head
+    // of the buffer. One thread at a time flushes, the others return right away. Returns the number of
+    // events taken out of the buffer, rejected_events counts the ones the keeper rejected for good.
+    template <class SendEvent>
+    size_t flush(size_t max_events, SendEvent send_event, size_t &rejected_events)
+    {
+        rejected_events = 0;
+        std::unique_lock <std::mutex> flush_lock(flushMutex, std::try_to_lock);
+        if(!flush_lock.owns_lock())
+        { return 0; }
+
+        size_t flushed_events = 0;
+        for(; flushed_events < max_events; ++flushed_events)
+        {
+            LogEvent event;
+            {
+                std::lock_guard <std::mutex> lock(bufferMutex);
+                if(events.empty())
+                { break; }
+                event = events.front();
+                events.pop_front();
+            }
+
+            int return_code = send_event(event);
+            std::lock_guard <std::mutex> lock(bufferMutex);
+            if(CL_ERR_NO_KEEPERS == return_code || CL_ERR_THROTTLED == return_code)
+            {
+                events.push_front(event);
+                eventCount = events.size();
+                break;
+            }
+            if(CL_SUCCESS != return_code)
+            { rejected_events++; }
+            eventCount = events.size();
+        }
+        return flushed_events;
+    }
+
+private:
+    size_t capacity;
+    std::mutex bufferMutex;
+    std::mutex flushMutex;
+    std::deque <LogEvent> events;
+    std::atomic <size_t> eventCount{0};
+};
+
+}
+
+#endif
@@ -1,16 +1,41 @@
 #ifndef KEEPER_RECORDING_CLIENT_H
 #define KEEPER_RECORDING_CLIENT_H
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <unistd.h>
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
 
 #include "chronolog_types.h"
 #include "KeeperIdCard.h"
 #include "client_errcode.h"
+#include "HybridLogicalClock.h"
+#include "RecordEventResponseMsg.h"
+#include "SharedEventRing.h"
+#include "KeeperFailover.h"
 
 namespace tl = thallium;
 
+// the record_event call is abandoned after this long, so that a dead keeper doesn't stall the writer thread
+#define KEEPER_RECORD_EVENT_TIMEOUT_MSECS 2000
+// consecutive failed record_event calls that open the keeper's circuit
+#define KEEPER_CIRCUIT_FAILURE_THRESHOLD 3
+// the open circuit lets a probe request through after this long
+#define KEEPER_CIRCUIT_OPEN_MSECS 1000
+// record area of the shared memory ring of the client and the keeper running on the same node
+#define SHM_EVENT_RING_CAPACITY (4 * 1024 * 1024)
+// the writer waits this long for the keeper to make room in the full ring before sending the event through rpc
+#define SHM_EVENT_RING_FULL_WAIT_USECS 1000
+// the events taken back from the stalled ring are resent through rpc this many at a time, ahead of the new event
+#define SHM_RECLAIMED_EVENTS_FLUSH_BATCH 256
+
 
 namespace chronolog
 {
@@ -20,12 +45,20 @@ class KeeperRecordingClient
 {
 
 public:
+    // client_clock is the hybrid logical clock of the client the keeper clock is merged into, nullptr if not used;
+    // with shared_memory_transport the events for the keeper running on the client node go through a SharedEventRing
     static KeeperRecordingClient*
-    CreateKeeperRecordingClient(tl::engine &tl_engine, KeeperIdCard const &keeper_id_card)
+    CreateKeeperRecordingClient(tl::engine &tl_engine, KeeperIdCard const &keeper_id_card
+                                , HybridLogicalClock* client_clock = nullptr, ClientId const &client_id = 0
+                                , bool shared_memory_transport = false)
     {
         try
         {
-            return new KeeperRecordingClient(tl_engine, keeper_id_card);
+            KeeperRecordingClient*keeperRecordingClient = new KeeperRecordingClient(tl_engine, keeper_id_card
+                                                                                    , client_clock);
+            if(shared_memory_transport && isLocalAddress(keeper_id_card.getRecordingServiceId().getIPaddr()))
+            { keeperRecordingClient->attachEventRing(client_id); }
+            return keeperRecordingClient;
         }
         catch(tl::exception const & ex)
         {
@@ -35,41 +68,293 @@ public:
     }
 
     int send_event_msg(LogEvent const &eventMsg)
+    {
+        InFlightRequest in_flight_request(inFlightRequests);
+        // the events acknowledged through the ring the keeper then stopped polling go first
+        if(reclaimedEvents.size() > 0)
+        { resendReclaimedEvents(SHM_RECLAIMED_EVENTS_FLUSH_BATCH); }
+
+        int return_code;
+        if(eventRingAttached.load(std::memory_order_acquire) && pushToEventRing(eventMsg, return_code))
+        { return return_code; }
+        return sendThroughRpc(eventMsg);
+    }
+
+    // circuit breaker: the keeper is skipped after KEEPER_CIRCUIT_FAILURE_THRESHOLD consecutive failures
+    // until KEEPER_CIRCUIT_OPEN_MSECS pass, then a single request is let through as the probe
+    // and its success closes the circuit; the caller that is allowed the request must send it
+    bool allowRequest()
+    { return circuitBreaker.allowRequest(steadyClockMillis()); }
+
+    KeeperIdCard const & getKeeperId() const
+    { return keeperIdCard; }
+
+    // record_event requests this client process is waiting on, used by the LeastOutstandingKeeperChoice
+    uint32_t getInFlightRequests() const
+    { return inFlightRequests.load(std::memory_order_relaxed); }
+
+    ~KeeperRecordingClient()
+    {
+        detachEventRing();
+        // last chance for the events taken back from the stalled ring
+        if(reclaimedEvents.size() > 0)
+        { resendReclaimedEvents(SIZE_MAX); }
+        if(reclaimedEvents.size() > 0)
+        {
+            LOG_WARNING("[KeeperRecordingClient] {} events taken back from the shared memory ring of {} are not recorded"
+                        , reclaimedEvents.size(), to_string(keeperIdCard));
+        }
+        record_event.deregister();
+        attach_event_ring.deregister();
+        LOG_DEBUG("[KeeperRecordingClient] Destructor called {}", to_string(keeperIdCard));
+    }
+
+private:
+
+    static uint64_t steadyClockMillis()
+    {
+        return std::chrono::duration_cast <std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // returns the record_event response code, CL_ERR_NO_KEEPERS if the keeper can't be reached
+    int sendThroughRpc(LogEvent const &eventMsg)
     {
         try
         {
             //std::stringstream ss;
             //ss << eventMsg;
             //LOG_TRACE("[KeeperRecordingClient] Sending event message: {}", ss.str());
-            int return_code = record_event.on(service_ph)(eventMsg);
-            //LOG_TRACE("[KeeperRecordingClient] Sent event message: {} with return code: {}", ss.str(), return_code);
-            return return_code;
+            RecordEventResponseMsg response = record_event.on(service_ph).timed(
+                    std::chrono::milliseconds(KEEPER_RECORD_EVENT_TIMEOUT_MSECS), eventMsg);
+            //LOG_TRACE("[KeeperRecordingClient] Sent event message: {} with return code: {}", ss.str(), response.getErrorCode());
+            recordSuccess();
+            if(clientClock != nullptr)
+            { clientClock->update(response.getClockTime()); }
+            return response.getErrorCode();
         }
         catch(thallium::exception const & ex)
         {
             LOG_ERROR("[KeeperRecordingClient] Failed to send event message to {} exception: {}", to_string(keeperIdCard), ex.what());
         }
-        return (chronolog::CL_ERR_UNKNOWN);
+        // the keeper is unreachable, the caller may retry the event with another keeper
+        recordFailure();
+        return (chronolog::CL_ERR_NO_KEEPERS);
     }
 
-    KeeperIdCard const & getKeeperId() const
-    { return keeperIdCard; }
+    // resends up to max_events reclaimed events through rpc in their ring order,
+    // stops at the first one the keeper doesn't take yet, it is tried again with the next event
+    void resendReclaimedEvents(size_t max_events)
+    {
+        size_t rejected_events = 0;
+        reclaimedEvents.flush(max_events, [this](LogEvent const &log_event)
+        {
+            // the migrated story is reported with the writer's next event of that story
+            int return_code = sendThroughRpc(log_event);
+            return (CL_ERR_STORY_MIGRATED == return_code ? CL_SUCCESS : return_code);
+        }, rejected_events);
+        if(rejected_events > 0)
+        {
+            LOG_WARNING("[KeeperRecordingClient] {} rejected {} events taken back from the shared memory ring"
+                        , to_string(keeperIdCard), rejected_events);
+        }
+    }
 
-    ~KeeperRecordingClient()
+    void recordSuccess()
     {
-        record_event.deregister();
-        LOG_DEBUG("[KeeperRecordingClient] Destructor called {}", to_string(keeperIdCard));
+        if(circuitBreaker.recordSuccess())
+        { LOG_INFO("[KeeperRecordingClient] {} is reachable again", to_string(keeperIdCard)); }
     }
 
-private:
+    void recordFailure()
+    {
+        if(circuitBreaker.recordFailure(steadyClockMillis()))
+        {
+            LOG_WARNING("[KeeperRecordingClient] {} is unavailable, skipping it for {} ms", to_string(keeperIdCard)
+                        , KEEPER_CIRCUIT_OPEN_MSECS);
+        }
+    }
+
+    // true if the keeper address is one of the addresses of the node this client runs on
+    static bool isLocalAddress(uint32_t ip_addr)
+    {
+        if((ip_addr >> 24) == 127)
+        { return true; }
+        struct ifaddrs*if_addrs = nullptr;
+        if(getifaddrs(&if_addrs) != 0)
+        { return false; }
+        bool is_local = false;
+        for(struct ifaddrs*if_addr = if_addrs; if_addr != nullptr && !is_local; if_addr = if_addr->ifa_next)
+        {
+            if(if_addr->ifa_addr != nullptr && if_addr->ifa_addr->sa_family == AF_INET)
+            {
+                is_local = (ntohl(reinterpret_cast<struct sockaddr_in*>(if_addr->ifa_addr)->sin_addr.s_addr) ==
+                            ip_addr);
+            }
+        }
+        freeifaddrs(if_addrs);
+        return is_local;
+    }
+
+    // creates the ring and asks the keeper to poll it, the events keep going through rpc if anything fails
+    void attachEventRing(ClientId const &client_id)
+    {
+        static std::atomic <uint32_t> ringCount{0};
+        std::string shm_name = "/chronolog_" + std::to_string(getpid()) + "_" + std::to_string(ringCount++);
+        SharedEventRing*event_ring = SharedEventRing::CreateSharedEventRing(shm_name, SHM_EVENT_RING_CAPACITY);
+        if(event_ring == nullptr)
+        { return; }
+
+        int return_code = CL_ERR_UNKNOWN;
+        try
+        {
+            return_code = attach_event_ring.on(service_ph).timed(
+                    std::chrono::milliseconds(KEEPER_RECORD_EVENT_TIMEOUT_MSECS), client_id, shm_name);
+        }
+        catch(thallium::exception const &ex)
+        {
+            LOG_WARNING("[KeeperRecordingClient] Failed to attach event ring to {} exception: {}"
+                        , to_string(keeperIdCard), ex.what());
+        }
+        // the keeper has the segment mapped by now if it is ever going to
+        SharedEventRing::unlink(shm_name);
+        if(return_code != CL_SUCCESS)
+        {
+            LOG_INFO("[KeeperRecordingClient] {} is on the client node but doesn't take the shared memory events"
+                     , to_string(keeperIdCard));
+            event_ring->closeProducer();
+            delete event_ring;
+            return;
+        }
+        eventRing = event_ring;
+        eventRingAttached.store(true, std::memory_order_release);
+        LOG_INFO("[KeeperRecordingClient] Sending events to {} through the shared memory ring {}"
+                 , to_string(keeperIdCard), shm_name);
+    }
+
+    // the keeper polls the closed ring until it has consumed all the events
+    void detachEventRing()
+    {
+        std::lock_guard <std::mutex> lock(eventRingMutex);
+        closeEventRing(false);
+    }
+
+    // the caller holds the eventRingMutex; with reclaim_events the events the keeper hasn't consumed
+    // are taken back from the ring before it is unmapped, they are resent through rpc
+    void closeEventRing(bool reclaim_events)
+    {
+        if(eventRing == nullptr)
+        { return; }
+        eventRingAttached.store(false, std::memory_order_relaxed);
+        eventRing->closeProducer();
+        if(reclaim_events)
+        {
+            size_t reclaimed_count = 0;
+            size_t lost_count = 0;
+            LogEvent log_event;
+            while(eventRing->reclaim(log_event))
+            {
+                if(reclaimedEvents.push(log_event))
+                { reclaimed_count++; }
+                else
+                { lost_count++; }
+            }
+            if(reclaimed_count > 0)
+            {
+                LOG_WARNING("[KeeperRecordingClient] {} events not polled by {} are resent through rpc"
+                            , reclaimed_count, to_string(keeperIdCard));
+            }
+            if(lost_count > 0)
+            {
+                LOG_ERROR("[KeeperRecordingClient] {} events not polled by {} are lost", lost_count
+                          , to_string(keeperIdCard));
+            }
+        }
+        delete eventRing;
+        eventRing = nullptr;
+    }
+
+    // returns false if the event is to go through rpc instead,
+    // otherwise the return_code is what record_event would have responded with
+    bool pushToEventRing(LogEvent const &eventMsg, int &return_code)
+    {
+        std::unique_lock <std::mutex> lock(eventRingMutex);
+        if(eventRing == nullptr || !eventRing->canHold(eventMsg))
+        { return false; }
+        if(eventRing->isConsumerClosed())
+        {
+            LOG_INFO("[KeeperRecordingClient] {} has closed the shared memory ring, falling back to rpc"
+                     , to_string(keeperIdCard));
+            closeEventRing(true);
+            return false;
+        }
+
+        std::chrono::steady_clock::time_point wait_start;
+        for(bool waiting = false; !eventRing->tryPush(eventMsg); waiting = true)
+        {
+            if(eventRing->isConsumerStalled(KEEPER_RECORD_EVENT_TIMEOUT_MSECS))
+            {
+                // the keeper has stopped polling the ring, it is treated the same way as the rpc timeout
+                LOG_ERROR("[KeeperRecordingClient] {} stopped polling the shared memory ring", to_string(keeperIdCard));
+                // the events already reported recorded are taken back, so that they aren't lost with the ring
+                closeEventRing(true);
+                lock.unlock();
+                recordFailure();
+                return_code = CL_ERR_NO_KEEPERS;
+                return true;
+            }
+            if(!waiting)
+            { wait_start = std::chrono::steady_clock::now(); }
+            else if(std::chrono::steady_clock::now() - wait_start >
+                    std::chrono::microseconds(SHM_EVENT_RING_FULL_WAIT_USECS))
+            {
+                // the full ring is backpressure, not the answer to this event: the keeper is behind on the ring
+                // or holds it back while the client is over the story's event rate limit,
+                // the rpc gets the event recorded or the keeper's CL_ERR_THROTTLED for it
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        recordSuccess();
+        if(clientClock != nullptr)
+        { clientClock->update(eventRing->getConsumerClock()); }
+        // the keeper reports the migrated story on the event following the one it has found migrated
+        return_code = (eventRing->takeStoryMigrated(eventMsg.storyId) ? CL_ERR_STORY_MIGRATED : CL_SUCCESS);
+        return true;
+    }
+
+    // counts the request as in flight for the duration of the send_event_msg call
+    class InFlightRequest
+    {
+    public:
+        explicit InFlightRequest(std::atomic <uint32_t> &in_flight_requests): inFlightRequests(in_flight_requests)
+        { inFlightRequests.fetch_add(1, std::memory_order_relaxed); }
+
+        ~InFlightRequest()
+        { inFlightRequests.fetch_sub(1, std::memory_order_relaxed); }
+
+    private:
+        std::atomic <uint32_t> &inFlightRequests;
+    };
 
     KeeperIdCard keeperIdCard;
+    HybridLogicalClock* clientClock;
+    std::atomic <uint32_t> inFlightRequests{0};
+    KeeperCircuitBreaker circuitBreaker{KEEPER_CIRCUIT_FAILURE_THRESHOLD, KEEPER_CIRCUIT_OPEN_MSECS};
     tl::provider_handle service_ph;  //provider_handle for remote registry service
     tl::remote_procedure record_event;
+    tl::remote_procedure attach_event_ring;
+    std::mutex eventRingMutex;  // the writer threads take turns as the single producer of the ring
+    SharedEventRing*eventRing;  // nullptr unless the keeper takes the events through shared memory
+    std::atomic <bool> eventRingAttached{false};    // lets the rpc-only clients skip the eventRingMutex
+    // events taken back from the stalled ring, every record is at least a record header so the whole ring fits
+    EventRetryBuffer reclaimedEvents{SHM_EVENT_RING_CAPACITY / sizeof(SharedEventRecordHeader)};
 
     // constructor is private to make sure thalium rpc objects are created on the heap, not stack
-    KeeperRecordingClient(tl::engine &tl_engine, KeeperIdCard const &keeper_id_card)
+    KeeperRecordingClient(tl::engine &tl_engine, KeeperIdCard const &keeper_id_card, HybridLogicalClock* client_clock)
         : keeperIdCard(keeper_id_card)
+        , clientClock(client_clock)
+        , eventRing(nullptr)
     {
         LOG_DEBUG("[KeeperRecordingClient] KeeperRecordingiClient Constructor for {}",to_string(keeper_id_card));
         std::string service_addr_string;
@@ -78,6 +363,7 @@ private:
         service_ph = tl::provider_handle(tl_engine.lookup(service_addr_string), keeper_id_card.getRecordingServiceId().getProviderId());
 
         record_event = tl_engine.define("record_event");
+        attach_event_ring = tl_engine.define("attach_event_ring");
     }
 
 
@@ -3,12 +3,15 @@
 #include <thallium/serialization/serialize.hpp>
 #include <thallium/serialization/stl/string.hpp>
 #include <thallium/serialization/stl/map.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "chrono_monitor.h"
 #include "client_errcode.h"
 #include "ServiceId.h"
 #include "PlaybackQueryRpcClient.h"
 #include "ClientQueryService.h"
+#include "AggregationResponseMsg.h"
+#include "StoryStatisticsResponseMsg.h"
 
 
 namespace tl = thallium;
@@ -28,12 +31,16 @@ chl::PlaybackQueryRpcClient::PlaybackQueryRpcClient(chl::ClientQueryService & cl
 
     playback_service_available = theClientQueryService.get_engine().define("playback_service_available");
     story_playback_request = theClientQueryService.get_engine().define("story_playback_request");
+    story_aggregation_request = theClientQueryService.get_engine().define("story_aggregation_request");
+    story_statistics_request = theClientQueryService.get_engine().define("story_statistics_request");
 }
 
 chl::PlaybackQueryRpcClient::~PlaybackQueryRpcClient()
 {
     playback_service_available.deregister();
     story_playback_request.deregister();
+    story_aggregation_request.deregister();
+    story_statistics_request.deregister();
 }
 //////////////
 
@@ -52,7 +59,8 @@ int chl::PlaybackQueryRpcClient::is_playback_service_available()
     return chronolog::CL_ERR_UNKNOWN;
 }
     
-int chl::PlaybackQueryRpcClient::send_story_playback_request(uint32_t query_id, chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, uint64_t start_time, uint64_t end_time)
+int chl::PlaybackQueryRpcClient::send_story_playback_request(uint32_t query_id, chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name, uint64_t start_time, uint64_t end_time
+        , chl::PlaybackFilter const & filter)
 {
     int return_code = chronolog::CL_ERR_UNKNOWN;
 
@@ -61,7 +69,7 @@ int chl::PlaybackQueryRpcClient::send_story_playback_request(uint32_t query_id,
     try
     {
         LOG_DEBUG("[PlaybackQueryRpcClient] {} ; send_story_playback_request for Story {}{}", chl::to_string(playback_service_id), chronicle_name,story_name);
-        story_playback_request.on(playback_service_handle)( theClientQueryService.get_service_id(), query_id, chronicle_name,story_name,start_time,end_time);
+        story_playback_request.on(playback_service_handle)( theClientQueryService.get_service_id(), query_id, chronicle_name,story_name,start_time,end_time, filter);
 
         return chronolog::CL_SUCCESS;
 
@@ -74,4 +82,57 @@ int chl::PlaybackQueryRpcClient::send_story_playback_request(uint32_t query_id,
     return return_code;
 }
 
+int chl::PlaybackQueryRpcClient::send_story_aggregation_request(chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name
+        , uint64_t start_time, uint64_t end_time, chl::AggregationQuery const & query, chl::PlaybackFilter const & filter
+        , std::vector<chl::AggregationBucket> & buckets, int timeout_secs)
+{
+    try
+    {
+        LOG_DEBUG("[PlaybackQueryRpcClient] {} ; send_story_aggregation_request for Story {}{}", chl::to_string(playback_service_id), chronicle_name,story_name);
+        chl::AggregationResponseMsg response = story_aggregation_request.on(playback_service_handle).timed(std::chrono::seconds(timeout_secs)
+                , chronicle_name, story_name, start_time, end_time, query, filter);
+
+        if(response.getErrorCode() == chronolog::CL_SUCCESS)
+        {   buckets = response.getBuckets(); }
+
+        return response.getErrorCode();
+    }
+    catch (tl::timeout const& ex)
+    {
+        LOG_ERROR("[PlaybackQueryRpcClient] {} ; send_story_aggregation_request timed out", chl::to_string(playback_service_id));
+        return chronolog::CL_ERR_QUERY_TIMED_OUT;
+    }
+    catch (tl::exception const& ex)
+    {
+        LOG_ERROR("[PlaybackQueryRpcClient] {} ; send_story_aggregation_request exception {}", chl::to_string(playback_service_id), ex.what());
+    }
+
+    return chronolog::CL_ERR_UNKNOWN;
+}
 
+int chl::PlaybackQueryRpcClient::send_story_statistics_request(chl::ChronicleName const &chronicle_name, chl::StoryName const &story_name
+        , uint64_t start_time, uint64_t end_time, chl::StoryStatistics & statistics, int timeout_secs)
+{
+    try
+    {
+        LOG_DEBUG("[PlaybackQueryRpcClient] {} ; send_story_statistics_request for Story {}{}", chl::to_string(playback_service_id), chronicle_name,story_name);
+        chl::StoryStatisticsResponseMsg response = story_statistics_request.on(playback_service_handle).timed(std::chrono::seconds(timeout_secs)
+                , chronicle_name, story_name, start_time, end_time);
+
+        if(response.getErrorCode() == chronolog::CL_SUCCESS)
+        {   statistics = response.getStatistics(); }
+
+        return response.getErrorCode();
+    }
+    catch (tl::timeout const& ex)
+    {
+        LOG_ERROR("[PlaybackQueryRpcClient] {} ; send_story_statistics_request timed out", chl::to_string(playback_service_id));
+        return chronolog::CL_ERR_QUERY_TIMED_OUT;
+    }
+    catch (tl::exception const& ex)
+    {
+        LOG_ERROR("[PlaybackQueryRpcClient] {} ; send_story_statistics_request exception {}", chl::to_string(playback_service_id), ex.what());
+    }
+
+    return chronolog::CL_ERR_UNKNOWN;
+}
@@ -38,7 +38,17 @@ public:
 
     int is_playback_service_available();
 
-    int send_story_playback_request(uint32_t query_id, ChronicleName const & chronicle_name, StoryName const & story_name, uint64_t start_time, uint64_t end_time);
+    int send_story_playback_request(uint32_t query_id, ChronicleName const & chronicle_name, StoryName const & story_name, uint64_t start_time, uint64_t end_time
+                                    , PlaybackFilter const & filter);
+
+    // synchronous request, the aggregated buckets are returned in the RPC response
+    int send_story_aggregation_request(ChronicleName const & chronicle_name, StoryName const & story_name, uint64_t start_time, uint64_t end_time
+                                    , AggregationQuery const & query, PlaybackFilter const & filter
+                                    , std::vector<AggregationBucket> & buckets, int timeout_secs);
+
+    // synchronous request, the range statistics are returned in the RPC response
+    int send_story_statistics_request(ChronicleName const & chronicle_name, StoryName const & story_name, uint64_t start_time, uint64_t end_time
+                                    , StoryStatistics & statistics, int timeout_secs);
 
 private:
 
@@ -51,6 +61,8 @@ private:
     tl::provider_handle playback_service_handle;  // tl::provider_handle for remote PlaybackService
     tl::remote_procedure playback_service_available;
     tl::remote_procedure story_playback_request;
+    tl::remote_procedure story_aggregation_request;
+    tl::remote_procedure story_statistics_request;
 
     // constructor is private to make sure thalium rpc objects are created on the heap, not stack
     PlaybackQueryRpcClient(ClientQueryService &, ServiceId const& playback_service_id);
@@ -1,13 +1,16 @@
 #include <iostream>
 
 #include <thallium.hpp>
+#include <algorithm>
 #include <chrono>
 #include <climits>
+#include <thread>
 
 #include "chronolog_types.h"
 #include "StorytellerClient.h"
 #include "KeeperRecordingClient.h"
 #include "PlaybackQueryRpcClient.h"
+#include "rpcVisorClient.h"
 
 namespace tl = thallium;
 
@@ -17,6 +20,8 @@ namespace chl = chronolog;
 
 uint64_t chronolog::ChronologTimer::getTimestamp()
 {
+    if(useHybridClock)
+    { return hybridClock.getTimestamp(); }
     return std::chrono::high_resolution_clock::now().time_since_epoch().count();
 }
 
@@ -24,20 +29,68 @@ uint64_t chronolog::ChronologTimer::getTimestamp()
 chronolog::StoryHandle::~StoryHandle()
 {}
 
+/////////////////////
+chronolog::KeeperRecordingClient*
+chronolog::LeastOutstandingKeeperChoice::chooseKeeper(std::vector <chl::KeeperRecordingClient*> const &vectorOfKeepers
+                                                      , chl::LogEvent const &)
+{
+    size_t start = nextKeeper++ % vectorOfKeepers.size();
+    chl::KeeperRecordingClient*chosenKeeper = vectorOfKeepers[start];
+    uint32_t fewest_requests = chosenKeeper->getInFlightRequests();
+    for(size_t i = 1; i < vectorOfKeepers.size() && fewest_requests > 0; ++i)
+    {
+        chl::KeeperRecordingClient*keeper = vectorOfKeepers[(start + i) % vectorOfKeepers.size()];
+        uint32_t in_flight_requests = keeper->getInFlightRequests();
+        if(in_flight_requests < fewest_requests)
+        {
+            chosenKeeper = keeper;
+            fewest_requests = in_flight_requests;
+        }
+    }
+    return chosenKeeper;
+}
+
 ////////////////////
 template <class KeeperChoicePolicy>
-// = chronolog::RoundRobinKeeperChoice>
 chronolog::StoryWritingHandle <KeeperChoicePolicy>::~StoryWritingHandle()
 {
+    // last chance for the events still waiting for a keeper
+    if(retryBuffer.size() > 0)
+    { flushRetryBuffer(STORY_RETRY_BUFFER_SIZE); }
+    if(retryBuffer.size() > 0)
+    {
+        LOG_WARNING("[StoryWritingHandle] Story {} released with {} events that couldn't reach any keeper", storyId
+                    , retryBuffer.size());
+    }
     delete keeperChoicePolicy;
 }
 
+///////////////////
+template <class KeeperChoicePolicy>
+void chronolog::StoryWritingHandle <KeeperChoicePolicy>::publishRecordingClients(
+        std::vector <chronolog::KeeperRecordingClient*> *keeperClients)
+{
+    // the previous list is freed once the last writer thread holding its snapshot lets it go
+    std::atomic_store_explicit(&storyKeepers, KeeperListSnapshot(keeperClients), std::memory_order_release);
+}
+
+///////////////////
+template <class KeeperChoicePolicy>
+typename chronolog::StoryWritingHandle <KeeperChoicePolicy>::KeeperListSnapshot
+chronolog::StoryWritingHandle <KeeperChoicePolicy>::getRecordingClients() const
+{
+    return std::atomic_load_explicit(&storyKeepers, std::memory_order_acquire);
+}
+
 ////////////////////
 template <class KeeperChoicePolicy>
 void
 chronolog::StoryWritingHandle <KeeperChoicePolicy>::addRecordingClient(chronolog::KeeperRecordingClient*keeperClient)
 {
-    storyKeepers.push_back(keeperClient);
+    std::lock_guard <std::mutex> lock(storyKeepersMutex);
+    auto keeperClients = new std::vector <chronolog::KeeperRecordingClient*>(*getRecordingClients());
+    keeperClients->push_back(keeperClient);
+    publishRecordingClients(keeperClients);
 }
 
 ///////////////////
@@ -47,35 +100,160 @@ chronolog::StoryWritingHandle <KeeperChoicePolicy>::removeRecordingClient(chrono
 {
     // this should only be called when the ChronoKeeper process unexpectedly exits
     // so it's ok to use rather inefficient vector iteration....
-    for(auto iter = storyKeepers.begin(); iter != storyKeepers.end(); ++iter)
+    std::lock_guard <std::mutex> lock(storyKeepersMutex);
+    KeeperListSnapshot keeperList = getRecordingClients();
+    std::vector <chronolog::KeeperRecordingClient*> const &currentKeepers = *keeperList;
+    for(auto iter = currentKeepers.begin(); iter != currentKeepers.end(); ++iter)
     {
         if((*iter)->getKeeperId() == keeper_id_card)
         {
-            storyKeepers.erase(iter);
+            auto keeperClients = new std::vector <chronolog::KeeperRecordingClient*>(currentKeepers);
+            keeperClients->erase(keeperClients->begin() + (iter - currentKeepers.begin()));
+            publishRecordingClients(keeperClients);
             break;
         }
     }
 }
 
+///////////////////
+template <class KeeperChoicePolicy>
+void chronolog::StoryWritingHandle <KeeperChoicePolicy>::replaceRecordingClients(
+        std::vector <chronolog::KeeperRecordingClient*> const &keeperClients)
+{
+    std::lock_guard <std::mutex> lock(storyKeepersMutex);
+    publishRecordingClients(new std::vector <chronolog::KeeperRecordingClient*>(keeperClients));
+}
+
+///////////////////
+template <class KeeperChoicePolicy>
+void chronolog::StoryWritingHandle <KeeperChoicePolicy>::refreshRecordingClients(
+        chronolog::KeeperRecordingClient*redirectingKeeper)
+{
+    // the other threads redirected at the same time keep sending to the previous keepers
+    // that still accept the events of the migrated story until its pipeline exits
+    std::unique_lock <std::mutex> refresh_lock(keepersRefreshMutex, std::try_to_lock);
+    if(!refresh_lock.owns_lock())
+    { return; }
+
+    KeeperListSnapshot keeperList = getRecordingClients();
+    std::vector <chronolog::KeeperRecordingClient*> const &currentKeepers = *keeperList;
+    if(std::find(currentKeepers.begin(), currentKeepers.end(), redirectingKeeper) == currentKeepers.end())
+    { return; } // already switched to the new keepers
+
+    std::vector <chronolog::KeeperRecordingClient*> keeperClients;
+    if(chronolog::CL_SUCCESS == theClient.refreshStoryKeepers(chronicle, story, keeperClients) && !keeperClients.empty())
+    {
+        replaceRecordingClients(keeperClients);
+        LOG_INFO("[StoryWritingHandle] Story {} migrated, switched to {} keepers", storyId, keeperClients.size());
+    }
+}
+
+//////////////////
+template <class KeeperChoicePolicy>
+int chronolog::StoryWritingHandle <KeeperChoicePolicy>::sendEvent(chronolog::LogEvent const &log_event)
+{
+    // the keeper list snapshot stays valid until the event is sent even if the list is replaced meanwhile
+    KeeperListSnapshot keeperList = getRecordingClients();
+    std::vector <chronolog::KeeperRecordingClient*> const &currentKeepers = *keeperList;
+    chronolog::KeeperRecordingClient*keeperRecordingClient = nullptr;
+    if(!currentKeepers.empty())
+    { keeperRecordingClient = keeperChoicePolicy->chooseKeeper(currentKeepers, log_event); }
+    if(nullptr == keeperRecordingClient)   //very unlikely...
+    {
+        LOG_WARNING("[StoryWritingHandle] No keeper selected for logging event to story {}", storyId);
+        return chronolog::CL_ERR_NO_KEEPERS;
+    }
+
+    // the same event keeps its timestamp and index if it fails over to another keeper
+    chronolog::KeeperRecordingClient*chosenKeeper = keeperRecordingClient;
+    int return_code = chronolog::sendWithFailover(currentKeepers, keeperRecordingClient, log_event);
+    if(keeperRecordingClient != chosenKeeper)
+    {
+        LOG_DEBUG("[StoryWritingHandle] Story {} event failed over to {}", storyId
+                  , to_string(keeperRecordingClient->getKeeperId()));
+    }
+
+    if(chronolog::CL_ERR_STORY_MIGRATED == return_code)
+    {
+        // the event is recorded, but the following ones should go to the story's new RecordingGroup
+        refreshRecordingClients(keeperRecordingClient);
+        return chronolog::CL_SUCCESS;
+    }
+    return return_code;
+}
+
+//////////////////
+template <class KeeperChoicePolicy>
+void chronolog::StoryWritingHandle <KeeperChoicePolicy>::flushRetryBuffer(size_t max_events)
+{
+    // one writer thread at a time does the flushing, the others go on with their own events
+    size_t rejected_events = 0;
+    retryBuffer.flush(max_events, [this](chronolog::LogEvent const &log_event)
+    { return sendEvent(log_event); }, rejected_events);
+    if(rejected_events > 0)
+    {
+        LOG_WARNING("[StoryWritingHandle] Story {} keeper rejected {} buffered events", storyId, rejected_events);
+    }
+}
+
 //////////////////
 template <class KeeperChoicePolicy>
 uint64_t chronolog::StoryWritingHandle <KeeperChoicePolicy>::log_event(std::string const &event_record)
 {
     chronolog::LogEvent log_event(storyId, theClient.getTimestamp(), theClient.getClientId()
                                   , theClient.get_event_index(), event_record);
-
-    auto keeperRecordingClient = keeperChoicePolicy->chooseKeeper(storyKeepers, log_event.time());
-    if(nullptr == keeperRecordingClient)   //very unlikely...
+    if(chronolog::EventTracer::isEnabled())
+    { chronolog::EventTracer::getInstance().recordStage(log_event, "log"); }
+    if(theClient.getWorkloadCapture() != nullptr)
+    { theClient.getWorkloadCapture()->recordEvent(storyId, event_record); }
+
+    // the events buffered while the keepers were unreachable go first
+    if(retryBuffer.size() > 0)
+    { flushRetryBuffer(STORY_RETRY_FLUSH_BATCH); }
+
+    int return_code = sendEvent(log_event);
+    // the client over the story's event rate limit backs off, the event keeps its timestamp and index
+    uint64_t backoff_usecs = STORY_THROTTLE_BACKOFF_MIN_USECS;
+    for(int retry = 0; chronolog::CL_ERR_THROTTLED == return_code && retry < STORY_THROTTLE_MAX_RETRIES; ++retry)
     {
-        LOG_WARNING("[StoryWritingHandle] No keeper selected for logging event: {}", event_record);
-        return 0;
+        std::this_thread::sleep_for(std::chrono::microseconds(backoff_usecs));
+        backoff_usecs = std::min <uint64_t>(backoff_usecs * 2, STORY_THROTTLE_BACKOFF_MAX_USECS);
+        return_code = sendEvent(log_event);
+    }
+    if(chronolog::CL_SUCCESS == return_code)
+    {
+        if(chronolog::EventTracer::isEnabled())
+        { chronolog::EventTracer::getInstance().recordStage(log_event, "sent"); }
+        return log_event.eventTime;
     }
 
-    if(chronolog::CL_SUCCESS == keeperRecordingClient->send_event_msg(log_event))
+    // none of the story keepers is reachable or the keeper still throttles the client,
+    // the event is kept for the later retry
+    if((chronolog::CL_ERR_NO_KEEPERS == return_code || chronolog::CL_ERR_THROTTLED == return_code)
+       && retryBuffer.push(log_event))
     { return log_event.eventTime; }
-    else
-    { return 0; }
+
+    LOG_WARNING("[StoryWritingHandle] Story {} event is not recorded : err_code {}", storyId, return_code);
+    return 0;
+}
+/////////////////////
+
+namespace
+{
+
+template <class KeeperChoicePolicy>
+chl::StoryHandle *createStoryWritingHandle(chl::StorytellerClient &client, chl::ChronicleName const &chronicle
+                                           , chl::StoryName const &story, chl::StoryId const &story_id
+                                           , std::vector <chl::KeeperRecordingClient*> const &keeperClients)
+{
+    chl::StoryWritingHandle <KeeperChoicePolicy>*storyWritingHandle = new chl::StoryWritingHandle <KeeperChoicePolicy>(
+            client, chronicle, story, story_id);
+    storyWritingHandle->replaceRecordingClients(keeperClients);
+    return storyWritingHandle;
+}
+
 }
+
 /////////////////////
 
 chronolog::StorytellerClient::~StorytellerClient()
@@ -98,6 +276,9 @@ chronolog::StorytellerClient::~StorytellerClient()
         delete keeper_client.second;
     }
     recordingClientMap.clear();
+
+    if(workloadCapture != nullptr)
+    { delete workloadCapture; }
 }
 
 int chronolog::StorytellerClient::get_event_index()
@@ -124,7 +305,7 @@ int chronolog::StorytellerClient::addKeeperRecordingClient(chronolog::KeeperIdCa
     try
     {
         chronolog::KeeperRecordingClient*keeperRecordingClient = chronolog::KeeperRecordingClient::CreateKeeperRecordingClient(
-                client_engine, keeper_id_card);
+                client_engine, keeper_id_card, theTimer.getHybridClock(), clientId, sharedMemoryTransport);
 
         auto insert_return = recordingClientMap.insert(
                 std::pair <std::pair <uint32_t, uint16_t>, chronolog::KeeperRecordingClient*>(
@@ -196,7 +377,6 @@ chronolog::StorytellerClient::initializeStoryWritingHandle(ChronicleName const &
                                                            , StoryId const &story_id
                                                            , std::vector <KeeperIdCard> const &vectorOfKeepers
                         , chl::ServiceId const & player_card)
-//INNA: TODO :KeeperChoicePolicy will have to be communicated here as well ....
 {
     std::lock_guard <std::mutex> lock(acquiredStoryMapMutex);
 
@@ -207,10 +387,8 @@ chronolog::StorytellerClient::initializeStoryWritingHandle(ChronicleName const &
         return story_record_iter->second;
     }
 
-    // create new StoryWritingHandle & initialize it's keeperClients vector    
-    chronolog::StoryWritingHandle <RoundRobinKeeperChoice>*storyWritingHandle = new StoryWritingHandle <RoundRobinKeeperChoice>(
-            *this, chronicle, story, story_id);
-
+    // collect the story keepers' recording clients
+    std::vector <chl::KeeperRecordingClient*> keeperClients;
     for(KeeperIdCard keeper_id_card: vectorOfKeepers)
     {
         auto keeper_client_iter = recordingClientMap.find(keeper_id_card.getRecordingServiceId().get_service_endpoint());
@@ -226,7 +404,34 @@ chronolog::StorytellerClient::initializeStoryWritingHandle(ChronicleName const &
         }
         keeper_client_iter = recordingClientMap.find(keeper_id_card.getRecordingServiceId().get_service_endpoint());
                 
-        storyWritingHandle->addRecordingClient((*keeper_client_iter).second);
+        keeperClients.push_back((*keeper_client_iter).second);
+    }
+
+    // create new StoryWritingHandle with the configured KeeperChoicePolicy & initialize it's keeperClients vector
+    chronolog::StoryHandle*storyWritingHandle = nullptr;
+    if(keeperChoicePolicy == "timestamp")
+    {
+        storyWritingHandle = createStoryWritingHandle <TimestampKeeperChoice>(*this, chronicle, story, story_id
+                                                                              , keeperClients);
+    }
+    else if(keeperChoicePolicy == "client_sticky")
+    {
+        storyWritingHandle = createStoryWritingHandle <ClientStickyKeeperChoice>(*this, chronicle, story, story_id
+                                                                                 , keeperClients);
+    }
+    else if(keeperChoicePolicy == "least_outstanding")
+    {
+        storyWritingHandle = createStoryWritingHandle <LeastOutstandingKeeperChoice>(*this, chronicle, story, story_id
+                                                                                     , keeperClients);
+    }
+    else
+    {
+        if(keeperChoicePolicy != "round_robin")
+        {
+            LOG_WARNING("[StorytellerClient] Unknown KeeperChoicePolicy '{}', using round_robin", keeperChoicePolicy);
+        }
+        storyWritingHandle = createStoryWritingHandle <RoundRobinKeeperChoice>(*this, chronicle, story, story_id
+                                                                               , keeperClients);
     }
 
     auto insert_return = acquiredStoryHandles.insert(
@@ -240,6 +445,9 @@ chronolog::StorytellerClient::initializeStoryWritingHandle(ChronicleName const &
         return nullptr;
     }
 
+    if(workloadCapture != nullptr)
+    { workloadCapture->recordAcquireStory(chronicle, story, story_id); }
+
     LOG_INFO("[StorytellerClient] Successfully initialized StoryWritingHandle for Chronicle: '{}' and Story: '{}'."
          , chronicle, story);
     return storyWritingHandle;
@@ -256,6 +464,49 @@ chronolog::StorytellerClient::initializeStoryWritingHandle(ChronicleName const &
     */
 }
 
+//////////////////////
+int chronolog::StorytellerClient::refreshStoryKeepers(ChronicleName const &chronicle, StoryName const &story
+                                                      , std::vector <chl::KeeperRecordingClient*> &keeperClients)
+{
+    keeperClients.clear();
+    if(rpcVisorClient == nullptr)
+    { return chronolog::CL_ERR_NO_CONNECTION; }
+
+    chronolog::AcquireStoryResponseMsg response = rpcVisorClient->RefreshStory(clientId, chronicle, story);
+    theTimer.mergeRemoteTime(response.getClockTime());
+    if(response.getErrorCode() != chronolog::CL_SUCCESS)
+    { return response.getErrorCode(); }
+
+    for(KeeperIdCard const &keeper_id_card: response.getKeepers())
+    {
+        auto endpoint = keeper_id_card.getRecordingServiceId().get_service_endpoint();
+        {
+            std::lock_guard <std::mutex> lock(recordingClientMapMutex);
+            auto keeper_client_iter = recordingClientMap.find(endpoint);
+            if(keeper_client_iter != recordingClientMap.end())
+            {
+                keeperClients.push_back((*keeper_client_iter).second);
+                continue;
+            }
+        }
+
+        // the keepers of the new RecordingGroup might not be known to this client yet
+        if(addKeeperRecordingClient(keeper_id_card) == 0)
+        {
+            LOG_WARNING("[StorytellerClient] Failed to add KeeperRecordingClient for {}", to_string(keeper_id_card));
+            continue;
+        }
+        std::lock_guard <std::mutex> lock(recordingClientMapMutex);
+        auto keeper_client_iter = recordingClientMap.find(endpoint);
+        if(keeper_client_iter != recordingClientMap.end())
+        { keeperClients.push_back((*keeper_client_iter).second); }
+    }
+
+    LOG_INFO("[StorytellerClient] Refreshed keepers for Chronicle: '{}' and Story: '{}': {} keepers", chronicle, story
+         , keeperClients.size());
+    return chronolog::CL_SUCCESS;
+}
+
 //////////////////////
 void chronolog::StorytellerClient::removeAcquiredStoryHandle(ChronicleName const &chronicle, StoryName const &story)
 {
@@ -266,6 +517,8 @@ void chronolog::StorytellerClient::removeAcquiredStoryHandle(ChronicleName const
     {
         delete (*story_record_iter).second;
         acquiredStoryHandles.erase(story_record_iter);
+        if(workloadCapture != nullptr)
+        { workloadCapture->recordReleaseStory(chronicle, story); }
         LOG_INFO("[StorytellerClient] Successfully removed StoryHandle for Chronicle: '{}' and Story: '{}'.", chronicle
              , story);
     }
@@ -4,47 +4,145 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <thallium.hpp>
 #include "chrono_monitor.h"
 #include "KeeperIdCard.h"
 #include "chronolog_types.h"
 #include "chronolog_client.h"
+#include "HybridLogicalClock.h"
+#include "EventTracer.h"
+#include "WorkloadTrace.h"
+#include "KeeperFailover.h"
+
+// events kept by the story writing handle while none of the story keepers is reachable or the keeper throttles them
+#define STORY_RETRY_BUFFER_SIZE 8192
+// buffered events resent by a log_event call before its own event, so that the writer thread isn't held up for long
+#define STORY_RETRY_FLUSH_BATCH 64
+// the event throttled by the keeper is resent after a backoff doubling from the min to the max,
+// if the keeper still throttles it after the max retries it goes to the retry buffer
+#define STORY_THROTTLE_BACKOFF_MIN_USECS 1000
+#define STORY_THROTTLE_BACKOFF_MAX_USECS 64000
+#define STORY_THROTTLE_MAX_RETRIES 8
 
 namespace chronolog
 {
 
+// ChronologTimer provides the event timestamps of the client process:
+// "physical" reads the local clock, "hlc" runs the hybrid logical clock that merges the clocks
+// the Keepers and the Visor piggyback on their rpc responses, bounding the clock skew between the clients
 class ChronologTimer
 {
 public:
+    explicit ChronologTimer(std::string const &clock_mode = "physical")
+        : useHybridClock(clock_mode == "hlc")
+    {}
+
     uint64_t getTimestamp();
+
+    void mergeRemoteTime(uint64_t remote_time)
+    {
+        if(useHybridClock)
+        { hybridClock.update(remote_time); }
+    }
+
+    // the clock the recording clients merge the keeper clocks into, nullptr in physical clock mode
+    HybridLogicalClock*getHybridClock()
+    { return (useHybridClock ? &hybridClock : nullptr); }
+
+private:
+    bool useHybridClock;
+    HybridLogicalClock hybridClock;
 };
 
 class KeeperRecordingClient;
 class PlaybackQueryRpcClient;
+class RpcVisorClient;
+
+// KeeperChoicePolicy picks the story keeper the next event is sent to;
+// the policies are selected by the keeper_choice_policy client configuration option
+
+// the keeper at the event timestamp modulo the number of keepers, the original choice:
+// skewed with the coarse clocks or bursty timestamps, and every client hits the same keeper on the same tick
+class TimestampKeeperChoice
+{
+public:
+    KeeperRecordingClient*
+    chooseKeeper(std::vector <KeeperRecordingClient*> const &vectorOfKeepers, LogEvent const &log_event)
+    {
+        return vectorOfKeepers[log_event.time() % vectorOfKeepers.size()];
+    }
+};
 
+// the story keepers take turns, counted per story handle
 class RoundRobinKeeperChoice
 {
 public:
     KeeperRecordingClient*
-    chooseKeeper(std::vector <KeeperRecordingClient*> const &vectorOfKeepers, uint64_t chrono_tick)
+    chooseKeeper(std::vector <KeeperRecordingClient*> const &vectorOfKeepers, LogEvent const &)
     {
-        return vectorOfKeepers[chrono_tick % vectorOfKeepers.size()];
+        return vectorOfKeepers[nextKeeper++ % vectorOfKeepers.size()];
     }
+
+private:
+    std::atomic <uint64_t> nextKeeper{0};
 };
 
+// all the events the client writes to the story go to the same keeper, chosen by hashing the client and story ids,
+// which keeps the keeper side story chunks large and spreads the clients of the story over its keepers
+class ClientStickyKeeperChoice
+{
+public:
+    KeeperRecordingClient*
+    chooseKeeper(std::vector <KeeperRecordingClient*> const &vectorOfKeepers, LogEvent const &log_event)
+    {
+        uint64_t key = (log_event.getClientId() ^ (log_event.getStoryId() * 0x9E3779B97F4A7C15ULL)) * 0x9E3779B97F4A7C15ULL;
+        return vectorOfKeepers[(key >> 32) % vectorOfKeepers.size()];
+    }
+};
+
+// the keeper with the fewest record_event requests in flight from this client process,
+// the scan starts at a rotating position so that the idle keepers take turns
+class LeastOutstandingKeeperChoice
+{
+public:
+    KeeperRecordingClient*
+    chooseKeeper(std::vector <KeeperRecordingClient*> const &vectorOfKeepers, LogEvent const &);
+
+private:
+    std::atomic <uint64_t> nextKeeper{0};
+};
 
 class StorytellerClient
 {
 public:
+    // keeper_choice_policy : "round_robin", "timestamp", "client_sticky" or "least_outstanding"
+    // the workload is captured into workload_capture_file unless it's empty, see WorkloadTraceWriter;
+    // shared_memory_transport sends the events to the keepers on the client node through the SharedEventRings
     StorytellerClient(ChronologTimer &chronolog_timer 
            , thallium::engine &client_tl_engine
-           , ClientId const &client_id)
+           , ClientId const &client_id
+           , RpcVisorClient *rpc_visor_client
+           , std::string const &keeper_choice_policy = "round_robin"
+           , std::string const &workload_capture_file = ""
+           , bool capture_payloads = false
+           , bool shared_memory_transport = true)
         : theTimer(chronolog_timer)
         , client_engine(client_tl_engine)
         , clientId(client_id)
+        , rpcVisorClient(rpc_visor_client)
+        , keeperChoicePolicy(keeper_choice_policy)
+        , workloadCapture(nullptr)
+        , sharedMemoryTransport(shared_memory_transport)
     {
-        LOG_DEBUG("[StorytellerClient] Initialized with ClientID: {}", clientId);
+        if(!workload_capture_file.empty())
+        { workloadCapture = WorkloadTraceWriter::CreateWorkloadTraceWriter(workload_capture_file, capture_payloads); }
+        LOG_DEBUG("[StorytellerClient] Initialized with ClientID: {}, KeeperChoicePolicy: {}", clientId
+                  , keeperChoicePolicy);
     }
 
     ~StorytellerClient();
@@ -59,14 +157,25 @@ public:
 
     void removeAcquiredStoryHandle(ChronicleName const &, StoryName const &);
 
+    // asks ChronoVisor for the current recording keepers of the story that has been migrated
+    // to another RecordingGroup and returns their recording clients
+    int refreshStoryKeepers(ChronicleName const &, StoryName const &, std::vector <KeeperRecordingClient*> &);
+
     uint64_t getTimestamp()
     { return theTimer.getTimestamp(); }
 
+    void mergeRemoteTime(uint64_t remote_time)
+    { theTimer.mergeRemoteTime(remote_time); }
+
     ClientId const &getClientId() const
     { return clientId; }
 
     int get_event_index();
 
+    // nullptr unless the workload capture is on
+    WorkloadTraceWriter*getWorkloadCapture()
+    { return workloadCapture; }
+
  //   ServiceId const& get_local_service_id() const    { return theClientQueryService.get_service_id(); }
 
 private:
@@ -77,7 +186,11 @@ private:
     ChronologTimer &theTimer;
     thallium::engine & client_engine;
     ClientId clientId;
+    RpcVisorClient *rpcVisorClient;
+    std::string keeperChoicePolicy;
     std::atomic <int> atomic_index;
+    WorkloadTraceWriter*workloadCapture;
+    bool sharedMemoryTransport;
 
     std::mutex recordingClientMapMutex;
     std::mutex acquiredStoryMapMutex;
@@ -97,6 +210,7 @@ public:
         : theClient(client)
         , chronicle(a_chronicle), story(a_story), storyId(story_id)
         , keeperChoicePolicy(new KeeperChoicePolicy)
+        , storyKeepers(new std::vector <KeeperRecordingClient*>())
      //   , playbackQueryClient(nullptr)
     {
         LOG_DEBUG("[StoryWritingHandle] Initialized for Chronicle: {}, Story: {}", a_chronicle, a_story);
@@ -110,15 +224,40 @@ public:
 
     void addRecordingClient(KeeperRecordingClient*);
     void removeRecordingClient(KeeperIdCard const &);
+    void replaceRecordingClients(std::vector <KeeperRecordingClient*> const &);
 
 private:
 
+    // switches to the story's new keepers once redirected by the keeper the story migrated away from
+    void refreshRecordingClients(KeeperRecordingClient*);
+
+    typedef std::shared_ptr <std::vector <KeeperRecordingClient*> const> KeeperListSnapshot;
+
+    // publishes the new list of the story keepers to the writer threads, the caller holds storyKeepersMutex;
+    // the writer threads still reading the previous list hold their own snapshots of it
+    void publishRecordingClients(std::vector <KeeperRecordingClient*> *);
+
+    KeeperListSnapshot getRecordingClients() const;
+
+    // sends the event to the keeper chosen by the policy, failing over to the other available story keepers
+    // if it is unreachable; returns CL_ERR_NO_KEEPERS if none of them could take the event
+    int sendEvent(LogEvent const &);
+
+    // resends up to max_events buffered events, stops at the first one that still can't reach a keeper
+    void flushRetryBuffer(size_t max_events);
+
     StorytellerClient &theClient;
     ChronicleName chronicle;
     StoryName story;
     StoryId storyId;
     KeeperChoicePolicy*keeperChoicePolicy;
-    std::vector <KeeperRecordingClient*> storyKeepers;
+    // the writer threads read the current keeper list without locking,
+    // the rare keeper list changes (keeper exit, story migration) are serialized by storyKeepersMutex
+    std::mutex storyKeepersMutex;
+    std::mutex keepersRefreshMutex;
+    KeeperListSnapshot storyKeepers;   // accessed with std::atomic_load / std::atomic_store only
+    // the events that couldn't reach any keeper are retried later with their original timestamp and index
+    EventRetryBuffer retryBuffer{STORY_RETRY_BUFFER_SIZE};
     
 };
 
@@ -171,6 +171,31 @@ public:
         return (AcquireStoryResponseMsg(chronolog::CL_ERR_UNKNOWN, 0, std::vector <KeeperIdCard>{}));
     }
 
+    // current recording keepers of the acquired story, the keepers redirect the clients here after story migration
+    chronolog::AcquireStoryResponseMsg
+    RefreshStory(ClientId const &client_id, std::string const &chronicle_name, std::string const &story_name)
+    {
+        LOG_DEBUG("[RPCVisorClient] Refreshing story keepers: ChronicleName={}, StoryName={}", chronicle_name.c_str()
+             , story_name.c_str());
+        try
+        {
+            chronolog::AcquireStoryResponseMsg response = refresh_story.on(service_ph)(client_id, chronicle_name
+                                                                                       , story_name);
+            if(response.getErrorCode() != chronolog::CL_SUCCESS)
+            {
+                LOG_ERROR("[RPCVisorClient] Failed to refresh story: ChronicleName={}, StoryName={}, Error Code={}"
+                     , chronicle_name.c_str(), story_name.c_str(), chronolog::to_string_client(response.getErrorCode()));
+            }
+            return response;
+        }
+        catch(tl::exception const &)
+        {
+            LOG_ERROR("[RPCVisorClient] Failed to refresh story {} from chronicle {}. Thallium exception encountered."
+                 , story_name.c_str(), chronicle_name.c_str());
+        }
+        return (AcquireStoryResponseMsg(chronolog::CL_ERR_UNKNOWN, 0, std::vector <KeeperIdCard>{}));
+    }
+
     int ReleaseStory(ClientId const &client_id, std::string const &chronicle_name, std::string const &story_name)
     {
         LOG_INFO("[RPCVisorClient] Initiating story release: ChronicleName={}, StoryName={}", chronicle_name.c_str()
@@ -200,6 +225,55 @@ public:
         return (chronolog::CL_ERR_UNKNOWN);
     }
 
+    std::vector <chronolog::AcquireStoryResponseMsg>
+    AcquireStories(ClientId const &client_id, std::string const &chronicle_name
+                   , std::vector <std::string> const &story_names, const std::map <std::string, std::string> &attrs
+                   , const int &flags)
+    {
+        LOG_INFO("[RPCVisorClient] Initiating acquisition of {} stories: ChronicleName={}", story_names.size()
+             , chronicle_name.c_str());
+        try
+        {
+            std::vector <chronolog::AcquireStoryResponseMsg> responses = acquire_stories.on(service_ph)(
+                    client_id, chronicle_name, story_names, attrs, flags);
+            if(responses.size() == story_names.size())
+            { return responses; }
+
+            LOG_ERROR("[RPCVisorClient] Failed to acquire stories from chronicle {}: {} responses for {} stories"
+                 , chronicle_name.c_str(), responses.size(), story_names.size());
+        }
+        catch(tl::exception const &)
+        {
+            LOG_ERROR("[RPCVisorClient] Failed to acquire {} stories from chronicle {}. Thallium exception encountered."
+                 , story_names.size(), chronicle_name.c_str());
+        }
+        return std::vector <chronolog::AcquireStoryResponseMsg>(
+                story_names.size(), AcquireStoryResponseMsg(chronolog::CL_ERR_UNKNOWN, 0, std::vector <KeeperIdCard>{}));
+    }
+
+    std::vector <int>
+    ReleaseStories(ClientId const &client_id, std::string const &chronicle_name
+                   , std::vector <std::string> const &story_names)
+    {
+        LOG_INFO("[RPCVisorClient] Initiating release of {} stories: ChronicleName={}", story_names.size()
+             , chronicle_name.c_str());
+        try
+        {
+            std::vector <int> return_codes = release_stories.on(service_ph)(client_id, chronicle_name, story_names);
+            if(return_codes.size() == story_names.size())
+            { return return_codes; }
+
+            LOG_ERROR("[RPCVisorClient] Failed to release stories from chronicle {}: {} return codes for {} stories"
+                 , chronicle_name.c_str(), return_codes.size(), story_names.size());
+        }
+        catch(tl::exception const &)
+        {
+            LOG_ERROR("[RPCVisorClient] Failed to release {} stories from chronicle {}. Thallium exception encountered."
+                 , story_names.size(), chronicle_name.c_str());
+        }
+        return std::vector <int>(story_names.size(), chronolog::CL_ERR_UNKNOWN);
+    }
+
     int DestroyStory(ClientId const &client_id, std::string const &chronicle_name, std::string const &story_name)
     {
         LOG_INFO("[RPCVisorClient] Initiating story destruction: ChronicleName={}, StoryName={}", chronicle_name.c_str()
@@ -354,6 +428,9 @@ public:
         edit_chronicle_attr.deregister();
         acquire_story.deregister();
         release_story.deregister();
+        refresh_story.deregister();
+        acquire_stories.deregister();
+        release_stories.deregister();
         destroy_story.deregister();
         show_chronicles.deregister();
         show_stories.deregister();
@@ -371,6 +448,9 @@ private:
     tl::remote_procedure edit_chronicle_attr;
     tl::remote_procedure acquire_story;
     tl::remote_procedure release_story;
+    tl::remote_procedure refresh_story;
+    tl::remote_procedure acquire_stories;
+    tl::remote_procedure release_stories;
     tl::remote_procedure destroy_story;
     tl::remote_procedure show_chronicles;
     tl::remote_procedure show_stories;
@@ -393,6 +473,9 @@ private:
         edit_chronicle_attr = tl_engine.define("EditChronicleAttr");
         acquire_story = tl_engine.define("AcquireStory");
         release_story = tl_engine.define("ReleaseStory");
+        refresh_story = tl_engine.define("RefreshStory");
+        acquire_stories = tl_engine.define("AcquireStories");
+        release_stories = tl_engine.define("ReleaseStories");
         destroy_story = tl_engine.define("DestroyStory");
         show_chronicles = tl_engine.define("ShowChronicles");
         show_stories = tl_engine.define("ShowStories");
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Compares the record-event throughput of the client keeper choice policies:
+# runs the same shared story workload once per policy and prints a summary table
+
+POLICIES="round_robin timestamp client_sticky least_outstanding"
+REP=3
+EVENT_SIZE_MIN=4096
+EVENT_SIZE_MAX=4096
+EVENT_SIZE_AVE=4096
+EVENT_COUNT=10000
+STORY_COUNT=1
+CHRONICLE_COUNT=1
+BARRIER=true
+
+NUM_NODES=4
+NUM_PROCS=16
+BUILD_TYPE=Release
+CHRONOLOG_INSTALL_DIR=/home/${USER}/chronolog/${BUILD_TYPE}
+CHRONOLOG_BIN_DIR=${CHRONOLOG_INSTALL_DIR}/bin
+CHRONOLOG_LIB_DIR=${CHRONOLOG_INSTALL_DIR}/lib
+HOST_FILE=${CHRONOLOG_INSTALL_DIR}/conf/hosts_client
+CLIENT_ADMIN_BIN=${CHRONOLOG_BIN_DIR}/client_admin
+MPIEXEC_BIN="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)/../../.spack-env/view/bin/mpiexec"
+CONF_FILE=${CHRONOLOG_INSTALL_DIR}/conf/default_client_conf.json
+OUTPUT_LOG_FILE=./keeper_choice_test.log
+
+[[ -f ${HOST_FILE} ]] || { echo "Host file not found: ${HOST_FILE}"; exit 1; }
+[[ -f ${CLIENT_ADMIN_BIN} ]] || { echo "client_admin binary not found: ${CLIENT_ADMIN_BIN}"; exit 1; }
+[[ -f ${MPIEXEC_BIN} ]] || { echo "mpiexec binary not found: ${MPIEXEC_BIN}"; exit 1; }
+[[ -f ${CONF_FILE} ]] || { echo "Configuration file not found: ${CONF_FILE}"; exit 1; }
+
+rm -f ${OUTPUT_LOG_FILE}
+rm -f ${HOST_FILE}.*
+
+head -${NUM_NODES} ${HOST_FILE} > "${HOST_FILE}.${NUM_NODES}"
+# all the processes write to the same story so that the policies spread one story's events over its keepers
+cli_args="-a ${EVENT_SIZE_MIN} -b ${EVENT_SIZE_MAX} -s ${EVENT_SIZE_AVE} -n ${EVENT_COUNT} -t ${STORY_COUNT} -h ${CHRONICLE_COUNT} -p -o"
+[[ "${BARRIER}" == "true" ]] && cli_args+=" -r"
+
+for policy in ${POLICIES}
+do
+    # the client configuration with the keeper_choice_policy set for this run
+    policy_conf_file="${OUTPUT_LOG_FILE%.log}.${policy}.json"
+    python3 -c "import json,sys; conf=json.load(open(sys.argv[1])); \
+conf['chrono_client']['VisorClientPortalService']['keeper_choice_policy']=sys.argv[2]; \
+json.dump(conf, open(sys.argv[3], 'w'), indent=2)" "${CONF_FILE}" "${policy}" "${policy_conf_file}" \
+        || { echo "Failed to write configuration file for policy ${policy}"; exit 1; }
+
+    for i in $(seq 1 ${REP})
+    do
+        echo "======================================================================================" >> ${OUTPUT_LOG_FILE}
+        echo "Policy ${policy} Iteration ${i}" >> ${OUTPUT_LOG_FILE}
+        echo LD_LIBRARY_PATH=${CHRONOLOG_LIB_DIR} ${MPIEXEC_BIN} -n ${NUM_PROCS} -f "${HOST_FILE}.${NUM_NODES}" \
+            "${CLIENT_ADMIN_BIN}" -c "${policy_conf_file}" ${cli_args}
+        LD_LIBRARY_PATH=${CHRONOLOG_LIB_DIR} ${MPIEXEC_BIN} -n ${NUM_PROCS} -f "${HOST_FILE}.${NUM_NODES}" \
+            "${CLIENT_ADMIN_BIN}" -c "${policy_conf_file}" ${cli_args} >>${OUTPUT_LOG_FILE} 2>&1
+    done
+    rm -f "${policy_conf_file}"
+done
+
+# average record-event throughput of each policy over the repetitions
+echo "Keeper choice policy record-event throughput (events/s, average of ${REP} runs):"
+awk '/^Policy /{policy=$2}
+     /Record-event \(incl. metadata time\) throughput:/{sum[policy]+=$(NF-1); count[policy]++}
+     END{for(p in sum) printf "  %-20s %.1f\n", p, sum[p]/count[p]}' ${OUTPUT_LOG_FILE}
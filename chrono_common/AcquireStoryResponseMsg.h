@@ -15,6 +15,7 @@ class AcquireStoryResponseMsg
     StoryId storyId;
     std::vector <KeeperIdCard> keepers;
     ServiceId player;
+    uint64_t clockTime;     // the Visor clock for the client running the hybrid logical clock
 
 public:
 
@@ -22,6 +23,7 @@ public:
         : error_code(chronolog::CL_SUCCESS)
         , storyId(0)
         , player(ServiceId())
+        , clockTime(0)
     {}
 
     AcquireStoryResponseMsg(int code, StoryId const &story_id, std::vector <KeeperIdCard> const &keepers_to_use
@@ -30,6 +32,7 @@ public:
         , storyId(story_id)
         , keepers(keepers_to_use)
         , player(player_to_use)
+        , clockTime(0)
     {}
 
     ~AcquireStoryResponseMsg() = default;
@@ -46,6 +49,12 @@ public:
     ServiceId const& getPlayer() const
     { return player; }
 
+    uint64_t getClockTime() const
+    { return clockTime; }
+
+    void setClockTime(uint64_t clock_time)
+    { clockTime = clock_time; }
+
     template <typename SerArchiveT>
     void serialize(SerArchiveT &serT)
     {
@@ -53,6 +62,7 @@ public:
         serT & storyId;
         serT & keepers;
         serT & player;
+        serT & clockTime;
     }
 
 };
@@ -0,0 +1,54 @@
+#ifndef AGGREGATION_RESPONSE_MSG_H
+#define AGGREGATION_RESPONSE_MSG_H
+
+#include <iostream>
+#include <vector>
+#include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::AggregationBucket definition
+
+namespace chronolog
+{
+
+class AggregationResponseMsg
+{
+    int error_code;
+    std::vector <AggregationBucket> buckets;
+
+public:
+
+    AggregationResponseMsg()
+        : error_code(chronolog::CL_SUCCESS)
+    {}
+
+    AggregationResponseMsg(int code, std::vector <AggregationBucket> const &result_buckets = std::vector <AggregationBucket>())
+        : error_code(code)
+        , buckets(result_buckets)
+    {}
+
+    ~AggregationResponseMsg() = default;
+
+    int getErrorCode() const
+    { return error_code; }
+
+    std::vector <AggregationBucket> const &getBuckets() const
+    { return buckets; }
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & error_code;
+        serT & buckets;
+    }
+
+};
+
+}//namespace
+
+
+inline std::ostream &operator<<(std::ostream &out, chronolog::AggregationResponseMsg const &msg)
+{
+    out << "AggregationResponseMsg{" << msg.getErrorCode() << "}{buckets:" << msg.getBuckets().size() << "}";
+    return out;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef CHRONOLOG_BINARY_ENCODING_H
+#define CHRONOLOG_BINARY_ENCODING_H
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace chronolog
+{
+
+// fixed width host byte order encoding of the trivially copyable values,
+// used by the versioned binary forms of the summaries and sketches persisted in the archive
+
+template <typename T>
+inline void appendValue(std::string &buffer, T const &value)
+{
+    buffer.append(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+
+// returns false and leaves the buffer as is if it is too short for the value
+template <typename T>
+inline bool consumeValue(std::string_view &buffer, T &value)
+{
+    if(buffer.size() < sizeof(T))
+    { return false; }
+    std::memcpy(&value, buffer.data(), sizeof(T));
+    buffer.remove_prefix(sizeof(T));
+    return true;
+}
+
+}
+
+#endif
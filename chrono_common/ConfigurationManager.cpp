@@ -189,6 +189,21 @@ int chronolog::LogConf::parseJsonConf(json_object*json_conf)
                     assert(json_object_is_type(val, json_type_string));
                     parseFlushLevelConf(val, FLUSHLEVEL);
                 }
+                else if(strcmp(key, "async") == 0)
+                {
+                    assert(json_object_is_type(val, json_type_boolean));
+                    ASYNC = json_object_get_boolean(val);
+                }
+                else if(strcmp(key, "module_levels") == 0)
+                {
+                    assert(json_object_is_type(val, json_type_object));
+                    json_object_object_foreach(val, module_name, module_level)
+                    {
+                        spdlog::level::level_enum level = LOGLEVEL;
+                        parselogLevelConf(module_level, level);
+                        MODULE_LEVELS[module_name] = level;
+                    }
+                }
                 else
                 {
                     std::cerr << "[LogConf] Unknown log configuration: " << key << std::endl;
@@ -251,6 +266,44 @@ return 1;
                 DELAYED_DATA_ADMIN_EXIT_IN_SECS = ((0 < delayed_exit_value && delayed_exit_value < 60)
                                                               ? delayed_exit_value : 5);
             }
+            else if(strcmp(key, "group_placement_policy") == 0)
+            {
+                assert(json_object_is_type(val, json_type_string));
+                GROUP_PLACEMENT_POLICY = json_object_get_string(val);
+            }
+            else if(strcmp(key, "story_rebalancing_ratio_percent") == 0)
+            {
+                assert(json_object_is_type(val, json_type_int));
+                int rebalancing_ratio = json_object_get_int(val);
+                // the most loaded group has to be above the mean group load for the rebalancing to make sense
+                if(rebalancing_ratio == 0 || rebalancing_ratio > 100)
+                {
+                    STORY_REBALANCING_RATIO_PERCENT = rebalancing_ratio;
+                }
+                else
+                {
+                    std::cerr << "[ConfigurationManager] [chrono_visor] Invalid story_rebalancing_ratio_percent "
+                              << rebalancing_ratio << ", expected 0 to disable the rebalancing or a value above 100; "
+                              << "using " << STORY_REBALANCING_RATIO_PERCENT << std::endl;
+                }
+            }
+            else if(strcmp(key, "metadata_store_dir") == 0)
+            {
+                assert(json_object_is_type(val, json_type_string));
+                METADATA_STORE_DIR = json_object_get_string(val);
+            }
+            else if(strcmp(key, "metadata_snapshot_interval_records") == 0)
+            {
+                assert(json_object_is_type(val, json_type_int));
+                int snapshot_interval = json_object_get_int(val);
+                METADATA_SNAPSHOT_INTERVAL_RECORDS = (snapshot_interval > 0 ? snapshot_interval : 100000);
+            }
+            else if(strcmp(key, "story_notification_timeout_msec") == 0)
+            {
+                assert(json_object_is_type(val, json_type_int));
+                int notification_timeout = json_object_get_int(val);
+                STORY_NOTIFICATION_TIMEOUT_MSEC = (notification_timeout > 0 ? notification_timeout : 1500);
+            }
             else
             {
                 std::cerr << "[VisorConfiguration] Unknown Visor configuration: " << key << std::endl;
@@ -382,6 +435,24 @@ return 1;
                     }
                 }
             }
+            else if(strcmp(key, "Metrics") == 0)
+            {
+                assert(json_object_is_type(val, json_type_object));
+                json_object*metrics_conf = json_object_object_get(json_conf, "Metrics");
+                METRICS_CONF.parseJsonConf(metrics_conf);
+            }
+            else if(strcmp(key, "Tracing") == 0)
+            {
+                assert(json_object_is_type(val, json_type_object));
+                json_object*tracing_conf = json_object_object_get(json_conf, "Tracing");
+                TRACING_CONF.parseJsonConf(tracing_conf);
+            }
+            else if(strcmp(key, "CorePlacement") == 0)
+            {
+                assert(json_object_is_type(val, json_type_object));
+                json_object*core_placement_conf = json_object_object_get(json_conf, "CorePlacement");
+                CORE_PLACEMENT_CONF.parseJsonConf(core_placement_conf);
+            }
             else
             {
                 std::cerr << "[ConfigurationManager] [chrono_keeper] Unknown Keeper configuration: "
@@ -420,6 +491,25 @@ int chronolog::GrapherConfiguration::parseJsonConf(json_object*json_conf)
                 }
             }
         }
+        else if(strcmp(key, "GrapherPlayerDrainService") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*grapher_player_drain_service_conf = json_object_object_get(json_conf
+                                                                                   , "GrapherPlayerDrainService");
+            json_object_object_foreach(grapher_player_drain_service_conf, key, val)
+            {
+                if(strcmp(key, "rpc") == 0)
+                {
+                    GRAPHER_PLAYER_DRAIN_SERVICE_CONF.parseJsonConf(val);
+                }
+                else
+                {
+                    std::cerr
+                            << "[GrapherConfiguration] Unknown GrapherPlayerDrainService configuration: "
+                            << key << std::endl;
+                }
+            }
+        }
         else if(strcmp(key, "DataStoreAdminService") == 0)
         {
             assert(json_object_is_type(val, json_type_object));
@@ -491,6 +581,11 @@ int chronolog::GrapherConfiguration::parseJsonConf(json_object*json_conf)
                     assert(json_object_is_type(val, json_type_string));
                     EXTRACTOR_CONF.story_files_dir = json_object_get_string(val);
                 }
+                else if(strcmp(key, "record_encoding") == 0)
+                {
+                    assert(json_object_is_type(val, json_type_string));
+                    EXTRACTOR_CONF.record_encoding = json_object_get_string(val);
+                }
                 else
                 {
                     std::cerr << "[GrapherConfiguration] Unknown Extractors configuration " << key
@@ -498,6 +593,24 @@ int chronolog::GrapherConfiguration::parseJsonConf(json_object*json_conf)
                 }
             }
         }
+        else if(strcmp(key, "Metrics") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*metrics_conf = json_object_object_get(json_conf, "Metrics");
+            METRICS_CONF.parseJsonConf(metrics_conf);
+        }
+        else if(strcmp(key, "Tracing") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*tracing_conf = json_object_object_get(json_conf, "Tracing");
+            TRACING_CONF.parseJsonConf(tracing_conf);
+        }
+        else if(strcmp(key, "CorePlacement") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*core_placement_conf = json_object_object_get(json_conf, "CorePlacement");
+            CORE_PLACEMENT_CONF.parseJsonConf(core_placement_conf);
+        }
         else
         {
             std::cerr << "[GrapherConfiguration] Unknown Grapher configuration " << key << std::endl;
@@ -552,6 +665,24 @@ int chronolog::PlayerConfiguration::parseJsonConf(json_object*json_conf)
                 }
             }
         }
+        else if(strcmp(key, "GrapherPlayerDrainService") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object* grapher_player_drain_service_conf = json_object_object_get(json_conf
+                                                                                    , "GrapherPlayerDrainService");
+            json_object_object_foreach(grapher_player_drain_service_conf, key, val)
+            {
+                if(strcmp(key, "rpc") == 0)
+                {
+                    GRAPHER_PLAYER_DRAIN_SERVICE_CONF.parseJsonConf(val);
+                }
+                else
+                {
+                    std::cerr << "[ConfigurationManager] [chrono_player] Unknown GrapherPlayerDrainService configuration: "
+                              << key << std::endl;
+                }
+            }
+        }
         else if(strcmp(key, "VisorRegistryService") == 0)
         {
             assert(json_object_is_type(val, json_type_object));
@@ -611,6 +742,18 @@ int chronolog::PlayerConfiguration::parseJsonConf(json_object*json_conf)
                 }
             }
         }
+        else if(strcmp(key, "Metrics") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*metrics_conf = json_object_object_get(json_conf, "Metrics");
+            METRICS_CONF.parseJsonConf(metrics_conf);
+        }
+        else if(strcmp(key, "CorePlacement") == 0)
+        {
+            assert(json_object_is_type(val, json_type_object));
+            json_object*core_placement_conf = json_object_object_get(json_conf, "CorePlacement");
+            CORE_PLACEMENT_CONF.parseJsonConf(core_placement_conf);
+        }
         else
         {
             std::cerr << "[ConfigurationManager][chrono_player] Unknown Player configuration " << key << std::endl;
@@ -651,3 +794,82 @@ int chronolog::DataStoreConf::parseJsonConf(json_object* data_store_json_conf)
 
 return 1;
 }
+
+int chronolog::MetricsConf::parseJsonConf(json_object* metrics_json_conf)
+{
+    json_object_object_foreach(metrics_json_conf, key, val)
+    {
+        if(strcmp(key, "dump_file") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            dump_file = json_object_get_string(val);
+        }
+        else if(strcmp(key, "dump_interval_secs") == 0)
+        {
+            assert(json_object_is_type(val, json_type_int));
+            dump_interval_secs = json_object_get_int(val);
+        }
+        else
+        {
+            std::cerr << "[MetricsConf] Unknown Metrics configuration: " << key << std::endl;
+        }
+    }
+
+return 1;
+}
+
+int chronolog::TracingConf::parseJsonConf(json_object* tracing_json_conf)
+{
+    json_object_object_foreach(tracing_json_conf, key, val)
+    {
+        if(strcmp(key, "sample_every") == 0)
+        {
+            assert(json_object_is_type(val, json_type_int));
+            sample_every = json_object_get_int(val);
+        }
+        else if(strcmp(key, "trace_file") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            trace_file = json_object_get_string(val);
+        }
+        else
+        {
+            std::cerr << "[TracingConf] Unknown Tracing configuration: " << key << std::endl;
+        }
+    }
+
+return 1;
+}
+
+int chronolog::CorePlacementConf::parseJsonConf(json_object* core_placement_json_conf)
+{
+    json_object_object_foreach(core_placement_json_conf, key, val)
+    {
+        if(strcmp(key, "rpc_cores") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            rpc_cores = json_object_get_string(val);
+        }
+        else if(strcmp(key, "sequencing_cores") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            sequencing_cores = json_object_get_string(val);
+        }
+        else if(strcmp(key, "extraction_cores") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            extraction_cores = json_object_get_string(val);
+        }
+        else if(strcmp(key, "io_cores") == 0)
+        {
+            assert(json_object_is_type(val, json_type_string));
+            io_cores = json_object_get_string(val);
+        }
+        else
+        {
+            std::cerr << "[CorePlacementConf] Unknown CorePlacement configuration: " << key << std::endl;
+        }
+    }
+
+return 1;
+}
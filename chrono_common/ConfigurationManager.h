@@ -6,6 +6,7 @@
 #include <fstream>
 #include <iostream>
 #include <cassert>
+#include <map>
 #include <unordered_map>
 #include <json-c/json.h>
 #include <sstream>
@@ -86,6 +87,8 @@ struct LogConf
     size_t LOGFILESIZE{};
     size_t LOGFILENUM{};
     spdlog::level::level_enum FLUSHLEVEL{};
+    bool ASYNC = false;  // write the messages to the sink from a background thread
+    std::map <std::string, spdlog::level::level_enum> MODULE_LEVELS;  // runtime levels of the module loggers
 
     void parselogLevelConf(json_object*json_conf, spdlog::level::level_enum &log_level)
     {
@@ -207,7 +210,8 @@ struct LogConf
     {
         return "[TYPE: " + LOGTYPE + ", FILE: " + LOGFILE + ", LEVEL: " + LevelToString(LOGLEVEL) + ", NAME: " +
                LOGNAME + ", LOGFILESIZE: " + std::to_string(LOGFILESIZE) + ", LOGFILENUM: " +
-               std::to_string(LOGFILENUM) + ", FLUSH LEVEL: " + LevelToString(FLUSHLEVEL) + "]";
+               std::to_string(LOGFILENUM) + ", FLUSH LEVEL: " + LevelToString(FLUSHLEVEL) + ", ASYNC: " +
+               (ASYNC ? "true" : "false") + ", MODULE LEVELS: " + std::to_string(MODULE_LEVELS.size()) + "]";
     }
 };
 
@@ -233,15 +237,74 @@ struct DataStoreConf
     }
 };
 
+// MetricsConf: the process metrics are dumped as text into dump_file every dump_interval_secs,
+// empty dump_file disables the dump; the latency rollup is sent with the stats messages regardless
+struct MetricsConf
+{
+    std::string dump_file;
+    uint32_t dump_interval_secs = 10;
+
+    int parseJsonConf(json_object*);
+
+    [[nodiscard]] std::string to_String() const
+    {
+        return  "[METRICS_CONF: DUMP_FILE: " + dump_file +
+                ", DUMP_INTERVAL_SECS: " + std::to_string(dump_interval_secs) +
+                "]";
+    }
+};
+
+// TracingConf: one in sample_every events is traced through the process stages (0 disables the tracing),
+// the traces are dumped in the Chrome trace event format into trace_file on shutdown
+struct TracingConf
+{
+    uint32_t sample_every = 0;
+    std::string trace_file;
+
+    int parseJsonConf(json_object*);
+
+    [[nodiscard]] std::string to_String() const
+    {
+        return  "[TRACING_CONF: SAMPLE_EVERY: " + std::to_string(sample_every) +
+                ", TRACE_FILE: " + trace_file +
+                "]";
+    }
+};
+
+// CorePlacementConf: the cores the xstreams of each kind of work are pinned to, in the cpulist format "0-3,8"
+// or "node<N>" for all the cores of a NUMA node; the pinned xstreams of one kind share their own Argobots pool,
+// an empty list leaves that kind of xstreams unpinned
+struct CorePlacementConf
+{
+    std::string rpc_cores;          // handlers of the recording service rpcs
+    std::string sequencing_cores;   // data collection merging the events into the story chunks
+    std::string extraction_cores;   // story chunk extraction to the next tier
+    std::string io_cores;           // archive writing and reading
+
+    int parseJsonConf(json_object*);
+
+    [[nodiscard]] std::string to_String() const
+    {
+        return  "[CORE_PLACEMENT_CONF: RPC_CORES: " + rpc_cores +
+                ", SEQUENCING_CORES: " + sequencing_cores +
+                ", EXTRACTION_CORES: " + extraction_cores +
+                ", IO_CORES: " + io_cores +
+                "]";
+    }
+};
+
 struct ExtractorReaderConf
 {
     std::string story_files_dir;
+    // "template" archives the log records with the per chunk record template dictionary, "none" verbatim
+    std::string record_encoding = "none";
 
     int parseJsonConf(json_object*);
 
     [[nodiscard]] std::string to_String() const
     {
         return  "[EXTRACTOR_READER_CONF: STORY_FILES_DIR: " + story_files_dir +
+                ", RECORD_ENCODING: " + record_encoding +
                 "]";
     }
 };
@@ -253,6 +316,12 @@ struct VisorConfiguration
     RPCProviderConf VISOR_KEEPER_REGISTRY_SERVICE_CONF;
     LogConf VISOR_LOG_CONF;
     size_t DELAYED_DATA_ADMIN_EXIT_IN_SECS{};
+    std::string GROUP_PLACEMENT_POLICY;
+    size_t STORY_REBALANCING_RATIO_PERCENT{}; // 0 disables story migration between RecordingGroups
+    std::string METADATA_STORE_DIR; // empty disables the persistent metadata store
+    size_t METADATA_SNAPSHOT_INTERVAL_RECORDS{};
+    size_t STORY_NOTIFICATION_TIMEOUT_MSEC{}; // timeout of the story start/stop rpc to a single recording process,
+                                              // capped at half of DELAYED_DATA_ADMIN_EXIT_IN_SECS
 
     VisorConfiguration()
     {
@@ -268,6 +337,11 @@ struct VisorConfiguration
         VISOR_KEEPER_REGISTRY_SERVICE_CONF.SERVICE_PROVIDER_ID = 88;
 
         DELAYED_DATA_ADMIN_EXIT_IN_SECS = 3;
+        GROUP_PLACEMENT_POLICY = "power_of_two";
+        STORY_REBALANCING_RATIO_PERCENT = 150;
+        METADATA_STORE_DIR = "";
+        METADATA_SNAPSHOT_INTERVAL_RECORDS = 100000;
+        STORY_NOTIFICATION_TIMEOUT_MSEC = 1500;
     }
 
     int parseJsonConf(json_object*);
@@ -277,7 +351,11 @@ struct VisorConfiguration
         return "[VISOR_CLIENT_PORTAL_SERVICE_CONF: " + VISOR_CLIENT_PORTAL_SERVICE_CONF.to_String() +
                ", VISOR_KEEPER_REGISTRY_SERVICE_CONF: " + VISOR_KEEPER_REGISTRY_SERVICE_CONF.to_String() +
                ", VISOR_LOG: " + VISOR_LOG_CONF.to_String() + ", DELAYED_DATA_ADMIN_EXIT_IN_SECS: " +
-               std::to_string(DELAYED_DATA_ADMIN_EXIT_IN_SECS) + "]";
+               std::to_string(DELAYED_DATA_ADMIN_EXIT_IN_SECS) + ", GROUP_PLACEMENT_POLICY: " + GROUP_PLACEMENT_POLICY +
+               ", STORY_REBALANCING_RATIO_PERCENT: " + std::to_string(STORY_REBALANCING_RATIO_PERCENT) +
+               ", METADATA_STORE_DIR: " + METADATA_STORE_DIR + ", METADATA_SNAPSHOT_INTERVAL_RECORDS: " +
+               std::to_string(METADATA_SNAPSHOT_INTERVAL_RECORDS) + ", STORY_NOTIFICATION_TIMEOUT_MSEC: " +
+               std::to_string(STORY_NOTIFICATION_TIMEOUT_MSEC) + "]";
     }
 };
 
@@ -291,6 +369,9 @@ struct KeeperConfiguration
     DataStoreConf DATA_STORE_CONF{};
     ExtractorReaderConf EXTRACTOR_CONF;
     LogConf LOG_CONF;
+    MetricsConf METRICS_CONF;
+    TracingConf TRACING_CONF;
+    CorePlacementConf CORE_PLACEMENT_CONF;
 
     KeeperConfiguration()
     {
@@ -328,6 +409,9 @@ struct KeeperConfiguration
                ", LOG_CONF: " + LOG_CONF.to_String() +
                ", DATA_STORE_CONF: " + DATA_STORE_CONF.to_String() +
                ", EXTRACTOR_CONF: " + EXTRACTOR_CONF.to_String() +
+               ", METRICS_CONF: " + METRICS_CONF.to_String() +
+               ", TRACING_CONF: " + TRACING_CONF.to_String() +
+               ", CORE_PLACEMENT_CONF: " + CORE_PLACEMENT_CONF.to_String() +
                "]";
     }
 };
@@ -336,11 +420,15 @@ struct GrapherConfiguration
 {
     uint32_t RECORDING_GROUP{};
     RPCProviderConf KEEPER_GRAPHER_DRAIN_SERVICE_CONF;
+    RPCProviderConf GRAPHER_PLAYER_DRAIN_SERVICE_CONF;
     RPCProviderConf DATA_STORE_ADMIN_SERVICE_CONF;
     RPCProviderConf VISOR_REGISTRY_SERVICE_CONF;
     LogConf LOG_CONF;
     DataStoreConf DATA_STORE_CONF{};
     ExtractorReaderConf EXTRACTOR_CONF;
+    MetricsConf METRICS_CONF;
+    TracingConf TRACING_CONF;
+    CorePlacementConf CORE_PLACEMENT_CONF;
 
     GrapherConfiguration()
     {
@@ -350,6 +438,11 @@ struct GrapherConfiguration
         KEEPER_GRAPHER_DRAIN_SERVICE_CONF.BASE_PORT = 9999;
         KEEPER_GRAPHER_DRAIN_SERVICE_CONF.SERVICE_PROVIDER_ID = 99;
 
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.PROTO_CONF = "ofi+sockets";
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.IP = "127.0.0.1";
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.BASE_PORT = 2255;
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.SERVICE_PROVIDER_ID = 26;
+
         DATA_STORE_ADMIN_SERVICE_CONF.PROTO_CONF = "ofi+sockets";
         DATA_STORE_ADMIN_SERVICE_CONF.IP = "127.0.0.1";
         DATA_STORE_ADMIN_SERVICE_CONF.BASE_PORT = 4444;
@@ -373,11 +466,15 @@ struct GrapherConfiguration
     {
         return "[CHRONO_GRAPHER_CONFIGURATION: RECORDING_GROUP: "+ std::to_string(RECORDING_GROUP) +
                ", KEEPER_GRAPHER_DRAIN_SERVICE_CONF: " + KEEPER_GRAPHER_DRAIN_SERVICE_CONF.to_String() +
+               ", GRAPHER_PLAYER_DRAIN_SERVICE_CONF: " + GRAPHER_PLAYER_DRAIN_SERVICE_CONF.to_String() +
                ", DATA_STORE_ADMIN_SERVICE_CONF: " + DATA_STORE_ADMIN_SERVICE_CONF.to_String() +
                ", VISOR_REGISTRY_SERVICE_CONF: " + VISOR_REGISTRY_SERVICE_CONF.to_String() +
                ", LOG_CONF: " + LOG_CONF.to_String() +
                ", DATA_STORE_CONF: " + DATA_STORE_CONF.to_String() +
                ", EXTRACTOR_CONF: " + EXTRACTOR_CONF.to_String() +
+               ", METRICS_CONF: " + METRICS_CONF.to_String() +
+               ", TRACING_CONF: " + TRACING_CONF.to_String() +
+               ", CORE_PLACEMENT_CONF: " + CORE_PLACEMENT_CONF.to_String() +
                "]";
     }
 };
@@ -387,10 +484,13 @@ struct PlayerConfiguration
     uint32_t RECORDING_GROUP;
     RPCProviderConf DATA_STORE_ADMIN_SERVICE_CONF;
     RPCProviderConf PLAYBACK_SERVICE_CONF;
+    RPCProviderConf GRAPHER_PLAYER_DRAIN_SERVICE_CONF;
     RPCProviderConf VISOR_REGISTRY_SERVICE_CONF;
     LogConf LOG_CONF;
     DataStoreConf DATA_STORE_CONF{};
     ExtractorReaderConf READER_CONF;
+    MetricsConf METRICS_CONF;
+    CorePlacementConf CORE_PLACEMENT_CONF;
 
     PlayerConfiguration()
     {
@@ -405,6 +505,11 @@ struct PlayerConfiguration
         PLAYBACK_SERVICE_CONF.BASE_PORT = 2225;
         PLAYBACK_SERVICE_CONF.SERVICE_PROVIDER_ID = 25;
 
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.PROTO_CONF = "ofi+sockets";
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.IP = "127.0.0.1";
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.BASE_PORT = 2255;
+        GRAPHER_PLAYER_DRAIN_SERVICE_CONF.SERVICE_PROVIDER_ID = 26;
+
         VISOR_REGISTRY_SERVICE_CONF.PROTO_CONF = "ofi+sockets";
         VISOR_REGISTRY_SERVICE_CONF.IP = "127.0.0.1";
         VISOR_REGISTRY_SERVICE_CONF.BASE_PORT = 8888;
@@ -412,7 +517,7 @@ struct PlayerConfiguration
     
         DATA_STORE_CONF.max_story_chunk_size = 4096;
         DATA_STORE_CONF.story_chunk_duration_secs = 60;
-        DATA_STORE_CONF.acceptance_window_secs = 180;
+        DATA_STORE_CONF.acceptance_window_secs = 180; // set to the Grapher acceptance window, see ConfigurationManager
         DATA_STORE_CONF.inactive_story_delay_secs = 300;
     
         READER_CONF.story_files_dir = "/tmp/";
@@ -424,10 +529,13 @@ struct PlayerConfiguration
         return "[CHRONO_PLAYER_CONFIGURATION: RECORDING_GROUP: " + std::to_string(RECORDING_GROUP) +
                ", DATA_STORE_ADMIN_SERVICE_CONF: " + DATA_STORE_ADMIN_SERVICE_CONF.to_String() +
                ", PLAYBACK_SERVICE_CONF: " + PLAYBACK_SERVICE_CONF.to_String() +
+               ", GRAPHER_PLAYER_DRAIN_SERVICE_CONF: " + GRAPHER_PLAYER_DRAIN_SERVICE_CONF.to_String() +
                ", VISOR_REGISTRY_SERVICE_CONF: " + VISOR_REGISTRY_SERVICE_CONF.to_String() +
                ", LOG_CONF: " + LOG_CONF.to_String() +
                ", DATA_STORE_CONF: " + DATA_STORE_CONF.to_String() +
                ", READER_CONF: " + READER_CONF.to_String() +
+               ", METRICS_CONF: " + METRICS_CONF.to_String() +
+               ", CORE_PLACEMENT_CONF: " + CORE_PLACEMENT_CONF.to_String() +
                "]";
     }
 };
@@ -543,6 +651,10 @@ public:
                 PLAYER_CONF.parseJsonConf(chrono_player_conf);
             }
         }
+
+        // the Player keeps the recent events forwarded by the Grapher in memory until the Grapher archives them,
+        // so both of them accept the late events for the same acceptance window of the Grapher configuration
+        PLAYER_CONF.DATA_STORE_CONF.acceptance_window_secs = GRAPHER_CONF.DATA_STORE_CONF.acceptance_window_secs;
         json_object_put(root);
     }
 };
@@ -11,13 +11,15 @@ class ConnectResponseMsg
 {
     int error_code;
     ClientId clientId;
+    uint64_t clockTime;     // the Visor clock for the client running the hybrid logical clock
 
 public:
 
-    ConnectResponseMsg(): error_code(chronolog::CL_SUCCESS), clientId(0)
+    ConnectResponseMsg(): error_code(chronolog::CL_SUCCESS), clientId(0), clockTime(0)
     {}
 
-    ConnectResponseMsg(int code, ClientId const &client_id): error_code(code), clientId(client_id)
+    ConnectResponseMsg(int code, ClientId const &client_id, uint64_t clock_time = 0)
+        : error_code(code), clientId(client_id), clockTime(clock_time)
     {}
 
     ~ConnectResponseMsg() = default;
@@ -28,11 +30,15 @@ public:
     ClientId const &getClientId() const
     { return clientId; }
 
+    uint64_t getClockTime() const
+    { return clockTime; }
+
     template <typename SerArchiveT>
     void serialize(SerArchiveT &serT)
     {
         serT&error_code;
         serT&clientId;
+        serT&clockTime;
     }
 
 };
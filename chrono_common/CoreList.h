@@ -0,0 +1,88 @@
+#ifndef CHRONOLOG_CORE_LIST_H
+#define CHRONOLOG_CORE_LIST_H
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chronolog_errcode.h"
+
+namespace chronolog
+{
+
+#define SYSFS_DEVICES_SYSTEM_DIR "/sys/devices/system"
+
+// parses the core list in the kernel cpulist format "0-3,8,10-11" into the core ids, in the listed order
+// without the duplicates; "node<N>" stands for all the cores of the NUMA node N as listed in sysfs
+inline int parseCoreList(std::string const &core_list, std::vector <int> &cores
+                         , std::string const &sysfs_dir = SYSFS_DEVICES_SYSTEM_DIR)
+{
+    std::stringstream list_stream(core_list);
+    std::string item;
+    while(std::getline(list_stream, item, ','))
+    {
+        item.erase(std::remove_if(item.begin(), item.end(), [](unsigned char c)
+        { return std::isspace(c); }), item.end());
+        if(item.empty())
+        { continue; }
+
+        std::vector <int> item_cores;
+        if(item.compare(0, 4, "node") == 0)
+        {
+            std::string node = item.substr(4);
+            if(node.empty() || node.find_first_not_of("0123456789") != std::string::npos)
+            { return CL_ERR_INVALID_CONF; }
+            std::ifstream node_cpulist(sysfs_dir + "/node/node" + node + "/cpulist");
+            std::string node_cores;
+            if(!node_cpulist.is_open() || !std::getline(node_cpulist, node_cores) || node_cores.empty() ||
+               node_cores.find("node") != std::string::npos ||
+               parseCoreList(node_cores, item_cores, sysfs_dir) != CL_SUCCESS)
+            { return CL_ERR_INVALID_CONF; }
+        }
+        else
+        {
+            size_t dash = item.find('-');
+            std::string first = item.substr(0, dash);
+            std::string last = (dash == std::string::npos ? first : item.substr(dash + 1));
+            if(first.empty() || last.empty() || first.find_first_not_of("0123456789") != std::string::npos ||
+               last.find_first_not_of("0123456789") != std::string::npos || first.size() > 6 || last.size() > 6)
+            { return CL_ERR_INVALID_CONF; }
+            int first_core = std::stoi(first);
+            int last_core = std::stoi(last);
+            if(first_core > last_core)
+            { return CL_ERR_INVALID_CONF; }
+            for(int core = first_core; core <= last_core; ++core)
+            { item_cores.push_back(core); }
+        }
+
+        for(int core: item_cores)
+        {
+            if(std::find(cores.begin(), cores.end(), core) == cores.end())
+            { cores.push_back(core); }
+        }
+    }
+    return CL_SUCCESS;
+}
+
+// NUMA node the core belongs to, -1 if the kernel doesn't expose the NUMA topology
+inline int getCoreNumaNode(int core, std::string const &sysfs_dir = SYSFS_DEVICES_SYSTEM_DIR)
+{
+    std::error_code error;
+    std::filesystem::path core_dir = std::filesystem::path(sysfs_dir) / "cpu" / ("cpu" + std::to_string(core));
+    for(auto const &entry: std::filesystem::directory_iterator(core_dir, error))
+    {
+        std::string name = entry.path().filename().string();
+        if(name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+           name.find_first_not_of("0123456789", 4) == std::string::npos)
+        { return std::stoi(name.substr(4)); }
+    }
+    return -1;
+}
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "chrono_monitor.h"
+#include "client_errcode.h"
+#include "EventTracer.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+uint64_t wallClockNanos()
+{
+    return std::chrono::duration_cast <std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// chrome trace timestamps are microseconds
+std::string traceMicros(uint64_t nanos)
+{
+    char micros[32];
+    snprintf(micros, sizeof(micros), "%llu.%03llu", static_cast<unsigned long long>(nanos / 1000)
+             , static_cast<unsigned long long>(nanos % 1000));
+    return std::string(micros);
+}
+
+}
+
+////////////////////////
+
+chl::EventTracer &chl::EventTracer::getInstance()
+{
+    static EventTracer eventTracer;
+    return eventTracer;
+}
+
+void chl::EventTracer::configure(std::string const &process_name, uint32_t sample_every)
+{
+    {
+        std::lock_guard <std::mutex> lock(tracerMutex);
+        processName = process_name;
+    }
+    sampleEvery.store(sample_every, std::memory_order_relaxed);
+    if(sample_every != 0)
+    { LOG_INFO("[EventTracer] {} traces one in {} events", process_name, sample_every); }
+}
+
+////////////////////////
+
+void chl::EventTracer::recordStage(chl::LogEvent const &event, char const *stage)
+{
+    if(!isEnabled())
+    { return; }
+    uint64_t trace_id = eventTraceId(event);
+    if(!isSampled(trace_id))
+    { return; }
+
+    recordStage(trace_id, TracedEvent{event.storyId, event.eventTime, event.clientId, event.eventIndex}, stage
+                , wallClockNanos());
+}
+
+void chl::EventTracer::recordStage(std::vector <chl::TracedEvent> const &traced_events, char const *stage)
+{
+    if(traced_events.empty())
+    { return; }
+
+    uint64_t stage_time = wallClockNanos();
+    for(auto const &traced_event: traced_events)
+    { recordStage(eventTraceId(traced_event), traced_event, stage, stage_time); }
+}
+
+void chl::EventTracer::recordStage(uint64_t trace_id, chl::TracedEvent const &event, char const *stage
+                                   , uint64_t stage_time)
+{
+    std::lock_guard <std::mutex> lock(tracerMutex);
+    auto trace_iter = eventTraces.find(trace_id);
+    if(trace_iter == eventTraces.end())
+    {
+        if(traceOrder.size() >= EVENT_TRACE_MAX_TRACES)
+        {
+            eventTraces.erase(traceOrder.front());
+            traceOrder.pop_front();
+        }
+        trace_iter = eventTraces.insert(std::pair <uint64_t, EventTrace>(trace_id, EventTrace{event, {}})).first;
+        traceOrder.push_back(trace_id);
+    }
+    (*trace_iter).second.stages.push_back(std::pair <char const*, uint64_t>(stage, stage_time));
+}
+
+size_t chl::EventTracer::getTraceCount() const
+{
+    std::lock_guard <std::mutex> lock(tracerMutex);
+    return eventTraces.size();
+}
+
+////////////////////////
+
+// every trace is a row of the process track: the first stage is an instant event,
+// each following stage is a complete event spanning the time since the previous stage
+std::string chl::EventTracer::toChromeTraceJson() const
+{
+    std::string pid = std::to_string(getpid());
+    std::lock_guard <std::mutex> lock(tracerMutex);
+
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"args\":{\"name\":\"" + processName + "\"}}";
+    for(uint64_t trace_id: traceOrder)
+    {
+        EventTrace const &event_trace = (*eventTraces.find(trace_id)).second;
+        std::string tid = std::to_string(trace_id & 0x7FFFFFFF);
+        std::string args = "{\"trace_id\":\"" + std::to_string(trace_id) + "\",\"story_id\":" +
+                           std::to_string(event_trace.event.storyId) + ",\"event_time\":" +
+                           std::to_string(event_trace.event.eventTime) + ",\"client_id\":" +
+                           std::to_string(event_trace.event.clientId) + ",\"event_index\":" +
+                           std::to_string(event_trace.event.eventIndex) + "}";
+
+        uint64_t previous_time = 0;
+        for(auto const &stage: event_trace.stages)
+        {
+            json += ",\n{\"name\":\"" + std::string(stage.first) + "\",\"cat\":\"chronolog\",\"pid\":" + pid +
+                    ",\"tid\":" + tid;
+            if(previous_time == 0)
+            { json += ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" + traceMicros(stage.second); }
+            else
+            {
+                uint64_t duration = (stage.second > previous_time ? stage.second - previous_time : 0);
+                json += ",\"ph\":\"X\",\"ts\":" + traceMicros(previous_time) + ",\"dur\":" + traceMicros(duration);
+            }
+            json += ",\"args\":" + args + "}";
+            previous_time = stage.second;
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+int chl::EventTracer::dumpToFile(std::string const &file_path) const
+{
+    std::string tmp_file_path = file_path + ".tmp";
+    {
+        std::ofstream trace_file(tmp_file_path, std::ios::out | std::ios::trunc);
+        if(!trace_file.is_open())
+        {
+            LOG_ERROR("[EventTracer] Failed to open trace file {}", tmp_file_path);
+            return chl::CL_ERR_UNKNOWN;
+        }
+        trace_file << toChromeTraceJson();
+        if(!trace_file.good())
+        {
+            LOG_ERROR("[EventTracer] Failed to write trace file {}", tmp_file_path);
+            return chl::CL_ERR_UNKNOWN;
+        }
+    }
+    if(std::rename(tmp_file_path.c_str(), file_path.c_str()) != 0)
+    {
+        LOG_ERROR("[EventTracer] Failed to replace trace file {}", file_path);
+        return chl::CL_ERR_UNKNOWN;
+    }
+    LOG_INFO("[EventTracer] Dumped {} event traces into {}", getTraceCount(), file_path);
+    return chl::CL_SUCCESS;
+}
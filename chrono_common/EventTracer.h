@@ -0,0 +1,121 @@
+#ifndef CHRONOLOG_EVENT_TRACER_H
+#define CHRONOLOG_EVENT_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "chronolog_types.h"
+
+// traces kept in memory by the process, the oldest trace is dropped to make room for the new one
+#define EVENT_TRACE_MAX_TRACES 4096
+
+namespace chronolog
+{
+
+// TracedEvent identifies the sampled event in the StoryChunks it is merged into
+struct TracedEvent
+{
+    StoryId storyId = 0;
+    chrono_time eventTime = 0;
+    ClientId clientId = 0;
+    chrono_index eventIndex = 0;
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & storyId;
+        serT & eventTime;
+        serT & clientId;
+        serT & eventIndex;
+    }
+};
+
+// trace id of the event is the hash of the event identity, every process on the event path computes
+// the same id and makes the same sampling decision, so the sampled events carry nothing extra over the wire
+inline uint64_t eventTraceId(StoryId story_id, chrono_time event_time, ClientId client_id, chrono_index event_index)
+{
+    uint64_t key = story_id * 0x9E3779B97F4A7C15ULL ^ client_id;
+    key = (key ^ event_time) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ event_index ^ (key >> 31)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 29);
+}
+
+inline uint64_t eventTraceId(LogEvent const &event)
+{ return eventTraceId(event.storyId, event.eventTime, event.clientId, event.eventIndex); }
+
+inline uint64_t eventTraceId(TracedEvent const &event)
+{ return eventTraceId(event.storyId, event.eventTime, event.clientId, event.eventIndex); }
+
+// EventTracer records the wall clock time each sampled event crosses the stage boundaries of this process:
+// client "log" / "sent", keeper "ingested" / "merged" / "extraction_queued" / "sent_to_grapher",
+// grapher "received" / "merged" / "extraction_queued" / "archived".
+// The trace file is in the Chrome trace event format, the files dumped by the client, keeper and grapher
+// processes can be loaded into the trace viewer together, the events are matched by the trace_id argument.
+// All the processes on the path need the same sample_every for the complete traces.
+class EventTracer
+{
+public:
+    static EventTracer &getInstance();
+
+    // sample_every 0 disables the tracing
+    void configure(std::string const &process_name, uint32_t sample_every);
+
+    // one in sample_every events is traced, the unsampled events pay for a relaxed load or a hash
+    static bool isSampled(uint64_t trace_id)
+    {
+        uint32_t sample_every = sampleEvery.load(std::memory_order_relaxed);
+        return (sample_every != 0 && trace_id % sample_every == 0);
+    }
+
+    static bool isSampled(LogEvent const &event)
+    { return (sampleEvery.load(std::memory_order_relaxed) != 0 && isSampled(eventTraceId(event))); }
+
+    static bool isEnabled()
+    { return (sampleEvery.load(std::memory_order_relaxed) != 0); }
+
+    // stage names are string literals
+    void recordStage(LogEvent const &event, char const *stage);
+
+    // records the stage for all the sampled events of the StoryChunk
+    void recordStage(std::vector <TracedEvent> const &traced_events, char const *stage);
+
+    size_t getTraceCount() const;
+
+    std::string toChromeTraceJson() const;
+
+    // the trace file is replaced atomically
+    int dumpToFile(std::string const &file_path) const;
+
+private:
+    EventTracer() = default;
+
+    ~EventTracer() = default;
+
+    EventTracer(EventTracer const &) = delete;
+
+    EventTracer &operator=(EventTracer const &) = delete;
+
+    struct EventTrace
+    {
+        TracedEvent event;
+        std::vector <std::pair <char const*, uint64_t>> stages;   // stage name, wall clock nanoseconds
+    };
+
+    void recordStage(uint64_t trace_id, TracedEvent const &event, char const *stage, uint64_t stage_time);
+
+    static inline std::atomic <uint32_t> sampleEvery{0};
+
+    mutable std::mutex tracerMutex;
+    std::string processName;
+    std::unordered_map <uint64_t, EventTrace> eventTraces;
+    std::deque <uint64_t> traceOrder;
+};
+
+}//namespace
+
+#endif
@@ -2,7 +2,10 @@
 #define GRAPHER_STATS_MSG_H
 
 #include <iostream>
+#include <vector>
 #include "GrapherIdCard.h"
+#include "ProcessLoadStats.h"
+#include "MetricsRollup.h"
 
 
 namespace chronolog
@@ -13,6 +16,8 @@ class GrapherStatsMsg
 
     GrapherIdCard grapherIdCard;
     uint32_t active_story_count;
+    ProcessLoadStats load_stats;
+    std::vector <MetricSummary> metrics_rollup;  // latency summaries of the instrumented pipeline stages
 
 public:
 
@@ -30,25 +35,44 @@ public:
     uint32_t getActiveStoryCount() const
     { return active_story_count; }
 
+    ProcessLoadStats const & getLoadStats() const
+    { return load_stats; }
+
+    void setLoadStats(uint32_t story_count, ProcessLoadStats const & process_load_stats)
+    {
+        active_story_count = story_count;
+        load_stats = process_load_stats;
+    }
+
+    std::vector <MetricSummary> const & getMetricsRollup() const
+    { return metrics_rollup; }
+
+    void setMetricsRollup(std::vector <MetricSummary> const & rollup)
+    { metrics_rollup = rollup; }
+
     template <typename SerArchiveT>
     void serialize(SerArchiveT &serT)
     {
         serT & grapherIdCard;
         serT & active_story_count;
+        serT & load_stats;
+        serT & metrics_rollup;
     }
 
 };
 
 inline std::string to_string(GrapherStatsMsg const& stats_msg)
 {
-    return std::string("GrapherStatsMsg{") + chronolog::to_string(stats_msg.getGrapherIdCard()) + "}";
+    return std::string("GrapherStatsMsg{") + chronolog::to_string(stats_msg.getGrapherIdCard()) + " activeStories:" +
+           std::to_string(stats_msg.getActiveStoryCount()) + " load:" + to_string(stats_msg.getLoadStats()) + "}";
 }
 
 }
 
 inline std::ostream &operator<<(std::ostream &out, chronolog::GrapherStatsMsg const &stats_msg)
 {
-    out << "GrapherStatsMsg{" << stats_msg.getGrapherIdCard() << "}";
+    out << "GrapherStatsMsg{" << stats_msg.getGrapherIdCard() << " activeStories:" << stats_msg.getActiveStoryCount()
+        << " load:" << chronolog::to_string(stats_msg.getLoadStats()) << "}";
     return out;
 }
 
@@ -0,0 +1,79 @@
+#ifndef CHRONOLOG_HYBRID_LOGICAL_CLOCK_H
+#define CHRONOLOG_HYBRID_LOGICAL_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// the remote clock further ahead of the local physical clock than this is not merged,
+// so that a single process with a broken clock can't drag all the others along
+#define HLC_MAX_CLOCK_OFFSET_NSECS 5000000000ULL
+
+namespace chronolog
+{
+
+// HybridLogicalClock timestamps are nanoseconds since the epoch just like the physical clock ones,
+// so that they can be used as event times and compared with the chunk and acceptance window boundaries.
+// The clock never goes backwards and never falls behind the remote timestamps merged into it;
+// the logical counter of the hybrid clock lives in the low order nanoseconds:
+// the timestamp that wouldn't advance the clock is bumped by one nanosecond instead.
+// The processes exchanging their clocks on rpc responses stay within the clock offset of the fastest of them
+// and the causally related events are ordered by their timestamps even if the physical clocks are skewed.
+class HybridLogicalClock
+{
+public:
+    explicit HybridLogicalClock(uint64_t max_clock_offset = HLC_MAX_CLOCK_OFFSET_NSECS)
+        : maxClockOffset(max_clock_offset)
+        , lastTime(0)
+    {}
+
+    static uint64_t physicalTime()
+    { return std::chrono::high_resolution_clock::now().time_since_epoch().count(); }
+
+    // the timestamps returned to the concurrent callers are unique
+    uint64_t getTimestamp()
+    {
+        uint64_t physical_time = physicalTime();
+        uint64_t last_time = lastTime.load(std::memory_order_relaxed);
+        uint64_t next_time;
+        do
+        {
+            next_time = (physical_time > last_time ? physical_time : last_time + 1);
+        } while(!lastTime.compare_exchange_weak(last_time, next_time, std::memory_order_relaxed));
+        return next_time;
+    }
+
+    // merges the clock piggybacked on the message from another process,
+    // returns false if the remote clock is too far ahead to be trusted
+    bool update(uint64_t remote_time)
+    {
+        if(remote_time > physicalTime() + maxClockOffset)
+        { return false; }
+
+        uint64_t last_time = lastTime.load(std::memory_order_relaxed);
+        while(remote_time > last_time &&
+              !lastTime.compare_exchange_weak(last_time, remote_time, std::memory_order_relaxed))
+        {}
+        return true;
+    }
+
+    // how far the clock has been pushed ahead of the local physical clock, 0 if it's not ahead
+    uint64_t getClockOffset() const
+    {
+        uint64_t last_time = lastTime.load(std::memory_order_relaxed);
+        uint64_t physical_time = physicalTime();
+        return (last_time > physical_time ? last_time - physical_time : 0);
+    }
+
+private:
+    HybridLogicalClock(HybridLogicalClock const &) = delete;
+
+    HybridLogicalClock &operator=(HybridLogicalClock const &) = delete;
+
+    uint64_t maxClockOffset;
+    std::atomic <uint64_t> lastTime;
+};
+
+}//namespace
+
+#endif
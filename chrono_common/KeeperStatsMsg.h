@@ -2,7 +2,10 @@
 #define KEEPER_STATS_MSG_H
 
 #include <iostream>
+#include <vector>
 #include "KeeperIdCard.h"
+#include "ProcessLoadStats.h"
+#include "MetricsRollup.h"
 
 
 namespace chronolog
@@ -13,6 +16,9 @@ class KeeperStatsMsg
 
     KeeperIdCard keeperIdCard;
     uint32_t active_story_count;
+    ProcessLoadStats load_stats;
+    std::vector <StoryLoad> hot_stories;  // the stories with the highest ingestion rate, hottest first
+    std::vector <MetricSummary> metrics_rollup;  // latency summaries of the instrumented pipeline stages
 
 public:
 
@@ -30,25 +36,53 @@ public:
     uint32_t getActiveStoryCount() const
     { return active_story_count; }
 
+    ProcessLoadStats const & getLoadStats() const
+    { return load_stats; }
+
+    void setLoadStats(uint32_t story_count, ProcessLoadStats const & process_load_stats)
+    {
+        active_story_count = story_count;
+        load_stats = process_load_stats;
+    }
+
+    std::vector <StoryLoad> const & getHotStories() const
+    { return hot_stories; }
+
+    void setHotStories(std::vector <StoryLoad> const & story_loads)
+    { hot_stories = story_loads; }
+
+    std::vector <MetricSummary> const & getMetricsRollup() const
+    { return metrics_rollup; }
+
+    void setMetricsRollup(std::vector <MetricSummary> const & rollup)
+    { metrics_rollup = rollup; }
+
     template <typename SerArchiveT>
     void serialize(SerArchiveT &serT)
     {
         serT & keeperIdCard;
         serT & active_story_count;
+        serT & load_stats;
+        serT & hot_stories;
+        serT & metrics_rollup;
     }
 
 };
 
 inline std::string to_string(KeeperStatsMsg const &stats_msg)
 {
-    return std::string("KeeperStatsMsg{") + to_string(stats_msg.getKeeperIdCard()) + "}";
+    return std::string("KeeperStatsMsg{") + to_string(stats_msg.getKeeperIdCard()) + " activeStories:" +
+           std::to_string(stats_msg.getActiveStoryCount()) + " load:" + to_string(stats_msg.getLoadStats()) +
+           " hotStories:" + std::to_string(stats_msg.getHotStories().size()) + "}";
 }
 
 } //namespace chronolog
 
 inline std::ostream & operator<<(std::ostream &out, chronolog::KeeperStatsMsg const &stats_msg)
 {
-    out << "KeeperStatsMsg{" << stats_msg.getKeeperIdCard() << "}";
+    out << "KeeperStatsMsg{" << stats_msg.getKeeperIdCard() << " activeStories:" << stats_msg.getActiveStoryCount()
+        << " load:" << chronolog::to_string(stats_msg.getLoadStats())
+        << " hotStories:" << stats_msg.getHotStories().size() << "}";
     return out;
 }
 
@@ -0,0 +1,216 @@
+#include <cstdio>
+#include <fstream>
+
+#include "chrono_monitor.h"
+#include "client_errcode.h"
+#include "MetricsRegistry.h"
+
+namespace chl = chronolog;
+
+////////////////////////
+
+uint64_t chl::HistogramSnapshot::quantile(double q) const
+{
+    if(count == 0)
+    { return 0; }
+    if(q <= 0)
+    { q = 0; }
+    if(q >= 1)
+    { return max; }
+
+    uint64_t rank = static_cast<uint64_t>(q * count) + 1;
+    uint64_t seen = 0;
+    for(uint32_t index = 0; index < buckets.size(); ++index)
+    {
+        seen += buckets[index];
+        if(seen >= rank)
+        {
+            uint64_t lower_bound = LatencyHistogram::bucketLowerBound(index);
+            uint64_t upper_bound = (index + 1 < buckets.size() ? LatencyHistogram::bucketLowerBound(index + 1) : max);
+            uint64_t value = lower_bound + (upper_bound - lower_bound) / 2;
+            return (value > max ? max : value);
+        }
+    }
+    return max;
+}
+
+////////////////////////
+
+chl::HistogramSnapshot chl::LatencyHistogram::snapshot() const
+{
+    HistogramSnapshot histogram_snapshot;
+    histogram_snapshot.buckets.resize(METRICS_HISTOGRAM_BUCKETS, 0);
+    for(auto const &shard: shards)
+    {
+        histogram_snapshot.count += shard.count.load(std::memory_order_relaxed);
+        histogram_snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        uint64_t shard_max = shard.max.load(std::memory_order_relaxed);
+        if(shard_max > histogram_snapshot.max)
+        { histogram_snapshot.max = shard_max; }
+        for(uint32_t index = 0; index < METRICS_HISTOGRAM_BUCKETS; ++index)
+        { histogram_snapshot.buckets[index] += shard.buckets[index].load(std::memory_order_relaxed); }
+    }
+    return histogram_snapshot;
+}
+
+////////////////////////
+
+chl::MetricsRegistry &chl::MetricsRegistry::getInstance()
+{
+    static MetricsRegistry metricsRegistry;
+    return metricsRegistry;
+}
+
+chl::MetricsRegistry::~MetricsRegistry()
+{
+    stopPeriodicDump();
+
+    // the metrics are intentionally not deleted: the instrumented objects with static lifetime
+    // might still hold the pointers when the registry is destroyed at exit
+}
+
+chl::MetricsCounter *chl::MetricsRegistry::getCounter(std::string const &name)
+{
+    std::lock_guard <std::mutex> lock(registryMutex);
+    auto counter_iter = counters.find(name);
+    if(counter_iter == counters.end())
+    { counter_iter = counters.insert(std::pair <std::string, MetricsCounter*>(name, new MetricsCounter())).first; }
+    return (*counter_iter).second;
+}
+
+chl::MetricsGauge *chl::MetricsRegistry::getGauge(std::string const &name)
+{
+    std::lock_guard <std::mutex> lock(registryMutex);
+    auto gauge_iter = gauges.find(name);
+    if(gauge_iter == gauges.end())
+    { gauge_iter = gauges.insert(std::pair <std::string, MetricsGauge*>(name, new MetricsGauge())).first; }
+    return (*gauge_iter).second;
+}
+
+chl::LatencyHistogram *chl::MetricsRegistry::getHistogram(std::string const &name)
+{
+    std::lock_guard <std::mutex> lock(registryMutex);
+    auto histogram_iter = histograms.find(name);
+    if(histogram_iter == histograms.end())
+    {
+        histogram_iter = histograms.insert(
+                std::pair <std::string, LatencyHistogram*>(name, new LatencyHistogram())).first;
+    }
+    return (*histogram_iter).second;
+}
+
+////////////////////////
+
+std::string chl::MetricsRegistry::toText() const
+{
+    std::string text;
+    std::lock_guard <std::mutex> lock(registryMutex);
+    for(auto const &counter: counters)
+    { text += counter.first + " " + std::to_string(counter.second->value()) + "\n"; }
+    for(auto const &gauge: gauges)
+    { text += gauge.first + " " + std::to_string(gauge.second->value()) + "\n"; }
+    for(auto const &histogram: histograms)
+    {
+        HistogramSnapshot histogram_snapshot = histogram.second->snapshot();
+        text += histogram.first + " count=" + std::to_string(histogram_snapshot.count) + " sum=" +
+                std::to_string(histogram_snapshot.sum) + " p50=" + std::to_string(histogram_snapshot.quantile(0.5)) +
+                " p90=" + std::to_string(histogram_snapshot.quantile(0.9)) + " p99=" +
+                std::to_string(histogram_snapshot.quantile(0.99)) + " max=" + std::to_string(histogram_snapshot.max) +
+                "\n";
+    }
+    return text;
+}
+
+int chl::MetricsRegistry::dumpToFile(std::string const &file_path) const
+{
+    std::string tmp_file_path = file_path + ".tmp";
+    {
+        std::ofstream dump_file(tmp_file_path, std::ios::out | std::ios::trunc);
+        if(!dump_file.is_open())
+        {
+            LOG_ERROR("[MetricsRegistry] Failed to open metrics dump file {}", tmp_file_path);
+            return chl::CL_ERR_UNKNOWN;
+        }
+        dump_file << toText();
+        if(!dump_file.good())
+        {
+            LOG_ERROR("[MetricsRegistry] Failed to write metrics dump file {}", tmp_file_path);
+            return chl::CL_ERR_UNKNOWN;
+        }
+    }
+    if(std::rename(tmp_file_path.c_str(), file_path.c_str()) != 0)
+    {
+        LOG_ERROR("[MetricsRegistry] Failed to replace metrics dump file {}", file_path);
+        return chl::CL_ERR_UNKNOWN;
+    }
+    return chl::CL_SUCCESS;
+}
+
+////////////////////////
+
+int chl::MetricsRegistry::startPeriodicDump(std::string const &file_path, uint32_t interval_secs)
+{
+    if(file_path.empty() || interval_secs == 0)
+    { return chl::CL_ERR_INVALID_ARG; }
+
+    std::lock_guard <std::mutex> lock(dumpMutex);
+    if(dumpThread.joinable())
+    {
+        LOG_WARNING("[MetricsRegistry] Periodic metrics dump is already running");
+        return chl::CL_ERR_UNKNOWN;
+    }
+    dumpStopRequested = false;
+    dumpThread = std::thread(&MetricsRegistry::dumpLoop, this, file_path, interval_secs);
+    LOG_INFO("[MetricsRegistry] Started periodic metrics dump into {} every {} secs", file_path, interval_secs);
+    return chl::CL_SUCCESS;
+}
+
+void chl::MetricsRegistry::stopPeriodicDump()
+{
+    std::thread dump_thread;
+    {
+        std::lock_guard <std::mutex> lock(dumpMutex);
+        if(!dumpThread.joinable())
+        { return; }
+        dumpStopRequested = true;
+        dump_thread = std::move(dumpThread);
+    }
+    dumpCondition.notify_all();
+    dump_thread.join();
+}
+
+void chl::MetricsRegistry::dumpLoop(std::string file_path, uint32_t interval_secs)
+{
+    std::unique_lock <std::mutex> lock(dumpMutex);
+    while(!dumpStopRequested)
+    {
+        dumpCondition.wait_for(lock, std::chrono::seconds(interval_secs), [this]()
+        { return dumpStopRequested; });
+
+        lock.unlock();
+        dumpToFile(file_path);
+        lock.lock();
+    }
+}
+
+////////////////////////
+
+void chl::MetricsRegistry::getRollup(std::vector <MetricSummary> &rollup) const
+{
+    std::lock_guard <std::mutex> lock(registryMutex);
+    for(auto const &histogram: histograms)
+    {
+        HistogramSnapshot histogram_snapshot = histogram.second->snapshot();
+        if(histogram_snapshot.count == 0)
+        { continue; }
+
+        MetricSummary summary;
+        summary.name = histogram.first;
+        summary.count = histogram_snapshot.count;
+        summary.sum = histogram_snapshot.sum;
+        summary.p50 = histogram_snapshot.quantile(0.5);
+        summary.p99 = histogram_snapshot.quantile(0.99);
+        summary.max = histogram_snapshot.max;
+        rollup.push_back(summary);
+    }
+}
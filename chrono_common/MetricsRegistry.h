@@ -0,0 +1,250 @@
+#ifndef CHRONOLOG_METRICS_REGISTRY_H
+#define CHRONOLOG_METRICS_REGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MetricsRollup.h"
+
+// the metric values are spread over this many cache line aligned shards,
+// each thread updates the shard picked by its thread index so that the concurrent updates don't share cache lines
+#define METRICS_THREAD_SHARDS 16
+
+// latency histogram buckets are log-linear: every power of 2 range is split into 2^SUB_BUCKET_BITS linear buckets,
+// so the value recorded is within 12.5% of the bucket lower bound
+#define METRICS_HISTOGRAM_SUB_BUCKET_BITS 3
+#define METRICS_HISTOGRAM_SUB_BUCKETS (1 << METRICS_HISTOGRAM_SUB_BUCKET_BITS)
+#define METRICS_HISTOGRAM_BUCKETS ((64 - METRICS_HISTOGRAM_SUB_BUCKET_BITS + 1) * METRICS_HISTOGRAM_SUB_BUCKETS)
+
+// hot path latencies (per event) are timed for one in this many calls on each thread
+#define METRICS_LATENCY_SAMPLE_EVERY 16
+
+namespace chronolog
+{
+
+// shard of the calling thread, assigned round robin the first time the thread touches any metric
+inline uint32_t metricsThreadShard()
+{
+    static std::atomic <uint32_t> next_thread_index{0};
+    thread_local uint32_t thread_shard =
+            next_thread_index.fetch_add(1, std::memory_order_relaxed) % METRICS_THREAD_SHARDS;
+    return thread_shard;
+}
+
+// returns true for one in METRICS_LATENCY_SAMPLE_EVERY calls made by the calling thread
+inline bool metricsSampleTick()
+{
+    thread_local uint32_t tick = 0;
+    return (++tick % METRICS_LATENCY_SAMPLE_EVERY) == 0;
+}
+
+class MetricsCounter
+{
+public:
+    MetricsCounter() = default;
+
+    void add(uint64_t value = 1)
+    { shards[metricsThreadShard()].value.fetch_add(value, std::memory_order_relaxed); }
+
+    uint64_t value() const
+    {
+        uint64_t total = 0;
+        for(auto const &shard: shards)
+        { total += shard.value.load(std::memory_order_relaxed); }
+        return total;
+    }
+
+private:
+    MetricsCounter(MetricsCounter const &) = delete;
+
+    MetricsCounter &operator=(MetricsCounter const &) = delete;
+
+    struct alignas(64) Shard
+    {
+        std::atomic <uint64_t> value{0};
+    };
+
+    Shard shards[METRICS_THREAD_SHARDS];
+};
+
+// gauge is set from the periodic stats loops, not from the hot path, so it isn't sharded
+class MetricsGauge
+{
+public:
+    MetricsGauge() = default;
+
+    void set(int64_t new_value)
+    { gaugeValue.store(new_value, std::memory_order_relaxed); }
+
+    void add(int64_t delta)
+    { gaugeValue.fetch_add(delta, std::memory_order_relaxed); }
+
+    int64_t value() const
+    { return gaugeValue.load(std::memory_order_relaxed); }
+
+private:
+    MetricsGauge(MetricsGauge const &) = delete;
+
+    MetricsGauge &operator=(MetricsGauge const &) = delete;
+
+    std::atomic <int64_t> gaugeValue{0};
+};
+
+struct HistogramSnapshot
+{
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector <uint64_t> buckets;
+
+    // approximate value at quantile q in [0,1], the midpoint of the bucket the quantile falls into
+    uint64_t quantile(double q) const;
+};
+
+// LatencyHistogram records values (nanoseconds) into the log-linear buckets,
+// the recording is a couple of relaxed atomic increments on the thread's own shard
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() = default;
+
+    static uint32_t bucketIndex(uint64_t value)
+    {
+        if(value < METRICS_HISTOGRAM_SUB_BUCKETS)
+        { return static_cast<uint32_t>(value); }
+        uint32_t msb = 63 - __builtin_clzll(value);
+        uint32_t shift = msb - METRICS_HISTOGRAM_SUB_BUCKET_BITS;
+        return ((shift + 1) << METRICS_HISTOGRAM_SUB_BUCKET_BITS) +
+               static_cast<uint32_t>((value >> shift) & (METRICS_HISTOGRAM_SUB_BUCKETS - 1));
+    }
+
+    static uint64_t bucketLowerBound(uint32_t index)
+    {
+        if(index < METRICS_HISTOGRAM_SUB_BUCKETS)
+        { return index; }
+        uint32_t shift = (index >> METRICS_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+        uint64_t sub_bucket = METRICS_HISTOGRAM_SUB_BUCKETS + (index & (METRICS_HISTOGRAM_SUB_BUCKETS - 1));
+        return sub_bucket << shift;
+    }
+
+    void record(uint64_t value)
+    {
+        Shard &shard = shards[metricsThreadShard()];
+        shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t current_max = shard.max.load(std::memory_order_relaxed);
+        while(value > current_max &&
+              !shard.max.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+        {}
+    }
+
+    HistogramSnapshot snapshot() const;
+
+private:
+    LatencyHistogram(LatencyHistogram const &) = delete;
+
+    LatencyHistogram &operator=(LatencyHistogram const &) = delete;
+
+    struct alignas(64) Shard
+    {
+        std::atomic <uint64_t> count{0};
+        std::atomic <uint64_t> sum{0};
+        std::atomic <uint64_t> max{0};
+        std::atomic <uint64_t> buckets[METRICS_HISTOGRAM_BUCKETS]{};
+    };
+
+    Shard shards[METRICS_THREAD_SHARDS];
+};
+
+// ScopedLatency records the time spent in the enclosing scope into the histogram;
+// the hot path instances pass metricsSampleTick() so that only the sampled calls read the clock
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram *latency_histogram, bool sampled = true)
+        : histogram(sampled ? latency_histogram : nullptr)
+    {
+        if(histogram != nullptr)
+        { startTime = std::chrono::steady_clock::now(); }
+    }
+
+    ~ScopedLatency()
+    {
+        if(histogram != nullptr)
+        {
+            histogram->record(std::chrono::duration_cast <std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - startTime).count());
+        }
+    }
+
+private:
+    ScopedLatency(ScopedLatency const &) = delete;
+
+    ScopedLatency &operator=(ScopedLatency const &) = delete;
+
+    LatencyHistogram *histogram;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+// MetricsRegistry is the process wide collection of the named metrics.
+// The instrumented code looks its metrics up once and keeps the pointers,
+// the metrics live for the lifetime of the process.
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry &getInstance();
+
+    MetricsCounter *getCounter(std::string const &name);
+
+    MetricsGauge *getGauge(std::string const &name);
+
+    LatencyHistogram *getHistogram(std::string const &name);
+
+    // plain text exposition: one line per metric, "name value" for counters and gauges,
+    // "name count= sum= p50= p90= p99= max=" for histograms
+    std::string toText() const;
+
+    // writes the text exposition into the file, the file is replaced atomically
+    int dumpToFile(std::string const &file_path) const;
+
+    // starts the thread dumping the metrics into the file every interval_secs
+    int startPeriodicDump(std::string const &file_path, uint32_t interval_secs);
+
+    void stopPeriodicDump();
+
+    // compact summary of the histograms that have recorded values, sent along with the process stats
+    void getRollup(std::vector <MetricSummary> &rollup) const;
+
+private:
+    MetricsRegistry() = default;
+
+    ~MetricsRegistry();
+
+    MetricsRegistry(MetricsRegistry const &) = delete;
+
+    MetricsRegistry &operator=(MetricsRegistry const &) = delete;
+
+    void dumpLoop(std::string file_path, uint32_t interval_secs);
+
+    mutable std::mutex registryMutex;
+    std::map <std::string, MetricsCounter*> counters;
+    std::map <std::string, MetricsGauge*> gauges;
+    std::map <std::string, LatencyHistogram*> histograms;
+
+    std::mutex dumpMutex;
+    std::condition_variable dumpCondition;
+    bool dumpStopRequested = false;
+    std::thread dumpThread;
+};
+
+}//namespace
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef CHRONOLOG_METRICS_ROLLUP_H
+#define CHRONOLOG_METRICS_ROLLUP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chronolog
+{
+
+// MetricSummary is the rollup of one latency histogram a process sends along with its periodic stats message
+struct MetricSummary
+{
+    std::string name;
+    uint64_t count = 0;
+    uint64_t sum = 0;   // nanoseconds
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & name;
+        serT & count;
+        serT & sum;
+        serT & p50;
+        serT & p99;
+        serT & max;
+    }
+};
+
+inline std::string to_string(std::vector <MetricSummary> const &rollup)
+{
+    std::string rollup_string("{");
+    for(auto const &summary: rollup)
+    {
+        rollup_string += summary.name + "{count:" + std::to_string(summary.count) + " p50:" +
+                         std::to_string(summary.p50) + " p99:" + std::to_string(summary.p99) + " max:" +
+                         std::to_string(summary.max) + "}";
+    }
+    rollup_string += "}";
+    return rollup_string;
+}
+
+}//namespace
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef PLAYBACK_EVENT_SELECTOR_H
+#define PLAYBACK_EVENT_SELECTOR_H
+
+#include <vector>
+#include <string>
+#include <regex>
+#include <random>
+#include <algorithm>
+#include <string_view>
+
+#include "chrono_monitor.h"
+#include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::PlaybackFilter definition
+#include "StoryChunk.h"
+
+namespace chronolog
+{
+
+// PlaybackEventSelector evaluates the PlaybackFilter of a single playback query.
+// Events are offered to the selector in time order as they are read from the archive,
+// so that only the selected events are copied into the StoryChunks sent back to the client.
+// The selector is stateful (sampling counters, limit, reservoir) and is not thread safe,
+// one instance is to be used per playback query.
+
+class PlaybackEventSelector
+{
+public:
+    explicit PlaybackEventSelector(PlaybackFilter const &playback_filter = PlaybackFilter()
+                                   , uint64_t random_seed = std::random_device{}())
+        : filter(playback_filter)
+        , regexIsValid(false)
+        , matchedCount(0)
+        , sampledCount(0)
+        , selectedCount(0)
+        , hasArchiveHorizon(false)
+        , archiveHorizon(0, 0, 0)
+        , randomEngine(random_seed)
+    {
+        std::sort(filter.clientIds.begin(), filter.clientIds.end());
+
+        if(filter.patternIsRegex && !filter.recordPattern.empty())
+        {
+            try
+            {
+                recordRegex = std::regex(filter.recordPattern, std::regex::ECMAScript | std::regex::optimize);
+                regexIsValid = true;
+            }
+            catch(std::regex_error const &ex)
+            {
+                LOG_WARNING("[PlaybackEventSelector] Invalid regex '{}' : {}; using it as plain substring"
+                            , filter.recordPattern, ex.what());
+            }
+        }
+    }
+
+    // returns false if the filter can not be evaluated (malformed regex)
+    static bool is_valid_filter(PlaybackFilter const &playback_filter)
+    {
+        if(!playback_filter.patternIsRegex || playback_filter.recordPattern.empty())
+        { return true; }
+
+        try
+        {
+            std::regex(playback_filter.recordPattern, std::regex::ECMAScript);
+        }
+        catch(std::regex_error const &)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool is_pass_through() const
+    { return filter.is_pass_through(); }
+
+    // the limit has been reached, no further event will be selected
+    bool is_exhausted() const
+    { return (filter.reservoirSize == 0 && filter.limit != 0 && selectedCount >= filter.limit); }
+
+    uint64_t getMatchedCount() const
+    { return matchedCount; }
+
+    // events up to the horizon have been offered to the selector from the archive,
+    // the in-memory copies of these events must not be offered again
+    void advanceArchiveHorizon(EventSequence const &event_sequence)
+    {
+        if(!hasArchiveHorizon || archiveHorizon < event_sequence)
+        {
+            archiveHorizon = event_sequence;
+            hasArchiveHorizon = true;
+        }
+    }
+
+    bool isArchived(EventSequence const &event_sequence) const
+    { return (hasArchiveHorizon && !(archiveHorizon < event_sequence)); }
+
+    // stateless part of the filter : client set and log record pattern
+    bool matches(ClientId const &client_id, std::string_view const &record) const
+    {
+        if(!filter.clientIds.empty() &&
+           !std::binary_search(filter.clientIds.begin(), filter.clientIds.end(), client_id))
+        { return false; }
+
+        if(filter.recordPattern.empty())
+        { return true; }
+
+        if(regexIsValid)
+        { return std::regex_search(record.begin(), record.end(), recordRegex); }
+
+        return (record.find(filter.recordPattern) != std::string_view::npos);
+    }
+
+    // Returns true if the event is selected by the filter and is to be kept with keep().
+    // Takes the raw event fields so that the rejected events are never copied.
+    bool select(ClientId const &client_id, std::string_view const &record)
+    {
+        if(is_exhausted() || !matches(client_id, record))
+        { return false; }
+
+        matchedCount++;
+        if(filter.sampleEveryNth > 1 && ((matchedCount - 1) % filter.sampleEveryNth) != 0)
+        { return false; }
+
+        sampledCount++;
+        if(filter.reservoirSize == 0)
+        { selectedCount++; }
+
+        return true;
+    }
+
+    // Inserts the selected event into the target chunk,
+    // in reservoir sampling mode the event is offered to the reservoir instead (Algorithm R)
+    // and the sample is handed over by drainReservoir() once all the events have been offered.
+    void keep(StoryChunk &target_chunk, LogEvent const &event)
+    {
+        if(filter.reservoirSize == 0)
+        {
+            target_chunk.insertEvent(event);
+        }
+        else if(reservoir.size() < filter.reservoirSize)
+        {
+            reservoir.push_back(event);
+        }
+        else
+        {
+            std::uniform_int_distribution <uint64_t> distribution(0, sampledCount - 1);
+            uint64_t slot = distribution(randomEngine);
+            if(slot < filter.reservoirSize)
+            { reservoir[slot] = event; }
+        }
+    }
+
+    // Offers the recent in-memory events after the archived ones. The in-memory copies of the events
+    // already offered from the archive are skipped so that they don't count twice against the sampling and the limit.
+    void selectRecentEvents(StoryChunk const &recent_chunk, StoryChunk &target_chunk)
+    {
+        for(auto const &event_record: recent_chunk)
+        {
+            if(is_exhausted())
+            { break; }
+            if(isArchived(event_record.first))
+            { continue; }
+
+            if(select(event_record.second.getClientId(), event_record.second.getRecord()))
+            { keep(target_chunk, event_record.second); }
+        }
+    }
+
+    // move the reservoir sample into the target chunk
+    uint32_t drainReservoir(StoryChunk &target_chunk)
+    {
+        uint32_t event_count = 0;
+        for(auto const &event: reservoir)
+        {
+            if(target_chunk.insertEvent(event) == 1)
+            { event_count++; }
+        }
+        reservoir.clear();
+        return event_count;
+    }
+
+private:
+    PlaybackFilter filter;
+    std::regex recordRegex;
+    bool regexIsValid;
+    uint64_t matchedCount;
+    uint64_t sampledCount;
+    uint64_t selectedCount;
+    bool hasArchiveHorizon;
+    EventSequence archiveHorizon;
+    std::vector <LogEvent> reservoir;
+    std::mt19937_64 randomEngine;
+};
+
+}
+
+#endif
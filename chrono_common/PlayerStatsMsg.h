@@ -2,17 +2,41 @@
 #define PLAYER_STATS_MSG_H
 
 #include <iostream>
+#include <vector>
 #include "PlayerIdCard.h"
+#include "MetricsRollup.h"
 
 
 namespace chronolog
 {
 
+// archive reading queue statistics of one priority class, latencies are in nanoseconds
+// and cover the requests completed since the previous stats message
+struct ReadingClassStats
+{
+    uint32_t queueDepth = 0;
+    uint64_t completedRequests = 0;
+    uint64_t meanLatency = 0;
+    uint64_t maxLatency = 0;
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT & serT)
+    {
+        serT & queueDepth;
+        serT & completedRequests;
+        serT & meanLatency;
+        serT & maxLatency;
+    }
+};
+
 class PlayerStatsMsg
 {
 
     PlayerIdCard playerIdCard;
     uint32_t active_story_count;
+    ReadingClassStats interactive_reading_stats;
+    ReadingClassStats bulk_reading_stats;
+    std::vector <MetricSummary> metrics_rollup;  // latency summaries of the playback queries
 
 public:
 
@@ -30,18 +54,46 @@ public:
     uint32_t getActiveStoryCount() const
     { return active_story_count; }
 
+    ReadingClassStats const & getInteractiveReadingStats() const
+    { return interactive_reading_stats; }
+
+    ReadingClassStats const & getBulkReadingStats() const
+    { return bulk_reading_stats; }
+
+    void setReadingStats(ReadingClassStats const & interactive_stats, ReadingClassStats const & bulk_stats)
+    {
+        interactive_reading_stats = interactive_stats;
+        bulk_reading_stats = bulk_stats;
+    }
+
+    std::vector <MetricSummary> const & getMetricsRollup() const
+    { return metrics_rollup; }
+
+    void setMetricsRollup(std::vector <MetricSummary> const & rollup)
+    { metrics_rollup = rollup; }
+
     template <typename SerArchiveT>
     void serialize(SerArchiveT & serT)
     {
         serT & playerIdCard;
         serT & active_story_count;
+        serT & interactive_reading_stats;
+        serT & bulk_reading_stats;
+        serT & metrics_rollup;
     }
 
 };
 
+inline std::string to_string(chronolog::ReadingClassStats const &stats)
+{
+    return std::string("{depth:") + std::to_string(stats.queueDepth) + " completed:" + std::to_string(stats.completedRequests)
+           + " meanLatency:" + std::to_string(stats.meanLatency) + " maxLatency:" + std::to_string(stats.maxLatency) + "}";
+}
+
 inline std::string to_string(chronolog::PlayerStatsMsg const &stats_msg)
 {
-    return std::string("PlayerStatsMsg{") + to_string(stats_msg.getPlayerIdCard()) + "}";
+    return std::string("PlayerStatsMsg{") + to_string(stats_msg.getPlayerIdCard()) + "}{interactive:"
+           + to_string(stats_msg.getInteractiveReadingStats()) + " bulk:" + to_string(stats_msg.getBulkReadingStats()) + "}";
 }
 
 
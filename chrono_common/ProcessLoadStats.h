@@ -0,0 +1,85 @@
+#ifndef PROCESS_LOAD_STATS_H
+#define PROCESS_LOAD_STATS_H
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "chronolog_types.h"
+
+namespace chronolog
+{
+
+// ProcessLoadStats is the load snapshot a recording process (Keeper or Grapher) sends
+// with its periodic stats message, ChronoVisor uses it for RecordingGroup placement of new stories
+
+struct ProcessLoadStats
+{
+    uint64_t ingestionRate = 0;        // events per second ingested over the last stats interval
+    uint32_t ingestionQueueDepth = 0;  // events (Keeper) or chunks (Grapher) waiting to be placed into the data store
+    uint32_t extractionQueueDepth = 0; // story chunks waiting for extraction
+    uint64_t residentMemory = 0;       // resident set size of the process in bytes
+    uint32_t capacity = 0;             // relative processing capacity of the process, the number of hardware threads
+    uint64_t throttleRate = 0;         // events per second rejected over the story event rate limits (Keeper only)
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & ingestionRate;
+        serT & ingestionQueueDepth;
+        serT & extractionQueueDepth;
+        serT & residentMemory;
+        serT & capacity;
+        serT & throttleRate;
+    }
+};
+
+// StoryLoad is the ingestion rate of one of the hottest stories a Keeper reports,
+// ChronoVisor picks the stories to migrate off the overloaded RecordingGroups from these
+
+struct StoryLoad
+{
+    StoryId storyId = 0;
+    uint64_t ingestionRate = 0;        // events per second ingested over the last stats interval
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & storyId;
+        serT & ingestionRate;
+    }
+};
+
+inline std::string to_string(ProcessLoadStats const &load_stats)
+{
+    return std::string("{ingestionRate:") + std::to_string(load_stats.ingestionRate) + " ingestionQueue:" +
+           std::to_string(load_stats.ingestionQueueDepth) + " extractionQueue:" +
+           std::to_string(load_stats.extractionQueueDepth) + " residentMemory:" +
+           std::to_string(load_stats.residentMemory) + " capacity:" + std::to_string(load_stats.capacity) + " throttleRate:" +
+           std::to_string(load_stats.throttleRate) + "}";
+}
+
+// resident set size of the calling process, 0 if it can't be read
+inline uint64_t getResidentMemory()
+{
+    uint64_t total_pages = 0;
+    uint64_t resident_pages = 0;
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if(statm == nullptr)
+    { return 0; }
+    if(std::fscanf(statm, "%lu %lu", &total_pages, &resident_pages) != 2)
+    { resident_pages = 0; }
+    std::fclose(statm);
+    return resident_pages * sysconf(_SC_PAGESIZE);
+}
+
+inline uint32_t getProcessCapacity()
+{
+    uint32_t hardware_threads = std::thread::hardware_concurrency();
+    return (hardware_threads == 0 ? 1 : hardware_threads);
+}
+
+}
+
+#endif
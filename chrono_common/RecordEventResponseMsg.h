@@ -0,0 +1,51 @@
+#ifndef RECORD_EVENT_RESPONSE_MSG_H
+#define RECORD_EVENT_RESPONSE_MSG_H
+
+#include <iostream>
+#include "chronolog_types.h"
+
+namespace chronolog
+{
+
+// the Keeper piggybacks its clock on the record_event response,
+// the client running the hybrid logical clock merges it into its own
+class RecordEventResponseMsg
+{
+    int error_code;
+    uint64_t clockTime;
+
+public:
+
+    RecordEventResponseMsg(): error_code(chronolog::CL_SUCCESS), clockTime(0)
+    {}
+
+    RecordEventResponseMsg(int code, uint64_t clock_time): error_code(code), clockTime(clock_time)
+    {}
+
+    ~RecordEventResponseMsg() = default;
+
+    int getErrorCode() const
+    { return error_code; }
+
+    uint64_t getClockTime() const
+    { return clockTime; }
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT&error_code;
+        serT&clockTime;
+    }
+
+};
+
+}//namespace
+
+
+inline std::ostream &operator<<(std::ostream &out, chronolog::RecordEventResponseMsg const &msg)
+{
+    out << "RecordEventResponseMsg{" << msg.getErrorCode() << "}{clock:" << msg.getClockTime() << "}";
+    return out;
+}
+
+#endif
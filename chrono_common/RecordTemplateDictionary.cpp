@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "RecordTemplateDictionary.h"
+
+namespace chl = chronolog;
+
+#define RECORD_TEMPLATE_DICTIONARY_MAGIC 0x44544352 // "RCTD"
+#define RECORD_TEMPLATE_DICTIONARY_VERSION 1
+
+// a template has to be shared by at least this many records of the chunk to go into the dictionary
+#define RECORD_TEMPLATE_MIN_USES 2
+#define RECORD_TEMPLATE_MAX_COUNT 65536
+// the encoded records and the dictionary have to take at least this much less space than the verbatim records
+#define RECORD_TEMPLATE_MIN_SAVING_PERCENT 10
+
+// the parameter slot in the template, the records containing it are not templated
+#define RECORD_TEMPLATE_SLOT '\0'
+
+// the first byte of the encoded record
+#define RECORD_VERBATIM 0
+#define RECORD_TEMPLATED 1
+
+namespace
+{
+
+void appendVarint(std::string &buffer, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+bool consumeVarint(std::string_view &buffer, uint64_t &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && !buffer.empty(); shift += 7)
+    {
+        uint8_t byte = static_cast<uint8_t>(buffer.front());
+        buffer.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0)
+        { return true; }
+    }
+    return false;
+}
+
+size_t varintSize(uint64_t value)
+{
+    size_t size = 1;
+    for(; value >= 0x80; value >>= 7)
+    { size++; }
+    return size;
+}
+
+bool isDelimiter(char c)
+{ return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || (c != '\0' && std::strchr(",;:=()[]{}<>\"'|/", c))); }
+
+// splits the record into its template and parameters, returns false if the record can't be templated
+bool mineTemplate(std::string_view record, std::string &record_template, std::vector <std::string_view> &parameters)
+{
+    if(record.find(RECORD_TEMPLATE_SLOT) != std::string_view::npos)
+    { return false; }
+
+    record_template.clear();
+    parameters.clear();
+    size_t pos = 0;
+    while(pos < record.size())
+    {
+        if(isDelimiter(record[pos]))
+        {
+            record_template.push_back(record[pos++]);
+            continue;
+        }
+        size_t token_end = pos;
+        bool has_digit = false;
+        for(; token_end < record.size() && !isDelimiter(record[token_end]); ++token_end)
+        { has_digit = has_digit || (record[token_end] >= '0' && record[token_end] <= '9'); }
+
+        if(has_digit)
+        {
+            record_template.push_back(RECORD_TEMPLATE_SLOT);
+            parameters.push_back(record.substr(pos, token_end - pos));
+        }
+        else
+        { record_template.append(record.substr(pos, token_end - pos)); }
+        pos = token_end;
+    }
+    return true;
+}
+
+struct MinedRecord
+{
+    size_t templateIndex;
+    std::vector <std::string_view> parameters;
+};
+
+}
+
+////////////////////////
+
+bool chronolog::RecordTemplateDictionary::encodeRecords(std::vector <std::string_view> const &records
+                                                        , std::vector <std::string> &encoded_records
+                                                        , std::string &encoded_dictionary)
+{
+    encoded_records.clear();
+    encoded_dictionary.clear();
+
+    // mining pass: the template of every record and the number of records sharing it
+    size_t const not_templated = std::numeric_limits <size_t>::max();
+    std::unordered_map <std::string, size_t> template_indexes;
+    std::vector <std::string const*> mined_templates;
+    std::vector <uint64_t> template_uses;
+    std::vector <MinedRecord> mined_records(records.size());
+    std::string record_template;
+    uint64_t record_bytes = 0;
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        record_bytes += records[i].size();
+        mined_records[i].templateIndex = not_templated;
+        if(!mineTemplate(records[i], record_template, mined_records[i].parameters))
+        { continue; }
+
+        auto insert_return = template_indexes.emplace(record_template, mined_templates.size());
+        if(insert_return.second)
+        {
+            mined_templates.push_back(&(*insert_return.first).first);
+            template_uses.push_back(0);
+        }
+        mined_records[i].templateIndex = (*insert_return.first).second;
+        template_uses[mined_records[i].templateIndex]++;
+    }
+
+    // the shared templates that save space get the dictionary ids in the order of their first use
+    std::vector <uint64_t> template_ids(mined_templates.size(), not_templated);
+    std::vector <std::string const*> dictionary_templates;
+    for(size_t index = 0; index < mined_templates.size() && dictionary_templates.size() < RECORD_TEMPLATE_MAX_COUNT
+            ; ++index)
+    {
+        std::string const &mined_template = *mined_templates[index];
+        size_t slot_count = std::count(mined_template.begin(), mined_template.end(), RECORD_TEMPLATE_SLOT);
+        if(template_uses[index] < RECORD_TEMPLATE_MIN_USES
+           || mined_template.size() - slot_count <= varintSize(dictionary_templates.size()) + slot_count)
+        { continue; }
+        template_ids[index] = dictionary_templates.size();
+        dictionary_templates.push_back(&mined_template);
+    }
+    if(dictionary_templates.empty())
+    { return false; }
+
+    uint32_t magic = RECORD_TEMPLATE_DICTIONARY_MAGIC;
+    encoded_dictionary.append(reinterpret_cast<char const*>(&magic), sizeof(magic));
+    encoded_dictionary.push_back(static_cast<char>(RECORD_TEMPLATE_DICTIONARY_VERSION));
+    appendVarint(encoded_dictionary, dictionary_templates.size());
+    for(std::string const*dictionary_template: dictionary_templates)
+    {
+        appendVarint(encoded_dictionary, dictionary_template->size());
+        encoded_dictionary.append(*dictionary_template);
+    }
+
+    // encoding pass
+    uint64_t encoded_bytes = encoded_dictionary.size();
+    encoded_records.resize(records.size());
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        std::string &encoded_record = encoded_records[i];
+        MinedRecord const &mined_record = mined_records[i];
+        if(mined_record.templateIndex == not_templated || template_ids[mined_record.templateIndex] == not_templated)
+        {
+            encoded_record.reserve(records[i].size() + 1);
+            encoded_record.push_back(static_cast<char>(RECORD_VERBATIM));
+            encoded_record.append(records[i]);
+        }
+        else
+        {
+            encoded_record.push_back(static_cast<char>(RECORD_TEMPLATED));
+            appendVarint(encoded_record, template_ids[mined_record.templateIndex]);
+            for(std::string_view const &parameter: mined_record.parameters)
+            {
+                appendVarint(encoded_record, parameter.size());
+                encoded_record.append(parameter);
+            }
+        }
+        encoded_bytes += encoded_record.size();
+    }
+
+    if(encoded_bytes * 100 > record_bytes * (100 - RECORD_TEMPLATE_MIN_SAVING_PERCENT))
+    {
+        encoded_records.clear();
+        encoded_dictionary.clear();
+        return false;
+    }
+    return true;
+}
+
+////////////////////////
+
+bool chronolog::RecordTemplateDictionary::decode(std::string_view buffer)
+{
+    templates.clear();
+    uint32_t magic = 0;
+    if(buffer.size() < sizeof(magic) + 1)
+    { return false; }
+    std::memcpy(&magic, buffer.data(), sizeof(magic));
+    buffer.remove_prefix(sizeof(magic));
+    uint8_t version = static_cast<uint8_t>(buffer.front());
+    buffer.remove_prefix(1);
+    if(magic != RECORD_TEMPLATE_DICTIONARY_MAGIC || version != RECORD_TEMPLATE_DICTIONARY_VERSION)
+    { return false; }
+
+    uint64_t template_count = 0;
+    if(!consumeVarint(buffer, template_count) || template_count > RECORD_TEMPLATE_MAX_COUNT)
+    { return false; }
+    templates.reserve(template_count);
+    for(uint64_t i = 0; i < template_count; ++i)
+    {
+        uint64_t template_size = 0;
+        if(!consumeVarint(buffer, template_size) || template_size > buffer.size())
+        {
+            templates.clear();
+            return false;
+        }
+        templates.emplace_back(buffer.substr(0, template_size));
+        buffer.remove_prefix(template_size);
+    }
+    return true;
+}
+
+////////////////////////
+
+bool chronolog::RecordTemplateDictionary::decodeRecord(std::string_view encoded_record, std::string &record) const
+{
+    record.clear();
+    if(encoded_record.empty())
+    { return false; }
+    uint8_t record_kind = static_cast<uint8_t>(encoded_record.front());
+    encoded_record.remove_prefix(1);
+    if(record_kind == RECORD_VERBATIM)
+    {
+        record.assign(encoded_record);
+        return true;
+    }
+
+    uint64_t template_id = 0;
+    if(record_kind != RECORD_TEMPLATED || !consumeVarint(encoded_record, template_id) || template_id >= templates.size())
+    { return false; }
+
+    std::string const &record_template = templates[template_id];
+    record.reserve(record_template.size() + encoded_record.size());
+    for(char c: record_template)
+    {
+        if(c != RECORD_TEMPLATE_SLOT)
+        {
+            record.push_back(c);
+            continue;
+        }
+        uint64_t parameter_size = 0;
+        if(!consumeVarint(encoded_record, parameter_size) || parameter_size > encoded_record.size())
+        { return false; }
+        record.append(encoded_record.substr(0, parameter_size));
+        encoded_record.remove_prefix(parameter_size);
+    }
+    return encoded_record.empty();
+}
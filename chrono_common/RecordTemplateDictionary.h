@@ -0,0 +1,45 @@
+#ifndef RECORD_TEMPLATE_DICTIONARY_H
+#define RECORD_TEMPLATE_DICTIONARY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chronolog
+{
+
+// RecordTemplateDictionary is the template-mining encoding of the log records of a StoryChunk.
+// The tokens of a record that contain a digit are its parameters, the rest of the record is its template:
+// "open /data/f17.h5 took 38 ms" is the template "open /data/\0 took \0 ms" with the parameters "f17.h5" and "38".
+// The templates shared by several records of the chunk go into the dictionary archived next to the events,
+// these records are archived as the template id followed by their parameters and the other records verbatim.
+// The dictionary is built for one chunk at a time, so that every archived chunk file can be decoded on its own.
+
+class RecordTemplateDictionary
+{
+public:
+    RecordTemplateDictionary() = default;
+
+    ~RecordTemplateDictionary() = default;
+
+    size_t getTemplateCount() const
+    { return templates.size(); }
+
+    // encodes the records and the dictionary of their templates;
+    // returns false and leaves the outputs empty if the encoding wouldn't make the records noticeably smaller
+    static bool encodeRecords(std::vector <std::string_view> const &records, std::vector <std::string> &encoded_records
+                              , std::string &encoded_dictionary);
+
+    // versioned binary form persisted in the archive
+    bool decode(std::string_view buffer);
+
+    // restores the original record from the encoded one, returns false if the encoded record is malformed
+    bool decodeRecord(std::string_view encoded_record, std::string &record) const;
+
+private:
+    std::vector <std::string> templates;
+};
+
+}
+
+#endif
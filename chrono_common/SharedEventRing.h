@@ -0,0 +1,389 @@
+#ifndef CHRONOLOG_SHARED_EVENT_RING_H
+#define CHRONOLOG_SHARED_EVENT_RING_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "chronolog_types.h"
+#include "chrono_monitor.h"
+
+#define SHARED_EVENT_RING_MAGIC 0x43484c52   // "CHLR"
+// version 2: the head is advanced by compare and swap, the producer takes back the unconsumed events
+#define SHARED_EVENT_RING_VERSION 2
+// the migrated stories are reported back to the producer through this many slots indexed by the story id
+#define SHARED_EVENT_RING_MIGRATED_SLOTS 16
+
+namespace chronolog
+{
+
+// the fields shared by the producer and the consumer processes, at the start of the segment;
+// the tail is only written by the producer and the head by the consumer, or by the producer that takes back
+// the unconsumed events once it has closed the ring; they are kept on separate cache lines
+struct SharedEventRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;         // bytes of the record area following the header, a power of two
+    int32_t producerPid;
+    alignas(64) std::atomic <uint64_t> tail;    // bytes ever written by the producer
+    // bytes ever consumed by the consumer or taken back by the closed producer, advanced by compare and swap
+    alignas(64) std::atomic <uint64_t> head;
+    alignas(64) std::atomic <uint64_t> consumerClock;     // hybrid logical clock of the consumer
+    std::atomic <uint64_t> consumerPollTime;  // steady clock milliseconds of the last consumer poll round
+    std::atomic <uint64_t> migratedStories[SHARED_EVENT_RING_MIGRATED_SLOTS];
+    std::atomic <uint32_t> producerClosed;
+    std::atomic <uint32_t> consumerClosed;
+};
+
+// the record is 8 bytes aligned, the padding record fills the end of the area the next record doesn't fit into
+struct SharedEventRecordHeader
+{
+    uint32_t recordLength;     // payload bytes, SHARED_EVENT_RING_PADDING for the padding record
+    uint32_t eventIndex;
+    uint64_t storyId;
+    uint64_t clientId;
+    uint64_t eventTime;
+};
+
+#define SHARED_EVENT_RING_PADDING UINT32_MAX
+
+static_assert(std::atomic <uint64_t>::is_always_lock_free, "SharedEventRing needs lock free 64 bit atomics");
+
+// SharedEventRing is a single producer single consumer ring of LogEvents in a POSIX shared memory segment,
+// the transport of the events from a client process to the ChronoKeeper running on the same node.
+// The client creates the segment and writes the events, the keeper attaches to it and polls the events out;
+// the keeper hands its clock and the stories migrated to another RecordingGroup back through the segment header.
+// Neither side blocks on the other: the full ring is reported to the producer and the empty one to the consumer.
+// Each side does its own locking if it has more than one thread using the ring.
+// The producer that gives up on the stalled consumer takes back the events the consumer hasn't consumed yet;
+// each event is either consumed or taken back, whichever side moves the head past it first.
+class SharedEventRing
+{
+public:
+    // producer side: creates the new segment with the record area of capacity bytes (rounded up to a power of two),
+    // returns nullptr if the segment can't be created
+    static SharedEventRing*CreateSharedEventRing(std::string const &shm_name, uint64_t capacity)
+    {
+        uint64_t ring_capacity = 4096;
+        while(ring_capacity < capacity)
+        { ring_capacity <<= 1; }
+
+        int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if(fd < 0)
+        {
+            LOG_ERROR("[SharedEventRing] Failed to create shared memory segment {}: {}", shm_name, strerror(errno));
+            return nullptr;
+        }
+        size_t segment_size = sizeof(SharedEventRingHeader) + ring_capacity;
+        void*segment = MAP_FAILED;
+        if(ftruncate(fd, segment_size) == 0)
+        { segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); }
+        close(fd);
+        if(segment == MAP_FAILED)
+        {
+            LOG_ERROR("[SharedEventRing] Failed to map shared memory segment {}: {}", shm_name, strerror(errno));
+            shm_unlink(shm_name.c_str());
+            return nullptr;
+        }
+
+        SharedEventRingHeader*header = new(segment) SharedEventRingHeader;
+        header->capacity = ring_capacity;
+        header->producerPid = getpid();
+        header->tail.store(0, std::memory_order_relaxed);
+        header->head.store(0, std::memory_order_relaxed);
+        header->consumerClock.store(0, std::memory_order_relaxed);
+        header->consumerPollTime.store(0, std::memory_order_relaxed);
+        for(auto &migrated_story: header->migratedStories)
+        { migrated_story.store(0, std::memory_order_relaxed); }
+        header->producerClosed.store(0, std::memory_order_relaxed);
+        header->consumerClosed.store(0, std::memory_order_relaxed);
+        header->version = SHARED_EVENT_RING_VERSION;
+        // the magic is written last, the consumer rejects the segment that isn't fully initialized
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SHARED_EVENT_RING_MAGIC;
+        return new SharedEventRing(shm_name, segment, segment_size);
+    }
+
+    // consumer side: maps the existing segment created by the producer,
+    // returns nullptr if the segment doesn't exist or isn't a SharedEventRing of this version
+    static SharedEventRing*AttachSharedEventRing(std::string const &shm_name)
+    {
+        int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+        if(fd < 0)
+        {
+            LOG_ERROR("[SharedEventRing] Failed to open shared memory segment {}: {}", shm_name, strerror(errno));
+            return nullptr;
+        }
+        struct stat segment_stat;
+        void*segment = MAP_FAILED;
+        if(fstat(fd, &segment_stat) == 0 && static_cast<size_t>(segment_stat.st_size) > sizeof(SharedEventRingHeader))
+        { segment = mmap(nullptr, segment_stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); }
+        close(fd);
+        if(segment == MAP_FAILED)
+        {
+            LOG_ERROR("[SharedEventRing] Failed to map shared memory segment {}", shm_name);
+            return nullptr;
+        }
+
+        SharedEventRingHeader*header = static_cast<SharedEventRingHeader*>(segment);
+        uint64_t capacity = header->capacity;
+        if(header->magic != SHARED_EVENT_RING_MAGIC || header->version != SHARED_EVENT_RING_VERSION
+           || capacity == 0 || (capacity & (capacity - 1)) != 0
+           || sizeof(SharedEventRingHeader) + capacity != static_cast<size_t>(segment_stat.st_size))
+        {
+            LOG_ERROR("[SharedEventRing] Shared memory segment {} is not a valid event ring", shm_name);
+            munmap(segment, segment_stat.st_size);
+            return nullptr;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return new SharedEventRing(shm_name, segment, segment_stat.st_size);
+    }
+
+    // the segment stays mapped by the processes that have attached to it after its name is unlinked
+    static void unlink(std::string const &shm_name)
+    { shm_unlink(shm_name.c_str()); }
+
+    ~SharedEventRing()
+    { munmap(header, segmentSize); }
+
+    std::string const &getName() const
+    { return shmName; }
+
+    uint64_t getCapacity() const
+    { return header->capacity; }
+
+    // the record of the event bigger than half the ring would stall the ring, it has to go some other way
+    bool canHold(LogEvent const &event) const
+    { return (recordSize(event.logRecord.size()) <= header->capacity / 2); }
+
+    /// producer side _______________________________________________________________________________________________
+
+    // returns false if the ring has no room for the event right now
+    bool tryPush(LogEvent const &event)
+    {
+        uint64_t record_size = recordSize(event.logRecord.size());
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        uint64_t offset = tail & (header->capacity - 1);
+        uint64_t contiguous = header->capacity - offset;
+        uint64_t needed = (contiguous < record_size ? contiguous + record_size : record_size);
+        if(!canHold(event) || tail + needed - header->head.load(std::memory_order_acquire) > header->capacity)
+        { return false; }
+
+        if(contiguous < record_size)
+        {
+            reinterpret_cast<SharedEventRecordHeader*>(records + offset)->recordLength = SHARED_EVENT_RING_PADDING;
+            tail += contiguous;
+            offset = 0;
+        }
+        SharedEventRecordHeader*record = reinterpret_cast<SharedEventRecordHeader*>(records + offset);
+        record->recordLength = event.logRecord.size();
+        record->eventIndex = event.eventIndex;
+        record->storyId = event.storyId;
+        record->clientId = event.clientId;
+        record->eventTime = event.eventTime;
+        memcpy(records + offset + sizeof(SharedEventRecordHeader), event.logRecord.data(), event.logRecord.size());
+        header->tail.store(tail + record_size, std::memory_order_release);
+        return true;
+    }
+
+    // the consumer hasn't polled the ring for longer than timeout_msecs
+    bool isConsumerStalled(uint64_t timeout_msecs) const
+    {
+        uint64_t poll_time = header->consumerPollTime.load(std::memory_order_relaxed);
+        return (poll_time + timeout_msecs < steadyClockMillis());
+    }
+
+    bool isConsumerClosed() const
+    { return (header->consumerClosed.load(std::memory_order_acquire) != 0); }
+
+    uint64_t getConsumerClock() const
+    { return header->consumerClock.load(std::memory_order_relaxed); }
+
+    // returns true once for the story the consumer has reported migrated since the last call
+    bool takeStoryMigrated(StoryId story_id)
+    {
+        uint64_t migrated_story = story_id;
+        return header->migratedStories[story_id % SHARED_EVENT_RING_MIGRATED_SLOTS].compare_exchange_strong(
+                migrated_story, 0, std::memory_order_relaxed);
+    }
+
+    void closeProducer()
+    { header->producerClosed.store(1, std::memory_order_release); }
+
+    // takes back the oldest event the consumer hasn't consumed, returns false once the ring is empty;
+    // called after closeProducer, the consumer may still be polling the ring
+    bool reclaim(LogEvent &event)
+    {
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        // the records between the head and the tail were written by this producer, only the head can move
+        while(head != tail && tail - head <= header->capacity)
+        {
+            uint64_t offset = head & (header->capacity - 1);
+            SharedEventRecordHeader*record = reinterpret_cast<SharedEventRecordHeader*>(records + offset);
+            bool is_padding = (record->recordLength == SHARED_EVENT_RING_PADDING);
+            uint64_t next_head = head + (is_padding ? header->capacity - offset : recordSize(record->recordLength));
+            if(!is_padding)
+            {
+                event.storyId = record->storyId;
+                event.eventTime = record->eventTime;
+                event.clientId = record->clientId;
+                event.eventIndex = record->eventIndex;
+                event.logRecord.assign(reinterpret_cast<char const*>(record) + sizeof(SharedEventRecordHeader)
+                                       , record->recordLength);
+            }
+            // the failed exchange reloads the head the consumer has moved past the record
+            if(header->head.compare_exchange_strong(head, next_head, std::memory_order_acq_rel
+                                                    , std::memory_order_acquire))
+            {
+                if(!is_padding)
+                { return true; }
+                head = next_head;
+            }
+        }
+        return false;
+    }
+
+    /// consumer side _______________________________________________________________________________________________
+
+    // reads the oldest event in the ring without consuming it, returns false if the ring is empty
+    // or if the producer has written a record that doesn't fit in the ring, the ring is then corrupted for good
+    bool peek(LogEvent &event)
+    {
+        if(corrupted)
+        { return false; }
+
+        uint64_t head = header->head.load(std::memory_order_relaxed);
+        uint64_t tail = header->tail.load(std::memory_order_acquire);
+        if(head == tail)
+        { return false; }
+        if(tail - head > header->capacity)
+        { return markCorrupted(head, tail); }
+
+        uint64_t offset = head & (header->capacity - 1);
+        // the record length is read once, the producer process can't change it between the check and the copy
+        uint32_t record_length = reinterpret_cast<SharedEventRecordHeader*>(records + offset)->recordLength;
+        if(record_length == SHARED_EVENT_RING_PADDING)
+        {
+            // the padding is consumed right away, the next record starts at the beginning of the area
+            uint64_t padded_head = head + header->capacity - offset;
+            if(padded_head > tail)
+            { return markCorrupted(padded_head, tail); }
+            // the closed producer may have taken back the records past the padding
+            if(!header->head.compare_exchange_strong(head, padded_head, std::memory_order_acq_rel))
+            { return false; }
+            head = padded_head;
+            if(head == tail)
+            { return false; }
+            offset = 0;
+            record_length = reinterpret_cast<SharedEventRecordHeader*>(records)->recordLength;
+        }
+        uint64_t record_size = recordSize(record_length);
+        if(record_length == SHARED_EVENT_RING_PADDING || record_size > header->capacity - offset
+           || record_size > tail - head)
+        { return markCorrupted(head, tail); }
+
+        SharedEventRecordHeader*record = reinterpret_cast<SharedEventRecordHeader*>(records + offset);
+        event.storyId = record->storyId;
+        event.eventTime = record->eventTime;
+        event.clientId = record->clientId;
+        event.eventIndex = record->eventIndex;
+        event.logRecord.assign(reinterpret_cast<char const*>(record) + sizeof(SharedEventRecordHeader), record_length);
+        peekedHead = head;
+        peekedSize = record_size;
+        return true;
+    }
+
+    // the producer has written past the ring bounds, the consumer has to detach from the ring
+    bool isCorrupted() const
+    { return corrupted; }
+
+    // consumes the event returned by the last peek,
+    // returns false if the producer has taken the event back in the meantime, the event is then not to be used
+    bool pop()
+    {
+        uint64_t head = peekedHead;
+        uint64_t record_size = peekedSize;
+        peekedSize = 0;
+        return header->head.compare_exchange_strong(head, head + record_size, std::memory_order_acq_rel);
+    }
+
+    bool isEmpty() const
+    { return (header->head.load(std::memory_order_relaxed) == header->tail.load(std::memory_order_acquire)); }
+
+    // the consumer poll round publishes its clock and its liveness to the producer
+    void publishConsumerState(uint64_t consumer_clock)
+    {
+        header->consumerClock.store(consumer_clock, std::memory_order_relaxed);
+        header->consumerPollTime.store(steadyClockMillis(), std::memory_order_relaxed);
+    }
+
+    void markStoryMigrated(StoryId story_id)
+    { header->migratedStories[story_id % SHARED_EVENT_RING_MIGRATED_SLOTS].store(story_id, std::memory_order_relaxed); }
+
+    void closeConsumer()
+    { header->consumerClosed.store(1, std::memory_order_release); }
+
+    // the producer has closed the ring or has exited without closing it
+    bool isProducerGone() const
+    {
+        if(header->producerClosed.load(std::memory_order_acquire) != 0)
+        { return true; }
+        return (kill(header->producerPid, 0) != 0 && errno == ESRCH);
+    }
+
+private:
+    SharedEventRing(std::string const &shm_name, void*segment, size_t segment_size)
+        : shmName(shm_name)
+        , header(static_cast<SharedEventRingHeader*>(segment))
+        , records(static_cast<char*>(segment) + sizeof(SharedEventRingHeader))
+        , segmentSize(segment_size)
+        , peekedHead(0)
+        , peekedSize(0)
+        , corrupted(false)
+    {}
+
+    SharedEventRing(SharedEventRing const &) = delete;
+
+    SharedEventRing &operator=(SharedEventRing const &) = delete;
+
+    static uint64_t recordSize(size_t payload_size)
+    { return (sizeof(SharedEventRecordHeader) + payload_size + 7) & ~static_cast<uint64_t>(7); }
+
+    bool markCorrupted(uint64_t head, uint64_t tail)
+    {
+        LOG_ERROR("[SharedEventRing] Event ring {} is corrupted: head {} tail {} capacity {}", shmName, head, tail
+                  , header->capacity);
+        corrupted = true;
+        return false;
+    }
+
+    // CLOCK_MONOTONIC is shared by all the processes on the node
+    static uint64_t steadyClockMillis()
+    {
+        return std::chrono::duration_cast <std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string shmName;
+    SharedEventRingHeader*header;
+    char*records;
+    size_t segmentSize;
+    uint64_t peekedHead;    // consumer side only
+    uint64_t peekedSize;
+    bool corrupted;     // consumer side only
+};
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef STORY_ADMISSION_LIMITS_H
+#define STORY_ADMISSION_LIMITS_H
+
+#include <cstdint>
+#include <string>
+
+namespace chronolog
+{
+
+// StoryAdmissionLimits are the event rate limits every Keeper recording the story enforces,
+// taken from the attributes of the story's chronicle when the story recording starts;
+// the rates are events per second on one Keeper, 0 means no limit: the story rate is not divided
+// between the Keepers of the story's RecordingGroups, each of them admits up to the full story rate
+struct StoryAdmissionLimits
+{
+    uint64_t clientEventRate = 0;   // events of a single client
+    uint64_t storyEventRate = 0;    // events of all the clients together
+    uint64_t burstMillis = 0;       // the bursts over the rate can take this many milliseconds worth of events, 0 = 1000
+
+    bool isUnlimited() const
+    { return (clientEventRate == 0 && storyEventRate == 0); }
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(clientEventRate, storyEventRate, burstMillis);
+    }
+};
+
+inline std::string to_string(StoryAdmissionLimits const &limits)
+{
+    return std::string("{clientEventRate:") + std::to_string(limits.clientEventRate) + " storyEventRate:" +
+           std::to_string(limits.storyEventRate) + " burstMillis:" + std::to_string(limits.burstMillis) + "}";
+}
+
+}
+
+#endif
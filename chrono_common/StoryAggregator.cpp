@@ -0,0 +1,306 @@
+#include <cmath>
+#include <limits>
+#include <charconv>
+#include <algorithm>
+
+#include "client_errcode.h"
+#include "chrono_monitor.h"
+#include "StoryAggregator.h"
+#include "BinaryEncoding.h"
+
+namespace chl = chronolog;
+
+// upper bound on the number of time buckets a single query can produce
+#define MAX_AGGREGATION_BUCKETS 1000000
+
+////////////////////////
+
+chronolog::QuantileSketch::QuantileSketch(double relative_accuracy)
+    : gamma((1 + relative_accuracy) / (1 - relative_accuracy))
+    , logGamma(std::log(gamma))
+    , zeroCount(0)
+    , totalCount(0)
+{}
+
+int32_t chronolog::QuantileSketch::binIndex(double abs_value) const
+{
+    return static_cast<int32_t>(std::ceil(std::log(abs_value) / logGamma));
+}
+
+double chronolog::QuantileSketch::binValue(int32_t bin_index) const
+{
+    return 2 * std::pow(gamma, bin_index) / (gamma + 1);
+}
+
+void chronolog::QuantileSketch::add(double value)
+{
+    if(!std::isfinite(value))
+    { return; }
+
+    if(std::fabs(value) < std::numeric_limits <double>::min())
+    { zeroCount++; }
+    else if(value > 0)
+    { positiveBins[binIndex(value)]++; }
+    else
+    { negativeBins[binIndex(-value)]++; }
+
+    totalCount++;
+}
+
+void chronolog::QuantileSketch::merge(chl::QuantileSketch const &other)
+{
+    for(auto const &bin: other.positiveBins)
+    { positiveBins[bin.first] += bin.second; }
+    for(auto const &bin: other.negativeBins)
+    { negativeBins[bin.first] += bin.second; }
+    zeroCount += other.zeroCount;
+    totalCount += other.totalCount;
+}
+
+double chronolog::QuantileSketch::quantile(double q) const
+{
+    if(totalCount == 0)
+    { return 0; }
+
+    q = std::clamp(q, 0.0, 1.0);
+    uint64_t rank = static_cast<uint64_t>(q * (totalCount - 1));
+    uint64_t cumulative_count = 0;
+
+    // negative values in ascending order are the bins of decreasing magnitude
+    for(auto iter = negativeBins.rbegin(); iter != negativeBins.rend(); ++iter)
+    {
+        cumulative_count += (*iter).second;
+        if(cumulative_count > rank)
+        { return -binValue((*iter).first); }
+    }
+
+    cumulative_count += zeroCount;
+    if(cumulative_count > rank)
+    { return 0; }
+
+    for(auto const &bin: positiveBins)
+    {
+        cumulative_count += bin.second;
+        if(cumulative_count > rank)
+        { return binValue(bin.first); }
+    }
+
+    return binValue((*positiveBins.rbegin()).first);
+}
+
+void chronolog::QuantileSketch::encode(std::string &buffer) const
+{
+    appendValue(buffer, gamma);
+    appendValue(buffer, zeroCount);
+    appendValue(buffer, totalCount);
+    for(auto const *bins: {&positiveBins, &negativeBins})
+    {
+        appendValue(buffer, static_cast<uint32_t>(bins->size()));
+        for(auto const &bin: *bins)
+        {
+            appendValue(buffer, bin.first);
+            appendValue(buffer, bin.second);
+        }
+    }
+}
+
+bool chronolog::QuantileSketch::decode(std::string_view &buffer)
+{
+    positiveBins.clear();
+    negativeBins.clear();
+    if(!consumeValue(buffer, gamma) || !consumeValue(buffer, zeroCount) || !consumeValue(buffer, totalCount)
+       || !(gamma > 1))
+    { return false; }
+    logGamma = std::log(gamma);
+
+    for(auto *bins: {&positiveBins, &negativeBins})
+    {
+        uint32_t bin_count = 0;
+        if(!consumeValue(buffer, bin_count))
+        { return false; }
+        for(uint32_t i = 0; i < bin_count; ++i)
+        {
+            int32_t bin_index = 0;
+            uint64_t bin_count_value = 0;
+            if(!consumeValue(buffer, bin_index) || !consumeValue(buffer, bin_count_value))
+            { return false; }
+            (*bins)[bin_index] = bin_count_value;
+        }
+    }
+    return true;
+}
+
+////////////////////////
+
+chronolog::StoryAggregator::StoryAggregator(chl::AggregationQuery const &aggregation_query, chl::chrono_time start_time
+                                            , chl::chrono_time end_time)
+    : query(aggregation_query)
+    , startTime(start_time)
+    , endTime(end_time)
+    , aggregatedEventCount(0)
+    , hasArchiveHorizon(false)
+    , archiveHorizon(0, 0, 0)
+{}
+
+int chronolog::StoryAggregator::validateQuery(chl::AggregationQuery const &aggregation_query, chl::chrono_time start_time
+                                              , chl::chrono_time end_time)
+{
+    if(aggregation_query.bucketWidth == 0 || start_time >= end_time)
+    { return chl::CL_ERR_INVALID_ARG; }
+
+    if((end_time - start_time) / aggregation_query.bucketWidth >= MAX_AGGREGATION_BUCKETS)
+    { return chl::CL_ERR_INVALID_ARG; }
+
+    for(auto const &q: aggregation_query.quantiles)
+    {
+        if(!(q >= 0 && q <= 1))
+        { return chl::CL_ERR_INVALID_ARG; }
+    }
+
+    return chl::CL_SUCCESS;
+}
+
+bool chronolog::StoryAggregator::parseNumericRecord(std::string_view const &record, double &value)
+{
+    size_t first = record.find_first_not_of(" \t\r\n");
+    if(first == std::string_view::npos)
+    { return false; }
+    size_t last = record.find_last_not_of(" \t\r\n");
+
+    char const *record_start = record.data() + first;
+    char const *record_end = record.data() + last + 1;
+    if(*record_start == '+')
+    { record_start++; }
+
+    auto parse_result = std::from_chars(record_start, record_end, value);
+    return (parse_result.ec == std::errc() && parse_result.ptr == record_end);
+}
+
+chl::StoryAggregator::BucketState &chronolog::StoryAggregator::getBucketState(uint64_t bucket_index
+                                                                              , chl::ClientId client_id)
+{
+    return buckets[std::pair <uint64_t, chl::ClientId>(bucket_index, (query.groupByClient ? client_id : 0))];
+}
+
+void chronolog::StoryAggregator::addValue(chl::StoryAggregator::BucketState &bucket_state
+                                          , std::string_view const &record)
+{
+    double value = 0;
+    if(!parseNumericRecord(record, value))
+    { return; }
+
+    if(bucket_state.valueCount == 0)
+    {
+        bucket_state.min = value;
+        bucket_state.max = value;
+    }
+    else
+    {
+        bucket_state.min = std::min(bucket_state.min, value);
+        bucket_state.max = std::max(bucket_state.max, value);
+    }
+    bucket_state.sum += value;
+    bucket_state.valueCount++;
+    if(!query.quantiles.empty())
+    { bucket_state.sketch.add(value); }
+}
+
+void chronolog::StoryAggregator::aggregateRun(uint64_t bucket_index, size_t first, size_t last
+                                              , std::vector <chl::ClientId> const &client_ids
+                                              , std::vector <std::string_view> const &records)
+{
+    if(!query.groupByClient && !query.numericStats)
+    {
+        // the run length is all we need
+        getBucketState(bucket_index, 0).eventCount += (last - first);
+        return;
+    }
+
+    BucketState *bucket_state = &getBucketState(bucket_index, client_ids[first]);
+    for(size_t i = first; i < last; ++i)
+    {
+        if(query.groupByClient && i != first && client_ids[i] != client_ids[i - 1])
+        { bucket_state = &getBucketState(bucket_index, client_ids[i]); }
+
+        bucket_state->eventCount++;
+        if(query.numericStats)
+        { addValue(*bucket_state, records[i]); }
+    }
+}
+
+void chronolog::StoryAggregator::aggregateEvents(std::vector <chl::chrono_time> const &event_times
+                                                 , std::vector <chl::ClientId> const &client_ids
+                                                 , std::vector <std::string_view> const &records)
+{
+    if(event_times.empty() || event_times.size() != client_ids.size() || event_times.size() != records.size())
+    { return; }
+
+    if(!std::is_sorted(event_times.begin(), event_times.end()))
+    {
+        for(size_t i = 0; i < event_times.size(); ++i)
+        { aggregateEvent(event_times[i], client_ids[i], records[i]); }
+        return;
+    }
+
+    // skip the events outside of the query range and walk the time column bucket by bucket
+    size_t position = std::lower_bound(event_times.begin(), event_times.end(), startTime) - event_times.begin();
+    size_t range_end = std::lower_bound(event_times.begin() + position, event_times.end(), endTime) - event_times.begin();
+
+    while(position < range_end)
+    {
+        uint64_t bucket_index = (event_times[position] - startTime) / query.bucketWidth;
+        chl::chrono_time bucket_end = startTime + (bucket_index + 1) * query.bucketWidth;
+        size_t run_end = std::lower_bound(event_times.begin() + position, event_times.begin() + range_end
+                                          , bucket_end) - event_times.begin();
+
+        aggregateRun(bucket_index, position, run_end, client_ids, records);
+        aggregatedEventCount += (run_end - position);
+        position = run_end;
+    }
+}
+
+void chronolog::StoryAggregator::aggregateEvent(chl::chrono_time event_time, chl::ClientId client_id
+                                                , std::string_view const &record)
+{
+    if(event_time < startTime || event_time >= endTime)
+    { return; }
+
+    BucketState &bucket_state = getBucketState((event_time - startTime) / query.bucketWidth, client_id);
+    bucket_state.eventCount++;
+    if(query.numericStats)
+    { addValue(bucket_state, record); }
+    aggregatedEventCount++;
+}
+
+void chronolog::StoryAggregator::advanceArchiveHorizon(chl::EventSequence const &event_sequence)
+{
+    if(!hasArchiveHorizon || archiveHorizon < event_sequence)
+    {
+        archiveHorizon = event_sequence;
+        hasArchiveHorizon = true;
+    }
+}
+
+std::vector <chl::AggregationBucket> &
+chronolog::StoryAggregator::getResults(std::vector <chl::AggregationBucket> &results) const
+{
+    results.clear();
+    results.reserve(buckets.size());
+    for(auto const &bucket: buckets)
+    {
+        chl::AggregationBucket result;
+        result.bucketStart = startTime + bucket.first.first * query.bucketWidth;
+        result.clientId = bucket.first.second;
+        result.eventCount = bucket.second.eventCount;
+        result.valueCount = bucket.second.valueCount;
+        result.sum = bucket.second.sum;
+        result.min = bucket.second.min;
+        result.max = bucket.second.max;
+        for(auto const &q: query.quantiles)
+        { result.quantileValues.push_back(bucket.second.sketch.quantile(q)); }
+        results.push_back(result);
+    }
+
+    LOG_DEBUG("[StoryAggregator] {} events aggregated into {} buckets", aggregatedEventCount, results.size());
+    return results;
+}
@@ -0,0 +1,119 @@
+#ifndef STORY_AGGREGATOR_H
+#define STORY_AGGREGATOR_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::AggregationQuery and chronolog::AggregationBucket definitions
+#include "StoryChunk.h"
+
+namespace chronolog
+{
+
+// QuantileSketch is a mergeable approximate quantile summary with bounded relative error:
+// values are counted in logarithmically sized bins so that any value returned for a quantile
+// is within relativeAccuracy of the exact one, while the sketch size only grows with
+// the logarithm of the value range, not with the number of values.
+
+class QuantileSketch
+{
+public:
+    explicit QuantileSketch(double relative_accuracy = 0.01);
+
+    void add(double value);
+
+    void merge(QuantileSketch const &other);
+
+    uint64_t count() const
+    { return totalCount; }
+
+    double quantile(double q) const;
+
+    // compact binary form used to persist the sketch, decode consumes the sketch bytes from the buffer
+    void encode(std::string &buffer) const;
+
+    bool decode(std::string_view &buffer);
+
+private:
+    int32_t binIndex(double abs_value) const;
+
+    double binValue(int32_t bin_index) const;
+
+    double gamma;
+    double logGamma;
+    uint64_t zeroCount;
+    uint64_t totalCount;
+    std::map <int32_t, uint64_t> positiveBins;
+    std::map <int32_t, uint64_t> negativeBins;
+};
+
+// StoryAggregator accumulates the time-bucketed statistics of the AggregationQuery
+// over the events of one story in the [startTime, endTime[ range.
+// Events are passed in columns, the time column is expected to be sorted
+// as it is in the archived StoryChunks, so that the bucket boundaries are found by binary search
+// and the count only aggregation does no per event work at all.
+// StoryAggregator is not thread safe, one instance is to be used per aggregation query.
+
+class StoryAggregator
+{
+public:
+    StoryAggregator(AggregationQuery const &aggregation_query, chrono_time start_time, chrono_time end_time);
+
+    ~StoryAggregator() = default;
+
+    // returns CL_SUCCESS or CL_ERR_INVALID_ARG for malformed query
+    static int validateQuery(AggregationQuery const &aggregation_query, chrono_time start_time, chrono_time end_time);
+
+    static bool parseNumericRecord(std::string_view const &record, double &value);
+
+    void aggregateEvents(std::vector <chrono_time> const &event_times, std::vector <ClientId> const &client_ids
+                         , std::vector <std::string_view> const &records);
+
+    void aggregateEvent(chrono_time event_time, ClientId client_id, std::string_view const &record);
+
+    // events up to the horizon have been aggregated from the archive,
+    // the in-memory copies of these events must not be counted again
+    void advanceArchiveHorizon(EventSequence const &event_sequence);
+
+    bool isArchived(EventSequence const &event_sequence) const
+    { return (hasArchiveHorizon && !(archiveHorizon < event_sequence)); }
+
+    uint64_t getEventCount() const
+    { return aggregatedEventCount; }
+
+    std::vector <AggregationBucket> &getResults(std::vector <AggregationBucket> &results) const;
+
+private:
+    struct BucketState
+    {
+        uint64_t eventCount = 0;
+        uint64_t valueCount = 0;
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        QuantileSketch sketch;
+    };
+
+    BucketState &getBucketState(uint64_t bucket_index, ClientId client_id);
+
+    void addValue(BucketState &bucket_state, std::string_view const &record);
+
+    void aggregateRun(uint64_t bucket_index, size_t first, size_t last, std::vector <ClientId> const &client_ids
+                      , std::vector <std::string_view> const &records);
+
+    AggregationQuery query;
+    chrono_time startTime;
+    chrono_time endTime;
+    uint64_t aggregatedEventCount;
+    bool hasArchiveHorizon;
+    EventSequence archiveHorizon;
+    // buckets keyed by {bucket index, clientId}, clientId is 0 unless the query is grouped by client
+    std::map <std::pair <uint64_t, ClientId>, BucketState> buckets;
+};
+
+}
+
+#endif
@@ -13,7 +13,7 @@ chl::StoryChunk::StoryChunk(chl::ChronicleName const &chronicle_name, chl::Story
                             , uint64_t end_time, uint32_t chunk_size)
                             : chronicleName(chronicle_name), storyName(story_name)
                             , storyId(story_id)
-                            , startTime(start_time), endTime(end_time), revisionTime(end_time)
+                            , startTime(start_time), endTime(end_time), revisionTime(end_time), shardIndex(0)
 {
     if(endTime <= startTime)
     { 
@@ -36,7 +36,9 @@ int chl::StoryChunk::insertEvent(chl::LogEvent const &event)
     {
         if((event.time() >= startTime) && (event.time() < endTime))
         {
-            logEvents.insert(std::pair <chl::EventSequence, chl::LogEvent>({event.time(), event.clientId, event.index()}, event));
+            bool inserted = logEvents.insert(std::pair <chl::EventSequence, chl::LogEvent>({event.time(), event.clientId, event.index()}, event)).second;
+            if(inserted && chl::EventTracer::isSampled(event))
+            { tracedEvents.push_back(chl::TracedEvent{event.storyId, event.eventTime, event.clientId, event.eventIndex}); }
             return 1;
         }
         else
@@ -188,7 +190,9 @@ std::map<chl::EventSequence, chl::LogEvent>::iterator
 chl::StoryChunk::eraseEvents(std::map<chl::EventSequence, chl::LogEvent>::const_iterator & range_start,
                              std::map<chl::EventSequence, chl::LogEvent>::const_iterator & range_end)
 {
-    return logEvents.erase(range_start, range_end);
+    std::map<chl::EventSequence, chl::LogEvent>::iterator next_pos = logEvents.erase(range_start, range_end);
+    pruneTracedEvents();
+    return next_pos;
 }
 
 //
@@ -208,7 +212,23 @@ std::map<chl::EventSequence, chl::LogEvent>::iterator chl::StoryChunk::eraseEven
             (end_time > endTime ? logEvents.upper_bound(chl::EventSequence{endTime,0,0}) 
                                 : logEvents.upper_bound(chl::EventSequence{end_time,0,0}));
     
-    return logEvents.erase(range_start, range_end);
+    std::map<chl::EventSequence, chl::LogEvent>::iterator next_pos = logEvents.erase(range_start, range_end);
+    pruneTracedEvents();
+    return next_pos;
+}
+
+//
+// drop the traced events that are no longer in the chunk
+
+void chl::StoryChunk::pruneTracedEvents()
+{
+    for(auto iter = tracedEvents.begin(); iter != tracedEvents.end();)
+    {
+        if(logEvents.find(chl::EventSequence{(*iter).eventTime, (*iter).clientId, (*iter).eventIndex}) == logEvents.end())
+        { iter = tracedEvents.erase(iter); }
+        else
+        { ++iter; }
+    }
 }
 
 ///////////////////
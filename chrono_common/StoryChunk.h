@@ -7,9 +7,11 @@
 #include <thallium/serialization/stl/string.hpp>
 #include <thallium/serialization/stl/map.hpp>
 #include <thallium/serialization/stl/tuple.hpp>
+#include <thallium/serialization/stl/vector.hpp>
 
 #include "chrono_monitor.h"
 #include "chronolog_types.h"  //for chronolog::LogEvent definiiton
+#include "EventTracer.h"
 #include "chronolog_client.h" //for chronolog::Event definition 
 namespace chronolog
 {
@@ -47,6 +49,14 @@ public:
     uint64_t getEndTime() const
     { return endTime; }
 
+    // index of the story shard the chunk was recorded by, 0 for the unsharded stories;
+    // the shard index is local to the recording process and is not serialized
+    uint32_t getShardIndex() const
+    { return shardIndex; }
+
+    void setShardIndex(uint32_t shard_index)
+    { shardIndex = shard_index; }
+
     int getEventCount() const
     { return logEvents.size(); }
 
@@ -70,6 +80,10 @@ public:
 
     int insertEvent(LogEvent const &);
 
+    // the events of the chunk sampled for tracing, see EventTracer
+    std::vector <TracedEvent> const &getTracedEvents() const
+    { return tracedEvents; }
+
     uint32_t mergeEvents(std::map <EventSequence, LogEvent> &events
                          , std::map <EventSequence, LogEvent>::const_iterator &merge_start);
 
@@ -100,6 +114,7 @@ public:
         serT&endTime;
         serT&revisionTime;
         serT&logEvents;
+        serT&tracedEvents;
     }
 
 inline std::string to_string() const
@@ -118,13 +133,17 @@ inline std::string to_string() const
     std::vector<Event> & extractEventSeries( std::vector<Event> & event_series);
 
 private:
+    void pruneTracedEvents();
+
     ChronicleName chronicleName;
     StoryName storyName;
     StoryId storyId;
     uint64_t startTime;
     uint64_t endTime;
     uint64_t revisionTime;
+    uint32_t shardIndex;
     std::map <EventSequence, LogEvent> logEvents;
+    std::vector <TracedEvent> tracedEvents;
 };
 
 }
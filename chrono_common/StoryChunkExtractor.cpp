@@ -10,7 +10,8 @@ namespace tl = thallium;
 
 //////////////////////////////
 
-void chronolog::StoryChunkExtractorBase::startExtractionThreads(int stream_count)
+void chronolog::StoryChunkExtractorBase::startExtractionThreads(int stream_count, XstreamPlacement*xstream_placement
+                                                               , XstreamRole xstream_role)
 {
     std::lock_guard lock(extractorMutex);
 
@@ -24,7 +25,8 @@ void chronolog::StoryChunkExtractorBase::startExtractionThreads(int stream_count
 
     for(int i = 0; i < stream_count; ++i)
     {
-        tl::managed <tl::xstream> es = tl::xstream::create();
+        tl::managed <tl::xstream> es = (xstream_placement != nullptr ? xstream_placement->createXstream(xstream_role)
+                                                                     : tl::xstream::create());
         extractionStreams.push_back(std::move(es));
     }
 
@@ -12,6 +12,7 @@
 #include "StoryChunkExtractionQueue.h"
 #include "chronolog_errcode.h"
 #include "chrono_monitor.h"
+#include "XstreamPlacement.h"
 
 
 namespace tl = thallium;
@@ -49,7 +50,8 @@ public:
 
     virtual int processStoryChunk(StoryChunk*)  =0;
 
-    void startExtractionThreads(int);
+    // the extraction xstreams are pinned to the cores of the role in the placement if it is given
+    void startExtractionThreads(int, XstreamPlacement* = nullptr, XstreamRole = XSTREAM_EXTRACTION);
 
     void shutdownExtractionThreads();
 
@@ -0,0 +1,275 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "chrono_monitor.h"
+#include "StoryChunkSummary.h"
+#include "BinaryEncoding.h"
+
+namespace chl = chronolog;
+
+// exact per client event counts are kept for at most this many clients per summary
+#define MAX_SUMMARY_CLIENTS 1024
+
+#define STORY_CHUNK_SUMMARY_MAGIC 0x53434853 // "SHCS"
+// version 2 adds the clientId and eventIndex of the last event
+#define STORY_CHUNK_SUMMARY_VERSION 2
+
+namespace
+{
+
+// splitmix64 finalizer, spreads the sequential client ids over the whole hash space
+uint64_t mixHash(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+}
+
+////////////////////////
+
+chronolog::HyperLogLogSketch::HyperLogLogSketch(uint8_t register_precision)
+    : precision(std::clamp <uint8_t>(register_precision, 4, 16))
+    , registers(size_t(1) << precision, 0)
+{}
+
+void chronolog::HyperLogLogSketch::add(uint64_t value)
+{
+    uint64_t hash = mixHash(value);
+    size_t register_index = hash >> (64 - precision);
+    uint64_t remaining_bits = hash << precision;
+    uint8_t rank = (remaining_bits == 0 ? 64 - precision + 1 : __builtin_clzll(remaining_bits) + 1);
+    registers[register_index] = std::max(registers[register_index], rank);
+}
+
+void chronolog::HyperLogLogSketch::merge(chl::HyperLogLogSketch const &other)
+{
+    if(other.precision != precision)
+    {
+        LOG_WARNING("[HyperLogLogSketch] Can't merge sketches of different precision {} and {}", precision
+                    , other.precision);
+        return;
+    }
+    for(size_t i = 0; i < registers.size(); ++i)
+    { registers[i] = std::max(registers[i], other.registers[i]); }
+}
+
+double chronolog::HyperLogLogSketch::estimate() const
+{
+    double register_count = registers.size();
+    double harmonic_sum = 0;
+    size_t zero_registers = 0;
+    for(auto const &rank: registers)
+    {
+        harmonic_sum += std::ldexp(1.0, -rank);
+        if(rank == 0)
+        { zero_registers++; }
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / register_count);
+    double raw_estimate = alpha * register_count * register_count / harmonic_sum;
+
+    // linear counting is more accurate for the small cardinalities
+    if(raw_estimate <= 2.5 * register_count && zero_registers != 0)
+    { return register_count * std::log(register_count / zero_registers); }
+
+    return raw_estimate;
+}
+
+void chronolog::HyperLogLogSketch::encode(std::string &buffer) const
+{
+    appendValue(buffer, precision);
+    buffer.append(reinterpret_cast<char const *>(registers.data()), registers.size());
+}
+
+bool chronolog::HyperLogLogSketch::decode(std::string_view &buffer)
+{
+    uint8_t encoded_precision = 0;
+    if(!consumeValue(buffer, encoded_precision) || encoded_precision < 4 || encoded_precision > 16)
+    { return false; }
+
+    size_t register_count = size_t(1) << encoded_precision;
+    if(buffer.size() < register_count)
+    { return false; }
+
+    precision = encoded_precision;
+    registers.assign(buffer.begin(), buffer.begin() + register_count);
+    buffer.remove_prefix(register_count);
+    return true;
+}
+
+////////////////////////
+
+chronolog::StoryChunkSummary::StoryChunkSummary()
+    : eventCount(0)
+    , firstEventTime(0)
+    , lastEventTime(0)
+    , lastEventClientId(0)
+    , lastEventIndex(0)
+    , recordBytes(0)
+    , minRecordSize(0)
+    , maxRecordSize(0)
+{}
+
+void chronolog::StoryChunkSummary::addEvent(chl::chrono_time event_time, chl::ClientId client_id
+                                           , chl::chrono_index event_index, uint64_t record_size)
+{
+    if(eventCount == 0 || getLastEventSequence() < chl::EventSequence(event_time, client_id, event_index))
+    {
+        lastEventTime = event_time;
+        lastEventClientId = client_id;
+        lastEventIndex = event_index;
+    }
+
+    if(eventCount == 0)
+    {
+        firstEventTime = event_time;
+        minRecordSize = maxRecordSize = record_size;
+    }
+    else
+    {
+        firstEventTime = std::min(firstEventTime, event_time);
+        minRecordSize = std::min(minRecordSize, record_size);
+        maxRecordSize = std::max(maxRecordSize, record_size);
+    }
+
+    eventCount++;
+    recordBytes += record_size;
+
+    auto client_iter = clientEventCounts.find(client_id);
+    if(client_iter != clientEventCounts.end())
+    { (*client_iter).second++; }
+    else if(clientEventCounts.size() < MAX_SUMMARY_CLIENTS)
+    { clientEventCounts.emplace(client_id, 1); }
+
+    distinctClients.add(client_id);
+    recordSizeSketch.add(static_cast<double>(record_size));
+}
+
+void chronolog::StoryChunkSummary::merge(chl::StoryChunkSummary const &other)
+{
+    if(other.empty())
+    { return; }
+
+    if(empty() || getLastEventSequence() < other.getLastEventSequence())
+    {
+        lastEventTime = other.lastEventTime;
+        lastEventClientId = other.lastEventClientId;
+        lastEventIndex = other.lastEventIndex;
+    }
+
+    if(empty())
+    {
+        firstEventTime = other.firstEventTime;
+        minRecordSize = other.minRecordSize;
+        maxRecordSize = other.maxRecordSize;
+    }
+    else
+    {
+        firstEventTime = std::min(firstEventTime, other.firstEventTime);
+        minRecordSize = std::min(minRecordSize, other.minRecordSize);
+        maxRecordSize = std::max(maxRecordSize, other.maxRecordSize);
+    }
+
+    eventCount += other.eventCount;
+    recordBytes += other.recordBytes;
+
+    for(auto const &client_count: other.clientEventCounts)
+    {
+        auto client_iter = clientEventCounts.find(client_count.first);
+        if(client_iter != clientEventCounts.end())
+        { (*client_iter).second += client_count.second; }
+        else if(clientEventCounts.size() < MAX_SUMMARY_CLIENTS)
+        { clientEventCounts.insert(client_count); }
+    }
+
+    distinctClients.merge(other.distinctClients);
+    recordSizeSketch.merge(other.recordSizeSketch);
+}
+
+chl::StoryStatistics &chronolog::StoryChunkSummary::getStatistics(chl::StoryStatistics &statistics) const
+{
+    statistics.eventCount = eventCount;
+    statistics.firstEventTime = firstEventTime;
+    statistics.lastEventTime = lastEventTime;
+    statistics.recordBytes = recordBytes;
+    statistics.minRecordSize = minRecordSize;
+    statistics.maxRecordSize = maxRecordSize;
+    statistics.distinctClients = (empty() ? 0 : static_cast<uint64_t>(std::llround(distinctClients.estimate())));
+    // the exact count is known as long as no client has been left out of the per client counts
+    if(clientEventCounts.size() < MAX_SUMMARY_CLIENTS)
+    { statistics.distinctClients = clientEventCounts.size(); }
+    statistics.clientEventCounts = clientEventCounts;
+    statistics.recordSizeQuantiles.clear();
+    for(double q: {0.5, 0.9, 0.99})
+    { statistics.recordSizeQuantiles.push_back(recordSizeSketch.quantile(q)); }
+    return statistics;
+}
+
+std::string chronolog::StoryChunkSummary::encode() const
+{
+    std::string buffer;
+    appendValue(buffer, static_cast<uint32_t>(STORY_CHUNK_SUMMARY_MAGIC));
+    appendValue(buffer, static_cast<uint32_t>(STORY_CHUNK_SUMMARY_VERSION));
+    appendValue(buffer, eventCount);
+    appendValue(buffer, firstEventTime);
+    appendValue(buffer, lastEventTime);
+    appendValue(buffer, recordBytes);
+    appendValue(buffer, minRecordSize);
+    appendValue(buffer, maxRecordSize);
+    appendValue(buffer, static_cast<uint32_t>(clientEventCounts.size()));
+    for(auto const &client_count: clientEventCounts)
+    {
+        appendValue(buffer, client_count.first);
+        appendValue(buffer, client_count.second);
+    }
+    distinctClients.encode(buffer);
+    recordSizeSketch.encode(buffer);
+    appendValue(buffer, lastEventClientId);
+    appendValue(buffer, lastEventIndex);
+    return buffer;
+}
+
+bool chronolog::StoryChunkSummary::decode(std::string_view buffer)
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if(!consumeValue(buffer, magic) || magic != STORY_CHUNK_SUMMARY_MAGIC || !consumeValue(buffer, version)
+       || version < 1 || version > STORY_CHUNK_SUMMARY_VERSION)
+    {
+        LOG_WARNING("[StoryChunkSummary] Unknown summary format magic {} version {}", magic, version);
+        return false;
+    }
+
+    uint32_t client_count = 0;
+    if(!consumeValue(buffer, eventCount) || !consumeValue(buffer, firstEventTime) || !consumeValue(buffer, lastEventTime)
+       || !consumeValue(buffer, recordBytes) || !consumeValue(buffer, minRecordSize)
+       || !consumeValue(buffer, maxRecordSize) || !consumeValue(buffer, client_count))
+    { return false; }
+
+    clientEventCounts.clear();
+    for(uint32_t i = 0; i < client_count; ++i)
+    {
+        chl::ClientId client_id = 0;
+        uint64_t client_event_count = 0;
+        if(!consumeValue(buffer, client_id) || !consumeValue(buffer, client_event_count))
+        { return false; }
+        clientEventCounts[client_id] = client_event_count;
+    }
+
+    if(!distinctClients.decode(buffer) || !recordSizeSketch.decode(buffer))
+    { return false; }
+
+    if(version == 1)
+    {
+        // the version 1 summaries only know the last event time,
+        // all the events of that time are taken to be covered by the summary
+        lastEventClientId = std::numeric_limits <chl::ClientId>::max();
+        lastEventIndex = std::numeric_limits <chl::chrono_index>::max();
+        return true;
+    }
+    return (consumeValue(buffer, lastEventClientId) && consumeValue(buffer, lastEventIndex));
+}
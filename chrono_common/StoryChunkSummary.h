@@ -0,0 +1,101 @@
+#ifndef STORY_CHUNK_SUMMARY_H
+#define STORY_CHUNK_SUMMARY_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::StoryStatistics definition
+#include "StoryAggregator.h"  //for chronolog::QuantileSketch definition
+
+namespace chronolog
+{
+
+// HyperLogLogSketch estimates the number of distinct values in fixed 2^precision bytes,
+// sketches of different chunks are merged by taking the register-wise maximum.
+
+class HyperLogLogSketch
+{
+public:
+    explicit HyperLogLogSketch(uint8_t precision = 10);
+
+    void add(uint64_t value);
+
+    void merge(HyperLogLogSketch const &other);
+
+    double estimate() const;
+
+    void encode(std::string &buffer) const;
+
+    bool decode(std::string_view &buffer);
+
+private:
+    uint8_t precision;
+    std::vector <uint8_t> registers;
+};
+
+// StoryChunkSummary is the small summary of the StoryChunk events that is archived alongside the events,
+// so that the range statistics can be answered by merging the summaries of the chunks in the range
+// without reading the events themselves.
+
+class StoryChunkSummary
+{
+public:
+    StoryChunkSummary();
+
+    ~StoryChunkSummary() = default;
+
+    bool empty() const
+    { return (eventCount == 0); }
+
+    uint64_t getEventCount() const
+    { return eventCount; }
+
+    chrono_time getFirstEventTime() const
+    { return firstEventTime; }
+
+    chrono_time getLastEventTime() const
+    { return lastEventTime; }
+
+    // the greatest {eventTime, clientId, eventIndex} of the summarized events
+    EventSequence getLastEventSequence() const
+    { return EventSequence(lastEventTime, lastEventClientId, lastEventIndex); }
+
+    uint64_t getRecordBytes() const
+    { return recordBytes; }
+
+    std::map <ClientId, uint64_t> const &getClientEventCounts() const
+    { return clientEventCounts; }
+
+    void addEvent(chrono_time event_time, ClientId client_id, chrono_index event_index, uint64_t record_size);
+
+    void merge(StoryChunkSummary const &other);
+
+    StoryStatistics &getStatistics(StoryStatistics &statistics) const;
+
+    // versioned binary form persisted in the archive
+    std::string encode() const;
+
+    bool decode(std::string_view buffer);
+
+private:
+    uint64_t eventCount;
+    chrono_time firstEventTime;
+    chrono_time lastEventTime;
+    ClientId lastEventClientId;
+    chrono_index lastEventIndex;
+    uint64_t recordBytes;
+    uint64_t minRecordSize;
+    uint64_t maxRecordSize;
+    // exact per client counts are kept for up to MAX_SUMMARY_CLIENTS clients,
+    // the distinct clients count is always available from the HyperLogLog sketch
+    std::map <ClientId, uint64_t> clientEventCounts;
+    HyperLogLogSketch distinctClients;
+    QuantileSketch recordSizeSketch;
+};
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include <filesystem>
 #include <regex>
 #include "StoryChunkWriter.h"
+#include "StoryChunkSummary.h"
+#include "RecordTemplateDictionary.h"
 
 namespace fs = std::filesystem;
 
@@ -31,6 +33,11 @@ hsize_t StoryChunkWriter::writeStoryChunk(StoryChunkHVL &story_chunk)
             return ret;
         }
 
+        if(!writeSummary(file, data))
+        {
+            LOG_WARNING("[StoryChunkWriter] StoryChunk summary is not written, statistics queries will read the events.");
+        }
+
         file->flush(H5F_SCOPE_GLOBAL);
         hsize_t file_size = file->getFileSize();
 
@@ -125,6 +132,13 @@ hsize_t StoryChunkWriter::writeStoryChunk(StoryChunk &story_chunk)
     }
     std::string file_name = story_chunk.getChronicleName() + "." + story_chunk.getStoryName() + "." +
                             std::to_string(story_chunk.getStartTime() / 1000000000) + ".vlen.h5";
+    if(story_chunk.getShardIndex() > 0)
+    {
+        // partial chunks of a sharded story are archived side by side with the shard index in the file name
+        file_name = story_chunk.getChronicleName() + "." + story_chunk.getStoryName() + "." +
+                    std::to_string(story_chunk.getStartTime() / 1000000000) + ".shard" +
+                    std::to_string(story_chunk.getShardIndex()) + ".vlen.h5";
+    }
 //    file_name = fs::path(rootDirectory) / fs::path(file_name);
     hsize_t ret = 0;
     std::unique_ptr<H5::H5File> file;
@@ -144,6 +158,11 @@ hsize_t StoryChunkWriter::writeStoryChunk(StoryChunk &story_chunk)
             return ret;
         }
 
+        if(!writeSummary(file, data))
+        {
+            LOG_WARNING("[StoryChunkWriter] StoryChunk summary is not written, statistics queries will read the events.");
+        }
+
         file->flush(H5F_SCOPE_GLOBAL);
         hsize_t file_size = file->getFileSize();
 
@@ -181,8 +200,28 @@ hsize_t StoryChunkWriter::writeEvents(std::unique_ptr<H5::H5File> &file, std::ve
         auto *dataset = new H5::DataSet(
                 file->createDataSet("/" + groupName + "/" + dsetName + ".vlen_bytes", data_type, *dataspace));
 
+        // the summary is computed from the events as they were logged, only the archived copy is encoded
+        std::vector <LogEventHVL> encoded_data;
+        std::string encoded_dictionary;
+        if(recordTemplateEncoding)
+        {
+            encoded_data = data;
+            encoded_dictionary = encodeRecordTemplates(encoded_data);
+        }
+
         LOG_DEBUG("[StoryChunkWriter] Writing data to dataset...");
-        dataset->write(&data.front(), data_type);
+        dataset->write(encoded_dictionary.empty() ? &data.front() : &encoded_data.front(), data_type);
+
+        if(!encoded_dictionary.empty())
+        {
+            // the reader decodes the records of the events dataset only if the dictionary dataset is present
+            hsize_t dictionary_size = encoded_dictionary.size();
+            H5::DataSpace dictionary_space(numDims, &dictionary_size);
+            LOG_DEBUG("[StoryChunkWriter] Creating record template dictionary dataset: {}.templates", dsetName);
+            H5::DataSet dictionary_dataset = file->createDataSet("/" + groupName + "/" + dsetName + ".templates"
+                                                                 , H5::PredType::NATIVE_UINT8, dictionary_space);
+            dictionary_dataset.write(encoded_dictionary.data(), H5::PredType::NATIVE_UINT8);
+        }
 
         delete dataset;
         delete dataspace;
@@ -213,4 +252,86 @@ hsize_t StoryChunkWriter::writeEvents(std::unique_ptr<H5::H5File> &file, std::ve
     return ret;
 }
 
-}
\ No newline at end of file
+std::string StoryChunkWriter::encodeRecordTemplates(std::vector <LogEventHVL> &data)
+{
+    std::vector <std::string_view> records;
+    records.reserve(data.size());
+    uint64_t record_bytes = 0;
+    for(auto const &event: data)
+    {
+        records.emplace_back(static_cast<char const*>(event.logRecord.p), event.logRecord.len);
+        record_bytes += event.logRecord.len;
+    }
+
+    std::vector <std::string> encoded_records;
+    std::string encoded_dictionary;
+    if(!RecordTemplateDictionary::encodeRecords(records, encoded_records, encoded_dictionary))
+    {
+        LOG_DEBUG("[StoryChunkWriter] Record templates don't pay off for {} events, the records are kept verbatim"
+                  , data.size());
+        return std::string();
+    }
+
+    uint64_t encoded_bytes = encoded_dictionary.size();
+    for(size_t i = 0; i < data.size(); ++i)
+    {
+        hvl_t encoded_record;
+        encoded_record.len = encoded_records[i].size();
+        encoded_record.p = (void*)encoded_records[i].data();
+        data[i] = LogEventHVL(data[i].storyId, data[i].eventTime, data[i].clientId, data[i].eventIndex
+                              , encoded_record);
+        encoded_bytes += encoded_record.len;
+    }
+    LOG_DEBUG("[StoryChunkWriter] Record templates encoded {} record bytes of {} events into {} bytes", record_bytes
+              , data.size(), encoded_bytes);
+    return encoded_dictionary;
+}
+
+bool StoryChunkWriter::writeSummary(std::unique_ptr<H5::H5File> &file, std::vector <LogEventHVL> const &data)
+{
+    if(data.empty())
+    {
+        return false;
+    }
+
+    StoryChunkSummary summary;
+    for(auto const &event: data)
+    {
+        summary.addEvent(event.eventTime, event.clientId, event.eventIndex, event.logRecord.len);
+    }
+    std::string encoded_summary = summary.encode();
+
+    try
+    {
+        hsize_t dim_size = encoded_summary.size();
+        H5::DataSpace dataspace(numDims, &dim_size);
+
+        LOG_DEBUG("[StoryChunkWriter] Creating summary dataset: {}.summary", dsetName);
+        H5::DataSet dataset = file->createDataSet("/" + groupName + "/" + dsetName + ".summary"
+                                                  , H5::PredType::NATIVE_UINT8, dataspace);
+        dataset.write(encoded_summary.data(), H5::PredType::NATIVE_UINT8);
+
+        // the most used fields are also kept as attributes readable with the standard HDF5 tools
+        H5::DataSpace attr_space(H5S_SCALAR);
+        uint64_t event_count = summary.getEventCount();
+        uint64_t first_event_time = summary.getFirstEventTime();
+        uint64_t last_event_time = summary.getLastEventTime();
+        uint64_t record_bytes = summary.getRecordBytes();
+        for(auto const &attr: {std::make_pair("eventCount", &event_count)
+                               , std::make_pair("firstEventTime", &first_event_time)
+                               , std::make_pair("lastEventTime", &last_event_time)
+                               , std::make_pair("recordBytes", &record_bytes)})
+        {
+            H5::Attribute attribute = dataset.createAttribute(attr.first, H5::PredType::NATIVE_UINT64, attr_space);
+            attribute.write(H5::PredType::NATIVE_UINT64, attr.second);
+        }
+        return true;
+    }
+    catch(H5::Exception &error)
+    {
+        LOG_ERROR("[StoryChunkWriter] Failed to write StoryChunk summary: {}", error.getCDetailMsg());
+    }
+    return false;
+}
+
+}
@@ -14,8 +14,12 @@ namespace chronolog
 class StoryChunkWriter
 {
 public:
-    StoryChunkWriter(std::string const &root_dir, std::string const &group_name, std::string const &dset_name)
+    // with encode_record_templates the log records are archived template-encoded when that makes them smaller,
+    // see RecordTemplateDictionary
+    StoryChunkWriter(std::string const &root_dir, std::string const &group_name, std::string const &dset_name
+                     , bool encode_record_templates = false)
             : rootDirectory(root_dir), groupName(group_name), dsetName(dset_name), numDims(1)
+            , recordTemplateEncoding(encode_record_templates)
     {};
 
     ~StoryChunkWriter()
@@ -29,6 +33,14 @@ public:
 
     hsize_t writeEvents(std::unique_ptr<H5::H5File> &file, std::vector <LogEventHVL> &data);
 
+    // replaces the log records of the events with their template encoding and returns the encoded dictionary,
+    // returns the empty string and leaves the events as they are if the encoding doesn't pay off
+    static std::string encodeRecordTemplates(std::vector <LogEventHVL> &data);
+
+    // writes the StoryChunkSummary of the events into the summary dataset next to the events dataset,
+    // the summary is used by the chrono_player to answer the range statistics without reading the events
+    bool writeSummary(std::unique_ptr<H5::H5File> &file, std::vector <LogEventHVL> const &data);
+
     static H5::CompType createEventCompoundType()
     {
         H5::CompType data_type(sizeof(LogEventHVL));
@@ -40,7 +52,8 @@ public:
         return data_type;
     }
 
-    // base_file_name should be in the format of chronicleName.storyName.startTime.vlen.h5, not including the path
+    // base_file_name should be in the format of chronicleName.storyName.startTime.vlen.h5
+    // or chronicleName.storyName.startTime.shardN.vlen.h5, not including the path
     static std::string getStoryChunkFileName(std::string const &root_dir, std::string const &base_file_name);
 
 private:
@@ -48,6 +61,7 @@ private:
     std::string groupName;
     std::string dsetName;
     int numDims;
+    bool recordTemplateEncoding;
 };
 } // chronolog
 
@@ -20,10 +20,10 @@ namespace chl = chronolog;
 chronolog::StoryPipeline::StoryPipeline(StoryChunkExtractionQueue &extractionQueue, chronolog::ChronicleName const &chronicle_name
                                         , chronolog::StoryName const &story_name, chronolog::StoryId const &story_id
                                         , uint64_t story_start_time, uint32_t chunk_granularity
-                                        , uint32_t acceptance_window)
+                                        , uint32_t acceptance_window, uint32_t shard_index)
         : theExtractionQueue(extractionQueue)
         , storyId(story_id), chronicleName(chronicle_name), storyName(story_name)
-        , chunkGranularity(chunk_granularity), acceptanceWindow(acceptance_window)
+        , chunkGranularity(chunk_granularity), acceptanceWindow(acceptance_window), shardIndex(shard_index)
         , activeIngestionHandle(nullptr)
 {
     activeIngestionHandle = new chl::StoryChunkIngestionHandle(ingestionMutex, &chunkQueue1, &chunkQueue2);
@@ -40,6 +40,7 @@ chronolog::StoryPipeline::StoryPipeline(StoryChunkExtractionQueue &extractionQue
     for(int i=0; i<3; ++i)
     {
         StoryChunk * new_chunk = new chronolog::StoryChunk(chronicleName, storyName, storyId, (story_start_time + chunkGranularity*i), (story_start_time + chunkGranularity*(i+1)));
+        new_chunk->setShardIndex(shardIndex);
         storyTimelineMap.insert( std::pair <uint64_t, chronolog::StoryChunk*>(new_chunk->getStartTime(), new_chunk));
     }
 
@@ -114,6 +115,7 @@ void chronolog::StoryPipeline::finalize()
             }
             else
             {
+                chl::EventTracer::getInstance().recordStage(extractedChunk->getTracedEvents(), "extraction_queued");
                 theExtractionQueue.stashStoryChunk(extractedChunk);
             }
         }
@@ -135,6 +137,7 @@ std::map <uint64_t, chronolog::StoryChunk*>::iterator chronolog::StoryPipeline::
     LOG_TRACE("[StoryPipeline] Prepending new chunk for StoryId {} timeline {}-{} ", storyId, TimelineStart(), TimelineEnd());
 #endif
     StoryChunk * new_chunk = new chronolog::StoryChunk(chronicleName, storyName, storyId, TimelineStart() - chunkGranularity, TimelineStart());
+    new_chunk->setShardIndex(shardIndex);
 
     auto result = storyTimelineMap.insert( std::pair <uint64_t, chronolog::StoryChunk*>(new_chunk->getStartTime(), new_chunk));
 
@@ -164,6 +167,7 @@ std::map <uint64_t, chronolog::StoryChunk*>::iterator chronolog::StoryPipeline::
 #endif
 
     chl::StoryChunk * new_chunk = new chronolog::StoryChunk(chronicleName, storyName, storyId, TimelineEnd(),TimelineEnd() + chunkGranularity);
+    new_chunk->setShardIndex(shardIndex);
     auto result = storyTimelineMap.insert( std::pair <uint64_t, chronolog::StoryChunk*>(TimelineEnd(),new_chunk));
 
     if(!result.second)
@@ -238,6 +242,7 @@ void chronolog::StoryPipeline::extractDecayedStoryChunks(uint64_t current_time)
             }
             else
             {
+                chl::EventTracer::getInstance().recordStage(extractedChunk->getTracedEvents(), "extraction_queued");
                 theExtractionQueue.stashStoryChunk(extractedChunk);
             }
         }
@@ -248,6 +253,40 @@ void chronolog::StoryPipeline::extractDecayedStoryChunks(uint64_t current_time)
 
 }
 
+//////////////////////
+// Copy the events with timestamps in range [start_time, end_time) currently held in the StoryPipeline
+// into the target_chunk, leaving the StoryPipeline intact
+// return the number of events copied
+//
+uint32_t chronolog::StoryPipeline::copyEvents(chronolog::StoryChunk &target_chunk, uint64_t start_time, uint64_t end_time)
+{
+    uint32_t copied_event_count = 0;
+
+    std::lock_guard <std::mutex> lock(sequencingMutex);
+
+    if(start_time >= TimelineEnd() || end_time <= TimelineStart())
+    { return copied_event_count; }
+
+    // start with the chunk preceeding the lower_bound as it might hold the events past start_time
+    auto chunk_iter = storyTimelineMap.lower_bound(start_time);
+    if(chunk_iter != storyTimelineMap.begin())
+    { chunk_iter--; }
+
+    for(; chunk_iter != storyTimelineMap.end() && (*chunk_iter).first < end_time; ++chunk_iter)
+    {
+        for(auto event_iter = (*chunk_iter).second->lower_bound(start_time);
+            event_iter != (*chunk_iter).second->end() && (*event_iter).second.time() < end_time; ++event_iter)
+        {
+            copied_event_count += target_chunk.insertEvent((*event_iter).second);
+        }
+    }
+
+    LOG_DEBUG("[StoryPipeline] StoryId {} timeline {}-{} : copied {} events in range {}-{}", storyId, TimelineStart()
+              , TimelineEnd(), copied_event_count, start_time, end_time);
+
+    return copied_event_count;
+}
+
 //////////////////////
 // Merge the StoryChunk obtained from external source into the StoryPipeline
 // Note that the granularity of the StoryChunk being merged may be 
@@ -260,6 +299,7 @@ void chronolog::StoryPipeline::mergeEvents(chronolog::StoryChunk &other_chunk)
     if(other_chunk.empty())
     { return; }
 
+    chl::EventTracer::getInstance().recordStage(other_chunk.getTracedEvents(), "merged");
     std::lock_guard <std::mutex> lock(sequencingMutex);
 
     LOG_DEBUG("[StoryPipeline] StoryId {} timeline {}-{} : Merging in StoryChunk {}-{} eventCount {} 1stEventTime {}", storyId, TimelineStart(), TimelineEnd()
@@ -24,6 +24,7 @@ public:
     StoryPipeline(StoryChunkExtractionQueue &, ChronicleName const &chronicle_name, StoryName const &story_name
                   , StoryId const &story_id, uint64_t start_time, uint32_t chunk_granularity = 60 // seconds
                   , uint32_t acceptance_window = 120 // seconds
+                  , uint32_t shard_index = 0 // story shard recorded by this pipeline, 0 for the unsharded story
     );
 
     StoryPipeline(StoryPipeline const &) = delete;
@@ -41,12 +42,23 @@ public:
 
     void extractDecayedStoryChunks(uint64_t);
 
+    uint32_t copyEvents(StoryChunk &, uint64_t start_time, uint64_t end_time);
+
     StoryId const &getStoryId() const
     { return storyId; }
 
+    ChronicleName const &getChronicleName() const
+    { return chronicleName; }
+
+    StoryName const &getStoryName() const
+    { return storyName; }
+
     uint64_t getAcceptanceWindow() const
     { return acceptanceWindow; }
 
+    uint32_t getShardIndex() const
+    { return shardIndex; }
+
     uint64_t TimelineStart() const
     { return (*storyTimelineMap.begin()).first; }  // storyTimelineMap is never left empty 
 
@@ -61,6 +73,7 @@ private:
     StoryName storyName;
     uint64_t chunkGranularity;
     uint64_t acceptanceWindow;
+    uint32_t shardIndex;
     uint64_t revisionTime; //time of the most recent merge
 
     // mutex used to protect the IngestionQueue from concurrent access
@@ -0,0 +1,38 @@
+#ifndef STORY_RECORDING_START_MSG_H
+#define STORY_RECORDING_START_MSG_H
+
+#include <iostream>
+#include "chronolog_types.h"
+#include "StoryAdmissionLimits.h"
+
+namespace chronolog
+{
+
+// one story of the batched story recording start notification
+// the Visor sends to the Keepers, Grapher and Player of a RecordingGroup
+struct StoryRecordingStartMsg
+{
+    ChronicleName chronicleName;
+    StoryName storyName;
+    StoryId storyId = 0;
+    uint64_t startTime = 0;
+    uint32_t shardIndex = 0;    // only the Grapher uses the shard index of the sharded story
+    StoryAdmissionLimits admissionLimits;   // only the Keepers enforce the event rate limits
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT(chronicleName, storyName, storyId, startTime, shardIndex, admissionLimits);
+    }
+};
+
+}//namespace
+
+inline std::ostream &operator<<(std::ostream &out, chronolog::StoryRecordingStartMsg const &msg)
+{
+    out << "StoryRecordingStartMsg{" << msg.chronicleName << ":" << msg.storyName << ":" << msg.storyId << "}{"
+        << msg.startTime << "}{shard:" << msg.shardIndex << "}";
+    return out;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef STORY_STATISTICS_RESPONSE_MSG_H
+#define STORY_STATISTICS_RESPONSE_MSG_H
+
+#include <iostream>
+#include "chronolog_types.h"
+#include "chronolog_client.h" //for chronolog::StoryStatistics definition
+
+namespace chronolog
+{
+
+class StoryStatisticsResponseMsg
+{
+    int error_code;
+    StoryStatistics statistics;
+
+public:
+
+    StoryStatisticsResponseMsg()
+        : error_code(chronolog::CL_SUCCESS)
+    {}
+
+    StoryStatisticsResponseMsg(int code, StoryStatistics const &story_statistics = StoryStatistics())
+        : error_code(code)
+        , statistics(story_statistics)
+    {}
+
+    ~StoryStatisticsResponseMsg() = default;
+
+    int getErrorCode() const
+    { return error_code; }
+
+    StoryStatistics const &getStatistics() const
+    { return statistics; }
+
+    template <typename SerArchiveT>
+    void serialize(SerArchiveT &serT)
+    {
+        serT & error_code;
+        serT & statistics;
+    }
+
+};
+
+}//namespace
+
+
+inline std::ostream &operator<<(std::ostream &out, chronolog::StoryStatisticsResponseMsg const &msg)
+{
+    out << "StoryStatisticsResponseMsg{" << msg.getErrorCode() << "}{events:" << msg.getStatistics().eventCount << "}";
+    return out;
+}
+
+#endif
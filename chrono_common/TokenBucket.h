@@ -0,0 +1,87 @@
+#ifndef CHRONOLOG_TOKEN_BUCKET_H
+#define CHRONOLOG_TOKEN_BUCKET_H
+
+#include <cstdint>
+
+namespace chronolog
+{
+
+// TokenBucket admits up to rate events per second on average and bursts of up to burst events.
+// The tokens are kept in nano-token units so that the refill is exact integer arithmetic;
+// the caller passes the current time in nanoseconds and does the locking
+class TokenBucket
+{
+public:
+    TokenBucket(uint64_t rate = 0, uint64_t burst = 0)
+        : ratePerSec(rate)
+        , capacity((burst == 0 ? rate : burst) * NANOS_PER_TOKEN)
+        , available(capacity)
+        , lastRefillTime(0)
+    {}
+
+    uint64_t getRate() const
+    { return ratePerSec; }
+
+    // rate 0 means no limit
+    bool isUnlimited() const
+    { return (ratePerSec == 0); }
+
+    void refill(uint64_t now)
+    {
+        if(isUnlimited())
+        { return; }
+        if(lastRefillTime == 0 || now <= lastRefillTime)
+        {
+            if(lastRefillTime == 0)
+            { lastRefillTime = now; }
+            return;
+        }
+        uint64_t elapsed = now - lastRefillTime;
+        lastRefillTime = now;
+        // the full bucket is reached without computing elapsed * rate that could overflow after a long idle time
+        uint64_t missing = capacity - available;
+        if(elapsed >= missing / ratePerSec + 1)
+        { available = capacity; }
+        else
+        { available += elapsed * ratePerSec; }
+    }
+
+    bool hasTokens(uint64_t tokens = 1) const
+    { return (isUnlimited() || available >= tokens * NANOS_PER_TOKEN); }
+
+    // the full bucket is the same as a new one
+    bool isFull() const
+    { return (isUnlimited() || available == capacity); }
+
+    uint64_t getLastRefillTime() const
+    { return lastRefillTime; }
+
+    void consume(uint64_t tokens = 1)
+    {
+        if(!isUnlimited())
+        { available -= tokens * NANOS_PER_TOKEN; }
+    }
+
+    bool tryConsume(uint64_t now, uint64_t tokens = 1)
+    {
+        if(isUnlimited())
+        { return true; }
+        refill(now);
+        if(!hasTokens(tokens))
+        { return false; }
+        consume(tokens);
+        return true;
+    }
+
+private:
+    static constexpr uint64_t NANOS_PER_TOKEN = 1000000000;
+
+    uint64_t ratePerSec;
+    uint64_t capacity;          // nano-tokens
+    uint64_t available;         // nano-tokens
+    uint64_t lastRefillTime;    // nanoseconds
+};
+
+}
+
+#endif
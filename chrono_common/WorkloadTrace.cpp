@@ -0,0 +1,274 @@
+#include "chrono_monitor.h"
+#include "client_errcode.h"
+#include "WorkloadTrace.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+void appendFixed(std::string &buffer, uint64_t value, int byte_count)
+{
+    for(int i = 0; i < byte_count; ++i)
+    { buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF)); }
+}
+
+void appendVarint(std::string &buffer, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+void appendString(std::string &buffer, std::string const &value)
+{
+    appendVarint(buffer, value.size());
+    buffer.append(value);
+}
+
+bool readFixed(std::istream &stream, uint64_t &value, int byte_count)
+{
+    unsigned char bytes[8];
+    if(!stream.read(reinterpret_cast<char*>(bytes), byte_count))
+    { return false; }
+    value = 0;
+    for(int i = 0; i < byte_count; ++i)
+    { value |= static_cast<uint64_t>(bytes[i]) << (8 * i); }
+    return true;
+}
+
+bool readVarint(std::istream &stream, uint64_t &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = stream.get();
+        if(byte == std::char_traits <char>::eof())
+        { return false; }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+        { return true; }
+    }
+    return false;
+}
+
+bool readString(std::istream &stream, std::string &value)
+{
+    uint64_t size = 0;
+    if(!readVarint(stream, size))
+    { return false; }
+    value.resize(size);
+    return (size == 0 || static_cast<bool>(stream.read(&value[0], size)));
+}
+
+}
+
+////////////////////////
+
+chl::WorkloadTraceWriter*
+chl::WorkloadTraceWriter::CreateWorkloadTraceWriter(std::string const &trace_file, bool keep_payloads)
+{
+    WorkloadTraceWriter*traceWriter = new WorkloadTraceWriter(trace_file, keep_payloads);
+    if(!traceWriter->traceStream.is_open())
+    {
+        LOG_ERROR("[WorkloadTraceWriter] Failed to open workload trace file {}", trace_file);
+        delete traceWriter;
+        return nullptr;
+    }
+    LOG_INFO("[WorkloadTraceWriter] Capturing the client workload into {}, payloads {}", trace_file
+             , (keep_payloads ? "kept" : "redacted"));
+    return traceWriter;
+}
+
+chl::WorkloadTraceWriter::WorkloadTraceWriter(std::string const &trace_file, bool keep_payloads)
+        : traceFile(trace_file), keepPayloads(keep_payloads)
+        , traceStream(trace_file, std::ios::out | std::ios::binary | std::ios::trunc)
+        , captureStart(std::chrono::steady_clock::now()), lastOffset(0), recordCount(0)
+{
+    buffer.reserve(WORKLOAD_TRACE_FLUSH_SIZE + 4096);
+    appendFixed(buffer, WORKLOAD_TRACE_MAGIC, 4);
+    appendFixed(buffer, WORKLOAD_TRACE_VERSION, 2);
+    appendFixed(buffer, (keepPayloads ? WORKLOAD_TRACE_FLAG_PAYLOADS : 0), 2);
+    appendFixed(buffer, std::chrono::duration_cast <std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count(), 8);
+}
+
+chl::WorkloadTraceWriter::~WorkloadTraceWriter()
+{
+    std::lock_guard <std::mutex> lock(writerMutex);
+    flush();
+    if(traceStream.is_open())
+    {
+        traceStream.close();
+        LOG_INFO("[WorkloadTraceWriter] Captured {} workload records into {}", recordCount, traceFile);
+    }
+}
+
+////////////////////////
+
+void chl::WorkloadTraceWriter::startRecord(chl::WorkloadRecordType record_type, uint32_t story_index)
+{
+    uint64_t offset = std::chrono::duration_cast <std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - captureStart).count();
+    // the offsets are stored as the deltas from the previous record to keep them to a byte or two
+    uint64_t offset_delta = (offset > lastOffset ? offset - lastOffset : 0);
+    lastOffset += offset_delta;
+
+    auto thread_iter = threadIndexes.find(std::this_thread::get_id());
+    if(thread_iter == threadIndexes.end())
+    {
+        thread_iter = threadIndexes.insert(
+                std::pair <std::thread::id, uint32_t>(std::this_thread::get_id(), threadIndexes.size())).first;
+    }
+
+    buffer.push_back(static_cast<char>(record_type));
+    appendVarint(buffer, offset_delta);
+    appendVarint(buffer, (*thread_iter).second);
+    appendVarint(buffer, story_index);
+    recordCount++;
+}
+
+void chl::WorkloadTraceWriter::recordAcquireStory(chl::ChronicleName const &chronicle, chl::StoryName const &story
+                                                  , chl::StoryId const &story_id)
+{
+    std::lock_guard <std::mutex> lock(writerMutex);
+    if(!traceStream.is_open())
+    { return; }
+
+    // the story keeps its index when it's acquired again after the release
+    auto story_iter = storyIndexes.find(std::pair <ChronicleName, StoryName>(chronicle, story));
+    if(story_iter == storyIndexes.end())
+    {
+        story_iter = storyIndexes.insert(std::pair <std::pair <ChronicleName, StoryName>, uint32_t>(
+                std::pair <ChronicleName, StoryName>(chronicle, story), storyIndexes.size())).first;
+    }
+    storyIdIndexes[story_id] = (*story_iter).second;
+
+    startRecord(WORKLOAD_ACQUIRE_STORY, (*story_iter).second);
+    appendString(buffer, chronicle);
+    appendString(buffer, story);
+}
+
+void chl::WorkloadTraceWriter::recordReleaseStory(chl::ChronicleName const &chronicle, chl::StoryName const &story)
+{
+    std::lock_guard <std::mutex> lock(writerMutex);
+    if(!traceStream.is_open())
+    { return; }
+
+    auto story_iter = storyIndexes.find(std::pair <ChronicleName, StoryName>(chronicle, story));
+    if(story_iter == storyIndexes.end())
+    { return; }
+
+    startRecord(WORKLOAD_RELEASE_STORY, (*story_iter).second);
+    if(buffer.size() >= WORKLOAD_TRACE_FLUSH_SIZE)
+    { flush(); }
+}
+
+void chl::WorkloadTraceWriter::recordEvent(chl::StoryId const &story_id, std::string const &event_record)
+{
+    std::lock_guard <std::mutex> lock(writerMutex);
+    if(!traceStream.is_open())
+    { return; }
+
+    auto story_iter = storyIdIndexes.find(story_id);
+    if(story_iter == storyIdIndexes.end())
+    { return; }
+
+    startRecord(WORKLOAD_LOG_EVENT, (*story_iter).second);
+    appendVarint(buffer, event_record.size());
+    if(keepPayloads)
+    { buffer.append(event_record); }
+    if(buffer.size() >= WORKLOAD_TRACE_FLUSH_SIZE)
+    { flush(); }
+}
+
+void chl::WorkloadTraceWriter::flush()
+{
+    if(buffer.empty() || !traceStream.is_open())
+    { return; }
+
+    traceStream.write(buffer.data(), buffer.size());
+    buffer.clear();
+    if(!traceStream.good())
+    {
+        // stop capturing rather than leave a trace with the records missing in the middle
+        LOG_ERROR("[WorkloadTraceWriter] Failed to write workload trace file {}, capture stopped after {} records"
+                  , traceFile, recordCount);
+        traceStream.close();
+    }
+}
+
+////////////////////////
+
+chl::WorkloadTraceReader*chl::WorkloadTraceReader::CreateWorkloadTraceReader(std::string const &trace_file)
+{
+    WorkloadTraceReader*traceReader = new WorkloadTraceReader();
+    traceReader->traceStream.open(trace_file, std::ios::in | std::ios::binary);
+    if(!traceReader->traceStream.is_open())
+    {
+        LOG_ERROR("[WorkloadTraceReader] Failed to open workload trace file {}", trace_file);
+        delete traceReader;
+        return nullptr;
+    }
+
+    uint64_t magic = 0, version = 0, flags = 0;
+    if(!readFixed(traceReader->traceStream, magic, 4) || !readFixed(traceReader->traceStream, version, 2) ||
+       !readFixed(traceReader->traceStream, flags, 2) ||
+       !readFixed(traceReader->traceStream, traceReader->captureStartTime, 8) || magic != WORKLOAD_TRACE_MAGIC ||
+       version != WORKLOAD_TRACE_VERSION)
+    {
+        LOG_ERROR("[WorkloadTraceReader] {} is not a workload trace of version {}", trace_file
+                  , WORKLOAD_TRACE_VERSION);
+        delete traceReader;
+        return nullptr;
+    }
+    traceReader->flags = static_cast<uint16_t>(flags);
+    return traceReader;
+}
+
+int chl::WorkloadTraceReader::readRecord(chl::WorkloadRecord &record)
+{
+    int record_type = traceStream.get();
+    if(record_type == std::char_traits <char>::eof())
+    { return chl::CL_ERR_UNKNOWN; }
+
+    uint64_t offset_delta = 0, thread_index = 0, story_index = 0;
+    if(!readVarint(traceStream, offset_delta) || !readVarint(traceStream, thread_index) ||
+       !readVarint(traceStream, story_index))
+    { return chl::CL_ERR_UNKNOWN; }
+
+    lastOffset += offset_delta;
+    record.type = static_cast<WorkloadRecordType>(record_type);
+    record.offset = lastOffset;
+    record.threadIndex = thread_index;
+    record.storyIndex = story_index;
+    record.payloadSize = 0;
+    record.payload.clear();
+
+    switch(record.type)
+    {
+        case WORKLOAD_ACQUIRE_STORY:
+            if(!readString(traceStream, record.chronicleName) || !readString(traceStream, record.storyName))
+            { return chl::CL_ERR_UNKNOWN; }
+            break;
+        case WORKLOAD_RELEASE_STORY:
+            break;
+        case WORKLOAD_LOG_EVENT:
+            if(!readVarint(traceStream, record.payloadSize))
+            { return chl::CL_ERR_UNKNOWN; }
+            if(hasPayloads())
+            {
+                record.payload.resize(record.payloadSize);
+                if(record.payloadSize > 0 && !traceStream.read(&record.payload[0], record.payloadSize))
+                { return chl::CL_ERR_UNKNOWN; }
+            }
+            break;
+        default:
+            LOG_ERROR("[WorkloadTraceReader] Unknown workload record type {}", record_type);
+            return chl::CL_ERR_UNKNOWN;
+    }
+    return chl::CL_SUCCESS;
+}
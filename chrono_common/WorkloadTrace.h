@@ -0,0 +1,123 @@
+#ifndef CHRONOLOG_WORKLOAD_TRACE_H
+#define CHRONOLOG_WORKLOAD_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "chronolog_types.h"
+
+// workload trace file : "CLWT" magic, version, flags, capture start wall clock time,
+// followed by the records in the order the client made the calls
+#define WORKLOAD_TRACE_MAGIC 0x54574C43
+#define WORKLOAD_TRACE_VERSION 1
+// the payload bytes follow the event sizes, otherwise the payloads are redacted
+#define WORKLOAD_TRACE_FLAG_PAYLOADS 0x1
+// the records are buffered and written out in blocks of this size
+#define WORKLOAD_TRACE_FLUSH_SIZE 1048576
+
+namespace chronolog
+{
+
+enum WorkloadRecordType: uint8_t
+{
+    WORKLOAD_ACQUIRE_STORY = 1, WORKLOAD_RELEASE_STORY = 2, WORKLOAD_LOG_EVENT = 3
+};
+
+// WorkloadRecord is one client call of the captured workload
+// the stories and the client threads are numbered in the order they first appear in the trace,
+// the chronicle and story names are only carried by the acquire records
+struct WorkloadRecord
+{
+    WorkloadRecordType type = WORKLOAD_LOG_EVENT;
+    uint64_t offset = 0;            // nanoseconds since the capture start
+    uint32_t threadIndex = 0;
+    uint32_t storyIndex = 0;
+    ChronicleName chronicleName;
+    StoryName storyName;
+    uint64_t payloadSize = 0;
+    std::string payload;            // empty when the payloads are redacted
+};
+
+// WorkloadTraceWriter captures the AcquireStory / log_event / ReleaseStory calls of the client process
+// with their timing, the story and thread they came from and the event sizes;
+// every record is a few bytes of varints unless the payloads are kept
+class WorkloadTraceWriter
+{
+public:
+    static WorkloadTraceWriter*CreateWorkloadTraceWriter(std::string const &trace_file, bool keep_payloads);
+
+    ~WorkloadTraceWriter();
+
+    void recordAcquireStory(ChronicleName const &, StoryName const &, StoryId const &);
+
+    void recordReleaseStory(ChronicleName const &, StoryName const &);
+
+    void recordEvent(StoryId const &, std::string const &event_record);
+
+    uint64_t getRecordCount() const
+    { return recordCount; }
+
+private:
+    WorkloadTraceWriter(std::string const &trace_file, bool keep_payloads);
+
+    WorkloadTraceWriter(WorkloadTraceWriter const &) = delete;
+
+    WorkloadTraceWriter &operator=(WorkloadTraceWriter const &) = delete;
+
+    // appends the record header to the buffer, called with the writerMutex held
+    void startRecord(WorkloadRecordType, uint32_t story_index);
+
+    void flush();
+
+    std::string traceFile;
+    bool keepPayloads;
+    std::mutex writerMutex;
+    std::ofstream traceStream;
+    std::string buffer;
+    std::chrono::steady_clock::time_point captureStart;
+    uint64_t lastOffset;
+    uint64_t recordCount;
+    std::map <std::pair <ChronicleName, StoryName>, uint32_t> storyIndexes;
+    std::unordered_map <StoryId, uint32_t> storyIdIndexes;
+    std::unordered_map <std::thread::id, uint32_t> threadIndexes;
+};
+
+class WorkloadTraceReader
+{
+public:
+    // returns nullptr if the file is not a workload trace of a known version
+    static WorkloadTraceReader*CreateWorkloadTraceReader(std::string const &trace_file);
+
+    ~WorkloadTraceReader() = default;
+
+    bool hasPayloads() const
+    { return (flags & WORKLOAD_TRACE_FLAG_PAYLOADS); }
+
+    uint64_t getCaptureStartTime() const
+    { return captureStartTime; }
+
+    // returns CL_SUCCESS, CL_ERR_UNKNOWN at the end of the trace or if the record is truncated
+    int readRecord(WorkloadRecord &);
+
+private:
+    WorkloadTraceReader() = default;
+
+    WorkloadTraceReader(WorkloadTraceReader const &) = delete;
+
+    WorkloadTraceReader &operator=(WorkloadTraceReader const &) = delete;
+
+    std::ifstream traceStream;
+    uint16_t flags = 0;
+    uint64_t captureStartTime = 0;
+    uint64_t lastOffset = 0;
+};
+
+}//namespace
+
+#endif
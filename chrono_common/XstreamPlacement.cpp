@@ -0,0 +1,160 @@
+#include <set>
+
+#include "chrono_monitor.h"
+#include "chronolog_errcode.h"
+#include "CoreList.h"
+#include "XstreamPlacement.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+std::set <int> numa_nodes_of(std::vector <int> const &cores)
+{
+    std::set <int> nodes;
+    for(int core: cores)
+    { nodes.insert(chl::getCoreNumaNode(core)); }
+    return nodes;
+}
+
+}
+
+////////////////////////
+
+chl::XstreamPlacement::XstreamPlacement()
+{
+    for(int role = 0; role < XSTREAM_ROLE_COUNT; ++role)
+    {
+        nextRoleCore[role] = 0;
+        rolePools[role] = nullptr;
+    }
+}
+
+////////////////////////
+
+chl::XstreamPlacement::~XstreamPlacement()
+{
+    shutdownHandlerXstreams();
+    for(int role = 0; role < XSTREAM_ROLE_COUNT; ++role)
+    {
+        if(rolePools[role] != nullptr)
+        { delete rolePools[role]; }
+    }
+}
+
+////////////////////////
+
+int chl::XstreamPlacement::initialize(CorePlacementConf const &core_placement_conf)
+{
+    std::string const*core_lists[XSTREAM_ROLE_COUNT] = {&core_placement_conf.rpc_cores
+                                                         , &core_placement_conf.sequencing_cores
+                                                         , &core_placement_conf.extraction_cores
+                                                         , &core_placement_conf.io_cores};
+    for(int role = 0; role < XSTREAM_ROLE_COUNT; ++role)
+    {
+        roleCores[role].clear();
+        if(parseCoreList(*core_lists[role], roleCores[role]) != CL_SUCCESS)
+        {
+            LOG_ERROR("[XstreamPlacement] Invalid {} core list '{}'", to_string(static_cast<XstreamRole>(role))
+                      , *core_lists[role]);
+            roleCores[role].clear();
+            return CL_ERR_INVALID_CONF;
+        }
+    }
+
+    // the events handed over by the rpc handlers to the sequencing xstreams would cross the sockets otherwise
+    if(isPinned(XSTREAM_RPC) && isPinned(XSTREAM_SEQUENCING))
+    {
+        std::set <int> rpc_nodes = numa_nodes_of(roleCores[XSTREAM_RPC]);
+        std::set <int> sequencing_nodes = numa_nodes_of(roleCores[XSTREAM_SEQUENCING]);
+        if(rpc_nodes.size() > 1 || rpc_nodes != sequencing_nodes)
+        {
+            LOG_WARNING("[XstreamPlacement] The rpc and sequencing cores are not on a single NUMA node, "
+                        "the ingested events will cross the NUMA nodes");
+        }
+    }
+    LOG_INFO("[XstreamPlacement] {}", to_String());
+    return CL_SUCCESS;
+}
+
+////////////////////////
+
+tl::pool chl::XstreamPlacement::getRolePool(XstreamRole role)
+{
+    if(rolePools[role] == nullptr)
+    { rolePools[role] = new tl::managed <tl::pool>(tl::pool::create(tl::pool::access::mpmc)); }
+    return **rolePools[role];
+}
+
+////////////////////////
+
+tl::managed <tl::xstream> chl::XstreamPlacement::createXstream(XstreamRole role)
+{
+    if(!isPinned(role))
+    { return tl::xstream::create(); }
+
+    int core = roleCores[role][nextRoleCore[role] % roleCores[role].size()];
+    nextRoleCore[role]++;
+
+    tl::managed <tl::xstream> es = tl::xstream::create(tl::scheduler::predef::deflt, getRolePool(role));
+    try
+    {
+        es->set_cpubind(core);
+        LOG_DEBUG("[XstreamPlacement] Created {} xstream ESrank={} on core {} NUMA node {}", to_string(role)
+                  , es->get_rank(), core, getCoreNumaNode(core));
+    }
+    catch(tl::exception const &ex)
+    {
+        // the xstream still runs the role pool, only without the affinity
+        LOG_WARNING("[XstreamPlacement] Failed to bind {} xstream ESrank={} to core {}: {}", to_string(role)
+                    , es->get_rank(), core, ex.what());
+    }
+    return es;
+}
+
+////////////////////////
+
+tl::pool chl::XstreamPlacement::createHandlerXstreams(XstreamRole role)
+{
+    if(!isPinned(role))
+    { return tl::pool(); }
+
+    for(size_t i = 0; i < roleCores[role].size(); ++i)
+    { handlerStreams.push_back(createXstream(role)); }
+    return getRolePool(role);
+}
+
+////////////////////////
+
+void chl::XstreamPlacement::shutdownHandlerXstreams()
+{
+    for(auto &es: handlerStreams)
+    { es->join(); }
+    if(!handlerStreams.empty())
+    { LOG_DEBUG("[XstreamPlacement] {} handler xstreams have been joined", handlerStreams.size()); }
+    handlerStreams.clear();
+}
+
+////////////////////////
+
+std::string chl::XstreamPlacement::to_String() const
+{
+    std::string placement;
+    for(int role = 0; role < XSTREAM_ROLE_COUNT; ++role)
+    {
+        placement += std::string(role == 0 ? "" : ", ") + to_string(static_cast<XstreamRole>(role)) + " cores: ";
+        if(roleCores[role].empty())
+        {
+            placement += "unpinned";
+            continue;
+        }
+        for(size_t i = 0; i < roleCores[role].size(); ++i)
+        { placement += (i == 0 ? "" : ",") + std::to_string(roleCores[role][i]); }
+        placement += " (NUMA nodes";
+        for(int node: numa_nodes_of(roleCores[role]))
+        { placement += " " + std::to_string(node); }
+        placement += ")";
+    }
+    return placement;
+}
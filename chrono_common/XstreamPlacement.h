@@ -0,0 +1,88 @@
+#ifndef CHRONOLOG_XSTREAM_PLACEMENT_H
+#define CHRONOLOG_XSTREAM_PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <thallium.hpp>
+
+#include "ConfigurationManager.h"
+
+namespace tl = thallium;
+
+namespace chronolog
+{
+
+enum XstreamRole
+{
+    XSTREAM_RPC = 0, XSTREAM_SEQUENCING = 1, XSTREAM_EXTRACTION = 2, XSTREAM_IO = 3, XSTREAM_ROLE_COUNT = 4
+};
+
+inline const char*to_string(XstreamRole role)
+{
+    switch(role)
+    {
+        case XSTREAM_RPC:
+            return "rpc";
+        case XSTREAM_SEQUENCING:
+            return "sequencing";
+        case XSTREAM_EXTRACTION:
+            return "extraction";
+        case XSTREAM_IO:
+            return "io";
+        default:
+            return "unknown";
+    }
+}
+
+// XstreamPlacement creates the xstreams of the Keeper, Grapher and Player modules according to the CorePlacementConf.
+// The xstreams of a pinned role are bound round robin to the role's cores and run the role's own Argobots pool,
+// so that the ULTs of one kind of work never compete with the other kinds for a core;
+// the xstreams of an unpinned role are created as before, with no affinity and their own default pool.
+// The event storage of the story chunks is first touched by the sequencing xstreams that merge the events,
+// so with the sequencing cores on the NUMA node of the rpc cores the ingest path stays NUMA local.
+// XstreamPlacement is initialized and used by the main thread at startup, it has to outlive all the xstreams it
+// created as they run its pools.
+class XstreamPlacement
+{
+public:
+    XstreamPlacement();
+
+    ~XstreamPlacement();
+
+    // parses the core lists, returns CL_ERR_INVALID_CONF if any of them is malformed
+    int initialize(CorePlacementConf const &);
+
+    bool isPinned(XstreamRole role) const
+    { return !roleCores[role].empty(); }
+
+    std::vector <int> const &getCores(XstreamRole role) const
+    { return roleCores[role]; }
+
+    // creates an xstream for the role, pinned to the next core of the role if the role is pinned
+    tl::managed <tl::xstream> createXstream(XstreamRole role);
+
+    // creates one xstream per core of the pinned role and returns the role pool the rpc handlers are to run on;
+    // returns the null pool, that leaves the handlers on the margo rpc xstream, if the role isn't pinned
+    tl::pool createHandlerXstreams(XstreamRole role);
+
+    // joins the handler xstreams once the providers using their pool are gone
+    void shutdownHandlerXstreams();
+
+    std::string to_String() const;
+
+private:
+    XstreamPlacement(XstreamPlacement const &) = delete;
+
+    XstreamPlacement &operator=(XstreamPlacement const &) = delete;
+
+    tl::pool getRolePool(XstreamRole role);
+
+    std::vector <int> roleCores[XSTREAM_ROLE_COUNT];
+    size_t nextRoleCore[XSTREAM_ROLE_COUNT];
+    tl::managed <tl::pool>*rolePools[XSTREAM_ROLE_COUNT];
+    std::vector <tl::managed <tl::xstream>> handlerStreams;
+};
+
+}
+
+#endif
@@ -129,6 +129,7 @@ generate_config_files() {
     local base_port_grapher_datastore=$(jq -r '.chrono_grapher.DataStoreAdminService.rpc.service_base_port' "$default_conf")
     local base_port_player_datastore=$(jq -r '.chrono_player.PlayerStoreAdminService.rpc.service_base_port' "$default_conf")
     local base_port_player_playback=$(jq -r '.chrono_player.PlaybackQueryService.rpc.service_base_port' "$default_conf")
+    local base_port_player_drain=$(jq -r '.chrono_player.GrapherPlayerDrainService.rpc.service_base_port' "$default_conf")
 
     # Generate grapher configuration files
     echo "Generating grapher configuration files ..."
@@ -136,6 +137,7 @@ generate_config_files() {
     for (( i=0; i<num_recording_groups; i++ )); do
         local new_port_grapher_drain=$((base_port_grapher_drain + i))
         local new_port_grapher_datastore=$((base_port_grapher_datastore + i))
+        local new_port_player_drain=$((base_port_player_drain + i))
 
         local grapher_index=$((i + 1))
         local grapher_output_file="${conf_dir}/grapher_conf_${grapher_index}.json"
@@ -146,11 +148,13 @@ generate_config_files() {
             --arg output_dir "$output_dir" \
             --argjson new_port_grapher_drain $new_port_grapher_drain \
             --argjson new_port_grapher_datastore $new_port_grapher_datastore \
+            --argjson new_port_player_drain $new_port_player_drain \
             --argjson grapher_index "$grapher_index" \
             --arg grapher_monitoring_file_name "$grapher_monitoring_file_name" \
            '.chrono_grapher.RecordingGroup = $grapher_index |
             .chrono_grapher.KeeperGrapherDrainService.rpc.service_base_port = $new_port_grapher_drain |
             .chrono_grapher.DataStoreAdminService.rpc.service_base_port = $new_port_grapher_datastore |
+            .chrono_grapher.GrapherPlayerDrainService.rpc.service_base_port = $new_port_player_drain |
             .chrono_grapher.Monitoring.monitor.file = ($monitor_dir + "/" + ($grapher_index | tostring) + "_" + $grapher_monitoring_file_name) |
             .chrono_grapher.Extractors.story_files_dir = ($output_dir + "/")' "$default_conf" > "$grapher_output_file"
 
@@ -162,6 +166,7 @@ generate_config_files() {
     for (( i=0; i<num_recording_groups; i++ )); do
         local new_port_player_datastore=$((base_port_player_datastore + i))
         local new_port_player_playback=$((base_port_player_playback + i))
+        local new_port_player_drain=$((base_port_player_drain + i))
 
         local player_index=$((i + 1))
         local player_output_file="${conf_dir}/player_conf_${player_index}.json"
@@ -172,11 +177,13 @@ generate_config_files() {
             --arg output_dir "$output_dir" \
             --argjson new_port_player_datastore $new_port_player_datastore \
             --argjson new_port_player_playback $new_port_player_playback \
+            --argjson new_port_player_drain $new_port_player_drain \
             --argjson player_index "$player_index" \
             --arg player_monitoring_file_name "$player_monitoring_file_name" \
            '.chrono_player.RecordingGroup = $player_index |
             .chrono_player.PlayerStoreAdminService.rpc.service_base_port = $new_port_player_datastore |
             .chrono_player.PlaybackQueryService.rpc.service_base_port = $new_port_player_playback |
+            .chrono_player.GrapherPlayerDrainService.rpc.service_base_port = $new_port_player_drain |
             .chrono_player.Monitoring.monitor.file = ($monitor_dir + "/" + ($player_index | tostring) + "_" + $player_monitoring_file_name) |
             .chrono_player.ArchiveReaders.story_files_dir = ($output_dir + "/")' "$default_conf" >"$player_output_file"
 
@@ -208,6 +208,11 @@ check_rpc_comm_conf() {
     keeper_grapher_drain_rpc_in_grapher=$(jq '.chrono_grapher.KeeperGrapherDrainService.rpc' "${CONF_FILE}")
     [[ "${keeper_grapher_drain_rpc_in_keeper}" != "${keeper_grapher_drain_rpc_in_grapher}" ]] && echo -e "${ERR}mismatched KeeperGrapherDrainService conf in ${CONF_FILE}, exiting ...${NC}" >&2 && exit 1
 
+    # for GrapherPlayerDrainService, Grapher->Player
+    grapher_player_drain_rpc_in_grapher=$(jq '.chrono_grapher.GrapherPlayerDrainService.rpc' "${CONF_FILE}")
+    grapher_player_drain_rpc_in_player=$(jq '.chrono_player.GrapherPlayerDrainService.rpc' "${CONF_FILE}")
+    [[ "${grapher_player_drain_rpc_in_grapher}" != "${grapher_player_drain_rpc_in_player}" ]] && echo -e "${ERR}mismatched GrapherPlayerDrainService conf in ${CONF_FILE}, exiting ...${NC}" >&2 && exit 1
+
     # to assure Keeper, Grapher and Player use the same protocol for dataStoreAdminService
     keeper_data_store_admin_protocol=$(jq '.chrono_keeper.KeeperDataStoreAdminService.rpc.protocol_conf' "${CONF_FILE}")
     grapher_data_store_admin_protocol=$(jq '.chrono_grapher.DataStoreAdminService.rpc.protocol_conf' "${CONF_FILE}")
@@ -429,6 +434,8 @@ generate_conf_for_each_recording_group() {
         jq ".chrono_grapher.Extractors.story_files_dir = \"${OUTPUT_DIR}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
         jq ".chrono_player.PlayerStoreAdminService.rpc.service_ip = \"${player_ip}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
         jq ".chrono_player.PlaybackQueryService.rpc.service_ip = \"${player_ip}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
+        jq ".chrono_grapher.GrapherPlayerDrainService.rpc.service_ip = \"${player_ip}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
+        jq ".chrono_player.GrapherPlayerDrainService.rpc.service_ip = \"${player_ip}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
         jq ".chrono_player.ArchiveReaders.story_files_dir = \"${OUTPUT_DIR}\"" "${CONF_FILE}.${i}" >temp.json && mv temp.json "${CONF_FILE}.${i}"
 
         generate_conf_for_each_keeper "${CONF_FILE}.${i}" "${keeper_hosts_file}"
@@ -64,11 +64,68 @@ void BindChronologEvent(pybind11::module & m)
 
 };
 
+using chronolog::PlaybackFilter;
+void BindChronologPlaybackFilter(pybind11::module & m)
+{
+    pybind11::class_<PlaybackFilter>(m,"PlaybackFilter")
+    .def(pybind11::init<>())
+    .def_readwrite("client_ids",&PlaybackFilter::clientIds)
+    .def_readwrite("record_pattern",&PlaybackFilter::recordPattern)
+    .def_readwrite("pattern_is_regex",&PlaybackFilter::patternIsRegex)
+    .def_readwrite("sample_every_nth",&PlaybackFilter::sampleEveryNth)
+    .def_readwrite("reservoir_size",&PlaybackFilter::reservoirSize)
+    .def_readwrite("limit",&PlaybackFilter::limit);
+
+};
+
+using chronolog::AggregationQuery;
+using chronolog::AggregationBucket;
+void BindChronologAggregation(pybind11::module & m)
+{
+    pybind11::class_<AggregationQuery>(m,"AggregationQuery")
+    .def(pybind11::init<>())
+    .def_readwrite("bucket_width",&AggregationQuery::bucketWidth)
+    .def_readwrite("group_by_client",&AggregationQuery::groupByClient)
+    .def_readwrite("numeric_stats",&AggregationQuery::numericStats)
+    .def_readwrite("quantiles",&AggregationQuery::quantiles);
+
+    pybind11::class_<AggregationBucket>(m,"AggregationBucket")
+    .def(pybind11::init<>())
+    .def_readonly("bucket_start",&AggregationBucket::bucketStart)
+    .def_readonly("client_id",&AggregationBucket::clientId)
+    .def_readonly("event_count",&AggregationBucket::eventCount)
+    .def_readonly("value_count",&AggregationBucket::valueCount)
+    .def_readonly("sum",&AggregationBucket::sum)
+    .def_readonly("min",&AggregationBucket::min)
+    .def_readonly("max",&AggregationBucket::max)
+    .def_readonly("quantile_values",&AggregationBucket::quantileValues);
+
+};
+
+using chronolog::StoryStatistics;
+void BindChronologStoryStatistics(pybind11::module & m)
+{
+    pybind11::class_<StoryStatistics>(m,"StoryStatistics")
+    .def(pybind11::init<>())
+    .def_readonly("event_count",&StoryStatistics::eventCount)
+    .def_readonly("first_event_time",&StoryStatistics::firstEventTime)
+    .def_readonly("last_event_time",&StoryStatistics::lastEventTime)
+    .def_readonly("record_bytes",&StoryStatistics::recordBytes)
+    .def_readonly("min_record_size",&StoryStatistics::minRecordSize)
+    .def_readonly("max_record_size",&StoryStatistics::maxRecordSize)
+    .def_readonly("distinct_clients",&StoryStatistics::distinctClients)
+    .def_readonly("client_event_counts",&StoryStatistics::clientEventCounts)
+    .def_readonly("record_size_quantiles",&StoryStatistics::recordSizeQuantiles);
+
+};
+
 PYBIND11_MAKE_OPAQUE(std::vector<Event>);
+PYBIND11_MAKE_OPAQUE(std::vector<AggregationBucket>);
 
 void BindChronologEventVector(pybind11::module &m)
 {
     pybind11::bind_vector<std::vector<Event>>(m, "EventList");
+    pybind11::bind_vector<std::vector<AggregationBucket>>(m, "AggregationBucketList");
 };
 
 using chronolog::Client;
@@ -84,8 +141,18 @@ void BindChronologClient(pybind11::module &m)
     .def("DestroyChronicle", &Client::DestroyChronicle)
     .def("AcquireStory", &Client::AcquireStory, pybind11::return_value_policy::reference)
     .def("ReleaseStory", &Client::ReleaseStory, pybind11::arg("chronicle_name"), pybind11::arg("story_name"))
+    .def("AcquireStories", &Client::AcquireStories, pybind11::return_value_policy::reference)
+    .def("ReleaseStories", &Client::ReleaseStories, pybind11::arg("chronicle_name"), pybind11::arg("story_names"))
     .def("DestroyStory", &Client::DestroyStory, pybind11::arg("chronicle_name"), pybind11::arg("story_name"))
-    .def("ReplayStory", &Client::ReplayStory)
+    .def("ReplayStory", static_cast<int (Client::*)(std::string const &, std::string const &, uint64_t, uint64_t
+                                    , std::vector<Event> &)>(&Client::ReplayStory))
+    .def("ReplayStory", static_cast<int (Client::*)(std::string const &, std::string const &, uint64_t, uint64_t
+                                    , PlaybackFilter const &, std::vector<Event> &)>(&Client::ReplayStory))
+    .def("AggregateStory", &Client::AggregateStory, pybind11::arg("chronicle_name"), pybind11::arg("story_name")
+            , pybind11::arg("start"), pybind11::arg("end"), pybind11::arg("query"), pybind11::arg("buckets")
+            , pybind11::arg("filter") = PlaybackFilter())
+    .def("GetStoryStatistics", &Client::GetStoryStatistics, pybind11::arg("chronicle_name"), pybind11::arg("story_name")
+            , pybind11::arg("start"), pybind11::arg("end"), pybind11::arg("statistics"))
     ;
 };
 
@@ -95,6 +162,9 @@ PYBIND11_MODULE(py_chronolog_client, m)
     BindChronologClientQueryServiceConf(m);
     BindChronologStoryHandle(m);
     BindChronologEvent(m);
+    BindChronologPlaybackFilter(m);
+    BindChronologAggregation(m);
+    BindChronologStoryStatistics(m);
     BindChronologEventVector(m);
     BindChronologClient(m);
 }
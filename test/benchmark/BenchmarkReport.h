@@ -0,0 +1,152 @@
+#ifndef CHRONOLOG_BENCHMARK_REPORT_H
+#define CHRONOLOG_BENCHMARK_REPORT_H
+
+#include <chronolog_client.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chrono_monitor.h"
+#include "MetricsRegistry.h"
+
+// The metrics reported by the end-to-end benchmark drivers, the synthetic workload of chronolog_e2e_benchmark
+// and the captured workload of chronolog_workload_replay are reported the same way so that the runs compare.
+
+struct BenchmarkStory
+{
+    std::string chronicleName;
+    std::string storyName;
+    uint64_t eventCount = 0;        // events written to the story during the run
+};
+
+struct IngestResult
+{
+    uint64_t eventCount = 0;
+    uint64_t failedEventCount = 0;
+    uint64_t byteCount = 0;
+    double elapsedSecs = 0;
+    uint64_t firstEventTime = 0;
+    uint64_t lastEventTime = 0;
+
+    void addEventTime(uint64_t event_time)
+    {
+        if(firstEventTime == 0 || event_time < firstEventTime)
+        { firstEventTime = event_time; }
+        if(event_time > lastEventTime)
+        { lastEventTime = event_time; }
+    }
+
+    void merge(IngestResult const &other)
+    {
+        eventCount += other.eventCount;
+        failedEventCount += other.failedEventCount;
+        byteCount += other.byteCount;
+        if(other.eventCount > 0)
+        {
+            addEventTime(other.firstEventTime);
+            addEventTime(other.lastEventTime);
+        }
+    }
+};
+
+struct ReplayResult
+{
+    uint64_t eventCount = 0;
+    uint64_t byteCount = 0;
+    double elapsedSecs = 0;
+};
+
+// waits for the archived story statistics to account for all the events written to the stories,
+// returns the seconds since the end of the ingest phase or -1 on timeout
+inline double wait_for_archive(chronolog::Client &client, std::vector <BenchmarkStory> const &stories
+                               , IngestResult const &ingest_result
+                               , std::chrono::steady_clock::time_point ingest_end, uint32_t timeout_secs)
+{
+    auto deadline = ingest_end + std::chrono::seconds(timeout_secs);
+    std::vector <bool> archived(stories.size(), false);
+    size_t archived_count = 0;
+
+    while(archived_count < stories.size() && std::chrono::steady_clock::now() < deadline)
+    {
+        for(size_t i = 0; i < stories.size(); ++i)
+        {
+            if(archived[i])
+            { continue; }
+            chronolog::StoryStatistics statistics;
+            int ret = client.GetStoryStatistics(stories[i].chronicleName, stories[i].storyName
+                                                , ingest_result.firstEventTime, ingest_result.lastEventTime + 1
+                                                , statistics);
+            if(ret == chronolog::CL_SUCCESS && statistics.eventCount >= stories[i].eventCount)
+            {
+                archived[i] = true;
+                archived_count++;
+            }
+        }
+        if(archived_count < stories.size())
+        { std::this_thread::sleep_for(std::chrono::milliseconds(500)); }
+    }
+    if(archived_count < stories.size())
+    {
+        LOG_WARNING("[BenchmarkReport] {} of {} stories were not archived within {} secs"
+                    , stories.size() - archived_count, stories.size(), timeout_secs);
+        return -1;
+    }
+    return std::chrono::duration <double>(std::chrono::steady_clock::now() - ingest_end).count();
+}
+
+// replays the events written during the ingest phase from the archive
+inline ReplayResult measure_replay(chronolog::Client &client, std::vector <BenchmarkStory> const &stories
+                                   , IngestResult const &ingest_result)
+{
+    ReplayResult replay_result;
+    auto replay_start = std::chrono::steady_clock::now();
+    for(auto const &story: stories)
+    {
+        std::vector <chronolog::Event> replay_events;
+        int ret = client.ReplayStory(story.chronicleName, story.storyName, ingest_result.firstEventTime
+                                     , ingest_result.lastEventTime + 1, replay_events);
+        if(ret != chronolog::CL_SUCCESS)
+        {
+            LOG_WARNING("[BenchmarkReport] Replay of story {}.{} returned {}", story.chronicleName, story.storyName
+                        , chronolog::to_string_client(ret));
+            continue;
+        }
+        replay_result.eventCount += replay_events.size();
+        for(auto const &event: replay_events)
+        { replay_result.byteCount += event.log_record().size(); }
+    }
+    replay_result.elapsedSecs = std::chrono::duration <double>(std::chrono::steady_clock::now() - replay_start).count();
+    return replay_result;
+}
+
+// workload_json is the JSON object describing the workload of the run
+inline std::string report_json(std::string const &workload_json, IngestResult const &ingest_result
+                               , chronolog::HistogramSnapshot const &latency, double time_to_archive_secs
+                               , ReplayResult const &replay_result)
+{
+    std::ostringstream json;
+    json.precision(6);
+    json << std::fixed;
+    json << "{\n"
+         << "  \"workload\": " << workload_json << ",\n"
+         << "  \"ingest\": {\"events\": " << ingest_result.eventCount << ", \"failed_events\": "
+         << ingest_result.failedEventCount << ", \"bytes\": " << ingest_result.byteCount << ", \"elapsed_secs\": "
+         << ingest_result.elapsedSecs << ", \"events_per_sec\": "
+         << (ingest_result.elapsedSecs > 0 ? ingest_result.eventCount / ingest_result.elapsedSecs : 0)
+         << ", \"mb_per_sec\": "
+         << (ingest_result.elapsedSecs > 0 ? ingest_result.byteCount / ingest_result.elapsedSecs / 1048576 : 0) << "},\n"
+         << "  \"log_event_latency_usecs\": {\"p50\": " << latency.quantile(0.5) / 1000.0 << ", \"p99\": "
+         << latency.quantile(0.99) / 1000.0 << ", \"max\": " << latency.max / 1000.0 << "},\n"
+         << "  \"time_to_archive_secs\": " << time_to_archive_secs << ",\n"
+         << "  \"replay\": {\"events\": " << replay_result.eventCount << ", \"bytes\": " << replay_result.byteCount
+         << ", \"elapsed_secs\": " << replay_result.elapsedSecs << ", \"events_per_sec\": "
+         << (replay_result.elapsedSecs > 0 ? replay_result.eventCount / replay_result.elapsedSecs : 0)
+         << ", \"mb_per_sec\": "
+         << (replay_result.elapsedSecs > 0 ? replay_result.byteCount / replay_result.elapsedSecs / 1048576 : 0)
+         << "}\n"
+         << "}\n";
+    return json.str();
+}
+
+#endif
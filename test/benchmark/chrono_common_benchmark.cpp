@@ -0,0 +1,392 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <filesystem>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/tuple.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "chrono_monitor.h"
+#include "StoryChunk.h"
+#include "StoryChunkExtractionQueue.h"
+#include "StoryChunkWriter.h"
+#include "StoryPipeline.h"
+#include "HDF5ArchiveReadingAgent.h"
+#include "SharedEventRing.h"
+
+// Micro-benchmarks of the chrono_common structures on the Keeper->Grapher->Player path.
+// The chunk size argument is the number of events in the chunk.
+// The results are tracked across releases in the JSON format:
+//   chrono_common_benchmark --benchmark_out=chrono_common_benchmark.json --benchmark_out_format=json
+// (the run_chrono_common_benchmark target runs exactly that)
+
+namespace chl = chronolog;
+namespace fs = std::filesystem;
+
+#define BENCHMARK_RECORD_SIZE 128
+#define BENCHMARK_CHUNK_START 1000000000000ULL  // 1000 secs, aligned to the pipeline chunk granularity
+#define BENCHMARK_CHUNK_DURATION 1000000000ULL  // 1 sec
+
+namespace
+{
+
+std::string const benchmarkRecord(BENCHMARK_RECORD_SIZE, 'r');
+
+// event_count events evenly spread over [start_time, start_time + duration[,
+// the client ids are interleaved the way the events of several clients arrive at the keeper
+std::vector <chl::LogEvent> makeEvents(uint64_t event_count, uint64_t start_time, uint64_t duration
+                                       , bool shuffled = false)
+{
+    std::vector <chl::LogEvent> events;
+    events.reserve(event_count);
+    uint64_t step = std::max <uint64_t>(1, duration / event_count);
+    for(uint64_t i = 0; i < event_count; ++i)
+    {
+        events.emplace_back(1, start_time + i * step, static_cast<chl::ClientId>(i % 8)
+                            , static_cast<chl::chrono_index>(i), benchmarkRecord);
+    }
+    if(shuffled)
+    { std::shuffle(events.begin(), events.end(), std::mt19937_64(42)); }
+    return events;
+}
+
+chl::StoryChunk*makeChunk(std::vector <chl::LogEvent> const &events, uint64_t start_time = BENCHMARK_CHUNK_START
+                          , uint64_t end_time = BENCHMARK_CHUNK_START + BENCHMARK_CHUNK_DURATION)
+{
+    chl::StoryChunk*story_chunk = new chl::StoryChunk("chronicle", "story", 1, start_time, end_time);
+    for(auto const &event: events)
+    { story_chunk->insertEvent(event); }
+    return story_chunk;
+}
+
+void setChunkCounters(benchmark::State &state, uint64_t event_count)
+{
+    state.SetItemsProcessed(state.iterations() * event_count);
+    state.SetBytesProcessed(state.iterations() * event_count * BENCHMARK_RECORD_SIZE);
+}
+
+}
+
+/// StoryChunk _________________________________________________________________________________________________________
+
+static void BM_StoryChunkInsert(benchmark::State &state)
+{
+    std::vector <chl::LogEvent> events = makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION
+                                                    , state.range(1) != 0);
+    for(auto _: state)
+    {
+        chl::StoryChunk story_chunk("chronicle", "story", 1, BENCHMARK_CHUNK_START
+                                    , BENCHMARK_CHUNK_START + BENCHMARK_CHUNK_DURATION);
+        for(auto const &event: events)
+        { story_chunk.insertEvent(event); }
+        benchmark::DoNotOptimize(story_chunk.getEventCount());
+    }
+    setChunkCounters(state, events.size());
+}
+BENCHMARK(BM_StoryChunkInsert)->ArgNames({"events", "shuffled"})
+        ->ArgsProduct({benchmark::CreateRange(64, 16384, 16), {0, 1}});
+
+// merges the chunk of the other keeper whose events interleave with the events of this chunk
+static void BM_StoryChunkMerge(benchmark::State &state)
+{
+    std::vector <chl::LogEvent> events = makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION);
+    std::vector <chl::LogEvent> other_events = makeEvents(state.range(0), BENCHMARK_CHUNK_START + 1
+                                                          , BENCHMARK_CHUNK_DURATION);
+    for(auto _: state)
+    {
+        state.PauseTiming();
+        chl::StoryChunk*story_chunk = makeChunk(events);
+        chl::StoryChunk*other_chunk = makeChunk(other_events);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(story_chunk->mergeEvents(*other_chunk));
+
+        state.PauseTiming();
+        delete other_chunk;
+        delete story_chunk;
+        state.ResumeTiming();
+    }
+    setChunkCounters(state, other_events.size());
+}
+BENCHMARK(BM_StoryChunkMerge)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+// erases the first half of the chunk, the way the merged events leave the chunk they are merged from
+static void BM_StoryChunkErase(benchmark::State &state)
+{
+    std::vector <chl::LogEvent> events = makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION);
+    for(auto _: state)
+    {
+        state.PauseTiming();
+        chl::StoryChunk*story_chunk = makeChunk(events);
+        state.ResumeTiming();
+
+        story_chunk->eraseEvents(BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_START + BENCHMARK_CHUNK_DURATION / 2);
+        benchmark::DoNotOptimize(story_chunk->getEventCount());
+
+        state.PauseTiming();
+        delete story_chunk;
+        state.ResumeTiming();
+    }
+    setChunkCounters(state, events.size() / 2);
+}
+BENCHMARK(BM_StoryChunkErase)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_StoryChunkIterate(benchmark::State &state)
+{
+    chl::StoryChunk*story_chunk = makeChunk(
+            makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION));
+    for(auto _: state)
+    {
+        uint64_t record_bytes = 0;
+        for(auto const &event: *story_chunk)
+        { record_bytes += event.second.logRecord.size(); }
+        benchmark::DoNotOptimize(record_bytes);
+    }
+    setChunkCounters(state, story_chunk->getEventCount());
+    delete story_chunk;
+}
+BENCHMARK(BM_StoryChunkIterate)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+/// StoryPipeline::mergeEvents _________________________________________________________________________________________
+
+// the pipeline holds events in the first half of its head chunk, the merged chunk carries:
+// in-order events that follow the events already in the pipeline,
+// out-of-order events that interleave with them across all the pipeline chunks,
+// late events that precede the pipeline timeline and make it prepend chunks
+enum PipelineMergeCase
+{
+    MERGE_IN_ORDER = 0, MERGE_OUT_OF_ORDER = 1, MERGE_LATE = 2
+};
+
+static void BM_StoryPipelineMergeEvents(benchmark::State &state)
+{
+    uint64_t event_count = state.range(0);
+    std::vector <chl::LogEvent> pipeline_events = makeEvents(event_count, BENCHMARK_CHUNK_START
+                                                             , BENCHMARK_CHUNK_DURATION / 2);
+    uint64_t merged_start = BENCHMARK_CHUNK_START + BENCHMARK_CHUNK_DURATION / 2;
+    uint64_t merged_duration = BENCHMARK_CHUNK_DURATION / 2;
+    if(state.range(1) == MERGE_OUT_OF_ORDER)
+    {
+        merged_start = BENCHMARK_CHUNK_START + 1;
+        merged_duration = 3 * BENCHMARK_CHUNK_DURATION;
+    }
+    else if(state.range(1) == MERGE_LATE)
+    {
+        merged_start = BENCHMARK_CHUNK_START - 2 * BENCHMARK_CHUNK_DURATION;
+        merged_duration = 2 * BENCHMARK_CHUNK_DURATION;
+    }
+    std::vector <chl::LogEvent> merged_events = makeEvents(event_count, merged_start, merged_duration);
+
+    // the deleted pipelines stash their chunks on the queue, they are freed by the single shutDown after the loop
+    chl::StoryChunkExtractionQueue extraction_queue;
+    for(auto _: state)
+    {
+        state.PauseTiming();
+        chl::StoryPipeline*pipeline = new chl::StoryPipeline(extraction_queue, "chronicle", "story", 1
+                                                             , BENCHMARK_CHUNK_START, 1, 1);
+        chl::StoryChunk*pipeline_chunk = makeChunk(pipeline_events);
+        pipeline->mergeEvents(*pipeline_chunk);
+        chl::StoryChunk*merged_chunk = makeChunk(merged_events, merged_start, merged_start + merged_duration);
+        state.ResumeTiming();
+
+        pipeline->mergeEvents(*merged_chunk);
+
+        state.PauseTiming();
+        delete merged_chunk;
+        delete pipeline_chunk;
+        delete pipeline;
+        state.ResumeTiming();
+    }
+    extraction_queue.shutDown();
+    setChunkCounters(state, merged_events.size());
+}
+BENCHMARK(BM_StoryPipelineMergeEvents)->ArgNames({"events", "case"})
+        ->ArgsProduct({benchmark::CreateRange(64, 16384, 16), {MERGE_IN_ORDER, MERGE_OUT_OF_ORDER, MERGE_LATE}});
+
+/// StoryChunkExtractionQueue __________________________________________________________________________________________
+
+// every thread stashes a chunk and ejects one, the way the sequencing threads stash the decayed chunks
+// while the extraction threads eject them; the queue is left empty so it never deletes the static chunks
+static void BM_StoryChunkExtractionQueueContention(benchmark::State &state)
+{
+    static chl::StoryChunkExtractionQueue extraction_queue;
+    static chl::StoryChunk story_chunks[64];
+
+    chl::StoryChunk*story_chunk = &story_chunks[state.thread_index() % 64];
+    for(auto _: state)
+    {
+        extraction_queue.stashStoryChunk(story_chunk);
+        benchmark::DoNotOptimize(extraction_queue.ejectStoryChunk());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_StoryChunkExtractionQueueContention)->ThreadRange(1, 16)->UseRealTime();
+
+/// SharedEventRing ____________________________________________________________________________________________________
+
+// per event cost of the shared memory transport of the on-node clients, both ends in one thread;
+// the record size argument is the event payload size
+static void BM_SharedEventRingPushPop(benchmark::State &state)
+{
+    std::string shm_name = "/chronolog_benchmark_ring_" + std::to_string(getpid());
+    chl::SharedEventRing*producer = chl::SharedEventRing::CreateSharedEventRing(shm_name, 1024 * 1024);
+    chl::SharedEventRing*consumer = (producer != nullptr ? chl::SharedEventRing::AttachSharedEventRing(shm_name)
+                                                         : nullptr);
+    chl::SharedEventRing::unlink(shm_name);
+    if(consumer == nullptr)
+    {
+        delete producer;
+        state.SkipWithError("shared memory segment is not available");
+        return;
+    }
+
+    chl::LogEvent log_event(1, BENCHMARK_CHUNK_START, 1, 0, std::string(state.range(0), 'r'));
+    chl::LogEvent polled_event;
+    for(auto _: state)
+    {
+        producer->tryPush(log_event);
+        consumer->peek(polled_event);
+        consumer->pop();
+        benchmark::DoNotOptimize(polled_event.logRecord.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    delete consumer;
+    delete producer;
+}
+BENCHMARK(BM_SharedEventRingPushPop)->ArgName("record_size")->RangeMultiplier(8)->Range(8, 4096);
+
+/// cereal serialization _______________________________________________________________________________________________
+
+static void BM_StoryChunkSerialize(benchmark::State &state)
+{
+    chl::StoryChunk*story_chunk = makeChunk(
+            makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION));
+    for(auto _: state)
+    {
+        std::ostringstream oss(std::ios::binary);
+        {
+            cereal::BinaryOutputArchive oarchive(oss);
+            oarchive(*story_chunk);
+        }
+        benchmark::DoNotOptimize(oss.str().size());
+    }
+    setChunkCounters(state, story_chunk->getEventCount());
+    delete story_chunk;
+}
+BENCHMARK(BM_StoryChunkSerialize)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_StoryChunkDeserialize(benchmark::State &state)
+{
+    chl::StoryChunk*story_chunk = makeChunk(
+            makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION));
+    std::ostringstream oss(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive oarchive(oss);
+        oarchive(*story_chunk);
+    }
+    std::string serialized_chunk = oss.str();
+    for(auto _: state)
+    {
+        std::istringstream iss(serialized_chunk, std::ios::binary);
+        chl::StoryChunk deserialized_chunk;
+        {
+            cereal::BinaryInputArchive iarchive(iss);
+            iarchive(deserialized_chunk);
+        }
+        benchmark::DoNotOptimize(deserialized_chunk.getEventCount());
+    }
+    setChunkCounters(state, story_chunk->getEventCount());
+    state.counters["serialized_bytes"] = serialized_chunk.size();
+    delete story_chunk;
+}
+BENCHMARK(BM_StoryChunkDeserialize)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+/// HDF5 archive _______________________________________________________________________________________________________
+
+static fs::path benchmarkArchiveDir()
+{
+    fs::path archive_dir = fs::temp_directory_path() / "chrono_common_benchmark";
+    fs::create_directories(archive_dir);
+    return archive_dir;
+}
+
+static void BM_StoryChunkWriterWriteStoryChunk(benchmark::State &state)
+{
+    fs::path archive_dir = benchmarkArchiveDir();
+    chl::StoryChunk*story_chunk = makeChunk(
+            makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION));
+    chl::StoryChunkWriter chunk_writer(archive_dir.string(), "story_chunks", "data");
+    for(auto _: state)
+    {
+        if(chunk_writer.writeStoryChunk(*story_chunk) == 0)
+        {
+            state.SkipWithError("StoryChunkWriter failed to write the chunk");
+            break;
+        }
+
+        state.PauseTiming();
+        fs::remove_all(archive_dir);
+        fs::create_directories(archive_dir);
+        state.ResumeTiming();
+    }
+    setChunkCounters(state, story_chunk->getEventCount());
+    delete story_chunk;
+}
+BENCHMARK(BM_StoryChunkWriterWriteStoryChunk)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+static void BM_HDF5ArchiveReadingAgentReadStoryChunkFile(benchmark::State &state)
+{
+    fs::path archive_dir = benchmarkArchiveDir();
+    chl::StoryChunk*story_chunk = makeChunk(
+            makeEvents(state.range(0), BENCHMARK_CHUNK_START, BENCHMARK_CHUNK_DURATION));
+    {
+        chl::StoryChunkWriter chunk_writer(archive_dir.string(), "story_chunks", "data");
+        chunk_writer.writeStoryChunk(*story_chunk);
+    }
+    std::string file_name = (archive_dir / ("chronicle.story." + std::to_string(BENCHMARK_CHUNK_START / 1000000000) +
+                                            ".vlen.h5")).string();
+
+    chl::HDF5ArchiveReadingAgent reading_agent(archive_dir.string());
+    for(auto _: state)
+    {
+        std::list <chl::StoryChunk*> chunks;
+        reading_agent.readStoryChunkFile("chronicle", "story", BENCHMARK_CHUNK_START
+                                         , BENCHMARK_CHUNK_START + BENCHMARK_CHUNK_DURATION, chunks, file_name);
+        if(chunks.empty())
+        {
+            state.SkipWithError("HDF5ArchiveReadingAgent failed to read the chunk file");
+            break;
+        }
+
+        state.PauseTiming();
+        for(auto*chunk: chunks)
+        { delete chunk; }
+        state.ResumeTiming();
+    }
+    setChunkCounters(state, story_chunk->getEventCount());
+    fs::remove_all(archive_dir);
+    delete story_chunk;
+}
+BENCHMARK(BM_HDF5ArchiveReadingAgentReadStoryChunkFile)->ArgName("events")->RangeMultiplier(16)->Range(64, 16384);
+
+int main(int argc, char**argv)
+{
+    // the structures log their progress, only the errors are kept out of the benchmark numbers
+    std::string log_file = (fs::temp_directory_path() / "chrono_common_benchmark.log").string();
+    if(chl::chrono_monitor::initialize("file", log_file, spdlog::level::err, "ChronoCommonBenchmark") == 1)
+    { return 1; }
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+    { return 1; }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include <chronolog_client.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "chrono_monitor.h"
+#include "ClientConfiguration.h"
+#include "MetricsRegistry.h"
+#include "BenchmarkReport.h"
+
+// End-to-end throughput benchmark of the Visor->Keeper->Grapher->Player stack:
+// the writer threads log events into the benchmark stories for the configured duration,
+// then the benchmark waits for the events to be archived and replays the stories.
+// The results are reported as a single JSON object.
+// run_e2e_benchmark.sh deploys the stack on the local node and runs this driver against it.
+
+#define BENCHMARK_PAYLOAD_POOL_SIZE 1024
+
+struct BenchmarkConf
+{
+    std::string confFile;
+    std::string outputFile;
+    std::string chronicleName = "e2e_benchmark";
+    uint32_t storyCount = 4;
+    uint32_t clientCount = 4;           // writer threads
+    uint32_t durationSecs = 30;
+    uint64_t eventRate = 0;             // events/s per writer thread, 0 = as fast as possible
+    std::string sizeDistribution = "fixed"; // "fixed", "uniform" or "exponential"
+    uint64_t minEventSize = 64;
+    uint64_t avgEventSize = 256;
+    uint64_t maxEventSize = 4096;
+    uint32_t archiveTimeoutSecs = 600;
+};
+
+void usage(char**argv)
+{
+    std::cerr << "\nUsage: " << argv[0] << " [options]\n"
+                 "-c|--config <client_conf_file>\n"
+                 "-o|--output <json_output_file>\t\tdefault: stdout\n"
+                 "-t|--stories <story_count>\t\tdefault: 4\n"
+                 "-n|--clients <writer_thread_count>\tdefault: 4\n"
+                 "-d|--duration <secs>\t\t\tdefault: 30\n"
+                 "-r|--rate <events_per_sec_per_client>\tdefault: 0 (unthrottled)\n"
+                 "-z|--size_dist <fixed|uniform|exponential>\n"
+                 "-a|--min_event_size <bytes>\n"
+                 "-s|--ave_event_size <bytes>\n"
+                 "-b|--max_event_size <bytes>\n"
+                 "-w|--archive_timeout <secs>\t\tdefault: 600\n"
+                 "-u|--usage\n" << std::endl;
+}
+
+BenchmarkConf parse_benchmark_args(int argc, char**argv)
+{
+    BenchmarkConf conf;
+    struct option long_options[] = {{  "config"         , required_argument, nullptr, 'c'}
+                                    , {"output"         , required_argument, nullptr, 'o'}
+                                    , {"stories"        , required_argument, nullptr, 't'}
+                                    , {"clients"        , required_argument, nullptr, 'n'}
+                                    , {"duration"       , required_argument, nullptr, 'd'}
+                                    , {"rate"           , required_argument, nullptr, 'r'}
+                                    , {"size_dist"      , required_argument, nullptr, 'z'}
+                                    , {"min_event_size" , required_argument, nullptr, 'a'}
+                                    , {"ave_event_size" , required_argument, nullptr, 's'}
+                                    , {"max_event_size" , required_argument, nullptr, 'b'}
+                                    , {"archive_timeout", required_argument, nullptr, 'w'}
+                                    , {"usage"          , no_argument      , nullptr, 'u'}
+                                    , {nullptr          , 0                , nullptr, 0}};
+    int opt;
+    while((opt = getopt_long(argc, argv, "c:o:t:n:d:r:z:a:s:b:w:u", long_options, nullptr)) != -1)
+    {
+        switch(opt)
+        {
+            case 'c':
+                conf.confFile = optarg;
+                break;
+            case 'o':
+                conf.outputFile = optarg;
+                break;
+            case 't':
+                conf.storyCount = std::stoul(optarg);
+                break;
+            case 'n':
+                conf.clientCount = std::stoul(optarg);
+                break;
+            case 'd':
+                conf.durationSecs = std::stoul(optarg);
+                break;
+            case 'r':
+                conf.eventRate = std::stoull(optarg);
+                break;
+            case 'z':
+                conf.sizeDistribution = optarg;
+                break;
+            case 'a':
+                conf.minEventSize = std::stoull(optarg);
+                break;
+            case 's':
+                conf.avgEventSize = std::stoull(optarg);
+                break;
+            case 'b':
+                conf.maxEventSize = std::stoull(optarg);
+                break;
+            case 'w':
+                conf.archiveTimeoutSecs = std::stoul(optarg);
+                break;
+            case 'u':
+            default:
+                usage(argv);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if(conf.storyCount == 0 || conf.clientCount == 0 || conf.durationSecs == 0 || conf.minEventSize > conf.maxEventSize
+       || (conf.sizeDistribution != "fixed" && conf.sizeDistribution != "uniform" &&
+           conf.sizeDistribution != "exponential"))
+    {
+        usage(argv);
+        exit(EXIT_FAILURE);
+    }
+    return conf;
+}
+
+// the payloads are generated up front so that the generation isn't timed with log_event
+std::vector <std::string> generate_payloads(BenchmarkConf const &conf)
+{
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution <uint64_t> uniform_size(conf.minEventSize, conf.maxEventSize);
+    std::exponential_distribution <double> exponential_size(1.0 / (conf.avgEventSize > 0 ? conf.avgEventSize : 1));
+    std::uniform_int_distribution <int> printable('a', 'z');
+
+    std::vector <std::string> payloads;
+    for(int i = 0; i < BENCHMARK_PAYLOAD_POOL_SIZE; ++i)
+    {
+        uint64_t size = conf.avgEventSize;
+        if(conf.sizeDistribution == "uniform")
+        { size = uniform_size(generator); }
+        else if(conf.sizeDistribution == "exponential")
+        { size = static_cast<uint64_t>(exponential_size(generator)); }
+        size = std::max(conf.minEventSize, std::min(conf.maxEventSize, size));
+
+        std::string payload(size, 'x');
+        for(auto &c: payload)
+        { c = static_cast<char>(printable(generator)); }
+        payloads.push_back(payload);
+    }
+    return payloads;
+}
+
+void run_writer(uint32_t writer_index, BenchmarkConf const &conf, std::vector <chronolog::StoryHandle*> const &story_handles
+                , std::vector <std::string> const &payloads, std::chrono::steady_clock::time_point end_time
+                , chronolog::LatencyHistogram*log_event_latency, std::vector <std::atomic <uint64_t>> &story_event_counts
+                , IngestResult &writer_result)
+{
+    auto interval = (conf.eventRate == 0 ? std::chrono::nanoseconds(0) : std::chrono::nanoseconds(1000000000 / conf.eventRate));
+    auto next_event_time = std::chrono::steady_clock::now();
+    uint64_t event_index = writer_index;
+
+    while(std::chrono::steady_clock::now() < end_time)
+    {
+        if(conf.eventRate != 0)
+        {
+            std::this_thread::sleep_until(next_event_time);
+            next_event_time += interval;
+        }
+        uint32_t story_index = event_index % story_handles.size();
+        std::string const &payload = payloads[event_index % payloads.size()];
+        ++event_index;
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t event_time = story_handles[story_index]->log_event(payload);
+        log_event_latency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+
+        if(event_time == 0)
+        {
+            writer_result.failedEventCount++;
+            continue;
+        }
+        writer_result.eventCount++;
+        writer_result.byteCount += payload.size();
+        writer_result.addEventTime(event_time);
+        story_event_counts[story_index].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string workload_json(BenchmarkConf const &conf)
+{
+    std::ostringstream json;
+    json << "{\"stories\": " << conf.storyCount << ", \"clients\": " << conf.clientCount << ", \"duration_secs\": "
+         << conf.durationSecs << ", \"rate_per_client\": " << conf.eventRate << ", \"size_dist\": \""
+         << conf.sizeDistribution << "\", \"min_event_size\": " << conf.minEventSize << ", \"ave_event_size\": "
+         << conf.avgEventSize << ", \"max_event_size\": " << conf.maxEventSize << "}";
+    return json.str();
+}
+
+int main(int argc, char**argv)
+{
+    BenchmarkConf conf = parse_benchmark_args(argc, argv);
+
+    chronolog::ClientConfiguration confManager;
+    if(!conf.confFile.empty() && !confManager.load_from_file(conf.confFile))
+    {
+        std::cerr << "[E2EBenchmark] Failed to load configuration file '" << conf.confFile << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    int result = chronolog::chrono_monitor::initialize(confManager.LOG_CONF.LOGTYPE, confManager.LOG_CONF.LOGFILE
+                                                       , confManager.LOG_CONF.LOGLEVEL, confManager.LOG_CONF.LOGNAME
+                                                       , confManager.LOG_CONF.LOGFILESIZE, confManager.LOG_CONF.LOGFILENUM
+                                                       , confManager.LOG_CONF.FLUSHLEVEL);
+    if(result == 1)
+    {
+        return EXIT_FAILURE;
+    }
+
+    chronolog::Client client(confManager.PORTAL_CONF, confManager.QUERY_CONF);
+    int ret = client.Connect();
+    if(chronolog::CL_SUCCESS != ret)
+    {
+        std::cerr << "[E2EBenchmark] Failed to connect to ChronoVisor : " << chronolog::to_string_client(ret) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int flags = 1;
+    std::map <std::string, std::string> attrs;
+    client.CreateChronicle(conf.chronicleName, attrs, flags);
+
+    std::vector <std::string> story_names;
+    for(uint32_t i = 0; i < conf.storyCount; ++i)
+    { story_names.push_back("story_" + std::to_string(i)); }
+    std::vector <chronolog::StoryHandle*> story_handles;
+    for(auto const &acquire_result: client.AcquireStories(conf.chronicleName, story_names, attrs, flags))
+    {
+        if(acquire_result.first != chronolog::CL_SUCCESS || acquire_result.second == nullptr)
+        {
+            std::cerr << "[E2EBenchmark] Failed to acquire the benchmark stories : "
+                      << chronolog::to_string_client(acquire_result.first) << std::endl;
+            client.Disconnect();
+            return EXIT_FAILURE;
+        }
+        story_handles.push_back(acquire_result.second);
+    }
+
+    std::vector <std::string> payloads = generate_payloads(conf);
+    chronolog::LatencyHistogram*log_event_latency = chronolog::MetricsRegistry::getInstance().getHistogram(
+            "e2e_benchmark_log_event_nsecs");
+    std::vector <std::atomic <uint64_t>> story_event_counts(conf.storyCount);
+    std::vector <IngestResult> writer_results(conf.clientCount);
+
+    /// Ingest _________________________________________________________________________________________________________
+    LOG_INFO("[E2EBenchmark] Writing {} stories from {} clients for {} secs", conf.storyCount, conf.clientCount
+             , conf.durationSecs);
+    auto ingest_start = std::chrono::steady_clock::now();
+    auto ingest_deadline = ingest_start + std::chrono::seconds(conf.durationSecs);
+    std::vector <std::thread> writers;
+    for(uint32_t i = 0; i < conf.clientCount; ++i)
+    {
+        writers.emplace_back(run_writer, i, std::cref(conf), std::cref(story_handles), std::cref(payloads)
+                             , ingest_deadline, log_event_latency, std::ref(story_event_counts)
+                             , std::ref(writer_results[i]));
+    }
+    for(auto &writer: writers)
+    { writer.join(); }
+    auto ingest_end = std::chrono::steady_clock::now();
+
+    IngestResult ingest_result;
+    ingest_result.elapsedSecs = std::chrono::duration <double>(ingest_end - ingest_start).count();
+    for(auto const &writer_result: writer_results)
+    { ingest_result.merge(writer_result); }
+
+    // the stories are released so that the keepers extract the remaining chunks without waiting for new events
+    client.ReleaseStories(conf.chronicleName, story_names);
+
+    std::vector <BenchmarkStory> benchmark_stories;
+    for(uint32_t i = 0; i < conf.storyCount; ++i)
+    { benchmark_stories.push_back(BenchmarkStory{conf.chronicleName, story_names[i], story_event_counts[i].load()}); }
+
+    /// Time to archive ________________________________________________________________________________________________
+    double time_to_archive_secs = wait_for_archive(client, benchmark_stories, ingest_result, ingest_end
+                                                   , conf.archiveTimeoutSecs);
+
+    /// Replay _________________________________________________________________________________________________________
+    ReplayResult replay_result = measure_replay(client, benchmark_stories, ingest_result);
+
+    std::string json = report_json(workload_json(conf), ingest_result, log_event_latency->snapshot()
+                                   , time_to_archive_secs, replay_result);
+    if(conf.outputFile.empty())
+    { std::cout << json; }
+    else
+    {
+        std::ofstream output(conf.outputFile, std::ios::out | std::ios::trunc);
+        output << json;
+    }
+
+    for(auto const &story_name: story_names)
+    { client.DestroyStory(conf.chronicleName, story_name); }
+    client.DestroyChronicle(conf.chronicleName);
+    client.Disconnect();
+
+    return (ingest_result.eventCount > 0 && time_to_archive_secs >= 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,413 @@
+#include <chronolog_client.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "chrono_monitor.h"
+#include "ClientConfiguration.h"
+#include "MetricsRegistry.h"
+#include "WorkloadTrace.h"
+#include "BenchmarkReport.h"
+
+// Replays a workload captured by the client library (workload_capture_file in the client configuration)
+// against a deployed ChronoLog stack and reports the same metrics as chronolog_e2e_benchmark.
+// Every captured client thread is replayed by its own thread at the captured timing scaled by the speed factor;
+// the order of the calls on the same story is kept: the events of a story wait for its AcquireStory,
+// and the ReleaseStory waits for the events logged while the story was acquired.
+// The redacted payloads are replaced with generated bytes of the captured sizes.
+
+#define REPLAY_PAYLOAD_SEED 42
+
+struct ReplayConf
+{
+    std::string confFile;
+    std::string outputFile;
+    std::string traceFile;
+    double speed = 1;                   // 0 = as fast as possible
+    uint32_t archiveTimeoutSecs = 600;
+};
+
+// ReplayEpoch is the span between AcquireStory and ReleaseStory of one captured story
+struct ReplayEpoch
+{
+    uint32_t storyIndex = 0;
+    chronolog::StoryHandle*storyHandle = nullptr;
+    bool acquired = false;              // set once AcquireStory returned, storyHandle is nullptr if it failed
+    bool released = false;
+    uint64_t pendingEventCount = 0;     // events of the epoch not yet logged
+    size_t previousEpoch = 0;           // 1 + the released epoch of the same story the acquire waits for, 0 if none
+};
+
+struct ReplayCall
+{
+    chronolog::WorkloadRecord record;
+    size_t epochIndex = 0;
+};
+
+struct ReplayState
+{
+    std::vector <std::pair <std::string, std::string>> stories;    // chronicle and story name by story index
+    std::vector <ReplayEpoch> epochs;
+    std::vector <std::vector <ReplayCall>> threadCalls;             // calls by captured thread index
+    std::vector <std::atomic <uint64_t>> storyEventCounts;
+    std::mutex epochMutex;
+    std::condition_variable epochCondition;
+    std::string payloadPool;
+    uint64_t recordCount = 0;
+    uint64_t capturedDuration = 0;
+    bool hasPayloads = false;
+};
+
+void usage(char**argv)
+{
+    std::cerr << "\nUsage: " << argv[0] << " [options]\n"
+                 "-c|--config <client_conf_file>\n"
+                 "-f|--trace <workload_trace_file>\n"
+                 "-x|--speed <factor>\t\t\tdefault: 1 (captured timing), 0 = as fast as possible\n"
+                 "-o|--output <json_output_file>\t\tdefault: stdout\n"
+                 "-w|--archive_timeout <secs>\t\tdefault: 600\n"
+                 "-u|--usage\n" << std::endl;
+}
+
+ReplayConf parse_replay_args(int argc, char**argv)
+{
+    ReplayConf conf;
+    struct option long_options[] = {{  "config"         , required_argument, nullptr, 'c'}
+                                    , {"trace"          , required_argument, nullptr, 'f'}
+                                    , {"speed"          , required_argument, nullptr, 'x'}
+                                    , {"output"         , required_argument, nullptr, 'o'}
+                                    , {"archive_timeout", required_argument, nullptr, 'w'}
+                                    , {"usage"          , no_argument      , nullptr, 'u'}
+                                    , {nullptr          , 0                , nullptr, 0}};
+    int opt;
+    while((opt = getopt_long(argc, argv, "c:f:x:o:w:u", long_options, nullptr)) != -1)
+    {
+        switch(opt)
+        {
+            case 'c':
+                conf.confFile = optarg;
+                break;
+            case 'f':
+                conf.traceFile = optarg;
+                break;
+            case 'x':
+                conf.speed = std::stod(optarg);
+                break;
+            case 'o':
+                conf.outputFile = optarg;
+                break;
+            case 'w':
+                conf.archiveTimeoutSecs = std::stoul(optarg);
+                break;
+            case 'u':
+            default:
+                usage(argv);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if(conf.traceFile.empty() || conf.speed < 0)
+    {
+        usage(argv);
+        exit(EXIT_FAILURE);
+    }
+    return conf;
+}
+
+// reads the trace and splits the calls by the captured thread,
+// every call is tied to the epoch of its story at the point of the call in the captured order
+int load_trace(std::string const &trace_file, ReplayState &state)
+{
+    chronolog::WorkloadTraceReader*traceReader = chronolog::WorkloadTraceReader::CreateWorkloadTraceReader(trace_file);
+    if(traceReader == nullptr)
+    { return chronolog::CL_ERR_UNKNOWN; }
+    state.hasPayloads = traceReader->hasPayloads();
+
+    std::map <uint32_t, size_t> open_epochs;     // story index -> current epoch
+    std::map <uint32_t, size_t> closed_epochs;   // story index -> last released epoch
+    uint64_t max_payload_size = 0;
+    uint64_t skipped_count = 0;
+    chronolog::WorkloadRecord record;
+    while(traceReader->readRecord(record) == chronolog::CL_SUCCESS)
+    {
+        state.recordCount++;
+        state.capturedDuration = record.offset;
+
+        if(record.type == chronolog::WORKLOAD_ACQUIRE_STORY)
+        {
+            if(record.storyIndex >= state.stories.size())
+            { state.stories.resize(record.storyIndex + 1); }
+            state.stories[record.storyIndex] = std::pair <std::string, std::string>(record.chronicleName
+                                                                                   , record.storyName);
+            ReplayEpoch epoch;
+            epoch.storyIndex = record.storyIndex;
+            auto closed_iter = closed_epochs.find(record.storyIndex);
+            if(open_epochs.find(record.storyIndex) == open_epochs.end() && closed_iter != closed_epochs.end())
+            { epoch.previousEpoch = (*closed_iter).second + 1; }
+            state.epochs.push_back(epoch);
+            open_epochs[record.storyIndex] = state.epochs.size() - 1;
+        }
+        else
+        {
+            auto epoch_iter = open_epochs.find(record.storyIndex);
+            if(epoch_iter == open_epochs.end())
+            {
+                // the capture lost the acquire of this story, the call can't be replayed
+                skipped_count++;
+                continue;
+            }
+            if(record.type == chronolog::WORKLOAD_LOG_EVENT)
+            {
+                state.epochs[(*epoch_iter).second].pendingEventCount++;
+                max_payload_size = std::max(max_payload_size, record.payloadSize);
+            }
+        }
+
+        if(record.threadIndex >= state.threadCalls.size())
+        { state.threadCalls.resize(record.threadIndex + 1); }
+        ReplayCall call;
+        call.record = record;
+        call.epochIndex = open_epochs[record.storyIndex];
+        state.threadCalls[record.threadIndex].push_back(call);
+
+        if(record.type == chronolog::WORKLOAD_RELEASE_STORY)
+        {
+            closed_epochs[record.storyIndex] = call.epochIndex;
+            open_epochs.erase(record.storyIndex);
+        }
+    }
+    delete traceReader;
+
+    if(skipped_count > 0)
+    { LOG_WARNING("[WorkloadReplay] Skipped {} calls on the stories with no captured AcquireStory", skipped_count); }
+
+    std::vector <std::atomic <uint64_t>> story_event_counts(state.stories.size());
+    state.storyEventCounts.swap(story_event_counts);
+
+    if(!state.hasPayloads)
+    {
+        std::mt19937_64 generator(REPLAY_PAYLOAD_SEED);
+        std::uniform_int_distribution <int> printable('a', 'z');
+        state.payloadPool.resize(max_payload_size);
+        for(auto &c: state.payloadPool)
+        { c = static_cast<char>(printable(generator)); }
+    }
+    return chronolog::CL_SUCCESS;
+}
+
+void run_replay_thread(std::vector <ReplayCall> const &calls, chronolog::Client &client, ReplayState &state
+                       , double speed, std::chrono::steady_clock::time_point replay_start
+                       , chronolog::LatencyHistogram*log_event_latency, IngestResult &thread_result)
+{
+    std::map <std::string, std::string> attrs;
+    int flags = 1;
+    for(auto const &call: calls)
+    {
+        if(speed > 0)
+        {
+            std::this_thread::sleep_until(replay_start + std::chrono::nanoseconds(
+                    static_cast<uint64_t>(call.record.offset / speed)));
+        }
+        ReplayEpoch &epoch = state.epochs[call.epochIndex];
+        auto const &story = state.stories[call.record.storyIndex];
+
+        if(call.record.type == chronolog::WORKLOAD_ACQUIRE_STORY)
+        {
+            if(epoch.previousEpoch != 0)
+            {
+                // the story is acquired again after the release, the release has to go first
+                ReplayEpoch const &previous_epoch = state.epochs[epoch.previousEpoch - 1];
+                std::unique_lock <std::mutex> lock(state.epochMutex);
+                state.epochCondition.wait(lock, [&previous_epoch]()
+                { return previous_epoch.released; });
+            }
+            std::pair <int, chronolog::StoryHandle*> acquire_result = client.AcquireStory(story.first, story.second
+                                                                                         , attrs, flags);
+            if(acquire_result.first != chronolog::CL_SUCCESS)
+            {
+                LOG_WARNING("[WorkloadReplay] AcquireStory {}.{} returned {}", story.first, story.second
+                            , chronolog::to_string_client(acquire_result.first));
+            }
+            std::lock_guard <std::mutex> lock(state.epochMutex);
+            epoch.storyHandle = (acquire_result.first == chronolog::CL_SUCCESS ? acquire_result.second : nullptr);
+            epoch.acquired = true;
+            state.epochCondition.notify_all();
+        }
+        else if(call.record.type == chronolog::WORKLOAD_LOG_EVENT)
+        {
+            chronolog::StoryHandle*story_handle = nullptr;
+            {
+                std::unique_lock <std::mutex> lock(state.epochMutex);
+                state.epochCondition.wait(lock, [&epoch]()
+                { return epoch.acquired; });
+                story_handle = epoch.storyHandle;
+            }
+            if(story_handle == nullptr)
+            { thread_result.failedEventCount++; }
+            else
+            {
+                std::string payload = (state.hasPayloads ? call.record.payload : state.payloadPool.substr(
+                        0, call.record.payloadSize));
+                auto start = std::chrono::steady_clock::now();
+                uint64_t event_time = story_handle->log_event(payload);
+                log_event_latency->record(std::chrono::duration_cast <std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+                if(event_time == 0)
+                { thread_result.failedEventCount++; }
+                else
+                {
+                    thread_result.eventCount++;
+                    thread_result.byteCount += payload.size();
+                    thread_result.addEventTime(event_time);
+                    state.storyEventCounts[call.record.storyIndex].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            std::lock_guard <std::mutex> lock(state.epochMutex);
+            if(--epoch.pendingEventCount == 0)
+            { state.epochCondition.notify_all(); }
+        }
+        else
+        {
+            {
+                std::unique_lock <std::mutex> lock(state.epochMutex);
+                state.epochCondition.wait(lock, [&epoch]()
+                { return epoch.acquired && epoch.pendingEventCount == 0; });
+            }
+            if(epoch.storyHandle != nullptr)
+            { client.ReleaseStory(story.first, story.second); }
+            std::lock_guard <std::mutex> lock(state.epochMutex);
+            epoch.released = true;
+            state.epochCondition.notify_all();
+        }
+    }
+}
+
+std::string workload_json(ReplayConf const &conf, ReplayState const &state)
+{
+    std::ostringstream json;
+    json.precision(6);
+    json << std::fixed;
+    json << "{\"trace\": \"" << conf.traceFile << "\", \"speed\": " << conf.speed << ", \"records\": "
+         << state.recordCount << ", \"clients\": " << state.threadCalls.size() << ", \"stories\": "
+         << state.stories.size() << ", \"captured_duration_secs\": " << state.capturedDuration / 1000000000.0
+         << ", \"payloads\": \"" << (state.hasPayloads ? "full" : "redacted") << "\"}";
+    return json.str();
+}
+
+int main(int argc, char**argv)
+{
+    ReplayConf conf = parse_replay_args(argc, argv);
+
+    chronolog::ClientConfiguration confManager;
+    if(!conf.confFile.empty() && !confManager.load_from_file(conf.confFile))
+    {
+        std::cerr << "[WorkloadReplay] Failed to load configuration file '" << conf.confFile << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    int result = chronolog::chrono_monitor::initialize(confManager.LOG_CONF.LOGTYPE, confManager.LOG_CONF.LOGFILE
+                                                       , confManager.LOG_CONF.LOGLEVEL, confManager.LOG_CONF.LOGNAME
+                                                       , confManager.LOG_CONF.LOGFILESIZE, confManager.LOG_CONF.LOGFILENUM
+                                                       , confManager.LOG_CONF.FLUSHLEVEL);
+    if(result == 1)
+    {
+        return EXIT_FAILURE;
+    }
+
+    ReplayState state;
+    if(load_trace(conf.traceFile, state) != chronolog::CL_SUCCESS)
+    {
+        std::cerr << "[WorkloadReplay] Failed to load workload trace '" << conf.traceFile << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("[WorkloadReplay] Loaded {} records of {} stories from {} client threads", state.recordCount
+             , state.stories.size(), state.threadCalls.size());
+
+    chronolog::Client client(confManager.PORTAL_CONF, confManager.QUERY_CONF);
+    int ret = client.Connect();
+    if(chronolog::CL_SUCCESS != ret)
+    {
+        std::cerr << "[WorkloadReplay] Failed to connect to ChronoVisor : " << chronolog::to_string_client(ret)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // the chronicles of the captured stories may not exist on this deployment
+    int flags = 1;
+    std::map <std::string, std::string> attrs;
+    std::set <std::string> chronicle_names;
+    for(auto const &story: state.stories)
+    {
+        if(!story.first.empty() && chronicle_names.insert(story.first).second)
+        { client.CreateChronicle(story.first, attrs, flags); }
+    }
+
+    chronolog::LatencyHistogram*log_event_latency = chronolog::MetricsRegistry::getInstance().getHistogram(
+            "workload_replay_log_event_nsecs");
+    std::vector <IngestResult> thread_results(state.threadCalls.size());
+
+    /// Ingest _________________________________________________________________________________________________________
+    auto ingest_start = std::chrono::steady_clock::now();
+    std::vector <std::thread> replay_threads;
+    for(size_t i = 0; i < state.threadCalls.size(); ++i)
+    {
+        replay_threads.emplace_back(run_replay_thread, std::cref(state.threadCalls[i]), std::ref(client)
+                                    , std::ref(state), conf.speed, ingest_start, log_event_latency
+                                    , std::ref(thread_results[i]));
+    }
+    for(auto &replay_thread: replay_threads)
+    { replay_thread.join(); }
+    auto ingest_end = std::chrono::steady_clock::now();
+
+    IngestResult ingest_result;
+    ingest_result.elapsedSecs = std::chrono::duration <double>(ingest_end - ingest_start).count();
+    for(auto const &thread_result: thread_results)
+    { ingest_result.merge(thread_result); }
+
+    // the stories still acquired at the end of the capture are released so that the keepers extract them
+    for(auto const &epoch: state.epochs)
+    {
+        if(!epoch.released && epoch.storyHandle != nullptr)
+        {
+            client.ReleaseStory(state.stories[epoch.storyIndex].first, state.stories[epoch.storyIndex].second);
+        }
+    }
+
+    std::vector <BenchmarkStory> replayed_stories;
+    for(size_t i = 0; i < state.stories.size(); ++i)
+    {
+        if(state.storyEventCounts[i].load() > 0)
+        {
+            replayed_stories.push_back(BenchmarkStory{state.stories[i].first, state.stories[i].second
+                                                      , state.storyEventCounts[i].load()});
+        }
+    }
+
+    /// Time to archive ________________________________________________________________________________________________
+    double time_to_archive_secs = wait_for_archive(client, replayed_stories, ingest_result, ingest_end
+                                                   , conf.archiveTimeoutSecs);
+
+    /// Replay _________________________________________________________________________________________________________
+    ReplayResult replay_result = measure_replay(client, replayed_stories, ingest_result);
+
+    std::string json = report_json(workload_json(conf, state), ingest_result, log_event_latency->snapshot()
+                                   , time_to_archive_secs, replay_result);
+    if(conf.outputFile.empty())
+    { std::cout << json; }
+    else
+    {
+        std::ofstream output(conf.outputFile, std::ios::out | std::ios::trunc);
+        output << json;
+    }
+
+    client.Disconnect();
+
+    return (ingest_result.eventCount > 0 && time_to_archive_secs >= 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
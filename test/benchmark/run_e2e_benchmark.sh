@@ -0,0 +1,293 @@
+#!/bin/bash
+
+# Deploys ChronoVisor, the ChronoKeepers, the ChronoGrapher and the ChronoPlayer on the local node,
+# runs chronolog_e2e_benchmark against them and stops the services.
+# With --replay the captured client workload is replayed by chronolog_workload_replay instead.
+# With --placement the Keepers, the Grapher and the Player pin their xstreams to the cores of the CorePlacement
+# JSON object in the given file; --compare-placement runs the benchmark unpinned and then pinned
+# and writes e2e_benchmark_unpinned.json and e2e_benchmark_pinned.json.
+# The benchmark JSON report is written to <work_dir>/e2e_benchmark.json,
+# the service configurations and logs are kept in the work directory.
+#
+# The services address each other as <protocol>://<ip>:<port>,
+# so the protocol has to be an ip:port transport such as ofi+sockets or ofi+tcp.
+
+# Variables ____________________________________________________________________________________________________________
+ERR='\033[7;37m\033[41m'
+INFO='\033[7;49m\033[92m'
+DEBUG='\033[0;33m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+# Default values
+BUILD_DIR="$(realpath "${SCRIPT_DIR}/../..")"
+WORK_DIR="/tmp/chronolog_e2e_benchmark"
+NUM_KEEPERS=1
+PROTOCOL="ofi+sockets"
+# short chunks and acceptance windows so that the events reach the archive within seconds of the ingest
+KEEPER_CHUNK_SECS=2
+KEEPER_ACCEPTANCE_SECS=2
+GRAPHER_CHUNK_SECS=5
+GRAPHER_ACCEPTANCE_SECS=5
+INACTIVE_STORY_SECS=5
+STOP_TIMEOUT=60
+BENCHMARK_ARGS=()
+REPLAY_TRACE=""
+PLACEMENT_FILE=""
+COMPARE_PLACEMENT=false
+
+# Helper Methods _______________________________________________________________________________________________________
+usage() {
+    echo "Usage: $0 [options] [-- <chronolog_e2e_benchmark | chronolog_workload_replay options>]"
+    echo "  -b|--build-dir <path>     ChronoLog build directory (default: ${BUILD_DIR})"
+    echo "  -w|--work-dir <path>      Directory for the configurations, logs and story files (default: ${WORK_DIR})"
+    echo "  -k|--keepers <count>      Number of ChronoKeepers (default: ${NUM_KEEPERS})"
+    echo "  -p|--protocol <protocol>  Transport of all the services (default: ${PROTOCOL})"
+    echo "  -r|--replay <trace_file>  Replay the captured client workload instead of the synthetic one"
+    echo "  -P|--placement <file>     CorePlacement JSON object of the Keeper, Grapher and Player xstreams,"
+    echo "                            e.g. {\"rpc_cores\": \"0-1\", \"sequencing_cores\": \"2-3\", \"extraction_cores\": \"4\", \"io_cores\": \"5\"}"
+    echo "  -C|--compare-placement    Run unpinned and then with the --placement cores and compare the throughput"
+    echo "  -h|--help                 Print this help"
+    echo ""
+    echo "Example:"
+    echo "  $0 --keepers 2 -- --clients 8 --stories 16 --duration 60 --size_dist exponential --ave_event_size 512"
+    exit 1
+}
+
+start_service() {
+    local bin="$1"
+    local args="$2"
+    local launch_log="$3"
+    echo -e "${DEBUG}Launching $bin $args ...${NC}"
+    nohup ${bin} ${args} > ${WORK_DIR}/logs/${launch_log} 2>&1 &
+    SERVICE_PIDS+=($!)
+}
+
+stop_services() {
+    # the services are stopped in the reverse launch order, the keepers drain into the grapher before it goes away
+    local pids=("${SERVICE_PIDS[@]}")
+    for (( i=${#pids[@]}-1; i>=0; i-- )); do
+        local pid=${pids[$i]}
+        kill -TERM ${pid} 2>/dev/null || continue
+        local start_time=$(date +%s)
+        while kill -0 ${pid} 2>/dev/null; do
+            if (( $(date +%s) - start_time >= STOP_TIMEOUT )); then
+                echo -e "${DEBUG}Timeout reached while stopping process ${pid}. Forcing termination.${NC}"
+                kill -9 ${pid} 2>/dev/null
+                break
+            fi
+            sleep 1
+        done
+    done
+    SERVICE_PIDS=()
+}
+
+check_dependencies() {
+    for dep in jq nohup; do
+        if ! command -v ${dep} &> /dev/null; then
+            echo -e "${ERR}Dependency ${dep} is not installed. Please install it and try again.${NC}"
+            exit 1
+        fi
+    done
+    for bin in ${VISOR_BIN} ${KEEPER_BIN} ${GRAPHER_BIN} ${PLAYER_BIN} ${BENCHMARK_BIN}; do
+        if [[ ! -x ${bin} ]]; then
+            echo -e "${ERR}${bin} not found, build ChronoLog first.${NC}"
+            exit 1
+        fi
+    done
+}
+
+generate_config_files() {
+    local placement_file="$1"
+    local conf_dir="${WORK_DIR}/conf"
+    local monitor_dir="${WORK_DIR}/logs"
+    local output_dir="${WORK_DIR}/output"
+    mkdir -p "${conf_dir}" "${monitor_dir}" "${output_dir}" "${WORK_DIR}/metadata"
+
+    # all the services run the same transport, the chunk windows are shortened for the benchmark
+    local common_conf="${conf_dir}/common_conf.json"
+    jq --arg protocol "${PROTOCOL}" \
+        --arg metadata_dir "${WORK_DIR}/metadata" \
+        --argjson keeper_chunk_secs ${KEEPER_CHUNK_SECS} \
+        --argjson keeper_acceptance_secs ${KEEPER_ACCEPTANCE_SECS} \
+        --argjson grapher_chunk_secs ${GRAPHER_CHUNK_SECS} \
+        --argjson grapher_acceptance_secs ${GRAPHER_ACCEPTANCE_SECS} \
+        --argjson inactive_story_secs ${INACTIVE_STORY_SECS} \
+       '(.. | objects | select(has("protocol_conf")) | .protocol_conf) = $protocol |
+        .chrono_visor.metadata_store_dir = $metadata_dir |
+        .chrono_keeper.DataStoreInternals.story_chunk_duration_secs = $keeper_chunk_secs |
+        .chrono_keeper.DataStoreInternals.acceptance_window_secs = $keeper_acceptance_secs |
+        .chrono_keeper.DataStoreInternals.inactive_story_delay_secs = $inactive_story_secs |
+        .chrono_grapher.DataStoreInternals.story_chunk_duration_secs = $grapher_chunk_secs |
+        .chrono_grapher.DataStoreInternals.acceptance_window_secs = $grapher_acceptance_secs |
+        .chrono_grapher.DataStoreInternals.inactive_story_delay_secs = $inactive_story_secs' \
+        "${DEFAULT_CONF}" > "${common_conf}" || exit 1
+
+    # the same core placement for all the recording processes of the node
+    if [[ -n "${placement_file}" ]]; then
+        jq --slurpfile placement "${placement_file}" \
+           '.chrono_keeper.CorePlacement = $placement[0] |
+            .chrono_grapher.CorePlacement = $placement[0] |
+            .chrono_player.CorePlacement = $placement[0]' "${common_conf}" > "${common_conf}.tmp" || exit 1
+        mv "${common_conf}.tmp" "${common_conf}"
+    fi
+
+    jq --arg monitor_file "${monitor_dir}/chrono_visor.log" \
+       '.chrono_visor.Monitoring.monitor.file = $monitor_file' "${common_conf}" > "${conf_dir}/visor_conf.json"
+
+    jq --arg monitor_file "${monitor_dir}/chrono_grapher.log" \
+        --arg output_dir "${output_dir}/" \
+       '.chrono_grapher.Monitoring.monitor.file = $monitor_file |
+        .chrono_grapher.Extractors.story_files_dir = $output_dir' "${common_conf}" > "${conf_dir}/grapher_conf.json"
+
+    jq --arg monitor_file "${monitor_dir}/chrono_player.log" \
+        --arg output_dir "${output_dir}/" \
+       '.chrono_player.Monitoring.monitor.file = $monitor_file |
+        .chrono_player.ArchiveReaders.story_files_dir = $output_dir' "${common_conf}" > "${conf_dir}/player_conf.json"
+
+    # the keepers of the single recording group differ in the ports of their own services
+    local base_port_keeper_record=$(jq -r '.chrono_keeper.KeeperRecordingService.rpc.service_base_port' "${common_conf}")
+    local base_port_keeper_datastore=$(jq -r '.chrono_keeper.KeeperDataStoreAdminService.rpc.service_base_port' "${common_conf}")
+    for (( i=1; i<=NUM_KEEPERS; i++ )); do
+        jq --arg monitor_file "${monitor_dir}/chrono_keeper_${i}.log" \
+            --arg output_dir "${output_dir}/" \
+            --argjson port_record $((base_port_keeper_record + i - 1)) \
+            --argjson port_datastore $((base_port_keeper_datastore + i - 1)) \
+           '.chrono_keeper.KeeperRecordingService.rpc.service_base_port = $port_record |
+            .chrono_keeper.KeeperDataStoreAdminService.rpc.service_base_port = $port_datastore |
+            .chrono_keeper.Extractors.story_files_dir = $output_dir |
+            .chrono_keeper.Monitoring.monitor.file = $monitor_file' "${common_conf}" > "${conf_dir}/keeper_conf_${i}.json"
+    done
+
+    jq --arg protocol "${PROTOCOL}" \
+        --arg monitor_file "${monitor_dir}/chrono_client.log" \
+       '(.. | objects | select(has("protocol_conf")) | .protocol_conf) = $protocol |
+        .chrono_client.Monitoring.monitor.file = $monitor_file' "${DEFAULT_CLIENT_CONF}" > "${conf_dir}/client_conf.json"
+}
+
+# Main _________________________________________________________________________________________________________________
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        -b|--build-dir)
+            BUILD_DIR="$(realpath "$2")"
+            shift 2 ;;
+        -w|--work-dir)
+            WORK_DIR="$2"
+            shift 2 ;;
+        -k|--keepers)
+            NUM_KEEPERS="$2"
+            shift 2 ;;
+        -p|--protocol)
+            PROTOCOL="$2"
+            shift 2 ;;
+        -r|--replay)
+            REPLAY_TRACE="$(realpath "$2")"
+            shift 2 ;;
+        -P|--placement)
+            PLACEMENT_FILE="$(realpath "$2")"
+            shift 2 ;;
+        -C|--compare-placement)
+            COMPARE_PLACEMENT=true
+            shift ;;
+        -h|--help)
+            usage ;;
+        --)
+            shift
+            BENCHMARK_ARGS=("$@")
+            break ;;
+        *)
+            echo -e "${ERR}Unknown option: $1${NC}"
+            usage ;;
+    esac
+done
+
+if (( NUM_KEEPERS <= 0 )); then
+    echo -e "${ERR}Number of keepers must be greater than 0.${NC}"
+    exit 1
+fi
+if [[ -n "${PLACEMENT_FILE}" ]] && ! jq -e 'type == "object"' "${PLACEMENT_FILE}" > /dev/null 2>&1; then
+    echo -e "${ERR}${PLACEMENT_FILE} is not a CorePlacement JSON object.${NC}"
+    exit 1
+fi
+if [[ "${COMPARE_PLACEMENT}" == true && -z "${PLACEMENT_FILE}" ]]; then
+    echo -e "${ERR}--compare-placement needs the --placement cores.${NC}"
+    exit 1
+fi
+if [[ "${PROTOCOL}" == na+sm* ]]; then
+    echo -e "${ERR}${PROTOCOL} is not addressed by ip:port, use ofi+sockets or ofi+tcp.${NC}"
+    exit 1
+fi
+
+VISOR_BIN="${BUILD_DIR}/ChronoVisor/chronovisor_server"
+KEEPER_BIN="${BUILD_DIR}/ChronoKeeper/chrono_keeper"
+GRAPHER_BIN="${BUILD_DIR}/ChronoGrapher/chrono_grapher"
+PLAYER_BIN="${BUILD_DIR}/ChronoPlayer/chrono_player"
+BENCHMARK_BIN="${BUILD_DIR}/test/benchmark/chronolog_e2e_benchmark"
+if [[ -n "${REPLAY_TRACE}" ]]; then
+    BENCHMARK_BIN="${BUILD_DIR}/test/benchmark/chronolog_workload_replay"
+    BENCHMARK_ARGS=(--trace "${REPLAY_TRACE}" "${BENCHMARK_ARGS[@]}")
+fi
+DEFAULT_CONF="${BUILD_DIR}/test/benchmark/default_conf.json"
+DEFAULT_CLIENT_CONF="${BUILD_DIR}/test/benchmark/default_client_conf.json"
+SERVICE_PIDS=()
+
+# deploys the services with the given core placement file (none if empty), runs the benchmark into the report file
+run_benchmark() {
+    local report_file="$1"
+    local placement_file="$2"
+    rm -rf "${WORK_DIR}/conf" "${WORK_DIR}/logs" "${WORK_DIR}/output" "${WORK_DIR}/metadata" "${report_file}"
+    generate_config_files "${placement_file}"
+    trap stop_services EXIT
+
+    echo -e "${INFO}Deploying ChronoLog with ${NUM_KEEPERS} keeper(s) over ${PROTOCOL} in ${WORK_DIR}" \
+            "${placement_file:+with the core placement ${placement_file}} ...${NC}"
+    start_service ${VISOR_BIN} "--config ${WORK_DIR}/conf/visor_conf.json" "visor.launch.log"
+    sleep 2
+    start_service ${GRAPHER_BIN} "--config ${WORK_DIR}/conf/grapher_conf.json" "grapher.launch.log"
+    start_service ${PLAYER_BIN} "--config ${WORK_DIR}/conf/player_conf.json" "player.launch.log"
+    sleep 2
+    for (( i=1; i<=NUM_KEEPERS; i++ )); do
+        start_service ${KEEPER_BIN} "--config ${WORK_DIR}/conf/keeper_conf_${i}.json" "keeper_${i}.launch.log"
+    done
+    sleep 5
+
+    echo -e "${INFO}Running ${BENCHMARK_BIN} ${BENCHMARK_ARGS[*]} ...${NC}"
+    ${BENCHMARK_BIN} --config ${WORK_DIR}/conf/client_conf.json --output ${report_file} "${BENCHMARK_ARGS[@]}"
+    local status=$?
+
+    stop_services
+    trap - EXIT
+    if (( status != 0 )); then
+        echo -e "${ERR}Benchmark failed, see the logs in ${WORK_DIR}/logs${NC}"
+    fi
+    return ${status}
+}
+
+check_dependencies
+
+if [[ "${COMPARE_PLACEMENT}" == true ]]; then
+    run_benchmark "${WORK_DIR}/e2e_benchmark_unpinned.json" ""
+    unpinned_status=$?
+    run_benchmark "${WORK_DIR}/e2e_benchmark_pinned.json" "${PLACEMENT_FILE}"
+    pinned_status=$?
+    if (( unpinned_status != 0 || pinned_status != 0 )); then
+        exit 1
+    fi
+    printf "%-10s %16s %12s %20s %22s\n" "placement" "events_per_sec" "mb_per_sec" "log_event_p99_usecs" \
+           "time_to_archive_secs"
+    for placement in unpinned pinned; do
+        jq -r --arg placement ${placement} \
+           '[$placement, .ingest.events_per_sec, .ingest.mb_per_sec, .log_event_latency_usecs.p99,
+             .time_to_archive_secs] | @tsv' "${WORK_DIR}/e2e_benchmark_${placement}.json" |
+        awk -F'\t' '{ printf "%-10s %16s %12s %20s %22s\n", $1, $2, $3, $4, $5 }'
+    done
+    exit 0
+fi
+
+run_benchmark "${WORK_DIR}/e2e_benchmark.json" "${PLACEMENT_FILE}"
+benchmark_status=$?
+if [[ -f ${WORK_DIR}/e2e_benchmark.json ]]; then
+    cat ${WORK_DIR}/e2e_benchmark.json
+fi
+exit ${benchmark_status}
@@ -0,0 +1,160 @@
+#include <chronolog_client.h>
+#include <chrono>
+#include <map>
+#include <cmd_arg_parse.h>
+#include "chrono_monitor.h"
+#include "ClientConfiguration.h"
+
+// Compares the server-side aggregation of a story segment (AggregateStory)
+// against the full replay of the same segment (ReplayStory) with the client-side aggregation
+// usage: client_lib_aggregation_benchmark -c <client_conf> [chronicle story start_time end_time bucket_width_ns]
+
+struct BenchmarkResult
+{
+    int returnCode = chronolog::CL_ERR_UNKNOWN;
+    double elapsedSecs = 0;
+    uint64_t eventCount = 0;
+    uint64_t transferredBytes = 0;
+    size_t bucketCount = 0;
+};
+
+BenchmarkResult run_full_replay(chronolog::Client &client, std::string const &chronicle, std::string const &story
+                                , uint64_t start_time, uint64_t end_time, uint64_t bucket_width)
+{
+    BenchmarkResult result;
+    std::vector <chronolog::Event> replay_events;
+
+    auto start = std::chrono::steady_clock::now();
+    result.returnCode = client.ReplayStory(chronicle, story, start_time, end_time, replay_events);
+
+    // client side equivalent of the count per bucket aggregation
+    std::map <uint64_t, uint64_t> bucket_counts;
+    for(auto const &event: replay_events)
+    {
+        bucket_counts[start_time + ((event.time() - start_time) / bucket_width) * bucket_width]++;
+        result.transferredBytes += sizeof(uint64_t) + sizeof(chronolog::ClientId) + sizeof(uint32_t) + event.log_record().size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.elapsedSecs = std::chrono::duration <double>(end - start).count();
+    result.eventCount = replay_events.size();
+    result.bucketCount = bucket_counts.size();
+    return result;
+}
+
+BenchmarkResult run_aggregation(chronolog::Client &client, std::string const &chronicle, std::string const &story
+                                , uint64_t start_time, uint64_t end_time, uint64_t bucket_width)
+{
+    BenchmarkResult result;
+    std::vector <chronolog::AggregationBucket> buckets;
+    chronolog::AggregationQuery query;
+    query.bucketWidth = bucket_width;
+    query.numericStats = false;
+
+    auto start = std::chrono::steady_clock::now();
+    result.returnCode = client.AggregateStory(chronicle, story, start_time, end_time, query, buckets);
+    auto end = std::chrono::steady_clock::now();
+
+    result.elapsedSecs = std::chrono::duration <double>(end - start).count();
+    for(auto const &bucket: buckets)
+    {
+        result.eventCount += bucket.eventCount;
+        result.transferredBytes += sizeof(chronolog::AggregationBucket) + bucket.quantileValues.size() * sizeof(double);
+    }
+    result.bucketCount = buckets.size();
+    return result;
+}
+
+void report(std::string const &name, BenchmarkResult const &result)
+{
+    LOG_INFO("[ClientLibAggregationBenchmark] {} : ret={} time={:.3f}s events={} buckets={} transferred_bytes={}"
+             , name, chronolog::to_string_client(result.returnCode), result.elapsedSecs, result.eventCount
+             , result.bucketCount, result.transferredBytes);
+    std::cout << "[ClientLibAggregationBenchmark] " << name << " : ret=" << chronolog::to_string_client(result.returnCode)
+              << " time=" << result.elapsedSecs << "s events=" << result.eventCount << " buckets=" << result.bucketCount
+              << " transferred_bytes=" << result.transferredBytes << std::endl;
+}
+
+int main(int argc, char**argv)
+{
+    // Load configuration
+    std::string conf_file_path = parse_conf_path_arg(argc, argv);
+    chronolog::ClientConfiguration confManager;
+    if(!conf_file_path.empty())
+    {
+        if(!confManager.load_from_file(conf_file_path))
+        {
+            std::cerr << "[ClientLibAggregationBenchmark] Failed to load configuration file '" << conf_file_path
+                      << "'. Using default values instead." << std::endl;
+        }
+    }
+    confManager.log_configuration(std::cout);
+
+    int result = chronolog::chrono_monitor::initialize(confManager.LOG_CONF.LOGTYPE, confManager.LOG_CONF.LOGFILE
+                                                       , confManager.LOG_CONF.LOGLEVEL, confManager.LOG_CONF.LOGNAME
+                                                       , confManager.LOG_CONF.LOGFILESIZE, confManager.LOG_CONF.LOGFILENUM
+                                                       , confManager.LOG_CONF.FLUSHLEVEL);
+    if(result == 1)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // positional arguments follow the configuration option
+    std::string chronicle_name = (optind < argc ? argv[optind] : "CHRONICLE");
+    std::string story_name = (optind + 1 < argc ? argv[optind + 1] : "STORY");
+    uint64_t start_time = (optind + 2 < argc ? std::stoull(argv[optind + 2]) : 1746486900000000000);
+    uint64_t end_time = (optind + 3 < argc ? std::stoull(argv[optind + 3]) : 1746486930000000000);
+    uint64_t bucket_width = (optind + 4 < argc ? std::stoull(argv[optind + 4]) : 1000000000);
+
+    chronolog::Client client(confManager.PORTAL_CONF, confManager.QUERY_CONF);
+
+    int ret = client.Connect();
+    if(chronolog::CL_SUCCESS != ret)
+    {
+        LOG_ERROR("[ClientLibAggregationBenchmark] Failed to connect to ChronoVisor");
+        return -1;
+    }
+
+    int flags = 1;
+    std::map <std::string, std::string> attrs;
+    auto acquire_ret = client.AcquireStory(chronicle_name, story_name, attrs, flags);
+    if(acquire_ret.first != chronolog::CL_SUCCESS)
+    {
+        LOG_ERROR("[ClientLibAggregationBenchmark] Failed to acquire story {}-{} : {}", chronicle_name, story_name
+                  , chronolog::to_string_client(acquire_ret.first));
+        client.Disconnect();
+        return -1;
+    }
+
+    LOG_INFO("[ClientLibAggregationBenchmark] Story {}-{} range {}-{} bucket width {}", chronicle_name, story_name
+             , start_time, end_time, bucket_width);
+
+    BenchmarkResult replay_result = run_full_replay(client, chronicle_name, story_name, start_time, end_time, bucket_width);
+    report("full replay + client aggregation", replay_result);
+
+    BenchmarkResult aggregation_result = run_aggregation(client, chronicle_name, story_name, start_time, end_time, bucket_width);
+    report("server side aggregation", aggregation_result);
+
+    // the comparison is only meaningful if both paths saw the same events,
+    // the check is explicit so that it is not compiled out of the release builds
+    int exit_code = 0;
+    if(replay_result.returnCode == chronolog::CL_SUCCESS && aggregation_result.returnCode == chronolog::CL_SUCCESS
+       && replay_result.eventCount != aggregation_result.eventCount)
+    {
+        LOG_ERROR("[ClientLibAggregationBenchmark] Event count mismatch: full replay {} events, server side aggregation {} events"
+                  , replay_result.eventCount, aggregation_result.eventCount);
+        exit_code = -1;
+    }
+    else if(replay_result.returnCode == chronolog::CL_SUCCESS && aggregation_result.returnCode == chronolog::CL_SUCCESS)
+    {
+        std::cout << "[ClientLibAggregationBenchmark] speedup=" << replay_result.elapsedSecs / aggregation_result.elapsedSecs
+                  << " transfer_reduction=" << (aggregation_result.transferredBytes == 0 ? 0.0 :
+                                                  double(replay_result.transferredBytes) / aggregation_result.transferredBytes)
+                  << std::endl;
+    }
+
+    client.ReleaseStory(chronicle_name, story_name);
+    client.Disconnect();
+
+    return exit_code;
+}
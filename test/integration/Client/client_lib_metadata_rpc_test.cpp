@@ -1,6 +1,9 @@
 #include <chrono>
 #include <cassert>
+#include <cstdio>
+#include <iostream>
 #include <map>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -15,6 +18,151 @@
 #define CHRONICLE_NAME_LEN 32
 #define STORY_NAME_LEN 32
 
+// metadata stress benchmark: the concurrent client counts double from 1 up to METADATA_STRESS_MAX_CLIENTS
+#define METADATA_STRESS_MAX_CLIENTS 1024
+#define METADATA_STRESS_ROUNDS_PER_CLIENT 16
+// bulk story setup: the stories acquired one by one and then with AcquireStories
+#define BULK_SETUP_STORY_COUNT 1000
+
+// one stress client: works on its own chronicle and story and reads the attribute of the chronicle shared by all,
+// returns the number of metadata operations issued
+uint64_t metadata_stress_client(chronolog::Client &client, std::string const &shared_chronicle_name)
+{
+    std::string chronicle_name(gen_random(CHRONICLE_NAME_LEN));
+    std::string story_name(gen_random(STORY_NAME_LEN));
+    std::map <std::string, std::string> chronicle_attrs;
+    chronicle_attrs.emplace("Priority", "High");
+    std::map <std::string, std::string> story_attrs;
+    int flags = 1;
+    uint64_t op_count = 0;
+
+    int ret = client.CreateChronicle(chronicle_name, chronicle_attrs, flags);
+    assert(ret == chronolog::CL_SUCCESS);
+    op_count++;
+
+    for(int round = 0; round < METADATA_STRESS_ROUNDS_PER_CLIENT; round++)
+    {
+        flags = 2;
+        ret = client.AcquireStory(chronicle_name, story_name, story_attrs, flags).first;
+        assert(ret == chronolog::CL_SUCCESS || ret == chronolog::CL_ERR_NO_KEEPERS);
+
+        std::string value;
+        client.GetChronicleAttr(shared_chronicle_name, "Priority", value);
+
+        std::vector <std::string> story_names;
+        client.ShowStories(chronicle_name, story_names);
+
+        ret = client.ReleaseStory(chronicle_name, story_name);
+        assert(ret == chronolog::CL_SUCCESS || ret == chronolog::CL_ERR_NOT_ACQUIRED);
+        op_count += 4;
+    }
+
+    ret = client.DestroyStory(chronicle_name, story_name);
+    assert(ret == chronolog::CL_SUCCESS || ret == chronolog::CL_ERR_NOT_EXIST);
+    ret = client.DestroyChronicle(chronicle_name);
+    assert(ret == chronolog::CL_SUCCESS);
+    op_count += 2;
+
+    return op_count;
+}
+
+// runs the stress clients as threads sharing the connected client and reports the aggregate metadata ops/s
+void metadata_stress_benchmark(chronolog::Client &client)
+{
+    std::string shared_chronicle_name(gen_random(CHRONICLE_NAME_LEN));
+    std::map <std::string, std::string> chronicle_attrs;
+    chronicle_attrs.emplace("Priority", "High");
+    int flags = 1;
+    int ret = client.CreateChronicle(shared_chronicle_name, chronicle_attrs, flags);
+    assert(ret == chronolog::CL_SUCCESS);
+
+    std::cout << "[ClientLibMetadataRPCTest] Metadata stress benchmark (" << METADATA_STRESS_ROUNDS_PER_CLIENT
+              << " rounds per client)" << std::endl;
+    std::cout << "  clients        ops     seconds        ops/s" << std::endl;
+    for(int num_clients = 1; num_clients <= METADATA_STRESS_MAX_CLIENTS; num_clients *= 2)
+    {
+        std::vector <uint64_t> op_counts(num_clients, 0);
+        std::vector <std::thread> workers;
+        workers.reserve(num_clients);
+
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        for(int i = 0; i < num_clients; i++)
+        {
+            workers.emplace_back([&client, &shared_chronicle_name, &op_counts, i]()
+                                 { op_counts[i] = metadata_stress_client(client, shared_chronicle_name); });
+        }
+        for(auto &worker: workers)
+        { worker.join(); }
+        std::chrono::duration <double> duration = std::chrono::steady_clock::now() - t1;
+
+        uint64_t total_ops = 0;
+        for(uint64_t op_count: op_counts)
+        { total_ops += op_count; }
+        double ops_per_sec = (duration.count() > 0 ? total_ops / duration.count() : 0);
+
+        std::printf("  %7d %10lu %11.3f %12.1f\n", num_clients, static_cast<unsigned long>(total_ops), duration.count()
+                    , ops_per_sec);
+        LOG_INFO("[ClientLibMetadataRPCTest] Metadata stress with {} clients: {} ops in {} s, {} ops/s", num_clients
+                 , total_ops, duration.count(), ops_per_sec);
+    }
+
+    ret = client.DestroyChronicle(shared_chronicle_name);
+    assert(ret == chronolog::CL_SUCCESS);
+}
+
+// compares the setup time of BULK_SETUP_STORY_COUNT stories acquired and released one by one
+// with the batched AcquireStories/ReleaseStories
+void bulk_story_setup_benchmark(chronolog::Client &client)
+{
+    std::string chronicle_name(gen_random(CHRONICLE_NAME_LEN));
+    std::map <std::string, std::string> attrs;
+    attrs.emplace("Priority", "High");
+    int flags = 1;
+    int ret = client.CreateChronicle(chronicle_name, attrs, flags);
+    assert(ret == chronolog::CL_SUCCESS);
+
+    std::vector <std::string> story_names;
+    for(int i = 0; i < BULK_SETUP_STORY_COUNT; i++)
+    { story_names.push_back("bulk_story_" + std::to_string(i)); }
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for(auto const &story_name: story_names)
+    {
+        auto acquire_ret = client.AcquireStory(chronicle_name, story_name, attrs, flags);
+        assert(acquire_ret.first == chronolog::CL_SUCCESS);
+    }
+    for(auto const &story_name: story_names)
+    {
+        ret = client.ReleaseStory(chronicle_name, story_name);
+        assert(ret == chronolog::CL_SUCCESS);
+    }
+    std::chrono::duration <double> single_duration = std::chrono::steady_clock::now() - t1;
+
+    t1 = std::chrono::steady_clock::now();
+    auto acquire_results = client.AcquireStories(chronicle_name, story_names, attrs, flags);
+    assert(acquire_results.size() == story_names.size());
+    for(auto const &acquire_result: acquire_results)
+    { assert(acquire_result.first == chronolog::CL_SUCCESS && acquire_result.second != nullptr); }
+    auto release_results = client.ReleaseStories(chronicle_name, story_names);
+    assert(release_results.size() == story_names.size());
+    for(int release_ret: release_results)
+    { assert(release_ret == chronolog::CL_SUCCESS); }
+    std::chrono::duration <double> batch_duration = std::chrono::steady_clock::now() - t1;
+
+    std::cout << "[ClientLibMetadataRPCTest] Setup and release of " << BULK_SETUP_STORY_COUNT << " stories: "
+              << single_duration.count() << " s one by one, " << batch_duration.count() << " s batched" << std::endl;
+    LOG_INFO("[ClientLibMetadataRPCTest] Bulk story setup of {} stories: {} s one by one, {} s batched"
+             , BULK_SETUP_STORY_COUNT, single_duration.count(), batch_duration.count());
+
+    for(auto const &story_name: story_names)
+    {
+        ret = client.DestroyStory(chronicle_name, story_name);
+        assert(ret == chronolog::CL_SUCCESS);
+    }
+    ret = client.DestroyChronicle(chronicle_name);
+    assert(ret == chronolog::CL_SUCCESS);
+}
+
 int main(int argc, char** argv) {
     
     // Load configuration
@@ -234,6 +382,11 @@ int main(int argc, char** argv) {
         assert(ret == chronolog::CL_SUCCESS);
         duration_destroy_chronicle += (t2 - t1);
     }
+
+    metadata_stress_benchmark(client);
+
+    bulk_story_setup_benchmark(client);
+
     LOG_INFO("[ClientLibMetadataRPCTest] Disconnecting from the server.");
     client.Disconnect();
 
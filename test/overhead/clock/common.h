@@ -10,6 +10,7 @@
 #include <numeric>
 #include <complex>
 #include "chrono_monitor.h"
+#include "HybridLogicalClock.h"
 
 //#define NO_LFENCE
 //#define NO_MFENCE
@@ -261,6 +262,20 @@ unsigned long long*collect_w_std_high_res_clock_imme(int test_reps, int sleep_ti
     return clock_list;
 }
 
+unsigned long long*collect_w_hlc(chronolog::HybridLogicalClock &hlc, int test_reps, int sleep_time = 0)
+{
+    unsigned long long*clock_list = (unsigned long long*)malloc((test_reps + 1) * sizeof(unsigned long long));
+    for(int i = 0; i < test_reps + 1; i++)
+    {
+        mfence();
+        lfence();
+        clock_list[i] = hlc.getTimestamp();
+        emulate_event_interval(sleep_time);
+    }
+
+    return clock_list;
+}
+
 void convert_ull_to_double_vec(unsigned long long*clock_list, int len, std::vector <double> &duration_list)
 {
     duration_list.reserve(len);
@@ -268,6 +283,13 @@ void convert_ull_to_double_vec(unsigned long long*clock_list, int len, std::vect
         duration_list.push_back((clock_list[i + 1] - clock_list[i]) * CPU_GHZ_INV);
 }
 
+void convert_ns_to_ull_vec(unsigned long long*clock_list, int len, std::vector <unsigned long long> &duration_list)
+{
+    duration_list.reserve(len);
+    for(int i = 0; i < len; i++)
+        duration_list.push_back(clock_list[i + 1] - clock_list[i]);
+}
+
 void convert_timespec_to_ull_vec(struct timespec*clock_list, int len, std::vector <unsigned long long> &duration_list)
 {
     duration_list.reserve(len);
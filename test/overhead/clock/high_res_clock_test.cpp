@@ -117,4 +117,21 @@ int main(int argc, char*argv[])
                                                        std::chrono::high_resolution_clock::period::den * 1e9);
         free(clock_list);
     }
+
+    /**
+     * using the hybrid logical clock the clients run in "hlc" clock mode
+     */
+    {
+        chronolog::HybridLogicalClock hlc;
+        unsigned long long*clock_list = collect_w_hlc(hlc, test_reps);
+        std::vector <unsigned long long> duration_list;
+        convert_ns_to_ull_vec(clock_list, test_reps, duration_list);
+        LOG_INFO("[HighResClockTest] Test with HybridLogicalClock::getTimestamp() calls: ");
+        printVectorStats(duration_list);
+        sort(duration_list.begin(), duration_list.end());
+        fout << "HLC\t";
+        printStatLine(fout, duration_list);
+        LOG_INFO("[HighResClockTest] Resolution (ns): 1");
+        free(clock_list);
+    }
 }
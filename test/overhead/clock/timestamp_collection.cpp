@@ -15,6 +15,7 @@ typedef struct thrd_args_
 {
     int thread_id;
     int sleep_ns;
+    chronolog::HybridLogicalClock*hlc;
 } thrd_args;
 
 void rdtscp_thread(void*args)
@@ -52,12 +53,34 @@ void clock_gettime_thread(void*args)
     LOG_INFO("[TimestampCollection] Thread ID: {} completed execution. Timestamps saved to file: {}", thread_id, fname);
 }
 
+void hlc_thread(void*args)
+{
+    int cpu = sched_getcpu();
+    thrd_args*arg = (thrd_args*)args;
+    int thread_id = arg->thread_id;
+    int sleep_time = arg->sleep_ns;
+    LOG_INFO("[TimestampCollection] Thread ID: {} is executing function {} on CPU Core: {} with a sleep interval of {} ns."
+         , thread_id, __FUNCTION__, cpu, sleep_time);
+    // all the threads share the process clock just like the writer threads of a client do
+    unsigned long long*clock_list = collect_w_hlc(*arg->hlc, NUM_TIMESTAMPS, sleep_time);
+    char hostname[256];
+    gethostname(hostname, sizeof(hostname));
+    std::string fname = __FUNCTION__ + std::to_string(thread_id) + hostname;
+    writeListToFile(clock_list, NUM_TIMESTAMPS, fname);
+    free(clock_list);
+    LOG_INFO("[TimestampCollection] Thread ID: {} completed execution. Timestamps saved to file: {}", thread_id, fname);
+}
+
 int main(int argc, char*argv[])
 {
     long n_threads = 24;
     int sleep_ns = 0;
+    std::string clock_source = "clock_gettime";
     if(argc > 1) n_threads = std::strtol(argv[1], nullptr, 10);
     if(argc > 2) sleep_ns = std::strtol(argv[2], nullptr, 10);
+    if(argc > 3) clock_source = argv[3];   // "clock_gettime" or "hlc"
+
+    chronolog::HybridLogicalClock hlc;
 
     std::vector <std::thread> threads;
 
@@ -66,8 +89,12 @@ int main(int argc, char*argv[])
     {
         args[i].thread_id = i;
         args[i].sleep_ns = sleep_ns;
+        args[i].hlc = &hlc;
 //        threads.emplace_back(rdtscp_thread, i);
-        threads.emplace_back(clock_gettime_thread, &args[i]);
+        if(clock_source == "hlc")
+        { threads.emplace_back(hlc_thread, &args[i]); }
+        else
+        { threads.emplace_back(clock_gettime_thread, &args[i]); }
     }
 
     for(auto &thread: threads)
@@ -14,10 +14,12 @@ int main(int argc, char*argv[])
 {
     // Define the path to the directory containing the files
     std::string dir_path = "./";
+    std::string clock_source = "clock_gettime";
     if(argc > 1) dir_path = argv[1];
+    if(argc > 2) clock_source = argv[2];   // "clock_gettime" or "hlc", same as for timestamp_collection
 
     // Define the regular expression to match the file names
-    std::regex file_regex("clock_gettime_thread.*");
+    std::regex file_regex(clock_source + "_thread.*");
 
     // Define an unordered map to store the count of each number
     std::unordered_map <uint64_t, uint64_t> count_map;
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+
+#include "chrono_monitor.h"
+#include "TokenBucket.h"
+#include "KeeperAdmissionControl.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+uint64_t const SECOND = 1000000000;
+
+chl::LogEvent makeEvent(chl::StoryId story_id, chl::ClientId client_id)
+{ return chl::LogEvent(story_id, 1000, client_id, 0, "record"); }
+
+}
+
+TEST(TokenBucket_Test, testUnlimitedBucketAlwaysAdmits)
+{
+    chl::TokenBucket bucket;
+    EXPECT_TRUE(bucket.isUnlimited());
+    for(int i = 0; i < 1000; ++i)
+    { EXPECT_TRUE(bucket.tryConsume(SECOND)); }
+}
+
+TEST(TokenBucket_Test, testBurstIsAdmittedThenRateApplies)
+{
+    chl::TokenBucket bucket(10, 5);
+    uint64_t now = SECOND;
+    for(int i = 0; i < 5; ++i)
+    { EXPECT_TRUE(bucket.tryConsume(now)); }
+    EXPECT_FALSE(bucket.tryConsume(now));
+
+    // one token every 100 milliseconds at 10 events per second
+    EXPECT_FALSE(bucket.tryConsume(now + SECOND / 20));
+    EXPECT_TRUE(bucket.tryConsume(now + SECOND / 10));
+    EXPECT_FALSE(bucket.tryConsume(now + SECOND / 10));
+}
+
+TEST(TokenBucket_Test, testRefillIsCappedAtBurst)
+{
+    chl::TokenBucket bucket(1000000, 3);
+    uint64_t now = SECOND;
+    EXPECT_TRUE(bucket.tryConsume(now, 3));
+    // a long idle time must neither overflow nor refill over the burst
+    now += 100000 * SECOND;
+    EXPECT_TRUE(bucket.tryConsume(now, 3));
+    EXPECT_FALSE(bucket.tryConsume(now));
+}
+
+class KeeperAdmissionControl_Test: public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        std::string log_file = (std::filesystem::temp_directory_path() / "admission_control_test.log").string();
+        chl::chrono_monitor::initialize("file", log_file, spdlog::level::info, "AdmissionControlTest");
+    }
+};
+
+TEST_F(KeeperAdmissionControl_Test, testStoriesWithoutLimitsAreAdmitted)
+{
+    chl::KeeperAdmissionControl admission_control;
+    admission_control.setStoryLimits(1, chl::StoryAdmissionLimits());
+    for(int i = 0; i < 100; ++i)
+    { EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7))); }
+    EXPECT_EQ(admission_control.getThrottledEventCount(), 0u);
+}
+
+TEST_F(KeeperAdmissionControl_Test, testClientOverItsRateIsThrottled)
+{
+    chl::KeeperAdmissionControl admission_control;
+    chl::StoryAdmissionLimits limits;
+    limits.clientEventRate = 5;
+    limits.burstMillis = 1000;
+    admission_control.setStoryLimits(1, limits);
+
+    int admitted = 0;
+    for(int i = 0; i < 20; ++i)
+    { admitted += admission_control.admitEvent(makeEvent(1, 7)); }
+    EXPECT_EQ(admitted, 5);
+    EXPECT_EQ(admission_control.getThrottledEventCount(), 15u);
+
+    // the other client of the story and the other story have their own budget
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 8)));
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(2, 7)));
+}
+
+TEST_F(KeeperAdmissionControl_Test, testStoryRateIsSharedByItsClients)
+{
+    chl::KeeperAdmissionControl admission_control;
+    chl::StoryAdmissionLimits limits;
+    limits.clientEventRate = 10;
+    limits.storyEventRate = 12;
+    limits.burstMillis = 1000;
+    admission_control.setStoryLimits(1, limits);
+
+    int admitted = 0;
+    for(int i = 0; i < 10; ++i)
+    {
+        admitted += admission_control.admitEvent(makeEvent(1, 7));
+        admitted += admission_control.admitEvent(makeEvent(1, 8));
+    }
+    EXPECT_EQ(admitted, 12);
+}
+
+TEST_F(KeeperAdmissionControl_Test, testRemovedStoryIsNoLongerLimited)
+{
+    chl::KeeperAdmissionControl admission_control;
+    chl::StoryAdmissionLimits limits;
+    limits.storyEventRate = 1;
+    admission_control.setStoryLimits(1, limits);
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7)));
+    EXPECT_FALSE(admission_control.admitEvent(makeEvent(1, 7)));
+
+    admission_control.removeStory(1);
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7)));
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7)));
+}
+
+TEST_F(KeeperAdmissionControl_Test, testIdleClientBucketsAreDropped)
+{
+    chl::KeeperAdmissionControl admission_control;
+    chl::StoryAdmissionLimits limits;
+    limits.clientEventRate = 5;
+    limits.burstMillis = 1000;
+    admission_control.setStoryLimits(1, limits);
+
+    uint64_t start = SECOND;
+    for(chl::ClientId client_id = 1; client_id <= 100; ++client_id)
+    { EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, client_id), start)); }
+    EXPECT_EQ(admission_control.getClientBucketCount(1), 100u);
+
+    // only client 7 keeps writing, the buckets of the others are dropped once they have been idle long enough
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7), start + CLIENT_BUCKET_IDLE_SECS * SECOND / 2));
+    uint64_t now = start + CLIENT_BUCKET_IDLE_SECS * SECOND + 1;
+    EXPECT_TRUE(admission_control.admitEvent(makeEvent(1, 7), now));
+    EXPECT_EQ(admission_control.getClientBucketCount(1), 1u);
+
+    // the client coming back gets the full burst again
+    int admitted = 0;
+    for(int i = 0; i < 10; ++i)
+    { admitted += admission_control.admitEvent(makeEvent(1, 1), now); }
+    EXPECT_EQ(admitted, 5);
+    EXPECT_EQ(admission_control.getClientBucketCount(1), 2u);
+}
@@ -0,0 +1,134 @@
+#include "ArchiveReadingRequestQueue.h"
+#include <gtest/gtest.h>
+
+namespace chl = chronolog;
+
+// the queue is guarded by the Argobots mutex, the tests run within the Argobots scope
+class Argobots_Environment: public ::testing::Environment
+{
+public:
+    void SetUp() override
+    { scope = new tl::abt(); }
+
+    void TearDown() override
+    { delete scope; }
+
+private:
+    tl::abt * scope = nullptr;
+};
+
+static ::testing::Environment * const argobotsEnvironment = ::testing::AddGlobalTestEnvironment(new Argobots_Environment);
+
+static uint64_t const SECOND = 1000000000;
+
+static chl::ArchiveReadingRequest makeRequest(std::string const &client, std::string const &story, uint64_t duration)
+{
+    return chl::ArchiveReadingRequest(nullptr, "chronicle", story, 1000 * SECOND, 1000 * SECOND + duration
+                                      , chl::PlaybackFilter(), nullptr, nullptr, client);
+}
+
+static std::string popStory(chl::ArchiveReadingRequestQueue &queue)
+{
+    chl::ArchiveReadingRequest request;
+    queue.popReadingRequest(request);
+    return request.storyName;
+}
+
+TEST(ArchiveReadingRequestQueue_Test, testSlicing)
+{
+    chl::ArchiveReadingRequestQueue queue(60 * SECOND);
+    queue.pushReadingRequest(makeRequest("client", "short", 60 * SECOND));
+    queue.pushReadingRequest(makeRequest("client", "long", 150 * SECOND));
+
+    chl::ArchiveReadingRequest request;
+    queue.popReadingRequest(request);
+    EXPECT_EQ(request.storyName, "short");
+    EXPECT_EQ(request.priority, chl::READING_INTERACTIVE);
+    EXPECT_EQ(queue.getSliceEnd(request), request.endTime);
+
+    queue.popReadingRequest(request);
+    EXPECT_EQ(request.storyName, "long");
+    EXPECT_EQ(request.priority, chl::READING_BULK);
+    EXPECT_EQ(queue.getSliceEnd(request), request.startTime + 60 * SECOND);
+
+    // the returned remainder keeps its class and original enqueue time
+    uint64_t enqueue_time = request.enqueueTime;
+    request.sliceStart = queue.getSliceEnd(request);
+    queue.pushReadingRequest(request);
+    queue.popReadingRequest(request);
+    EXPECT_EQ(request.priority, chl::READING_BULK);
+    EXPECT_EQ(request.enqueueTime, enqueue_time);
+    EXPECT_EQ(queue.getSliceEnd(request), request.startTime + 120 * SECOND);
+    request.sliceStart = queue.getSliceEnd(request);
+    EXPECT_EQ(queue.getSliceEnd(request), request.endTime);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ArchiveReadingRequestQueue_Test, testClientFairness)
+{
+    chl::ArchiveReadingRequestQueue queue(60 * SECOND);
+    queue.pushReadingRequest(makeRequest("A", "a1", SECOND));
+    queue.pushReadingRequest(makeRequest("A", "a2", SECOND));
+    queue.pushReadingRequest(makeRequest("A", "a3", SECOND));
+    queue.pushReadingRequest(makeRequest("B", "b1", SECOND));
+    queue.pushReadingRequest(makeRequest("C", "c1", SECOND));
+
+    EXPECT_EQ(popStory(queue), "a1");
+    EXPECT_EQ(popStory(queue), "b1");
+    EXPECT_EQ(popStory(queue), "c1");
+    EXPECT_EQ(popStory(queue), "a2");
+    EXPECT_EQ(popStory(queue), "a3");
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(popStory(queue), "");
+}
+
+TEST(ArchiveReadingRequestQueue_Test, testInteractivePriority)
+{
+    chl::ArchiveReadingRequestQueue queue(60 * SECOND);
+    queue.pushReadingRequest(makeRequest("exporter", "bulk", 3600 * SECOND));
+    for(int i = 0; i < INTERACTIVE_READING_BURST + 2; ++i)
+    { queue.pushReadingRequest(makeRequest("client" + std::to_string(i), "interactive", SECOND)); }
+
+    for(int i = 0; i < INTERACTIVE_READING_BURST; ++i)
+    { EXPECT_EQ(popStory(queue), "interactive"); }
+    // bulk request is not starved by the interactive ones
+    EXPECT_EQ(popStory(queue), "bulk");
+    EXPECT_EQ(popStory(queue), "interactive");
+    EXPECT_EQ(popStory(queue), "interactive");
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ArchiveReadingRequestQueue_Test, testStatsAndShutdown)
+{
+    chl::ArchiveReadingRequestQueue queue(60 * SECOND);
+    queue.pushReadingRequest(makeRequest("A", "interactive", SECOND));
+    queue.pushReadingRequest(makeRequest("A", "bulk", 3600 * SECOND));
+    queue.pushReadingRequest(makeRequest("B", "bulk", 3600 * SECOND));
+
+    chl::ArchiveReadingRequest request;
+    queue.waitReadingRequest(request);
+    queue.completeReadingRequest(request);
+
+    chl::ReadingClassStats interactive_stats;
+    chl::ReadingClassStats bulk_stats;
+    queue.collectReadingStats(interactive_stats, bulk_stats);
+    EXPECT_EQ(interactive_stats.queueDepth, 0);
+    EXPECT_EQ(interactive_stats.completedRequests, 1);
+    EXPECT_GE(interactive_stats.maxLatency, interactive_stats.meanLatency);
+    EXPECT_EQ(bulk_stats.queueDepth, 2);
+    EXPECT_EQ(bulk_stats.completedRequests, 0);
+
+    // latencies are reported for the interval since the previous collection
+    queue.collectReadingStats(interactive_stats, bulk_stats);
+    EXPECT_EQ(interactive_stats.completedRequests, 0);
+
+    queue.shutdown();
+    EXPECT_FALSE(queue.pushReadingRequest(makeRequest("C", "late", SECOND)));
+    // the queued requests can still be drained after the shutdown
+    queue.waitReadingRequest(request);
+    EXPECT_EQ(request.storyName, "bulk");
+    queue.waitReadingRequest(request);
+    EXPECT_EQ(request.storyName, "bulk");
+    queue.waitReadingRequest(request);
+    EXPECT_TRUE(request.storyName.empty());
+}
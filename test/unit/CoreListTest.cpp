@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CoreList.h"
+
+namespace chl = chronolog;
+
+// sysfs layout of a two socket node: cores 0-3 on NUMA node 0, cores 4-7 on NUMA node 1
+class CoreList_Test: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        sysfsDir = std::filesystem::temp_directory_path() / "core_list_test_sysfs";
+        std::filesystem::remove_all(sysfsDir);
+        for(int node = 0; node < 2; ++node)
+        {
+            std::filesystem::path node_dir = sysfsDir / "node" / ("node" + std::to_string(node));
+            std::filesystem::create_directories(node_dir);
+            std::ofstream(node_dir / "cpulist") << (node == 0 ? "0-3" : "4-7") << "\n";
+            for(int core = 4 * node; core < 4 * node + 4; ++core)
+            {
+                std::filesystem::create_directories(
+                        sysfsDir / "cpu" / ("cpu" + std::to_string(core)) / ("node" + std::to_string(node)));
+            }
+        }
+    }
+
+    void TearDown() override
+    { std::filesystem::remove_all(sysfsDir); }
+
+    std::filesystem::path sysfsDir;
+};
+
+TEST_F(CoreList_Test, testParsesCoresAndRanges)
+{
+    std::vector <int> cores;
+    EXPECT_EQ(chl::parseCoreList("6, 0-2,4", cores, sysfsDir.string()), chl::CL_SUCCESS);
+    EXPECT_EQ(cores, (std::vector <int>{6, 0, 1, 2, 4}));
+}
+
+TEST_F(CoreList_Test, testEmptyListHasNoCores)
+{
+    std::vector <int> cores;
+    EXPECT_EQ(chl::parseCoreList("", cores, sysfsDir.string()), chl::CL_SUCCESS);
+    EXPECT_TRUE(cores.empty());
+}
+
+TEST_F(CoreList_Test, testExpandsNumaNodesWithoutDuplicates)
+{
+    std::vector <int> cores;
+    EXPECT_EQ(chl::parseCoreList("5,node1,2", cores, sysfsDir.string()), chl::CL_SUCCESS);
+    EXPECT_EQ(cores, (std::vector <int>{5, 4, 6, 7, 2}));
+}
+
+TEST_F(CoreList_Test, testRejectsMalformedLists)
+{
+    for(char const *core_list: {"a", "3-1", "1-", "-2", "node", "node9", "node0x", "1;2"})
+    {
+        std::vector <int> cores;
+        EXPECT_EQ(chl::parseCoreList(core_list, cores, sysfsDir.string()), chl::CL_ERR_INVALID_CONF) << core_list;
+    }
+}
+
+TEST_F(CoreList_Test, testFindsNumaNodeOfCore)
+{
+    EXPECT_EQ(chl::getCoreNumaNode(1, sysfsDir.string()), 0);
+    EXPECT_EQ(chl::getCoreNumaNode(7, sysfsDir.string()), 1);
+    EXPECT_EQ(chl::getCoreNumaNode(42, sysfsDir.string()), -1);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+
+#include "chrono_monitor.h"
+#include "EventTracer.h"
+#include "StoryChunk.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+chl::LogEvent makeEvent(uint64_t index)
+{ return chl::LogEvent(1, 1000 + index, 7, static_cast<chl::chrono_index>(index), "record"); }
+
+// index of the next event that would be sampled, starting at start_index
+uint64_t nextSampledIndex(uint64_t start_index)
+{
+    uint64_t index = start_index;
+    while(!chl::EventTracer::isSampled(makeEvent(index)))
+    { ++index; }
+    return index;
+}
+
+}
+
+class EventTracerTest: public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        std::string log_file = (std::filesystem::temp_directory_path() / "event_tracer_test.log").string();
+        chl::chrono_monitor::initialize("file", log_file, spdlog::level::info, "EventTracerTest");
+    }
+
+    void TearDown() override
+    { chl::EventTracer::getInstance().configure("EventTracerTest", 0); }
+};
+
+TEST_F(EventTracerTest, testDisabledTracingRecordsNothing)
+{
+    chl::EventTracer &tracer = chl::EventTracer::getInstance();
+    tracer.configure("EventTracerTest", 0);
+    size_t trace_count = tracer.getTraceCount();
+
+    for(uint64_t index = 0; index < 10000; ++index)
+    {
+        EXPECT_FALSE(chl::EventTracer::isSampled(makeEvent(index)));
+        tracer.recordStage(makeEvent(index), "log");
+    }
+    EXPECT_EQ(tracer.getTraceCount(), trace_count);
+}
+
+TEST_F(EventTracerTest, testSamplingIsDeterministicOneInN)
+{
+    chl::EventTracer::getInstance().configure("EventTracerTest", 64);
+
+    uint64_t const event_count = 640000;
+    uint64_t sampled_count = 0;
+    for(uint64_t index = 0; index < event_count; ++index)
+    {
+        chl::LogEvent event = makeEvent(index);
+        bool sampled = chl::EventTracer::isSampled(event);
+        // every process on the event path makes the same decision for the same event
+        EXPECT_EQ(sampled, chl::EventTracer::isSampled(chl::eventTraceId(event)));
+        if(sampled)
+        { ++sampled_count; }
+    }
+    EXPECT_NEAR(static_cast<double>(sampled_count), event_count / 64.0, event_count / 64.0 * 0.1);
+}
+
+TEST_F(EventTracerTest, testChromeTraceOfRecordedStages)
+{
+    chl::EventTracer &tracer = chl::EventTracer::getInstance();
+    tracer.configure("EventTracerTest", 8);
+
+    chl::LogEvent event = makeEvent(nextSampledIndex(1000000));
+    tracer.recordStage(event, "log");
+    tracer.recordStage(event, "sent");
+
+    std::string json = tracer.toChromeTraceJson();
+    std::string trace_id = "\"trace_id\":\"" + std::to_string(chl::eventTraceId(event)) + "\"";
+    EXPECT_NE(json.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"EventTracerTest\"}"), std::string::npos);
+    // the first stage is an instant event, the next one spans the time since the first
+    EXPECT_NE(json.find("{\"name\":\"log\",\"cat\":\"chronolog\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"sent\",\"cat\":\"chronolog\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find(trace_id), std::string::npos);
+}
+
+TEST_F(EventTracerTest, testTraceCountIsBounded)
+{
+    chl::EventTracer &tracer = chl::EventTracer::getInstance();
+    tracer.configure("EventTracerTest", 1);
+
+    for(uint64_t index = 0; index < EVENT_TRACE_MAX_TRACES + 100; ++index)
+    { tracer.recordStage(makeEvent(2000000 + index), "log"); }
+    EXPECT_EQ(tracer.getTraceCount(), static_cast<size_t>(EVENT_TRACE_MAX_TRACES));
+}
+
+TEST_F(EventTracerTest, testStoryChunkKeepsSampledEvents)
+{
+    chl::EventTracer::getInstance().configure("EventTracerTest", 8);
+
+    chl::StoryChunk chunk("chronicle", "story", 1, 1000, 100000);
+    uint64_t sampled_index = nextSampledIndex(0);
+    uint64_t sampled_count = 0;
+    for(uint64_t index = 0; index < 1000; ++index)
+    {
+        chunk.insertEvent(makeEvent(index));
+        if(chl::EventTracer::isSampled(makeEvent(index)))
+        { ++sampled_count; }
+    }
+    EXPECT_EQ(chunk.getTracedEvents().size(), sampled_count);
+
+    // the traced events follow the events out of the chunk
+    chl::LogEvent sampled_event = makeEvent(sampled_index);
+    chunk.eraseEvents(sampled_event.time(), sampled_event.time() + 1);
+    EXPECT_EQ(chunk.getTracedEvents().size(), sampled_count - 1);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "GroupPlacementPolicy.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+std::vector <chl::GroupLoad> makeGroupLoads(std::vector <uint32_t> const &story_counts
+                                            , std::vector <uint32_t> const &capacities)
+{
+    std::vector <chl::GroupLoad> group_loads;
+    for(size_t i = 0; i < story_counts.size(); ++i)
+    {
+        chl::GroupLoad group_load;
+        group_load.groupId = i;
+        group_load.storyCount = story_counts[i];
+        group_load.capacity = capacities[i];
+        group_loads.push_back(group_load);
+    }
+    return group_loads;
+}
+
+struct SimulatedStory
+{
+    size_t group;
+    double ingestionRate;
+    double endTime;
+};
+
+// time averaged ratio of the most loaded group to the mean group load, both per unit of capacity
+double simulateArrivalTrace(chl::GroupPlacementPolicy &policy, std::vector <uint32_t> const &capacities)
+{
+    double const arrival_rate = 2.0;      // stories per second
+    double const mean_lifetime = 300.0;   // seconds
+    double const stats_interval = 10.0;   // seconds between the process stats messages
+    double const trace_duration = 3600.0;
+
+    std::mt19937_64 trace_random(20240501);
+    std::exponential_distribution <double> inter_arrival(arrival_rate);
+    std::exponential_distribution <double> lifetime(1.0 / mean_lifetime);
+    std::uniform_real_distribution <double> uniform(0.0, 1.0);
+
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads(std::vector <uint32_t>(capacities.size(), 0), capacities);
+    std::vector <double> actual_rates(capacities.size(), 0);
+    std::vector <SimulatedStory> active_stories;
+
+    double now = 0;
+    double next_stats_time = stats_interval;
+    double imbalance_sum = 0;
+    size_t imbalance_samples = 0;
+
+    while(now < trace_duration)
+    {
+        now += inter_arrival(trace_random);
+
+        // retire the stories that ended before this arrival
+        for(auto iter = active_stories.begin(); iter != active_stories.end();)
+        {
+            if((*iter).endTime <= now)
+            {
+                group_loads[(*iter).group].storyCount--;
+                actual_rates[(*iter).group] -= (*iter).ingestionRate;
+                iter = active_stories.erase(iter);
+            }
+            else
+            { ++iter; }
+        }
+
+        // the ingestion rates the registry sees are only as fresh as the latest stats message
+        while(next_stats_time <= now)
+        {
+            double max_load = 0;
+            double total_load = 0;
+            double total_capacity = 0;
+            for(size_t g = 0; g < group_loads.size(); ++g)
+            {
+                group_loads[g].ingestionRate = static_cast<uint64_t>(std::max(0.0, actual_rates[g]));
+                max_load = std::max(max_load, actual_rates[g] / capacities[g]);
+                total_load += actual_rates[g];
+                total_capacity += capacities[g];
+            }
+            if(total_load > 0)
+            {
+                imbalance_sum += max_load / (total_load / total_capacity);
+                imbalance_samples++;
+            }
+            next_stats_time += stats_interval;
+        }
+
+        // heavy tailed ingestion rate: most stories are small, a few are very busy
+        double ingestion_rate = 100.0 / std::pow(1.0 - uniform(trace_random), 1.0 / 1.5);
+        size_t group = policy.selectGroup(group_loads);
+        group_loads[group].storyCount++;
+        actual_rates[group] += ingestion_rate;
+        active_stories.push_back(SimulatedStory{group, ingestion_rate, now + lifetime(trace_random)});
+    }
+
+    return (imbalance_samples == 0 ? 0 : imbalance_sum / imbalance_samples);
+}
+
+}
+
+TEST(GroupPlacementPolicyTest, testCreatePolicy)
+{
+    for(std::string policy_name: {"uniform", "least_loaded", "power_of_two", "weighted_capacity"})
+    {
+        std::unique_ptr <chl::GroupPlacementPolicy> policy(
+                chl::GroupPlacementPolicy::CreateGroupPlacementPolicy(policy_name, 1));
+        ASSERT_NE(policy, nullptr);
+        EXPECT_EQ(policy->getName(), policy_name);
+    }
+    EXPECT_EQ(chl::GroupPlacementPolicy::CreateGroupPlacementPolicy("round_robin", 1), nullptr);
+}
+
+TEST(GroupPlacementPolicyTest, testLeastLoaded)
+{
+    chl::LeastLoadedPlacementPolicy policy;
+
+    EXPECT_EQ(policy.selectGroup(makeGroupLoads({5, 2, 7}, {1, 1, 1})), 1u);
+    // the load is per unit of capacity
+    EXPECT_EQ(policy.selectGroup(makeGroupLoads({5, 2, 7}, {1, 1, 8})), 2u);
+
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads({1, 1}, {1, 1});
+    group_loads[0].ingestionRate = 5000;
+    EXPECT_EQ(policy.selectGroup(group_loads), 1u);
+}
+
+TEST(GroupPlacementPolicyTest, testPowerOfTwo)
+{
+    chl::PowerOfTwoPlacementPolicy policy(7);
+
+    // with two groups both are always drawn and the less loaded one wins
+    for(int i = 0; i < 100; ++i)
+    { EXPECT_EQ(policy.selectGroup(makeGroupLoads({9, 3}, {1, 1})), 1u); }
+
+    // the most loaded of several groups is never selected
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads({1, 2, 3, 50}, {1, 1, 1, 1});
+    for(int i = 0; i < 1000; ++i)
+    { EXPECT_NE(policy.selectGroup(group_loads), 3u); }
+
+    EXPECT_EQ(policy.selectGroup(makeGroupLoads({4}, {1})), 0u);
+}
+
+TEST(GroupPlacementPolicyTest, testWeightedCapacity)
+{
+    chl::WeightedCapacityPlacementPolicy policy(11);
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads({0, 0}, {1, 3});
+
+    size_t selections[2] = {0, 0};
+    for(int i = 0; i < 10000; ++i)
+    { selections[policy.selectGroup(group_loads)]++; }
+
+    EXPECT_NEAR(selections[1] / 10000.0, 0.75, 0.03);
+}
+
+// simulation benchmark over the synthetic story arrival trace:
+// the load aware policies keep the hottest group closer to the mean than the uniform random placement,
+// and with the ingestion rates known only as of the last stats message, power of two choices
+// beats the least loaded policy that keeps piling new stories onto the same group between the stats
+TEST(GroupPlacementPolicyTest, testSyntheticArrivalTrace)
+{
+    std::vector <uint32_t> capacities = {8, 8, 8, 8, 16, 16, 32, 32};
+
+    std::map <std::string, double> imbalance;
+    for(std::string policy_name: {"uniform", "weighted_capacity", "least_loaded", "power_of_two"})
+    {
+        std::unique_ptr <chl::GroupPlacementPolicy> policy(
+                chl::GroupPlacementPolicy::CreateGroupPlacementPolicy(policy_name, 42));
+        imbalance[policy_name] = simulateArrivalTrace(*policy, capacities);
+        std::cout << "[GroupPlacementPolicyTest] " << policy_name << " mean max/avg load imbalance: "
+                  << imbalance[policy_name] << std::endl;
+    }
+
+    EXPECT_LT(imbalance["weighted_capacity"], imbalance["uniform"]);
+    EXPECT_LT(imbalance["least_loaded"], imbalance["uniform"]);
+    EXPECT_LT(imbalance["power_of_two"], imbalance["least_loaded"]);
+    EXPECT_LT(imbalance["power_of_two"], imbalance["weighted_capacity"]);
+}
+
+TEST(GroupPlacementPolicyTest, testSelectRebalancingGroups)
+{
+    size_t source = 0;
+    size_t target = 0;
+
+    // balanced groups are left alone
+    EXPECT_FALSE(chl::selectRebalancingGroups(makeGroupLoads({4, 5, 4}, {1, 1, 1}), 1.5, source, target));
+    EXPECT_FALSE(chl::selectRebalancingGroups(makeGroupLoads({4}, {1}), 1.5, source, target));
+
+    // the hot group stands out after a new group joins
+    ASSERT_TRUE(chl::selectRebalancingGroups(makeGroupLoads({12, 6, 0}, {1, 1, 1}), 1.5, source, target));
+    EXPECT_EQ(source, 0u);
+    EXPECT_EQ(target, 2u);
+
+    // the load is per unit of capacity
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads({2, 2, 2}, {4, 1, 4});
+    group_loads[1].ingestionRate = 6000;
+    ASSERT_TRUE(chl::selectRebalancingGroups(group_loads, 1.5, source, target));
+    EXPECT_EQ(source, 1u);
+    EXPECT_NE(target, 1u);
+}
+
+TEST(GroupPlacementPolicyTest, testSelectStoryToMigrate)
+{
+    std::vector <chl::GroupLoad> group_loads = makeGroupLoads({3, 0}, {1, 1});
+    group_loads[0].ingestionRate = 9000;
+    chl::StoryId story_id = 0;
+
+    // the 8000 events/sec story would just move the hot spot, the 4000 events/sec one evens the groups best
+    std::vector <chl::StoryLoad> candidates = {{1, 8000}, {2, 4000}, {3, 1000}};
+    ASSERT_TRUE(chl::selectStoryToMigrate(group_loads[0], group_loads[1], candidates, story_id));
+    EXPECT_EQ(story_id, 2u);
+
+    // once moved, the story is not worth bouncing back
+    chl::GroupLoad source = group_loads[1];
+    source.storyCount = 1;
+    source.ingestionRate = 4000;
+    chl::GroupLoad target = group_loads[0];
+    target.storyCount = 2;
+    target.ingestionRate = 5000;
+    EXPECT_FALSE(chl::selectStoryToMigrate(source, target, {{2, 4000}}, story_id));
+
+    EXPECT_FALSE(chl::selectStoryToMigrate(group_loads[0], group_loads[1], {}, story_id));
+}
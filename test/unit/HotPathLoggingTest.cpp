@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+
+#include "chrono_monitor.h"
+#include "IngestionQueue.h"
+
+// Allocation benchmark of the Keeper ingest path: with the debug logging off
+// ingesting an event should allocate nothing beyond the storage of the event itself.
+
+namespace chl = chronolog;
+
+namespace
+{
+std::atomic <uint64_t> allocationCount{0};
+}
+
+void*operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void*ptr = std::malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr)
+    { throw std::bad_alloc(); }
+    return ptr;
+}
+
+void operator delete(void*ptr) noexcept
+{ std::free(ptr); }
+
+void operator delete(void*ptr, std::size_t) noexcept
+{ std::free(ptr); }
+
+class HotPathLoggingTest: public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        std::string log_file = (std::filesystem::temp_directory_path() / "hot_path_logging_test.log").string();
+        chl::chrono_monitor::initialize("file", log_file, spdlog::level::info, "HotPathLoggingTest");
+    }
+
+    // events with the log record short enough for the small string optimization,
+    // so that copying the event into the deque allocates nothing but the deque blocks
+    static chl::LogEvent makeEvent(chl::StoryId story_id, uint64_t index)
+    { return chl::LogEvent(story_id, 1000000000ULL + index, 7, index, "record"); }
+
+    // allocations made to store the events in the story deque, without the ingestion queue on the path
+    static uint64_t storageAllocations(uint64_t event_count)
+    {
+        std::mutex handle_mutex;
+        chl::EventDeque active_deque;
+        chl::EventDeque passive_deque;
+        chl::StoryIngestionHandle handle(handle_mutex, &active_deque, &passive_deque);
+
+        uint64_t allocations_before = allocationCount.load();
+        for(uint64_t i = 0; i < event_count; ++i)
+        { handle.ingestEvent(makeEvent(1, i)); }
+        return allocationCount.load() - allocations_before;
+    }
+
+    // allocations made by IngestionQueue::ingestLogEvent for the same events
+    static uint64_t ingestAllocations(uint64_t event_count, double &nsecs_per_event)
+    {
+        std::mutex handle_mutex;
+        chl::EventDeque active_deque;
+        chl::EventDeque passive_deque;
+        chl::StoryIngestionHandle handle(handle_mutex, &active_deque, &passive_deque);
+        chl::IngestionQueue ingestion_queue;
+        ingestion_queue.addStoryIngestionHandle(1, &handle);
+
+        uint64_t allocations_before = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < event_count; ++i)
+        { ingestion_queue.ingestLogEvent(makeEvent(1, i)); }
+        auto end = std::chrono::steady_clock::now();
+        uint64_t allocations = allocationCount.load() - allocations_before;
+
+        nsecs_per_event = static_cast<double>(std::chrono::duration_cast <std::chrono::nanoseconds>(end - start).count()) /
+                          event_count;
+        ingestion_queue.removeIngestionHandle(1);
+        return allocations;
+    }
+};
+
+TEST_F(HotPathLoggingTest, testDisabledDebugLoggingDoesNotEvaluateArguments)
+{
+    chl::LogEvent event = makeEvent(1, 1);
+    int evaluations = 0;
+    auto count_evaluation = [&evaluations, &event]()
+    {
+        ++evaluations;
+        return event.toString();
+    };
+    (void)count_evaluation;    // unused when the debug logging is compiled out
+
+    uint64_t allocations_before = allocationCount.load();
+    for(int i = 0; i < 1000; ++i)
+    {
+        LOG_DEBUG("[HotPathLoggingTest] event {}", count_evaluation());
+        LOG_TRACE("[HotPathLoggingTest] event {}", count_evaluation());
+    }
+    EXPECT_EQ(allocationCount.load() - allocations_before, 0u);
+    EXPECT_EQ(evaluations, 0);
+}
+
+TEST_F(HotPathLoggingTest, testIngestPathAllocatesOnlyEventStorage)
+{
+    uint64_t const event_count = 100000;
+    double nsecs_per_event = 0;
+
+    uint64_t storage_allocations = storageAllocations(event_count);
+    uint64_t ingest_allocations = ingestAllocations(event_count, nsecs_per_event);
+
+    std::cout << "[HotPathLoggingTest] ingestLogEvent: " << nsecs_per_event << " ns/event, "
+              << static_cast<double>(ingest_allocations - storage_allocations) / event_count
+              << " logging allocations/event" << std::endl;
+    EXPECT_EQ(ingest_allocations, storage_allocations);
+}
+
+#if CHRONOLOG_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+TEST_F(HotPathLoggingTest, testModuleDebugLevelEnablesEventLogging)
+{
+    uint64_t const event_count = 1000;
+    double nsecs_per_event = 0;
+
+    // the module level is raised at runtime without touching the process level
+    chl::chrono_monitor::setModuleLevel("IngestionQueue", spdlog::level::debug);
+    uint64_t storage_allocations = storageAllocations(event_count);
+    uint64_t ingest_allocations = ingestAllocations(event_count, nsecs_per_event);
+    chl::chrono_monitor::setModuleLevel("IngestionQueue", spdlog::level::info);
+
+    EXPECT_GT(ingest_allocations, storage_allocations);
+    EXPECT_FALSE(chl::chrono_monitor::getInstance().should_log(spdlog::level::debug));
+}
+#endif
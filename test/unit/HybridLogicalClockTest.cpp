@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "HybridLogicalClock.h"
+
+namespace chl = chronolog;
+
+TEST(HybridLogicalClockTest, testTimestampsAreUniqueAndIncreasing)
+{
+    chl::HybridLogicalClock clock;
+    size_t const thread_count = 4;
+    size_t const timestamps_per_thread = 100000;
+
+    std::vector <std::vector <uint64_t>> thread_timestamps(thread_count);
+    std::vector <std::thread> threads;
+    for(size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&clock, &thread_timestamps, t, timestamps_per_thread]()
+                             {
+                                 thread_timestamps[t].reserve(timestamps_per_thread);
+                                 for(size_t i = 0; i < timestamps_per_thread; ++i)
+                                 { thread_timestamps[t].push_back(clock.getTimestamp()); }
+                             });
+    }
+    for(auto &thread: threads)
+    { thread.join(); }
+
+    std::vector <uint64_t> all_timestamps;
+    for(auto const &timestamps: thread_timestamps)
+    {
+        EXPECT_TRUE(std::is_sorted(timestamps.begin(), timestamps.end()));
+        EXPECT_EQ(std::adjacent_find(timestamps.begin(), timestamps.end()), timestamps.end());
+        all_timestamps.insert(all_timestamps.end(), timestamps.begin(), timestamps.end());
+    }
+    std::sort(all_timestamps.begin(), all_timestamps.end());
+    EXPECT_EQ(std::adjacent_find(all_timestamps.begin(), all_timestamps.end()), all_timestamps.end());
+}
+
+TEST(HybridLogicalClockTest, testRemoteClockAheadIsMerged)
+{
+    chl::HybridLogicalClock clock;
+    uint64_t remote_time = chl::HybridLogicalClock::physicalTime() + 1000000000ULL;
+
+    EXPECT_TRUE(clock.update(remote_time));
+    EXPECT_GT(clock.getClockOffset(), 0u);
+    // the events following the merged remote clock are ordered after it
+    uint64_t first = clock.getTimestamp();
+    uint64_t second = clock.getTimestamp();
+    EXPECT_GT(first, remote_time);
+    EXPECT_GT(second, first);
+    EXPECT_LT(second, remote_time + 1000);
+}
+
+TEST(HybridLogicalClockTest, testRemoteClockBehindIsIgnored)
+{
+    chl::HybridLogicalClock clock;
+    uint64_t before = clock.getTimestamp();
+
+    EXPECT_TRUE(clock.update(before - 1000000000ULL));
+    EXPECT_GT(clock.getTimestamp(), before);
+    EXPECT_EQ(clock.getClockOffset(), 0u);
+}
+
+TEST(HybridLogicalClockTest, testRemoteClockTooFarAheadIsRejected)
+{
+    chl::HybridLogicalClock clock(1000000ULL);
+    uint64_t remote_time = chl::HybridLogicalClock::physicalTime() + 60 * 1000000000ULL;
+
+    EXPECT_FALSE(clock.update(remote_time));
+    EXPECT_LT(clock.getTimestamp(), remote_time);
+    EXPECT_EQ(clock.getClockOffset(), 0u);
+}
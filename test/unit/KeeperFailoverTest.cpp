@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "KeeperFailover.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+// stands in for the KeeperRecordingClient, the circuit breaker time is driven by the test
+class FakeKeeper
+{
+public:
+    explicit FakeKeeper(int return_code = chl::CL_SUCCESS)
+        : returnCode(return_code)
+        , circuitBreaker(3, 1000)
+        , now(0)
+        , sentEvents(0)
+    {}
+
+    bool allowRequest()
+    { return circuitBreaker.allowRequest(now); }
+
+    int send_event_msg(chl::LogEvent const &)
+    {
+        sentEvents++;
+        if(returnCode == chl::CL_ERR_NO_KEEPERS)
+        { circuitBreaker.recordFailure(now); }
+        else
+        { circuitBreaker.recordSuccess(); }
+        return returnCode;
+    }
+
+    int returnCode;
+    chl::KeeperCircuitBreaker circuitBreaker;
+    uint64_t now;
+    int sentEvents;
+};
+
+chl::LogEvent makeEvent(chl::chrono_index index)
+{ return chl::LogEvent(1, 1000 + index, 7, index, "record " + std::to_string(index)); }
+
+}
+
+TEST(KeeperFailover_Test, testCircuitOpensAfterThreshold)
+{
+    chl::KeeperCircuitBreaker breaker(3, 1000);
+    EXPECT_FALSE(breaker.recordFailure(10));
+    EXPECT_FALSE(breaker.recordFailure(20));
+    EXPECT_TRUE(breaker.allowRequest(30));
+    EXPECT_TRUE(breaker.recordFailure(30));
+    EXPECT_TRUE(breaker.isOpen());
+    EXPECT_FALSE(breaker.allowRequest(500));
+    EXPECT_FALSE(breaker.allowRequest(1029));
+}
+
+TEST(KeeperFailover_Test, testHalfOpenAllowsSingleProbe)
+{
+    chl::KeeperCircuitBreaker breaker(1, 1000);
+    breaker.recordFailure(0);
+
+    std::atomic <int> allowed_requests{0};
+    std::vector <std::thread> threads;
+    for(int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&breaker, &allowed_requests]()
+                             {
+                                 for(int i = 0; i < 1000; ++i)
+                                 {
+                                     if(breaker.allowRequest(1000))
+                                     { allowed_requests++; }
+                                 }
+                             });
+    }
+    for(auto &thread: threads)
+    { thread.join(); }
+    EXPECT_EQ(allowed_requests.load(), 1);
+
+    // the probe never reported back, the next one is let through after another open period
+    EXPECT_FALSE(breaker.allowRequest(1999));
+    EXPECT_TRUE(breaker.allowRequest(2000));
+
+    // the probe success closes the circuit for everyone
+    EXPECT_TRUE(breaker.recordSuccess());
+    EXPECT_FALSE(breaker.isOpen());
+    EXPECT_TRUE(breaker.allowRequest(2000));
+    EXPECT_TRUE(breaker.allowRequest(2000));
+}
+
+TEST(KeeperFailover_Test, testFailedProbeKeepsCircuitOpen)
+{
+    chl::KeeperCircuitBreaker breaker(2, 1000);
+    breaker.recordFailure(0);
+    breaker.recordFailure(0);
+    EXPECT_TRUE(breaker.allowRequest(1000));
+    EXPECT_TRUE(breaker.recordFailure(1100));
+    EXPECT_FALSE(breaker.allowRequest(2000));
+    EXPECT_TRUE(breaker.allowRequest(2100));
+}
+
+TEST(KeeperFailover_Test, testFailoverToNextAvailableKeeper)
+{
+    FakeKeeper dead_keeper(chl::CL_ERR_NO_KEEPERS);
+    FakeKeeper open_keeper(chl::CL_ERR_NO_KEEPERS);
+    FakeKeeper live_keeper;
+    std::vector <FakeKeeper*> keepers = {&dead_keeper, &open_keeper, &live_keeper};
+
+    // open the circuit of the second keeper so that it is skipped without a request
+    for(int i = 0; i < 3; ++i)
+    { open_keeper.send_event_msg(makeEvent(0)); }
+    open_keeper.sentEvents = 0;
+
+    FakeKeeper* chosen_keeper = &dead_keeper;
+    EXPECT_EQ(chl::sendWithFailover(keepers, chosen_keeper, makeEvent(1)), chl::CL_SUCCESS);
+    EXPECT_EQ(chosen_keeper, &live_keeper);
+    EXPECT_EQ(dead_keeper.sentEvents, 1);
+    EXPECT_EQ(open_keeper.sentEvents, 0);
+    EXPECT_EQ(live_keeper.sentEvents, 1);
+
+    // once its circuit is open the dead keeper isn't tried first any more
+    for(chl::chrono_index i = 2; i < 4; ++i)
+    {
+        chosen_keeper = &dead_keeper;
+        EXPECT_EQ(chl::sendWithFailover(keepers, chosen_keeper, makeEvent(i)), chl::CL_SUCCESS);
+    }
+    EXPECT_TRUE(dead_keeper.circuitBreaker.isOpen());
+    chosen_keeper = &dead_keeper;
+    EXPECT_EQ(chl::sendWithFailover(keepers, chosen_keeper, makeEvent(4)), chl::CL_SUCCESS);
+    EXPECT_EQ(dead_keeper.sentEvents, 3);
+    EXPECT_EQ(live_keeper.sentEvents, 4);
+}
+
+TEST(KeeperFailover_Test, testNoKeeperReachable)
+{
+    FakeKeeper first_keeper(chl::CL_ERR_NO_KEEPERS);
+    FakeKeeper second_keeper(chl::CL_ERR_NO_KEEPERS);
+    std::vector <FakeKeeper*> keepers = {&first_keeper, &second_keeper};
+
+    FakeKeeper* chosen_keeper = &second_keeper;
+    EXPECT_EQ(chl::sendWithFailover(keepers, chosen_keeper, makeEvent(0)), chl::CL_ERR_NO_KEEPERS);
+    EXPECT_EQ(chosen_keeper, &second_keeper);
+    EXPECT_EQ(first_keeper.sentEvents, 1);
+    EXPECT_EQ(second_keeper.sentEvents, 1);
+}
+
+TEST(KeeperFailover_Test, testRetryBufferCapacity)
+{
+    chl::EventRetryBuffer retry_buffer(4);
+    for(chl::chrono_index i = 0; i < 4; ++i)
+    { EXPECT_TRUE(retry_buffer.push(makeEvent(i))); }
+    EXPECT_FALSE(retry_buffer.push(makeEvent(4)));
+    EXPECT_EQ(retry_buffer.size(), 4);
+}
+
+TEST(KeeperFailover_Test, testRetryBufferFlushKeepsOrderAndStopsWhenUnreachable)
+{
+    chl::EventRetryBuffer retry_buffer(16);
+    for(chl::chrono_index i = 0; i < 10; ++i)
+    { retry_buffer.push(makeEvent(i)); }
+
+    // the keeper comes back for three events, then is unreachable again
+    std::vector <chl::chrono_index> sent_indexes;
+    int calls = 0;
+    size_t rejected_events = 0;
+    size_t flushed_events = retry_buffer.flush(16, [&sent_indexes, &calls](chl::LogEvent const &event)
+    {
+        if(calls++ >= 3)
+        { return int(chl::CL_ERR_NO_KEEPERS); }
+        sent_indexes.push_back(event.index());
+        return int(chl::CL_SUCCESS);
+    }, rejected_events);
+    EXPECT_EQ(flushed_events, 3);
+    EXPECT_EQ(rejected_events, 0);
+    EXPECT_EQ(retry_buffer.size(), 7);
+    EXPECT_EQ(sent_indexes, (std::vector <chl::chrono_index>{0, 1, 2}));
+
+    // the unreachable event stays at the head, the batch limit is respected and the rejected events are dropped
+    flushed_events = retry_buffer.flush(5, [&sent_indexes](chl::LogEvent const &event)
+    {
+        sent_indexes.push_back(event.index());
+        return int(event.index() == 4 ? chl::CL_ERR_INVALID_ARG : chl::CL_SUCCESS);
+    }, rejected_events);
+    EXPECT_EQ(flushed_events, 5);
+    EXPECT_EQ(rejected_events, 1);
+    EXPECT_EQ(retry_buffer.size(), 2);
+    EXPECT_EQ(sent_indexes, (std::vector <chl::chrono_index>{0, 1, 2, 3, 4, 5, 6, 7}));
+
+    // the throttled event is retried later as well
+    flushed_events = retry_buffer.flush(5, [](chl::LogEvent const &)
+    { return int(chl::CL_ERR_THROTTLED); }, rejected_events);
+    EXPECT_EQ(flushed_events, 0);
+    EXPECT_EQ(retry_buffer.size(), 2);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "MetricsRegistry.h"
+
+namespace chl = chronolog;
+
+TEST(MetricsRegistryTest, testCounterSumsConcurrentUpdates)
+{
+    chl::MetricsCounter *counter = chl::MetricsRegistry::getInstance().getCounter("test_concurrent_counter");
+    size_t const thread_count = 8;
+    size_t const increments_per_thread = 100000;
+
+    std::vector <std::thread> threads;
+    for(size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([counter, increments_per_thread]()
+                             {
+                                 for(size_t i = 0; i < increments_per_thread; ++i)
+                                 { counter->add(); }
+                             });
+    }
+    for(auto &thread: threads)
+    { thread.join(); }
+
+    EXPECT_EQ(counter->value(), thread_count * increments_per_thread);
+    // the same name resolves to the same metric
+    EXPECT_EQ(counter, chl::MetricsRegistry::getInstance().getCounter("test_concurrent_counter"));
+}
+
+TEST(MetricsRegistryTest, testHistogramBucketsCoverValueRange)
+{
+    for(uint64_t value: {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 1000ULL, 123456789ULL, ~0ULL})
+    {
+        uint32_t index = chl::LatencyHistogram::bucketIndex(value);
+        ASSERT_LT(index, static_cast<uint32_t>(METRICS_HISTOGRAM_BUCKETS));
+        EXPECT_LE(chl::LatencyHistogram::bucketLowerBound(index), value);
+        if(index + 1 < METRICS_HISTOGRAM_BUCKETS)
+        { EXPECT_GT(chl::LatencyHistogram::bucketLowerBound(index + 1), value); }
+    }
+}
+
+TEST(MetricsRegistryTest, testHistogramQuantiles)
+{
+    chl::LatencyHistogram *histogram = chl::MetricsRegistry::getInstance().getHistogram("test_quantile_histogram");
+    for(uint64_t value = 1; value <= 100000; ++value)
+    { histogram->record(value); }
+
+    chl::HistogramSnapshot snapshot = histogram->snapshot();
+    EXPECT_EQ(snapshot.count, 100000u);
+    EXPECT_EQ(snapshot.max, 100000u);
+    EXPECT_EQ(snapshot.sum, 100000ULL * 100001ULL / 2);
+    // the bucket midpoint is within the sub bucket resolution of the exact quantile
+    EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.5)), 50000.0, 50000.0 / METRICS_HISTOGRAM_SUB_BUCKETS);
+    EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.99)), 99000.0, 99000.0 / METRICS_HISTOGRAM_SUB_BUCKETS);
+    EXPECT_EQ(snapshot.quantile(1.0), 100000u);
+}
+
+TEST(MetricsRegistryTest, testTextExportAndRollup)
+{
+    chl::MetricsRegistry &registry = chl::MetricsRegistry::getInstance();
+    registry.getGauge("test_export_gauge")->set(42);
+    registry.getCounter("test_export_counter")->add(7);
+    registry.getHistogram("test_export_histogram")->record(1000);
+    registry.getHistogram("test_empty_histogram");
+
+    std::string text = registry.toText();
+    EXPECT_NE(text.find("test_export_gauge 42\n"), std::string::npos);
+    EXPECT_NE(text.find("test_export_counter 7\n"), std::string::npos);
+    EXPECT_NE(text.find("test_export_histogram count=1 "), std::string::npos);
+
+    std::vector <chl::MetricSummary> rollup;
+    registry.getRollup(rollup);
+    bool found_histogram = false;
+    for(auto const &summary: rollup)
+    {
+        // the histograms with no recorded values are left out of the rollup
+        EXPECT_NE(summary.name, "test_empty_histogram");
+        if(summary.name == "test_export_histogram")
+        {
+            found_histogram = true;
+            EXPECT_EQ(summary.count, 1u);
+            EXPECT_EQ(summary.max, 1000u);
+        }
+    }
+    EXPECT_TRUE(found_histogram);
+}
+
+TEST(MetricsRegistryTest, testScopedLatencyRecordsOnlySampledScopes)
+{
+    chl::LatencyHistogram *histogram = chl::MetricsRegistry::getInstance().getHistogram("test_scoped_histogram");
+    {
+        chl::ScopedLatency timed(histogram);
+    }
+    {
+        chl::ScopedLatency skipped(histogram, false);
+    }
+    EXPECT_EQ(histogram->snapshot().count, 1u);
+}
@@ -0,0 +1,184 @@
+#include "PlaybackEventSelector.h"
+#include "StoryChunk.h"
+#include "chrono_monitor.h"
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+namespace chl = chronolog;
+
+static void initLogger()
+{
+    int ret = chl::chrono_monitor::initialize("console", "", spdlog::level::debug, "unit_test_logger");
+    ASSERT_EQ(ret, 0);
+}
+
+// offer events with time 100..100+count, clientId = index % 3, record "event <index>"
+static void offerEvents(chl::PlaybackEventSelector &selector, chl::StoryChunk &chunk, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        chl::LogEvent event(1, 100 + i, i % 3, i, "event " + std::to_string(i));
+        if(selector.select(event.getClientId(), event.getRecord()))
+        { selector.keep(chunk, event); }
+    }
+    selector.drainReservoir(chunk);
+}
+
+// offer the archived events with time 100+first..100+last the way the archive reader does,
+// advancing the archive horizon before the filter is evaluated
+static void offerArchivedEvents(chl::PlaybackEventSelector &selector, chl::StoryChunk &chunk, int first, int last)
+{
+    for(int i = first; i <= last && !selector.is_exhausted(); ++i)
+    {
+        chl::LogEvent event(1, 100 + i, i % 3, i, "event " + std::to_string(i));
+        selector.advanceArchiveHorizon(chl::EventSequence(event.time(), event.getClientId(), event.index()));
+        if(selector.select(event.getClientId(), event.getRecord()))
+        { selector.keep(chunk, event); }
+    }
+}
+
+// in-memory store holding the recent events with time 100+first..100+last
+static void fillRecentEvents(chl::StoryChunk &recent_chunk, int first, int last)
+{
+    for(int i = first; i <= last; ++i)
+    { recent_chunk.insertEvent(chl::LogEvent(1, 100 + i, i % 3, i, "event " + std::to_string(i))); }
+}
+
+/* ----------------------------------
+  Tests on PlaybackEventSelector
+  ---------------------------------- */
+
+TEST(PlaybackEventSelector_TestSelect, testPassThrough)
+{
+    initLogger();
+    chl::PlaybackEventSelector selector;
+    EXPECT_TRUE(selector.is_pass_through());
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerEvents(selector, chunk, 10);
+    EXPECT_EQ(chunk.getEventCount(), 10);
+}
+
+TEST(PlaybackEventSelector_TestSelect, testClientIdsAndSubstring)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.clientIds = {2, 1};
+    filter.recordPattern = "event 1";
+    chl::PlaybackEventSelector selector(filter);
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerEvents(selector, chunk, 20);
+    // "event 1", "event 10" .. "event 19" produced by clients 1 or 2
+    for(auto const &event_record: chunk)
+    {
+        EXPECT_NE(event_record.second.getClientId(), 0);
+        EXPECT_EQ(event_record.second.getRecord().find("event 1"), 0);
+    }
+    EXPECT_EQ(chunk.getEventCount(), 8);
+}
+
+TEST(PlaybackEventSelector_TestSelect, testRegex)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.recordPattern = "^event [0-9]$";
+    filter.patternIsRegex = true;
+    EXPECT_TRUE(chl::PlaybackEventSelector::is_valid_filter(filter));
+    chl::PlaybackEventSelector selector(filter);
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerEvents(selector, chunk, 20);
+    EXPECT_EQ(chunk.getEventCount(), 10);
+
+    filter.recordPattern = "event [0-";
+    EXPECT_FALSE(chl::PlaybackEventSelector::is_valid_filter(filter));
+}
+
+TEST(PlaybackEventSelector_TestSelect, testSampleEveryNthWithLimit)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.sampleEveryNth = 3;
+    filter.limit = 4;
+    chl::PlaybackEventSelector selector(filter);
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerEvents(selector, chunk, 30);
+    EXPECT_TRUE(selector.is_exhausted());
+    ASSERT_EQ(chunk.getEventCount(), 4);
+
+    uint64_t expected_time = 100;
+    for(auto const &event_record: chunk)
+    {
+        EXPECT_EQ(event_record.second.time(), expected_time);
+        expected_time += 3;
+    }
+}
+
+TEST(PlaybackEventSelector_TestSelect, testReservoir)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.clientIds = {0};
+    filter.reservoirSize = 5;
+    chl::PlaybackEventSelector selector(filter, 42);
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerEvents(selector, chunk, 300);
+    EXPECT_EQ(selector.getMatchedCount(), 100);
+    EXPECT_EQ(chunk.getEventCount(), 5);
+    for(auto const &event_record: chunk)
+    {   EXPECT_EQ(event_record.second.getClientId(), 0); }
+}
+
+TEST(PlaybackEventSelector_TestSelect, testOverlappingRecentEventsWithSampleAndLimit)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.sampleEveryNth = 3;
+    filter.limit = 8;
+    chl::PlaybackEventSelector selector(filter);
+
+    // events 10..19 are both in the archive and still in memory
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerArchivedEvents(selector, chunk, 0, 19);
+    EXPECT_EQ(chunk.getEventCount(), 7);
+    EXPECT_TRUE(selector.isArchived(chl::EventSequence(119, 19 % 3, 19)));
+    EXPECT_FALSE(selector.isArchived(chl::EventSequence(120, 20 % 3, 20)));
+
+    chl::StoryChunk recent_chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    fillRecentEvents(recent_chunk, 10, 29);
+    selector.selectRecentEvents(recent_chunk, chunk);
+
+    // the overlapping events are offered once, so the sampling continues with event 21
+    EXPECT_TRUE(selector.is_exhausted());
+    EXPECT_EQ(selector.getMatchedCount(), 22);
+    ASSERT_EQ(chunk.getEventCount(), 8);
+    uint64_t expected_time = 100;
+    for(auto const &event_record: chunk)
+    {
+        EXPECT_EQ(event_record.second.time(), expected_time);
+        expected_time += 3;
+    }
+}
+
+TEST(PlaybackEventSelector_TestSelect, testOverlappingRecentEventsWithReservoir)
+{
+    initLogger();
+    chl::PlaybackFilter filter;
+    filter.reservoirSize = 5;
+    chl::PlaybackEventSelector selector(filter, 42);
+
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    offerArchivedEvents(selector, chunk, 0, 59);
+
+    chl::StoryChunk recent_chunk("ChronicleName", "StoryName", 1, 0, 1000);
+    fillRecentEvents(recent_chunk, 30, 99);
+    selector.selectRecentEvents(recent_chunk, chunk);
+    selector.drainReservoir(chunk);
+
+    // every event of the combined range is offered to the reservoir exactly once
+    EXPECT_EQ(selector.getMatchedCount(), 100);
+    EXPECT_EQ(chunk.getEventCount(), 5);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "RecordTemplateDictionary.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+std::vector <std::string_view> viewsOf(std::vector <std::string> const &records)
+{ return std::vector <std::string_view>(records.begin(), records.end()); }
+
+// decodes the encoded records with the encoded dictionary, the way the archive reader does
+std::vector <std::string> decodeAll(std::vector <std::string> const &encoded_records
+                                    , std::string const &encoded_dictionary)
+{
+    chl::RecordTemplateDictionary dictionary;
+    EXPECT_TRUE(dictionary.decode(encoded_dictionary));
+    std::vector <std::string> records;
+    for(auto const &encoded_record: encoded_records)
+    {
+        std::string record;
+        EXPECT_TRUE(dictionary.decodeRecord(encoded_record, record));
+        records.push_back(record);
+    }
+    return records;
+}
+
+}
+
+TEST(RecordTemplateDictionary_Test, testRepetitiveRecordsRoundTrip)
+{
+    std::vector <std::string> records;
+    for(int i = 0; i < 1000; ++i)
+    {
+        records.push_back("[rank " + std::to_string(i % 64) + "] checkpoint step=" + std::to_string(i)
+                          + " wrote " + std::to_string(i * 4096) + " bytes to /scratch/ckpt_" + std::to_string(i)
+                          + ".h5 in 0." + std::to_string(i % 10) + " secs");
+        if(i % 7 == 0)
+        { records.push_back("heartbeat from node" + std::to_string(i % 16) + " status OK"); }
+        if(i % 100 == 0)
+        { records.push_back("one of a kind message"); }
+    }
+
+    std::vector <std::string> encoded_records;
+    std::string encoded_dictionary;
+    ASSERT_TRUE(chl::RecordTemplateDictionary::encodeRecords(viewsOf(records), encoded_records, encoded_dictionary));
+    ASSERT_EQ(encoded_records.size(), records.size());
+    EXPECT_EQ(decodeAll(encoded_records, encoded_dictionary), records);
+
+    size_t record_bytes = 0;
+    size_t encoded_bytes = encoded_dictionary.size();
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        record_bytes += records[i].size();
+        encoded_bytes += encoded_records[i].size();
+    }
+    EXPECT_LT(encoded_bytes * 2, record_bytes);
+}
+
+TEST(RecordTemplateDictionary_Test, testUniqueRecordsAreNotEncoded)
+{
+    std::vector <std::string> records = {"alpha", "beta gamma", "delta epsilon zeta", "x1", "y2"};
+    std::vector <std::string> encoded_records;
+    std::string encoded_dictionary;
+    EXPECT_FALSE(chl::RecordTemplateDictionary::encodeRecords(viewsOf(records), encoded_records, encoded_dictionary));
+    EXPECT_TRUE(encoded_records.empty());
+    EXPECT_TRUE(encoded_dictionary.empty());
+}
+
+TEST(RecordTemplateDictionary_Test, testBinaryAndEmptyRecordsStayVerbatim)
+{
+    std::vector <std::string> records;
+    for(int i = 0; i < 100; ++i)
+    { records.push_back("request " + std::to_string(i) + " served from cache shard " + std::to_string(i % 3)); }
+    records.push_back(std::string("bin\0ary 1", 9));
+    records.push_back("");
+    records.push_back(std::string(1, '\x01'));
+
+    std::vector <std::string> encoded_records;
+    std::string encoded_dictionary;
+    ASSERT_TRUE(chl::RecordTemplateDictionary::encodeRecords(viewsOf(records), encoded_records, encoded_dictionary));
+    EXPECT_EQ(decodeAll(encoded_records, encoded_dictionary), records);
+}
+
+TEST(RecordTemplateDictionary_Test, testRejectsMalformedInput)
+{
+    chl::RecordTemplateDictionary dictionary;
+    EXPECT_FALSE(dictionary.decode(""));
+    EXPECT_FALSE(dictionary.decode("not a dictionary"));
+
+    std::vector <std::string> records(10, "value 1 and value 2");
+    std::vector <std::string> encoded_records;
+    std::string encoded_dictionary;
+    ASSERT_TRUE(chl::RecordTemplateDictionary::encodeRecords(viewsOf(records), encoded_records, encoded_dictionary));
+    EXPECT_FALSE(dictionary.decode(encoded_dictionary.substr(0, encoded_dictionary.size() - 1)));
+    ASSERT_TRUE(dictionary.decode(encoded_dictionary));
+    EXPECT_EQ(dictionary.getTemplateCount(), 1u);
+
+    std::string record;
+    EXPECT_FALSE(dictionary.decodeRecord("", record));
+    EXPECT_FALSE(dictionary.decodeRecord(encoded_records[0].substr(0, encoded_records[0].size() - 1), record));
+    EXPECT_FALSE(dictionary.decodeRecord(encoded_records[0] + "x", record));
+    EXPECT_FALSE(dictionary.decodeRecord(std::string("\x01\x05", 2), record));
+    EXPECT_FALSE(dictionary.decodeRecord(std::string("\x07", 1), record));
+}
@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "SharedEventRing.h"
+
+namespace chl = chronolog;
+
+// the producer and the consumer ends of one ring, both mapped by the test process
+class SharedEventRing_Test: public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        std::string log_file = (std::filesystem::temp_directory_path() / "shared_event_ring_test.log").string();
+        chl::chrono_monitor::initialize("file", log_file, spdlog::level::info, "SharedEventRingTest");
+    }
+
+    void SetUp() override
+    {
+        shmName = "/chronolog_ring_test_" + std::to_string(getpid());
+        chl::SharedEventRing::unlink(shmName);
+        producer = chl::SharedEventRing::CreateSharedEventRing(shmName, 4096);
+        ASSERT_NE(producer, nullptr);
+        consumer = chl::SharedEventRing::AttachSharedEventRing(shmName);
+        ASSERT_NE(consumer, nullptr);
+        chl::SharedEventRing::unlink(shmName);
+    }
+
+    void TearDown() override
+    {
+        delete consumer;
+        delete producer;
+    }
+
+    static chl::LogEvent makeEvent(uint32_t index, size_t record_size = 16)
+    { return chl::LogEvent(7, 1000 + index, 3, index, std::string(record_size, 'a' + index % 26)); }
+
+    std::string shmName;
+    chl::SharedEventRing*producer = nullptr;
+    chl::SharedEventRing*consumer = nullptr;
+};
+
+TEST_F(SharedEventRing_Test, testPassesEventsInOrder)
+{
+    for(uint32_t i = 0; i < 10; ++i)
+    { ASSERT_TRUE(producer->tryPush(makeEvent(i, i * 3))); }
+
+    chl::LogEvent event;
+    for(uint32_t i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(consumer->peek(event));
+        EXPECT_EQ(event, makeEvent(i, i * 3));
+        EXPECT_EQ(event.getRecord(), makeEvent(i, i * 3).getRecord());
+        consumer->pop();
+    }
+    EXPECT_FALSE(consumer->peek(event));
+    EXPECT_TRUE(consumer->isEmpty());
+}
+
+TEST_F(SharedEventRing_Test, testPeekLeavesEventInRing)
+{
+    ASSERT_TRUE(producer->tryPush(makeEvent(1)));
+    chl::LogEvent event;
+    ASSERT_TRUE(consumer->peek(event));
+    ASSERT_TRUE(consumer->peek(event));
+    EXPECT_EQ(event, makeEvent(1));
+    consumer->pop();
+    EXPECT_TRUE(consumer->isEmpty());
+}
+
+TEST_F(SharedEventRing_Test, testReportsFullRingAndWrapsAround)
+{
+    // 32 bytes of record header + 200 bytes of payload don't divide the 4096 bytes ring evenly
+    uint32_t pushed = 0;
+    while(producer->tryPush(makeEvent(pushed, 200)))
+    { pushed++; }
+    EXPECT_EQ(pushed, 4096 / 232);
+
+    chl::LogEvent event;
+    uint32_t popped = 0;
+    for(int round = 0; round < 100; ++round)
+    {
+        ASSERT_TRUE(consumer->peek(event));
+        EXPECT_EQ(event, makeEvent(popped, 200));
+        consumer->pop();
+        popped++;
+        ASSERT_TRUE(producer->tryPush(makeEvent(pushed, 200)));
+        pushed++;
+    }
+    while(consumer->peek(event))
+    {
+        EXPECT_EQ(event, makeEvent(popped, 200));
+        consumer->pop();
+        popped++;
+    }
+    EXPECT_EQ(popped, pushed);
+}
+
+TEST_F(SharedEventRing_Test, testRejectsEventsOverHalfTheRing)
+{
+    EXPECT_TRUE(producer->canHold(makeEvent(1, 2048 - 32)));
+    EXPECT_FALSE(producer->canHold(makeEvent(1, 2048)));
+    EXPECT_FALSE(producer->tryPush(makeEvent(1, 2048)));
+    EXPECT_TRUE(consumer->isEmpty());
+}
+
+TEST_F(SharedEventRing_Test, testReportsMigratedStoryOnce)
+{
+    consumer->markStoryMigrated(7);
+    EXPECT_FALSE(producer->takeStoryMigrated(8));
+    EXPECT_TRUE(producer->takeStoryMigrated(7));
+    EXPECT_FALSE(producer->takeStoryMigrated(7));
+}
+
+TEST_F(SharedEventRing_Test, testSharesConsumerStateAndClosing)
+{
+    EXPECT_TRUE(producer->isConsumerStalled(1000));
+    consumer->publishConsumerState(12345);
+    EXPECT_FALSE(producer->isConsumerStalled(1000));
+    EXPECT_EQ(producer->getConsumerClock(), 12345u);
+
+    EXPECT_FALSE(producer->isConsumerClosed());
+    consumer->closeConsumer();
+    EXPECT_TRUE(producer->isConsumerClosed());
+
+    EXPECT_FALSE(consumer->isProducerGone());
+    producer->closeProducer();
+    EXPECT_TRUE(consumer->isProducerGone());
+}
+
+TEST_F(SharedEventRing_Test, testAttachFailsWithoutValidSegment)
+{
+    EXPECT_EQ(chl::SharedEventRing::AttachSharedEventRing(shmName), nullptr);
+
+    std::string other_name = shmName + "_bad";
+    int fd = shm_open(other_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 2 * sizeof(chl::SharedEventRingHeader)), 0);
+    close(fd);
+    EXPECT_EQ(chl::SharedEventRing::AttachSharedEventRing(other_name), nullptr);
+    chl::SharedEventRing::unlink(other_name);
+}
+
+TEST_F(SharedEventRing_Test, testRecordsPastTheRingCorruptIt)
+{
+    // a second mapping of a ring stands in for the client process writing garbage into the segment
+    std::string other_name = shmName + "_corrupt";
+    chl::SharedEventRing*other_producer = chl::SharedEventRing::CreateSharedEventRing(other_name, 4096);
+    ASSERT_NE(other_producer, nullptr);
+    chl::SharedEventRing*other_consumer = chl::SharedEventRing::AttachSharedEventRing(other_name);
+    ASSERT_NE(other_consumer, nullptr);
+    int fd = shm_open(other_name.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    size_t segment_size = sizeof(chl::SharedEventRingHeader) + 4096;
+    void*segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    chl::SharedEventRing::unlink(other_name);
+    ASSERT_NE(segment, MAP_FAILED);
+    auto*first_record = reinterpret_cast<chl::SharedEventRecordHeader*>(
+            static_cast<char*>(segment) + sizeof(chl::SharedEventRingHeader));
+
+    ASSERT_TRUE(other_producer->tryPush(makeEvent(1)));
+    first_record->recordLength = 4096;
+    chl::LogEvent event;
+    EXPECT_FALSE(other_consumer->peek(event));
+    EXPECT_TRUE(other_consumer->isCorrupted());
+    // the length is fixed up too late, the consumer doesn't read the ring again
+    first_record->recordLength = 16;
+    EXPECT_FALSE(other_consumer->peek(event));
+
+    munmap(segment, segment_size);
+    delete other_consumer;
+    delete other_producer;
+
+    // the rings of the other clients carry on
+    ASSERT_TRUE(producer->tryPush(makeEvent(2)));
+    ASSERT_TRUE(consumer->peek(event));
+    EXPECT_EQ(event, makeEvent(2));
+    EXPECT_FALSE(consumer->isCorrupted());
+}
+
+TEST_F(SharedEventRing_Test, testProducerAndConsumerThreads)
+{
+    uint32_t const event_count = 100000;
+    std::thread producer_thread([this, event_count]()
+    {
+        for(uint32_t i = 0; i < event_count; ++i)
+        {
+            while(!producer->tryPush(makeEvent(i, i % 100)))
+            { std::this_thread::yield(); }
+        }
+    });
+
+    chl::LogEvent event;
+    uint32_t popped = 0;
+    while(popped < event_count)
+    {
+        if(!consumer->peek(event))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(event.index(), popped);
+        ASSERT_EQ(event.getRecord(), makeEvent(popped, popped % 100).getRecord());
+        consumer->pop();
+        popped++;
+    }
+    producer_thread.join();
+    EXPECT_TRUE(consumer->isEmpty());
+}
+
+TEST_F(SharedEventRing_Test, testProducerReclaimsUnconsumedEvents)
+{
+    // the records wrap around the end of the ring, the padding is skipped by the reclaim
+    chl::LogEvent event;
+    for(uint32_t i = 0; i < 20; ++i)
+    { ASSERT_TRUE(producer->tryPush(makeEvent(i, 150))); }
+    for(uint32_t i = 0; i < 20; ++i)
+    {
+        ASSERT_TRUE(consumer->peek(event));
+        ASSERT_TRUE(consumer->pop());
+    }
+    for(uint32_t i = 20; i < 40; ++i)
+    { ASSERT_TRUE(producer->tryPush(makeEvent(i, 150))); }
+    ASSERT_TRUE(consumer->peek(event));
+    ASSERT_TRUE(consumer->pop());
+
+    producer->closeProducer();
+    for(uint32_t i = 21; i < 40; ++i)
+    {
+        ASSERT_TRUE(producer->reclaim(event));
+        EXPECT_EQ(event, makeEvent(i, 150));
+        EXPECT_EQ(event.getRecord(), makeEvent(i, 150).getRecord());
+    }
+    EXPECT_FALSE(producer->reclaim(event));
+    EXPECT_FALSE(consumer->peek(event));
+    EXPECT_TRUE(consumer->isEmpty());
+    EXPECT_FALSE(consumer->isCorrupted());
+}
+
+TEST_F(SharedEventRing_Test, testReclaimedEventIsNotConsumed)
+{
+    ASSERT_TRUE(producer->tryPush(makeEvent(1)));
+    ASSERT_TRUE(producer->tryPush(makeEvent(2)));
+    chl::LogEvent event;
+    ASSERT_TRUE(consumer->peek(event));
+
+    producer->closeProducer();
+    chl::LogEvent reclaimed_event;
+    ASSERT_TRUE(producer->reclaim(reclaimed_event));
+    EXPECT_EQ(reclaimed_event, makeEvent(1));
+    EXPECT_FALSE(consumer->pop());
+
+    ASSERT_TRUE(consumer->peek(event));
+    EXPECT_EQ(event, makeEvent(2));
+    EXPECT_TRUE(consumer->pop());
+    EXPECT_FALSE(producer->reclaim(reclaimed_event));
+}
+
+TEST_F(SharedEventRing_Test, testEventIsConsumedOrReclaimedOnce)
+{
+    uint32_t const event_count = 100000;
+    std::vector <uint32_t> consumed_indexes;
+    std::vector <uint32_t> reclaimed_indexes;
+    std::atomic <bool> producer_closed{false};
+    std::thread consumer_thread([&]()
+    {
+        chl::LogEvent event;
+        while(!producer_closed || !consumer->isEmpty())
+        {
+            if(consumer->peek(event) && consumer->pop())
+            { consumed_indexes.push_back(event.index()); }
+        }
+    });
+
+    // the producer gives up on the consumer half way through
+    for(uint32_t i = 0; i < event_count / 2; ++i)
+    {
+        while(!producer->tryPush(makeEvent(i, i % 100)))
+        { std::this_thread::yield(); }
+    }
+    producer->closeProducer();
+    producer_closed = true;
+    chl::LogEvent event;
+    while(producer->reclaim(event))
+    { reclaimed_indexes.push_back(event.index()); }
+    consumer_thread.join();
+
+    // the consumed events are followed by the reclaimed ones, every event exactly once and in order
+    std::vector <uint32_t> all_indexes(consumed_indexes);
+    all_indexes.insert(all_indexes.end(), reclaimed_indexes.begin(), reclaimed_indexes.end());
+    ASSERT_EQ(all_indexes.size(), event_count / 2);
+    for(uint32_t i = 0; i < event_count / 2; ++i)
+    { ASSERT_EQ(all_indexes[i], i); }
+}
@@ -0,0 +1,155 @@
+#include "StoryAggregator.h"
+#include "client_errcode.h"
+#include "chrono_monitor.h"
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+namespace chl = chronolog;
+
+static uint64_t const SECOND = 1000000000;
+
+static void initLogger()
+{
+    int ret = chl::chrono_monitor::initialize("console", "", spdlog::level::debug, "unit_test_logger");
+    ASSERT_EQ(ret, 0);
+}
+
+// one event every 100ms over [0, seconds[ , clientId alternates between 1 and 2, record holds the event number
+struct EventColumns
+{
+    std::vector <std::string> recordStore;
+    std::vector <chl::chrono_time> times;
+    std::vector <chl::ClientId> clientIds;
+    std::vector <std::string_view> records;
+
+    explicit EventColumns(int seconds)
+    {
+        for(int i = 0; i < seconds * 10; ++i)
+        { recordStore.push_back(std::to_string(i)); }
+        for(int i = 0; i < seconds * 10; ++i)
+        {
+            times.push_back(i * SECOND / 10);
+            clientIds.push_back(1 + i % 2);
+            records.emplace_back(recordStore[i]);
+        }
+    }
+};
+
+/* ----------------------------------
+  Tests on QuantileSketch
+  ---------------------------------- */
+
+TEST(StoryAggregator_TestQuantileSketch, testRelativeAccuracy)
+{
+    chl::QuantileSketch sketch(0.01);
+    for(int i = 1; i <= 10000; ++i)
+    { sketch.add(i); }
+    sketch.add(-5);
+    sketch.add(0);
+
+    EXPECT_EQ(sketch.count(), 10002);
+    EXPECT_NEAR(sketch.quantile(0.5), 4999, 4999 * 0.01);
+    EXPECT_NEAR(sketch.quantile(0.99), 9899, 9899 * 0.01);
+    EXPECT_NEAR(sketch.quantile(0), -5, 5 * 0.01);
+
+    chl::QuantileSketch other(0.01);
+    for(int i = 10001; i <= 20000; ++i)
+    { other.add(i); }
+    sketch.merge(other);
+    EXPECT_NEAR(sketch.quantile(0.5), 10000, 10000 * 0.01);
+}
+
+/* ----------------------------------
+  Tests on StoryAggregator
+  ---------------------------------- */
+
+TEST(StoryAggregator_TestAggregate, testValidateQuery)
+{
+    chl::AggregationQuery query;
+    EXPECT_EQ(chl::StoryAggregator::validateQuery(query, 0, 10 * SECOND), chl::CL_SUCCESS);
+    EXPECT_EQ(chl::StoryAggregator::validateQuery(query, 10 * SECOND, 10 * SECOND), chl::CL_ERR_INVALID_ARG);
+    query.quantiles = {0.5, 1.5};
+    EXPECT_EQ(chl::StoryAggregator::validateQuery(query, 0, 10 * SECOND), chl::CL_ERR_INVALID_ARG);
+    query.quantiles.clear();
+    query.bucketWidth = 0;
+    EXPECT_EQ(chl::StoryAggregator::validateQuery(query, 0, 10 * SECOND), chl::CL_ERR_INVALID_ARG);
+}
+
+TEST(StoryAggregator_TestAggregate, testParseNumericRecord)
+{
+    double value = 0;
+    EXPECT_TRUE(chl::StoryAggregator::parseNumericRecord(" 42.5\n", value));
+    EXPECT_DOUBLE_EQ(value, 42.5);
+    EXPECT_TRUE(chl::StoryAggregator::parseNumericRecord("+1e3", value));
+    EXPECT_DOUBLE_EQ(value, 1000);
+    EXPECT_FALSE(chl::StoryAggregator::parseNumericRecord("42 apples", value));
+    EXPECT_FALSE(chl::StoryAggregator::parseNumericRecord("", value));
+}
+
+TEST(StoryAggregator_TestAggregate, testCountOnlyBuckets)
+{
+    initLogger();
+    EventColumns columns(10);
+    chl::AggregationQuery query;
+    query.numericStats = false;
+    // query range starts in the middle of the generated events
+    chl::StoryAggregator aggregator(query, 2 * SECOND, 8 * SECOND);
+    aggregator.aggregateEvents(columns.times, columns.clientIds, columns.records);
+
+    std::vector <chl::AggregationBucket> buckets;
+    aggregator.getResults(buckets);
+    ASSERT_EQ(buckets.size(), 6);
+    EXPECT_EQ(aggregator.getEventCount(), 60);
+    for(size_t i = 0; i < buckets.size(); ++i)
+    {
+        EXPECT_EQ(buckets[i].bucketStart, (2 + i) * SECOND);
+        EXPECT_EQ(buckets[i].eventCount, 10);
+        EXPECT_EQ(buckets[i].valueCount, 0);
+    }
+}
+
+TEST(StoryAggregator_TestAggregate, testNumericStatsGroupedByClient)
+{
+    initLogger();
+    EventColumns columns(2);
+    chl::AggregationQuery query;
+    query.groupByClient = true;
+    query.quantiles = {0.5};
+    chl::StoryAggregator aggregator(query, 0, 2 * SECOND);
+    aggregator.aggregateEvents(columns.times, columns.clientIds, columns.records);
+
+    std::vector <chl::AggregationBucket> buckets;
+    aggregator.getResults(buckets);
+    ASSERT_EQ(buckets.size(), 4);
+
+    // first second, client 1 : events 0,2,4,6,8
+    EXPECT_EQ(buckets[0].bucketStart, 0);
+    EXPECT_EQ(buckets[0].clientId, 1);
+    EXPECT_EQ(buckets[0].eventCount, 5);
+    EXPECT_EQ(buckets[0].valueCount, 5);
+    EXPECT_DOUBLE_EQ(buckets[0].sum, 20);
+    EXPECT_DOUBLE_EQ(buckets[0].min, 0);
+    EXPECT_DOUBLE_EQ(buckets[0].max, 8);
+    ASSERT_EQ(buckets[0].quantileValues.size(), 1);
+    EXPECT_NEAR(buckets[0].quantileValues[0], 4, 4 * 0.01);
+
+    // second second, client 2 : events 11,13,15,17,19
+    EXPECT_EQ(buckets[3].bucketStart, SECOND);
+    EXPECT_EQ(buckets[3].clientId, 2);
+    EXPECT_DOUBLE_EQ(buckets[3].sum, 75);
+    EXPECT_DOUBLE_EQ(buckets[3].min, 11);
+    EXPECT_DOUBLE_EQ(buckets[3].max, 19);
+}
+
+TEST(StoryAggregator_TestAggregate, testArchiveHorizon)
+{
+    chl::AggregationQuery query;
+    chl::StoryAggregator aggregator(query, 0, 10 * SECOND);
+    EXPECT_FALSE(aggregator.isArchived(chl::EventSequence(0, 0, 0)));
+
+    aggregator.advanceArchiveHorizon(chl::EventSequence(5 * SECOND, 1, 3));
+    aggregator.advanceArchiveHorizon(chl::EventSequence(2 * SECOND, 1, 0));
+    EXPECT_TRUE(aggregator.isArchived(chl::EventSequence(5 * SECOND, 1, 3)));
+    EXPECT_TRUE(aggregator.isArchived(chl::EventSequence(4 * SECOND, 7, 9)));
+    EXPECT_FALSE(aggregator.isArchived(chl::EventSequence(5 * SECOND, 1, 4)));
+}
@@ -0,0 +1,161 @@
+#include "StoryChunkSummary.h"
+#include "chrono_monitor.h"
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+namespace chl = chronolog;
+
+static void initLogger()
+{
+    int ret = chl::chrono_monitor::initialize("console", "", spdlog::level::debug, "unit_test_logger");
+    ASSERT_EQ(ret, 0);
+}
+
+/* ----------------------------------
+  Tests on HyperLogLogSketch
+  ---------------------------------- */
+
+TEST(StoryChunkSummary_TestHyperLogLog, testEstimate)
+{
+    chl::HyperLogLogSketch small_sketch;
+    for(int repeat = 0; repeat < 3; ++repeat)
+    {
+        for(uint64_t i = 1; i <= 100; ++i)
+        { small_sketch.add(i); }
+    }
+    EXPECT_NEAR(small_sketch.estimate(), 100, 10);
+
+    chl::HyperLogLogSketch large_sketch;
+    for(uint64_t i = 1; i <= 100000; ++i)
+    { large_sketch.add(i); }
+    // standard error of 1024 registers is ~3.3%
+    EXPECT_NEAR(large_sketch.estimate(), 100000, 100000 * 0.1);
+}
+
+TEST(StoryChunkSummary_TestHyperLogLog, testMergeAndEncode)
+{
+    chl::HyperLogLogSketch first;
+    chl::HyperLogLogSketch second;
+    for(uint64_t i = 0; i < 20000; ++i)
+    { first.add(i); }
+    for(uint64_t i = 10000; i < 30000; ++i)
+    { second.add(i); }
+    first.merge(second);
+    EXPECT_NEAR(first.estimate(), 30000, 30000 * 0.1);
+
+    std::string buffer;
+    first.encode(buffer);
+    std::string_view encoded(buffer);
+    chl::HyperLogLogSketch decoded(4);
+    ASSERT_TRUE(decoded.decode(encoded));
+    EXPECT_TRUE(encoded.empty());
+    EXPECT_DOUBLE_EQ(decoded.estimate(), first.estimate());
+}
+
+/* ----------------------------------
+  Tests on StoryChunkSummary
+  ---------------------------------- */
+
+TEST(StoryChunkSummary_TestSummary, testStatistics)
+{
+    initLogger();
+    chl::StoryChunkSummary summary;
+    EXPECT_TRUE(summary.empty());
+
+    for(uint64_t i = 0; i < 100; ++i)
+    { summary.addEvent(1000 + i, 1 + i % 4, i, 10 + i); }
+
+    chl::StoryStatistics statistics;
+    summary.getStatistics(statistics);
+    EXPECT_EQ(statistics.eventCount, 100);
+    EXPECT_EQ(statistics.firstEventTime, 1000);
+    EXPECT_EQ(statistics.lastEventTime, 1099);
+    EXPECT_EQ(statistics.recordBytes, 100 * 10 + 99 * 100 / 2);
+    EXPECT_EQ(statistics.minRecordSize, 10);
+    EXPECT_EQ(statistics.maxRecordSize, 109);
+    EXPECT_EQ(statistics.distinctClients, 4);
+    ASSERT_EQ(statistics.clientEventCounts.size(), 4);
+    EXPECT_EQ(statistics.clientEventCounts[1], 25);
+    ASSERT_EQ(statistics.recordSizeQuantiles.size(), 3);
+    EXPECT_NEAR(statistics.recordSizeQuantiles[0], 59, 59 * 0.02);
+}
+
+TEST(StoryChunkSummary_TestSummary, testMergeMatchesSingleSummary)
+{
+    chl::StoryChunkSummary whole;
+    chl::StoryChunkSummary first_half;
+    chl::StoryChunkSummary second_half;
+    for(uint64_t i = 0; i < 2000; ++i)
+    {
+        whole.addEvent(i, i % 50, i, i % 300);
+        (i < 1000 ? first_half : second_half).addEvent(i, i % 50, i, i % 300);
+    }
+
+    chl::StoryChunkSummary merged;
+    merged.merge(second_half);
+    merged.merge(first_half);
+
+    chl::StoryStatistics expected;
+    chl::StoryStatistics actual;
+    whole.getStatistics(expected);
+    merged.getStatistics(actual);
+    EXPECT_EQ(actual.eventCount, expected.eventCount);
+    EXPECT_EQ(actual.firstEventTime, 0);
+    EXPECT_EQ(actual.lastEventTime, 1999);
+    EXPECT_EQ(actual.recordBytes, expected.recordBytes);
+    EXPECT_EQ(actual.minRecordSize, expected.minRecordSize);
+    EXPECT_EQ(actual.maxRecordSize, expected.maxRecordSize);
+    EXPECT_EQ(actual.distinctClients, 50);
+    EXPECT_EQ(actual.clientEventCounts, expected.clientEventCounts);
+    EXPECT_EQ(actual.recordSizeQuantiles, expected.recordSizeQuantiles);
+    EXPECT_EQ(merged.getLastEventSequence(), whole.getLastEventSequence());
+}
+
+TEST(StoryChunkSummary_TestSummary, testLastEventSequence)
+{
+    chl::StoryChunkSummary summary;
+    summary.addEvent(2000, 7, 3, 10);
+    summary.addEvent(2000, 9, 1, 10);
+    summary.addEvent(1000, 11, 5, 10);
+    summary.addEvent(2000, 9, 0, 10);
+    EXPECT_EQ(summary.getLastEventTime(), 2000);
+    EXPECT_EQ(summary.getLastEventSequence(), chl::EventSequence(2000, 9, 1));
+}
+
+TEST(StoryChunkSummary_TestSummary, testEncodeDecode)
+{
+    chl::StoryChunkSummary summary;
+    for(uint64_t i = 0; i < 5000; ++i)
+    { summary.addEvent(i * 1000, i % 2000, i, i % 128); }
+
+    std::string encoded = summary.encode();
+    chl::StoryChunkSummary decoded;
+    ASSERT_TRUE(decoded.decode(encoded));
+
+    chl::StoryStatistics expected;
+    chl::StoryStatistics actual;
+    summary.getStatistics(expected);
+    decoded.getStatistics(actual);
+    EXPECT_EQ(actual.eventCount, expected.eventCount);
+    EXPECT_EQ(actual.lastEventTime, expected.lastEventTime);
+    EXPECT_EQ(actual.recordBytes, expected.recordBytes);
+    EXPECT_EQ(actual.clientEventCounts, expected.clientEventCounts);
+    EXPECT_EQ(actual.recordSizeQuantiles, expected.recordSizeQuantiles);
+    // per client counts are capped, the distinct count comes from the HyperLogLog sketch
+    EXPECT_NEAR(actual.distinctClients, 2000, 2000 * 0.1);
+    EXPECT_EQ(actual.distinctClients, expected.distinctClients);
+
+    EXPECT_EQ(decoded.getLastEventSequence(), summary.getLastEventSequence());
+
+    // the version 1 summary has no last event clientId and eventIndex, it covers all the events of its last time
+    std::string encoded_v1 = encoded.substr(0, encoded.size() - sizeof(chl::ClientId) - sizeof(chl::chrono_index));
+    uint32_t version = 1;
+    encoded_v1.replace(sizeof(uint32_t), sizeof(version), reinterpret_cast<char const *>(&version), sizeof(version));
+    chl::StoryChunkSummary decoded_v1;
+    ASSERT_TRUE(decoded_v1.decode(encoded_v1));
+    EXPECT_EQ(decoded_v1.getEventCount(), summary.getEventCount());
+    EXPECT_FALSE(decoded_v1.getLastEventSequence() < chl::EventSequence(summary.getLastEventTime(), 1999, 4999));
+
+    EXPECT_FALSE(decoded.decode(std::string_view(encoded).substr(0, encoded.size() / 2)));
+    EXPECT_FALSE(decoded.decode("not a summary"));
+}
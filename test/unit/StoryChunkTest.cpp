@@ -772,6 +772,32 @@ TEST(StoryChunk_TestMergeEvents, testMergeExactBoundaryNoOverlap)
     EXPECT_EQ(other.getEventCount(), 2);
 }
 
+// merging overlapping chunks (e.g. archived and in-memory copies of the same events)
+// keeps a single copy of the events present in both
+TEST(StoryChunk_TestMergeEvents, testMergeOverlappingChunksNoDuplicates)
+{
+    initLogger();
+    chl::StoryChunk result("ChronicleName", "StoryName", 1, 100, 300, 10),
+            archived("ChronicleName", "StoryName", 1, 100, 200, 10),
+            recent("ChronicleName", "StoryName", 1, 150, 300, 10);
+    archived.insertEvent({1, 120, 0, 0, "Archived"});
+    archived.insertEvent({1, 160, 0, 0, "Both"});
+    archived.insertEvent({1, 160, 1, 0, "Both"});
+    recent.insertEvent({1, 160, 0, 0, "Both"});
+    recent.insertEvent({1, 160, 1, 0, "Both"});
+    recent.insertEvent({1, 250, 0, 0, "Recent"});
+
+    result.mergeEvents(archived);
+    result.mergeEvents(recent);
+    EXPECT_EQ(result.getEventCount(), 4);
+
+    std::vector<chl::Event> series;
+    result.extractEventSeries(series);
+    ASSERT_EVENTS_ORDERED(series);
+    EXPECT_EQ(series.front().time(), 120);
+    EXPECT_EQ(series.back().time(), 250);
+}
+
 /* ----------------------------------
   Tests on eraseEvents()
   ---------------------------------- */
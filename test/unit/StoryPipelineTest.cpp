@@ -0,0 +1,95 @@
+#include "StoryPipeline.h"
+#include "StoryChunkExtractionQueue.h"
+#include "chrono_monitor.h"
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+namespace chl = chronolog;
+
+static uint64_t const SECOND = 1000000000;
+// story start time aligned to the 60 seconds chunk granularity
+static uint64_t const STORY_START = 1000 * 60 * SECOND;
+
+static void initLogger()
+{
+    int ret = chl::chrono_monitor::initialize("console", "", spdlog::level::debug, "unit_test_logger");
+    ASSERT_EQ(ret, 0);
+}
+
+/* ----------------------------------
+  Tests on copyEvents()
+  ---------------------------------- */
+
+// events in the requested range are copied and the pipeline is left intact
+TEST(StoryPipeline_TestCopyEvents, testCopyEventsInRange)
+{
+    initLogger();
+    chl::StoryChunkExtractionQueue extractionQueue;
+    chl::StoryPipeline pipeline(extractionQueue, "ChronicleName", "StoryName", 1, STORY_START, 60, 120);
+
+    chl::StoryChunk incoming("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 180 * SECOND);
+    incoming.insertEvent({1, STORY_START + 10 * SECOND, 0, 0, "first"});
+    incoming.insertEvent({1, STORY_START + 70 * SECOND, 0, 1, "second"});
+    incoming.insertEvent({1, STORY_START + 130 * SECOND, 0, 2, "third"});
+    pipeline.mergeEvents(incoming);
+    EXPECT_TRUE(incoming.empty());
+
+    chl::StoryChunk target("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 180 * SECOND);
+    EXPECT_EQ(pipeline.copyEvents(target, STORY_START + 5 * SECOND, STORY_START + 100 * SECOND), 2);
+    EXPECT_EQ(target.getEventCount(), 2);
+
+    // copying again returns the same events, nothing was removed from the pipeline
+    chl::StoryChunk second_target("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 180 * SECOND);
+    EXPECT_EQ(pipeline.copyEvents(second_target, STORY_START, STORY_START + 180 * SECOND), 3);
+}
+
+// range outside of the pipeline timeline yields no events
+TEST(StoryPipeline_TestCopyEvents, testCopyEventsOutsideTimeline)
+{
+    initLogger();
+    chl::StoryChunkExtractionQueue extractionQueue;
+    chl::StoryPipeline pipeline(extractionQueue, "ChronicleName", "StoryName", 1, STORY_START, 60, 120);
+
+    chl::StoryChunk incoming("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 60 * SECOND);
+    incoming.insertEvent({1, STORY_START + 10 * SECOND, 0, 0, "first"});
+    pipeline.mergeEvents(incoming);
+
+    chl::StoryChunk target("ChronicleName", "StoryName", 1, STORY_START - 100 * SECOND, STORY_START);
+    EXPECT_EQ(pipeline.copyEvents(target, STORY_START - 100 * SECOND, STORY_START), 0);
+    EXPECT_TRUE(target.empty());
+}
+
+/* ----------------------------------
+  Tests on the sharded story pipeline
+  ---------------------------------- */
+
+// the chunks extracted by the pipeline of a story shard carry its shard index for the archive file naming
+TEST(StoryPipeline_TestShardIndex, testExtractedChunksCarryShardIndex)
+{
+    initLogger();
+    chl::StoryChunkExtractionQueue extractionQueue;
+    {
+        chl::StoryPipeline pipeline(extractionQueue, "ChronicleName", "StoryName", 1, STORY_START, 60, 120, 2);
+        EXPECT_EQ(pipeline.getShardIndex(), 2u);
+
+        chl::StoryChunk incoming("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 240 * SECOND);
+        incoming.insertEvent({1, STORY_START + 10 * SECOND, 0, 0, "first"});
+        incoming.insertEvent({1, STORY_START + 200 * SECOND, 0, 1, "second"});
+        pipeline.mergeEvents(incoming);
+
+        pipeline.extractDecayedStoryChunks(STORY_START + 1000 * SECOND);
+    }
+
+    ASSERT_EQ(extractionQueue.size(), 2);
+    while(!extractionQueue.empty())
+    {
+        chl::StoryChunk *chunk = extractionQueue.ejectStoryChunk();
+        ASSERT_NE(chunk, nullptr);
+        EXPECT_EQ(chunk->getShardIndex(), 2u);
+        delete chunk;
+    }
+
+    // the chunks of the unsharded story belong to shard 0
+    chl::StoryChunk chunk("ChronicleName", "StoryName", 1, STORY_START, STORY_START + 60 * SECOND);
+    EXPECT_EQ(chunk.getShardIndex(), 0u);
+}
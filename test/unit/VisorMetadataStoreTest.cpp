@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+
+#include "ChronicleMetaDirectory.h"
+#include "VisorMetadataStore.h"
+#include "chrono_monitor.h"
+#include "chronolog_errcode.h"
+
+namespace chl = chronolog;
+
+namespace
+{
+
+class VisorMetadataStoreTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        static bool logger_initialized = false;
+        if(!logger_initialized)
+        {
+            ASSERT_EQ(chl::chrono_monitor::initialize("console", "", spdlog::level::warn, "unit_test_logger"), 0);
+            logger_initialized = true;
+        }
+        storeDir = (std::filesystem::temp_directory_path() /
+                    ("visor_metadata_store_test_" + std::to_string(getpid()))).string();
+        std::filesystem::remove_all(storeDir);
+    }
+
+    void TearDown() override
+    { std::filesystem::remove_all(storeDir); }
+
+    std::unique_ptr <chl::VisorMetadataStore> openStore(uint64_t snapshot_interval_records = 1000)
+    {
+        std::unique_ptr <chl::VisorMetadataStore> store(
+                chl::VisorMetadataStore::CreateVisorMetadataStore(storeDir, snapshot_interval_records));
+        EXPECT_NE(store, nullptr);
+        EXPECT_EQ(store->recover(), chl::CL_SUCCESS);
+        return store;
+    }
+
+    std::string storeDir;
+};
+
+chl::StoryRecordingRecord makeRecording(chl::StoryId story_id, std::vector <chl::RecordingGroupId> const &groups)
+{
+    chl::StoryRecordingRecord recording;
+    recording.storyId = story_id;
+    recording.chronicleName = "chronicle";
+    recording.storyName = "story_" + std::to_string(story_id);
+    recording.shardGroups = groups;
+    return recording;
+}
+
+}
+
+TEST_F(VisorMetadataStoreTest, testRecoverLoggedChanges)
+{
+    {
+        auto store = openStore();
+        store->logChronicleCreated("chronicle");
+        store->logChronicleCreated("gone");
+        store->logChronicleAttrEdited("chronicle", "Priority", "High");
+        store->logStoryCreated("chronicle", "story_1", {{"TieringPolicy", "Hot"}});
+        store->logStoryCreated("chronicle", "story_2", {});
+        store->logStoryCreated("gone", "story_3", {});
+        store->logStoryDestroyed("chronicle", "story_2");
+        store->logChronicleDestroyed("gone");
+        store->logStoryRecordingStarted(makeRecording(1, {7}));
+        store->logStoryRecordingStarted(makeRecording(2, {3, 4}));
+        store->logStoryRecordingStopped(2);
+        // the migrated story is recorded by the new group
+        store->logStoryRecordingStarted(makeRecording(1, {9}));
+    }
+
+    auto store = openStore();
+    ASSERT_EQ(store->getChronicles().size(), 1u);
+    auto const &chronicle = store->getChronicles().at("chronicle");
+    EXPECT_EQ(chronicle.properties.at("Priority"), "High");
+    ASSERT_EQ(chronicle.stories.size(), 1u);
+    EXPECT_EQ(chronicle.stories.at("story_1").at("TieringPolicy"), "Hot");
+    EXPECT_EQ(store->getStoryCount(), 1u);
+
+    ASSERT_EQ(store->getStoryRecordings().size(), 1u);
+    EXPECT_EQ(store->getStoryRecordings().at(1).storyName, "story_1");
+    EXPECT_EQ(store->getStoryRecordings().at(1).shardGroups, std::vector <chl::RecordingGroupId>({9}));
+}
+
+TEST_F(VisorMetadataStoreTest, testTornLogTailIsCutOff)
+{
+    {
+        auto store = openStore();
+        store->logChronicleCreated("chronicle");
+        store->logStoryCreated("chronicle", "story_1", {});
+    }
+    // the Visor crashed in the middle of appending a record
+    {
+        std::ofstream log_file(storeDir + "/visor_metadata.log", std::ios::binary | std::ios::app);
+        log_file.write("\x30\x00\x00\x00\x01\x02\x03", 7);
+    }
+
+    {
+        auto store = openStore();
+        EXPECT_EQ(store->getStoryCount(), 1u);
+        store->logStoryCreated("chronicle", "story_2", {});
+    }
+
+    // the records appended after the recovery follow the last intact record
+    auto store = openStore();
+    EXPECT_EQ(store->getStoryCount(), 2u);
+}
+
+TEST_F(VisorMetadataStoreTest, testSnapshotTruncatesLog)
+{
+    {
+        auto store = openStore(4);
+        store->logChronicleCreated("chronicle");
+        for(int i = 0; i < 3; ++i)
+        { store->logStoryCreated("chronicle", "story_" + std::to_string(i), {}); }
+        store->logStoryRecordingStarted(makeRecording(1, {2}));
+        EXPECT_EQ(store->snapshotIfDue(), chl::CL_SUCCESS);
+        EXPECT_EQ(std::filesystem::file_size(storeDir + "/visor_metadata.log"), 0u);
+
+        store->logStoryDestroyed("chronicle", "story_0");
+        store->logStoryRecordingStopped(1);
+    }
+
+    auto store = openStore();
+    EXPECT_EQ(store->getStoryCount(), 2u);
+    EXPECT_TRUE(store->getStoryRecordings().empty());
+}
+
+TEST_F(VisorMetadataStoreTest, testReplayOfSnapshottedLog)
+{
+    // the Visor stopped after the snapshot rename but before the log truncation:
+    // replaying the old log over the snapshot ends in the same state
+    {
+        auto store = openStore();
+        store->logChronicleCreated("chronicle");
+        store->logStoryCreated("chronicle", "story_1", {});
+        store->logStoryDestroyed("chronicle", "story_1");
+        store->logStoryCreated("chronicle", "story_2", {});
+    }
+    std::filesystem::copy_file(storeDir + "/visor_metadata.log", storeDir + "/saved.log");
+    {
+        auto store = openStore();
+        EXPECT_EQ(store->writeSnapshot(), chl::CL_SUCCESS);
+    }
+    std::filesystem::copy_file(storeDir + "/saved.log", storeDir + "/visor_metadata.log"
+                               , std::filesystem::copy_options::overwrite_existing);
+
+    auto store = openStore();
+    auto const &stories = store->getChronicles().at("chronicle").stories;
+    ASSERT_EQ(stories.size(), 1u);
+    EXPECT_EQ(stories.count("story_2"), 1u);
+}
+
+// the records of the concurrent ChronicleMetaDirectory changes are appended after the chronicle locks are released,
+// the changes of each chronicle still reach the log in the order they were applied
+TEST_F(VisorMetadataStoreTest, testDirectoryChangesAreLoggedInOrder)
+{
+    size_t const thread_count = 8;
+    size_t const change_count = 200;
+    std::string last_editor;
+    {
+        auto store = openStore(thread_count * change_count * 4);
+        ChronicleMetaDirectory chronicle_directory;
+        chronicle_directory.set_metadata_store(store.get());
+        ASSERT_EQ(chronicle_directory.create_chronicle("shared", {{"Editor", "none"}}), chl::CL_SUCCESS);
+
+        std::vector <std::thread> threads;
+        for(size_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&chronicle_directory, t, change_count]()
+            {
+                std::string chronicle_name = "chronicle_" + std::to_string(t);
+                for(size_t i = 0; i < change_count; ++i)
+                {
+                    chronicle_directory.create_chronicle(chronicle_name, {});
+                    chronicle_directory.destroy_chronicle(chronicle_name);
+                    chronicle_directory.edit_chronicle_attr("shared", "Editor"
+                                                            , std::to_string(t) + "_" + std::to_string(i));
+                }
+                chronicle_directory.create_chronicle(chronicle_name, {});
+            });
+        }
+        for(auto &thread: threads)
+        { thread.join(); }
+
+        EXPECT_EQ(chronicle_directory.get_chronicle_attr("shared", "Editor", last_editor), chl::CL_SUCCESS);
+    }
+
+    auto store = openStore();
+    EXPECT_EQ(store->getChronicles().size(), thread_count + 1);
+    EXPECT_EQ(store->getChronicles().at("shared").properties.at("Editor"), last_editor);
+}
+
+// the Visor metadata of 10^6 stories is recovered from the snapshot and rebuilt into the ChronicleMetaDirectory;
+// the startup time is reported, not asserted, it depends on the build type and the machine
+TEST_F(VisorMetadataStoreTest, testRecoveryOfMillionStories)
+{
+    size_t const chronicle_count = 1000;
+    size_t const stories_per_chronicle = 1000;
+    {
+        auto store = openStore(chronicle_count * stories_per_chronicle * 2);
+        for(size_t c = 0; c < chronicle_count; ++c)
+        {
+            std::string chronicle_name = "chronicle_" + std::to_string(c);
+            store->logChronicleCreated(chronicle_name);
+            for(size_t s = 0; s < stories_per_chronicle; ++s)
+            {
+                store->logStoryCreated(chronicle_name, "story_" + std::to_string(s)
+                                       , {{"Priority", "High"}, {"TieringPolicy", "Hot"}});
+            }
+        }
+        ASSERT_EQ(store->writeSnapshot(), chl::CL_SUCCESS);
+    }
+
+    auto recovery_start = std::chrono::steady_clock::now();
+    auto store = openStore();
+    auto restore_start = std::chrono::steady_clock::now();
+    ChronicleMetaDirectory chronicle_directory;
+    EXPECT_EQ(chronicle_directory.restore_from_metadata_store(*store), chl::CL_SUCCESS);
+    auto restore_end = std::chrono::steady_clock::now();
+    std::chrono::duration <double> recovery_time = restore_start - recovery_start;
+    std::chrono::duration <double> restore_time = restore_end - restore_start;
+    std::cout << "[VisorMetadataStoreTest] recovered " << store->getStoryCount() << " stories in "
+              << recovery_time.count() << " s, restored the ChronicleMetaDirectory in " << restore_time.count()
+              << " s" << std::endl;
+
+    EXPECT_EQ(store->getStoryCount(), chronicle_count * stories_per_chronicle);
+    std::vector <std::string> chronicle_names;
+    chronicle_directory.show_chronicles(chronicle_names);
+    EXPECT_EQ(chronicle_names.size(), chronicle_count);
+    std::vector <std::string> story_names;
+    EXPECT_EQ(chronicle_directory.show_stories("chronicle_999", story_names), chl::CL_SUCCESS);
+    EXPECT_EQ(story_names.size(), stories_per_chronicle);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chrono_monitor.h"
+#include "client_errcode.h"
+#include "WorkloadTrace.h"
+
+namespace chl = chronolog;
+
+class WorkloadTrace_Test: public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        std::string log_file = (std::filesystem::temp_directory_path() / "workload_trace_test.log").string();
+        chl::chrono_monitor::initialize("file", log_file, spdlog::level::info, "WorkloadTraceTest");
+    }
+
+    void SetUp() override
+    {
+        traceFile = (std::filesystem::temp_directory_path() / ("workload_trace_test_" + std::string(
+                ::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".clwt")).string();
+    }
+
+    void TearDown() override
+    { std::filesystem::remove(traceFile); }
+
+    // captures acquire, two events and release of one story
+    void captureWorkload(bool keep_payloads)
+    {
+        chl::WorkloadTraceWriter*traceWriter = chl::WorkloadTraceWriter::CreateWorkloadTraceWriter(traceFile
+                                                                                                  , keep_payloads);
+        ASSERT_NE(traceWriter, nullptr);
+        traceWriter->recordAcquireStory("chronicle", "story", 11);
+        traceWriter->recordEvent(11, "first");
+        traceWriter->recordEvent(11, std::string(300, 'x'));
+        traceWriter->recordReleaseStory("chronicle", "story");
+        EXPECT_EQ(traceWriter->getRecordCount(), 4u);
+        delete traceWriter;
+    }
+
+    std::vector <chl::WorkloadRecord> readWorkload(bool &has_payloads)
+    {
+        std::vector <chl::WorkloadRecord> records;
+        chl::WorkloadTraceReader*traceReader = chl::WorkloadTraceReader::CreateWorkloadTraceReader(traceFile);
+        if(traceReader == nullptr)
+        { return records; }
+        has_payloads = traceReader->hasPayloads();
+        EXPECT_GT(traceReader->getCaptureStartTime(), 0u);
+        chl::WorkloadRecord record;
+        while(traceReader->readRecord(record) == chl::CL_SUCCESS)
+        { records.push_back(record); }
+        delete traceReader;
+        return records;
+    }
+
+    std::string traceFile;
+};
+
+TEST_F(WorkloadTrace_Test, testRoundTripWithPayloads)
+{
+    captureWorkload(true);
+    bool has_payloads = false;
+    std::vector <chl::WorkloadRecord> records = readWorkload(has_payloads);
+
+    EXPECT_TRUE(has_payloads);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].type, chl::WORKLOAD_ACQUIRE_STORY);
+    EXPECT_EQ(records[0].chronicleName, "chronicle");
+    EXPECT_EQ(records[0].storyName, "story");
+    EXPECT_EQ(records[1].type, chl::WORKLOAD_LOG_EVENT);
+    EXPECT_EQ(records[1].payloadSize, 5u);
+    EXPECT_EQ(records[1].payload, "first");
+    EXPECT_EQ(records[2].payloadSize, 300u);
+    EXPECT_EQ(records[2].payload, std::string(300, 'x'));
+    EXPECT_EQ(records[3].type, chl::WORKLOAD_RELEASE_STORY);
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].storyIndex, 0u);
+        EXPECT_EQ(records[i].threadIndex, 0u);
+        if(i > 0)
+        { EXPECT_GE(records[i].offset, records[i - 1].offset); }
+    }
+}
+
+TEST_F(WorkloadTrace_Test, testRedactedPayloadsKeepSizes)
+{
+    captureWorkload(false);
+    bool has_payloads = true;
+    std::vector <chl::WorkloadRecord> records = readWorkload(has_payloads);
+
+    EXPECT_FALSE(has_payloads);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[1].payloadSize, 5u);
+    EXPECT_TRUE(records[1].payload.empty());
+    EXPECT_EQ(records[2].payloadSize, 300u);
+    EXPECT_TRUE(records[2].payload.empty());
+}
+
+TEST_F(WorkloadTrace_Test, testStoriesAndThreadsAreNumberedInOrder)
+{
+    chl::WorkloadTraceWriter*traceWriter = chl::WorkloadTraceWriter::CreateWorkloadTraceWriter(traceFile, false);
+    ASSERT_NE(traceWriter, nullptr);
+    traceWriter->recordAcquireStory("chronicle", "story_a", 21);
+    std::thread other_thread([traceWriter]()
+                             {
+                                 traceWriter->recordAcquireStory("chronicle", "story_b", 22);
+                                 traceWriter->recordEvent(22, "b");
+                             });
+    other_thread.join();
+    traceWriter->recordEvent(21, "a");
+    // events of the stories that were never acquired aren't captured
+    traceWriter->recordEvent(99, "unknown");
+    delete traceWriter;
+
+    bool has_payloads = false;
+    std::vector <chl::WorkloadRecord> records = readWorkload(has_payloads);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].storyIndex, 0u);
+    EXPECT_EQ(records[0].threadIndex, 0u);
+    EXPECT_EQ(records[1].storyIndex, 1u);
+    EXPECT_EQ(records[1].threadIndex, 1u);
+    EXPECT_EQ(records[2].storyIndex, 1u);
+    EXPECT_EQ(records[2].threadIndex, 1u);
+    EXPECT_EQ(records[3].storyIndex, 0u);
+    EXPECT_EQ(records[3].threadIndex, 0u);
+}
+
+TEST_F(WorkloadTrace_Test, testRejectsFilesOfUnknownFormat)
+{
+    std::ofstream stream(traceFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    stream << "not a workload trace";
+    stream.close();
+    EXPECT_EQ(chl::WorkloadTraceReader::CreateWorkloadTraceReader(traceFile), nullptr);
+}
+
+TEST_F(WorkloadTrace_Test, testTruncatedRecordEndsTheTrace)
+{
+    captureWorkload(true);
+    std::filesystem::resize_file(traceFile, std::filesystem::file_size(traceFile) - 10);
+    bool has_payloads = false;
+    std::vector <chl::WorkloadRecord> records = readWorkload(has_payloads);
+    EXPECT_EQ(records.size(), 2u);
+}